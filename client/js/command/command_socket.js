@@ -1,4 +1,6 @@
 /// <reference path="../utilities/message_bus.js" />
+/// <reference path="../telemetry/telemetry_listener.js" />
+/// <reference path="../telemetry/telemetry_model_listener.js" />
 
 
 ///////////////// Web Socket for Rover Commands /////////////////
@@ -32,6 +34,21 @@ function CommandSocket(hostname, port=82, messageBus = undefined) {
     //
     var socket = null;
 
+    // wheel telemetry may be delta encoded
+    const _deltaMerger = TelemetryDeltaMerger(messageBus);
+
+    /**
+     * Publish wheel telemetry once any deltas are merged.
+     * 
+     * @param {object} telemetry 
+     */
+    function _publishTelemetry(telemetry) {
+        const merged = _deltaMerger.merge("wheel", telemetry);
+        if(merged) {
+            messageBus.publish("telemetry", merged);
+        }
+    }
+
     /**
      * Determine if socket is started.
      * 
@@ -174,6 +191,73 @@ function CommandSocket(hostname, port=82, messageBus = undefined) {
         }
     }
 
+    /**
+     * Handle a single text message from the rover.
+     * 
+     * @param {string} text 
+     */
+    function _onTextMessage(text) {
+        if(text.startsWith("log(")) {
+            // just reflect logs to the console for now
+            console.log(`CommandSocket: ${text}`);
+        } else if(text.startsWith("tel(")) {
+            // reflect telemetry to console
+            console.log(`CommandSocket: ${text}`);
+
+            // parse out the telemetry packet and publish it
+            if(messageBus) {
+                const telemetry = JSON.parse(text.slice(4, text.lastIndexOf(")")));    // skip 'tel('
+                _publishTelemetry(telemetry);
+            }
+        } else if(text.startsWith("pose(")) {
+            // reflect pose to console
+            console.log(`CommandSocket: ${text}`);
+
+            // parse out pose change and publish it
+            if(messageBus) {
+                const pose = JSON.parse(text.slice(5, text.lastIndexOf(")")));    // skip 'pose('
+                messageBus.publish("pose", pose);
+            }
+        } else if(text.startsWith("goto(")) {
+            // reflect pose to console
+            console.log(`CommandSocket: ${text}`);
+
+            // parse out pose change and publish it
+            if(messageBus) {
+                // like: '{"goto":{"x":-300.000000,"y":0.000000,"a":3.141593,"state":"ACHIEVED","at":707869}}'
+                const gotoGoal = JSON.parse(text.slice(5, text.lastIndexOf(")")));    // skip 'goto('
+                messageBus.publish("goto", gotoGoal);
+            }
+        } else if(text.startsWith("set(")) {
+            // reflect settings to console
+            console.log(`CommandSocket: ${text}`);
+
+            // parse out setting change and publish it
+            if(messageBus) {
+                const setting = JSON.parse(text.slice(4, text.lastIndexOf(")")));    // skip 'set('
+                messageBus.publish("set", setting);
+            }
+        } else if(text.startsWith("loss(")) {
+            // rover dropped telemetry; warn and publish counts
+            console.warn(`CommandSocket: ${text}`);
+            if(messageBus) {
+                const loss = JSON.parse(text.slice(5, text.lastIndexOf(")")));    // skip 'loss('
+                messageBus.publish("loss", loss);
+            }
+        } else if(text.startsWith("cmd(") && isSending()) {
+            // this should be the acknowledgement of the sent command
+            if(_sentCommand === text) {
+                console.log(`CommandSocket: ${_sentCommand} Acknowledged`);
+                _sentCommand = "";   // SUCCESS, we got our command ack'd
+            } else {
+                console.log(`CommandSocket: ${_sentCommand} Not Acknowledged: ${text}`);
+                _errorMessage = `ERROR(${text})`;
+            }
+        } else {
+            console.log(`CommandSocket received unexpected text message: ${text}`);
+        }
+    }
+
     /**
      * @summary Start the websocket.
      * @description
@@ -187,61 +271,43 @@ function CommandSocket(hostname, port=82, messageBus = undefined) {
         try {
             socket.onopen = function () {
                 console.log("CommandSocket opened");
+                _deltaMerger.reset();   // rover starts each connection with keyframes
+
+                // let listeners negotiate per-connection settings, like telemetry format
+                if(messageBus) {
+                    messageBus.publish("command-socket-open", self);
+                }
             }
 
             socket.onmessage = function (msg) {
                 if("string" === typeof msg.data) {
-                    if(msg.data.startsWith("log(")) {
-                        // just reflect logs to the console for now
-                        console.log(`CommandSocket: ${msg.data}`);
-                    } else if(msg.data.startsWith("tel(")) {
-                        // reflect telemetry to console
-                        console.log(`CommandSocket: ${msg.data}`);
-
-                        // parse out the telemetry packet and publish it
-                        if(messageBus) {
-                            const telemetry = JSON.parse(msg.data.slice(4, msg.data.lastIndexOf(")")));    // skip 'tel('
-                            messageBus.publish("telemetry", telemetry);
-                        }
-                    } else if(msg.data.startsWith("pose(")) {
-                        // reflect pose to console
-                        console.log(`CommandSocket: ${msg.data}`);
-
-                        // parse out pose change and publish it
-                        if(messageBus) {
-                            const pose = JSON.parse(msg.data.slice(5, msg.data.lastIndexOf(")")));    // skip 'pose('
-                            messageBus.publish("pose", pose);
+                    //
+                    // telemetry is batched into one frame per poll,
+                    // with one record per line.
+                    //
+                    for(const text of msg.data.split("\n")) {
+                        if(text) {
+                            _onTextMessage(text);
                         }
-                    } else if(msg.data.startsWith("goto(")) {
-                        // reflect pose to console
-                        console.log(`CommandSocket: ${msg.data}`);
-
-                        // parse out pose change and publish it
-                        if(messageBus) {
-                            // like: '{"goto":{"x":-300.000000,"y":0.000000,"a":3.141593,"state":"ACHIEVED","at":707869}}'
-                            const gotoGoal = JSON.parse(msg.data.slice(5, msg.data.lastIndexOf(")")));    // skip 'goto('
-                            messageBus.publish("goto", gotoGoal);
-                        }
-                    } else if(msg.data.startsWith("set(")) {
-                        // reflect settings to console
-                        console.log(`CommandSocket: ${msg.data}`);
-
-                        // parse out setting change and publish it
-                        if(messageBus) {
-                            const setting = JSON.parse(msg.data.slice(4, msg.data.lastIndexOf(")")));    // skip 'set('
-                            messageBus.publish("set", setting);
-                        }
-                    } else if(msg.data.startsWith("cmd(") && isSending()) {
-                        // this should be the acknowledgement of the sent command
-                        if(_sentCommand === msg.data) {
-                            console.log(`CommandSocket: ${_sentCommand} Acknowledged`);
-                            _sentCommand = "";   // SUCCESS, we got our command ack'd
-                        } else {
-                            console.log(`CommandSocket: ${_sentCommand} Not Acknowledged: ${msg.data}`);
-                            _errorMessage = `ERROR(${msg})`;
+                    }
+                } else if(msg.data instanceof ArrayBuffer) {
+                    //
+                    // binary telemetry; decode records and publish
+                    // them just like the equivalent text telemetry.
+                    //
+                    for(const record of decodeBinaryTelemetry(msg.data)) {
+                        if("log" === record.message) {
+                            console.log(`CommandSocket: log(${JSON.stringify(record.data)})`);
+                        } else if("loss" === record.message) {
+                            console.warn(`CommandSocket: loss(${JSON.stringify(record.data)})`);
+                            if(messageBus) {
+                                messageBus.publish("loss", record.data);
+                            }
+                        } else if(messageBus && ("telemetry" === record.message)) {
+                            _publishTelemetry(record.data);
+                        } else if(messageBus) {
+                            messageBus.publish(record.message, record.data);
                         }
-                    } else {
-                        console.log(`CommandSocket received unexpected text message: ${msg.data}`);
                     }
                 } else {
                     console.warn("CommandSocket received unexpected binary message.");
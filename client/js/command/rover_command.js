@@ -1,6 +1,7 @@
 /// <reference path="command_socket.js" />
 
 /** @typedef {'stop'|'forward'|'reverse'|'left'|'right'} TurtleCommandName */
+/** @typedef {'wheel'|'pose'|'goto'|'set'|'log'} TelemetryChannelName */
 
 /**
  * @summary A rover command processor.
@@ -46,9 +47,19 @@
  *             leftFlip?: boolean, rightFlip?: boolean, 
  *             leftZero?: number, rightZero?: number) 
  *             => boolean} sendTankCommand
+ * @property {(linear: number, angular: number) => boolean} sendTwistCommand
  * @property {() => boolean} sendHaltCommand
  * @property {() => boolean} sendResetPoseCommand
+ * @property {(Kp: number, Ki: number) => boolean} sendWheelSyncCommand
  * @property {(x: number, y: number, tolerance: number, pointForward: number) => boolean} sendGotoGoalCommand
+ * @property {(waypoints: {x: number, y: number}[], lookahead: number, tolerance: number) => boolean} sendPathCommand
+ * @property {(on: boolean) => boolean} sendRecordCommand
+ * @property {(lookahead: number, tolerance: number) => boolean} sendPlayCommand
+ * @property {(x: number, y: number, tolerance: number, pointForward: number) => boolean} sendPlanCommand
+ * @property {(binary: boolean, delta?: boolean) => boolean} sendTelemetryFormatCommand
+ * @property {(channel: TelemetryChannelName) => boolean} sendKeyframeCommand
+ * @property {(channel: TelemetryChannelName, periodMs: number) => boolean} sendTelemetryRateCommand
+ * @property {(sinceMs: number, channel: TelemetryChannelName) => boolean} sendHistoryCommand
  * @property {(command: TurtleCommandName, speedPercent: number) => void} enqueueTurtleCommand
  * @property {() => void} processTurtleCommand
  * @property {(command: TurtleCommandName, speedFraction: number) => boolean} sendTurtleCommand
@@ -385,6 +396,18 @@ function RoverCommand(host, commandSocket) {
         return `goto(${x}, ${y}, ${tolerance}, ${pointForward})`
     }
 
+    /**
+     * Format a velocity command.
+     * 
+     * @private
+     * @param {number} linear  // cm/sec forward, negative for reverse
+     * @param {number} angular // radians/sec counter-clockwise, negative for clockwise
+     * @returns {string}       // the twist command
+     */
+    function _formatTwistCommand(linear, angular) {
+        return `twist(${parseFloat(linear.toFixed(4))}, ${parseFloat(angular.toFixed(4))})`;
+    }
+
     /**
      * @summary Send a turtle-style command to the rover.
      * 
@@ -466,6 +489,25 @@ function RoverCommand(host, commandSocket) {
             steeringValue = -(steeringValue);
         }
 
+        if(_useSpeedControl) {
+            //
+            // the rover does the kinematics; throttle chooses
+            // the speed and steering chooses the curvature,
+            // up to a tightest turn like a car's, so the
+            // turning rate follows the speed.
+            //
+            let linear = 0;
+            if(0 != throttleValue) {
+                linear = map(abs(throttleValue), throttleZero, 1.0, _minSpeed, _maxSpeed);
+                if(throttleValue < 0) {
+                    linear = -linear;
+                }
+            }
+            // right turn (positive steering) is clockwise (negative angular)
+            const angular = -steeringValue * linear / config.joystickTurnRadius();
+            return sendTwistCommand(linear, angular);
+        }
+
         // assume straight - not turn
         let leftValue = throttleValue;
         let rightValue = throttleValue;
@@ -507,6 +549,25 @@ function RoverCommand(host, commandSocket) {
         return _enqueueCommand(tankCommand, (abs(leftValue) <= leftZero) && (abs(rightValue) <= rightZero));
     }
 
+    /**
+     * @summary Send a velocity movement command to the rover.
+     * 
+     * @description
+     * Send a linear velocity and turning rate to the rover,
+     * which calculates the wheel speeds.  If a wheel would
+     * go faster than the rover's maximum speed then the rover
+     * slows both wheels so it keeps the same curvature.
+     * This requires speed control.
+     * 
+     * @param {number} linear  // cm/sec forward, negative for reverse
+     * @param {number} angular // radians/sec counter-clockwise, negative for clockwise
+     * @return {boolean}       // true if command sent, false if not
+     */
+    function sendTwistCommand(linear, angular) {
+        // a zero (stop) command is high priority
+        return _enqueueCommand(_formatTwistCommand(linear, angular), (0 == linear) && (0 == angular));
+    }
+
     /**
      * @summary Send a halt command to the rover
      * 
@@ -536,6 +597,23 @@ function RoverCommand(host, commandSocket) {
         return _enqueueCommand("resetPose()", true);
     }
 
+    /**
+     * @summary Send the wheel synchronization gains to the rover.
+     * 
+     * @description
+     * While both wheels use speed control, the rover trims
+     * their speeds so neither gets ahead of the other, which
+     * keeps it on a straight line even if the motors are
+     * mismatched.  Zero for both gains turns this off.
+     * 
+     * @param {number} Kp // cm/sec of trim per cm one wheel is ahead
+     * @param {number} Ki // cm/sec of trim per cm·sec one wheel has been ahead
+     * @return {boolean}  // true if command sent, false if not
+     */
+    function sendWheelSyncCommand(Kp, Ki) {
+        return _enqueueCommand(`sync(${Kp}, ${Ki})`, true);
+    }
+
     /**
      * @summary Send the goto goal movement command to the rover.
      * 
@@ -555,6 +633,163 @@ function RoverCommand(host, commandSocket) {
         return _enqueueCommand(_formatGotoGoalCommand(x, y, tolerance, pointForward));
     }
 
+    /**
+     * @summary Send a path of waypoints for the rover to follow.
+     * 
+     * @description
+     * Upload the waypoints, in order, then tell the rover
+     * to follow them.  The rover drives through each waypoint
+     * without stopping, steering toward the point on the path
+     * that is lookahead cm ahead of it, and stops at the last
+     * one.  The rover keeps at most 16 waypoints.
+     * 
+     * @param {{x: number, y: number}[]} waypoints // positions to drive through, in order
+     * @param {number} lookahead                   // cm along the path ahead of the rover to steer toward
+     * @param {number} tolerance                   // distance from last waypoint considered success
+     * @returns {boolean}                          // true if commands queued, false if not
+     */
+    function sendPathCommand(waypoints, lookahead, tolerance) {
+        if(0 == waypoints.length) {
+            return false;
+        }
+        for(let i = 0; i < waypoints.length; i += 1) {
+            if(!_enqueueCommand(`waypoint(${i}, ${waypoints[i].x}, ${waypoints[i].y})`, true)) {
+                return false;
+            }
+        }
+        return _enqueueCommand(`path(${lookahead}, ${tolerance})`, true);
+    }
+
+    /**
+     * @summary Start or stop recording the path the rover drives.
+     * 
+     * @description
+     * While recording, the rover keeps just enough of it's
+     * poses as waypoints to stay within a couple of cm of the
+     * path it drives, however it is driven.  Starting a
+     * recording forgets the last one.
+     * 
+     * @param {boolean} on  // true to start recording, false to stop
+     * @returns {boolean}   // true if command queued, false if not
+     */
+    function sendRecordCommand(on) {
+        return _enqueueCommand(`record(${on ? "true" : "false"})`, true);
+    }
+
+    /**
+     * @summary Follow the recorded path.
+     * 
+     * @description
+     * The rover drives from where it is through the
+     * recorded waypoints, like sendPathCommand(), and
+     * stops at the end of the recorded path.
+     * 
+     * @param {number} lookahead    // cm along the path ahead of the rover to steer toward
+     * @param {number} tolerance    // distance from last waypoint considered success
+     * @returns {boolean}           // true if command queued, false if not
+     */
+    function sendPlayCommand(lookahead, tolerance) {
+        return _enqueueCommand(`play(${lookahead}, ${tolerance})`, true);
+    }
+
+    /**
+     * @summary Plan a path around obstacles to a position and drive it.
+     * 
+     * @description
+     * The rover plans a path across it's map, keeping clear
+     * of occupied cells, then drives it one waypoint at a time
+     * like sendGotoGoalCommand().  It does not move if there
+     * is no way to the goal.
+     * 
+     * @param {number} x             // x position to achieve
+     * @param {number} y             // y position to achieve
+     * @param {number} tolerance     // tolerance of each goal along the path
+     * @param {number} pointForward  // point forward as fraction of wheelbase
+     * @returns {boolean}            // true if command queued, false if not
+     */
+    function sendPlanCommand(x, y, tolerance, pointForward) {
+        return _enqueueCommand(`plan(${x}, ${y}, ${tolerance}, ${pointForward})`, true);
+    }
+
+    /**
+     * @summary Select binary or text telemetry.
+     * 
+     * @description
+     * Ask the rover to send telemetry as compact binary
+     * records or as text.  The rover reverts to text
+     * when the command socket disconnects, so this
+     * should be sent each time the socket opens.
+     * 
+     * If delta is true then wheel telemetry only carries
+     * the fields that changed, with periodic keyframes;
+     * TelemetryDeltaMerger turns these back into complete records.
+     * 
+     * @param {boolean} binary // true for binary telemetry, false for text
+     * @param {boolean} delta  // true for delta encoded wheel telemetry
+     * @returns {boolean}      // true if command sent, false if not
+     */
+    function sendTelemetryFormatCommand(binary, delta = false) {
+        const format = binary ? "binary" : "text";
+        return _enqueueTelemetryCommand(delta ? `format(${format}, delta)` : `format(${format})`);
+    }
+
+    /**
+     * @summary Ask for all fields in the next telemetry on a channel.
+     * 
+     * @description
+     * When delta encoded telemetry skips a sequence number
+     * the client's merged values may be stale; a keyframe
+     * carries all of the fields so the client can recover.
+     * 
+     * @param {TelemetryChannelName} channel // channel that had a gap
+     * @returns {boolean}                    // true if command sent, false if not
+     */
+    function sendKeyframeCommand(channel) {
+        return _enqueueTelemetryCommand(`keyframe(${channel})`);
+    }
+
+    /**
+     * @summary Turn a telemetry channel off or set it's rate.
+     * 
+     * @description
+     * Channels are 'wheel', 'pose', 'goto', 'set' and 'log'.
+     * The rover decimates the periodic 'wheel' and 'pose'
+     * channels before formatting, so a slower rate saves
+     * both bandwidth and rover cpu.  The state change
+     * channels, 'goto', 'set' and 'log', are only turned
+     * off or on; any period other than 0 sends them all.
+     * The rover restores all channels when the command 
+     * socket disconnects, so this should be sent each
+     * time the socket opens.
+     * 
+     * @param {TelemetryChannelName} channel // channel to change
+     * @param {number} periodMs              // 0 for off, 1 for all messages,
+     *                                       // otherwise minimum milliseconds between messages
+     * @returns {boolean}                    // true if command sent, false if not
+     */
+    function sendTelemetryRateCommand(channel, periodMs) {
+        return _enqueueTelemetryCommand(`telemetry(${channel}, ${int(periodMs)})`);
+    }
+
+    /**
+     * @summary Ask the rover for recorded telemetry.
+     * 
+     * @description
+     * The rover records wheel and pose samples, so
+     * after a reconnect or while a chart was inactive
+     * the samples the client missed can be backfilled.
+     * The backlog is streamed as binary history
+     * records, which are decoded into the usual
+     * 'telemetry' and 'pose' messages.
+     * 
+     * @param {number} sinceMs               // rover time of newest sample the client has
+     * @param {TelemetryChannelName} channel // 'wheel' or 'pose'
+     * @returns {boolean}                    // true if command sent, false if not
+     */
+    function sendHistoryCommand(sinceMs, channel) {
+        return _enqueueTelemetryCommand(`history(${int(sinceMs)}, ${channel})`);
+    }
+
     /**
      * @summary Send a command string to the server
      * 
@@ -717,6 +952,30 @@ function RoverCommand(host, commandSocket) {
         return false;
     }
 
+    //
+    // telemetry commands change what the rover sends,
+    // not what it does, so they are queued apart from
+    // drive commands; they neither clear queued drive
+    // commands nor get replaced by them.
+    //
+    let _telemetryQueue = [];
+
+    /**
+     * Insert a telemetry command into the telemetry queue.
+     * 
+     * @private
+     * @param {string} command       // IN : command to queue
+     * @return {boolean}             // RET: true if command queued, 
+     *                                       false if not
+     */
+    function _enqueueTelemetryCommand(command) {
+        if(typeof command == "string") {
+            _telemetryQueue.push(command);
+            return true;
+        }
+        return false;
+    }
+
     /**
      * @summary Determine if there are any commands in the command queue
      * 
@@ -726,7 +985,7 @@ function RoverCommand(host, commandSocket) {
      *                      //      false if the command queue is empty.
      */
     function _pendingCommands() {
-        return _commandQueue.length > 0;
+        return (_commandQueue.length > 0) || (_telemetryQueue.length > 0);
     }
 
     /**
@@ -736,6 +995,13 @@ function RoverCommand(host, commandSocket) {
      *                      false is command was not sent
      */
     function _processCommands() {
+        if(_telemetryQueue.length > 0) {
+            if(_sendCommand(_telemetryQueue[0])) {
+                _telemetryQueue.shift();
+                return true;
+            }
+            return false;
+        }
         if(_commandQueue.length > 0) {
             const command = _commandQueue.shift();
             if(typeof command == "string") {
@@ -830,11 +1096,21 @@ function RoverCommand(host, commandSocket) {
         "sendTurtleCommand": sendTurtleCommand,
         "sendJoystickCommand": sendJoystickCommand,
         "sendTankCommand": sendTankCommand,
+        "sendTwistCommand": sendTwistCommand,
         "sendHaltCommand": sendHaltCommand,
         "sendResetPoseCommand": sendResetPoseCommand,
+        "sendWheelSyncCommand": sendWheelSyncCommand,
         "syncSpeedControl": syncSpeedControl,
         "syncMotorStall": syncMotorStall,
         "sendGotoGoalCommand": sendGotoGoalCommand,
+        "sendPathCommand": sendPathCommand,
+        "sendRecordCommand": sendRecordCommand,
+        "sendPlayCommand": sendPlayCommand,
+        "sendPlanCommand": sendPlanCommand,
+        "sendTelemetryFormatCommand": sendTelemetryFormatCommand,
+        "sendKeyframeCommand": sendKeyframeCommand,
+        "sendHistoryCommand": sendHistoryCommand,
+        "sendTelemetryRateCommand": sendTelemetryRateCommand,
     });
 
     return self;
@@ -55,6 +55,30 @@ const config = function() {
     function telemetryBufferSize() { return 200; }
     function poseTelemetrySize() { return 200; }
 
+    /**
+     * @returns {boolean} - true to ask the rover for binary telemetry,
+     *                      false to use text telemetry.
+     */
+    function binaryTelemetry() { return true; }
+
+    /**
+     * @returns {boolean} - true to ask the rover to send only
+     *                      changed wheel telemetry fields.
+     */
+    function deltaTelemetry() { return true; }
+
+    /**
+     * @returns {number} - telemetry period in milliseconds for a chart 
+     *                     that is being viewed; 1 means all telemetry.
+     */
+    function activeTelemetryMs() { return 1; }
+
+    /**
+     * @returns {number} - telemetry period in milliseconds for a chart
+     *                     that is not being viewed; 0 would turn it off.
+     */
+    function inactiveTelemetryMs() { return 1000; }
+
     function chartBackgroundColor() { return "#181818" /*"#363636"*/; };
     function chartAxisColor() { return "#EFEFEF"; }
     function leftSpeedColor() { return "lightblue"; }
@@ -65,12 +89,24 @@ const config = function() {
     function rightPwmColor() { return "yellow"; }
     function poseLineColor() { return "pink"; }
     function posePointColor() { return "red"; }
+    function poseErrorColor() { return "orange"; }
     function averageSpeedMs() { return 2000; }
 
+    /**
+     * @returns {number} - radius in cm of the tightest turn the
+     *                     joystick asks for, at full steering,
+     *                     when using speed control.
+     */
+    function joystickTurnRadius() { return 30; }
+
     const self = {
         "telemetryPlotMs": telemetryPlotMs,
         "telemetryBufferSize": telemetryBufferSize,
         "poseTelemetrySize": poseTelemetrySize,
+        "binaryTelemetry": binaryTelemetry,
+        "deltaTelemetry": deltaTelemetry,
+        "activeTelemetryMs": activeTelemetryMs,
+        "inactiveTelemetryMs": inactiveTelemetryMs,
         "chartBackgroundColor": chartBackgroundColor,
         "chartAxisColor": chartAxisColor,
         "leftSpeedColor": leftSpeedColor,
@@ -81,7 +117,9 @@ const config = function() {
         "rightPwmColor": rightPwmColor,
         "poseLineColor": poseLineColor,
         "posePointColor": posePointColor,
+        "poseErrorColor": poseErrorColor,
         "averageSpeedMs": averageSpeedMs,
+        "joystickTurnRadius": joystickTurnRadius,
     }
 
     return self;
@@ -172,6 +172,16 @@ document.addEventListener('DOMContentLoaded', function (event) {
     const commandSocket = CommandSocket(location.hostname, 82, messageBus);
     const roverCommand = RoverCommand(baseHost, commandSocket);
 
+    // each new command connection starts with text telemetry; ask for binary and delta if configured
+    messageBus.subscribe("command-socket-open", {
+        "onMessage": () => roverCommand.sendTelemetryFormatCommand(config.binaryTelemetry(), config.deltaTelemetry()),
+    });
+
+    // recover from a gap in delta encoded telemetry
+    messageBus.subscribe("telemetry-keyframe-request", {
+        "onMessage": (message, channel) => roverCommand.sendKeyframeCommand(channel),
+    });
+
     const joystickContainer = document.getElementById("joystick-control");
     const joystickViewController = GamePadViewController(joystickContainer, 
         "#joystick-control > .selector > .select-gamepad ",                                                                     // gamepad select element
@@ -256,7 +266,8 @@ document.addEventListener('DOMContentLoaded', function (event) {
         telemetryViewController,
         resetTelemetryViewController, 
         poseTelemetryViewController, 
-        resetPoseViewController);
+        resetPoseViewController,
+        roverCommand);
 
     const turtleKeyboardControl = TurtleKeyboardController(messageBus);
     const turtleViewController = TurtleViewController(roverCommand, messageBus, '#turtle-control', 'button.rover', '#rover_speed-group');
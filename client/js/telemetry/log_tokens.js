@@ -0,0 +1,43 @@
+/**
+ * Format strings of tokenized log records, indexed by token.
+ * GENERATED from src/log_tokens.h by tools/log_tokens_js.sh; do not edit.
+ */
+const LOG_TOKEN_FORMATS = [
+    "%u log records dropped",     // LOG_TOKEN_DROPPED
+    "Setting up...",     // LOG_SETUP_STARTED
+    "WiFi Failed!",     // LOG_WIFI_FAILED
+    "... http server intialized ...",     // LOG_HTTP_INITIALIZED
+    "... websockets server intialized ...",     // LOG_WEBSOCKETS_INITIALIZED
+    "...Rover Initialized...",     // LOG_ROVER_INITIALIZED
+    "Telemetry history could not be allocated",     // LOG_HISTORY_ALLOCATION_FAILED
+    "Flight log could not be created",     // LOG_FLIGHT_LOG_FAILED
+    "SPIFFS could not be mounted for the flight log",     // LOG_FLIGHT_SPIFFS_FAILED
+    "handling /",     // LOG_HANDLE_INDEX
+    "handling /bundle.css",     // LOG_HANDLE_BUNDLE_CSS
+    "handling /bundle.js",     // LOG_HANDLE_BUNDLE_JS
+    "handling /health",     // LOG_HANDLE_HEALTH
+    "handling /capture",     // LOG_HANDLE_CAPTURE
+    "handling /status",     // LOG_HANDLE_STATUS
+    "handling /control",     // LOG_HANDLE_CONTROL
+    "Failure setting camera property",     // LOG_CAMERA_PROPERTY_FAILED
+    "Camera init failed with error 0x%x",     // LOG_CAMERA_INIT_FAILED
+    "Camera capture failed",     // LOG_CAMERA_CAPTURE_FAILED
+    "JPEG compression failed",     // LOG_CAMERA_JPEG_FAILED
+    "Failure grabbing and sending image.",     // LOG_STREAM_IMAGE_FAILED
+    "wsStreamEvent.WS_EVT_CONNECT, clientId: %d",     // LOG_STREAM_CONNECTED
+    "wsStreamEvent.WS_EVT_DISCONNECT, clientId: %d",     // LOG_STREAM_DISCONNECTED
+    "wsStreamEvent.WStype_PONG, clientId: %d",     // LOG_STREAM_PONG
+    "wsStreamEvent.WStype_BIN, clientId: %d",     // LOG_STREAM_BINARY
+    "wsStreamEvent.WStype_TEXT, clientId: %d, %u bytes",     // LOG_STREAM_TEXT
+    "wsStreamEvent.UNHANDLED EVENT %d, clientId: %d",     // LOG_STREAM_UNHANDLED
+    "wsCommandEvent.WS_EVT_CONNECT, clientId: %d",     // LOG_COMMAND_CONNECTED
+    "wsCommandEvent.WS_EVT_DISCONNECT, clientId: %d",     // LOG_COMMAND_DISCONNECTED
+    "wsCommandEvent.WStype_PONG, clientId: %d",     // LOG_COMMAND_PONG
+    "wsCommandEvent.WStype_BIN, clientId: %d",     // LOG_COMMAND_BINARY
+    "wsCommandEvent.WStype_TEXT, clientId: %d, %u bytes",     // LOG_COMMAND_TEXT
+    "wsCommandEvent.UNHANDLED EVENT %d, clientId: %d",     // LOG_COMMAND_UNHANDLED
+    "Occupancy grid could not be allocated",     // LOG_MAP_ALLOCATION_FAILED
+    "handling /map",     // LOG_HANDLE_MAP
+    "Path planner could not be allocated",     // LOG_PLANNER_ALLOCATION_FAILED
+    "Camera capture task could not be created",     // LOG_CAMERA_TASK_FAILED
+];
@@ -2,6 +2,57 @@
 /// <reference path="../../view/widget/canvas/plot.js" />
 /// <reference path="../../view/widget/canvas/canvas_painter.js" />
 
+/**
+ * Construct an iterator of points around the error
+ * ellipse of a pose, from the (x, y) part of it's covariance.
+ * 
+ * @param {PoseTelemetryType} pose  // IN : pose with covariance in 'cov'
+ * @param {number} sigmas           // IN : size of ellipse in standard deviations
+ * @param {number} segments         // IN : number of line segments in ellipse
+ * @returns {Point2dIteratorType}
+ */
+function ErrorEllipseIterator(pose, sigmas = 2, segments = 32) {
+    // cov is [xx, xy, xa, yy, ya, aa]
+    const xx = pose.cov[0];
+    const xy = pose.cov[1];
+    const yy = pose.cov[3];
+
+    //
+    // eigenvalues of the 2x2 covariance are the
+    // variances along the ellipse's axes, and the
+    // major axis is rotated by half the angle below
+    //
+    const mean = (xx + yy) / 2;
+    const spread = Math.sqrt(((xx - yy) / 2) ** 2 + xy * xy);
+    const major = sigmas * Math.sqrt(Math.max(0, mean + spread));
+    const minor = sigmas * Math.sqrt(Math.max(0, mean - spread));
+    const rotation = Math.atan2(2 * xy, xx - yy) / 2;
+    const cosRotation = Math.cos(rotation);
+    const sinRotation = Math.sin(rotation);
+
+    let i = 0;
+    function hasNext() {
+        return i <= segments;
+    }
+    function next() {
+        if(hasNext()) {
+            const t = 2 * Math.PI * i / segments;
+            const u = major * Math.cos(t);
+            const v = minor * Math.sin(t);
+            i += 1;
+            return Point(
+                pose.x + u * cosRotation - v * sinRotation, 
+                pose.y + u * sinRotation + v * cosRotation);
+        }
+        throw RangeError("ErrorEllipseIterator is out of range.")
+    }
+
+    return {
+        "hasNext": hasNext,
+        "next": next,
+    }
+}
+
 /**
  * Construct canvas painter that draw telemetry line charts.
  * 
@@ -121,6 +172,11 @@ function PoseCanvasPainter(poseTelemetry) {
                 lineChart.setLineColor(config.poseLineColor()).plotLine(Point2dIterator(poseTelemetry), xAxis, yAxis);
                 lineChart.setPointColor(config.posePointColor()).drawPoint(poseTelemetry.last(), xAxis, yAxis);
 
+                // two sigma error ellipse around current position
+                if(Array.isArray(poseTelemetry.last().cov)) {
+                    lineChart.setLineColor(config.poseErrorColor()).plotLine(ErrorEllipseIterator(poseTelemetry.last()), xAxis, yAxis);
+                }
+
                 // done
                 lineChart.detachContext();
 
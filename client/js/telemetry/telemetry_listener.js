@@ -17,12 +17,14 @@
  * A telemetry value for robot pose.
  * 
  * @example
- * `{pose: {x: 10.1, y: 4.3, a: 0.53, at:1234567890}`
+ * `{pose: {x: 10.1, y: 4.3, a: 0.53, cov: [0.1, 0, 0.01, 0.2, 0.02, 0.001], at:1234567890}`
  * 
  * @typedef {object} PoseTelemetryType
  * @property {number} x   // x position in meters
  * @property {number} y   // y position in meters
  * @property {number} a   // orientation (angle in radians)
+ * @property {number[]} [cov] // upper triangle of (x, y, a) covariance; [xx, xy, xa, yy, ya, aa]
+ *                            // not present in history backfill
  * @property {number} at  // timestamp
  * 
  */
@@ -249,10 +251,38 @@ function TelemetryListener(messageBus, msg, spec, maxHistory) {
          */
         function processTelemetry(telemetry) {
             if (telemetry) {
-                if(_telemetry.length === maxHistory) {
-                    _telemetry.shift();
+                if((_telemetry.length > 0) && (telemetry["at"] <= _telemetry[_telemetry.length - 1]["at"])) {
+                    //
+                    // backfilled history is older than what we have;
+                    // insert it in time order and skip samples we already have.
+                    //
+                    let low = 0;
+                    let high = _telemetry.length;
+                    while(low < high) {
+                        const middle = (low + high) >> 1;
+                        if(_telemetry[middle]["at"] < telemetry["at"]) {
+                            low = middle + 1;
+                        } else {
+                            high = middle;
+                        }
+                    }
+                    if((low < _telemetry.length) && (_telemetry[low]["at"] === telemetry["at"])) {
+                        return;
+                    }
+                    if(_telemetry.length === maxHistory) {
+                        if(0 === low) {
+                            return; // older than anything we can keep
+                        }
+                        _telemetry.shift();
+                        low -= 1;
+                    }
+                    _telemetry.splice(low, 0, telemetry);
+                } else {
+                    if(_telemetry.length === maxHistory) {
+                        _telemetry.shift();
+                    }
+                    _telemetry.push(telemetry);
                 }
-                _telemetry.push(telemetry);
 
                 //
                 // maintain min/max ranges for numeric
@@ -457,3 +487,380 @@ function TelemetryListener(messageBus, msg, spec, maxHistory) {
 
     return self;
 }
+
+/**
+ * A decoded binary telemetry record;
+ * message and data are the same as
+ * the text telemetry would publish.
+ * 
+ * @typedef {object} DecodedTelemetryType
+ * @property {string} message  // "telemetry", "set", "pose", "goto" or "log"
+ * @property {object} data     // like {left: {forward: true, pwm: 255, ...}}
+ */
+
+/**
+ * Binary telemetry record types.
+ * These match TelemetryRecordType in telemetry_format.h
+ */
+const TELEMETRY_RECORD_WHEEL = 1;
+const TELEMETRY_RECORD_WHEEL_POWER = 2;
+const TELEMETRY_RECORD_TARGET_SPEED = 3;
+const TELEMETRY_RECORD_POSE = 4;
+const TELEMETRY_RECORD_GOTO = 5;
+const TELEMETRY_RECORD_LOG = 6;
+const TELEMETRY_RECORD_WHEEL_DELTA = 7;
+const TELEMETRY_RECORD_LOSS = 8;
+const TELEMETRY_RECORD_HISTORY = 9;
+const TELEMETRY_RECORD_TOKEN_LOG = 10;
+const TELEMETRY_HISTORY_LAST = 0x01;
+
+/**
+ * Telemetry channel names in the order of TelemetryChannel in telemetry_format.h
+ */
+const TELEMETRY_CHANNEL_NAMES = ["wheel", "pose", "goto", "set", "log"];
+
+/**
+ * Field bits of a wheel delta record.
+ * These match WheelTelemetryField in telemetry_format.h
+ */
+const WHEEL_FORWARD_FIELD = 0x01;
+const WHEEL_PWM_FIELD = 0x02;
+const WHEEL_TARGET_FIELD = 0x04;
+const WHEEL_SPEED_FIELD = 0x08;
+const WHEEL_DISTANCE_FIELD = 0x10;
+const WHEEL_KEYFRAME = 0x80;
+
+/**
+ * Goto goal state names; these match GotoGoalStateStr in goto_goal.cpp
+ */
+const GOTO_GOAL_STATE_NAMES = ["NOT_RUNNING", "STARTING", "RUNNING", "ACHIEVED"];
+
+/**
+ * Log level names, indexed by level; these match tokenLogLevelName() in token_log.cpp
+ */
+const LOG_LEVEL_NAMES = ["DEBUG", "INFO", "WARNING", "ERROR"];
+
+/**
+ * @summary Format a tokenized log record.
+ *
+ * @description
+ * The rover sends a token that names a format string
+ * in LOG_TOKEN_FORMATS (see log_tokens.js) along with the
+ * raw 32 bit argument values.  This applies the format
+ * the same way formatTokenLog() in token_log.cpp does;
+ * %d, %i, %u, %x, %X, %c, %f and %g are supported,
+ * with an optional precision for %f and %g.
+ *
+ * @param {number} token        // IN : index into LOG_TOKEN_FORMATS
+ * @param {number[]} args       // IN : raw unsigned 32 bit argument values
+ * @returns {string}            // RET: formatted message
+ */
+function formatTokenLog(token, args) {
+    const format = LOG_TOKEN_FORMATS[token];
+    if(undefined === format) {
+        return `unknown log token ${token}`;
+    }
+
+    const bits = new DataView(new ArrayBuffer(4));
+    let arg = 0;
+    return format.replace(/%([-+ #0]*)(\d*)(?:\.(\d+))?([diuxXcfg%])/g, (match, flags, width, precision, conversion) => {
+        if("%" === conversion) return "%";
+
+        const value = (arg < args.length) ? args[arg] : 0;
+        arg += 1;
+        let text;
+        switch(conversion) {
+            case "d":
+            case "i":
+                text = `${value | 0}`;
+                break;
+            case "u":
+                text = `${value >>> 0}`;
+                break;
+            case "x":
+                text = (value >>> 0).toString(16);
+                break;
+            case "X":
+                text = (value >>> 0).toString(16).toUpperCase();
+                break;
+            case "c":
+                text = String.fromCharCode(value & 0xFF);
+                break;
+            default: {
+                bits.setUint32(0, value);
+                const f = bits.getFloat32(0);
+                text = ("f" === conversion) 
+                    ? f.toFixed(("" !== (precision || "")) ? parseInt(precision) : 6) 
+                    : `${f}`;
+                break;
+            }
+        }
+        const padWidth = ("" !== width) ? parseInt(width) : 0;
+        return (flags.indexOf("-") >= 0) 
+            ? text.padEnd(padWidth) 
+            : text.padStart(padWidth, (flags.indexOf("0") >= 0) ? "0" : " ");
+    });
+}
+
+/**
+ * @summary Decode a binary telemetry frame.
+ * 
+ * @description
+ * A frame holds one or more fixed layout, little-endian
+ * records (see telemetry_format.h).  Each record
+ * is converted into the same object the text
+ * telemetry would produce, so listeners do not
+ * need to know which format was used.
+ * Decoding stops at an unknown or truncated record.
+ * 
+ * @example
+ * ```
+ * for(const record of decodeBinaryTelemetry(msg.data)) {
+ *     messageBus.publish(record.message, record.data);
+ * }
+ * ```
+ * 
+ * @param {ArrayBuffer} buffer         // IN : binary websocket message
+ * @returns {DecodedTelemetryType[]}   // RET: decoded records in order received
+ */
+function decodeBinaryTelemetry(buffer) {
+    const view = new DataView(buffer);
+    const LITTLE = true;
+
+    /** @type {DecodedTelemetryType[]} */
+    const records = [];
+
+    /**
+     * Decode text of given length at offset
+     * @param {number} offset 
+     * @param {number} length 
+     * @returns {string}
+     */
+    function textAt(offset, length) {
+        let text = "";
+        for(let i = 0; i < length; i += 1) {
+            text += String.fromCharCode(view.getUint8(offset + i));
+        }
+        return text;
+    }
+
+    /**
+     * @param {number} offset 
+     * @returns {string}
+     */
+    function wheelAt(offset) {
+        return (0 === view.getUint8(offset)) ? "left" : "right";
+    }
+
+    let offset = 0;
+    while(offset < view.byteLength) {
+        const remaining = view.byteLength - offset;
+        const type = view.getUint8(offset);
+        switch(type) {
+            case TELEMETRY_RECORD_WHEEL: {
+                if(remaining < 20) return records;
+                records.push({message: "telemetry", data: {
+                    [wheelAt(offset + 1)]: {
+                        "forward": 0 !== view.getUint8(offset + 2),
+                        "pwm": view.getUint8(offset + 3),
+                        "target": view.getFloat32(offset + 4, LITTLE),
+                        "speed": view.getFloat32(offset + 8, LITTLE),
+                        "distance": view.getFloat32(offset + 12, LITTLE),
+                        "at": view.getUint32(offset + 16, LITTLE),
+                    }
+                }});
+                offset += 20;
+                break;
+            }
+            case TELEMETRY_RECORD_WHEEL_POWER: {
+                if(remaining < 4) return records;
+                records.push({message: "set", data: {
+                    [wheelAt(offset + 1)]: {
+                        "forward": 0 !== view.getUint8(offset + 2),
+                        "pwm": view.getUint8(offset + 3),
+                    }
+                }});
+                offset += 4;
+                break;
+            }
+            case TELEMETRY_RECORD_TARGET_SPEED: {
+                if(remaining < 8) return records;
+                records.push({message: "set", data: {
+                    [wheelAt(offset + 1)]: {
+                        "target": view.getFloat32(offset + 4, LITTLE),
+                    }
+                }});
+                offset += 8;
+                break;
+            }
+            case TELEMETRY_RECORD_POSE: {
+                if(remaining < 44) return records;
+                const cov = [];
+                for(let i = 0; i < 6; i += 1) {
+                    cov.push(view.getFloat32(offset + 20 + 4 * i, LITTLE));
+                }
+                records.push({message: "pose", data: {
+                    "pose": {
+                        "x": view.getFloat32(offset + 4, LITTLE),
+                        "y": view.getFloat32(offset + 8, LITTLE),
+                        "a": view.getFloat32(offset + 12, LITTLE),
+                        "cov": cov,
+                        "at": view.getUint32(offset + 16, LITTLE),
+                    }
+                }});
+                offset += 44;
+                break;
+            }
+            case TELEMETRY_RECORD_GOTO: {
+                if(remaining < 20) return records;
+                const state = view.getUint8(offset + 1);
+                records.push({message: "goto", data: {
+                    "goto": {
+                        "x": view.getFloat32(offset + 4, LITTLE),
+                        "y": view.getFloat32(offset + 8, LITTLE),
+                        "a": view.getFloat32(offset + 12, LITTLE),
+                        "state": (state < GOTO_GOAL_STATE_NAMES.length) ? GOTO_GOAL_STATE_NAMES[state] : "",
+                        "at": view.getUint32(offset + 16, LITTLE),
+                    }
+                }});
+                offset += 20;
+                break;
+            }
+            case TELEMETRY_RECORD_LOG: {
+                if(remaining < 3) return records;
+                const srcLength = view.getUint8(offset + 1);
+                const msgLength = view.getUint8(offset + 2);
+                if(remaining < 3 + srcLength + msgLength) return records;
+                records.push({message: "log", data: {
+                    "src": textAt(offset + 3, srcLength),
+                    "msg": textAt(offset + 3 + srcLength, msgLength),
+                }});
+                offset += 3 + srcLength + msgLength;
+                break;
+            }
+            case TELEMETRY_RECORD_TOKEN_LOG: {
+                //
+                // tokenized log record; formatted here
+                // into the same record as a text log.
+                //
+                if(remaining < 9) return records;
+                const argc = view.getUint8(offset + 8);
+                if(remaining < 9 + 4 * argc) return records;
+                const args = [];
+                for(let i = 0; i < argc; i += 1) {
+                    args.push(view.getUint32(offset + 9 + 4 * i, LITTLE));
+                }
+                records.push({message: "log", data: {
+                    "src": LOG_LEVEL_NAMES[view.getUint8(offset + 1)] || "ERROR",
+                    "msg": formatTokenLog(view.getUint16(offset + 2, LITTLE), args),
+                    "at": view.getUint32(offset + 4, LITTLE),
+                }});
+                offset += 9 + 4 * argc;
+                break;
+            }
+            case TELEMETRY_RECORD_WHEEL_DELTA: {
+                //
+                // only the fields that changed are present;
+                // the message looks like text delta telemetry,
+                // with "seq" and on keyframes "key".
+                //
+                if(remaining < 8) return records;
+                const fields = view.getUint8(offset + 2);
+                const wheel = {"seq": view.getUint8(offset + 3)};
+                let fieldOffset = offset + 4;
+                if(fields & WHEEL_KEYFRAME) {
+                    wheel["key"] = true;
+                }
+                if(fields & WHEEL_FORWARD_FIELD) {
+                    wheel["forward"] = 0 !== view.getUint8(fieldOffset);
+                    fieldOffset += 1;
+                }
+                if(fields & WHEEL_PWM_FIELD) {
+                    wheel["pwm"] = view.getUint8(fieldOffset);
+                    fieldOffset += 1;
+                }
+                for(const [bit, name] of [[WHEEL_TARGET_FIELD, "target"], [WHEEL_SPEED_FIELD, "speed"], [WHEEL_DISTANCE_FIELD, "distance"]]) {
+                    if(fields & bit) {
+                        if(fieldOffset + 4 > view.byteLength) return records;
+                        wheel[name] = view.getFloat32(fieldOffset, LITTLE);
+                        fieldOffset += 4;
+                    }
+                }
+                if(fieldOffset + 4 > view.byteLength) return records;
+                wheel["at"] = view.getUint32(fieldOffset, LITTLE);
+                records.push({message: "telemetry", data: {[wheelAt(offset + 1)]: wheel}});
+                offset = fieldOffset + 4;
+                break;
+            }
+            case TELEMETRY_RECORD_LOSS: {
+                // like text 'loss({"lost":{"wheel":3,...},"depth":2,"high":8,"sendUs":5230,"at":1234567})'
+                if(remaining < 4) return records;
+                const channels = view.getUint8(offset + 1);
+                const length = 4 + 4 * channels + 8;
+                if(remaining < length) return records;
+                const lost = {};
+                for(let channel = 0; channel < channels; channel += 1) {
+                    lost[TELEMETRY_CHANNEL_NAMES[channel] || `${channel}`] = view.getUint32(offset + 4 + 4 * channel, LITTLE);
+                }
+                records.push({message: "loss", data: {
+                    "lost": lost,
+                    "depth": view.getUint8(offset + 2),
+                    "high": view.getUint8(offset + 3),
+                    "sendUs": view.getUint32(offset + length - 8, LITTLE),
+                    "at": view.getUint32(offset + length - 4, LITTLE),
+                }});
+                offset += length;
+                break;
+            }
+            case TELEMETRY_RECORD_HISTORY: {
+                //
+                // a chunk of recorded samples; each is decoded
+                // just like the live record, so it lands in the
+                // same listeners.  The last chunk also produces
+                // a 'history' record so the client knows the
+                // backlog is complete.
+                //
+                if(remaining < 4) return records;
+                const channel = TELEMETRY_CHANNEL_NAMES[view.getUint8(offset + 1)];
+                const flags = view.getUint8(offset + 2);
+                const count = view.getUint8(offset + 3);
+                if(remaining < 4 + 20 * count) return records;
+                for(let i = 0; i < count; i += 1) {
+                    const sample = offset + 4 + 20 * i;
+                    const at = view.getUint32(sample, LITTLE);
+                    if("wheel" === channel) {
+                        records.push({message: "telemetry", data: {
+                            [wheelAt(sample + 4)]: {
+                                "forward": 0 !== view.getUint8(sample + 5),
+                                "pwm": view.getUint8(sample + 6),
+                                "target": view.getFloat32(sample + 8, LITTLE),
+                                "speed": view.getFloat32(sample + 12, LITTLE),
+                                "distance": view.getFloat32(sample + 16, LITTLE),
+                                "at": at,
+                            }
+                        }});
+                    } else if("pose" === channel) {
+                        records.push({message: "pose", data: {
+                            "pose": {
+                                "x": view.getFloat32(sample + 8, LITTLE),
+                                "y": view.getFloat32(sample + 12, LITTLE),
+                                "a": view.getFloat32(sample + 16, LITTLE),
+                                "at": at,
+                            }
+                        }});
+                    }
+                }
+                if(flags & TELEMETRY_HISTORY_LAST) {
+                    records.push({message: "history", data: {"channel": channel, "last": true}});
+                }
+                offset += 4 + 20 * count;
+                break;
+            }
+            default: {
+                console.warn(`decodeBinaryTelemetry: unknown record type ${type}`);
+                return records;
+            }
+        }
+    }
+    return records;
+}
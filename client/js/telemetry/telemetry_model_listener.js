@@ -206,3 +206,108 @@ function TelemetryModelListener(messageBus, msg, spec, model) {
     return self;
 }
 
+
+
+/**
+ * @summary Merges delta encoded telemetry into complete records.
+ * 
+ * @typedef {object} TelemetryDeltaMergerType
+ * @property {(channel: string, data: object) => object | undefined} merge
+ * @property {() => TelemetryDeltaMergerType} reset
+ */
+
+/**
+ * @summary Construct a merger for delta encoded telemetry.
+ * 
+ * @description
+ * Delta encoded telemetry carries a sequence number, "seq",
+ * and only the fields that changed since the prior record
+ * for the same source (like "left" or "right").  Keyframes
+ * also carry "key" and all of the fields.
+ * This keeps the last complete record for each source and
+ * merges each delta into it, so listeners always see
+ * complete records.  Records without "seq" are passed
+ * through unchanged.
+ * 
+ * Deltas are dropped until a keyframe arrives for the source.
+ * If a sequence number is skipped, then the merged
+ * record may be stale, so a "telemetry-keyframe-request"
+ * message is published with the channel so a keyframe
+ * can be requested from the rover.
+ * 
+ * @example
+ * ```
+ * const merged = merger.merge("wheel", {"left": {"seq": 12, "speed": 11.2, "at": 1234}});
+ * if(merged) messageBus.publish("telemetry", merged);
+ * ```
+ * 
+ * @param {MessageBusType} messageBus // IN : bus on which to publish keyframe requests
+ * @returns {TelemetryDeltaMergerType}
+ */
+function TelemetryDeltaMerger(messageBus = undefined) {
+    /** @type {Object.<string, object>} */
+    let _last = {};     // last complete record by channel and source
+
+    /**
+     * Merge a telemetry message.
+     * 
+     * @param {string} channel  // IN : telemetry channel, like "wheel"
+     * @param {object} data     // IN : telemetry, like {"left": {...}}
+     * @returns {object | undefined} // RET: data with complete records,
+     *                               //      or undefined if nothing to publish yet
+     */
+    function merge(channel, data) {
+        const merged = {};
+        let gap = false;
+        for(const [source, record] of Object.entries(data)) {
+            if(!record.hasOwnProperty("seq")) {
+                merged[source] = record;   // not delta encoded
+                continue;
+            }
+
+            const key = `${channel}.${source}`;
+            const last = _last[key];
+            if(record["key"]) {
+                // keyframe; start over
+                _last[key] = {...record};
+            } else if(last) {
+                if(((last["seq"] + 1) & 0xFF) !== record["seq"]) {
+                    gap = true;
+                }
+                _last[key] = {...last, ...record};
+            } else {
+                // we have nothing to merge into
+                gap = true;
+                continue;
+            }
+
+            const complete = {..._last[key]};
+            delete complete["seq"];
+            delete complete["key"];
+            merged[source] = complete;
+        }
+
+        if(gap && messageBus) {
+            messageBus.publish("telemetry-keyframe-request", channel);
+        }
+        return (Object.keys(merged).length > 0) ? merged : undefined;
+    }
+
+    /**
+     * Forget all records; call this when the connection is reset.
+     * 
+     * @returns {TelemetryDeltaMergerType} // RET: self for fluent chained api calls
+     */
+    function reset() {
+        _last = {};
+        return self;
+    }
+
+    /** @type {TelemetryDeltaMergerType} */
+    const self = Object.freeze({
+        "merge": merge,
+        "reset": reset,
+    });
+
+    return self;
+}
@@ -4,6 +4,8 @@
 /// <reference path="../control/turtle/turtle_keyboard_controller.js" />
 /// <reference path="../control/joystick/gamepad_view_controller.js" />
 /// <reference path="reset_telemetry_view_controller.js" />
+/// <reference path="../command/rover_command.js" />
+/// <reference path="../config/config.js" />
 
 
 /**
@@ -25,6 +27,9 @@
  * @param {ResetTelemetryViewControllerType} resetTelemetryViewController 
  * @param {CanvasViewControllerType} poseTelemetryViewController 
  * @param {ResetTelemetryViewControllerType} resetPoseViewController 
+ * @param {RoverCommanderType} roverCommand // optional; if provided then the rover is
+ *                                          // asked to slow telemetry for inactive charts
+ *                                          // and to backfill charts from it's history.
  * @returns {TelemetryViewManagerType}
  */
 function TelemetryViewManager(
@@ -32,7 +37,8 @@ function TelemetryViewManager(
     motorTelemetryViewController, 
     resetTelemetryViewController, 
     poseTelemetryViewController, 
-    resetPoseViewController) 
+    resetPoseViewController,
+    roverCommand = undefined) 
 {
     // we must have a message bus
     if (!messageBus) throw new Error();
@@ -43,9 +49,69 @@ function TelemetryViewManager(
     const MOTOR_DEACTIVATED = "TAB_DEACTIVATED(#motor-telemetry-container)";
     const POSE_ACTIVATED = "TAB_ACTIVATED(#pose-telemetry-container)";
     const POSE_DEACTIVATED = "TAB_DEACTIVATED(#pose-telemetry-container)";
+    const COMMAND_SOCKET_OPEN = "command-socket-open";
+    const TELEMETRY = "telemetry";
+    const POSE = "pose";
 
     let listening = 0;
 
+    //
+    // telemetry period we last asked for, by channel
+    //
+    /** @type {Object.<string, number>} */
+    const _channelPeriodMs = {
+        "wheel": config.activeTelemetryMs(),
+        "pose": config.activeTelemetryMs(),
+    };
+
+    //
+    // rover time of newest sample we have, by channel,
+    // and of newest sample when the chart was deactivated.
+    //
+    /** @type {Object.<string, number>} */
+    const _newestAt = {};
+    /** @type {Object.<string, number>} */
+    const _inactiveAt = {};
+
+    /**
+     * Track the newest sample time on a channel.
+     * 
+     * @param {string} channel 
+     * @param {any} sample  // like {"speed": 1.2, "at": 1234}
+     */
+    function _sampleAt(channel, sample) {
+        if(sample && (typeof sample["at"] === "number")) {
+            if(!(_newestAt[channel] >= sample["at"])) {
+                _newestAt[channel] = sample["at"];
+            }
+        }
+    }
+
+    /**
+     * Ask the rover for samples newer than the given time.
+     * 
+     * @param {TelemetryChannelName} channel 
+     * @param {number | undefined} sinceMs  // if undefined, we have no samples to backfill
+     */
+    function _backfill(channel, sinceMs) {
+        if(roverCommand && (typeof sinceMs === "number")) {
+            roverCommand.sendHistoryCommand(sinceMs, channel);
+        }
+    }
+
+    /**
+     * Ask the rover for the given telemetry rate on a channel.
+     * 
+     * @param {TelemetryChannelName} channel 
+     * @param {number} periodMs 
+     */
+    function _setTelemetryRate(channel, periodMs) {
+        _channelPeriodMs[channel] = periodMs;
+        if(roverCommand) {
+            roverCommand.sendTelemetryRateCommand(channel, periodMs);
+        }
+    }
+
     /**
      * @summary Start listening for messages.
      * 
@@ -72,6 +138,9 @@ function TelemetryViewManager(
             messageBus.subscribe(MOTOR_DEACTIVATED, self);
             messageBus.subscribe(POSE_ACTIVATED, self);
             messageBus.subscribe(POSE_DEACTIVATED, self);
+            messageBus.subscribe(COMMAND_SOCKET_OPEN, self);
+            messageBus.subscribe(TELEMETRY, self);
+            messageBus.subscribe(POSE, self);
         }
         return self;
     }
@@ -134,7 +203,8 @@ function TelemetryViewManager(
      * in order to coordinate them.
      * In particular, when a tab is activated
      * then start it listening and when it is deactivate
-     * then stop it listening.
+     * then stop it listening.  The rover is also asked
+     * to slow the telemetry for a deactivated tab.
      * >> CAUTION: this should not be called directly;
      *    only the message but should call it.
      * 
@@ -148,6 +218,9 @@ function TelemetryViewManager(
                     resetTelemetryViewController.startListening();
                     messageBus.publish("telemetry-update"); // for update of telemetry canvas
                 }
+                _setTelemetryRate("wheel", config.activeTelemetryMs());
+                _backfill("wheel", _inactiveAt["wheel"]);   // fill in what the slow rate skipped
+                delete _inactiveAt["wheel"];
                 return;
             }
             case MOTOR_DEACTIVATED: {
@@ -155,6 +228,8 @@ function TelemetryViewManager(
                     motorTelemetryViewController.stopListening();
                     resetTelemetryViewController.stopListening();
                 }
+                _setTelemetryRate("wheel", config.inactiveTelemetryMs());
+                _inactiveAt["wheel"] = _newestAt["wheel"];
                 return;
             }
             case POSE_ACTIVATED: {
@@ -163,6 +238,9 @@ function TelemetryViewManager(
                     resetPoseViewController.startListening();
                     messageBus.publish("pose-update"); // for update of pose canvas
                 }
+                _setTelemetryRate("pose", config.activeTelemetryMs());
+                _backfill("pose", _inactiveAt["pose"]);     // fill in what the slow rate skipped
+                delete _inactiveAt["pose"];
                 return;
             }
             case POSE_DEACTIVATED: {
@@ -170,6 +248,34 @@ function TelemetryViewManager(
                     poseTelemetryViewController.stopListening();
                     resetPoseViewController.stopListening();
                 }
+                _setTelemetryRate("pose", config.inactiveTelemetryMs());
+                _inactiveAt["pose"] = _newestAt["pose"];
+                return;
+            }
+            case COMMAND_SOCKET_OPEN: {
+                // rover starts each connection at full rate; restore our rates
+                for(const [channel, periodMs] of Object.entries(_channelPeriodMs)) {
+                    if(periodMs !== config.activeTelemetryMs()) {
+                        _setTelemetryRate(/** @type {TelemetryChannelName} */(channel), periodMs);
+                    }
+                }
+
+                // fill in what we missed while disconnected
+                _backfill("wheel", _newestAt["wheel"]);
+                _backfill("pose", _newestAt["pose"]);
+                return;
+            }
+            case TELEMETRY: {
+                if(data) {
+                    _sampleAt("wheel", data["left"]);
+                    _sampleAt("wheel", data["right"]);
+                }
+                return;
+            }
+            case POSE: {
+                if(data) {
+                    _sampleAt("pose", data["pose"]);
+                }
                 return;
             }
             default: {
@@ -0,0 +1,178 @@
+#include "camera_capture.h"
+#include "../error.h"
+
+#ifdef TESTING
+    #include <chrono>
+    #include <thread>
+#endif
+
+/**
+ * Attach dependencies
+ */
+CameraCapture& CameraCapture::attach(FrameSource &source) // IN : where frames come from
+                                                          // RET: this capture in attached state
+{
+    if(!attached()) {
+        _source = &source;
+    }
+
+    return *this;
+}
+
+/**
+ * Detach dependencies
+ */
+CameraCapture& CameraCapture::detach()    // RET: this capture in detached state
+{
+    if(attached()) {
+        stop();
+        _source = nullptr;
+    }
+
+    return *this;
+}
+
+/**
+ * Start the capture task on the core that loop()
+ * does not use; on the host there is no task,
+ * so poll() must be called instead.
+ */
+int CameraCapture::begin()    // RET: SUCCESS or FAILURE if the task could not be created
+{
+    #ifndef TESTING
+        if(NULL == _task) {
+            if(pdPASS != xTaskCreatePinnedToCore(_run, "cameraTask", CAMERA_TASK_STACK, this, 1, &_task, (1 == xPortGetCoreID()) ? 0 : 1)) {
+                _task = NULL;
+                return FAILURE;
+            }
+        }
+    #endif
+    return SUCCESS;
+}
+
+#ifndef TESTING
+/**
+ * Capture task; capture frames while
+ * streaming and idle while not.  Grabbing
+ * a frame blocks until the camera has one,
+ * which lets the other tasks run.
+ */
+void CameraCapture::_run(void *params)    // IN : the CameraCapture
+{
+    CameraCapture *capture = (CameraCapture *)params;
+    for(;;) {
+        if(!capture->poll()) {
+            vTaskDelay(pdMS_TO_TICKS(CAMERA_IDLE_MS));
+        }
+    }
+}
+#endif
+
+/**
+ * Start capturing frames
+ */
+CameraCapture& CameraCapture::start()     // RET: this capture
+{
+    _capturing.store(attached(), std::memory_order_relaxed);
+    return *this;
+}
+
+/**
+ * Stop capturing frames and give back any
+ * frame that was not taken.
+ *
+ * NOTE: only call from the consumer side.
+ */
+CameraCapture& CameraCapture::stop()      // RET: this capture
+{
+    _capturing.store(false, std::memory_order_relaxed);
+    return release(take());
+}
+
+/**
+ * Capture one frame and post it for the sender,
+ * if streaming or a snapshot was asked for.
+ *
+ * NOTE: only call from the producer side.
+ */
+bool CameraCapture::poll()    // RET: true if a frame was posted,
+                              //      false if not capturing or the grab failed
+{
+    const bool snapshot = _snapshot.exchange(false, std::memory_order_relaxed);
+    if(!capturing() && !snapshot) {
+        return false;
+    }
+
+    CameraFrame *frame = _source->grab();
+    if(nullptr == frame) {
+        _failures.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // if streaming stopped while grabbing, don't post the frame
+    if(!capturing() && !snapshot) {
+        _source->release(frame);
+        return false;
+    }
+
+    // the sender never saw the frame this replaces, so give it back
+    CameraFrame *replaced = _mailbox.post(frame);
+    if(nullptr != replaced) {
+        _source->release(replaced);
+    }
+    return true;
+}
+
+/**
+ * Take the newest captured frame; it
+ * must be released once it is sent.
+ *
+ * NOTE: only call from the consumer side.
+ */
+CameraFrame *CameraCapture::take()    // RET: frame or nullptr if no new frame is ready
+{
+    return _mailbox.take();
+}
+
+/**
+ * Take the next captured frame, asking the
+ * capture task for one if no one is streaming.
+ *
+ * NOTE: only call from the consumer side.
+ */
+CameraFrame *CameraCapture::snapshot(unsigned long timeoutMs)  // IN : most milliseconds to wait
+                                                               // RET: frame or nullptr if none was captured in time
+{
+    if(!attached()) {
+        return nullptr;
+    }
+    if(!capturing()) {
+        // a frame left by a snapshot that timed out is stale
+        release(take());
+        _snapshot.store(true, std::memory_order_relaxed);
+    }
+
+    for(unsigned long waitedMs = 0; ; waitedMs += 1) {
+        CameraFrame *frame = take();
+        if((nullptr != frame) || (waitedMs >= timeoutMs)) {
+            return frame;
+        }
+        #ifdef TESTING
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        #else
+            vTaskDelay(pdMS_TO_TICKS(1));
+        #endif
+    }
+}
+
+/**
+ * Give back a frame from take()
+ */
+CameraCapture& CameraCapture::release(CameraFrame *frame)  // IN : frame from take() or nullptr
+                                                           // RET: this capture
+{
+    if((nullptr != frame) && attached()) {
+        _source->release(frame);
+    }
+    return *this;
+}
@@ -0,0 +1,183 @@
+#ifndef CAMERA_CAMERA_CAPTURE_H
+#define CAMERA_CAMERA_CAPTURE_H
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../config.h"
+#include "../util/mailbox.h"
+
+//
+// a captured JPEG image; on the rover this is
+// the camera driver's frame buffer, so frames
+// are streamed without copying them.
+//
+#ifdef TESTING
+    typedef struct CameraFrame {
+        uint8_t *buf;   // JPEG image
+        size_t len;     // bytes in image
+    } CameraFrame;
+#else
+    #include "esp_camera.h"
+    typedef camera_fb_t CameraFrame;
+#endif
+
+/**
+ * Where frames come from; the camera on the rover,
+ * or JPEG files when the pipeline runs on the host.
+ */
+class FrameSource {
+    public:
+
+    virtual ~FrameSource() {}
+
+    /**
+     * Capture a JPEG frame; this may block
+     * until the camera has one ready.
+     */
+    virtual CameraFrame *grab() = 0;    // RET: frame owned by the caller or nullptr on failure
+
+    /**
+     * Give a frame back to the source;
+     * this may be called from any task.
+     */
+    virtual void release(CameraFrame *frame) = 0;   // IN : frame from grab()
+};
+
+/**
+ * Capture camera frames in their own task so
+ * that waiting on the camera never stalls motor
+ * control or command handling.
+ *
+ * The capture task is the producer; it grabs
+ * frames and posts them to a Mailbox.  The stream
+ * socket is the consumer; it takes the newest
+ * frame, sends it and releases it.  If the sender
+ * falls behind, the frame it never took is
+ * replaced by a newer one and given back to the
+ * source, so the sender always gets the newest
+ * frame and the camera's buffers are never all
+ * held waiting to be sent.  Single images are
+ * captured by the task too, with snapshot(), so
+ * it is the only user of the camera.
+ *
+ * On the host there is no task; a test thread
+ * calls poll() to run the producer side.
+ */
+class CameraCapture {
+    private:
+    FrameSource *_source = nullptr;
+    Mailbox<CameraFrame> _mailbox;          // newest frame, handed from capture to sender
+    std::atomic<bool> _capturing;           // true while someone is streaming
+    std::atomic<bool> _snapshot;            // true when a single frame is asked for
+    std::atomic<unsigned int> _failures;    // grabs that did not return a frame
+
+    #ifndef TESTING
+        TaskHandle_t _task = NULL;
+
+        /**
+         * Capture task; capture frames while
+         * streaming and idle while not.
+         */
+        static void _run(void *params);     // IN : the CameraCapture
+    #endif
+
+    public:
+
+    CameraCapture()
+        : _capturing(false), _snapshot(false), _failures(0)
+    {
+        // no-op
+    }
+
+    /**
+     * Deteremine if dependencies are attached
+     */
+    bool attached() { return nullptr != _source; }
+
+    /**
+     * Attach dependencies
+     */
+    CameraCapture& attach(FrameSource &source); // IN : where frames come from
+                                                // RET: this capture in attached state
+
+    /**
+     * Detach dependencies
+     */
+    CameraCapture& detach();    // RET: this capture in detached state
+
+    /**
+     * Start the capture task; on the host there is
+     * no task, so poll() must be called instead.
+     */
+    int begin();    // RET: SUCCESS or FAILURE if the task could not be created
+
+    /**
+     * Start capturing frames
+     */
+    CameraCapture& start();     // RET: this capture
+
+    /**
+     * Stop capturing frames and give back any
+     * frame that was not taken.
+     *
+     * NOTE: only call from the consumer side.
+     */
+    CameraCapture& stop();      // RET: this capture
+
+    bool capturing() { return _capturing.load(std::memory_order_relaxed); }
+
+    /**
+     * Capture one frame and post it for the sender,
+     * if streaming or a snapshot was asked for;
+     * the capture task calls this continuously.
+     *
+     * NOTE: only call from the producer side.
+     */
+    bool poll();    // RET: true if a frame was posted,
+                    //      false if not capturing or the grab failed
+
+    /**
+     * Take the newest captured frame; it
+     * must be released once it is sent.
+     *
+     * NOTE: only call from the consumer side.
+     */
+    CameraFrame *take();    // RET: frame or nullptr if no new frame is ready
+
+    /**
+     * Take the next captured frame, asking the capture
+     * task for one if no one is streaming, so single
+     * images don't use the camera behind the task's
+     * back.  It must be released once it is sent.
+     *
+     * NOTE: only call from the consumer side;
+     *       this waits until a frame is ready.
+     *       The stream socket and /capture may
+     *       both take frames; take() is an atomic
+     *       exchange, so each goes to only one.
+     */
+    CameraFrame *snapshot(unsigned long timeoutMs);  // IN : most milliseconds to wait
+                                                     // RET: frame or nullptr if none was captured in time
+
+    /**
+     * Give back a frame from take()
+     */
+    CameraCapture& release(CameraFrame *frame);  // IN : frame from take() or nullptr
+                                                 // RET: this capture
+
+    unsigned int captured() {   // RET: frames posted for the sender
+        return _mailbox.count();
+    }
+
+    unsigned int dropped() {    // RET: frames replaced before the sender took them
+        return _mailbox.dropped();
+    }
+
+    unsigned int failures() {   // RET: grabs that failed
+        return _failures.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // CAMERA_CAMERA_CAPTURE_H
@@ -66,8 +66,7 @@ int initCamera()
         esp_err_t err = esp_camera_init(&config);
         if (err != ESP_OK)
         {
-            LOG_ERROR("Camera init failed with error 0x");
-            LOG_ERROR(err);
+            LOGT_ERROR(LOG_CAMERA_INIT_FAILED, (int)err);
             return -1;
         }
 
@@ -113,7 +112,7 @@ int processImage(
         size_t jpg_buf_len;
         if (!fb)
         {
-            LOG_ERROR("Camera capture failed");
+            LOGT_ERROR(LOG_CAMERA_CAPTURE_FAILED);
             res = ESP_FAIL;
         }
         else
@@ -124,7 +123,7 @@ int processImage(
                 fb = NULL;
                 if (!jpeg_converted)
                 {
-                    LOG_ERROR("JPEG compression failed");
+                    LOGT_ERROR(LOG_CAMERA_JPEG_FAILED);
                     res = ESP_FAIL;
                 }
             }
@@ -147,52 +146,46 @@ int processImage(
     #endif
 }
 
-
-//
-// grap and image and fill the camera buffer with it
-// TODO: update to prevent buffer overun if provided
-//       buffer is too small.
-//
-esp_err_t grabImage(size_t &jpg_buf_len, uint8_t *jpg_buf)
+/**
+ * Capture a JPEG frame; this blocks
+ * until the camera has one ready.
+ * The camera is set up for JPEG, so
+ * other formats are not converted.
+ */
+CameraFrame *Esp32FrameSource::grab()    // RET: frame owned by the caller or nullptr on failure
 {
     #ifdef ENABLE_CAMERA
-        esp_err_t res = ESP_OK;
-        camera_fb_t *fb = NULL;
-        fb = esp_camera_fb_get();
-        uint8_t *jpg_buf_tmp = NULL;
+        camera_fb_t *fb = esp_camera_fb_get();
         if (!fb)
         {
-            LOG_ERROR("Camera capture failed");
-            res = ESP_FAIL;
+            LOGT_ERROR(LOG_CAMERA_CAPTURE_FAILED);
+            return nullptr;
         }
-        else
+        if (fb->format != PIXFORMAT_JPEG)
         {
-            if (fb->format != PIXFORMAT_JPEG)
-            {
-                bool jpeg_converted = frame2jpg(fb, 80, &jpg_buf_tmp, &jpg_buf_len);
-                memcpy(jpg_buf, jpg_buf_tmp, jpg_buf_len);
-                fb = NULL;
-                if (!jpeg_converted)
-                {
-                    LOG_ERROR("JPEG compression failed");
-                    res = ESP_FAIL;
-                }
-            }
-            else
-            {
-                jpg_buf_len = fb->len;
-                memcpy(jpg_buf, fb->buf, jpg_buf_len);
-                // SERIAL_PRINTLN("Image is in jpg format");
-            }
+            LOGT_ERROR(LOG_CAMERA_JPEG_FAILED);
             esp_camera_fb_return(fb);
+            return nullptr;
         }
-        return res;
+        return fb;
     #else
-        return ESP_FAIL;
+        return nullptr;
     #endif
+}
 
+/**
+ * Give a frame back to the camera driver
+ */
+void Esp32FrameSource::release(CameraFrame *frame)   // IN : frame from grab()
+{
+    #ifdef ENABLE_CAMERA
+        if (nullptr != frame) {
+            esp_camera_fb_return(frame);
+        }
+    #endif
 }
 
+
 //
 // set the value of a camera property
 //
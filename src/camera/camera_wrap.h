@@ -5,11 +5,31 @@
 #include <string.h>
 
 #include "esp_camera.h"
+#include "camera_capture.h"
 
 extern int initCamera();
 int processImage(int (*processor)(uint8_t *, size_t));
-extern esp_err_t grabImage( size_t& jpg_buf_len, uint8_t *jpg_buf);
 extern String getCameraPropertiesJson();
 extern int setCameraProperty(String varParam, String valParam);
 
+/**
+ * FrameSource for the ESP32 camera; frames are
+ * the driver's own frame buffers, so they are
+ * streamed without copying.
+ */
+class Esp32FrameSource : public FrameSource {
+    public:
+
+    /**
+     * Capture a JPEG frame; this blocks
+     * until the camera has one ready.
+     */
+    CameraFrame *grab();    // RET: frame owned by the caller or nullptr on failure
+
+    /**
+     * Give a frame back to the camera driver
+     */
+    void release(CameraFrame *frame);   // IN : frame from grab()
+};
+
 #endif // CAMERA_CAMERA_WRAP_H
\ No newline at end of file
@@ -3,8 +3,19 @@
 
 #include "./util/math.h"
 
-typedef float distance_type;    // from pose.h
-typedef float speed_type;       // from drive_wheel.h
+//
+// USE_FIXED_POINT swaps the Q15.16 fixed point type in
+// util/fixed_point.h in for distances and speeds, for
+// processors without a fast FPU; otherwise they are float.
+//
+#ifdef USE_FIXED_POINT
+    #include "./util/fixed_point.h"
+    typedef Fixed<16> distance_type;    // from pose.h
+    typedef Fixed<16> speed_type;       // from drive_wheel.h
+#else
+    typedef float distance_type;    // from pose.h
+    typedef float speed_type;       // from drive_wheel.h
+#endif
 typedef long encoder_count_type;// from encoder.h
 
 //
@@ -39,9 +50,63 @@ const encoder_count_type CONTROL_MIN_ENCODER_COUNT = PULSES_PER_REVOLUTION / 4;
 const unsigned int CONTROL_SETTLE_MS = 20;     // number of milliseconds after changing direction that we
                                                // we continue to integrate encoder ticks in the prior direction
                                                // in order to handle inertia.
+const speed_type WHEEL_MAX_ACCELERATION = 100;  // cm/sec² limit on change in target speed; 0 for no limit
+const speed_type WHEEL_MAX_JERK = 1000;         // cm/sec³ limit on change in acceleration; 0 for no limit
+const float WHEEL_MAX_PWM_RATE = 1000;          // pwm/sec limit on change in power; 0 for no limit
+const float WHEEL_MAX_PWM_JERK = 10000;         // pwm/sec² limit on change in power rate; 0 for no limit
+const float WHEEL_SYNC_KP = 0.5;                // speed trim in cm/sec per cm one wheel is ahead of the other; 0 and 0 is off
+const float WHEEL_SYNC_KI = 0.0;                // speed trim in cm/sec per cm·sec one wheel has been ahead
+const float WHEEL_SYNC_MAX_TRIM = 0.25;         // largest trim as a fraction of the wheel's setpoint
 // pose
 const unsigned int POSE_POLL_MS = 20;        // how often to run pose estimation
-const encoder_count_type POSE_MIN_ENCODER_COUNT = CONTROL_MIN_ENCODER_COUNT;     // travel at least 1/5 turn before updating pose
+const encoder_count_type POSE_MIN_ENCODER_COUNT = CONTROL_MIN_ENCODER_COUNT;     // travel at least 1/4 turn before updating pose velocity
+const distance_type POSE_ARC_MIN_ANGLE = 0.0001;    // radians; smaller turns are integrated as a straight line
+const distance_type POSE_LEFT_SLIP = 0.01;     // variance of left wheel distance per distance travelled
+const distance_type POSE_RIGHT_SLIP = 0.01;    // variance of right wheel distance per distance travelled
+const unsigned int POSE_HISTORY_COUNT = 64;    // poses kept for lookup by time; a power of two
+const unsigned int POSE_PREDICT_MAX_MS = 250;  // longest time to extrapolate pose without an encoder tick;
+                                               // after that the rover is assumed to have stopped
+
+// goto goal behavior
+typedef enum GotoGoalTick {
+    GOTO_TICK_ON_POSE,      // run behavior when a new pose is published
+    GOTO_TICK_FIXED_RATE,   // run behavior every GOTO_TICK_MS on a predicted pose
+} GotoGoalTick;
+const GotoGoalTick GOTO_TICK_POLICY = GOTO_TICK_FIXED_RATE;
+const unsigned int GOTO_TICK_MS = CONTROL_POLL_MS;  // how often to run behavior with GOTO_TICK_FIXED_RATE
+typedef enum GotoGoalSteer {
+    GOTO_STEER_TURN_THEN_DRIVE, // turn in place toward the goal, then drive to it
+    GOTO_STEER_BLENDED,         // turn while driving with one point forward controller
+} GotoGoalSteer;
+const GotoGoalSteer GOTO_STEER_POLICY = GOTO_STEER_BLENDED;
+const distance_type GOTO_SLOWDOWN_DISTANCE = 30;    // cm from goal at which the blended controller starts to slow
+const speed_type GOTO_MAX_TURN_RATE = 3;            // radians/sec; fastest the blended controller turns, so the wheels can follow
+
+// path follow behavior
+const unsigned int PATH_MAX_WAYPOINTS = 16;     // most waypoints in an uploaded path
+const distance_type PATH_LOOKAHEAD = 20;        // cm along the path ahead of the rover that pure pursuit steers toward
+
+// waypoint recorder
+const unsigned int WAYPOINT_RECORDER_COUNT = 256;   // most waypoints recorded; 4 bytes each
+const unsigned int WAYPOINT_WINDOW_COUNT = 32;      // most poses checked against the line between waypoints;
+                                                    // every other one is dropped when there are more
+const distance_type WAYPOINT_TOLERANCE = 2;         // cm the recorded path may stray from the driven path;
+                                                    // doubles each time the recorder fills up
+const distance_type WAYPOINT_MIN_SPACING = 1;       // cm a pose must move to be considered
+
+// occupancy grid map, centered on where the rover starts
+const unsigned int MAP_COLUMNS = 512;           // cells across; must be a multiple of 16
+const unsigned int MAP_ROWS = 512;              // cells up and down; 512 x 512 is 64KB in PSRAM, twice that with the upload buffer
+const unsigned int MAP_HEAP_COLUMNS = 128;      // cells across if there is no PSRAM; 4KB
+const unsigned int MAP_HEAP_ROWS = 128;
+const distance_type MAP_CELL_SIZE = 5;          // cm along each side of a cell
+
+// path planner on the occupancy grid
+const unsigned int PLANNER_HEAP_COUNT = 16384;      // open cells the planner can queue; 8 bytes each, in PSRAM
+const unsigned int PLANNER_HEAP_HEAP_COUNT = 1024;  // open cells if there is no PSRAM
+const unsigned int PLANNER_BUDGET_US = 2000;        // most time the planner searches per poll, so it never stalls motor control
+const unsigned int PLANNER_BATCH = 32;              // cells expanded between checks of the time budget
+const distance_type PLANNER_CLEARANCE = 7;          // cm the planned path keeps from occupied cells; about half the rover's width
 
 
 // const float WHEEL_CIRCUMFERENCE = 1.0;  // distance is revolutions, speed is revolutions/sec
@@ -50,6 +115,34 @@ const float WHEEL_DIAMETER_CM = 6.97;   // centimeters
 const float WHEEL_CIRCUMFERENCE = WHEEL_DIAMETER_CM * PI;  // distance is cm, speed is cm/sec
 const distance_type WHEELBASE = 13.5;   // centimeters
 
+// telemetry
+const unsigned int TELEMETRY_FRAME_BYTES = 512; // maximum size of a batched telemetry frame
+const unsigned int TELEMETRY_FRAME_MS = 0;      // minimum time between telemetry frames; 0 sends a frame every poll
+const unsigned int TELEMETRY_KEYFRAME_INTERVAL = 25;    // with delta telemetry, send all fields at least every n records
+const unsigned int TELEMETRY_LOSS_MS = 1000;    // minimum time between reports of dropped telemetry
+const unsigned int TELEMETRY_HISTORY_RECORDS = 32768;       // wheel and pose samples kept in PSRAM; 640KB, about 3.5 minutes of driving
+const unsigned int TELEMETRY_HISTORY_HEAP_RECORDS = 512;    // samples kept if there is no PSRAM; 10KB
+const unsigned int TELEMETRY_HISTORY_SCAN = 256;            // most history samples examined per poll
+const unsigned int TELEMETRY_BRIDGE_COUNT = 32; // captured telemetry in flight between cores; must be a power of two
+const unsigned int COMMAND_RING_COUNT = 8;      // commands in flight from network core to control core; must be a power of two
+
+// flight recorder
+const unsigned int FLIGHT_BLOCK_BYTES = 2048;   // records are buffered and written a block at a time
+const unsigned int FLIGHT_BLOCK_COUNT = 4;      // number of blocks; must be a power of two
+const unsigned int FLIGHT_FLUSH_MS = 1000;      // longest time a record is buffered before it's block is written
+const unsigned int FLIGHT_WRITE_BYTES = 256;    // most bytes written per poll, so a poll never blocks for a whole block
+const unsigned int FLIGHT_INDEX_ENTRIES = 1024; // blocks indexed by time; more are written, but not indexed
+const unsigned long FLIGHT_LOG_MAX_BYTES = 1024UL * 1024UL;     // stop writing when the log reaches this size
+
+// camera capture task
+const unsigned int CAMERA_TASK_STACK = 4096;    // bytes of stack for the task that captures camera frames
+const unsigned int CAMERA_IDLE_MS = 20;         // time the capture task sleeps while no one is streaming
+const unsigned int CAMERA_SNAPSHOT_MS = 1000;   // longest time /capture waits on the capture task for an image
+
+// tokenized logging
+const unsigned int TOKEN_LOG_RECORDS = 64;      // log records waiting to be sent; must be a power of two
+const unsigned int TOKEN_LOG_DRAIN = 4;         // most log records formatted per telemetry poll
+
 const distance_type POINT_FORWARD_FRACTION = 0.75;  // position of forward control point as fraction of wheelbase
 
 #endif // CONFIG_H
\ No newline at end of file
@@ -17,6 +17,19 @@
 #define LOG_INFO(_msg_)    do{/* no-op */}while(0)
 #define LOG_DEBUG(_msg_)   do{/* no-op */}while(0)
 
+//
+// Tokenized logging; see token_log.h.
+// These take a LogToken from log_tokens.h and up to
+// TOKEN_LOG_ARGS numeric arguments, like;
+// LOGT_INFO(LOG_COMMAND_CONNECTED, clientNum);
+// The message is formatted where the log is read,
+// so they are cheap enough to use in the control loop.
+//
+#define LOGT_ERROR(...)   do{/* no-op */}while(0)
+#define LOGT_WARNING(...) do{/* no-op */}while(0)
+#define LOGT_INFO(...)    do{/* no-op */}while(0)
+#define LOGT_DEBUG(...)   do{/* no-op */}while(0)
+
 
 #ifdef LOG_LEVEL
     #ifdef Arduino_h
@@ -43,6 +56,24 @@
             #define LOG_DEBUG(_msg_) LOG_MESSAGE("DEBUG: ", _msg_)
         #endif
     #endif
+
+    #include "token_log.h"
+    #if (LOG_LEVEL <= ERROR_LEVEL)
+        #undef LOGT_ERROR
+        #define LOGT_ERROR(...) tokenLog.log(ERROR_LEVEL, __VA_ARGS__)
+    #endif
+    #if (LOG_LEVEL <= WARN_LEVEL)
+        #undef LOGT_WARNING
+        #define LOGT_WARNING(...) tokenLog.log(WARN_LEVEL, __VA_ARGS__)
+    #endif
+    #if (LOG_LEVEL <= INFO_LEVEL)
+        #undef LOGT_INFO
+        #define LOGT_INFO(...) tokenLog.log(INFO_LEVEL, __VA_ARGS__)
+    #endif
+    #if (LOG_LEVEL <= DEBUG_LEVEL)
+        #undef LOGT_DEBUG
+        #define LOGT_DEBUG(...) tokenLog.log(DEBUG_LEVEL, __VA_ARGS__)
+    #endif
 #endif
 
 #endif // LOG_H
\ No newline at end of file
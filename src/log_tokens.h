@@ -0,0 +1,62 @@
+#ifndef LOG_TOKENS_H
+#define LOG_TOKENS_H
+
+//
+// Format strings for tokenized logging (see token_log.h).
+//
+// The rover only sends a token and the raw argument
+// values; the format string is looked up and applied
+// where the log is read, so the string never needs to
+// be built on the rover.
+//
+// Each entry is LOG_TOKEN(name, format).
+// - tokens are numbered in the order listed, so only
+//   append new entries and never reorder or remove one,
+//   or logs that were already recorded will be misread.
+// - formats take up to TOKEN_LOG_ARGS arguments using
+//   %d, %i, %u, %x, %X, %c, %f or %g conversions
+//   with optional flags, width and precision; strings
+//   can not be logged.
+// - run tools/log_tokens_js.sh after editing this table
+//   so the browser client formats the same way.
+//
+#define LOG_TOKEN_TABLE(LOG_TOKEN) \
+    LOG_TOKEN(LOG_TOKEN_DROPPED,            "%u log records dropped") \
+    LOG_TOKEN(LOG_SETUP_STARTED,            "Setting up...") \
+    LOG_TOKEN(LOG_WIFI_FAILED,              "WiFi Failed!") \
+    LOG_TOKEN(LOG_HTTP_INITIALIZED,         "... http server intialized ...") \
+    LOG_TOKEN(LOG_WEBSOCKETS_INITIALIZED,   "... websockets server intialized ...") \
+    LOG_TOKEN(LOG_ROVER_INITIALIZED,        "...Rover Initialized...") \
+    LOG_TOKEN(LOG_HISTORY_ALLOCATION_FAILED, "Telemetry history could not be allocated") \
+    LOG_TOKEN(LOG_FLIGHT_LOG_FAILED,        "Flight log could not be created") \
+    LOG_TOKEN(LOG_FLIGHT_SPIFFS_FAILED,     "SPIFFS could not be mounted for the flight log") \
+    LOG_TOKEN(LOG_HANDLE_INDEX,             "handling /") \
+    LOG_TOKEN(LOG_HANDLE_BUNDLE_CSS,        "handling /bundle.css") \
+    LOG_TOKEN(LOG_HANDLE_BUNDLE_JS,         "handling /bundle.js") \
+    LOG_TOKEN(LOG_HANDLE_HEALTH,            "handling /health") \
+    LOG_TOKEN(LOG_HANDLE_CAPTURE,           "handling /capture") \
+    LOG_TOKEN(LOG_HANDLE_STATUS,            "handling /status") \
+    LOG_TOKEN(LOG_HANDLE_CONTROL,           "handling /control") \
+    LOG_TOKEN(LOG_CAMERA_PROPERTY_FAILED,   "Failure setting camera property") \
+    LOG_TOKEN(LOG_CAMERA_INIT_FAILED,       "Camera init failed with error 0x%x") \
+    LOG_TOKEN(LOG_CAMERA_CAPTURE_FAILED,    "Camera capture failed") \
+    LOG_TOKEN(LOG_CAMERA_JPEG_FAILED,       "JPEG compression failed") \
+    LOG_TOKEN(LOG_STREAM_IMAGE_FAILED,      "Failure grabbing and sending image.") \
+    LOG_TOKEN(LOG_STREAM_CONNECTED,         "wsStreamEvent.WS_EVT_CONNECT, clientId: %d") \
+    LOG_TOKEN(LOG_STREAM_DISCONNECTED,      "wsStreamEvent.WS_EVT_DISCONNECT, clientId: %d") \
+    LOG_TOKEN(LOG_STREAM_PONG,              "wsStreamEvent.WStype_PONG, clientId: %d") \
+    LOG_TOKEN(LOG_STREAM_BINARY,            "wsStreamEvent.WStype_BIN, clientId: %d") \
+    LOG_TOKEN(LOG_STREAM_TEXT,              "wsStreamEvent.WStype_TEXT, clientId: %d, %u bytes") \
+    LOG_TOKEN(LOG_STREAM_UNHANDLED,         "wsStreamEvent.UNHANDLED EVENT %d, clientId: %d") \
+    LOG_TOKEN(LOG_COMMAND_CONNECTED,        "wsCommandEvent.WS_EVT_CONNECT, clientId: %d") \
+    LOG_TOKEN(LOG_COMMAND_DISCONNECTED,     "wsCommandEvent.WS_EVT_DISCONNECT, clientId: %d") \
+    LOG_TOKEN(LOG_COMMAND_PONG,             "wsCommandEvent.WStype_PONG, clientId: %d") \
+    LOG_TOKEN(LOG_COMMAND_BINARY,           "wsCommandEvent.WStype_BIN, clientId: %d") \
+    LOG_TOKEN(LOG_COMMAND_TEXT,             "wsCommandEvent.WStype_TEXT, clientId: %d, %u bytes") \
+    LOG_TOKEN(LOG_COMMAND_UNHANDLED,        "wsCommandEvent.UNHANDLED EVENT %d, clientId: %d") \
+    LOG_TOKEN(LOG_MAP_ALLOCATION_FAILED,    "Occupancy grid could not be allocated") \
+    LOG_TOKEN(LOG_HANDLE_MAP,               "handling /map") \
+    LOG_TOKEN(LOG_PLANNER_ALLOCATION_FAILED, "Path planner could not be allocated") \
+    LOG_TOKEN(LOG_CAMERA_TASK_FAILED,       "Camera capture task could not be created")
+
+#endif // LOG_TOKENS_H
@@ -24,13 +24,24 @@
 #include "encoder/encoder.h"
 #include "wheel/drive_wheel.h"
 #include "telemetry.h"
+#include "telemetry_bridge.h"
+#include "util/spsc_ring.h"
+#ifdef USE_FLIGHT_RECORDER
+    #include <SPIFFS.h>
+    #include "recorder/flight_recorder.h"
+    #include "recorder/flight_wheel_listener.h"
+#endif
 
 //
 // control pins for the L9110S motor controller
 //
 #include "rover/rover.h"
 #include "rover/goto_goal.h"
+#include "rover/path_follow.h"
+#include "rover/waypoint_recorder.h"
 #include "rover/rover_command.h"
+#include "map/occupancy_grid.h"
+#include "map/path_planner.h"
 
 //
 // wheel encoders use same pins as the serial port,
@@ -53,6 +64,7 @@ bool builtInLedOn = false;
 //
 #define LOG_LEVEL INFO_LEVEL
 #include "log.h"
+#include "token_log.h"
 
 //
 // put ssid and password in wifi_credentials.h
@@ -75,6 +87,9 @@ void healthHandler(AsyncWebServerRequest *request);
 // 404 not found handler
 void notFound(AsyncWebServerRequest *request);
 
+// blink led on wheel rotation
+void pollBuiltInLed();
+
 //
 // Create all the parts for the rover.
 // It's CRITICAL that PwmChannels exist for life of the motor instance
@@ -83,6 +98,26 @@ void notFound(AsyncWebServerRequest *request);
 MessageBus messageBus;
 TelemetrySender telemetry;
 
+// camera frames are captured in their own task and sent by the stream socket and /capture
+Esp32FrameSource cameraSource;
+CameraCapture cameraCapture;    // used by stream_socket.cpp and captureHandler()
+
+#ifdef USE_CONTROL_TASK
+    //
+    // control runs in loop() on the application core and
+    // networking runs in its own task on the other core.
+    // - telemetry is captured on the control core and flows
+    //   control -> network over the bridge to be formatted and sent
+    // - parsed commands flow network -> control over the command ring
+    //   and their status flows back over the ack ring
+    //
+    TelemetryBridge telemetryBridge;    // captured telemetry; control -> network
+    SpscRing<QueuedCommand, COMMAND_RING_COUNT> commandRing;   // network -> control, used by command_socket.cpp
+    SpscRing<CommandAck, COMMAND_RING_COUNT> ackRing;          // control -> network, used by command_socket.cpp
+    TaskHandle_t networkTaskHandle = NULL;
+    void networkTask(void *params);
+#endif
+
 // left drive wheel
 PwmChannel leftForwardPwm(A1_A_PIN, LEFT_FORWARD_CHANNEL, MotorL9110s::pwmBits());
 PwmChannel leftReversePwm(A1_B_PIN, LEFT_REVERSE_CHANNEL, MotorL9110s::pwmBits());
@@ -113,6 +148,25 @@ RoverCommandProcessor roverCommandProcessor;
 
 // rover behaviors
 GotoGoalBehavior gotoGoalBehavior;
+PathFollowBehavior pathFollowBehavior;
+WaypointRecorder waypointRecorder;    // records driven paths and plays them back
+
+// map of where the rover has been, for path planning
+OccupancyGrid occupancyGrid;
+int mapUploadStatus = SUCCESS;      // status of the last /map upload
+PathPlanner pathPlanner;            // plans paths across the map and drives them
+
+#ifdef USE_FLIGHT_RECORDER
+    //
+    // record commands, wheel power, encoders and pose to flash
+    // for replay on the host with tools/flight_replay.cpp.
+    // The SD card shares pins with the motor controller,
+    // so the log goes to SPIFFS.
+    //
+    FlightRecorder flightRecorder;
+    FlightWheelListener flightWheelListener;
+    const char *FLIGHT_LOG_FILE = "/flight.log";   // path within SPIFFS
+#endif
 
 // create the http server
 AsyncWebServer server(80);
@@ -132,7 +186,7 @@ void setup()
     SERIAL_DEBUG(true);
     SERIAL_PRINTLN();
 
-    LOG_INFO("Setting up...");
+    LOGT_INFO(LOG_SETUP_STARTED);
 
     // 
     // init wifi
@@ -141,7 +195,7 @@ void setup()
     WiFi.begin(ssid, password);
     if (WiFi.waitForConnectResult() != WL_CONNECTED)
     {
-        LOG_ERROR("WiFi Failed!\n");
+        LOGT_ERROR(LOG_WIFI_FAILED);
         return;
     }
 
@@ -156,19 +210,19 @@ void setup()
 
     // endpoints to return the compressed html/css/javascript for the browser web application
     server.on("/", HTTP_GET, [](AsyncWebServerRequest *request) {
-        LOG_INFO("handling " + request->url());
+        LOGT_INFO(LOG_HANDLE_INDEX);
         AsyncWebServerResponse *response = request->beginResponse_P(200, "text/html", index_html_gz, sizeof(index_html_gz));
         response->addHeader("Content-Encoding", "gzip");
         request->send(response);
     });
     server.on("/bundle.css", HTTP_GET, [](AsyncWebServerRequest *request) {
-        LOG_INFO("handling " + request->url());
+        LOGT_INFO(LOG_HANDLE_BUNDLE_CSS);
         AsyncWebServerResponse *response = request->beginResponse_P(200, "text/css", bundle_css_gz, sizeof(bundle_css_gz));
         response->addHeader("Content-Encoding", "gzip");
         request->send(response);
     });
     server.on("/bundle.js", HTTP_GET, [](AsyncWebServerRequest *request) {
-        LOG_INFO("handling " + request->url());
+        LOGT_INFO(LOG_HANDLE_BUNDLE_JS);
         AsyncWebServerResponse *response = request->beginResponse_P(200, "text/javascript", bundle_js_gz, sizeof(bundle_js_gz));
         response->addHeader("Content-Encoding", "gzip");
         request->send(response);
@@ -177,6 +231,41 @@ void setup()
     // endpoint to check server health
     server.on("/health", HTTP_GET, healthHandler);
 
+    //
+    // endpoints to download and upload the occupancy grid as a binary blob;
+    // it is streamed a chunk at a time, so it never needs to be copied.
+    // the control core may mark cells while this runs, which
+    // at worst sends a cell as it was just before it changed.
+    // an upload is staged and swapped in by loop() once it is whole.
+    //
+    server.on("/map", HTTP_GET, [](AsyncWebServerRequest *request) {
+        LOGT_INFO(LOG_HANDLE_MAP);
+        AsyncWebServerResponse *response = request->beginResponse("application/octet-stream", occupancyGrid.blobSize(),
+            [](uint8_t *buffer, size_t maxLen, size_t index) -> size_t {
+                return occupancyGrid.download(buffer, maxLen, index);
+            });
+        request->send(response);
+    });
+    server.on("/map", HTTP_POST,
+        [](AsyncWebServerRequest *request) {
+            LOGT_INFO(LOG_HANDLE_MAP);
+            request->send((SUCCESS == mapUploadStatus) ? 200 : 400);
+        },
+        nullptr,
+        [](AsyncWebServerRequest *request, uint8_t *data, size_t len, size_t index, size_t total) {
+            if(0 == index) {
+                mapUploadStatus = (occupancyGrid.blobSize() == total) ? SUCCESS : FAILURE;
+            }
+            if(SUCCESS == mapUploadStatus) {
+                mapUploadStatus = occupancyGrid.upload(data, len, index);
+            }
+        });
+    #ifdef USE_FLIGHT_RECORDER
+        server.on("/flight", HTTP_GET, [](AsyncWebServerRequest *request) {
+            request->send(SPIFFS, FLIGHT_LOG_FILE, "application/octet-stream", true);
+        });
+    #endif
+
     // endpoint for streaming video from camera
     server.on("/control", HTTP_GET, configHandler);     // set a single camera setting
     server.on("/status", HTTP_GET, statusHandler);      // return camera settings
@@ -188,14 +277,14 @@ void setup()
 
     // start the server listening for requests
     server.begin();
-    LOG_INFO("... http server intialized ...");
+    LOGT_INFO(LOG_HTTP_INITIALIZED);
 
     //
     // initialize websockets for streaming video and rover commands
     //
     wsStreamInit();
     wsCommandInit();
-    LOG_INFO("... websockets server intialized ...");
+    LOGT_INFO(LOG_WEBSOCKETS_INITIALIZED);
 
     //
     // create background task to execute queued rover tasks
@@ -206,6 +295,30 @@ void setup()
     // initialize the camera
     //
     initCamera();
+    #ifdef ENABLE_CAMERA
+        if(SUCCESS != cameraCapture.attach(cameraSource).begin()) {
+            LOGT_ERROR(LOG_CAMERA_TASK_FAILED);
+        }
+    #endif
+
+    //
+    // keep a history of wheel and pose samples for reconnecting clients;
+    // this comes after the camera so it's frame buffers get PSRAM first.
+    //
+    if(SUCCESS != telemetry.beginHistory(psramFound() ? TELEMETRY_HISTORY_RECORDS : TELEMETRY_HISTORY_HEAP_RECORDS)) {
+        LOGT_ERROR(LOG_HISTORY_ALLOCATION_FAILED);
+    }
+
+    //
+    // the map is centered on where the rover starts
+    //
+    const unsigned int mapColumns = psramFound() ? MAP_COLUMNS : MAP_HEAP_COLUMNS;
+    const unsigned int mapRows = psramFound() ? MAP_ROWS : MAP_HEAP_ROWS;
+    if(SUCCESS != occupancyGrid.begin(mapColumns, mapRows, MAP_CELL_SIZE, -(mapColumns * MAP_CELL_SIZE) / 2, -(mapRows * MAP_CELL_SIZE) / 2)) {
+        LOGT_ERROR(LOG_MAP_ALLOCATION_FAILED);
+    } else if(SUCCESS != pathPlanner.begin(occupancyGrid, psramFound() ? PLANNER_HEAP_COUNT : PLANNER_HEAP_HEAP_COUNT)) {
+        LOGT_ERROR(LOG_PLANNER_ALLOCATION_FAILED);
+    }
 
     //
     // initialize rover dependancies
@@ -216,7 +329,11 @@ void setup()
     //       serial port pins for the wheel encoders.  So we must 
     //       attach to those pins after those systems are started.
     //
-    telemetry.attach(&messageBus);
+    #ifdef USE_CONTROL_TASK
+        telemetryBridge.attach(messageBus);  // telemetry is sent from the network task
+    #else
+        telemetry.attach(&messageBus);
+    #endif
     rover.attach(
         leftWheel.attach(
             leftMotor.attach(leftForwardPwm, leftReversePwm), 
@@ -230,14 +347,49 @@ void setup()
             &messageBus),
         &messageBus);
     gotoGoalBehavior.attach(rover, messageBus).startListening();
-    roverCommandProcessor.attach(rover, gotoGoalBehavior);
+    pathFollowBehavior.attach(rover, messageBus);
+    waypointRecorder.attach(rover, messageBus);
+    occupancyGrid.attach(rover, messageBus).startListening();
+    pathPlanner.attach(rover, gotoGoalBehavior);
+    roverCommandProcessor.attach(rover, gotoGoalBehavior, &telemetry);
+    roverCommandProcessor.setPathFollowBehavior(&pathFollowBehavior);
+    roverCommandProcessor.setWaypointRecorder(&waypointRecorder);
+    roverCommandProcessor.setPathPlanner(&pathPlanner);
+
+    #ifdef USE_FLIGHT_RECORDER
+        if(SPIFFS.begin(true)) {
+            FlightLogHeader header;
+            header.startMs = millis();
+            header.wheelBase = rover.wheelBase();
+            header.leftCircumference = leftWheel.circumference();
+            header.rightCircumference = rightWheel.circumference();
+            header.leftCountsPerRevolution = (uint16_t)leftWheel.countsPerRevolution();
+            header.rightCountsPerRevolution = (uint16_t)rightWheel.countsPerRevolution();
+            header.posePollMs = POSE_POLL_MS;
+            header.poseMinEncoderCount = POSE_MIN_ENCODER_COUNT;
+            if(SUCCESS == flightRecorder.begin((String("/spiffs") + FLIGHT_LOG_FILE).c_str(), header)) {
+                rover.setRecorder(&flightRecorder);
+                roverCommandProcessor.setRecorder(&flightRecorder);
+                flightWheelListener.attach(messageBus, leftWheel, rightWheel, flightRecorder);
+            } else {
+                LOGT_ERROR(LOG_FLIGHT_LOG_FAILED);
+            }
+        } else {
+            LOGT_ERROR(LOG_FLIGHT_SPIFFS_FAILED);
+        }
+    #endif
 
     #ifdef USE_WHEEL_ENCODERS
         // internal led will blink on each wheel rotation
         pinMode(BUILTIN_LED_PIN, OUTPUT);
     #endif
 
-    LOG_INFO("...Rover Initialized...");
+    #ifdef USE_CONTROL_TASK
+        // loop() runs on the application core, so put networking on the other core
+        xTaskCreatePinnedToCore(networkTask, "networkTask", 8192, NULL, 1, &networkTaskHandle, (1 == xPortGetCoreID()) ? 0 : 1);
+    #endif
+
+    LOGT_INFO(LOG_ROVER_INITIALIZED);
 
 }
 
@@ -248,10 +400,50 @@ void setup()
  */
 void loop()
 {
+    tokenLog.tick(millis());    // time stamp for tokenized log records
+
+    #ifdef USE_CONTROL_TASK
+        //
+        // execute commands that the network core has received
+        // and hand their status back so they are acked or nacked;
+        // the network core never has more commands in flight
+        // than the ack ring holds, so the push can not fail.
+        //
+        QueuedCommand command;
+        while(commandRing.pop(command)) {
+            CommandAck ack;
+            ack.clientNum = command.clientNum;
+            ack.status = roverCommandProcessor.executeCommand(command.command, command.text);
+            strCopy(ack.text, sizeof(ack.text), command.text);
+            ackRing.push(ack);
+        }
+    #endif
+
+    // swap in a map uploaded by the web server; a planned path is for the old map
+    if(occupancyGrid.applyUpload()) {
+        pathPlanner.cancel().setClearance(PLANNER_CLEARANCE);
+    }
+
     // poll all rover systems (motor, encoders, speed controllers)
     rover.poll(millis());
+    gotoGoalBehavior.poll(millis());    // runs behavior if it uses GOTO_TICK_FIXED_RATE
+    pathFollowBehavior.poll(millis());
+    waypointRecorder.poll(millis());   // streams the recorded path while it is played
+    pathPlanner.poll(millis());        // searches within PLANNER_BUDGET_US, then drives the path
     roverCommandProcessor.pollRoverCommand(millis());
-    telemetry.poll();   // send any buffered telemetry
+
+    #ifdef USE_CONTROL_TASK
+        // networking is polled by networkTask() on the other core
+        #ifdef USE_WHEEL_ENCODERS
+            pollBuiltInLed();
+        #endif
+        return;
+    #endif
+
+    telemetry.poll(millis());   // send any buffered telemetry
+    #ifdef USE_FLIGHT_RECORDER
+        flightRecorder.poll();  // write the next chunk of the flight log
+    #endif
 
     // poll stream to send image to clients via websocket
     #ifdef ENABLE_CAMERA
@@ -263,18 +455,51 @@ void loop()
     wsCommandPoll();
 
     #ifdef USE_WHEEL_ENCODERS
-        //
-        // blink built-in led on each wheel revolution
-        //
-        const unsigned int leftWheelCount = rover.readLeftWheelTicks();
-        const boolean ledOn = (0 == (leftWheelCount / (PULSES_PER_REVOLUTION / 2)) % 2);
-        if (ledOn != builtInLedOn) {
-            digitalWrite(BUILTIN_LED_PIN, ledOn ? LOW : HIGH);  // built in led uses inverted logic; low to light
-            builtInLedOn = ledOn;
-        }
+        pollBuiltInLed();
     #endif
 }
 
+/**
+ * blink built-in led on each wheel revolution
+ */
+void pollBuiltInLed() {
+    const unsigned int leftWheelCount = rover.readLeftWheelTicks();
+    const boolean ledOn = (0 == (leftWheelCount / (PULSES_PER_REVOLUTION / 2)) % 2);
+    if (ledOn != builtInLedOn) {
+        digitalWrite(BUILTIN_LED_PIN, ledOn ? LOW : HIGH);  // built in led uses inverted logic; low to light
+        builtInLedOn = ledOn;
+    }
+}
+
+#ifdef USE_CONTROL_TASK
+/**
+ * Network task
+ * - runs on the core that loop() does not use.
+ * - formats bridged telemetry and sends it
+ * - streams camera images
+ * - parses commands, executes telemetry commands
+ *   and hands the others to loop() via commandRing
+ * - acks or nacks the commands loop() executed
+ */
+void networkTask(void *params) {
+    for(;;) {
+        telemetryBridge.poll(telemetry);    // format telemetry captured on the control core
+        telemetry.poll(millis());       // send any buffered telemetry
+        #ifdef USE_FLIGHT_RECORDER
+            flightRecorder.poll();      // write the next chunk of the flight log off the control core
+        #endif
+
+        #ifdef ENABLE_CAMERA
+            wsStreamCameraImage();
+        #endif
+        wsStreamPoll();
+        wsCommandPoll();
+
+        vTaskDelay(1);  // let idle task run so watchdog is fed
+    }
+}
+#endif
+
 
 /************ web server endpoint handlers ************/
 // These are called by the webserver when a request 
@@ -296,7 +521,7 @@ void notFound(AsyncWebServerRequest *request)
  */
 void healthHandler(AsyncWebServerRequest *request)
 {
-    LOG_INFO("handling " + request->url());
+    LOGT_INFO(LOG_HANDLE_HEALTH);
 
     // TODO: determine if camera and rover are healty
     request->send(200, "application/json", "{\"health\": \"ok\"}");
@@ -309,36 +534,23 @@ void healthHandler(AsyncWebServerRequest *request)
  */
 void captureHandler(AsyncWebServerRequest *request)
 {
-    LOG_INFO("handling " + request->url());
+    LOGT_INFO(LOG_HANDLE_CAPTURE);
 
     //
-    // 1. create buffer to hold image
-    // 2. capture a camera image
-    // 3. create response and send it
-    // 4. free the image buffer
+    // 1. get an image from the capture task, which owns the camera
+    // 2. copy it into the response, which is sent after this returns
+    // 3. give the frame back
+    // 4. send the response
     //
- 
- 
-    // 1. create buffer to hold frames
-    uint8_t* jpgBuff = new uint8_t[68123];  // TODO: should be based on image dimensions
-    size_t   jpgLength = 0;
-
-    // 2. capture a camera image
-    esp_err_t result = grabImage(jpgLength, jpgBuff);
-
-    // 3. create and send response
-    if(result == ESP_OK){
-        request->send_P(200, "image/jpeg", jpgBuff, jpgLength);
-    }
-    else
-    {
+    CameraFrame *frame = cameraCapture.snapshot(CAMERA_SNAPSHOT_MS);
+    if(nullptr == frame) {
         request->send(500, "text/plain", "Error capturing image from camera");
+        return;
     }
-
-    //
-    // 4. free the image buffer
-    //
-    delete jpgBuff;
+    AsyncResponseStream *response = request->beginResponseStream("image/jpeg", frame->len);
+    response->write(frame->buf, frame->len);
+    cameraCapture.release(frame);
+    request->send(response);
 }
 
 
@@ -351,7 +563,7 @@ void captureHandler(AsyncWebServerRequest *request)
  */
 void statusHandler(AsyncWebServerRequest *request) 
 {
-    LOG_INFO("handling " + request->url());
+    LOGT_INFO(LOG_HANDLE_STATUS);
 
     const String json = getCameraPropertiesJson();
     request->send_P(200, "application/json", (uint8_t *)json.c_str(), json.length());
@@ -365,7 +577,7 @@ void statusHandler(AsyncWebServerRequest *request)
  *   - 'val' is the value of the configuration variable to set
  */
 void configHandler(AsyncWebServerRequest *request) {
-    LOG_INFO("handling " + request->url());
+    LOGT_INFO(LOG_HANDLE_CONTROL);
 
     //
     // validate parameters
@@ -391,7 +603,7 @@ void configHandler(AsyncWebServerRequest *request) {
     {
         const int status = setCameraProperty(varParam, valParam);
         if(SUCCESS != status) {
-            LOG_ERROR("Failure setting camera property");
+            LOGT_ERROR(LOG_CAMERA_PROPERTY_FAILED);
         }
         request->send((SUCCESS == status) ? 200: 500);
     }
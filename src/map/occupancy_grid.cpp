@@ -0,0 +1,414 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "occupancy_grid.h"
+#include "../error.h"
+
+OccupancyGrid::~OccupancyGrid() {
+    detach();
+    free(_cells);
+    free(_staged);
+}
+
+/**
+ * Allocate the grid and it's upload buffer;
+ * PSRAM is used if the board has it,
+ * otherwise internal RAM.  All cells start unknown.
+ */
+int OccupancyGrid::begin(
+    unsigned int columns,   // IN : cells across; a multiple of 16
+    unsigned int rows,      // IN : cells up and down
+    distance_type cellSize, // IN : cm along each side of a cell
+    distance_type originX,  // IN : world x of corner of cell (0, 0)
+    distance_type originY)  // IN : world y of corner of cell (0, 0)
+                            // RET: SUCCESS or FAILURE if memory could not be allocated
+{
+    free(_cells);
+    free(_staged);
+    _cells = nullptr;
+    _staged = nullptr;
+    _columns = 0;
+    _rows = 0;
+    _wordsPerRow = 0;
+    _hasLastPose = false;
+    _uploadValid = false;
+    _uploadBytes = 0;
+    _uploadPending.store(false, std::memory_order_release);
+
+    // a row must be whole words, so the blob is the words as they are
+    if((0 == columns) || (0 != (columns & 15)) || (0 == rows) || (columns > UINT16_MAX) || (rows > UINT16_MAX) || (cellSize <= 0)) {
+        return FAILURE;
+    }
+
+    const size_t bytes = (size_t)rows * (columns >> 4) * sizeof(uint32_t);
+    #ifdef TESTING
+        _cells = (uint32_t *)malloc(bytes);
+        _staged = (uint32_t *)malloc(bytes);
+    #else
+        _cells = (uint32_t *)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+        _staged = (uint32_t *)(psramFound() ? ps_malloc(bytes) : malloc(bytes));
+    #endif
+    if((nullptr == _cells) || (nullptr == _staged)) {
+        free(_cells);
+        free(_staged);
+        _cells = nullptr;
+        _staged = nullptr;
+        return FAILURE;
+    }
+
+    _columns = columns;
+    _rows = rows;
+    _wordsPerRow = columns >> 4;
+    _cellSize = cellSize;
+    _inverseCellSize = 1 / cellSize;
+    _originX = originX;
+    _originY = originY;
+    fill(CELL_UNKNOWN);
+    return SUCCESS;
+}
+
+/**
+ * Deteremine if dependencies are attached
+ */
+bool OccupancyGrid::attached() // RET: true if attached, false if not
+{
+    return (NULL != _rover) && (NULL != _messageBus);
+}
+
+/**
+ * Attach dependencies
+ */
+OccupancyGrid& OccupancyGrid::attach(
+    TwoWheelRover& rover,   // IN : rover whose path is mapped
+    MessageBus& messageBus) // IN : MessageBus to subscribe rover pose updates
+                            // RET: this grid in attached state
+{
+    if(!attached()) {
+        _rover = &rover;
+        _messageBus = &messageBus;
+    }
+
+    return *this;
+}
+
+/**
+ * Detach dependencies
+ */
+OccupancyGrid& OccupancyGrid::detach() // RET: this grid in detached state
+{
+    if(attached()) {
+        stopListening();
+        _rover = nullptr;
+        _messageBus = nullptr;
+    }
+
+    return *this;
+}
+
+/**
+ * Start marking the rover's path as free
+ */
+OccupancyGrid& OccupancyGrid::startListening()    // RET: this grid
+{
+    if(attached()) {
+        _hasLastPose = false;
+        _messageBus->subscribe(*this, ROVER_POSE);
+    }
+
+    return *this;
+}
+
+/**
+ * Stop marking the rover's path
+ */
+OccupancyGrid& OccupancyGrid::stopListening()     // RET: this grid
+{
+    if(attached()) {
+        _messageBus->unsubscribe(*this, ROVER_POSE);
+    }
+
+    return *this;
+}
+
+/**
+ * Handle a subscribed message from a publisher
+ */
+void OccupancyGrid::onMessage(
+    Publisher &publisher,       // IN : publisher of message
+    Message message,            // IN : message that was published
+    Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+    const char *)               // IN : message data as a c-cstring
+{
+    switch (message)
+    {
+        case ROVER_POSE: {
+            assert(&publisher == _rover);
+            assert(specifier == ROVER_SPEC);
+
+            // the rover drove from the last pose to this one, so that is free
+            const Pose2D pose = _rover->pose();
+            const Pose2D &from = _hasLastPose ? _lastPose : pose;
+            markLine(from.x, from.y, pose.x, pose.y, CELL_FREE);
+            _lastPose = pose;
+            _hasLastPose = true;
+            break;
+        }
+        default: {
+            // NOOP
+            break;
+        }
+    }
+}
+
+/**
+ * Set every cell to the same state
+ */
+OccupancyGrid& OccupancyGrid::fill(CellState state)   // IN : new state of every cell
+                                                      // RET: this grid
+{
+    if(ready()) {
+        // repeat the 2 bit state through the word
+        const uint32_t word = (uint32_t)state * 0x55555555;
+        const unsigned int words = _rows * _wordsPerRow;
+        for(unsigned int i = 0; i < words; i += 1) {
+            _cells[i] = word;
+        }
+    }
+    return *this;
+}
+
+/**
+ * Set the cells on the line between two world positions,
+ * using Bresenham's line algorithm on the cells they are in;
+ * the parts of the line outside the grid are ignored.
+ */
+OccupancyGrid& OccupancyGrid::markLine(
+    distance_type x0,   // IN : world position of start of line
+    distance_type y0,
+    distance_type x1,   // IN : world position of end of line
+    distance_type y1,
+    CellState state)    // IN : new state of the cells
+                        // RET: this grid
+{
+    if(!ready()) {
+        return *this;
+    }
+
+    int column, row, endColumn, endRow;
+    worldToCell(x0, y0, column, row);
+    worldToCell(x1, y1, endColumn, endRow);
+
+    const int dx = abs<int>(endColumn - column);
+    const int dy = -abs<int>(endRow - row);
+    const int stepX = (column < endColumn) ? 1 : -1;
+    const int stepY = (row < endRow) ? 1 : -1;
+    int error = dx + dy;
+    for(;;) {
+        setCell(column, row, state);
+        if((column == endColumn) && (row == endRow)) {
+            break;
+        }
+        const int error2 = 2 * error;
+        if(error2 >= dy) {
+            error += dy;
+            column += stepX;
+        }
+        if(error2 <= dx) {
+            error += dx;
+            row += stepY;
+        }
+    }
+    return *this;
+}
+
+/**
+ * Count the cells in a state
+ */
+unsigned int OccupancyGrid::count(CellState state)    // IN : state to count
+                                                      // RET: number of cells in that state
+{
+    unsigned int total = 0;
+    for(unsigned int row = 0; row < _rows; row += 1) {
+        for(unsigned int column = 0; column < _columns; column += 1) {
+            if(state == cell(column, row)) {
+                total += 1;
+            }
+        }
+    }
+    return total;
+}
+
+/**
+ * Read one byte of the blob
+ */
+uint8_t OccupancyGrid::_blobByte(unsigned int offset) // IN : offset into blob
+                                                      // RET: byte at offset
+{
+    if(offset >= MAP_BLOB_HEADER_BYTES) {
+        // cells are the words, little-endian
+        const unsigned int cellOffset = offset - MAP_BLOB_HEADER_BYTES;
+        return (uint8_t)(_cells[cellOffset >> 2] >> ((cellOffset & 3) << 3));
+    }
+
+    uint32_t value;
+    unsigned int at;    // offset of field in header
+    float field;        // header float, which may not be a distance_type
+    switch(offset) {
+        case 0: case 1: value = MAP_BLOB_MAGIC; at = 0; break;
+        case 2: return MAP_BLOB_VERSION;
+        case 3: return 2;   // bits per cell
+        case 4: case 5: value = _columns; at = 4; break;
+        case 6: case 7: value = _rows; at = 6; break;
+        case 8: case 9: case 10: case 11: field = (float)_cellSize; at = 8; break;
+        case 12: case 13: case 14: case 15: field = (float)_originX; at = 12; break;
+        default: field = (float)_originY; at = 16; break;
+    }
+    if(at >= 8) {
+        memcpy(&value, &field, sizeof(value));
+    }
+    return (uint8_t)(value >> ((offset - at) << 3));
+}
+
+/**
+ * Download a chunk of the blob
+ */
+unsigned int OccupancyGrid::download(
+    uint8_t *buffer,        // OUT: receives the chunk
+    unsigned int size,      // IN : most bytes to copy
+    unsigned int offset)    // IN : offset of chunk in blob
+                            // RET: bytes copied; 0 at end of blob
+{
+    if(!ready() || (offset >= blobSize())) {
+        return 0;
+    }
+    const unsigned int end = min<unsigned int>(blobSize(), offset + size);
+    for(unsigned int i = offset; i < end; i += 1) {
+        buffer[i - offset] = _blobByte(i);
+    }
+    return end - offset;
+}
+
+/**
+ * Read a little-endian value from the uploaded header
+ */
+static uint32_t headerValue(
+    const uint8_t *header,  // IN : header bytes
+    unsigned int offset,    // IN : offset of value in header
+    unsigned int bytes)     // IN : size of value
+                            // RET: value
+{
+    uint32_t value = 0;
+    for(unsigned int i = 0; i < bytes; i += 1) {
+        value |= (uint32_t)header[offset + i] << (i << 3);
+    }
+    return value;
+}
+
+/**
+ * Read a little-endian float from the uploaded header
+ */
+static float headerFloat(
+    const uint8_t *header,  // IN : header bytes
+    unsigned int offset)    // IN : offset of float in header
+                            // RET: value
+{
+    const uint32_t bits = headerValue(header, offset, 4);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Upload a chunk of the blob into the upload buffer;
+ * chunks must be uploaded in order, starting at offset
+ * zero.  The header must match the grid's size, since
+ * the grid can not be reallocated, but the cell size
+ * and origin are taken from it.  Nothing changes in the
+ * grid until the whole blob is uploaded and applyUpload()
+ * is called, so a short or aborted upload is ignored.
+ */
+int OccupancyGrid::upload(
+    const uint8_t *chunk,   // IN : chunk of the blob
+    unsigned int size,      // IN : bytes in the chunk
+    unsigned int offset)    // IN : offset of chunk in blob
+                            // RET: SUCCESS,
+                            //      FAILURE if the header does not match the grid,
+                            //      chunks are out of order or an upload is
+                            //      still waiting for applyUpload()
+{
+    // the control loop owns the upload buffer until it applies it
+    if(!ready() || uploadPending()) {
+        return FAILURE;
+    }
+    if(0 == offset) {
+        _uploadValid = false;
+        _uploadBytes = 0;
+    }
+    if((offset != _uploadBytes) || (offset + size > blobSize())) {
+        return FAILURE;
+    }
+
+    for(unsigned int i = 0; i < size; i += 1) {
+        const unsigned int at = offset + i;
+        if(at < MAP_BLOB_HEADER_BYTES) {
+            _uploadHeader[at] = chunk[i];
+            if(MAP_BLOB_HEADER_BYTES - 1 == at) {
+                //
+                // the header is complete; it must be
+                // for a grid of this size
+                //
+                const float cellSize = headerFloat(_uploadHeader, 8);
+                _uploadValid = (MAP_BLOB_MAGIC == headerValue(_uploadHeader, 0, 2))
+                    && (MAP_BLOB_VERSION == _uploadHeader[2])
+                    && (2 == _uploadHeader[3])
+                    && (_columns == headerValue(_uploadHeader, 4, 2))
+                    && (_rows == headerValue(_uploadHeader, 6, 2))
+                    && (cellSize > 0);
+                if(!_uploadValid) {
+                    return FAILURE;
+                }
+            }
+        } else if(!_uploadValid) {
+            return FAILURE;
+        } else {
+            // set one byte of a little-endian word
+            const unsigned int cellOffset = at - MAP_BLOB_HEADER_BYTES;
+            const unsigned int shift = (cellOffset & 3) << 3;
+            uint32_t &word = _staged[cellOffset >> 2];
+            word = (word & ~((uint32_t)0xff << shift)) | ((uint32_t)chunk[i] << shift);
+        }
+    }
+    _uploadBytes = offset + size;
+
+    // hand the whole blob to the control loop
+    if(_uploadValid && (blobSize() == _uploadBytes)) {
+        _uploadPending.store(true, std::memory_order_release);
+    }
+    return SUCCESS;
+}
+
+/**
+ * Replace the grid with an uploaded blob;
+ * the upload buffer becomes the grid and
+ * the old grid becomes the upload buffer.
+ */
+bool OccupancyGrid::applyUpload()   // RET: true if an upload was applied,
+                                    //      false if none was pending
+{
+    if(!uploadPending()) {
+        return false;
+    }
+
+    uint32_t *cells = _cells;
+    _cells = _staged;
+    _staged = cells;
+
+    _cellSize = headerFloat(_uploadHeader, 8);
+    _inverseCellSize = 1 / _cellSize;
+    _originX = headerFloat(_uploadHeader, 12);
+    _originY = headerFloat(_uploadHeader, 16);
+    _hasLastPose = false;
+
+    _uploadPending.store(false, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,310 @@
+#ifndef OCCUPANCY_GRID_H
+#define OCCUPANCY_GRID_H
+
+#include <atomic>
+#include <stdint.h>
+
+#include "../config.h"
+#include "../rover/rover.h"
+#include "../rover/pose.h"
+#include "../message_bus/message_bus.h"
+
+//
+// what is known about a cell; 2 bits each
+//
+typedef enum CellState {
+    CELL_UNKNOWN = 0,   // not yet seen
+    CELL_FREE,          // the rover can drive here
+    CELL_OCCUPIED,      // blocked
+} CellState;
+
+//
+// upload and download blob;
+// [magic:u16][version:u8][bitsPerCell:u8][columns:u16][rows:u16]
+// [cellSize:f32][originX:f32][originY:f32]
+// followed by rows * columns / 4 bytes of cells, row by row
+// from the bottom, 4 cells per byte with the first cell in
+// the low bits.  All values are little-endian.
+//
+const uint16_t MAP_BLOB_MAGIC = 0x474f;     // "OG"
+const uint8_t MAP_BLOB_VERSION = 1;
+const unsigned int MAP_BLOB_HEADER_BYTES = 20;
+
+/**
+ * A fixed size map of the world around the rover as
+ * a grid of square cells that are unknown, free or occupied,
+ * for path planning.
+ *
+ * Cells are packed 16 to a 32 bit word, so a large
+ * map is small enough for PSRAM.  The memory is allocated
+ * once, by begin(); nothing after that allocates, so the
+ * grid can be updated at pose rate.  Cell (0, 0) is at
+ * the world origin of the grid, and columns run along x
+ * and rows along y, in the same world coordinates as the
+ * rover's Pose2D.
+ *
+ * While attached and listening, each ROVER_POSE message
+ * marks the cells on the line from the previous pose as
+ * free, so the map fills in as the rover drives.
+ *
+ * The whole map is uploaded and downloaded as a compact
+ * binary blob, a chunk at a time so it can be streamed.
+ * An upload is staged in a second buffer, so the web
+ * server can receive it while the control loop uses the
+ * grid; once it is whole and valid, the control loop
+ * swaps it in with applyUpload().
+ */
+class OccupancyGrid : public Subscriber {
+    private:
+    // attached dependencies
+    TwoWheelRover* _rover = nullptr;
+    MessageBus *_messageBus = nullptr;
+
+    uint32_t *_cells = nullptr;         // packed cells, row by row
+    unsigned int _columns = 0;
+    unsigned int _rows = 0;
+    unsigned int _wordsPerRow = 0;
+    distance_type _cellSize = MAP_CELL_SIZE;
+    distance_type _inverseCellSize = 1 / MAP_CELL_SIZE;   // cells per cm
+    distance_type _originX = 0;         // world position of corner of cell (0, 0)
+    distance_type _originY = 0;
+
+    bool _hasLastPose = false;          // true once a pose has been mapped
+    Pose2D _lastPose = {0, 0, 0};       // pose that was last mapped
+
+    uint32_t *_staged = nullptr;        // cells of blob being uploaded
+    uint8_t _uploadHeader[MAP_BLOB_HEADER_BYTES];   // header of blob being uploaded
+    bool _uploadValid = false;          // true if the uploaded header matches the grid
+    unsigned int _uploadBytes = 0;      // bytes of blob uploaded so far
+    std::atomic<bool> _uploadPending;   // true when a whole blob is staged and waiting for applyUpload()
+
+    /**
+     * Round down to a whole number without calling floorf()
+     */
+    static int _floor(distance_type value)  // IN : value to round
+                                            // RET: largest integer <= value
+    {
+        const int truncated = (int)value;
+        return (value < truncated) ? truncated - 1 : truncated;
+    }
+
+    /**
+     * Read one byte of the blob
+     */
+    uint8_t _blobByte(unsigned int offset); // IN : offset into blob
+                                            // RET: byte at offset
+
+    public:
+
+    OccupancyGrid()
+        : Subscriber(), _uploadPending(false)
+    {
+    }
+
+    ~OccupancyGrid();
+
+    /**
+     * Allocate the grid and it's upload buffer;
+     * PSRAM is used if the board has it.
+     * All cells start unknown.
+     */
+    int begin(
+        unsigned int columns,   // IN : cells across; a multiple of 16
+        unsigned int rows,      // IN : cells up and down
+        distance_type cellSize, // IN : cm along each side of a cell
+        distance_type originX,  // IN : world x of corner of cell (0, 0)
+        distance_type originY); // IN : world y of corner of cell (0, 0)
+                                // RET: SUCCESS or FAILURE if memory could not be allocated
+
+    /**
+     * Determine if the grid is allocated
+     */
+    bool ready() { return nullptr != _cells; }
+
+    unsigned int columns() { return _columns; }
+    unsigned int rows() { return _rows; }
+    distance_type cellSize() { return _cellSize; }
+    distance_type originX() { return _originX; }
+    distance_type originY() { return _originY; }
+
+    /**
+     * Deteremine if dependencies are attached
+     */
+    bool attached(); // RET: true if attached, false if not
+
+    /**
+     * Attach dependencies
+     */
+    OccupancyGrid& attach(
+        TwoWheelRover& rover,   // IN : rover whose path is mapped
+        MessageBus& messageBus);// IN : MessageBus to subscribe rover pose updates
+                                // RET: this grid in attached state
+
+    /**
+     * Detach dependencies
+     */
+    OccupancyGrid& detach(); // RET: this grid in detached state
+
+    /**
+     * Start marking the rover's path as free
+     */
+    OccupancyGrid& startListening();    // RET: this grid
+
+    /**
+     * Stop marking the rover's path
+     */
+    OccupancyGrid& stopListening();     // RET: this grid
+
+    /**
+     * Handle a subscribed message from a publisher
+     */
+    void onMessage(
+        Publisher &publisher,       // IN : publisher of message
+        Message message,            // IN : message that was published
+        Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+        const char *data);          // IN : message data as a c-cstring
+
+    /**
+     * Find the cell that contains a world position
+     */
+    bool worldToCell(
+        distance_type x,        // IN : world x
+        distance_type y,        // IN : world y
+        int &column,            // OUT: column of cell, may be outside the grid
+        int &row)               // OUT: row of cell, may be outside the grid
+                                // RET: true if the cell is in the grid
+    {
+        #ifdef USE_FIXED_POINT
+            // a fixed point reciprocal is too coarse to land on cell edges
+            column = _floor((x - _originX) / _cellSize);
+            row = _floor((y - _originY) / _cellSize);
+        #else
+            column = _floor((x - _originX) * _inverseCellSize);
+            row = _floor((y - _originY) * _inverseCellSize);
+        #endif
+        return contains(column, row);
+    }
+
+    /**
+     * Get the world position of the center of a cell
+     */
+    Point2D cellToWorld(int column, int row)    // IN : cell
+                                                // RET: world position of center of cell
+    {
+        return {_originX + (column + 0.5f) * _cellSize, _originY + (row + 0.5f) * _cellSize};
+    }
+
+    /**
+     * Determine if a cell is in the grid
+     */
+    bool contains(int column, int row)  // IN : cell
+                                        // RET: true if cell is in the grid
+    {
+        return (column >= 0) && (row >= 0) && ((unsigned int)column < _columns) && ((unsigned int)row < _rows);
+    }
+
+    /**
+     * Get the state of a cell
+     */
+    CellState cell(int column, int row)     // IN : cell
+                                            // RET: state of cell; CELL_UNKNOWN if outside the grid
+    {
+        if(!ready() || !contains(column, row)) {
+            return CELL_UNKNOWN;
+        }
+        const uint32_t word = _cells[row * _wordsPerRow + (column >> 4)];
+        return (CellState)((word >> ((column & 15) << 1)) & 3);
+    }
+
+    /**
+     * Set the state of a cell
+     */
+    OccupancyGrid& setCell(int column, int row, CellState state)    // IN : cell and it's new state
+                                                                    // RET: this grid
+    {
+        if(ready() && contains(column, row)) {
+            uint32_t &word = _cells[row * _wordsPerRow + (column >> 4)];
+            const unsigned int shift = (column & 15) << 1;
+            word = (word & ~((uint32_t)3 << shift)) | ((uint32_t)state << shift);
+        }
+        return *this;
+    }
+
+    /**
+     * Set every cell to the same state
+     */
+    OccupancyGrid& fill(CellState state);   // IN : new state of every cell
+                                            // RET: this grid
+
+    /**
+     * Set the cells on the line between two world positions;
+     * the parts of the line outside the grid are ignored.
+     */
+    OccupancyGrid& markLine(
+        distance_type x0,   // IN : world position of start of line
+        distance_type y0,
+        distance_type x1,   // IN : world position of end of line
+        distance_type y1,
+        CellState state);   // IN : new state of the cells
+                            // RET: this grid
+
+    /**
+     * Count the cells in a state
+     */
+    unsigned int count(CellState state);    // IN : state to count
+                                            // RET: number of cells in that state
+
+    /**
+     * Get the size of the upload/download blob
+     */
+    unsigned int blobSize() // RET: bytes in blob
+    {
+        return MAP_BLOB_HEADER_BYTES + _rows * _wordsPerRow * sizeof(uint32_t);
+    }
+
+    /**
+     * Download a chunk of the blob
+     */
+    unsigned int download(
+        uint8_t *buffer,        // OUT: receives the chunk
+        unsigned int size,      // IN : most bytes to copy
+        unsigned int offset);   // IN : offset of chunk in blob
+                                // RET: bytes copied; 0 at end of blob
+
+    /**
+     * Upload a chunk of the blob into the upload buffer;
+     * chunks must be uploaded in order, starting at offset
+     * zero.  The header must match the grid's size, since
+     * the grid can not be reallocated, but the cell size
+     * and origin are taken from it.  Nothing changes in the
+     * grid until the whole blob is uploaded and applyUpload()
+     * is called, so a short or aborted upload is ignored.
+     *
+     * NOTE: this may be called from another task than
+     *       the one that uses the grid.
+     */
+    int upload(
+        const uint8_t *chunk,   // IN : chunk of the blob
+        unsigned int size,      // IN : bytes in the chunk
+        unsigned int offset);   // IN : offset of chunk in blob
+                                // RET: SUCCESS,
+                                //      FAILURE if the header does not match the grid,
+                                //      chunks are out of order or an upload is
+                                //      still waiting for applyUpload()
+
+    /**
+     * Determine if a whole blob has been uploaded
+     * and is waiting for applyUpload()
+     */
+    bool uploadPending() { return _uploadPending.load(std::memory_order_acquire); }
+
+    /**
+     * Replace the grid with an uploaded blob
+     *
+     * NOTE: call this from the task that uses the grid.
+     */
+    bool applyUpload(); // RET: true if an upload was applied,
+                        //      false if none was pending
+};
+
+#endif // OCCUPANCY_GRID_H
@@ -0,0 +1,643 @@
+#include <stdlib.h>
+
+#include "path_planner.h"
+#include "../error.h"
+#include "../util/math.h"
+
+//
+// cost so far of each cell; values up to PLANNER_MAX_COST
+// are open or unreached cells, with PLANNER_CLOSED
+// set once the cell is expanded.
+//
+const uint16_t PLANNER_CLOSED = 0x8000;     // cell has been expanded
+const uint16_t PLANNER_MAX_COST = 0x7FFD;   // longest path the search can cost
+const uint16_t PLANNER_FAR = 0x7FFF;        // passable, but not reached yet
+const uint16_t PLANNER_BLOCKED = 0xFFFE;    // rover does not fit
+const uint16_t PLANNER_UNSEEN = 0xFFFF;     // not checked yet
+
+// octile costs; ratio is close to sqrt(2) and they keep paths under 16 bits
+const uint16_t PLANNER_STRAIGHT = 5;
+const uint16_t PLANNER_DIAGONAL = 7;
+
+// cells cleared per expansion when a search starts
+const unsigned int PLANNER_CLEAR_CHUNK = 256;
+
+// neighbors; straight first, then diagonal
+static const int neighborColumn[8] = {1, 0, -1, 0, 1, -1, -1, 1};
+static const int neighborRow[8] = {0, 1, 0, -1, 1, 1, -1, -1};
+
+/**
+ * Get the cost so far of a cell that has been reached
+ */
+static bool reachedCost(
+    uint16_t value,     // IN : cell's value
+    uint16_t &cost)     // OUT: cost so far
+                        // RET: true if cell has been reached
+{
+    if(value < PLANNER_FAR) {
+        cost = value;
+        return true;
+    }
+    if((value & PLANNER_CLOSED) && (value < PLANNER_BLOCKED)) {
+        cost = value & ~PLANNER_CLOSED;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Determine if an entry should be popped before another;
+ * ties go to the entry further along, so the search
+ * runs to the goal rather than widening.
+ */
+static bool before(const PlannerEntry &a, const PlannerEntry &b)
+{
+    return (a.f < b.f) || ((a.f == b.f) && (a.g > b.g));
+}
+
+PathPlanner::~PathPlanner() {
+    detach();
+    free(_cost);
+    free(_heap);
+}
+
+/**
+ * Allocate memory for planning on a grid;
+ * PSRAM is used if the board has it.
+ */
+int PathPlanner::begin(
+    OccupancyGrid &grid,        // IN : grid in ready state; it's size must not change
+    unsigned int heapCount)     // IN : most open cells
+                                // RET: SUCCESS or FAILURE if memory could not be allocated
+{
+    free(_cost);
+    free(_heap);
+    _cost = nullptr;
+    _heap = nullptr;
+    _grid = nullptr;
+    _cellCount = 0;
+    _heapCapacity = 0;
+    _state = PLANNER_IDLE;
+    _driving = false;
+
+    if(!grid.ready() || (0 == heapCount)) {
+        return FAILURE;
+    }
+
+    const size_t cells = (size_t)grid.columns() * grid.rows();
+    const size_t costBytes = cells * sizeof(uint16_t);
+    const size_t heapBytes = heapCount * sizeof(PlannerEntry);
+    #ifdef TESTING
+        _cost = (uint16_t *)malloc(costBytes);
+        _heap = (PlannerEntry *)malloc(heapBytes);
+    #else
+        _cost = (uint16_t *)(psramFound() ? ps_malloc(costBytes) : malloc(costBytes));
+        _heap = (PlannerEntry *)(psramFound() ? ps_malloc(heapBytes) : malloc(heapBytes));
+    #endif
+    if((nullptr == _cost) || (nullptr == _heap)) {
+        free(_cost);
+        free(_heap);
+        _cost = nullptr;
+        _heap = nullptr;
+        return FAILURE;
+    }
+
+    _grid = &grid;
+    _cellCount = cells;
+    _heapCapacity = heapCount;
+    setClearance(PLANNER_CLEARANCE);
+    return SUCCESS;
+}
+
+/**
+ * Set how far the path keeps from occupied cells
+ */
+PathPlanner& PathPlanner::setClearance(distance_type clearance)  // IN : cm from an occupied cell that is blocked
+                                                                 // RET: this planner
+{
+    if(nullptr != _grid) {
+        // round up to whole cells
+        const distance_type cells = clearance / _grid->cellSize();
+        _clearance = (int)cells;
+        if(_clearance < cells) {
+            _clearance += 1;
+        }
+        _clearance = max<int>(0, _clearance);
+    }
+    return *this;
+}
+
+/**
+ * Determine if the rover fits in a cell; no cell
+ * within the clearance of it may be occupied.
+ */
+static bool fits(
+    OccupancyGrid &grid,    // IN : map
+    int column,             // IN : cell
+    int row,
+    int clearance)          // IN : cells that must be clear around it
+                            // RET: true if the rover can be there
+{
+    if(!grid.contains(column, row)) {
+        return false;
+    }
+    for(int r = row - clearance; r <= row + clearance; r += 1) {
+        for(int c = column - clearance; c <= column + clearance; c += 1) {
+            if(CELL_OCCUPIED == grid.cell(c, r)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Determine if the rover fits in a cell,
+ * remembering if it does not.
+ */
+bool PathPlanner::_passable(int column, int row)    // IN : cell
+                                                    // RET: true if the rover can be there
+{
+    if(!_grid->contains(column, row)) {
+        return false;
+    }
+    uint16_t &value = _cost[row * _grid->columns() + column];
+    if(PLANNER_UNSEEN == value) {
+        value = fits(*_grid, column, row, _clearance) ? PLANNER_FAR : PLANNER_BLOCKED;
+    }
+    return PLANNER_BLOCKED != value;
+}
+
+/**
+ * Determine if there is a clear straight line between cells,
+ * using Bresenham's line algorithm; a diagonal step needs
+ * both cells beside it clear, as it does in the search.
+ */
+bool PathPlanner::_lineOfSight(uint32_t from, uint32_t to)  // IN : cells at ends of line
+                                                            // RET: true if every cell on the line is passable
+{
+    const int columns = _grid->columns();
+    int column = from % columns;
+    int row = from / columns;
+    const int endColumn = to % columns;
+    const int endRow = to / columns;
+
+    const int dx = abs<int>(endColumn - column);
+    const int dy = -abs<int>(endRow - row);
+    const int stepX = (column < endColumn) ? 1 : -1;
+    const int stepY = (row < endRow) ? 1 : -1;
+    int error = dx + dy;
+    for(;;) {
+        if(!_passable(column, row)) {
+            return false;
+        }
+        if((column == endColumn) && (row == endRow)) {
+            return true;
+        }
+        const int error2 = 2 * error;
+        const bool moveX = error2 >= dy;
+        const bool moveY = error2 <= dx;
+        if(moveX && moveY && !(_passable(column + stepX, row) && _passable(column, row + stepY))) {
+            return false;
+        }
+        if(moveX) {
+            error += dy;
+            column += stepX;
+        }
+        if(moveY) {
+            error += dx;
+            row += stepY;
+        }
+    }
+}
+
+/**
+ * Estimate cost from a cell to the goal
+ */
+uint16_t PathPlanner::_heuristic(int column, int row)   // IN : cell
+                                                        // RET: octile distance to goal
+{
+    const int columns = _grid->columns();
+    const int dx = abs<int>((int)(_goal % columns) - column);
+    const int dy = abs<int>((int)(_goal / columns) - row);
+    return PLANNER_STRAIGHT * max<int>(dx, dy) + (PLANNER_DIAGONAL - PLANNER_STRAIGHT) * min<int>(dx, dy);
+}
+
+/**
+ * Add an open cell to the heap
+ */
+bool PathPlanner::_push(uint32_t cell, uint16_t g, uint16_t f)  // IN : open cell and it's costs
+                                                                // RET: false if heap is full
+{
+    if(_heapCount >= _heapCapacity) {
+        return false;
+    }
+
+    // sift up
+    const PlannerEntry entry = {cell, f, g};
+    unsigned int i = _heapCount;
+    _heapCount += 1;
+    while(i > 0) {
+        const unsigned int parent = (i - 1) >> 1;
+        if(!before(entry, _heap[parent])) {
+            break;
+        }
+        _heap[i] = _heap[parent];
+        i = parent;
+    }
+    _heap[i] = entry;
+    return true;
+}
+
+/**
+ * Move an entry down the heap to where it belongs
+ */
+static void siftDown(
+    PlannerEntry *heap,     // IN/OUT: heap
+    unsigned int count,     // IN : entries in heap
+    unsigned int i)         // IN : index of entry to move
+{
+    const PlannerEntry entry = heap[i];
+    for(;;) {
+        unsigned int child = (i << 1) + 1;
+        if(child >= count) {
+            break;
+        }
+        if((child + 1 < count) && before(heap[child + 1], heap[child])) {
+            child += 1;
+        }
+        if(!before(heap[child], entry)) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = entry;
+}
+
+/**
+ * Remove the open cell with lowest cost; heap must not be empty
+ */
+PlannerEntry PathPlanner::_pop()    // RET: open cell with lowest cost
+{
+    const PlannerEntry top = _heap[0];
+    _heapCount -= 1;
+    if(_heapCount > 0) {
+        _heap[0] = _heap[_heapCount];
+        siftDown(_heap, _heapCount, 0);
+    }
+    return top;
+}
+
+/**
+ * Squeeze stale entries out of the heap;
+ * those for cells that are closed or that
+ * were queued again at a lower cost.
+ */
+void PathPlanner::_compact()
+{
+    unsigned int kept = 0;
+    for(unsigned int i = 0; i < _heapCount; i += 1) {
+        if(_cost[_heap[i].cell] == _heap[i].g) {
+            _heap[kept] = _heap[i];
+            kept += 1;
+        }
+    }
+    _heapCount = kept;
+    for(unsigned int i = _heapCount >> 1; i-- > 0; ) {
+        siftDown(_heap, _heapCount, i);
+    }
+}
+
+/**
+ * Start planning a path between world positions;
+ * the search runs as step() is called.
+ */
+PlannerState PathPlanner::plan(
+    distance_type startX,   // IN : world position of start
+    distance_type startY,
+    distance_type goalX,    // IN : world position of goal
+    distance_type goalY)    // IN : world position of goal
+                            // RET: PLANNER_SEARCHING, or PLANNER_FAILED if
+                            //      either end is outside the grid or the goal is blocked
+{
+    if(!ready()) {
+        return _state = PLANNER_FAILED;
+    }
+
+    int startColumn, startRow, goalColumn, goalRow;
+    if(!_grid->worldToCell(startX, startY, startColumn, startRow)
+        || !_grid->worldToCell(goalX, goalY, goalColumn, goalRow)
+        || !fits(*_grid, goalColumn, goalRow, _clearance))
+    {
+        return _state = PLANNER_FAILED;
+    }
+
+    _start = startRow * _grid->columns() + startColumn;
+    _goal = goalRow * _grid->columns() + goalColumn;
+    _goalPoint = {goalX, goalY};
+    _heapCount = 0;
+    _cleared = 0;
+    _expanded = 0;
+    _waypointCount = 0;
+    return _state = PLANNER_SEARCHING;
+}
+
+/**
+ * Expand up to a number of cells.  The costs
+ * are cleared in chunks first, so starting a
+ * search on a large grid does not stall either.
+ */
+PlannerState PathPlanner::step(unsigned int maxExpansions)  // IN : most cells to expand
+                                                            // RET: state after expanding
+{
+    if(PLANNER_SEARCHING != _state) {
+        return _state;
+    }
+
+    const int columns = _grid->columns();
+    for(unsigned int n = 0; n < maxExpansions; n += 1) {
+        if(_cleared < _cellCount) {
+            const unsigned int end = min<unsigned int>(_cellCount, _cleared + PLANNER_CLEAR_CHUNK);
+            for(; _cleared < end; _cleared += 1) {
+                _cost[_cleared] = PLANNER_UNSEEN;
+            }
+            if(_cleared == _cellCount) {
+                // the rover is already at the start, so it is passable
+                _cost[_start] = 0;
+                _push(_start, 0, _heuristic(_start % columns, _start / columns));
+            }
+            continue;
+        }
+
+        if(0 == _heapCount) {
+            return _state = PLANNER_FAILED;     // no way to the goal
+        }
+        const PlannerEntry entry = _pop();
+        if(_cost[entry.cell] != entry.g) {
+            continue;   // stale; closed, or queued again at a lower cost
+        }
+        if(entry.cell == _goal) {
+            return _finish();
+        }
+        _cost[entry.cell] = entry.g | PLANNER_CLOSED;
+        _expanded += 1;
+
+        const int column = entry.cell % columns;
+        const int row = entry.cell / columns;
+        for(int i = 0; i < 8; i += 1) {
+            const int c = column + neighborColumn[i];
+            const int r = row + neighborRow[i];
+            if(!_passable(c, r)) {
+                continue;
+            }
+
+            // diagonal moves must not cut a corner
+            const bool diagonal = (i >= 4);
+            if(diagonal && !(_passable(c, row) && _passable(column, r))) {
+                continue;
+            }
+
+            const uint32_t neighbor = r * columns + c;
+            const uint16_t cost = _cost[neighbor];
+            const unsigned int g = entry.g + (diagonal ? PLANNER_DIAGONAL : PLANNER_STRAIGHT);
+            if((cost & PLANNER_CLOSED) || (g >= cost) || (g > PLANNER_MAX_COST)) {
+                continue;
+            }
+            _cost[neighbor] = g;
+            const uint16_t f = g + _heuristic(c, r);
+            if(!_push(neighbor, g, f)) {
+                _compact();
+                if(!_push(neighbor, g, f)) {
+                    return _state = PLANNER_FAILED;     // too many open cells
+                }
+            }
+        }
+    }
+    return _state;
+}
+
+/**
+ * Walk back from the goal along neighbors whose
+ * cost plus the step to the cell is the cell's cost,
+ * keeping only the corners the rover can not see past.
+ * The waypoints are gathered in the heap, which the
+ * search no longer needs.
+ */
+PlannerState PathPlanner::_finish()     // RET: PLANNER_PLANNED or PLANNER_FAILED
+{
+    const int columns = _grid->columns();
+    _heapCount = 0;
+    _waypointCount = 0;
+
+    uint32_t anchor = _goal;    // last waypoint kept
+    uint32_t corner = _goal;    // furthest corner seen from the anchor
+    uint32_t cell = _goal;
+    uint16_t cost;
+    reachedCost(_cost[cell], cost);
+    int direction = 0;
+    _keep(_goal);
+    while(cell != _start) {
+        // prefer to keep going the same way, so there are fewer corners
+        const int column = cell % columns;
+        const int row = cell / columns;
+        int next = -1;
+        for(int j = 0; (j < 8) && (next < 0); j += 1) {
+            const int i = (direction + j) & 7;
+            const int c = column + neighborColumn[i];
+            const int r = row + neighborRow[i];
+            uint16_t neighborCost;
+            if(!_grid->contains(c, r) || !reachedCost(_cost[r * columns + c], neighborCost)) {
+                continue;
+            }
+            const bool diagonal = (i >= 4);
+            if(diagonal && !(_passable(c, row) && _passable(column, r))) {
+                continue;
+            }
+            if(neighborCost + (diagonal ? PLANNER_DIAGONAL : PLANNER_STRAIGHT) == cost) {
+                next = i;
+                cost = neighborCost;
+            }
+        }
+        if(next < 0) {
+            return _state = PLANNER_FAILED; // can not happen; costs always lead back to start
+        }
+        const uint32_t previous = cell;
+        cell = (column + neighborColumn[next]) + (row + neighborRow[next]) * columns;
+
+        //
+        // at each turn, keep the last corner
+        // if the anchor can not see past it
+        //
+        if(next != direction) {
+            if(!_lineOfSight(anchor, previous)) {
+                if(!_keep(corner)) {
+                    return _state = PLANNER_FAILED;
+                }
+                anchor = corner;
+            }
+            corner = previous;
+            direction = next;
+        }
+        if((cell == _start) && !_lineOfSight(anchor, cell) && !_keep(corner)) {
+            return _state = PLANNER_FAILED;
+        }
+    }
+
+    // waypoints were gathered from the goal; put them in driving order
+    for(unsigned int i = 0, j = _waypointCount - 1; i < j; i += 1, j -= 1) {
+        const uint32_t swap = _heap[i].cell;
+        _heap[i].cell = _heap[j].cell;
+        _heap[j].cell = swap;
+    }
+    return _state = PLANNER_PLANNED;
+}
+
+/**
+ * Keep a waypoint of the path being finished
+ */
+bool PathPlanner::_keep(uint32_t cell)  // IN : cell of waypoint
+                                        // RET: false if there are too many waypoints
+{
+    if(_waypointCount >= _heapCapacity) {
+        return false;
+    }
+    _heap[_waypointCount].cell = cell;
+    _waypointCount += 1;
+    return true;
+}
+
+/**
+ * Get a waypoint on the planned path;
+ * the last waypoint is exactly the goal.
+ */
+Point2D PathPlanner::waypoint(unsigned int index)   // IN : 0 to waypointCount() - 1
+                                                    // RET: world position of waypoint
+{
+    if(index + 1 >= waypointCount()) {
+        return _goalPoint;
+    }
+    const int columns = _grid->columns();
+    return _grid->cellToWorld(_heap[index].cell % columns, _heap[index].cell / columns);
+}
+
+/**
+ * Deteremine if dependencies are attached
+ */
+bool PathPlanner::attached() // RET: true if attached, false if not
+{
+    return (NULL != _rover) && (NULL != _gotoGoalBehavior);
+}
+
+/**
+ * Attach dependencies for driving
+ */
+PathPlanner& PathPlanner::attach(
+    TwoWheelRover& rover,                   // IN : rover that drives the path
+    GotoGoalBehavior& gotoGoalBehavior)     // IN : behavior in attached state
+                                            // RET: this planner in attached state
+{
+    if(!attached()) {
+        _rover = &rover;
+        _gotoGoalBehavior = &gotoGoalBehavior;
+    }
+
+    return *this;
+}
+
+/**
+ * Detach dependencies
+ */
+PathPlanner& PathPlanner::detach() // RET: this planner in detached state
+{
+    if(attached()) {
+        cancel();
+        _rover = nullptr;
+        _gotoGoalBehavior = nullptr;
+    }
+
+    return *this;
+}
+
+/**
+ * Plan a path from the rover's pose to a goal
+ * and drive it once it is planned.
+ */
+PathPlanner& PathPlanner::planAndDrive(
+    distance_type x,            // IN : goal's horizontal position in world coordinates
+    distance_type y,            // IN : goal's vertical position in world coordinates
+    distance_type pointForward, // IN : point forward as fraction of wheelbase
+    distance_type tolerance)    // IN : tolerance in error term of each goal
+                                // RET: this planner
+{
+    cancel();
+    if(attached()) {
+        const Pose2D pose = _rover->pose();
+        _driving = (PLANNER_SEARCHING == plan(pose.x, pose.y, x, y));
+        _pointForward = pointForward;
+        _tolerance = tolerance;
+        _nextGoal = 0;
+    }
+    return *this;
+}
+
+/**
+ * Stop planning and driving
+ */
+PathPlanner& PathPlanner::cancel()  // RET: this planner
+{
+    if(_driving) {
+        _driving = false;
+        if(_nextGoal > 0) {
+            _gotoGoalBehavior->cancel();
+        }
+        if(PLANNER_SEARCHING == _state) {
+            _state = PLANNER_IDLE;
+        }
+    }
+    return *this;
+}
+
+/**
+ * Poll from the control loop; this searches for
+ * at most PLANNER_BUDGET_US, then drives the
+ * planned path one waypoint at a time.
+ */
+PathPlanner& PathPlanner::poll(unsigned long currentMillis) // IN : current time in milliseconds
+                                                            // RET: this planner
+{
+    if(!_driving) {
+        return *this;
+    }
+
+    if(PLANNER_SEARCHING == _state) {
+        const unsigned long startMicros = micros();
+        while((PLANNER_SEARCHING == step(PLANNER_BATCH)) && (micros() - startMicros < PLANNER_BUDGET_US)) {
+            // keep searching
+        }
+    }
+
+    switch(_state) {
+        case PLANNER_SEARCHING: {
+            break;  // search more next time
+        }
+        case PLANNER_PLANNED: {
+            // drive to the next waypoint once the last is reached
+            if(NOT_RUNNING == _gotoGoalBehavior->state()) {
+                if(_nextGoal < _waypointCount) {
+                    const Point2D goal = waypoint(_nextGoal);
+                    _nextGoal += 1;
+                    _gotoGoalBehavior->gotoGoal(goal.x, goal.y, _pointForward, _tolerance).poll(currentMillis);
+                } else {
+                    _driving = false;
+                }
+            }
+            break;
+        }
+        default: {
+            _driving = false;
+            break;
+        }
+    }
+    return *this;
+}
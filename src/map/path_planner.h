@@ -0,0 +1,219 @@
+#ifndef PATH_PLANNER_H
+#define PATH_PLANNER_H
+
+#include <stdint.h>
+
+#include "../config.h"
+#include "../rover/rover.h"
+#include "../rover/goto_goal.h"
+#include "../rover/pose.h"
+#include "./occupancy_grid.h"
+
+typedef enum PlannerState {
+    PLANNER_IDLE,       // nothing planned
+    PLANNER_SEARCHING,  // searching for a path; call step() or poll()
+    PLANNER_PLANNED,    // found a path; see waypointCount()
+    PLANNER_FAILED,     // there is no path, or it did not fit in memory
+} PlannerState;
+
+//
+// open cell in the planner's heap
+//
+typedef struct PlannerEntry {
+    uint32_t cell;  // index of cell; row * columns + column
+    uint16_t f;     // cost so far plus estimate of cost to goal
+    uint16_t g;     // cost so far, when queued; stale if the cell's cost is now lower
+} PlannerEntry;
+
+/**
+ * Plan a path across an OccupancyGrid with A*, then
+ * drive it one goal at a time with a GotoGoalBehavior.
+ *
+ * Memory is allocated once, by begin(), and is bounded;
+ * each cell has a 16 bit cost so far, with the top bit
+ * set once the cell is closed, and the open cells are
+ * a binary heap of at most heapCount entries.  Cells are
+ * queued again rather than moved within the heap when
+ * a cheaper way to them is found; the stale entries are
+ * skipped when popped, and squeezed out if the heap fills.
+ * The path is recovered by walking back from the goal
+ * through neighbors whose cost plus the step is the
+ * cell's cost, so no parent pointers are kept.
+ *
+ * Moves are to the 8 neighbors, costing 10 straight and
+ * 14 diagonal, without cutting corners.  Occupied cells
+ * and cells within the clearance of one are blocked;
+ * unknown cells are assumed free, so the rover can plan
+ * across parts of the map it has not seen.
+ *
+ * The search runs incrementally; poll() expands cells
+ * for at most PLANNER_BUDGET_US each call, so planning
+ * never stalls motor control.  The path is smoothed to
+ * the few waypoints where it must turn, by skipping any
+ * waypoint the rover can see past.
+ */
+class PathPlanner {
+    private:
+    // attached dependencies
+    TwoWheelRover* _rover = nullptr;
+    GotoGoalBehavior* _gotoGoalBehavior = nullptr;
+    OccupancyGrid* _grid = nullptr;
+
+    uint16_t *_cost = nullptr;          // cost so far of each cell, with PLANNER_CLOSED
+    unsigned int _cellCount = 0;
+    PlannerEntry *_heap = nullptr;      // open cells; waypoints once planned
+    unsigned int _heapCapacity = 0;
+    unsigned int _heapCount = 0;
+
+    PlannerState _state = PLANNER_IDLE;
+    int _clearance = 1;                 // cells around an occupied cell that are blocked
+    uint32_t _start = 0;                // cell where path starts
+    uint32_t _goal = 0;                 // cell where path ends
+    Point2D _goalPoint = {0, 0};        // world position of goal
+    unsigned int _cleared = 0;          // cells whose cost is cleared for this search
+    unsigned int _expanded = 0;         // cells expanded by the search
+    unsigned int _waypointCount = 0;    // waypoints in smoothed path
+
+    // driving the path
+    bool _driving = false;
+    distance_type _pointForward = 0;
+    distance_type _tolerance = 0;
+    unsigned int _nextGoal = 0;         // next waypoint to drive to
+
+    /**
+     * Determine if the rover fits in a cell,
+     * remembering if it does not.
+     */
+    bool _passable(int column, int row);    // IN : cell
+                                            // RET: true if the rover can be there
+
+    /**
+     * Determine if there is a clear straight line between cells
+     */
+    bool _lineOfSight(uint32_t from, uint32_t to);  // IN : cells at ends of line
+                                                    // RET: true if every cell on the line is passable
+
+    /**
+     * Estimate cost from a cell to the goal
+     */
+    uint16_t _heuristic(int column, int row);   // IN : cell
+                                                // RET: octile distance to goal
+
+    bool _push(uint32_t cell, uint16_t g, uint16_t f);  // IN : open cell and it's costs
+                                                        // RET: false if heap is full
+    PlannerEntry _pop();                                // RET: open cell with lowest cost
+    void _compact();                                    // squeeze stale entries out of the heap
+
+    /**
+     * Walk back from the goal and smooth the path into waypoints
+     */
+    PlannerState _finish();     // RET: PLANNER_PLANNED or PLANNER_FAILED
+
+    bool _keep(uint32_t cell);  // IN : cell of waypoint
+                                // RET: false if there are too many waypoints
+
+    public:
+
+    ~PathPlanner();
+
+    /**
+     * Allocate memory for planning on a grid;
+     * PSRAM is used if the board has it.
+     */
+    int begin(
+        OccupancyGrid &grid,        // IN : grid in ready state; it's size must not change
+        unsigned int heapCount);    // IN : most open cells
+                                    // RET: SUCCESS or FAILURE if memory could not be allocated
+
+    /**
+     * Determine if the planner is allocated
+     */
+    bool ready() { return nullptr != _cost; }
+
+    /**
+     * Set how far the path keeps from occupied cells
+     */
+    PathPlanner& setClearance(distance_type clearance);  // IN : cm from an occupied cell that is blocked
+                                                         // RET: this planner
+
+    /**
+     * Start planning a path between world positions
+     */
+    PlannerState plan(
+        distance_type startX,   // IN : world position of start
+        distance_type startY,
+        distance_type goalX,    // IN : world position of goal
+        distance_type goalY);   // IN : world position of goal
+                                // RET: PLANNER_SEARCHING, or PLANNER_FAILED if
+                                //      either end is outside the grid or the goal is blocked
+
+    /**
+     * Expand up to a number of cells
+     */
+    PlannerState step(unsigned int maxExpansions);  // IN : most cells to expand
+                                                    // RET: state after expanding
+
+    PlannerState state() { return _state; }
+
+    unsigned int expanded() {   // RET: cells expanded by the last search
+        return _expanded;
+    }
+
+    unsigned int waypointCount() {  // RET: waypoints in planned path, not counting the start
+        return (PLANNER_PLANNED == _state) ? _waypointCount : 0;
+    }
+
+    /**
+     * Get a waypoint on the planned path
+     */
+    Point2D waypoint(unsigned int index);   // IN : 0 to waypointCount() - 1
+                                            // RET: world position of waypoint
+
+    /**
+     * Deteremine if dependencies are attached
+     */
+    bool attached(); // RET: true if attached, false if not
+
+    /**
+     * Attach dependencies for driving
+     */
+    PathPlanner& attach(
+        TwoWheelRover& rover,                   // IN : rover that drives the path
+        GotoGoalBehavior& gotoGoalBehavior);    // IN : behavior in attached state
+                                                // RET: this planner in attached state
+
+    /**
+     * Detach dependencies
+     */
+    PathPlanner& detach(); // RET: this planner in detached state
+
+    /**
+     * Plan a path from the rover's pose to a goal
+     * and drive it once it is planned.
+     */
+    PathPlanner& planAndDrive(
+        distance_type x,            // IN : goal's horizontal position in world coordinates
+        distance_type y,            // IN : goal's vertical position in world coordinates
+        distance_type pointForward, // IN : point forward as fraction of wheelbase
+        distance_type tolerance);   // IN : tolerance in error term of each goal
+                                    // RET: this planner
+
+    bool driving() {    // RET: true if planning or driving toward a goal
+        return _driving;
+    }
+
+    /**
+     * Stop planning and driving
+     */
+    PathPlanner& cancel();  // RET: this planner
+
+    /**
+     * Poll from the control loop; this searches for
+     * at most PLANNER_BUDGET_US, then drives the
+     * planned path one waypoint at a time.
+     */
+    PathPlanner& poll(unsigned long currentMillis); // IN : current time in milliseconds
+                                                    // RET: this planner
+};
+
+#endif // PATH_PLANNER_H
@@ -0,0 +1,99 @@
+#include "message_bridge.h"
+#include "../string/strcopy.h"
+
+/**
+ * Determine if buses are attached
+ */
+bool MessageBridge::attached() // RET: true if attached, false if not
+{
+    return (nullptr != _fromBus) && (nullptr != _toBus);
+}
+
+/**
+ * Attach the buses to bridge
+ */
+MessageBridge& MessageBridge::attach(
+    MessageBus &fromBus,    // IN : bus on which messages are published (producer core)
+    MessageBus &toBus)      // IN : bus on which messages are republished (consumer core)
+                            // RET: this bridge in attached state
+{
+    if(!attached()) {
+        _fromBus = &fromBus;
+        _toBus = &toBus;
+    }
+    return *this;
+}
+
+/**
+ * Stop bridging and detach the buses
+ */
+MessageBridge& MessageBridge::detach() // RET: this bridge in detached state
+{
+    if(attached()) {
+        for(int message = 0; message < NUMBER_OF_MESSAGES; message += 1) {
+            unbridge((Message)message);
+        }
+        _fromBus = nullptr;
+        _toBus = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * Carry the given message across the bridge
+ */
+MessageBridge& MessageBridge::bridge(Message message) // IN : message to carry
+                                                      // RET: this bridge
+{
+    if(attached()) {
+        subscribe(*_fromBus, message);
+    }
+    return *this;
+}
+
+/**
+ * Stop carrying the given message across the bridge
+ */
+MessageBridge& MessageBridge::unbridge(Message message) // IN : message to stop carrying
+                                                        // RET: this bridge
+{
+    if(attached()) {
+        unsubscribe(*_fromBus, message);
+    }
+    return *this;
+}
+
+/**
+ * Copy a message from the 'from' bus into the ring.
+ * This is called on the producer core by the 'from' bus.
+ */
+void MessageBridge::onMessage(
+    Publisher &,                // IN : publisher of message
+    Message message,            // IN : message that was published
+    Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+    const char *data)           // IN : message data as a c-cstring
+{
+    BridgedMessage bridged;
+    bridged.message = message;
+    bridged.specifier = specifier;
+    strCopy(bridged.data, sizeof(bridged.data), (nullptr != data) ? data : "");
+
+    _ring.push(bridged);    // on overflow this is counted in dropped()
+}
+
+/**
+ * Republish all queued messages on the 'to' bus.
+ * Call this on the consumer core.
+ */
+int MessageBridge::poll() // RET: number of messages republished
+{
+    int count = 0;
+    if(attached()) {
+        BridgedMessage bridged;
+        while(_ring.pop(bridged)) {
+            publish(*_toBus, bridged.message, bridged.specifier, bridged.data);
+            count += 1;
+        }
+    }
+    return count;
+}
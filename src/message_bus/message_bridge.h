@@ -0,0 +1,111 @@
+#ifndef MESSAGE_BRIDGE_H
+#define MESSAGE_BRIDGE_H
+
+#include "message_bus.h"
+#include "../util/spsc_ring.h"
+
+const unsigned int MESSAGE_BRIDGE_CAPACITY = 16;    // messages in flight; must be power of two
+const unsigned int MESSAGE_BRIDGE_DATA_BYTES = 32;  // max bytes of message data, including terminator
+
+//
+// a bus message, with a copy of its data,
+// as it is carried across the bridge.
+//
+typedef struct BridgedMessage {
+    Message message;
+    Specifier specifier;
+    char data[MESSAGE_BRIDGE_DATA_BYTES];
+} BridgedMessage;
+
+/**
+ * Carry messages from one MessageBus to another
+ * MessageBus that is polled on a different core (or thread).
+ *
+ * The MessageBus is synchronous; subscribers are called
+ * on the publisher's stack.  The bridge subscribes to
+ * messages on the 'from' bus and copies each one into a
+ * single-producer/single-consumer lock-free ring.
+ * The other core calls poll(), which drains the ring and
+ * republishes the messages on the 'to' bus with their
+ * original specifier and data.
+ *
+ * - publish to the 'from' bus only from the producer core.
+ * - call poll() only from the consumer core.
+ * - if the ring is full the message is dropped and counted.
+ */
+class MessageBridge : public Publisher, public Subscriber {
+    private:
+    MessageBus *_fromBus = nullptr;
+    MessageBus *_toBus = nullptr;
+    SpscRing<BridgedMessage, MESSAGE_BRIDGE_CAPACITY> _ring;
+
+    public:
+
+    MessageBridge()
+        : Publisher(NONE), Subscriber()
+    {
+        // no-op
+    }
+
+    ~MessageBridge() {
+        detach();
+    }
+
+    /**
+     * Determine if buses are attached
+     */
+    bool attached();    // RET: true if attached, false if not
+
+    /**
+     * Attach the buses to bridge
+     */
+    MessageBridge& attach(
+        MessageBus &fromBus,    // IN : bus on which messages are published (producer core)
+        MessageBus &toBus);     // IN : bus on which messages are republished (consumer core)
+                                // RET: this bridge in attached state
+
+    /**
+     * Stop bridging and detach the buses
+     */
+    MessageBridge& detach();    // RET: this bridge in detached state
+
+    /**
+     * Carry the given message across the bridge
+     */
+    MessageBridge& bridge(Message message);     // IN : message to carry
+                                                // RET: this bridge
+
+    /**
+     * Stop carrying the given message across the bridge
+     */
+    MessageBridge& unbridge(Message message);   // IN : message to stop carrying
+                                                // RET: this bridge
+
+    /**
+     * Copy a message from the 'from' bus into the ring.
+     * This is called on the producer core by the 'from' bus.
+     */
+    void onMessage(
+        Publisher &publisher,       // IN : publisher of message
+        Message message,            // IN : message that was published
+        Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+        const char *data);          // IN : message data as a c-cstring
+
+    /**
+     * Republish all queued messages on the 'to' bus.
+     * Call this on the consumer core.
+     */
+    int poll();     // RET: number of messages republished
+
+    /**
+     * Number of messages waiting to be republished
+     */
+    unsigned int pending() { return _ring.count(); }
+
+    /**
+     * Number of messages dropped because the ring was full
+     */
+    unsigned int dropped() { return _ring.dropped(); }
+};
+
+#endif // MESSAGE_BRIDGE_H
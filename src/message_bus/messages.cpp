@@ -15,6 +15,8 @@ const char *Specifiers[NUMBER_OF_SPECIFIERS] = {
     "NONE",
     "LEFT_WHEEL",
     "RIGHT_WHEEL",
-    "ROVER"
+    "ROVER",
+    "BEHAVIOR",
+    "PATH",
 };
 
@@ -25,6 +25,7 @@ typedef enum Specifier {
     RIGHT_WHEEL_SPEC,
     ROVER_SPEC,
     BEHAVIOR_SPEC,
+    PATH_SPEC,
     NUMBER_OF_SPECIFIERS    // THIS SHOULD ALWAYS BE LAST
 } Specifier;
 
@@ -230,6 +230,28 @@ ParseIntegerResult parseUnsignedInt(
 	return {false, offset, 0};
 }
 
+/**
+ * Parse an unsigned integer that may not fit in an int,
+ * like a time in milliseconds.
+ */
+ParseUnsignedLongResult parseUnsignedLong(
+    String msg,     // IN : the string to scan
+    int offset)     // IN : the index into the string to start scanning
+                    // RET: scan result 
+                    //      matched is true if completely matched, false otherwise
+                    //      if matched, offset is index of character after matched span, 
+                    //      otherwise return the offset argument unchanged.
+                    //      if matched, value is the unsigned long value
+                    //      otherwise it is zero.
+{
+	ScanResult scan = scanDigits(msg, offset);
+	if (scan.matched) {
+		unsigned long value = strtoul(cstr(msg) + offset, NULL, 10);
+		return {true, scan.index, value};
+	}
+	return {false, offset, 0};
+}
+
 String booleans[] = {
     "true",
     "True",
@@ -64,6 +64,14 @@ typedef struct _ParseIntegerResult {
                     // otherwise 0
 } ParseIntegerResult;
 
+typedef struct _ParseUnsignedLongResult {
+    bool matched;   // true if fully matched, false if not
+    int index;      // if matched, index of first char after matched span,
+                    // otherwise index of start of scan
+    unsigned long value;    // if matched, then is the integer
+                            // otherwise 0
+} ParseUnsignedLongResult;
+
 typedef struct _ParseBooleanResult {
     bool matched;   // true if fully matched, false if not
     int index;      // if matched, index of first char after matched span,
@@ -99,6 +107,7 @@ extern ScanNumberResult scanUnsignedNumber(String msg, int offset);
 extern ParseDecimalResult parseUnsignedFloat(String msg, int offset);
 extern ParseDecimalResult parseFloat(String msg, int offset);
 extern ParseIntegerResult parseUnsignedInt(String msg, int offset);
+extern ParseUnsignedLongResult parseUnsignedLong(String msg, int offset);
 extern ParseBooleanResult parseBoolean(String msg, int offset);
 
 // scan_highorder
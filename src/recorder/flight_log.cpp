@@ -0,0 +1,316 @@
+#include <string.h>
+
+#include "flight_log.h"
+
+static const char FLIGHT_MAGIC[4] = {'F', 'R', 'E', 'C'};
+static const char FLIGHT_INDEX_MAGIC[4] = {'F', 'I', 'D', 'X'};
+static const char FLIGHT_FOOTER_MAGIC[4] = {'F', 'E', 'N', 'D'};
+
+static inline int packU8At(uint8_t *buffer, int offset, uint8_t value) {
+    buffer[offset] = value;
+    return offset + 1;
+}
+
+static inline int packU16At(uint8_t *buffer, int offset, uint16_t value) {
+    buffer[offset] = (uint8_t)(value);
+    buffer[offset + 1] = (uint8_t)(value >> 8);
+    return offset + 2;
+}
+
+static inline int packU32At(uint8_t *buffer, int offset, uint32_t value) {
+    buffer[offset] = (uint8_t)(value);
+    buffer[offset + 1] = (uint8_t)(value >> 8);
+    buffer[offset + 2] = (uint8_t)(value >> 16);
+    buffer[offset + 3] = (uint8_t)(value >> 24);
+    return offset + 4;
+}
+
+static inline int packFloatAt(uint8_t *buffer, int offset, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return packU32At(buffer, offset, bits);
+}
+
+static inline uint16_t unpackU16At(const uint8_t *buffer, uint32_t offset) {
+    return (uint16_t)(buffer[offset] | (buffer[offset + 1] << 8));
+}
+
+static inline uint32_t unpackU32At(const uint8_t *buffer, uint32_t offset) {
+    return (uint32_t)buffer[offset] 
+        | ((uint32_t)buffer[offset + 1] << 8) 
+        | ((uint32_t)buffer[offset + 2] << 16) 
+        | ((uint32_t)buffer[offset + 3] << 24);
+}
+
+static inline float unpackFloatAt(const uint8_t *buffer, uint32_t offset) {
+    const uint32_t bits = unpackU32At(buffer, offset);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * Write the record header
+ */
+static inline int packRecordHeaderAt(uint8_t *buffer, FlightRecordType type, int payloadBytes, uint32_t at) {
+    int offset = packU8At(buffer, 0, (uint8_t)type);
+    offset = packU8At(buffer, offset, (uint8_t)payloadBytes);
+    return packU32At(buffer, offset, at);
+}
+
+int packFlightHeader(uint8_t *buffer, int sizeOfBuffer, const FlightLogHeader &header) {
+    if((nullptr == buffer) || (sizeOfBuffer < FLIGHT_HEADER_BYTES)) return -1;
+
+    memcpy(buffer, FLIGHT_MAGIC, sizeof(FLIGHT_MAGIC));
+    int offset = packU16At(buffer, 4, (uint16_t)FLIGHT_LOG_VERSION);
+    offset = packU16At(buffer, offset, (uint16_t)FLIGHT_HEADER_BYTES);
+    offset = packU32At(buffer, offset, header.startMs);
+    offset = packFloatAt(buffer, offset, (float)header.wheelBase);
+    offset = packFloatAt(buffer, offset, (float)header.leftCircumference);
+    offset = packFloatAt(buffer, offset, (float)header.rightCircumference);
+    offset = packU16At(buffer, offset, header.leftCountsPerRevolution);
+    offset = packU16At(buffer, offset, header.rightCountsPerRevolution);
+    offset = packU16At(buffer, offset, header.posePollMs);
+    return packU16At(buffer, offset, header.poseMinEncoderCount);
+}
+
+int packFlightCommand(uint8_t *buffer, int sizeOfBuffer, uint32_t at, const char *text) {
+    if((nullptr == buffer) || (nullptr == text)) return -1;
+
+    int length = (int)strlen(text);
+    if(length > FLIGHT_COMMAND_BYTES) {
+        length = FLIGHT_COMMAND_BYTES;
+    }
+    if(sizeOfBuffer < FLIGHT_RECORD_HEADER_BYTES + length) return -1;
+
+    const int offset = packRecordHeaderAt(buffer, FLIGHT_RECORD_COMMAND, length, at);
+    memcpy(buffer + offset, text, length);
+    return offset + length;
+}
+
+int packFlightWheelPower(uint8_t *buffer, int sizeOfBuffer, uint32_t at, uint8_t wheel, bool forward, uint8_t pwm) {
+    const int length = 3;
+    if((nullptr == buffer) || (sizeOfBuffer < FLIGHT_RECORD_HEADER_BYTES + length)) return -1;
+
+    int offset = packRecordHeaderAt(buffer, FLIGHT_RECORD_WHEEL_POWER, length, at);
+    offset = packU8At(buffer, offset, wheel);
+    offset = packU8At(buffer, offset, forward ? 1 : 0);
+    return packU8At(buffer, offset, pwm);
+}
+
+int packFlightEncoders(uint8_t *buffer, int sizeOfBuffer, uint32_t at, uint8_t flags, const EncoderSample &sample) {
+    const int length = 17;
+    if((nullptr == buffer) || (sizeOfBuffer < FLIGHT_RECORD_HEADER_BYTES + length)) return -1;
+
+    int offset = packRecordHeaderAt(buffer, FLIGHT_RECORD_ENCODERS, length, at);
+    offset = packU8At(buffer, offset, flags);
+    offset = packU32At(buffer, offset, (uint32_t)sample.leftCount);
+    offset = packU32At(buffer, offset, (uint32_t)sample.rightCount);
+    offset = packU32At(buffer, offset, (uint32_t)sample.leftTicks);
+    return packU32At(buffer, offset, (uint32_t)sample.rightTicks);
+}
+
+int packFlightPose(uint8_t *buffer, int sizeOfBuffer, uint32_t at, const Pose2D &pose) {
+    const int length = 12;
+    if((nullptr == buffer) || (sizeOfBuffer < FLIGHT_RECORD_HEADER_BYTES + length)) return -1;
+
+    int offset = packRecordHeaderAt(buffer, FLIGHT_RECORD_POSE, length, at);
+    offset = packFloatAt(buffer, offset, (float)pose.x);
+    offset = packFloatAt(buffer, offset, (float)pose.y);
+    return packFloatAt(buffer, offset, (float)pose.angle);
+}
+
+int packFlightDropped(uint8_t *buffer, int sizeOfBuffer, uint32_t at, uint32_t count) {
+    const int length = 4;
+    if((nullptr == buffer) || (sizeOfBuffer < FLIGHT_RECORD_HEADER_BYTES + length)) return -1;
+
+    const int offset = packRecordHeaderAt(buffer, FLIGHT_RECORD_DROPPED, length, at);
+    return packU32At(buffer, offset, count);
+}
+
+int packFlightIndexHeader(uint8_t *buffer, int sizeOfBuffer, uint32_t count) {
+    if((nullptr == buffer) || (sizeOfBuffer < FLIGHT_INDEX_HEADER_BYTES)) return -1;
+
+    memcpy(buffer, FLIGHT_INDEX_MAGIC, sizeof(FLIGHT_INDEX_MAGIC));
+    return packU32At(buffer, 4, count);
+}
+
+int packFlightIndexEntry(uint8_t *buffer, int sizeOfBuffer, uint32_t offset, uint32_t at) {
+    if((nullptr == buffer) || (sizeOfBuffer < FLIGHT_INDEX_ENTRY_BYTES)) return -1;
+
+    return packU32At(buffer, packU32At(buffer, 0, offset), at);
+}
+
+int packFlightFooter(uint8_t *buffer, int sizeOfBuffer, uint32_t indexOffset) {
+    if((nullptr == buffer) || (sizeOfBuffer < FLIGHT_FOOTER_BYTES)) return -1;
+
+    memcpy(buffer, FLIGHT_FOOTER_MAGIC, sizeof(FLIGHT_FOOTER_MAGIC));
+    return packU32At(buffer, 4, indexOffset);
+}
+
+
+FlightLogReader::FlightLogReader(
+    const uint8_t *log,     // IN : the log bytes
+    uint32_t size)          // IN : number of bytes in the log
+    : _log(log), _size(size)
+{
+    memset(&_header, 0, sizeof(_header));
+    if((nullptr == log) 
+        || (size < (uint32_t)FLIGHT_HEADER_BYTES)
+        || (0 != memcmp(log, FLIGHT_MAGIC, sizeof(FLIGHT_MAGIC)))
+        || (FLIGHT_LOG_VERSION != unpackU16At(log, 4)))
+    {
+        return;
+    }
+
+    const uint16_t headerBytes = unpackU16At(log, 6);
+    if((headerBytes < FLIGHT_HEADER_BYTES) || (headerBytes > size)) {
+        return;
+    }
+    _header.startMs = unpackU32At(log, 8);
+    _header.wheelBase = unpackFloatAt(log, 12);
+    _header.leftCircumference = unpackFloatAt(log, 16);
+    _header.rightCircumference = unpackFloatAt(log, 20);
+    _header.leftCountsPerRevolution = unpackU16At(log, 24);
+    _header.rightCountsPerRevolution = unpackU16At(log, 26);
+    _header.posePollMs = unpackU16At(log, 28);
+    _header.poseMinEncoderCount = unpackU16At(log, 30);
+    _offset = headerBytes;
+    _end = size;
+
+    //
+    // if the log was ended cleanly, the footer
+    // tells us where the records end and the index starts
+    //
+    if(size >= (uint32_t)(headerBytes + FLIGHT_INDEX_HEADER_BYTES + FLIGHT_FOOTER_BYTES)) {
+        const uint32_t footer = size - FLIGHT_FOOTER_BYTES;
+        if(0 == memcmp(log + footer, FLIGHT_FOOTER_MAGIC, sizeof(FLIGHT_FOOTER_MAGIC))) {
+            const uint32_t indexHeader = unpackU32At(log, footer + 4);
+            if((indexHeader >= headerBytes) 
+                && (indexHeader + FLIGHT_INDEX_HEADER_BYTES <= footer)
+                && (0 == memcmp(log + indexHeader, FLIGHT_INDEX_MAGIC, sizeof(FLIGHT_INDEX_MAGIC))))
+            {
+                const uint32_t count = unpackU32At(log, indexHeader + 4);
+                if(indexHeader + FLIGHT_INDEX_HEADER_BYTES + count * FLIGHT_INDEX_ENTRY_BYTES == footer) {
+                    _end = indexHeader;
+                    _indexOffset = indexHeader + FLIGHT_INDEX_HEADER_BYTES;
+                    _indexCount = count;
+                }
+            }
+        }
+    }
+
+    _valid = true;
+}
+
+/**
+ * Read the next record
+ */
+bool FlightLogReader::next(FlightRecord &record)    // OUT: on true, the decoded record
+                                                    // RET: true if a record was read,
+                                                    //      false at end of log or on a damaged record
+{
+    if(!_valid || (_offset + FLIGHT_RECORD_HEADER_BYTES > _end)) {
+        return false;
+    }
+
+    const uint8_t *bytes = _log + _offset;
+    const uint8_t length = bytes[1];
+    if(_offset + FLIGHT_RECORD_HEADER_BYTES + length > _end) {
+        return false;   // truncated record, like from a power loss mid-write
+    }
+
+    memset(&record, 0, sizeof(record));
+    record.type = (FlightRecordType)bytes[0];
+    record.at = unpackU32At(bytes, 2);
+    record.offset = _offset;
+    record.encoders.ms = record.at;
+
+    const uint8_t *payload = bytes + FLIGHT_RECORD_HEADER_BYTES;
+    switch(record.type) {
+        case FLIGHT_RECORD_COMMAND: {
+            record.text = (const char *)payload;
+            record.textLength = length;
+            break;
+        }
+        case FLIGHT_RECORD_WHEEL_POWER: {
+            if(length < 3) return false;
+            record.wheel = payload[0];
+            record.forward = (0 != payload[1]);
+            record.pwm = payload[2];
+            break;
+        }
+        case FLIGHT_RECORD_ENCODERS: {
+            if(length < 17) return false;
+            record.flags = payload[0];
+            record.encoders.leftCount = (int32_t)unpackU32At(payload, 1);
+            record.encoders.rightCount = (int32_t)unpackU32At(payload, 5);
+            record.encoders.leftTicks = (int32_t)unpackU32At(payload, 9);
+            record.encoders.rightTicks = (int32_t)unpackU32At(payload, 13);
+            break;
+        }
+        case FLIGHT_RECORD_POSE: {
+            if(length < 12) return false;
+            record.pose.x = unpackFloatAt(payload, 0);
+            record.pose.y = unpackFloatAt(payload, 4);
+            record.pose.angle = unpackFloatAt(payload, 8);
+            break;
+        }
+        case FLIGHT_RECORD_DROPPED: {
+            if(length < 4) return false;
+            record.dropped = unpackU32At(payload, 0);
+            break;
+        }
+        default: {
+            // unknown record types are skipped by readers that don't understand them
+            break;
+        }
+    }
+
+    _offset += FLIGHT_RECORD_HEADER_BYTES + length;
+    return true;
+}
+
+/**
+ * Position the reader at the last indexed record
+ * before a time.
+ */
+FlightLogReader& FlightLogReader::seek(uint32_t atMs)   // IN : time in ms since startup
+                                                        // RET: this reader
+{
+    rewind();
+    if(_valid && indexed()) {
+        //
+        // binary search for the last entry before atMs; records
+        // in earlier blocks can be no later than that entry
+        //
+        uint32_t low = 0;
+        uint32_t high = _indexCount;
+        while(low < high) {
+            const uint32_t middle = low + (high - low) / 2;
+            if(unpackU32At(_log, _indexOffset + middle * FLIGHT_INDEX_ENTRY_BYTES + 4) <= atMs) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        if(low > 0) {
+            const uint32_t offset = unpackU32At(_log, _indexOffset + (low - 1) * FLIGHT_INDEX_ENTRY_BYTES);
+            if(offset < _end) {
+                _offset = offset;
+            }
+        }
+    }
+    return *this;
+}
+
+/**
+ * Position the reader back at the first record
+ */
+FlightLogReader& FlightLogReader::rewind()  // RET: this reader
+{
+    if(_valid) {
+        _offset = unpackU16At(_log, 6);
+    }
+    return *this;
+}
@@ -0,0 +1,170 @@
+#ifndef RECORDER_FLIGHT_LOG_H
+#define RECORDER_FLIGHT_LOG_H
+
+#include <stdint.h>
+
+#include "../rover/pose.h"
+#include "../rover/odometry.h"
+
+//
+// ---------------- flight log file format --------------------
+//
+// An append-only binary log of what the rover was told
+// to do and what it measured, so a drive can be replayed
+// offline through the same pose estimation.
+//
+// The file starts with a FLIGHT_HEADER_BYTES header that
+// records the rover geometry, followed by records of
+//
+//    [type u8][payload length u8][at u32][payload]
+//
+// where 'at' is ms since startup.  If the recorder is
+// ended cleanly, then an index of (offset, at) pairs
+// and a footer follow the last record;
+//
+//    ["FIDX"][count u32][offset u32, at u32]*["FEND"][index offset u32]
+//
+// A log that was cut off by a power loss has no index
+// and is read by scanning the records from the header.
+//
+// As with binary telemetry, multi-byte values are
+// little-endian and floats are IEEE-754 single precision.
+//
+
+const unsigned int FLIGHT_LOG_VERSION = 1;
+const int FLIGHT_HEADER_BYTES = 32;
+const int FLIGHT_RECORD_HEADER_BYTES = 6;
+const int FLIGHT_INDEX_HEADER_BYTES = 8;
+const int FLIGHT_INDEX_ENTRY_BYTES = 8;
+const int FLIGHT_FOOTER_BYTES = 8;
+const int FLIGHT_COMMAND_BYTES = 255;   // longest command text that is recorded
+
+typedef enum FlightRecordType {
+    FLIGHT_RECORD_NONE = 0,
+    FLIGHT_RECORD_COMMAND = 1,      // [command text]; not terminated
+    FLIGHT_RECORD_WHEEL_POWER = 2,  // [wheel u8][forward u8][pwm u8]; wheel 0 is left, 1 is right
+    FLIGHT_RECORD_ENCODERS = 3,     // [flags u8][left count i32][right count i32][left ticks u32][right ticks u32]
+    FLIGHT_RECORD_POSE = 4,         // [x f32][y f32][angle f32]
+    FLIGHT_RECORD_DROPPED = 5,      // [count u32]; records lost before this one because the writer fell behind
+} FlightRecordType;
+
+// flags for FLIGHT_RECORD_ENCODERS
+const uint8_t FLIGHT_ENCODERS_START = 0x01;    // sample that started pose estimation at the origin
+
+//
+// the rover geometry needed to replay the log
+//
+typedef struct FlightLogHeader {
+    uint32_t startMs;                       // ms since startup when the log began
+    distance_type wheelBase;
+    distance_type leftCircumference;
+    distance_type rightCircumference;
+    uint16_t leftCountsPerRevolution;
+    uint16_t rightCountsPerRevolution;
+    uint16_t posePollMs;                    // POSE_POLL_MS when recorded
+    uint16_t poseMinEncoderCount;           // POSE_MIN_ENCODER_COUNT when recorded
+} FlightLogHeader;
+
+//
+// one decoded record; only the fields for 'type' are valid
+//
+typedef struct FlightRecord {
+    FlightRecordType type;
+    uint32_t at;                // ms since startup
+    uint32_t offset;            // offset of record in the log
+
+    const char *text;           // FLIGHT_RECORD_COMMAND; points into the log, not terminated
+    int textLength;
+
+    uint8_t wheel;              // FLIGHT_RECORD_WHEEL_POWER
+    bool forward;
+    uint8_t pwm;
+
+    uint8_t flags;              // FLIGHT_RECORD_ENCODERS
+    EncoderSample encoders;
+
+    Pose2D pose;                // FLIGHT_RECORD_POSE
+
+    uint32_t dropped;           // FLIGHT_RECORD_DROPPED
+} FlightRecord;
+
+
+//
+// pack functions write one record and return the number
+// of bytes written, or -1 if it did not fit in the buffer.
+//
+int packFlightHeader(uint8_t *buffer, int sizeOfBuffer, const FlightLogHeader &header);
+int packFlightCommand(uint8_t *buffer, int sizeOfBuffer, uint32_t at, const char *text);
+int packFlightWheelPower(uint8_t *buffer, int sizeOfBuffer, uint32_t at, uint8_t wheel, bool forward, uint8_t pwm);
+int packFlightEncoders(uint8_t *buffer, int sizeOfBuffer, uint32_t at, uint8_t flags, const EncoderSample &sample);
+int packFlightPose(uint8_t *buffer, int sizeOfBuffer, uint32_t at, const Pose2D &pose);
+int packFlightDropped(uint8_t *buffer, int sizeOfBuffer, uint32_t at, uint32_t count);
+int packFlightIndexHeader(uint8_t *buffer, int sizeOfBuffer, uint32_t count);
+int packFlightIndexEntry(uint8_t *buffer, int sizeOfBuffer, uint32_t offset, uint32_t at);
+int packFlightFooter(uint8_t *buffer, int sizeOfBuffer, uint32_t indexOffset);
+
+
+/**
+ * Read a flight log that is entirely in memory.
+ * The reader does not copy or own the log.
+ */
+class FlightLogReader {
+    private:
+    const uint8_t *_log;
+    uint32_t _size;
+    uint32_t _end = 0;          // offset just past the last record
+    uint32_t _indexOffset = 0;  // offset of first index entry or 0 if no index
+    uint32_t _indexCount = 0;
+    uint32_t _offset = 0;       // offset of next record to read
+    FlightLogHeader _header;
+    bool _valid = false;
+
+    public:
+
+    FlightLogReader(
+        const uint8_t *log,     // IN : the log bytes
+        uint32_t size);         // IN : number of bytes in the log
+
+    /**
+     * Determine if the log has a valid header
+     */
+    bool valid() { return _valid; }
+
+    /**
+     * Get the rover geometry recorded in the header
+     */
+    const FlightLogHeader &header() { return _header; }
+
+    /**
+     * Determine if the log was ended cleanly and has an index
+     */
+    bool indexed() { return 0 != _indexOffset; }
+
+    /**
+     * Get the number of index entries
+     */
+    uint32_t indexCount() { return _indexCount; }
+
+    /**
+     * Read the next record
+     */
+    bool next(FlightRecord &record);    // OUT: on true, the decoded record
+                                        // RET: true if a record was read,
+                                        //      false at end of log or on a damaged record
+
+    /**
+     * Position the reader at the last indexed record
+     * before a time, so reading from there
+     * includes every record at or after the time.
+     * An unindexed log is positioned at the first record.
+     */
+    FlightLogReader& seek(uint32_t atMs);   // IN : time in ms since startup
+                                            // RET: this reader
+
+    /**
+     * Position the reader back at the first record
+     */
+    FlightLogReader& rewind();  // RET: this reader
+};
+
+#endif // RECORDER_FLIGHT_LOG_H
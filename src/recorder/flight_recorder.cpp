@@ -0,0 +1,251 @@
+#include "flight_recorder.h"
+#include "../error.h"
+
+/**
+ * Create the log file and write it's header.
+ */
+int FlightRecorder::begin(
+    const char *path,               // IN : path of log file; it is replaced
+    const FlightLogHeader &header)  // IN : rover geometry for replay
+                                    // RET: SUCCESS or FAILURE if file could not be written
+{
+    end();
+    if(nullptr == path) {
+        return FAILURE;
+    }
+
+    _file = fopen(path, "wb");
+    if(nullptr == _file) {
+        return FAILURE;
+    }
+    setvbuf(_file, nullptr, _IONBF, 0);  // we already write whole chunks
+
+    uint8_t buffer[FLIGHT_HEADER_BYTES];
+    const int length = packFlightHeader(buffer, sizeof(buffer), header);
+    if((length <= 0) || (1 != fwrite(buffer, length, 1, _file))) {
+        fclose(_file);
+        _file = nullptr;
+        return FAILURE;
+    }
+    _written = length;
+    _indexCount = 0;
+    _writing = -1;
+    _writeOffset = 0;
+    _writeFailed = false;
+
+    //
+    // every block starts out free
+    //
+    uint8_t block;
+    while(_full.pop(block)) {}
+    while(_free.pop(block)) {}
+    for(unsigned int i = 0; i < FLIGHT_BLOCK_COUNT; i += 1) {
+        _free.push((uint8_t)i);
+    }
+    _current = -1;
+    _pendingDropped = 0;
+
+    _recording.store(true, std::memory_order_release);
+    return SUCCESS;
+}
+
+/**
+ * Write any buffered records, the index and
+ * the footer, then close the file.
+ */
+FlightRecorder& FlightRecorder::end()   // RET: this recorder
+{
+    if(nullptr != _file) {
+        _recording.store(false, std::memory_order_release);
+        _handoff();
+        while(_writeChunk()) {
+            // write everything that is buffered
+        }
+
+        uint8_t buffer[FLIGHT_INDEX_HEADER_BYTES + FLIGHT_FOOTER_BYTES];
+        const uint32_t indexOffset = _written;
+        bool ok = (1 == fwrite(buffer, packFlightIndexHeader(buffer, sizeof(buffer), _indexCount), 1, _file));
+        for(unsigned int i = 0; ok && (i < _indexCount); i += 1) {
+            ok = (1 == fwrite(buffer, packFlightIndexEntry(buffer, sizeof(buffer), _indexOffset[i], _indexAt[i]), 1, _file));
+        }
+        if(ok) {
+            fwrite(buffer, packFlightFooter(buffer, sizeof(buffer), indexOffset), 1, _file);
+        }
+
+        fclose(_file);
+        _file = nullptr;
+    }
+    return *this;
+}
+
+void FlightRecorder::recordCommand(uint32_t at, const char *text) {
+    if(nullptr != text) {
+        _append(at, [&](uint8_t *buffer, int sizeOfBuffer) {
+            return packFlightCommand(buffer, sizeOfBuffer, at, text);
+        });
+    }
+}
+
+void FlightRecorder::recordWheelPower(uint32_t at, uint8_t wheel, bool forward, uint8_t pwm) {
+    _append(at, [&](uint8_t *buffer, int sizeOfBuffer) {
+        return packFlightWheelPower(buffer, sizeOfBuffer, at, wheel, forward, pwm);
+    });
+}
+
+void FlightRecorder::recordEncoders(uint32_t at, uint8_t flags, const EncoderSample &sample) {
+    _append(at, [&](uint8_t *buffer, int sizeOfBuffer) {
+        return packFlightEncoders(buffer, sizeOfBuffer, at, flags, sample);
+    });
+}
+
+void FlightRecorder::recordPose(uint32_t at, const Pose2D &pose) {
+    _append(at, [&](uint8_t *buffer, int sizeOfBuffer) {
+        return packFlightPose(buffer, sizeOfBuffer, at, pose);
+    });
+}
+
+/**
+ * Hand off a partially filled block
+ * if it has held records for FLIGHT_FLUSH_MS.
+ */
+FlightRecorder& FlightRecorder::flush(uint32_t currentMillis)   // IN : milliseconds since startup
+                                                                // RET: this recorder
+{
+    if((_current >= 0) && (_blockRecords[_current] > 0) 
+        && ((currentMillis - _blockAt[_current]) >= FLIGHT_FLUSH_MS)) 
+    {
+        _handoff();
+    }
+    return *this;
+}
+
+/**
+ * Write up to FLIGHT_WRITE_BYTES of the handed off 
+ * blocks to the file.
+ */
+FlightRecorder& FlightRecorder::poll()  // RET: this recorder
+{
+    _writeChunk();
+    return *this;
+}
+
+/**
+ * Get room in the current block, starting a new block if necessary
+ */
+uint8_t *FlightRecorder::_space(
+    uint32_t at,        // IN : time of record about to be packed
+    int &available)     // OUT: bytes available in block
+                        // RET: pointer to free space in current block
+                        //      or nullptr if there is no free block
+{
+    if(_current < 0) {
+        uint8_t block;
+        if(!_free.pop(block)) {
+            return nullptr;
+        }
+        _current = block;
+        _blockLength[block] = 0;
+        _blockRecords[block] = 0;
+        _blockAt[block] = at;
+
+        //
+        // note any gap before the records in this block
+        //
+        if(_pendingDropped > 0) {
+            _blockLength[block] = packFlightDropped(_blocks[block], FLIGHT_BLOCK_BYTES, at, _pendingDropped);
+            _blockRecords[block] = 1;
+            _pendingDropped = 0;
+        }
+    }
+
+    available = FLIGHT_BLOCK_BYTES - _blockLength[_current];
+    return _blocks[_current] + _blockLength[_current];
+}
+
+/**
+ * Account for a record packed into the current block
+ */
+void FlightRecorder::_commit(
+    uint32_t at,        // IN : time of record
+    int length)         // IN : bytes packed
+{
+    if(0 == _blockRecords[_current]) {
+        _blockAt[_current] = at;
+    }
+    _blockLength[_current] += length;
+    _blockRecords[_current] += 1;
+}
+
+/**
+ * Hand the current block to the writer
+ */
+void FlightRecorder::_handoff() {
+    if(_current >= 0) {
+        if(_blockRecords[_current] > 0) {
+            _full.push((uint8_t)_current);  // never full; there are only FLIGHT_BLOCK_COUNT blocks
+        } else {
+            _free.push((uint8_t)_current);
+        }
+        _current = -1;
+    }
+}
+
+/**
+ * Write the next chunk of the block being written,
+ * starting the next handed off block if necessary.
+ * A block is indexed once all of it is written.
+ */
+bool FlightRecorder::_writeChunk()  // RET: true if there was a block to write,
+                                    //      false if the writer is idle
+{
+    if(_writing < 0) {
+        uint8_t block;
+        if(!_full.pop(block)) {
+            return false;
+        }
+        _writing = block;
+        _writeOffset = 0;
+
+        if((nullptr == _file) || _writeFailed 
+            || ((_written + _blockLength[block]) > FLIGHT_LOG_MAX_BYTES)) 
+        {
+            _dropBlock();
+            return true;
+        }
+    }
+
+    const uint8_t block = (uint8_t)_writing;
+    const uint16_t length = _blockLength[block];
+    const uint16_t chunk = ((length - _writeOffset) < FLIGHT_WRITE_BYTES) ? (length - _writeOffset) : FLIGHT_WRITE_BYTES;
+    if((chunk > 0) && (1 != fwrite(_blocks[block] + _writeOffset, chunk, 1, _file))) {
+        //
+        // part of the block may be in the file,
+        // so nothing after it can be read back.
+        //
+        _writeFailed = true;
+        _dropBlock();
+        return true;
+    }
+    _writeOffset += chunk;
+
+    if(_writeOffset >= length) {
+        if(_indexCount < FLIGHT_INDEX_ENTRIES) {
+            _indexOffset[_indexCount] = _written;
+            _indexAt[_indexCount] = _blockAt[block];
+            _indexCount += 1;
+        }
+        _written += length;
+        _writing = -1;
+        _free.push(block);
+    }
+    return true;
+}
+
+/**
+ * Give up on the block being written
+ */
+void FlightRecorder::_dropBlock() {
+    _dropped.fetch_add(_blockRecords[_writing], std::memory_order_relaxed);
+    _free.push((uint8_t)_writing);
+    _writing = -1;
+}
@@ -0,0 +1,205 @@
+#ifndef RECORDER_FLIGHT_RECORDER_H
+#define RECORDER_FLIGHT_RECORDER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+
+#include "../config.h"
+#include "../util/spsc_ring.h"
+#include "flight_log.h"
+
+/**
+ * Append-only binary recorder of commands, wheel power,
+ * encoder samples and poses; see flight_log.h for the format.
+ *
+ * Records are packed in place into one of FLIGHT_BLOCK_COUNT
+ * fixed size blocks, so recording never allocates and never
+ * touches the file.  A block is handed to the writer when it
+ * is full, or when it has held records for FLIGHT_FLUSH_MS,
+ * and poll() writes handed off blocks to the file and returns
+ * them for reuse.  A flash write blocks the caller, so
+ * poll() writes at most FLIGHT_WRITE_BYTES of a block per call
+ * and a block is spread across several polls.
+ *
+ * The record...() functions and flush() are the producer side
+ * and poll() is the writer side; like SpscRing, each side may
+ * run on it's own core.  If the writer falls behind so there
+ * is no free block, then records are dropped, counted, and
+ * a FLIGHT_RECORD_DROPPED record notes the gap in the log.
+ */
+class FlightRecorder {
+    private:
+
+    uint8_t _blocks[FLIGHT_BLOCK_COUNT][FLIGHT_BLOCK_BYTES];
+    uint16_t _blockLength[FLIGHT_BLOCK_COUNT];      // bytes of records in block
+    uint16_t _blockRecords[FLIGHT_BLOCK_COUNT];     // number of records in block
+    uint32_t _blockAt[FLIGHT_BLOCK_COUNT];          // time of first record in block
+    SpscRing<uint8_t, FLIGHT_BLOCK_COUNT> _full;    // producer -> writer
+    SpscRing<uint8_t, FLIGHT_BLOCK_COUNT> _free;    // writer -> producer
+
+    std::atomic<bool> _recording;
+    std::atomic<uint32_t> _dropped;     // records lost by either side
+
+    // producer side
+    int _current = -1;                  // block being filled or -1 if none
+    uint32_t _pendingDropped = 0;       // records dropped since last FLIGHT_RECORD_DROPPED
+
+    // writer side
+    FILE *_file = nullptr;
+    uint32_t _written = 0;              // bytes written to file
+    int _writing = -1;                  // block being written or -1 if none
+    uint16_t _writeOffset = 0;          // bytes of _writing already written
+    bool _writeFailed = false;          // true if a write failed; the rest of the log is dropped
+    uint32_t _indexOffset[FLIGHT_INDEX_ENTRIES];    // file offset of each written block
+    uint32_t _indexAt[FLIGHT_INDEX_ENTRIES];        // time of first record in each written block
+    unsigned int _indexCount = 0;
+
+    /**
+     * Get room in the current block, starting a new block if necessary
+     */
+    uint8_t *_space(
+        uint32_t at,        // IN : time of record about to be packed
+        int &available);    // OUT: bytes available in block
+                            // RET: pointer to free space in current block
+                            //      or nullptr if there is no free block
+
+    /**
+     * Account for a record packed into the current block
+     */
+    void _commit(
+        uint32_t at,        // IN : time of record
+        int length);        // IN : bytes packed
+
+    /**
+     * Hand the current block to the writer
+     */
+    void _handoff();
+
+    /**
+     * Write the next chunk of the block being written,
+     * starting the next handed off block if necessary
+     */
+    bool _writeChunk(); // RET: true if there was a block to write,
+                        //      false if the writer is idle
+
+    /**
+     * Give up on the block being written
+     */
+    void _dropBlock();
+
+    /**
+     * Pack a record into the current block, moving
+     * to a new block if it does not fit.
+     */
+    template <typename PACK> void _append(
+        uint32_t at,        // IN : time of record
+        PACK pack)          // IN : int pack(uint8_t *buffer, int sizeOfBuffer)
+    {
+        if(!recording()) return;
+
+        int available;
+        uint8_t *space = _space(at, available);
+        int length = (nullptr != space) ? pack(space, available) : -1;
+        if((nullptr != space) && (length < 0)) {
+            // does not fit; try again in an empty block
+            _handoff();
+            space = _space(at, available);
+            length = (nullptr != space) ? pack(space, available) : -1;
+        }
+        if(length < 0) {
+            _pendingDropped += 1;
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        _commit(at, length);
+    }
+
+    public:
+
+    FlightRecorder()
+        : _recording(false), _dropped(0)
+    {
+        // no-op
+    }
+
+    ~FlightRecorder() {
+        end();
+    }
+
+    /**
+     * Determine if the recorder is recording
+     */
+    bool recording() { return _recording.load(std::memory_order_acquire); }
+
+    /**
+     * Get the number of records that were dropped
+     * because the writer fell behind or the log was full
+     */
+    uint32_t dropped() { return _dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * Get the number of bytes written to the log
+     */
+    uint32_t written() { return _written; }
+
+    /**
+     * Create the log file and write it's header.
+     * Call before either side starts running.
+     */
+    int begin(
+        const char *path,               // IN : path of log file; it is replaced
+        const FlightLogHeader &header); // IN : rover geometry for replay
+                                        // RET: SUCCESS or FAILURE if file could not be written
+
+    /**
+     * Write any buffered records, the index and
+     * the footer, then close the file.
+     * Call only when neither side is running.
+     */
+    FlightRecorder& end();  // RET: this recorder
+
+    /**
+     * Record a command as it was received
+     */
+    void recordCommand(uint32_t at, const char *text);
+
+    /**
+     * Record a change in a wheel's motor power
+     */
+    void recordWheelPower(uint32_t at, uint8_t wheel, bool forward, uint8_t pwm);
+
+    /**
+     * Record an encoder sample used for pose estimation
+     */
+    void recordEncoders(uint32_t at, uint8_t flags, const EncoderSample &sample);
+
+    /**
+     * Record an estimated pose
+     */
+    void recordPose(uint32_t at, const Pose2D &pose);
+
+    /**
+     * Hand off a partially filled block
+     * if it has held records for FLIGHT_FLUSH_MS.
+     * This is the producer side.
+     */
+    FlightRecorder& flush(uint32_t currentMillis);  // IN : milliseconds since startup
+                                                    // RET: this recorder
+
+    /**
+     * Write up to FLIGHT_WRITE_BYTES of the handed off 
+     * blocks to the file.
+     * This is the writer side.
+     */
+    FlightRecorder& poll(); // RET: this recorder
+
+    /**
+     * Determine if the writer has handed off blocks 
+     * that are not completely written yet.
+     * This is the writer side.
+     */
+    bool writing() { return (_writing >= 0) || !_full.empty(); }
+};
+
+#endif // RECORDER_FLIGHT_RECORDER_H
@@ -0,0 +1,62 @@
+#include "flight_wheel_listener.h"
+
+/**
+ * Determine if listening for wheel power changes
+ */
+bool FlightWheelListener::attached() {
+    return nullptr != _messageBus;
+}
+
+/**
+ * Start listening for wheel power changes
+ */
+FlightWheelListener& FlightWheelListener::attach(
+    MessageBus &messageBus,     // IN : bus on which wheels publish WHEEL_POWER
+    DriveWheel &leftWheel,      // IN : left drive wheel
+    DriveWheel &rightWheel,     // IN : right drive wheel
+    FlightRecorder &recorder)   // IN : recorder to receive changes
+                                // RET: this listener in attached state
+{
+    if(!attached()) {
+        _messageBus = &messageBus;
+        _leftWheel = &leftWheel;
+        _rightWheel = &rightWheel;
+        _recorder = &recorder;
+        subscribe(*_messageBus, WHEEL_POWER);
+    }
+    return *this;
+}
+
+/**
+ * Stop listening for wheel power changes
+ */
+FlightWheelListener& FlightWheelListener::detach()  // RET: this listener in detached state
+{
+    if(attached()) {
+        unsubscribe(*_messageBus, WHEEL_POWER);
+        _messageBus = nullptr;
+        _leftWheel = nullptr;
+        _rightWheel = nullptr;
+        _recorder = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * Record the power of the wheel that changed
+ */
+void FlightWheelListener::onMessage(
+    Publisher &publisher,   // IN : publisher of message
+    Message message,        // IN : message that was published
+    Specifier specifier,    // IN : specifier (like LEFT_WHEEL_SPEC)
+    const char *data)       // IN : message data as a c-cstring
+{
+    if(attached() && (WHEEL_POWER == message)) {
+        DriveWheel &wheel = (LEFT_WHEEL_SPEC == specifier) ? *_leftWheel : *_rightWheel;
+        _recorder->recordWheelPower(
+            millis(), 
+            (LEFT_WHEEL_SPEC == specifier) ? 0 : 1, 
+            wheel.forward(), 
+            (uint8_t)wheel.pwm());
+    }
+}
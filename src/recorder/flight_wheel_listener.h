@@ -0,0 +1,55 @@
+#ifndef RECORDER_FLIGHT_WHEEL_LISTENER_H
+#define RECORDER_FLIGHT_WHEEL_LISTENER_H
+
+#include "../message_bus/message_bus.h"
+#include "../wheel/drive_wheel.h"
+#include "flight_recorder.h"
+
+/**
+ * Listen for changes in wheel motor power
+ * and add them to a flight recorder.
+ */
+class FlightWheelListener : Subscriber {
+    private:
+    MessageBus *_messageBus = nullptr;
+    DriveWheel *_leftWheel = nullptr;
+    DriveWheel *_rightWheel = nullptr;
+    FlightRecorder *_recorder = nullptr;
+
+    public:
+
+    ~FlightWheelListener() {
+        detach();
+    }
+
+    /**
+     * Determine if listening for wheel power changes
+     */
+    bool attached();
+
+    /**
+     * Start listening for wheel power changes
+     */
+    FlightWheelListener& attach(
+        MessageBus &messageBus,     // IN : bus on which wheels publish WHEEL_POWER
+        DriveWheel &leftWheel,      // IN : left drive wheel
+        DriveWheel &rightWheel,     // IN : right drive wheel
+        FlightRecorder &recorder);  // IN : recorder to receive changes
+                                    // RET: this listener in attached state
+
+    /**
+     * Stop listening for wheel power changes
+     */
+    FlightWheelListener& detach();  // RET: this listener in detached state
+
+    /**
+     * Record the power of the wheel that changed
+     */
+    void onMessage(
+        Publisher &publisher,   // IN : publisher of message
+        Message message,        // IN : message that was published
+        Specifier specifier,    // IN : specifier (like LEFT_WHEEL_SPEC)
+        const char *data);      // IN : message data as a c-cstring
+};
+
+#endif // RECORDER_FLIGHT_WHEEL_LISTENER_H
@@ -8,6 +8,49 @@ const char *GotoGoalStateStr[NUMBER_OF_GOTO_GOAL_STATES] = {
     "ACHIEVED",
 };
 
+/**
+ * Choose when the behavior runs
+ */
+GotoGoalBehavior& GotoGoalBehavior::setTickPolicy(
+    GotoGoalTick policy,    // IN : GOTO_TICK_ON_POSE or GOTO_TICK_FIXED_RATE
+    unsigned int tickMs)    // IN : milliseconds between runs with GOTO_TICK_FIXED_RATE
+                            // RET: this behavior
+{
+    _tickPolicy = policy;
+    _tickMs = tickMs;
+    return *this;
+}
+
+/**
+ * Choose how the behavior steers to the goal
+ */
+GotoGoalBehavior& GotoGoalBehavior::setSteerPolicy(
+    GotoGoalSteer policy,           // IN : GOTO_STEER_BLENDED or GOTO_STEER_TURN_THEN_DRIVE
+    distance_type slowdownDistance, // IN : cm from goal at which GOTO_STEER_BLENDED slows
+    speed_type maxTurnRate)         // IN : radians/sec fastest GOTO_STEER_BLENDED turns
+                                    // RET: this behavior
+{
+    _steerPolicy = policy;
+    _slowdownDistance = slowdownDistance;
+    _maxTurnRate = maxTurnRate;
+    return *this;
+}
+
+/**
+ * Time taken to reach the goal; while the
+ * behavior is running this is the time so far.
+ */
+unsigned long GotoGoalBehavior::timeToGoalMs()  // RET: milliseconds since behavior started running
+{
+    if(0 != _finishMs) {
+        return _finishMs - _startMs;
+    }
+    if(RUNNING == _state) {
+        return millis() - _startMs;
+    }
+    return 0;
+}
+
 /**
  * Deteremine if dependencies are attached
  */
@@ -78,7 +121,7 @@ void GotoGoalBehavior::onMessage(
     Publisher &publisher,       // IN : publisher of message
     Message message,            // IN : message that was published
     Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
-    const char *data)           // IN : message data as a c-cstring
+    const char *)               // IN : message data as a c-cstring
 {
     // TODO: implement
     switch (message)
@@ -86,7 +129,9 @@ void GotoGoalBehavior::onMessage(
         case ROVER_POSE: {
             assert(&publisher == _rover);
             assert(specifier == ROVER_SPEC);
-            poll(millis());   // update behavior state
+            if(GOTO_TICK_ON_POSE == _tickPolicy) {
+                _tick(millis());   // update behavior state
+            }
             break;
         }
         case WHEEL_HALT: {
@@ -128,6 +173,8 @@ GotoGoalBehavior& GotoGoalBehavior::gotoGoal(
 
         _state = STARTING;
         _action = GOTO_NONE;
+        _finishMs = 0;
+        _pathLength = 0;
 
         startListening();   // listen for ROVER_POSE messages from rover
         _messageBus->publish(*this, GOTO_GOAL, BEHAVIOR_SPEC, GotoGoalStateStr[STARTING]);
@@ -152,15 +199,45 @@ GotoGoalBehavior& GotoGoalBehavior::cancel() // RET: this behavior
 
 
 
+/**
+ * Poll from the control loop
+ */
+GotoGoalBehavior& GotoGoalBehavior::poll(
+    unsigned long currentMillis) // IN : current time in milliseconds
+                                 // RET: this behavior
+{
+    if((GOTO_TICK_FIXED_RATE == _tickPolicy) 
+        && ((STARTING == _state) || (RUNNING == _state))
+        && (currentMillis >= _lastTickMs + _tickMs)) 
+    {
+        _tick(currentMillis);
+    }
+    return *this;
+}
+
+/**
+ * Get the pose to steer by.
+ * Right after a pose update this is that pose;
+ * between updates it is extrapolated, so steering
+ * does not lag behind the rover.
+ */
+Pose2D GotoGoalBehavior::_pose(unsigned long currentMillis)  // IN : current time in milliseconds
+                                                             // RET: pose predicted at currentMillis
+{
+    return _rover->predictedPose(currentMillis);
+}
+
 /**
  * Run the behavior and update rover velocities.
  * Publish messages when goal is achieved.
  */
-GotoGoalBehavior& GotoGoalBehavior::poll(
+GotoGoalBehavior& GotoGoalBehavior::_tick(
     unsigned long currentMillis) // IN : current time in milliseconds
                                  // RET: this behavior
 {
     if(attached()) {
+        _lastTickMs = currentMillis;
+
         //
         // 1. get current pose and current velocities
         // 2. finish if we have achieved goal, otherwise;
@@ -182,36 +259,42 @@ GotoGoalBehavior& GotoGoalBehavior::poll(
         //
         if(STARTING == _state) {
             _state = RUNNING;
-            _action = GOTO_ANGLE;
+            _action = (GOTO_STEER_BLENDED == _steerPolicy) ? GOTO_BLEND : GOTO_ANGLE;
+            _startMs = currentMillis;
+            _lastPose = _rover->pose();
         }
         if(RUNNING == _state) {
+            // measure the path as the rover drives it
+            const Pose2D pose = _rover->pose();
+            const distance_type dx = pose.x - _lastPose.x;
+            const distance_type dy = pose.y - _lastPose.y;
+            _pathLength += HYPOT(dx, dy);
+            _lastPose = pose;
+
             switch(_action) {
                 case GOTO_STOP: {
                     if(gotoStop(currentMillis)) {
                         _action = GOTO_ANGLE;
-                        poll(currentMillis);    // recursive call to start action
+                        _tick(currentMillis);   // recursive call to start action
                     }
                     break;
                 }
                 case GOTO_ANGLE: {
                     if(gotoTurn(currentMillis)) {
                         _action = GOTO_POINT;
-                        poll(currentMillis);    // recursive call to start action
+                        _tick(currentMillis);   // recursive call to start action
                     }
                     break;
                 }
                 case GOTO_POINT: {
                     if(gotoPoint(currentMillis)) {
-                        gotoStop(currentMillis);
-                        _action = GOTO_NONE;
-
-                        // publish ACHIEVED message
-                        _state = ACHIEVED;
-                        _messageBus->publish(*this, GOTO_GOAL, BEHAVIOR_SPEC, GotoGoalStateStr[ACHIEVED]);
-
-                        // we are done, publish NOT_RUNNING message
-                        _state = NOT_RUNNING;
-                        _messageBus->publish(*this, GOTO_GOAL, BEHAVIOR_SPEC, GotoGoalStateStr[NOT_RUNNING]);
+                        _achieve(currentMillis);
+                    }
+                    break;
+                }
+                case GOTO_BLEND: {
+                    if(gotoBlend(currentMillis)) {
+                        _achieve(currentMillis);
                     }
                     break;
                 }
@@ -225,11 +308,32 @@ GotoGoalBehavior& GotoGoalBehavior::poll(
     return *this;
 }
 
+/**
+ * Stop the rover and publish that the goal is achieved
+ */
+GotoGoalBehavior& GotoGoalBehavior::_achieve(
+    unsigned long currentMillis) // IN : current time in milliseconds
+                                 // RET: this behavior
+{
+    gotoStop(currentMillis);
+    _action = GOTO_NONE;
+    _finishMs = currentMillis;
+
+    // publish ACHIEVED message
+    _state = ACHIEVED;
+    _messageBus->publish(*this, GOTO_GOAL, BEHAVIOR_SPEC, GotoGoalStateStr[ACHIEVED]);
+
+    // we are done, publish NOT_RUNNING message
+    _state = NOT_RUNNING;
+    _messageBus->publish(*this, GOTO_GOAL, BEHAVIOR_SPEC, GotoGoalStateStr[NOT_RUNNING]);
+    return *this;
+}
+
 /**
  * Run the behavior and update rover velocities.
  */
 bool GotoGoalBehavior::gotoStop(
-    unsigned long currentMillis) // IN : current time in milliseconds
+    unsigned long)               // IN : current time in milliseconds
                                  // RET: false if not RUNNING or not goal achieved,
                                  //      true if RUNNING and goal achieved 
 {
@@ -252,7 +356,7 @@ bool GotoGoalBehavior::gotoTurn(
         if(RUNNING == _state) {
 
             // we should be pointing at the goal from where we are
-            const Pose2D pose = _rover->pose();
+            const Pose2D pose = _pose(currentMillis);
             const distance_type goalAngle = ATAN2(_goal.y - pose.y, _goal.x - pose.x);
 
             // this is the difference between where we should point and where we are pointing
@@ -300,7 +404,7 @@ bool GotoGoalBehavior::gotoAngle(
     if(attached()) {
         if(RUNNING == _state) {
             const speed_type desiredVelocity = _rover->minimumSpeed() * 1.5;
-            const Pose2D pose = _rover->pose();
+            const Pose2D pose = _pose(currentMillis);
 
             // we should be pointing at the goal from where we are
             const distance_type goalAngle = ATAN2(_goal.y - pose.y, _goal.x - pose.x);
@@ -337,7 +441,7 @@ bool GotoGoalBehavior::gotoPoint(
 {
     if(attached()) {
         if(RUNNING == _state) {
-            const Pose2D pose = _rover->pose();
+            const Pose2D pose = _pose(currentMillis);
 
             //
             // 1. if we are near goal, we are done
@@ -390,3 +494,72 @@ bool GotoGoalBehavior::gotoPoint(
     }    
     return false;
 }
+
+/**
+ * Run the behavior and update rover velocities.
+ * Turn and drive at once with the point forward
+ * controller, slowing as the rover nears the goal.
+ */
+bool GotoGoalBehavior::gotoBlend(
+    unsigned long currentMillis) // IN : current time in milliseconds
+                                 // RET: false if not RUNNING or not goal achieved,
+                                 //      true if RUNNING and goal achieved 
+{
+    if(attached()) {
+        if(RUNNING == _state) {
+            const Pose2D pose = _pose(currentMillis);
+
+            //
+            // we are done within the same circle
+            // around the goal that gotoPoint() uses
+            //
+            const distance_type minimumWheelDistance = ((WHEEL_CIRCUMFERENCE * (distance_type)POSE_MIN_ENCODER_COUNT) / PULSES_PER_REVOLUTION);
+            const distance_type dx = _goal.x - pose.x;
+            const distance_type dy = _goal.y - pose.y;
+            const distance_type distance = HYPOT(dx, dy);
+            if(distance <= minimumWheelDistance) {
+                return true;
+            }
+
+            // this is the difference between where we should point and where we are pointing
+            const distance_type errorAngle = limitAngle(ATAN2(dy, dx) - pose.angle);
+
+            //
+            // full speed until within the slowdown distance, then
+            // slow in proportion to the distance left to go,
+            // but not so slow that the wheels stall.
+            //
+            const speed_type maxSpeed = _rover->maximumSpeed();
+            const speed_type minSpeed = _rover->minimumSpeed();
+            const speed_type speed = (distance >= _slowdownDistance)
+                ? maxSpeed
+                : bound<speed_type>(maxSpeed * distance / _slowdownDistance, minSpeed, maxSpeed);
+
+            //
+            // move the point forward toward the goal at speed;
+            //
+            //   linear  = speed * cos(errorAngle)
+            //   angular = speed * sin(errorAngle) / forward
+            //
+            // which is the wheel velocity law in gotoAngle(),
+            //
+            //   right = speed * (cos(errorAngle) + K * sin(errorAngle))
+            //   left  = speed * (cos(errorAngle) - K * sin(errorAngle))
+            //
+            // so heading error slows the rover and turns it in
+            // proportion.  With the goal behind us we do not back
+            // up; we turn toward it as fast as we can, and the
+            // turn blends into the drive as the goal comes around.
+            // The turn rate is limited, so the wheel speed
+            // controllers can follow it without the heading
+            // overshooting back and forth.
+            //
+            const distance_type forward = (_forward > 0) ? _forward : _rover->wheelBase() / 2;
+            const bool behind = ABS(errorAngle) > (PI / 2);
+            const speed_type linear = behind ? 0 : speed * COS(errorAngle);
+            const speed_type angular = bound<speed_type>(speed * (behind ? SIGN(errorAngle) : SIN(errorAngle)) / forward, -_maxTurnRate, _maxTurnRate);
+            _rover->setVelocity(linear, angular);
+        }
+    }
+    return false;
+}
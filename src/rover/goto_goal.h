@@ -20,6 +20,7 @@ typedef enum {
     GOTO_STOP,
     GOTO_ANGLE,
     GOTO_POINT,
+    GOTO_BLEND,
 } GotoGoalAction;
 
 extern const char *GotoGoalStateStr[NUMBER_OF_GOTO_GOAL_STATES];
@@ -34,6 +35,11 @@ extern const char *GotoGoalStateStr[NUMBER_OF_GOTO_GOAL_STATES];
  * behaviors and avoids instabilities in the 
  * standard PID controller.  
  * See http://faculty.salina.k-state.edu/tim/robot_prog/MobileBot/Steering/pointFwd.html
+ *
+ * With GOTO_STEER_BLENDED the rover turns and drives
+ * at once; there is no stop-and-rotate phase.
+ * With GOTO_STEER_TURN_THEN_DRIVE it turns in place
+ * toward the goal before it drives there.
  */
 class GotoGoalBehavior : public Publisher, public Subscriber {
     private:
@@ -51,6 +57,31 @@ class GotoGoalBehavior : public Publisher, public Subscriber {
     distance_type _goalTolerance = 0;
     distance_type _angleTolerance = 0;
 
+    GotoGoalTick _tickPolicy = GOTO_TICK_POLICY;
+    unsigned int _tickMs = GOTO_TICK_MS;
+    unsigned long _lastTickMs = 0;      // time behavior last ran
+
+    GotoGoalSteer _steerPolicy = GOTO_STEER_POLICY;
+    distance_type _slowdownDistance = GOTO_SLOWDOWN_DISTANCE;
+    speed_type _maxTurnRate = GOTO_MAX_TURN_RATE;
+
+    unsigned long _startMs = 0;         // time behavior started running
+    unsigned long _finishMs = 0;        // time goal was achieved; 0 if not yet
+    distance_type _pathLength = 0;      // distance driven since behavior started
+    Pose2D _lastPose = {0, 0, 0};       // pose when path length was last updated
+
+    /**
+     * Run one step of the behavior
+     */
+    GotoGoalBehavior& _tick(unsigned long currentMillis);   // IN : current time in milliseconds
+                                                            // RET: this behavior
+
+    /**
+     * Get the pose to steer by
+     */
+    Pose2D _pose(unsigned long currentMillis);  // IN : current time in milliseconds
+                                                // RET: pose predicted at currentMillis
+
     public:
 
     GotoGoalBehavior()
@@ -71,6 +102,56 @@ class GotoGoalBehavior : public Publisher, public Subscriber {
     }
 
 
+    /**
+     * Choose when the behavior runs.
+     * GOTO_TICK_ON_POSE runs it when the rover publishes
+     * a new pose, so it only steers as often as the
+     * wheels move.  GOTO_TICK_FIXED_RATE runs it from
+     * poll() every tickMs on a pose predicted from the
+     * last pose velocity, so it keeps correcting
+     * heading between encoder ticks at low speed.
+     */
+    GotoGoalBehavior& setTickPolicy(
+        GotoGoalTick policy,    // IN : GOTO_TICK_ON_POSE or GOTO_TICK_FIXED_RATE
+        unsigned int tickMs);   // IN : milliseconds between runs with GOTO_TICK_FIXED_RATE
+                                // RET: this behavior
+
+    GotoGoalTick tickPolicy() {
+        return _tickPolicy;
+    }
+
+    /**
+     * Choose how the behavior steers to the goal.
+     * GOTO_STEER_BLENDED turns while it drives,
+     * slowing within slowdownDistance of the goal
+     * and turning no faster than maxTurnRate.
+     * GOTO_STEER_TURN_THEN_DRIVE turns in place
+     * toward the goal, then drives to it.
+     */
+    GotoGoalBehavior& setSteerPolicy(
+        GotoGoalSteer policy,               // IN : GOTO_STEER_BLENDED or GOTO_STEER_TURN_THEN_DRIVE
+        distance_type slowdownDistance,     // IN : cm from goal at which GOTO_STEER_BLENDED slows
+        speed_type maxTurnRate);            // IN : radians/sec fastest GOTO_STEER_BLENDED turns
+                                            // RET: this behavior
+
+    GotoGoalSteer steerPolicy() {
+        return _steerPolicy;
+    }
+
+    /**
+     * Time taken to reach the goal; while the
+     * behavior is running this is the time so far.
+     */
+    unsigned long timeToGoalMs();   // RET: milliseconds since behavior started running
+
+    /**
+     * Distance the rover has driven toward the goal,
+     * measured along the path of it's pose.
+     */
+    distance_type pathLength() {    // RET: path length in cm
+        return _pathLength;
+    }
+
     /**
      * Deteremine if dependencies are attached
      */
@@ -124,13 +205,21 @@ class GotoGoalBehavior : public Publisher, public Subscriber {
     GotoGoalBehavior& cancel(); // RET: this behavior 
 
     /**
-     * Run the behavior and update rover velocities.
-     * Publish messages when goal is achieved.
+     * Poll from the control loop; with GOTO_TICK_FIXED_RATE
+     * this runs the behavior and updates rover velocities
+     * every tickMs.  Publish messages when goal is achieved.
      */
-    GotoGoalBehavior& poll(unsigned long currentMillis); // RET: this behavior
+    GotoGoalBehavior& poll(unsigned long currentMillis);    // IN : current time in milliseconds
+                                                            // RET: this behavior
 
     private:
 
+    /**
+     * Stop the rover and publish that the goal is achieved
+     */
+    GotoGoalBehavior& _achieve(unsigned long currentMillis);    // IN : current time in milliseconds
+                                                                // RET: this behavior
+
     /**
      * Run the behavior and update rover velocities.
      */
@@ -162,6 +251,14 @@ class GotoGoalBehavior : public Publisher, public Subscriber {
                                       // RET: true while achieving goal,
                                       //      false if goal achieved OR not RUNNING state 
 
+    /**
+     * Run the behavior and update rover velocities.
+     */
+    bool gotoBlend(
+        unsigned long currentMillis); // IN : current time in milliseconds
+                                      // RET: true while achieving goal,
+                                      //      false if goal achieved OR not RUNNING state 
+
 };
 
 
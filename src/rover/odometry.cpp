@@ -0,0 +1,295 @@
+#include <math.h>
+
+#include "odometry.h"
+
+/**
+ * Set wheel geometry used to convert encoder counts to distance
+ */
+Odometry& Odometry::setWheels(
+    distance_type leftCircumference,            // IN : distance per revolution of left wheel
+    encoder_count_type leftCountsPerRevolution, // IN : encoder counts per revolution of left wheel
+    distance_type rightCircumference,           // IN : distance per revolution of right wheel
+    encoder_count_type rightCountsPerRevolution) // IN : encoder counts per revolution of right wheel
+                                                // RET: this odometry
+{
+    _leftCircumference = leftCircumference;
+    _leftCountsPerRevolution = leftCountsPerRevolution;
+    _rightCircumference = rightCircumference;
+    _rightCountsPerRevolution = rightCountsPerRevolution;
+    return *this;
+}
+
+/**
+ * Set the wheel slip noise used to grow the pose covariance
+ */
+Odometry& Odometry::setSlip(
+    distance_type leftSlip,     // IN : variance of left wheel distance per distance travelled
+    distance_type rightSlip)    // IN : variance of right wheel distance per distance travelled
+                                // RET: this odometry
+{
+    _leftSlip = leftSlip;
+    _rightSlip = rightSlip;
+    return *this;
+}
+
+/**
+ * Start over at the origin on the next update()
+ */
+Odometry& Odometry::reset() // RET: this odometry
+{
+    _lastPoseMs = 0;    // will reset on next update()
+    return *this;
+}
+
+/**
+ * Determine if enough time has passed to update the pose
+ */
+bool Odometry::isDue(unsigned long currentMillis)   // IN : milliseconds since startup
+                                                    // RET: true if update() should be called
+{
+    return (0 == _lastPoseMs) || (currentMillis >= (_lastPoseMs + POSE_POLL_MS));
+}
+
+/**
+ * Move a pose along the arc that a differential drive
+ * follows when it's wheels travel the given distances.
+ *
+ * With the wheels travelling dl and dr, the center travels
+ * d = (dr + dl) / 2 and the heading turns dθ = (dr - dl) / b
+ * along an arc of radius R = d / dθ, so
+ *
+ *   x' = x + R (sin(θ + dθ) - sin(θ))
+ *   y' = y - R (cos(θ + dθ) - cos(θ))
+ *
+ * which is exact however far the wheels travel, so
+ * tight turns do not accumulate the error of assuming
+ * the rover moved in a straight line.
+ *
+ * The differences of sines cancel badly when R is large,
+ * and take four trig calls, so this uses the same arc
+ * written as a chord along the mean heading φ = θ + dθ/2
+ *
+ *   x' = x + d cos(φ) sin(dθ/2) / (dθ/2)
+ *   y' = y + d sin(φ) sin(dθ/2) / (dθ/2)
+ *
+ * which needs three, and no cancellation.
+ */
+Pose2D integrateArc(
+    const Pose2D &pose,             // IN : pose at start of movement
+    distance_type leftDistance,     // IN : distance left wheel travelled
+    distance_type rightDistance,    // IN : distance right wheel travelled
+    distance_type wheelBase)        // IN : distance between drive wheels
+                                    // RET: pose at end of movement
+{
+    const distance_type distance = (rightDistance + leftDistance) / 2;
+    const distance_type deltaAngle = (rightDistance - leftDistance) / wheelBase;
+
+    // chord is shorter than the arc by sin(dθ/2) / (dθ/2)
+    const distance_type halfAngle = deltaAngle / 2;
+    const distance_type chord = (ABS(deltaAngle) < POSE_ARC_MIN_ANGLE)
+        ? distance      // nearly straight; the ratio is one to float precision
+        : distance * SIN(halfAngle) / halfAngle;
+
+    const distance_type heading = pose.angle + halfAngle;
+    Pose2D moved;
+    moved.x = pose.x + chord * COS(heading);
+    moved.y = pose.y + chord * SIN(heading);
+    moved.angle = limitAngle(pose.angle + deltaAngle);
+    return moved;
+}
+
+/**
+ * Grow a pose covariance by one movement of the wheels.
+ *
+ * With the heading at the middle of the movement φ = θ + dθ/2,
+ * and d and b as in integrateArc(), the covariance becomes
+ *
+ *   Σ' = Fp Σ Fpᵀ + Fw Q Fwᵀ
+ *
+ * where Q = diag(kr |dr|, kl |dl|) is the slip noise of
+ * the wheels, Fp is the jacobian of the movement by pose
+ *
+ *   Fp = [1, 0, -(y' - y)]
+ *        [0, 1,  (x' - x)]
+ *        [0, 0,     1    ]
+ *
+ * and Fw is the jacobian by (dr, dl)
+ *
+ *   Fw = [cos(φ)/2 - d sin(φ)/2b, cos(φ)/2 + d sin(φ)/2b]
+ *        [sin(φ)/2 + d cos(φ)/2b, sin(φ)/2 - d cos(φ)/2b]
+ *        [          1/b         ,          -1/b         ]
+ *
+ * Fp uses the exact arc; Fw is the usual small movement
+ * approximation, which holds as the pose is updated
+ * on every batch of encoder ticks.
+ */
+PoseCovariance propagateCovariance(
+    const PoseCovariance &covariance,   // IN : covariance of pose at start of movement
+    const Pose2D &pose,                 // IN : pose at start of movement
+    const Pose2D &moved,                // IN : pose at end of movement
+    distance_type leftDistance,         // IN : distance left wheel travelled
+    distance_type rightDistance,        // IN : distance right wheel travelled
+    distance_type wheelBase,            // IN : distance between drive wheels
+    distance_type leftSlip,             // IN : variance of left wheel distance per distance travelled
+    distance_type rightSlip)            // IN : variance of right wheel distance per distance travelled
+                                        // RET: covariance of pose at end of movement
+{
+    const distance_type distance = (rightDistance + leftDistance) / 2;
+    const distance_type deltaAngle = (rightDistance - leftDistance) / wheelBase;
+    const distance_type heading = pose.angle + deltaAngle / 2;
+    const distance_type cosHeading = COS(heading);
+    const distance_type sinHeading = SIN(heading);
+    const distance_type lever = distance / (2 * wheelBase);
+
+    PoseCovariance poseJacobian = identityMatrix<distance_type, 3>();
+    poseJacobian(0, 2) = -(moved.y - pose.y);
+    poseJacobian(1, 2) = moved.x - pose.x;
+
+    Matrix<distance_type, 3, 2> wheelJacobian;
+    wheelJacobian(0, 0) = cosHeading / 2 - lever * sinHeading;
+    wheelJacobian(0, 1) = cosHeading / 2 + lever * sinHeading;
+    wheelJacobian(1, 0) = sinHeading / 2 + lever * cosHeading;
+    wheelJacobian(1, 1) = sinHeading / 2 - lever * cosHeading;
+    wheelJacobian(2, 0) = 1 / wheelBase;
+    wheelJacobian(2, 1) = -1 / wheelBase;
+
+    // Q is diagonal, so Fw Q is just Fw with it's columns scaled
+    Matrix<distance_type, 3, 2> wheelNoise = wheelJacobian;
+    for(int i = 0; i < 3; i += 1) {
+        wheelNoise(i, 0) *= rightSlip * ABS(rightDistance);
+        wheelNoise(i, 1) *= leftSlip * ABS(leftDistance);
+    }
+
+    PoseCovariance movedCovariance = add(
+        multiplyTransposed(multiply(poseJacobian, covariance), poseJacobian),
+        multiplyTransposed(wheelNoise, wheelJacobian));
+
+    // rounding, which is coarse in fixed point, can skew the
+    // two halves apart; average them so it stays symmetric
+    for(int i = 0; i < 3; i += 1) {
+        for(int j = 0; j < i; j += 1) {
+            const distance_type average = (movedCovariance(i, j) + movedCovariance(j, i)) / 2;
+            movedCovariance(i, j) = average;
+            movedCovariance(j, i) = average;
+        }
+    }
+    return movedCovariance;
+}
+
+/**
+ * Predict the pose at a time after the last update.
+ *
+ * The pose velocity is measured over at least
+ * POSE_MIN_ENCODER_COUNT ticks, so it is smooth enough
+ * to extrapolate.  It's speed along the heading and
+ * turn rate are turned back into wheel distances so
+ * the prediction follows the same arc as an update would.
+ */
+Pose2D Odometry::predict(unsigned long currentMillis)   // IN : milliseconds since startup
+                                                        // RET: predicted pose
+{
+    if((0 == _lastPoseMs) || (currentMillis <= _lastPoseMs)) {
+        return _lastPose;
+    }
+    const unsigned long elapsedMs = currentMillis - _lastPoseMs;
+    if(elapsedMs > POSE_PREDICT_MAX_MS) {
+        return _lastPose;   // stopped; the velocity is stale
+    }
+
+    const distance_type elapsedSec = elapsedMs / 1000.0;
+    const distance_type speed = 
+        _lastPoseVelocity.x * COS(_lastPose.angle) + _lastPoseVelocity.y * SIN(_lastPose.angle);
+    const distance_type distance = speed * elapsedSec;
+    const distance_type turn = _lastPoseVelocity.angle * elapsedSec * _wheelBase / 2;
+    return integrateArc(_lastPose, distance - turn, distance + turn, _wheelBase);
+}
+
+/**
+ * Update the pose from an encoder sample.
+ */
+bool Odometry::update(const EncoderSample &sample)  // IN : encoders read at sample.ms
+                                                    // RET: true if pose was updated
+{
+    if(0 == _lastPoseMs) {
+        // initialize
+        _lastPoseMs = sample.ms;
+        _lastLeftEncoderTicks = sample.leftTicks;
+        _lastRightEncoderTicks = sample.rightTicks;
+        _lastLeftDistance = _leftCircumference * ((distance_type)sample.leftCount / _leftCountsPerRevolution);
+        _lastRightDistance = _rightCircumference * ((distance_type)sample.rightCount / _rightCountsPerRevolution);
+
+        //
+        // stopped at origin, pointing to zero radians
+        //
+        _lastPose.x = 0;
+        _lastPose.y = 0;
+        _lastPose.angle = 0;   // pointing right
+        _lastPoseVelocity.x = 0;
+        _lastPoseVelocity.y = 0;
+        _lastPoseVelocity.angle = 0;
+        _lastCovariance = zeroMatrix<distance_type, 3, 3>();  // exactly at origin
+
+        _velocityMs = sample.ms;
+        _velocityLeftTicks = sample.leftTicks;
+        _velocityRightTicks = sample.rightTicks;
+        _velocityPose = _lastPose;
+        _velocityAngle = 0;
+        return true;
+    }
+
+    //
+    // integrate every batch of encoder ticks;
+    // the arc is exact, so there is no need to
+    // wait for the wheels to move further.
+    //
+    if((sample.leftTicks == _lastLeftEncoderTicks) && (sample.rightTicks == _lastRightEncoderTicks)) {
+        return false;
+    }
+
+    const distance_type currentLeftDistance = 
+        _leftCircumference * ((distance_type)sample.leftCount / _leftCountsPerRevolution);
+    const distance_type leftDeltaDistance = currentLeftDistance - _lastLeftDistance;
+
+    const distance_type currentRightDistance =  
+        _rightCircumference * ((distance_type)sample.rightCount / _rightCountsPerRevolution);
+    const distance_type rightDeltaDistance = currentRightDistance - _lastRightDistance; 
+
+    const Pose2D movedPose = integrateArc(_lastPose, leftDeltaDistance, rightDeltaDistance, _wheelBase);
+    _lastCovariance = propagateCovariance(
+        _lastCovariance, _lastPose, movedPose, 
+        leftDeltaDistance, rightDeltaDistance, _wheelBase, 
+        _leftSlip, _rightSlip);
+    _lastPose = movedPose;
+    _velocityAngle += (rightDeltaDistance - leftDeltaDistance) / _wheelBase;
+
+    //
+    // make sure at least one wheel has moves some minimum rotation 
+    // so we can reduce noise in the velocity calculation
+    //
+    if(((sample.leftTicks - _velocityLeftTicks) >= POSE_MIN_ENCODER_COUNT) 
+        || ((sample.rightTicks - _velocityRightTicks) >= POSE_MIN_ENCODER_COUNT)) 
+    {
+        const distance_type deltaTimeSec = (sample.ms - _velocityMs) / 1000.0;
+        if(deltaTimeSec > 0) {
+            _lastPoseVelocity.x = (_lastPose.x - _velocityPose.x) / deltaTimeSec;
+            _lastPoseVelocity.y = (_lastPose.y - _velocityPose.y) / deltaTimeSec;
+            _lastPoseVelocity.angle = _velocityAngle / deltaTimeSec;
+        }
+
+        _velocityMs = sample.ms;
+        _velocityLeftTicks = sample.leftTicks;
+        _velocityRightTicks = sample.rightTicks;
+        _velocityPose = _lastPose;
+        _velocityAngle = 0;
+    }
+
+    // 
+    // record keeping
+    //
+    _lastPoseMs = sample.ms;
+    _lastLeftEncoderTicks = sample.leftTicks;
+    _lastRightEncoderTicks = sample.rightTicks;
+    _lastLeftDistance = currentLeftDistance;
+    _lastRightDistance = currentRightDistance;
+    return true;
+}
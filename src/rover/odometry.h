@@ -0,0 +1,182 @@
+#ifndef ODOMETRY_H
+#define ODOMETRY_H
+
+#include "../config.h"
+#include "./pose.h"
+
+//
+// wheel encoder values read at one time;
+// the input to pose estimation.
+//
+typedef struct EncoderSample {
+    unsigned long ms;                   // time encoders were read in ms since startup
+    encoder_count_type leftCount;       // signed left encoder count; increases forward, decreases reverse
+    encoder_count_type rightCount;      // signed right encoder count
+    encoder_count_type leftTicks;       // unsigned left encoder ticks; increases in either direction
+    encoder_count_type rightTicks;      // unsigned right encoder ticks
+} EncoderSample;
+
+/**
+ * Dead reckoning of the rover's pose
+ * from wheel encoder samples.
+ *
+ * This holds no references to hardware, so
+ * the same estimate can be run on the rover
+ * and offline from a recording of the samples.
+ */
+class Odometry {
+    private:
+
+    distance_type _wheelBase;                       // distance between drive wheels
+    distance_type _leftCircumference = 1;           // distance per revolution of left wheel
+    distance_type _rightCircumference = 1;          // distance per revolution of right wheel
+    encoder_count_type _leftCountsPerRevolution = 1;
+    encoder_count_type _rightCountsPerRevolution = 1;
+    distance_type _leftSlip = POSE_LEFT_SLIP;       // variance of left wheel distance per distance travelled
+    distance_type _rightSlip = POSE_RIGHT_SLIP;     // variance of right wheel distance per distance travelled
+
+    unsigned long _lastPoseMs = 0;                  // time of last pose update; zero if not started
+    encoder_count_type _lastLeftEncoderTicks = 0;   // last encoder ticks for left wheel
+    encoder_count_type _lastRightEncoderTicks = 0;  // last encoder ticks for right wheel
+    distance_type _lastLeftDistance = 0;            // last calculated distance for left wheel
+    distance_type _lastRightDistance = 0;           // last calculated distance for right wheel
+    Pose2D _lastPose = {0, 0, 0};                   // most recently estimated position/orientation
+    Pose2D _lastPoseVelocity = {0, 0, 0};           // most recently estimated velocities
+    PoseCovariance _lastCovariance = zeroMatrix<distance_type, 3, 3>(); // uncertainty of _lastPose
+
+    //
+    // velocity is measured over at least POSE_MIN_ENCODER_COUNT
+    // ticks, from the pose at the start of that span
+    //
+    unsigned long _velocityMs = 0;                  // time at start of velocity span
+    encoder_count_type _velocityLeftTicks = 0;      // left encoder ticks at start of velocity span
+    encoder_count_type _velocityRightTicks = 0;     // right encoder ticks at start of velocity span
+    Pose2D _velocityPose = {0, 0, 0};               // pose at start of velocity span
+    distance_type _velocityAngle = 0;               // unwrapped change in angle over velocity span
+
+    public:
+
+    Odometry(distance_type wheelBase)   // IN : distance between drive wheels
+        : _wheelBase(wheelBase)
+    {
+    }
+
+    /**
+     * Set wheel geometry used to convert encoder counts to distance
+     */
+    Odometry& setWheels(
+        distance_type leftCircumference,            // IN : distance per revolution of left wheel
+        encoder_count_type leftCountsPerRevolution, // IN : encoder counts per revolution of left wheel
+        distance_type rightCircumference,           // IN : distance per revolution of right wheel
+        encoder_count_type rightCountsPerRevolution); // IN : encoder counts per revolution of right wheel
+                                                    // RET: this odometry
+
+    /**
+     * Set the wheel slip noise used to grow
+     * the pose covariance.  Each wheel's distance
+     * is modeled with a variance proportional to
+     * the distance it travelled, so uncertainty
+     * grows as the rover drives, not as time passes.
+     */
+    Odometry& setSlip(
+        distance_type leftSlip,     // IN : variance of left wheel distance per distance travelled
+        distance_type rightSlip);   // IN : variance of right wheel distance per distance travelled
+                                    // RET: this odometry
+
+    /**
+     * Distance between drive wheels
+     */
+    distance_type wheelBase() { return _wheelBase; }
+
+    /**
+     * Determine if a pose has been established
+     */
+    bool started() { return 0 != _lastPoseMs; }
+
+    /**
+     * Start over at the origin on the next update()
+     */
+    Odometry& reset();  // RET: this odometry
+
+    /**
+     * Determine if enough time has passed to update the pose
+     */
+    bool isDue(unsigned long currentMillis);    // IN : milliseconds since startup
+                                                // RET: true if update() should be called
+
+    /**
+     * Update the pose from an encoder sample.
+     * The first sample after reset() starts
+     * at the origin; after that the pose is
+     * updated by every sample in which a wheel moved,
+     * and the pose velocity once a wheel has moved
+     * at least POSE_MIN_ENCODER_COUNT, to reduce noise.
+     */
+    bool update(const EncoderSample &sample);   // IN : encoders read at sample.ms
+                                                // RET: true if pose was updated
+
+    /**
+     * Get the time of the last pose update
+     */
+    unsigned long lastPoseMs() { return _lastPoseMs; }
+
+    /**
+     * Get the most recently estimated pose
+     */
+    Pose2D pose() { return _lastPose; }
+
+    /**
+     * Get the most recently estimated pose velocity
+     */
+    Pose2D poseVelocity() { return _lastPoseVelocity; }
+
+    /**
+     * Predict the pose at a time after the last update
+     * by moving along the arc of the last pose velocity.
+     * If no wheel has moved for POSE_PREDICT_MAX_MS the
+     * rover is assumed to have stopped and the last pose
+     * is returned.
+     */
+    Pose2D predict(unsigned long currentMillis);    // IN : milliseconds since startup
+                                                    // RET: predicted pose
+
+    /**
+     * Get the covariance of the most recently estimated pose
+     */
+    PoseCovariance covariance() { return _lastCovariance; }
+};
+
+/**
+ * Move a pose along the arc that a differential drive
+ * follows when it's wheels travel the given distances.
+ * The arc is exact for any turn; turns smaller than
+ * POSE_ARC_MIN_ANGLE, where the arc's radius blows up,
+ * are moved in a straight line along the mean heading.
+ */
+extern Pose2D integrateArc(
+    const Pose2D &pose,             // IN : pose at start of movement
+    distance_type leftDistance,     // IN : distance left wheel travelled
+    distance_type rightDistance,    // IN : distance right wheel travelled
+    distance_type wheelBase);       // IN : distance between drive wheels
+                                    // RET: pose at end of movement
+
+/**
+ * Grow a pose covariance by one movement of the wheels,
+ * using the differential drive error model: each
+ * wheel's distance has a variance proportional
+ * to how far it travelled, and that is propagated
+ * through the motion along with the existing
+ * uncertainty of the pose.
+ */
+extern PoseCovariance propagateCovariance(
+    const PoseCovariance &covariance,   // IN : covariance of pose at start of movement
+    const Pose2D &pose,                 // IN : pose at start of movement
+    const Pose2D &moved,                // IN : pose at end of movement
+    distance_type leftDistance,         // IN : distance left wheel travelled
+    distance_type rightDistance,        // IN : distance right wheel travelled
+    distance_type wheelBase,            // IN : distance between drive wheels
+    distance_type leftSlip,             // IN : variance of left wheel distance per distance travelled
+    distance_type rightSlip);           // IN : variance of right wheel distance per distance travelled
+                                        // RET: covariance of pose at end of movement
+
+#endif // ODOMETRY_H
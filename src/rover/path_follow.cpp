@@ -0,0 +1,376 @@
+#include "./path_follow.h"
+
+/**
+ * Deteremine if dependencies are attached
+ */
+bool PathFollowBehavior::attached() // RET: true if attached, false if not
+{
+    return (NULL != _rover) && (NULL != _messageBus);
+}
+
+/**
+ * Attach dependencies
+ */
+PathFollowBehavior& PathFollowBehavior::attach(
+    TwoWheelRover& rover,   // IN : rover that get's behavior
+    MessageBus& messageBus) // IN : MessageBus to publish state changes
+                            // RET: this behavior in attached state
+{
+    if(!attached()) {
+        _rover = &rover;
+        _messageBus = &messageBus;
+    }
+
+    return *this;
+}
+
+/**
+ * Detach dependencies
+ */
+PathFollowBehavior& PathFollowBehavior::detach() // RET: this behavior in detached state
+{
+    if(attached()) {
+        _rover = nullptr;
+        _messageBus = nullptr;
+    }
+
+    return *this;
+}
+
+/**
+ * Add a waypoint to the pending path.
+ * Waypoints must be added in order;
+ * index zero starts a new pending path.
+ */
+int PathFollowBehavior::addWaypoint(
+    unsigned int index, // IN : index of waypoint in path
+    distance_type x,    // IN : waypoint's horizontal position in world coordinates
+    distance_type y)    // IN : waypoint's vertical position in world coordinates
+                        // RET: SUCCESS if added,
+                        //      FAILURE if out of order or the path is full
+{
+    if(0 == index) {
+        _pendingCount = 0;
+    }
+    if((index != _pendingCount) || (_pendingCount >= PATH_MAX_WAYPOINTS)) {
+        return FAILURE;
+    }
+    _pending[_pendingCount] = {x, y};
+    _pendingCount += 1;
+    return SUCCESS;
+}
+
+/**
+ * Start following the pending waypoints
+ * from where the rover is now.
+ */
+PathFollowBehavior& PathFollowBehavior::followPath(
+    distance_type lookahead,    // IN : cm along the path ahead of the rover to steer toward
+    distance_type tolerance)    // IN : cm from last waypoint considered success
+                                // RET: this behavior
+{
+    if(attached() && (_pendingCount > 0)) {
+        cancel();
+
+        //
+        // the path starts where the rover is, so
+        // the first segment takes it to the first waypoint
+        //
+        const Pose2D pose = _rover->pose();
+        _path[0] = {pose.x, pose.y};
+        for(unsigned int i = 0; i < _pendingCount; i += 1) {
+            _path[i + 1] = _pending[i];
+        }
+        _pathCount = _pendingCount + 1;
+        _pendingCount = 0;
+        _segment = 0;
+        _dropped = 0;
+        _measure();
+
+        _lookahead = (lookahead > 0) ? lookahead : PATH_LOOKAHEAD;
+        _tolerance = tolerance;
+        _finishMs = 0;
+        _pathLength = 0;
+        _publish(STARTING);
+    }
+    return *this;
+}
+
+/**
+ * Extend the path being followed, so a long path
+ * can be streamed a few waypoints at a time.
+ * Waypoints the rover has passed are dropped
+ * to make room.
+ */
+int PathFollowBehavior::appendWaypoint(
+    distance_type x,    // IN : waypoint's horizontal position in world coordinates
+    distance_type y)    // IN : waypoint's vertical position in world coordinates
+                        // RET: SUCCESS if added,
+                        //      FAILURE if not running or the path is full
+{
+    if((STARTING != _state) && (RUNNING != _state)) {
+        return FAILURE;
+    }
+
+    // drop the segments behind the rover
+    if(_segment > 0) {
+        for(unsigned int i = _segment; i < _pathCount; i += 1) {
+            _path[i - _segment] = _path[i];
+        }
+        _pathCount -= _segment;
+        _dropped += _segment;
+        _segment = 0;
+    }
+    if(_pathCount >= PATH_MAX_WAYPOINTS + 1) {
+        return FAILURE;
+    }
+
+    _path[_pathCount] = {x, y};
+    _pathCount += 1;
+    _measure();
+    return SUCCESS;
+}
+
+/**
+ * Cancel the behavior IF it is running
+ */
+PathFollowBehavior& PathFollowBehavior::cancel() // RET: this behavior
+{
+    if((STARTING == _state) || (RUNNING == _state)) {
+        _stop();
+        _publish(NOT_RUNNING);
+    }
+    return *this;
+}
+
+/**
+ * Poll from the control loop
+ */
+PathFollowBehavior& PathFollowBehavior::poll(
+    unsigned long currentMillis) // IN : current time in milliseconds
+                                 // RET: this behavior
+{
+    if(((STARTING == _state) || (RUNNING == _state))
+        && (currentMillis >= _lastTickMs + _tickMs))
+    {
+        _tick(currentMillis);
+    }
+    return *this;
+}
+
+/**
+ * Get the waypoint the rover is heading for
+ */
+Pose2D PathFollowBehavior::goal()   // RET: position of waypoint at end of current segment
+{
+    if(_pathCount > 1) {
+        const Point2D waypoint = _path[_segment + 1];
+        return {waypoint.x, waypoint.y, 0};
+    }
+    return {0, 0, 0};
+}
+
+/**
+ * Time taken to reach the last waypoint; while the
+ * behavior is running this is the time so far.
+ */
+unsigned long PathFollowBehavior::timeToGoalMs()    // RET: milliseconds since behavior started running
+{
+    if(0 != _finishMs) {
+        return _finishMs - _startMs;
+    }
+    if(RUNNING == _state) {
+        return millis() - _startMs;
+    }
+    return 0;
+}
+
+/**
+ * Run the behavior and update rover velocities.
+ * Publish messages when the last waypoint is achieved.
+ */
+PathFollowBehavior& PathFollowBehavior::_tick(
+    unsigned long currentMillis) // IN : current time in milliseconds
+                                 // RET: this behavior
+{
+    if(!attached()) {
+        return *this;
+    }
+    _lastTickMs = currentMillis;
+
+    if(STARTING == _state) {
+        _startMs = currentMillis;
+        _lastPose = _rover->pose();
+        _publish(RUNNING);
+    }
+    if(RUNNING != _state) {
+        return *this;
+    }
+
+    // measure the path as the rover drives it
+    const Pose2D measured = _rover->pose();
+    const distance_type driven = HYPOT(measured.x - _lastPose.x, measured.y - _lastPose.y);
+    _pathLength += driven;
+    _lastPose = measured;
+
+    //
+    // move on to the next segment once it's start is
+    // within the lookahead circle, so the rover
+    // turns the corner rather than driving to it.
+    //
+    const Pose2D pose = _rover->predictedPose(currentMillis);
+    const unsigned int last = _pathCount - 2;
+    while(_segment < last) {
+        const Point2D &end = _path[_segment + 1];
+        if(!pointInCircle<distance_type>(end.x, end.y, pose.x, pose.y, _lookahead)) {
+            break;
+        }
+        _segment += 1;
+    }
+
+    //
+    // we are done within tolerance of the
+    // last waypoint, or within the circle
+    // that the encoders can measure.
+    //
+    const Point2D &end = _path[_segment + 1];
+    const distance_type dx = end.x - pose.x;
+    const distance_type dy = end.y - pose.y;
+    const distance_type distance = HYPOT(dx, dy);
+    const distance_type minimumWheelDistance = ((WHEEL_CIRCUMFERENCE * (distance_type)POSE_MIN_ENCODER_COUNT) / PULSES_PER_REVOLUTION);
+    if((_segment == last) && (distance <= max<distance_type>(_tolerance, minimumWheelDistance))) {
+        _stop();
+        _finishMs = currentMillis;
+        _publish(ACHIEVED);
+        _publish(NOT_RUNNING);
+        return *this;
+    }
+
+    //
+    // full speed until within the slowdown distance
+    // of the end of the path, then slow in proportion
+    // to the path left, but not so slow the wheels stall.
+    //
+    const distance_type remaining = distance + _remaining[_segment + 1];
+    const speed_type maxSpeed = _rover->maximumSpeed();
+    const speed_type minSpeed = _rover->minimumSpeed();
+    speed_type linear = (remaining >= GOTO_SLOWDOWN_DISTANCE)
+        ? maxSpeed
+        : bound<speed_type>(maxSpeed * remaining / GOTO_SLOWDOWN_DISTANCE, minSpeed, maxSpeed);
+    speed_type angular;
+
+    //
+    // pure pursuit; the arc through the rover and the
+    // lookahead point, tangent to the rover's heading,
+    // has curvature 2 * y / d², where y is the point's
+    // offset to the left of the rover and d it's distance.
+    //
+    const Point2D target = _lookaheadPoint(pose);
+    const distance_type tx = target.x - pose.x;
+    const distance_type ty = target.y - pose.y;
+    const distance_type cosAngle = COS(pose.angle);
+    const distance_type sinAngle = SIN(pose.angle);
+    const distance_type ahead = tx * cosAngle + ty * sinAngle;
+    const distance_type left = ty * cosAngle - tx * sinAngle;
+    if(ahead <= 0) {
+        // point is behind us; turn toward it in place
+        linear = 0;
+        angular = (left >= 0) ? GOTO_MAX_TURN_RATE : -GOTO_MAX_TURN_RATE;
+    } else {
+        const distance_type curvature = 2 * left / (tx * tx + ty * ty);
+        angular = linear * curvature;
+
+        // slow down to keep the curvature on tight turns
+        if(ABS(angular) > GOTO_MAX_TURN_RATE) {
+            linear = GOTO_MAX_TURN_RATE / ABS(curvature);
+            angular = (angular > 0) ? GOTO_MAX_TURN_RATE : -GOTO_MAX_TURN_RATE;
+        }
+    }
+    _rover->setVelocity(linear, angular);
+
+    return *this;
+}
+
+/**
+ * Measure the length of the path left after
+ * each point, so the rover slows at the end.
+ */
+PathFollowBehavior& PathFollowBehavior::_measure() // RET: this behavior
+{
+    _remaining[_pathCount - 1] = 0;
+    for(int i = _pathCount - 2; i >= 0; i -= 1) {
+        const distance_type dx = _path[i + 1].x - _path[i].x;
+        const distance_type dy = _path[i + 1].y - _path[i].y;
+        _remaining[i] = _remaining[i + 1] + HYPOT(dx, dy);
+    }
+    return *this;
+}
+
+/**
+ * Find the point on the current segment
+ * that is lookahead distance from the rover.
+ */
+Point2D PathFollowBehavior::_lookaheadPoint(const Pose2D &pose) // IN : rover's pose
+                                                                // RET: point to steer toward
+{
+    //
+    // solve |start + t * (end - start) - pose| = lookahead
+    // for the furthest point along the segment, 0 <= t <= 1.
+    // This is worked in distances along and across the segment
+    // rather than the quadratic's squares of squares, so it stays
+    // in range of fixed point.
+    //
+    const Point2D &start = _path[_segment];
+    const Point2D &end = _path[_segment + 1];
+    const distance_type sx = end.x - start.x;
+    const distance_type sy = end.y - start.y;
+    const distance_type length = HYPOT(sx, sy);
+    if(0 == length) {
+        return end;
+    }
+    const distance_type ux = sx / length;
+    const distance_type uy = sy / length;
+    const distance_type px = pose.x - start.x;
+    const distance_type py = pose.y - start.y;
+    const distance_type along = px * ux + py * uy;    // to the nearest point on the segment's line
+    const distance_type across = ABS(px * uy - py * ux);
+
+    distance_type t;
+    if(across <= _lookahead) {
+        t = (along + SQRT(_lookahead * _lookahead - across * across)) / length;
+    } else {
+        //
+        // we are further than lookahead from the path;
+        // steer toward the point lookahead along the
+        // path from the nearest point on it.
+        //
+        t = (along + _lookahead) / length;
+    }
+    t = bound<distance_type>(t, 0, 1);
+    return {start.x + t * sx, start.y + t * sy};
+}
+
+/**
+ * Stop the rover
+ */
+PathFollowBehavior& PathFollowBehavior::_stop() // RET: this behavior
+{
+    if(attached()) {
+        _rover->roverLeftWheel(false, true, 0);
+        _rover->roverRightWheel(false, true, 0);
+    }
+    return *this;
+}
+
+/**
+ * Publish the state as a GOTO_GOAL message
+ */
+PathFollowBehavior& PathFollowBehavior::_publish(GotoGoalState state)   // IN : new state
+                                                                        // RET: this behavior
+{
+    _state = state;
+    if(attached()) {
+        _messageBus->publish(*this, GOTO_GOAL, PATH_SPEC, GotoGoalStateStr[state]);
+    }
+    return *this;
+}
@@ -0,0 +1,201 @@
+#ifndef PATH_FOLLOW_H
+#define PATH_FOLLOW_H
+
+#include "../config.h"
+#include "../rover/rover.h"
+#include "../rover/goto_goal.h"
+#include "../message_bus/message_bus.h"
+#include "../rover/pose.h"
+
+/**
+ * Follow a path of waypoints in world coordinates
+ * with pure pursuit steering.
+ *
+ * The path runs from where the rover is when it starts
+ * through each waypoint in turn.  Each tick the rover
+ * steers along the arc that takes it to the point on the
+ * path that is lookahead cm away, so it cuts smoothly
+ * through intermediate waypoints rather than stopping
+ * at them; it only slows within GOTO_SLOWDOWN_DISTANCE
+ * of the last waypoint, where it stops.
+ * See https://www.ri.cmu.edu/pub_files/pub3/coulter_r_craig_1992_1/coulter_r_craig_1992_1.pdf
+ *
+ * Waypoints are uploaded one at a time with addWaypoint()
+ * into a pending list of at most PATH_MAX_WAYPOINTS, so
+ * the next path can be uploaded while one is followed;
+ * followPath() starts following the pending list.
+ * State changes are published as GOTO_GOAL messages
+ * with PATH_SPEC.
+ */
+class PathFollowBehavior : public Publisher {
+    private:
+    // attached dependencies
+    TwoWheelRover* _rover = nullptr;
+    MessageBus *_messageBus = nullptr;
+
+    // uploaded waypoints, waiting for followPath()
+    Point2D _pending[PATH_MAX_WAYPOINTS];
+    unsigned int _pendingCount = 0;
+
+    //
+    // path being followed; _path[0] is where the rover
+    // started, so there is one more point than waypoints.
+    // _remaining[i] is the length of the path after _path[i].
+    //
+    Point2D _path[PATH_MAX_WAYPOINTS + 1];
+    distance_type _remaining[PATH_MAX_WAYPOINTS + 1];
+    unsigned int _pathCount = 0;
+    unsigned int _segment = 0;      // following segment from _path[_segment] to _path[_segment + 1]
+    unsigned int _dropped = 0;      // waypoints passed and dropped by appendWaypoint()
+
+    GotoGoalState _state = NOT_RUNNING;
+    distance_type _lookahead = PATH_LOOKAHEAD;
+    distance_type _tolerance = 0;
+    unsigned int _tickMs = GOTO_TICK_MS;
+    unsigned long _lastTickMs = 0;      // time behavior last ran
+
+    unsigned long _startMs = 0;         // time behavior started running
+    unsigned long _finishMs = 0;        // time last waypoint was achieved; 0 if not yet
+    distance_type _pathLength = 0;      // distance driven since behavior started
+    Pose2D _lastPose = {0, 0, 0};       // pose when path length was last updated
+
+    /**
+     * Run one step of the behavior
+     */
+    PathFollowBehavior& _tick(unsigned long currentMillis);   // IN : current time in milliseconds
+                                                              // RET: this behavior
+
+    /**
+     * Measure the length of the path left after each point
+     */
+    PathFollowBehavior& _measure(); // RET: this behavior
+
+    /**
+     * Find the point on the current segment
+     * that is lookahead distance from the rover.
+     */
+    Point2D _lookaheadPoint(const Pose2D &pose);    // IN : rover's pose
+                                                    // RET: point to steer toward
+
+    /**
+     * Stop the rover
+     */
+    PathFollowBehavior& _stop();    // RET: this behavior
+
+    /**
+     * Publish the state as a GOTO_GOAL message
+     */
+    PathFollowBehavior& _publish(GotoGoalState state);  // IN : new state
+                                                        // RET: this behavior
+
+    public:
+
+    PathFollowBehavior()
+        :  Publisher(PATH_SPEC)
+    {
+    }
+
+    ~PathFollowBehavior() {
+        detach();
+    }
+
+    /**
+     * Deteremine if dependencies are attached
+     */
+    bool attached(); // RET: true if attached, false if not
+
+    /**
+     * Attach dependencies
+     */
+    PathFollowBehavior& attach(
+        TwoWheelRover& rover,   // IN : rover that get's behavior
+        MessageBus& messageBus);// IN : MessageBus to publish state changes
+                                // RET: this behavior in attached state
+
+    /**
+     * Detach dependencies
+     */
+    PathFollowBehavior& detach(); // RET: this behavior in detached state
+
+    /**
+     * Add a waypoint to the pending path.
+     * Waypoints must be added in order;
+     * index zero starts a new pending path.
+     */
+    int addWaypoint(
+        unsigned int index, // IN : index of waypoint in path
+        distance_type x,    // IN : waypoint's horizontal position in world coordinates
+        distance_type y);   // IN : waypoint's vertical position in world coordinates
+                            // RET: SUCCESS if added,
+                            //      FAILURE if out of order or the path is full
+
+    unsigned int pendingCount() {   // RET: number of waypoints uploaded for the next path
+        return _pendingCount;
+    }
+
+    /**
+     * Start following the pending waypoints
+     * from where the rover is now.
+     */
+    PathFollowBehavior& followPath(
+        distance_type lookahead,    // IN : cm along the path ahead of the rover to steer toward
+        distance_type tolerance);   // IN : cm from last waypoint considered success
+                                    // RET: this behavior
+
+    /**
+     * Extend the path being followed, so a long path
+     * can be streamed a few waypoints at a time.
+     * Waypoints the rover has passed are dropped
+     * to make room.
+     */
+    int appendWaypoint(
+        distance_type x,    // IN : waypoint's horizontal position in world coordinates
+        distance_type y);   // IN : waypoint's vertical position in world coordinates
+                            // RET: SUCCESS if added,
+                            //      FAILURE if not running or the path is full
+
+    /**
+     * Cancel the behavior IF it is running
+     */
+    PathFollowBehavior& cancel(); // RET: this behavior
+
+    /**
+     * Poll from the control loop; this runs the
+     * behavior and updates rover velocities
+     * every GOTO_TICK_MS.
+     */
+    PathFollowBehavior& poll(unsigned long currentMillis);  // IN : current time in milliseconds
+                                                            // RET: this behavior
+
+    GotoGoalState state() {
+        return _state;
+    }
+
+    /**
+     * Get the waypoint the rover is heading for
+     */
+    Pose2D goal();  // RET: position of waypoint at end of current segment
+
+    /**
+     * Get the index of the waypoint the rover is heading for
+     */
+    unsigned int waypointIndex() {  // RET: 0 to number of waypoints - 1
+        return _dropped + _segment;
+    }
+
+    /**
+     * Time taken to reach the last waypoint; while the
+     * behavior is running this is the time so far.
+     */
+    unsigned long timeToGoalMs();   // RET: milliseconds since behavior started running
+
+    /**
+     * Distance the rover has driven along the path,
+     * measured along the path of it's pose.
+     */
+    distance_type pathLength() {    // RET: path length in cm
+        return _pathLength;
+    }
+};
+
+#endif // PATH_FOLLOW_H
@@ -1,3 +1,5 @@
+#include <math.h>
+
 #include "./pose.h"
 
 /**
@@ -5,21 +7,15 @@
  */
 const distance_type TWOPI = 2 * PI;
 distance_type limitAngle(distance_type angle) {
-    // 
-    // atan2 will do this if it is available
-    //
-    return ATAN2(SIN(angle), COS(angle));
-
     //
-    // this may be faster if there is no floating
-    // point processor available.
+    // headings only ever step a little past ±pi,
+    // so a branch and an add is enough; this used
+    // to be atan2(sin(angle), cos(angle)), which
+    // is three libm calls for the same answer.
     //
-    // while(angle > PI) {
-    //     angle -= TWOPI;
-    // }
-    // while(angle < -PI) {
-    //     angle += TWOPI;
-    // }
-
-    return angle;
+    #ifdef USE_FIXED_POINT
+        return fixedWrapAngle(angle);
+    #else
+        return fastWrapAngle(angle);
+    #endif
 }
@@ -1,20 +1,43 @@
 #ifndef POSE_H
 #define POSE_H
 
+#include "../config.h"
 #include "../util/math.h"
+#include "../util/matrix.h"
+#include "../util/fast_trig.h"
 
 //
-// type for distance and velocity
+// type for distance and velocity is distance_type from config.h
 //
-typedef float distance_type;
 const int sizeOfDistance = sizeof(distance_type);
-#define COS(_radians) (cosf(_radians))
-#define SIN(_radians) (sinf(_radians))
-#define ATAN(_value) (atanf(_value))
-#define ATAN2(_value1, _value2) (atan2f(_value1, _value2))
-#define SQRT(_value) (sqrtf(_value))
-#define ABS(_value) (abs<float>(_value))
-#define SIGN(_value) (sign<float>(_value))
+
+//
+// USE_FIXED_POINT selects the integer kernels in
+// util/fixed_point.h for the pose and behavior math,
+// USE_FAST_TRIG selects the polynomial kernels in
+// util/fast_trig.h, otherwise libm is used.
+//
+#ifdef USE_FIXED_POINT
+    #define COS(_radians) (fixedCos(distance_type(_radians)))
+    #define SIN(_radians) (fixedSin(distance_type(_radians)))
+    #define ATAN2(_value1, _value2) (fixedAtan2(distance_type(_value1), distance_type(_value2)))
+    #define SQRT(_value) (fixedSqrt(distance_type(_value)))
+    #define HYPOT(_x, _y) (fixedHypot(distance_type(_x), distance_type(_y)))
+#else
+    #ifdef USE_FAST_TRIG
+        #define COS(_radians) (fastCos(_radians))
+        #define SIN(_radians) (fastSin(_radians))
+        #define ATAN2(_value1, _value2) (fastAtan2(_value1, _value2))
+    #else
+        #define COS(_radians) (cosf(_radians))
+        #define SIN(_radians) (sinf(_radians))
+        #define ATAN2(_value1, _value2) (atan2f(_value1, _value2))
+    #endif
+    #define SQRT(_value) (sqrtf(_value))
+    #define HYPOT(_x, _y) (sqrtf((_x) * (_x) + (_y) * (_y)))
+#endif
+#define ABS(_value) (abs<distance_type>(_value))
+#define SIGN(_value) (sign<distance_type>(_value))
 
 //
 // point on 2D cartesian coordinate space
@@ -55,6 +78,15 @@ typedef struct Velocity2D {
                             // in a right-handed coordinate frame.
 } Velocity2D;
 
+//
+// uncertainty of a Pose2D as the 3x3 covariance
+// of (x, y, angle); row and column 0 is x,
+// 1 is y and 2 is angle.  Symmetric, so
+// (0, 1) is the x-y covariance and (2, 2)
+// is the variance of the angle.
+//
+typedef Matrix<distance_type, 3, 3> PoseCovariance;
+
 extern const distance_type TWOPI;
 extern distance_type limitAngle(distance_type angle);
 
@@ -0,0 +1,154 @@
+#include <assert.h>
+
+#include "pose_history.h"
+
+/**
+ * Forget all samples
+ */
+PoseHistory& PoseHistory::clear()   // RET: this pose history
+{
+    _started.store(0, std::memory_order_relaxed);
+    _sequence.store(0, std::memory_order_release);
+    _heldMs.store(0, std::memory_order_release);
+    return *this;
+}
+
+/**
+ * Get the number of samples being kept
+ */
+unsigned int PoseHistory::count()   // RET: number of samples, up to POSE_HISTORY_COUNT
+{
+    const unsigned int sequence = _sequence.load(std::memory_order_acquire);
+    return (sequence < POSE_HISTORY_COUNT) ? sequence : POSE_HISTORY_COUNT;
+}
+
+/**
+ * Add a newly estimated pose
+ */
+PoseHistory& PoseHistory::append(
+    unsigned long ms,       // IN : time of pose in ms since startup
+    const Pose2D &pose)     // IN : estimated pose
+                            // RET: this pose history
+{
+    //
+    // announce the write before touching the slot,
+    // so a reader copying the sample being
+    // overwritten can tell that it was.
+    //
+    const unsigned int sequence = _sequence.load(std::memory_order_relaxed);
+
+    // poseAt() binary searches by time
+    assert((0 == sequence) || (_samples[(sequence - 1) % POSE_HISTORY_COUNT].ms <= ms));
+
+    _started.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    PoseSample &sample = _samples[sequence % POSE_HISTORY_COUNT];
+    sample.ms = ms;
+    sample.pose = pose;
+
+    _sequence.store(sequence + 1, std::memory_order_release);
+    _heldMs.store(ms, std::memory_order_release);
+    return *this;
+}
+
+/**
+ * Note that the newest pose is still current
+ */
+PoseHistory& PoseHistory::hold(unsigned long ms)    // IN : time encoders were read in ms since startup
+                                                    // RET: this pose history
+{
+    _heldMs.store(ms, std::memory_order_release);
+    return *this;
+}
+
+/**
+ * Interpolate between two poses
+ */
+Pose2D interpolatePose(
+    const Pose2D &from,     // IN : pose at fraction zero
+    const Pose2D &to,       // IN : pose at fraction one
+    distance_type fraction) // IN : 0 to 1
+                            // RET: pose between from and to
+{
+    // turn the shorter way, so -179 to 179 degrees passes through 180
+    const distance_type turn = limitAngle(to.angle - from.angle);
+    Pose2D pose;
+    pose.x = from.x + (to.x - from.x) * fraction;
+    pose.y = from.y + (to.y - from.y) * fraction;
+    pose.angle = limitAngle(from.angle + turn * fraction);
+    return pose;
+}
+
+/**
+ * Look up the pose at a time.
+ *
+ * The samples on either side of ms are found with
+ * a binary search and copied, then the writer's
+ * count of started samples is checked to make sure
+ * neither was overwritten during the copy; if one
+ * was, the history has moved on and the search
+ * is done again.
+ */
+bool PoseHistory::poseAt(
+    unsigned long ms,       // IN : time in ms since startup
+    Pose2D &pose)           // OUT: on true, the pose at that time
+                            // RET: true if ms is within the history
+{
+    for(;;) {
+        const unsigned int sequence = _sequence.load(std::memory_order_acquire);
+        const unsigned long heldMs = _heldMs.load(std::memory_order_acquire);
+        const unsigned int count = (sequence < POSE_HISTORY_COUNT) ? sequence : POSE_HISTORY_COUNT;
+        if(0 == count) {
+            return false;
+        }
+        const unsigned int oldest = sequence - count;
+
+        //
+        // find the first sample newer than ms
+        //
+        unsigned int low = oldest;
+        unsigned int high = sequence;
+        while(low < high) {
+            const unsigned int middle = low + (high - low) / 2;
+            if(_samples[middle % POSE_HISTORY_COUNT].ms <= ms) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+
+        bool found = false;
+        Pose2D result;
+        if(low == oldest) {
+            // older than the history
+        } else if(low == sequence) {
+            // at or after the newest; the rover has not moved since
+            const PoseSample newest = _samples[(sequence - 1) % POSE_HISTORY_COUNT];
+            if((ms == newest.ms) || (ms <= heldMs)) {
+                result = newest.pose;
+                found = true;
+            }
+        } else {
+            const PoseSample before = _samples[(low - 1) % POSE_HISTORY_COUNT];
+            const PoseSample after = _samples[low % POSE_HISTORY_COUNT];
+            result = interpolatePose(before.pose, after.pose, 
+                (distance_type)(ms - before.ms) / (distance_type)(after.ms - before.ms));
+            found = true;
+        }
+
+        //
+        // if the writer has not started on the slot
+        // of the oldest sample we read, nothing we
+        // read was overwritten.
+        //
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const unsigned int started = _started.load(std::memory_order_relaxed);
+        if((started - oldest) <= POSE_HISTORY_COUNT) {
+            if(found) {
+                pose = result;
+            }
+            return found;
+        }
+    }
+}
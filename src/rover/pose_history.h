@@ -0,0 +1,98 @@
+#ifndef POSE_HISTORY_H
+#define POSE_HISTORY_H
+
+#include <atomic>
+
+#include "../config.h"
+#include "./pose.h"
+
+//
+// a pose and the time it was estimated
+//
+typedef struct PoseSample {
+    unsigned long ms;   // time of pose in ms since startup
+    Pose2D pose;        // estimated pose at that time
+} PoseSample;
+
+/**
+ * Time ordered ring of the most recent
+ * POSE_HISTORY_COUNT poses, so something
+ * that happened between pose updates, like
+ * a camera frame or a command, can look up
+ * where the rover was at that time.
+ *
+ * The ring is appended to by the rover's poll
+ * on the control core and may be read from the
+ * other core.  Samples are never locked; instead
+ * a reader copies the samples it needs, then checks
+ * that the writer did not overwrite them while it
+ * was copying, and tries again if it did.
+ */
+class PoseHistory {
+    static_assert((POSE_HISTORY_COUNT > 1) && (0 == (POSE_HISTORY_COUNT & (POSE_HISTORY_COUNT - 1))), "POSE_HISTORY_COUNT must be a power of two");
+
+    private:
+    PoseSample _samples[POSE_HISTORY_COUNT];
+    std::atomic<unsigned int> _started;     // samples the writer has started to write
+    std::atomic<unsigned int> _sequence;    // samples written; sequence number of next sample
+    std::atomic<unsigned long> _heldMs;     // newest pose is unchanged through this time
+
+    public:
+
+    PoseHistory()
+        : _started(0), _sequence(0), _heldMs(0)
+    {
+        // no-op
+    }
+
+    /**
+     * Forget all samples
+     */
+    PoseHistory& clear();   // RET: this pose history
+
+    /**
+     * Get the number of samples being kept
+     */
+    unsigned int count();   // RET: number of samples, up to POSE_HISTORY_COUNT
+
+    /**
+     * Add a newly estimated pose, overwriting
+     * the oldest if the ring is full.
+     * Times must not decrease.
+     */
+    PoseHistory& append(
+        unsigned long ms,       // IN : time of pose in ms since startup
+        const Pose2D &pose);    // IN : estimated pose
+                                // RET: this pose history
+
+    /**
+     * Note that the newest pose is still current;
+     * the encoders were read and had not moved.
+     */
+    PoseHistory& hold(unsigned long ms);    // IN : time encoders were read in ms since startup
+                                            // RET: this pose history
+
+    /**
+     * Look up the pose at a time, interpolating
+     * between the samples on either side of it.
+     * Position is interpolated linearly and the angle
+     * along the shorter way around the circle.
+     */
+    bool poseAt(
+        unsigned long ms,       // IN : time in ms since startup
+        Pose2D &pose);          // OUT: on true, the pose at that time
+                                // RET: true if ms is within the history,
+                                //      false if it is older than the oldest
+                                //      sample or newer than the newest.
+};
+
+/**
+ * Interpolate between two poses
+ */
+extern Pose2D interpolatePose(
+    const Pose2D &from,     // IN : pose at fraction zero
+    const Pose2D &to,       // IN : pose at fraction one
+    distance_type fraction);// IN : 0 to 1
+                            // RET: pose between from and to
+
+#endif // POSE_HISTORY_H
@@ -5,6 +5,7 @@
 #include "string/strcopy.h"
 #include "util/math.h"
 #include "goto_goal.h"
+#include "../recorder/flight_recorder.h"
 
 
 
@@ -30,6 +31,9 @@ TwoWheelRover& TwoWheelRover::attach(
         _leftWheel = &leftWheel;
         _rightWheel = &rightWheel;
         _messageBus = messageBus;
+        _odometry.setWheels(
+            leftWheel.circumference(), leftWheel.countsPerRevolution(),
+            rightWheel.circumference(), rightWheel.countsPerRevolution());
     }
 
     return *this;
@@ -54,7 +58,19 @@ TwoWheelRover& TwoWheelRover::detach() // RET: this rover in detached state
  */
 distance_type TwoWheelRover::wheelBase() // RET: distance between drive wheels
 {
-    return _wheelBase;
+    return _odometry.wheelBase();
+}
+
+/**
+ * Set the flight recorder that receives
+ * encoder samples and poses.
+ */
+TwoWheelRover& TwoWheelRover::setRecorder(FlightRecorder *recorder)   // IN : recording flight recorder 
+                                                                        //      or nullptr to stop recording
+                                                                        // RET: this rover
+{
+    _recorder = recorder;
+    return *this;
 }
 
 /**
@@ -80,6 +96,48 @@ TwoWheelRover& TwoWheelRover::setSpeedControl(
     return *this;
 }
 
+/**
+ * Set acceleration limits for the wheels.
+ * While both wheels ramp to new speeds, each
+ * wheel's limits are scaled so they finish together
+ * and the rover keeps the curvature of it's path.
+ */
+TwoWheelRover& TwoWheelRover::setAccelerationLimits(
+    WheelId wheels,             // IN : bit flags for wheels to apply 
+    speed_type maxAcceleration, // IN : cm/sec² limit on change in speed; 0 for no limit
+    speed_type maxJerk,         // IN : cm/sec³ limit on change in acceleration; 0 for no limit
+    float maxPwmRate,           // IN : pwm/sec limit on change in power; 0 for no limit
+    float maxPwmJerk)           // IN : pwm/sec² limit on change in power rate; 0 for no limit
+                                // RET: this TwoWheelRover
+{
+    if(attached()) {
+        if(wheels & LEFT_WHEEL) {
+            if(nullptr != _leftWheel) _leftWheel->setAccelerationLimits(maxAcceleration, maxJerk, maxPwmRate, maxPwmJerk);
+        }
+        if(wheels & RIGHT_WHEEL) {
+            if(nullptr != _rightWheel) _rightWheel->setAccelerationLimits(maxAcceleration, maxJerk, maxPwmRate, maxPwmJerk);
+        }
+    }
+    return *this;
+}
+
+/**
+ * Set the gains of the controller that keeps the wheels
+ * in step.  Zero for both gains turns it off.
+ */
+TwoWheelRover& TwoWheelRover::setWheelSync(
+    float Kp,   // IN : cm/sec of trim per cm of error
+    float Ki)   // IN : cm/sec of trim per cm·sec of error
+                // RET: this TwoWheelRover
+{
+    _wheelSync.setGains(Kp, Ki);
+    if((nullptr != _leftWheel) && (nullptr != _rightWheel)) {
+        _leftWheel->setSpeedTrim(0);
+        _rightWheel->setSpeedTrim(0);
+    }
+    return *this;
+}
+
 /**
  * Set motor stall values.
  * These are the values below which the motor will stall,
@@ -204,7 +262,7 @@ TwoWheelRover& TwoWheelRover::_roverWheelSpeed(
             if(useSpeedControl) {
                 wheel->setSpeed(forward ? speed : -speed);
             } else {
-                wheel->setPower(forward, speed);
+                wheel->setPower(forward, (pwm_type)speed);
             }
         }
     }
@@ -239,6 +297,42 @@ TwoWheelRover& TwoWheelRover::roverRightWheel(
     return _roverWheelSpeed(_rightWheel, useSpeedControl, forward, speed);
 }
 
+/**
+ * Drive the rover at a linear velocity and turning rate,
+ * using the wheel speed controllers.
+ */
+TwoWheelRover& TwoWheelRover::setVelocity(
+    speed_type linear,      // IN : cm/sec forward, negative for reverse
+    speed_type angular)     // IN : radians/sec counter-clockwise,
+                            //      negative for clockwise
+                            // RET: this TwoWheelRover
+{
+    if (!attached())
+        return *this;
+
+    const speed_type turn = angular * wheelBase() / 2;
+    speed_type leftSpeed = linear - turn;
+    speed_type rightSpeed = linear + turn;
+
+    //
+    // saturate the faster wheel at maximum speed and
+    // scale the other by the same factor, so the ratio
+    // of wheel speeds, and so the curvature, is kept.
+    // Uncalibrated wheels (zero maximum) are not limited.
+    //
+    const speed_type maxSpeed = maximumSpeed();
+    const speed_type fastest = max<speed_type>(abs<speed_type>(leftSpeed), abs<speed_type>(rightSpeed));
+    if((maxSpeed > 0) && (fastest > maxSpeed)) {
+        const speed_type scale = maxSpeed / fastest;
+        leftSpeed *= scale;
+        rightSpeed *= scale;
+    }
+
+    _roverWheelSpeed(_leftWheel, true, leftSpeed >= 0, abs<speed_type>(leftSpeed));
+    _roverWheelSpeed(_rightWheel, true, rightSpeed >= 0, abs<speed_type>(rightSpeed));
+    return *this;
+}
+
 
 /**
  * Poll rover systems
@@ -258,9 +352,25 @@ TwoWheelRover& TwoWheelRover::poll(
  * Poll wheel encoders
  */
 TwoWheelRover& TwoWheelRover::_pollWheels(    
-    unsigned long currentMillis)   // IN : milliseconds since startup
+    unsigned long)                 // IN : milliseconds since startup
                                    // RET: this rover
 {
+    //
+    // scale each wheel's ramp by the change it has left to
+    // make, so both ramps have the same shape and finish
+    // together, and the ratio of wheel speeds, which is
+    // the curvature of the rover's path, is kept.
+    //
+    if((nullptr != _leftWheel) && (nullptr != _rightWheel)) {
+        const float left = abs(_leftWheel->rampRemaining());
+        const float right = abs(_rightWheel->rampRemaining());
+        const float largest = (left > right) ? left : right;
+        if(largest > 0) {
+            _leftWheel->setRampScale(left / largest);
+            _rightWheel->setRampScale(right / largest);
+        }
+    }
+
     if(nullptr != _leftWheel) {
         _leftWheel->poll(millis());
     }
@@ -268,6 +378,30 @@ TwoWheelRover& TwoWheelRover::_pollWheels(
         _rightWheel->poll(millis());
     }
 
+    //
+    // trim the setpoints so the wheels keep the ratio of
+    // their setpoints, rather than each drifting within
+    // it's own controller's tolerance.
+    //
+    if((nullptr != _leftWheel) && (nullptr != _rightWheel)) {
+        const unsigned long currentMillis = millis();
+        const float seconds = (0 == _syncMs) ? 0 : (currentMillis - _syncMs) / 1000.0f;
+        _syncMs = currentMillis;
+        if(_leftWheel->useSpeedControl() && _rightWheel->useSpeedControl()) {
+            // distance from the encoders, which is finer than the speed controller's last measurement
+            const distance_type leftDistance = _leftWheel->circumference() * ((distance_type)readLeftWheelEncoder() / _leftWheel->countsPerRevolution());
+            const distance_type rightDistance = _rightWheel->circumference() * ((distance_type)readRightWheelEncoder() / _rightWheel->countsPerRevolution());
+            _wheelSync.step(
+                _leftWheel->setpointSpeed(), _rightWheel->setpointSpeed(),
+                leftDistance, rightDistance,
+                seconds);
+        } else {
+            _wheelSync.reset();
+        }
+        _leftWheel->setSpeedTrim(_wheelSync.leftTrim());
+        _rightWheel->setSpeedTrim(_wheelSync.rightTrim());
+    }
+
     return *this;
 }
 
@@ -276,7 +410,7 @@ TwoWheelRover& TwoWheelRover::_pollWheels(
  */
 unsigned long TwoWheelRover::lastPoseMs()   // RET: time of last poll in ms
 {
-    return _lastPoseMs;
+    return _odometry.lastPoseMs();
 }
 
 
@@ -285,7 +419,7 @@ unsigned long TwoWheelRover::lastPoseMs()   // RET: time of last poll in ms
  */
 Pose2D TwoWheelRover::pose()   // RET: most recently calculated pose
 {
-    return _lastPose;
+    return _odometry.pose();
 }
 
 /**
@@ -293,7 +427,36 @@ Pose2D TwoWheelRover::pose()   // RET: most recently calculated pose
  */
 Pose2D TwoWheelRover::poseVelocity()   // RET: most recently calculated pose velocity
 {
-    return _lastPoseVelocity;
+    return _odometry.poseVelocity();
+}
+
+/**
+ * Predict the pose now, between pose updates
+ */
+Pose2D TwoWheelRover::predictedPose(unsigned long currentMillis)  // IN : milliseconds since startup
+                                                                  // RET: predicted pose
+{
+    return _odometry.predict(currentMillis);
+}
+
+/**
+ * Get the covariance of the most recently calculated pose
+ */
+PoseCovariance TwoWheelRover::poseCovariance()   // RET: uncertainty of most recently calculated pose
+{
+    return _odometry.covariance();
+}
+
+/**
+ * Look up where the rover was at a time
+ */
+bool TwoWheelRover::poseAt(
+    unsigned long ms,   // IN : time in ms since startup
+    Pose2D &pose)       // OUT: on true, the pose at that time
+                        // RET: true if ms is within the last
+                        //      POSE_HISTORY_COUNT pose updates
+{
+    return _poseHistory.poseAt(ms, pose);
 }
 
 /**
@@ -301,7 +464,8 @@ Pose2D TwoWheelRover::poseVelocity()   // RET: most recently calculated pose vel
  */
 TwoWheelRover& TwoWheelRover::resetPose()   // RET: this rover
 {
-    _lastPoseMs = 0;    // will reset on next _pollPose()
+    _odometry.reset();    // will reset on next _pollPose()
+    _poseHistory.clear();
     return *this;
 }
 
@@ -316,94 +480,52 @@ TwoWheelRover& TwoWheelRover::_pollPose(
 {
     if(attached()) {
         //
-        // determine if enough time has gone by to run speed control
+        // determine if enough time has gone by to run pose estimation
         //
-        if(0 == _lastPoseMs) {
-            // initialize
-            _lastPoseMs = currentMillis;
-            _lastLeftEncoderTicks = readLeftWheelTicks();   // last encoder ticks for left wheel
-            _lastRightEncoderTicks = readRightWheelTicks();  // last encoder ticks for right wheel
-            _lastLeftDistance = _leftWheel->circumference() * (distance_type)readLeftWheelEncoder() / _leftWheel->countsPerRevolution();;
-            _lastRightDistance = _rightWheel->circumference() * (distance_type)readRightWheelEncoder() / _rightWheel->countsPerRevolution();
+        if(_odometry.isDue(currentMillis)) {
+            const bool starting = !_odometry.started();
+            EncoderSample sample;
+            sample.ms = currentMillis;
+            sample.leftTicks = readLeftWheelTicks();
+            sample.rightTicks = readRightWheelTicks();
+            sample.leftCount = readLeftWheelEncoder();
+            sample.rightCount = readRightWheelEncoder();
 
             //
-            // stopped at origin, pointing to zero radians
+            // record samples where the encoders changed;
+            // replaying just those through Odometry
+            // reproduces the same poses.
             //
-            _lastPose.x = 0;
-            _lastPose.y = 0;
-            _lastPose.angle = 0;   // pointing right
-            _lastPoseVelocity.x = 0;
-            _lastPoseVelocity.y = 0;
-            _lastPoseVelocity.angle = 0;
-
-            // publish speed control message
-            if(nullptr != _messageBus) {
-                publish(*_messageBus, ROVER_POSE, ROVER_SPEC);
+            if((nullptr != _recorder) 
+                && (starting 
+                    || (sample.leftTicks != _lastRecordedLeftTicks) 
+                    || (sample.rightTicks != _lastRecordedRightTicks))) 
+            {
+                _recorder->recordEncoders(currentMillis, starting ? FLIGHT_ENCODERS_START : 0, sample);
+                _lastRecordedLeftTicks = sample.leftTicks;
+                _lastRecordedRightTicks = sample.rightTicks;
             }
-        } else if(currentMillis >= (_lastPoseMs + POSE_POLL_MS)) {
 
-            //
-            // make sure at least one wheel has moves some minimum rotation 
-            // so we can reduce noise in the velocity calculation
-            //
-            const encoder_count_type leftWheelTicks = readLeftWheelTicks();
-            const encoder_count_type rightWheelTicks = readRightWheelTicks();
-            if(((leftWheelTicks - _lastLeftEncoderTicks) >= POSE_MIN_ENCODER_COUNT) 
-                || ((rightWheelTicks - _lastRightEncoderTicks) >= POSE_MIN_ENCODER_COUNT)) 
-            {
-                const distance_type currentLeftDistance = 
-                    _leftWheel->circumference() * (distance_type)readLeftWheelEncoder() / _leftWheel->countsPerRevolution();
-                const distance_type leftDeltaDistance = currentLeftDistance - _lastLeftDistance;
-
-                const distance_type currentRightDistance =  
-                    _rightWheel->circumference() * (distance_type)readRightWheelEncoder() / _rightWheel->countsPerRevolution();
-                const distance_type rightDeltaDistance = currentRightDistance - _lastRightDistance; 
-
-                // distance and velocity at center of rover
-                const distance_type deltaTimeSec = (currentMillis - _lastPoseMs) / 1000.0;
-                const distance_type deltaDistance = (rightDeltaDistance + leftDeltaDistance) / 2;
-                // const speed_type linearVelocity = deltaDistance / deltaTimeSec;
-
-                const distance_type deltaAngle = (rightDeltaDistance - leftDeltaDistance) / _wheelBase;
-                const speed_type angularVelocity = deltaAngle / deltaTimeSec;
-
-                // new position and orientation
-                const distance_type estimatedAngle = limitAngle(_lastPose.angle + deltaAngle / 2);  // assume mid point of orientation change when calculated updated position
-                const distance_type x = _lastPose.x + deltaDistance * cosf(estimatedAngle);
-                const distance_type y = _lastPose.y + deltaDistance * sinf(estimatedAngle);
-                const distance_type angle = limitAngle(_lastPose.angle + deltaAngle);
-
-                //
-                // update velocities
-                //
-                _lastPoseVelocity.x = (x - _lastPose.x) / deltaTimeSec;
-                _lastPoseVelocity.y = (y - _lastPose.y) / deltaTimeSec;
-                _lastPoseVelocity.angle = angularVelocity;
-
-                // 
-                // update pose
-                //
-                _lastPose.x = x;
-                _lastPose.y = y;
-                _lastPose.angle = angle;
-
-                // 
-                // record keeping
-                //
-                _lastPoseMs = currentMillis;
-                _lastLeftEncoderTicks = leftWheelTicks;
-                _lastRightEncoderTicks = rightWheelTicks;
-                _lastLeftDistance = currentLeftDistance;
-                _lastRightDistance = currentRightDistance;
-
-                // publish speed control message
+            if(_odometry.update(sample)) {
+                _poseHistory.append(currentMillis, _odometry.pose());
+                if(nullptr != _recorder) {
+                    _recorder->recordPose(currentMillis, _odometry.pose());
+                }
+
+                // publish pose message
                 if(nullptr != _messageBus) {
                     publish(*_messageBus, ROVER_POSE, ROVER_SPEC);
                 }
+            } else {
+                // wheels have not moved; pose is still current
+                _poseHistory.hold(currentMillis);
             }
         }
+
+        if(nullptr != _recorder) {
+            _recorder->flush(currentMillis);
+        }
     }
 
     return *this;
 }
-
@@ -3,9 +3,14 @@
 
 #include "../wheel/drive_wheel.h"
 #include "./pose.h"
+#include "./odometry.h"
+#include "./pose_history.h"
+#include "./wheel_sync.h"
 
 #include <stdint.h>
 
+class FlightRecorder;
+
 #ifdef DEBUG
     #include <stdio.h>
     #define LOG(_msg) do{printf(String(_msg).c_str());}while(0)
@@ -34,21 +39,21 @@ class TwoWheelRover : public Publisher  {
     // attached dependencies
     DriveWheel *_leftWheel = nullptr;
     DriveWheel *_rightWheel = nullptr;
-    distance_type _wheelBase;
     MessageBus *_messageBus = nullptr;
+    FlightRecorder *_recorder = nullptr;
 
     pwm_type _speedLeft = 0;
     pwm_type _speedRight = 0;
     pwm_type _forwardLeft = 1;
     pwm_type _forwardRight = 1;
 
-    unsigned long _lastPoseMs = 0;         // last time we polled for pose
-    encoder_count_type _lastLeftEncoderTicks = 0;   // last encoder count for left wheel
-    encoder_count_type _lastRightEncoderTicks = 0;  // last encoder count for right wheel
-    distance_type _lastLeftDistance = 0;   // last calculated distance for left wheel
-    distance_type _lastRightDistance = 0;  // last calculated distance for right wheel
-    Pose2D _lastPose = {0, 0, 0};          // most recently polled position/orientation
-    Pose2D _lastPoseVelocity = {0, 0, 0};      // most recently polled velocities
+    Odometry _odometry;                     // pose estimation from wheel encoders
+    PoseHistory _poseHistory;               // recent poses for lookup by time
+    encoder_count_type _lastRecordedLeftTicks = 0;  // encoder ticks in last recorded sample
+    encoder_count_type _lastRecordedRightTicks = 0;
+
+    WheelSync _wheelSync;                   // keeps the wheels in step with each other
+    unsigned long _syncMs = 0;              // time of last wheel sync step
 
     /**
      * Poll command queue 
@@ -84,7 +89,9 @@ class TwoWheelRover : public Publisher  {
 
     TwoWheelRover(        
         distance_type wheelBase) // IN : distance between drive wheels
-        :  Publisher(ROVER_SPEC), _wheelBase(wheelBase)
+        :  Publisher(ROVER_SPEC), 
+           _odometry(wheelBase), 
+           _wheelSync(WHEEL_SYNC_KP, WHEEL_SYNC_KI, WHEEL_SYNC_MAX_TRIM)
     {
     }
 
@@ -117,6 +124,14 @@ class TwoWheelRover : public Publisher  {
      */
     distance_type wheelBase(); // RET: distance between drive wheels
 
+    /**
+     * Set the flight recorder that receives
+     * encoder samples and poses.
+     */
+    TwoWheelRover& setRecorder(FlightRecorder *recorder);   // IN : recording flight recorder 
+                                                            //      or nullptr to stop recording
+                                                            // RET: this rover
+
     /**
      * Reset pose estimation back to origin
      */
@@ -134,6 +149,39 @@ class TwoWheelRover : public Publisher  {
         float Kd);              // IN : derivative gain
                                 // RET: this TwoWheelRover
 
+    /**
+     * Set acceleration limits for the wheels.
+     * While both wheels ramp to new speeds, each
+     * wheel's limits are scaled so they finish together
+     * and the rover keeps the curvature of it's path.
+     */
+    TwoWheelRover& setAccelerationLimits(
+        WheelId wheels,             // IN : bit flags for wheels to apply 
+        speed_type maxAcceleration, // IN : cm/sec² limit on change in speed; 0 for no limit
+        speed_type maxJerk,         // IN : cm/sec³ limit on change in acceleration; 0 for no limit
+        float maxPwmRate,           // IN : pwm/sec limit on change in power; 0 for no limit
+        float maxPwmJerk);          // IN : pwm/sec² limit on change in power rate; 0 for no limit
+                                    // RET: this TwoWheelRover
+
+    /**
+     * Set the gains of the controller that keeps the wheels
+     * in step, so the rover does not drift off a straight
+     * line or arc when the motors are mismatched.
+     * While both wheels use speed control, it trims their
+     * setpoints by the distance one wheel has got ahead of
+     * the other.  Zero for both gains turns it off.
+     */
+    TwoWheelRover& setWheelSync(
+        float Kp,   // IN : cm/sec of trim per cm of error
+        float Ki);  // IN : cm/sec of trim per cm·sec of error
+                    // RET: this TwoWheelRover
+
+    /**
+     * Get the distance the wheels have drifted
+     * from the ratio of their setpoints.
+     */
+    distance_type wheelSyncError() { return _wheelSync.error(); }   // RET: error in cm; positive if left is ahead
+
     /**
      * Set motor stall values.
      * These are the values below which the motor will stall,
@@ -208,6 +256,29 @@ class TwoWheelRover : public Publisher  {
      */
     Pose2D poseVelocity();   // RET: most recently calculated pose velocity
 
+    /**
+     * Predict the pose now, between pose updates,
+     * from the last pose and it's velocity.
+     */
+    Pose2D predictedPose(unsigned long currentMillis);  // IN : milliseconds since startup
+                                                        // RET: predicted pose
+
+    /**
+     * Get the covariance of the most recently calculated pose
+     */
+    PoseCovariance poseCovariance();   // RET: uncertainty of most recently calculated pose
+
+    /**
+     * Look up where the rover was at a time,
+     * interpolating between recent poses.
+     * This may be called from the other core.
+     */
+    bool poseAt(
+        unsigned long ms,   // IN : time in ms since startup
+        Pose2D &pose);      // OUT: on true, the pose at that time
+                            // RET: true if ms is within the last
+                            //      POSE_HISTORY_COUNT pose updates
+
 
     /**
      * Immediately 
@@ -241,11 +312,29 @@ class TwoWheelRover : public Publisher  {
         speed_type speed);      // IN : target speed for wheel
                                 // RET: this TwoWheelRover
 
+    /**
+     * Drive the rover at a linear velocity and turning rate,
+     * using the wheel speed controllers.
+     *
+     *   left  = linear - angular * wheelBase / 2
+     *   right = linear + angular * wheelBase / 2
+     *
+     * If either wheel would be faster than maximumSpeed()
+     * then both are slowed by the same factor, so the rover
+     * drives the same arc (keeps it's curvature) more slowly.
+     */
+    TwoWheelRover& setVelocity(
+        speed_type linear,      // IN : cm/sec forward, negative for reverse
+        speed_type angular);    // IN : radians/sec counter-clockwise,
+                                //      negative for clockwise
+                                // RET: this TwoWheelRover
+
     private: 
     /**
      * Log the current value of the wheel encoders
      */
     void logWheelEncoders(EncoderLogger logger) {
+        (void)logger;   // only used when logging at DEBUG_LEVEL
         #ifdef LOG_MESSAGE
         #ifdef LOG_LEVEL
             #if (LOG_LEVEL >= DEBUG_LEVEL)
@@ -1,5 +1,8 @@
 #include "./rover_command.h"
 #include "./rover_parse.h"
+#include "../telemetry.h"
+#include "../recorder/flight_recorder.h"
+#include "../map/path_planner.h"
 
 // turtle commands
 typedef enum {
@@ -21,15 +24,6 @@ const char *directionString[DIRECTION_COUNT] = {
     "reverse"
 };
 
-const char *CommandNames[] = {
-    "noop",
-    "halt",
-    "tank",
-    "pid",
-    "stall",
-    "resetPose",
-};
-
 
 /**
  * Determine if rover's dependencies are attached
@@ -43,12 +37,15 @@ bool RoverCommandProcessor::attached() {
  */
 RoverCommandProcessor& RoverCommandProcessor::attach(
     TwoWheelRover &rover,               // IN : left drive wheel in attached state
-    GotoGoalBehavior &gotoGoalBehavior) // IN : right drive wheel in attached state
+    GotoGoalBehavior &gotoGoalBehavior, // IN : right drive wheel in attached state
+    TelemetrySender *telemetry)         // IN : telemetry sender or nullptr;
+                                        //      receives telemetry format commands
                                         // RET: this behavior in attached state
 {
     if(!attached()) {
         _rover = &rover;
         _gotoGoalBehavior = &gotoGoalBehavior;
+        _telemetry = telemetry;
     }
 
     return *this;
@@ -62,12 +59,57 @@ RoverCommandProcessor& RoverCommandProcessor::detach() // RET: this behavior in
     if(attached()) {
         _rover = nullptr;
         _gotoGoalBehavior = nullptr;
+        _telemetry = nullptr;
     }
 
     return *this;
 }
 
+/**
+ * Set the flight recorder that receives submitted commands
+ */
+RoverCommandProcessor& RoverCommandProcessor::setRecorder(FlightRecorder *recorder)   // IN : recording flight recorder 
+                                                                                        //      or nullptr to stop recording
+                                                                                        // RET: this RoverCommandProcessor
+{
+    _recorder = recorder;
+    return *this;
+}
+
+
+
+/**
+ * Set the behavior that follows uploaded waypoints
+ */
+RoverCommandProcessor& RoverCommandProcessor::setPathFollowBehavior(PathFollowBehavior *pathFollowBehavior)   // IN : behavior in attached state
+                                                                                                                //      or nullptr to ignore path commands
+                                                                                                                // RET: this RoverCommandProcessor
+{
+    _pathFollowBehavior = pathFollowBehavior;
+    return *this;
+}
+
+/**
+ * Set the recorder that records and plays back driven paths
+ */
+RoverCommandProcessor& RoverCommandProcessor::setWaypointRecorder(WaypointRecorder *waypointRecorder) // IN : recorder in attached state
+                                                                                                        //      or nullptr to ignore record and play commands
+                                                                                                        // RET: this RoverCommandProcessor
+{
+    _waypointRecorder = waypointRecorder;
+    return *this;
+}
 
+/**
+ * Set the planner that plans and drives paths around obstacles
+ */
+RoverCommandProcessor& RoverCommandProcessor::setPathPlanner(PathPlanner *pathPlanner)    // IN : planner in attached state
+                                                                                            //      or nullptr to ignore plan commands
+                                                                                            // RET: this RoverCommandProcessor
+{
+    _pathPlanner = pathPlanner;
+    return *this;
+}
 
 /**
  * Add a command, as string parameters, to the command queue
@@ -145,83 +187,227 @@ int RoverCommandProcessor::submitTurtleCommand(
     return FAILURE;
 }
 
-/*
-** submit the command that was
-** send in the websocket channel
-*/
-SubmitCommandResult RoverCommandProcessor::submitCommand(
-    const char *commandParam,   // IN : A wrapped tank command link cmd(tank(...))
+/**
+ * Parse a command without executing it.
+ * This does not touch the rover or telemetry,
+ * so it may be called on any core.
+ */
+SubmitCommandResult RoverCommandProcessor::parseCommandText(
+    const char *commandParam,   // IN : A wrapped command like cmd(tank(...))
     const int offset)           // IN : offset of cmd() wrapper in command buffer
                                 // RET: struct with status, command id and command
                                 //      where status == SUCCESS or
                                 //      status == -1 on bad command (null or empty)
                                 //      status == -2 on parse error
-                                //      status == -3 on enqueue error (queue is full)
 {
-    int error = COMMAND_BAD_FAILURE;
-    if((NULL != commandParam) && (offset >= 0)) {
-        //
-        // parse the command from the buffer
-        // like: tank(true, 128, false, 196)
-        //
-        String command = String(commandParam);
-        ParseCommandResult parsed = parseCommand(command, offset);
-        if(parsed.matched) {
-            switch(parsed.command.type) {
-                case NOOP: {
-                    return {SUCCESS, parsed.id, parsed.command};
-                }
-                case HALT: {
-                    // execute halt immediately
-                    _rover->roverHalt();
-                    _gotoGoalBehavior->cancel();
-                    return {SUCCESS, parsed.id, parsed.command};
+    if((NULL == commandParam) || (offset < 0)) {
+        return {COMMAND_BAD_FAILURE, 0, RoverCommand()};
+    }
+
+    //
+    // parse the command from the buffer
+    // like: tank(true, 128, false, 196)
+    //
+    String command = String(commandParam);
+    ParseCommandResult parsed = parseCommand(command, offset);
+    if(!parsed.matched) {
+        return {COMMAND_PARSE_FAILURE, 0, RoverCommand()};
+    }
+    return {SUCCESS, parsed.id, parsed.command};
+}
+
+/**
+ * Execute a parsed command.
+ */
+int RoverCommandProcessor::executeCommand(
+    const RoverCommand &command,    // IN : parsed command
+    const char *commandText)        // IN : text of command for the flight recorder,
+                                    //      or nullptr
+                                    // RET: SUCCESS or
+                                    //      status == -2 on unknown command
+                                    //      status == -3 on enqueue error (queue or path is full)
+{
+    //
+    // only commands that move the rover are recorded;
+    // telemetry commands may run on the other core
+    // and do not change what is replayed.
+    //
+    if((nullptr != _recorder) && (nullptr != commandText) && !isTelemetryCommand(command.type)) {
+        _recorder->recordCommand(millis(), commandText);
+    }
+    switch(command.type) {
+        case NOOP: {
+            return SUCCESS;
+        }
+        case HALT: {
+            // execute halt immediately
+            _rover->roverHalt();
+            if(_pathPlanner) {
+                _pathPlanner->cancel();
+            }
+            _gotoGoalBehavior->cancel();
+            if(_pathFollowBehavior) {
+                _pathFollowBehavior->cancel();
+            }
+            return SUCCESS;
+        }
+        case TANK: {
+            // queue up movement command
+            return (SUCCESS == enqueueRoverCommand(command.tank)) ? SUCCESS : COMMAND_ENQUEUE_FAILURE;
+        }
+        case TWIST: {
+            // queue up movement command, in order with tank commands
+            return (SUCCESS == enqueueRoverCommand(command)) ? SUCCESS : COMMAND_ENQUEUE_FAILURE;
+        }
+        case PID: {
+            // execute control command immediately
+            const PidCommand& pid = command.pid;
+            _rover->setSpeedControl(pid.wheels, pid.minSpeed, pid.maxSpeed, pid.Kp, pid.Ki, pid.Kd);
+            return SUCCESS;
+        }
+        case STALL: {
+            // execute control command immediately
+            const StallCommand& stall = command.stall;
+            _rover->setMotorStall(stall.leftStall, stall.rightStall);
+            return SUCCESS;
+        }
+        case SYNC: {
+            // execute control command immediately
+            _rover->setWheelSync(command.sync.Kp, command.sync.Ki);
+            return SUCCESS;
+        }
+        case RESET_POSE: {
+            // execute reset pose immediately
+            _rover->resetPose();
+            return SUCCESS;
+        }
+        case GOTO: {
+            if(_pathPlanner) {
+                _pathPlanner->cancel();
+            }
+            if(_pathFollowBehavior) {
+                _pathFollowBehavior->cancel();
+            }
+            if(_gotoGoalBehavior) {
+                const GotoCommand& go2 = command.go2;
+                _gotoGoalBehavior->gotoGoal(go2.x, go2.y, go2.pointForward, go2.tolerance).poll(millis());
+            }
+            return SUCCESS;
+        }
+        case WAYPOINT: {
+            // waypoints are kept until a path command follows them
+            if(_pathFollowBehavior) {
+                const WaypointCommand& waypoint = command.waypoint;
+                if(SUCCESS != _pathFollowBehavior->addWaypoint(waypoint.index, waypoint.x, waypoint.y)) {
+                    return COMMAND_ENQUEUE_FAILURE;
                 }
-                case TANK: {
-                    // queue up movement command
-                    TankCommand& tank = parsed.command.tank;
-                    if(SUCCESS == enqueueRoverCommand(tank)) {
-                        return {SUCCESS, parsed.id, parsed.command};
-                    } else {
-                        error = COMMAND_ENQUEUE_FAILURE;
-                    }
-                    break;
+            }
+            return SUCCESS;
+        }
+        case PATH: {
+            if(_pathFollowBehavior) {
+                if(_pathPlanner) {
+                    _pathPlanner->cancel();
                 }
-                case PID: {
-                    // execute control command immediately
-                    PidCommand& pid = parsed.command.pid;
-                    _rover->setSpeedControl(pid.wheels, pid.minSpeed, pid.maxSpeed, pid.Kp, pid.Ki, pid.Kd);
-                    return {SUCCESS, parsed.id, parsed.command};
+                if(_gotoGoalBehavior) {
+                    _gotoGoalBehavior->cancel();
                 }
-                case STALL: {
-                    // execute control command immediately
-                    StallCommand stall = parsed.command.stall;
-                    _rover->setMotorStall(stall.leftStall, stall.rightStall);
-                    return {SUCCESS, parsed.id, parsed.command};
+                _pathFollowBehavior->followPath(command.path.lookahead, command.path.tolerance).poll(millis());
+            }
+            return SUCCESS;
+        }
+        case RECORD: {
+            // poses are recorded while the rover is driven by other commands
+            if(_waypointRecorder) {
+                if(command.record.on) {
+                    _waypointRecorder->startRecording();
+                } else {
+                    _waypointRecorder->stopRecording();
                 }
-                case RESET_POSE: {
-                    // execute reset pose immediately
-                    _rover->resetPose();
-                    return {SUCCESS, parsed.id, parsed.command};
+            }
+            return SUCCESS;
+        }
+        case PLAY: {
+            if(_waypointRecorder && _pathFollowBehavior) {
+                if(_pathPlanner) {
+                    _pathPlanner->cancel();
                 }
-                case GOTO: {
-                    if(_gotoGoalBehavior) {
-                        const GotoCommand go2 = parsed.command.go2;
-                        _gotoGoalBehavior->gotoGoal(go2.x, go2.y, go2.pointForward, go2.tolerance).poll(millis());
-                    }
-                    return {SUCCESS, parsed.id, parsed.command};
+                if(_gotoGoalBehavior) {
+                    _gotoGoalBehavior->cancel();
                 }
-                default: {
-                    error = COMMAND_PARSE_FAILURE;
-                    break;
+                _waypointRecorder->play(*_pathFollowBehavior, command.path.lookahead, command.path.tolerance);
+                _pathFollowBehavior->poll(millis());
+            }
+            return SUCCESS;
+        }
+        case PLAN: {
+            // the planner drives the goto goal behavior one waypoint at a time
+            if(_pathPlanner) {
+                if(_pathFollowBehavior) {
+                    _pathFollowBehavior->cancel();
                 }
+                _gotoGoalBehavior->cancel();
+                const GotoCommand& plan = command.go2;
+                _pathPlanner->planAndDrive(plan.x, plan.y, plan.pointForward, plan.tolerance).poll(millis());
+            }
+            return SUCCESS;
+        }
+        case TELEMETRY_FORMAT: {
+            // applies to telemetry formatted after the ack is sent
+            if(_telemetry) {
+                _telemetry->setFormat(command.format.binary ? TELEMETRY_BINARY : TELEMETRY_TEXT);
+                _telemetry->setDelta(command.format.delta);
             }
-        } else {
-            error = COMMAND_PARSE_FAILURE;
+            return SUCCESS;
+        }
+        case TELEMETRY_RATE: {
+            if(_telemetry) {
+                _telemetry->setChannelPeriod(command.telemetry.channel, command.telemetry.periodMs);
+            }
+            return SUCCESS;
+        }
+        case TELEMETRY_KEYFRAME: {
+            if(_telemetry) {
+                _telemetry->requestKeyframe(command.telemetry.channel);
+            }
+            return SUCCESS;
+        }
+        case TELEMETRY_HISTORY: {
+            // backlog is streamed after the ack by TelemetrySender::poll()
+            if(_telemetry) {
+                _telemetry->requestHistory(command.history.channel, command.history.sinceMs);
+            }
+            return SUCCESS;
+        }
+        default: {
+            return COMMAND_PARSE_FAILURE;
         }
     }
+}
 
-    return {error, 0, RoverCommand()};
+/*
+** submit the command that was
+** send in the websocket channel
+*/
+SubmitCommandResult RoverCommandProcessor::submitCommand(
+    const char *commandParam,   // IN : A wrapped tank command link cmd(tank(...))
+    const int offset)           // IN : offset of cmd() wrapper in command buffer
+                                // RET: struct with status, command id and command
+                                //      where status == SUCCESS or
+                                //      status == -1 on bad command (null or empty)
+                                //      status == -2 on parse error
+                                //      status == -3 on enqueue error (queue or path is full)
+{
+    const SubmitCommandResult parsed = parseCommandText(commandParam, offset);
+    if(SUCCESS != parsed.status) {
+        return parsed;
+    }
+
+    const int status = executeCommand(parsed.command, commandParam + offset);
+    if(SUCCESS != status) {
+        return {status, 0, RoverCommand()};
+    }
+    return parsed;
 }
 
 /**
@@ -231,6 +417,17 @@ int RoverCommandProcessor::enqueueRoverCommand(
     TankCommand command)    // IN : speed/direction for both wheels
                             // RET: SUCCESS if command could be queued
                             //      FAILURE if buffer is full.
+{
+    return enqueueRoverCommand(RoverCommand(TANK, command));
+}
+
+/**
+ * Append a tank or twist command to the command queue.
+ */
+int RoverCommandProcessor::enqueueRoverCommand(
+    const RoverCommand &command)    // IN : TANK or TWIST command
+                                    // RET: SUCCESS if command could be queued
+                                    //      FAILURE if buffer is full.
 {
     //
     // insert new command at head of circular buffer
@@ -249,7 +446,7 @@ int RoverCommandProcessor::enqueueRoverCommand(
  * Get the next command from the command queue.
  */
 int RoverCommandProcessor::dequeueRoverCommand(
-    TankCommand *command)   // OUT: on SUCCESS, speed/direction for both wheels
+    RoverCommand *command)  // OUT: on SUCCESS, TANK or TWIST command
                             //      otherwise unchanged.
                             // RET: SUCCESS if buffer had a command to return 
                             //      FAILURE if buffer is empty.
@@ -269,17 +466,28 @@ int RoverCommandProcessor::dequeueRoverCommand(
  * Execute the given rover command
  */
 int RoverCommandProcessor::executeRoverCommand(
-    TankCommand &command)   // IN : speed/direction for both wheels
-                            // RET: SUCCESS if command executed
-                            //      FAILURE if command could not execute
+    const RoverCommand &command)    // IN : TANK or TWIST command
+                                    // RET: SUCCESS if command executed
+                                    //      FAILURE if command could not execute
 {
     if (!attached())
         return FAILURE;
 
-    _rover->roverLeftWheel(command.useSpeedControl, command.left.forward, command.left.value);
-    _rover->roverRightWheel(command.useSpeedControl, command.right.forward, command.right.value);
-
-    return SUCCESS;
+    switch(command.type) {
+        case TANK: {
+            const TankCommand& tank = command.tank;
+            _rover->roverLeftWheel(tank.useSpeedControl, tank.left.forward, tank.left.value);
+            _rover->roverRightWheel(tank.useSpeedControl, tank.right.forward, tank.right.value);
+            return SUCCESS;
+        }
+        case TWIST: {
+            _rover->setVelocity(command.twist.linear, command.twist.angular);
+            return SUCCESS;
+        }
+        default: {
+            return FAILURE;
+        }
+    }
 }
 
 /**
@@ -289,7 +497,7 @@ RoverCommandProcessor& RoverCommandProcessor::pollRoverCommand(
     unsigned long currentMillis)   // IN : milliseconds since startup
                                    // RET: this rover
 {
-    TankCommand command;
+    RoverCommand command;
     if (SUCCESS == dequeueRoverCommand(&command)) {
         executeRoverCommand(command);
     }
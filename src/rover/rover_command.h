@@ -3,6 +3,13 @@
 
 #include "./rover.h"
 #include "./goto_goal.h"
+#include "./path_follow.h"
+#include "./waypoint_recorder.h"
+#include "../telemetry_format.h"
+
+class TelemetrySender;
+class FlightRecorder;
+class PathPlanner;
 
 //
 // discriminate between commands
@@ -15,6 +22,17 @@ typedef enum {
     STALL,
     RESET_POSE,
     GOTO,
+    TELEMETRY_FORMAT,
+    TELEMETRY_RATE,
+    TELEMETRY_KEYFRAME,
+    TELEMETRY_HISTORY,
+    TWIST,
+    SYNC,
+    WAYPOINT,
+    PATH,
+    RECORD,
+    PLAY,
+    PLAN,
 } CommandType;
 
 extern const char *CommandNames[];
@@ -72,7 +90,33 @@ typedef struct TankCommand {
 } TankCommand;
 
 //
-// command to move rover to a given location
+// command to drive the rover at a linear 
+// velocity and turning rate
+//
+typedef struct TwistCommand {
+    TwistCommand(): linear(0), angular(0) {};
+    TwistCommand(speed_type l, speed_type a): linear(l), angular(a) {};
+
+    speed_type linear;     // cm/sec forward, negative for reverse
+    speed_type angular;    // radians/sec counter-clockwise, negative for clockwise
+} TwistCommand;
+
+//
+// command to set the gains of the controller
+// that keeps the wheels in step; zero gains
+// turn it off
+//
+typedef struct SyncCommand {
+    SyncCommand(): Kp(0), Ki(0) {};
+    SyncCommand(float p, float i): Kp(p), Ki(i) {};
+
+    float Kp;   // cm/sec of trim per cm of error
+    float Ki;   // cm/sec of trim per cm·sec of error
+} SyncCommand;
+
+//
+// command to move rover to a given location;
+// a plan command drives to it around obstacles
 //
 typedef struct GotoCommand {
     GotoCommand(): x(0), y(), tolerance(0), pointForward(0) {};
@@ -86,23 +130,142 @@ typedef struct GotoCommand {
     distance_type pointForward;
 } GotoCommand;
 
+//
+// command to add a waypoint to the path
+// that the next path command follows
+//
+typedef struct WaypointCommand {
+    WaypointCommand(): index(0), x(0), y(0) {};
+    WaypointCommand(unsigned int i, distance_type _x, distance_type _y): index(i), x(_x), y(_y) {};
+
+    unsigned int index; // index of waypoint in path; 0 starts a new path
+    distance_type x;
+    distance_type y;
+} WaypointCommand;
+
+//
+// command to follow the uploaded waypoints
+//
+typedef struct PathCommand {
+    PathCommand(): lookahead(0), tolerance(0) {};
+    PathCommand(distance_type l, distance_type t): lookahead(l), tolerance(t) {};
+
+    distance_type lookahead;    // cm along the path ahead of the rover to steer toward
+    distance_type tolerance;    // cm from last waypoint considered success
+} PathCommand;
+
+//
+// command to start or stop recording the driven path;
+// the recorded path is played with a PathCommand
+//
+typedef struct RecordCommand {
+    RecordCommand(): on(false) {};
+    RecordCommand(bool o): on(o) {};
+
+    bool on;    // true to start recording, false to stop
+} RecordCommand;
+
+//
+// command to select text or binary telemetry
+//
+typedef struct FormatCommand {
+    FormatCommand(): binary(false), delta(false) {};
+    FormatCommand(bool b, bool d): binary(b), delta(d) {};
+
+    bool binary;    // true for binary telemetry, false for text
+    bool delta;     // true to send changed wheel fields only
+} FormatCommand;
+
+//
+// command to turn a telemetry channel off or set it's rate
+//
+typedef struct TelemetryCommand {
+    TelemetryCommand(): channel(TELEMETRY_WHEEL), periodMs(TELEMETRY_PERIOD_ALL) {};
+    TelemetryCommand(TelemetryChannel c, unsigned int p): channel(c), periodMs(p) {};
+
+    TelemetryChannel channel;   // channel to change
+    unsigned int periodMs;      // 0 for off, 1 for all, otherwise ms between messages
+} TelemetryCommand;
+
+//
+// command to stream recorded telemetry
+//
+typedef struct HistoryCommand {
+    HistoryCommand(): channel(TELEMETRY_WHEEL), sinceMs(0) {};
+    HistoryCommand(TelemetryChannel c, unsigned long s): channel(c), sinceMs(s) {};
+
+    TelemetryChannel channel;   // channel to stream; wheel or pose
+    unsigned long sinceMs;      // stream samples newer than this time
+} HistoryCommand;
+
 typedef struct RoverCommand {
     RoverCommand(): type(NOOP), tank(TankCommand()) {};
     RoverCommand(CommandType t): type(t), tank(TankCommand()) {};
     RoverCommand(CommandType t, TankCommand c): type(t), tank(c) {};
+    RoverCommand(CommandType t, TwistCommand c): type(t), twist(c) {};
     RoverCommand(CommandType t, PidCommand c): type(t), pid(c) {};
     RoverCommand(CommandType t, StallCommand c): type(t), stall(c) {};
+    RoverCommand(CommandType t, SyncCommand c): type(t), sync(c) {};
     RoverCommand(CommandType t, GotoCommand c): type(t), go2(c) {};
+    RoverCommand(CommandType t, WaypointCommand c): type(t), waypoint(c) {};
+    RoverCommand(CommandType t, PathCommand c): type(t), path(c) {};
+    RoverCommand(CommandType t, RecordCommand c): type(t), record(c) {};
+    RoverCommand(CommandType t, FormatCommand c): type(t), format(c) {};
+    RoverCommand(CommandType t, TelemetryCommand c): type(t), telemetry(c) {};
+    RoverCommand(CommandType t, HistoryCommand c): type(t), history(c) {};
 
     CommandType type;    // if matched, the command number OR NOOP
     union  {
         TankCommand tank; 
+        TwistCommand twist;
         PidCommand pid;    
         StallCommand stall;
+        SyncCommand sync;
         GotoCommand go2;
+        WaypointCommand waypoint;
+        PathCommand path;
+        RecordCommand record;
+        FormatCommand format;
+        TelemetryCommand telemetry;
+        HistoryCommand history;
     };
 } RoverCommand;
 
+/**
+ * Determine if a command changes telemetry
+ * rather than the rover.  These are executed
+ * on the core that sends telemetry.
+ */
+inline bool isTelemetryCommand(CommandType type)    // IN : type of command
+                                                    // RET: true if command changes telemetry
+{
+    return (TELEMETRY_FORMAT == type) || (TELEMETRY_RATE == type) 
+        || (TELEMETRY_KEYFRAME == type) || (TELEMETRY_HISTORY == type);
+}
+
+//
+// parsed command along with it's text as received 
+// from the client, used to hand commands from the 
+// network core to the control core.
+//
+const unsigned int COMMAND_TEXT_BYTES = 128;
+typedef struct QueuedCommand {
+    RoverCommand command;           // parsed command
+    unsigned char clientNum;        // websocket client to ack once it is executed
+    char text[COMMAND_TEXT_BYTES];  // command text for the flight recorder
+} QueuedCommand;
+
+//
+// status of a queued command once the control core
+// has executed it, handed back to the network core
+// so the command can be acked or nacked.
+//
+typedef struct CommandAck {
+    unsigned char clientNum;        // websocket client that sent the command
+    int status;                     // SUCCESS or the error from executing it
+    char text[COMMAND_TEXT_BYTES];  // command text, sent back as the ack
+} CommandAck;
+
 typedef struct SubmitCommandResult {
     int status;
     int id;
@@ -120,12 +283,17 @@ typedef struct SubmitCommandResult {
 class RoverCommandProcessor {
     private:
     static const unsigned int COMMAND_BUFFER_SIZE = 4;
-    TankCommand _commandQueue[COMMAND_BUFFER_SIZE];     // circular queue of commands
+    RoverCommand _commandQueue[COMMAND_BUFFER_SIZE];    // circular queue of tank and twist commands
     uint8_t _commandHead = 0; // read from head
     uint8_t _commandTail = 0; // append to tail
 
     TwoWheelRover* _rover = nullptr;
     GotoGoalBehavior* _gotoGoalBehavior = nullptr;
+    PathFollowBehavior* _pathFollowBehavior = nullptr;
+    WaypointRecorder* _waypointRecorder = nullptr;
+    PathPlanner* _pathPlanner = nullptr;
+    TelemetrySender* _telemetry = nullptr;
+    FlightRecorder* _recorder = nullptr;
 
     public:
 
@@ -139,7 +307,9 @@ class RoverCommandProcessor {
      */
     RoverCommandProcessor& attach(
         TwoWheelRover &rover,               // IN : rover attached state
-        GotoGoalBehavior &gotoGoalBehavior);// IN : behavior in attached state
+        GotoGoalBehavior &gotoGoalBehavior, // IN : behavior in attached state
+        TelemetrySender *telemetry = nullptr);  // IN : telemetry sender or nullptr;
+                                                //      receives telemetry format commands
                                             // RET: this RoverCommandProcessor in attached state
 
     /**
@@ -147,6 +317,34 @@ class RoverCommandProcessor {
      */
     RoverCommandProcessor& detach(); // RET: this behavior in detached state
 
+    /**
+     * Set the flight recorder that receives submitted commands
+     */
+    RoverCommandProcessor& setRecorder(FlightRecorder *recorder);   // IN : recording flight recorder 
+                                                                    //      or nullptr to stop recording
+                                                                    // RET: this RoverCommandProcessor
+
+    /**
+     * Set the behavior that follows uploaded waypoints
+     */
+    RoverCommandProcessor& setPathFollowBehavior(PathFollowBehavior *pathFollowBehavior);   // IN : behavior in attached state
+                                                                                            //      or nullptr to ignore path commands
+                                                                                            // RET: this RoverCommandProcessor
+
+    /**
+     * Set the recorder that records and plays back driven paths
+     */
+    RoverCommandProcessor& setWaypointRecorder(WaypointRecorder *waypointRecorder); // IN : recorder in attached state
+                                                                                    //      or nullptr to ignore record and play commands
+                                                                                    // RET: this RoverCommandProcessor
+
+    /**
+     * Set the planner that plans and drives paths around obstacles
+     */
+    RoverCommandProcessor& setPathPlanner(PathPlanner *pathPlanner);    // IN : planner in attached state
+                                                                        //      or nullptr to ignore plan commands
+                                                                        // RET: this RoverCommandProcessor
+
     /**
      * Add a command, as string parameters, to the command queue
      */
@@ -161,6 +359,34 @@ class RoverCommandProcessor {
                                     // RET: 0 for SUCCESS, non-zero for error code
 
 
+    /**
+     * Parse a command without executing it.
+     * This does not touch the rover or telemetry,
+     * so it may be called on any core.
+     */
+    SubmitCommandResult parseCommandText(
+        const char *commandParam,   // IN : A wrapped command like cmd(tank(...))
+        const int offset);          // IN : offset of cmd() wrapper in command buffer
+                                    // RET: struct with status, command id and command
+                                    //      where status == SUCCESS or
+                                    //      status == -1 on bad command (null or empty)
+                                    //      status == -2 on parse error
+
+    /**
+     * Execute a parsed command.
+     * Telemetry commands change the telemetry sender
+     * so call this on the core that sends telemetry
+     * for those (see isTelemetryCommand()), and on
+     * the core that runs the rover for the others.
+     */
+    int executeCommand(
+        const RoverCommand &command,    // IN : parsed command
+        const char *commandText);       // IN : text of command for the flight recorder,
+                                        //      or nullptr
+                                        // RET: SUCCESS or
+                                        //      status == -2 on unknown command
+                                        //      status == -3 on enqueue error (queue or path is full)
+
     /*
     ** submit the tank command that was
     ** send in the websocket channel
@@ -172,7 +398,7 @@ class RoverCommandProcessor {
                                     //      where status == SUCCESS or
                                     //      status == -1 on bad command (null or empty)
                                     //      status == -2 on parse error
-                                    //      status == -3 on enqueue error (queue is full)
+                                    //      status == -3 on enqueue error (queue or path is full)
 
 
     /**
@@ -183,12 +409,20 @@ class RoverCommandProcessor {
                                 // RET: SUCCESS if command could be queued
                                 //      FAILURE if buffer is full.
 
+    /**
+     * Append a tank or twist command to the command queue.
+     */
+    int enqueueRoverCommand(
+        const RoverCommand &command);   // IN : TANK or TWIST command
+                                        // RET: SUCCESS if command could be queued
+                                        //      FAILURE if buffer is full.
+
 
     /**
      * Get the next command from the command queue.
      */
     int dequeueRoverCommand(
-        TankCommand *command);  // OUT: on SUCCESS, speed/direction for both wheels
+        RoverCommand *command); // OUT: on SUCCESS, TANK or TWIST command
                                 //      otherwise unchanged.
                                 // RET: SUCCESS if buffer had a command to return 
                                 //      FAILURE if buffer is empty.
@@ -198,9 +432,9 @@ class RoverCommandProcessor {
      * Execute the given rover command
      */
     int executeRoverCommand(
-        TankCommand &command);  // IN : speed/direction for both wheels
-                                // RET: SUCCESS if command executed
-                                //      FAILURE if command could not execute
+        const RoverCommand &command);   // IN : TANK or TWIST command
+                                        // RET: SUCCESS if command executed
+                                        //      FAILURE if command could not execute
 
     /**
      * Poll command queue
@@ -5,6 +5,27 @@
 #include "rover.h"
 #include "rover_parse.h"
 
+const char *CommandNames[] = {
+    "noop",
+    "halt",
+    "tank",
+    "pid",
+    "stall",
+    "resetPose",
+    "goto",
+    "format",
+    "telemetry",
+    "keyframe",
+    "history",
+    "twist",
+    "sync",
+    "waypoint",
+    "path",
+    "record",
+    "play",
+    "plan",
+};
+
 /**
  * Scan delimiter and whitespace around it
  */
@@ -227,6 +248,47 @@ ParseTankResult parseHaltCommand(
     return {false, offset, TankCommand()};
 }
 
+/*
+** Parse wheel synchronization command
+** in form "sync({Kp}, {Ki})"
+** where zero for both gains turns it off,
+** like "sync(0.5, 0)"
+*/
+ParseSyncResult parseSyncCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("sync("));
+    if(scan.matched) {
+        // proportional gain
+        ParseDecimalResult Kp = parseUnsignedFloat(command, scan.index);
+        if(Kp.matched) {
+            scan = scanFieldSeparator(command, Kp.index, ',');  // skip field separator
+            if(scan.matched) {
+                // integral gain
+                ParseDecimalResult Ki = parseUnsignedFloat(command, scan.index);
+                if(Ki.matched) {
+                    scan = scanEndCommand(command, Ki.index, ')');
+                    if(scan.matched) {
+                        return {true, scan.index, SyncCommand(Kp.value, Ki.value)};
+                    }
+                }
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, SyncCommand()};
+}
+
 /*
 ** Parse Goto location command
 ** in form "goto({x}, {y}, {tolerance})"
@@ -281,6 +343,440 @@ ParseGotoResult parseGotoCommand(
     return {false, offset, GotoCommand()};
 }
 
+/*
+** Parse waypoint command
+** in form "waypoint({index}, {x}, {y})"
+** like "waypoint(0, 48.0, 104.0)"
+*/
+ParseWaypointResult parseWaypointCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("waypoint("));
+    if(scan.matched) {
+        // index of waypoint in path
+        ParseIntegerResult index = parseUnsignedInt(command, scan.index);
+        if(index.matched) {
+            scan = scanFieldSeparator(command, index.index, ',');  // skip field separator
+            if(scan.matched) {
+                // x value
+                ParseDecimalResult x = parseFloat(command, scan.index);
+                if(x.matched) {
+                    scan = scanFieldSeparator(command, x.index, ',');  // skip field separator
+                    if(scan.matched) {
+                        // y value
+                        ParseDecimalResult y = parseFloat(command, scan.index);
+                        if(y.matched) {
+                            scan = scanEndCommand(command, y.index, ')');
+                            if(scan.matched) {
+                                return {true, scan.index, WaypointCommand(index.value, x.value, y.value)};
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, WaypointCommand()};
+}
+
+/*
+** Parse path command
+** in form "path({lookahead}, {tolerance})"
+** like "path(20.0, 5.0)"
+*/
+ParsePathResult parsePathCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("path("));
+    if(scan.matched) {
+        // lookahead distance
+        ParseDecimalResult lookahead = parseUnsignedFloat(command, scan.index);
+        if(lookahead.matched) {
+            scan = scanFieldSeparator(command, lookahead.index, ',');  // skip field separator
+            if(scan.matched) {
+                // tolerance (distance from last waypoint considered success)
+                ParseDecimalResult tolerance = parseUnsignedFloat(command, scan.index);
+                if(tolerance.matched) {
+                    scan = scanEndCommand(command, tolerance.index, ')');
+                    if(scan.matched) {
+                        return {true, scan.index, PathCommand(lookahead.value, tolerance.value)};
+                    }
+                }
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, PathCommand()};
+}
+
+/*
+** Parse record command
+** in form "record({true|false})"
+** like "record(true)"
+*/
+ParseRecordResult parseRecordCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("record("));
+    if(scan.matched) {
+        // true to start recording, false to stop
+        ParseBooleanResult on = parseBoolean(command, scan.index);
+        if(on.matched) {
+            scan = scanEndCommand(command, on.index, ')');
+            if(scan.matched) {
+                return {true, scan.index, RecordCommand(on.value)};
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, RecordCommand()};
+}
+
+/*
+** Parse play command
+** in form "play({lookahead}, {tolerance})"
+** like "play(20.0, 5.0)"
+*/
+ParsePathResult parsePlayCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("play("));
+    if(scan.matched) {
+        // lookahead distance
+        ParseDecimalResult lookahead = parseUnsignedFloat(command, scan.index);
+        if(lookahead.matched) {
+            scan = scanFieldSeparator(command, lookahead.index, ',');  // skip field separator
+            if(scan.matched) {
+                // tolerance (distance from last waypoint considered success)
+                ParseDecimalResult tolerance = parseUnsignedFloat(command, scan.index);
+                if(tolerance.matched) {
+                    scan = scanEndCommand(command, tolerance.index, ')');
+                    if(scan.matched) {
+                        return {true, scan.index, PathCommand(lookahead.value, tolerance.value)};
+                    }
+                }
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, PathCommand()};
+}
+
+/*
+** Parse plan command
+** in form "plan({x}, {y}, {tolerance}, {pointForward})"
+** like "plan(48.0, 104.0, 0.1, 0.75)"
+*/
+ParseGotoResult parsePlanCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("plan("));
+    if(scan.matched) {
+        // x value
+        ParseDecimalResult x = parseFloat(command, scan.index);
+        if(x.matched) {
+            scan = scanFieldSeparator(command, x.index, ',');  // skip field separator
+            if(scan.matched) {
+                // y value
+                ParseDecimalResult y = parseFloat(command, scan.index);
+                if(y.matched) {
+                    scan = scanFieldSeparator(command, y.index, ',');  // skip field separator
+                    if(scan.matched) {
+                        // tolerance of each goal along the planned path
+                        ParseDecimalResult tolerance = parseUnsignedFloat(command, scan.index);
+                        if(tolerance.matched) {
+                            scan = scanFieldSeparator(command, tolerance.index, ',');  // skip field separator
+                            if(scan.matched){
+                                // point-forward
+                                ParseDecimalResult pointForward = parseUnsignedFloat(command, scan.index);
+                                if(pointForward.matched) {
+                                    scan = scanEndCommand(command, pointForward.index, ')');
+                                    if(scan.matched) {
+                                        return {true, scan.index, GotoCommand(x.value, y.value, tolerance.value, pointForward.value)};
+                                    }
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, GotoCommand()};
+}
+
+/*
+** Parse velocity command
+** in form "twist({linear}, {angular})"
+** where linear is cm/sec forward (negative for reverse)
+** and angular is radians/sec counter-clockwise 
+** (negative for clockwise),
+** like "twist(20.0, -0.5)"
+*/
+ParseTwistResult parseTwistCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("twist("));
+    if(scan.matched) {
+        // linear velocity
+        ParseDecimalResult linear = parseFloat(command, scan.index);
+        if(linear.matched) {
+            scan = scanFieldSeparator(command, linear.index, ',');  // skip field separator
+            if(scan.matched) {
+                // angular velocity
+                ParseDecimalResult angular = parseFloat(command, scan.index);
+                if(angular.matched) {
+                    scan = scanEndCommand(command, angular.index, ')');
+                    if(scan.matched) {
+                        return {true, scan.index, TwistCommand(linear.value, angular.value)};
+                    }
+                }
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, TwistCommand()};
+}
+
+/*
+** Parse telemetry format command
+** in form "format({binary|text})" or "format({binary|text}, delta)"
+** like "format(binary, delta)"
+*/
+ParseFormatResult parseFormatCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("format("));
+    if(scan.matched) {
+        scan = scanChars(command, scan.index, ' '); // skip whitespace
+        bool binary = true;
+        ScanResult format = scanString(command, scan.index, String("binary"));
+        if(!format.matched) {
+            binary = false;
+            format = scanString(command, scan.index, String("text"));
+        }
+        if(format.matched) {
+            // optional delta encoding
+            bool delta = false;
+            scan = scanFieldSeparator(command, format.index, ',');
+            if(scan.matched) {
+                scan = scanString(command, scan.index, String("delta"));
+                if(!scan.matched) {
+                    return {false, offset, FormatCommand()};
+                }
+                delta = true;
+            } else {
+                scan = format;
+            }
+
+            scan = scanEndCommand(command, scan.index, ')');
+            if(scan.matched) {
+                return {true, scan.index, FormatCommand(binary, delta)};
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, FormatCommand()};
+}
+
+/*
+** Parse keyframe request command
+** in form "keyframe({channel})"
+** like "keyframe(wheel)"
+*/
+ParseTelemetryResult parseKeyframeCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("keyframe("));
+    if(scan.matched) {
+        scan = scanChars(command, scan.index, ' '); // skip whitespace
+        for(int channel = 0; channel < NUMBER_OF_TELEMETRY_CHANNELS; channel += 1) {
+            ScanResult name = scanString(command, scan.index, String(TelemetryChannelNames[channel]));
+            if(name.matched) {
+                scan = scanEndCommand(command, name.index, ')');
+                if(scan.matched) {
+                    return {true, scan.index, TelemetryCommand((TelemetryChannel)channel, 0)};
+                }
+                break;
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, TelemetryCommand()};
+}
+
+/*
+** Parse telemetry rate command
+** in form "telemetry({channel}, {periodMs})"
+** where channel is wheel, pose, goto, set or log
+** and periodMs is 0 for off, 1 for all
+** or the minimum milliseconds between messages,
+** like "telemetry(pose, 100)"
+*/
+ParseTelemetryResult parseTelemetryCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    //
+    // scan command open
+    //
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("telemetry("));
+    if(scan.matched) {
+        scan = scanChars(command, scan.index, ' '); // skip whitespace
+
+        // channel name
+        for(int channel = 0; channel < NUMBER_OF_TELEMETRY_CHANNELS; channel += 1) {
+            ScanResult name = scanString(command, scan.index, String(TelemetryChannelNames[channel]));
+            if(name.matched) {
+                scan = scanFieldSeparator(command, name.index, ',');  // skip field separator
+                if(scan.matched) {
+                    // period in milliseconds
+                    ParseIntegerResult periodMs = parseUnsignedInt(command, scan.index);
+                    if(periodMs.matched) {
+                        scan = scanEndCommand(command, periodMs.index, ')');
+                        if(scan.matched) {
+                            return {true, scan.index, TelemetryCommand((TelemetryChannel)channel, periodMs.value)};
+                        }
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, TelemetryCommand()};
+}
+
+/*
+** Parse telemetry history command
+** in form "history({sinceMs}, {channel})"
+** where sinceMs is a rover time in milliseconds
+** and channel is wheel or pose,
+** like "history(123456, pose)"
+*/
+ParseHistoryResult parseHistoryCommand(
+    String command,     // IN : the string to scan
+    const int offset)   // IN : the index into the string to start scanning
+                        // RET: scan result 
+                        //      matched is true if completely matched, false otherwise
+                        //      if matched, offset is index of character after matched span, 
+                        //      otherwise return the offset argument unchanged.
+{
+    ScanResult scan = scanChars(command, offset, ' '); // skip whitespace
+    scan = scanString(command, scan.index, String("history("));
+    if(scan.matched) {
+        scan = scanChars(command, scan.index, ' '); // skip whitespace
+
+        // time in milliseconds; rover time does not fit in an int after about 25 days
+        ParseUnsignedLongResult sinceMs = parseUnsignedLong(command, scan.index);
+        if(sinceMs.matched) {
+            scan = scanFieldSeparator(command, sinceMs.index, ',');  // skip field separator
+            if(scan.matched) {
+                // channel name; only wheel and pose samples are recorded
+                const TelemetryChannel channels[] = {TELEMETRY_WHEEL, TELEMETRY_POSE};
+                for(const TelemetryChannel channel : channels) {
+                    ScanResult name = scanString(command, scan.index, String(TelemetryChannelNames[channel]));
+                    if(name.matched) {
+                        scan = scanEndCommand(command, name.index, ')');
+                        if(scan.matched) {
+                            return {true, scan.index, HistoryCommand(channel, sinceMs.value)};
+                        }
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // did not parse
+    return {false, offset, HistoryCommand()};
+}
+
 ParseNoArgCommandResult parseNoArgCommand(
     String command,     // IN : the string to scan
     const int offset,   // IN : the index into the string to start scanning
@@ -356,6 +852,19 @@ ParseCommandResult parseCommand(
                     }
                 } 
 
+                //
+                // linear and angular velocity command
+                //
+                ParseTwistResult twist = parseTwistCommand(command, scan.index);
+                if(twist.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, twist.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(TWIST, twist.value)};
+                    }
+                }
+
                 //
                 // halt is a special version of tank command that stops motors
                 //
@@ -382,6 +891,19 @@ ParseCommandResult parseCommand(
                     }
                 }
 
+                //
+                // set wheel synchronization gains
+                //
+                ParseSyncResult sync = parseSyncCommand(command, scan.index);
+                if(sync.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, sync.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(SYNC, sync.value)};
+                    }
+                }
+
                 //
                 // goto (x, y) location
                 //
@@ -395,6 +917,123 @@ ParseCommandResult parseCommand(
                     }
                 }
 
+                //
+                // add a waypoint to the path
+                //
+                ParseWaypointResult waypoint = parseWaypointCommand(command, scan.index);
+                if(waypoint.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, waypoint.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(WAYPOINT, waypoint.value)};
+                    }
+                }
+
+                //
+                // follow the waypoints
+                //
+                ParsePathResult path = parsePathCommand(command, scan.index);
+                if(path.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, path.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(PATH, path.value)};
+                    }
+                }
+
+                //
+                // start or stop recording the driven path
+                //
+                ParseRecordResult record = parseRecordCommand(command, scan.index);
+                if(record.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, record.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(RECORD, record.value)};
+                    }
+                }
+
+                //
+                // follow the recorded path
+                //
+                ParsePathResult play = parsePlayCommand(command, scan.index);
+                if(play.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, play.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(PLAY, play.value)};
+                    }
+                }
+
+                //
+                // plan a path to (x, y) and drive it
+                //
+                ParseGotoResult plan = parsePlanCommand(command, scan.index);
+                if(plan.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, plan.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(PLAN, plan.value)};
+                    }
+                }
+
+                //
+                // select text or binary telemetry
+                //
+                ParseFormatResult format = parseFormatCommand(command, scan.index);
+                if(format.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, format.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(TELEMETRY_FORMAT, format.value)};
+                    }
+                }
+
+                //
+                // turn a telemetry channel off or set it's rate
+                //
+                ParseTelemetryResult telemetry = parseTelemetryCommand(command, scan.index);
+                if(telemetry.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, telemetry.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(TELEMETRY_RATE, telemetry.value)};
+                    }
+                }
+
+                //
+                // ask for all fields in next telemetry on channel
+                //
+                ParseTelemetryResult keyframe = parseKeyframeCommand(command, scan.index);
+                if(keyframe.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, keyframe.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(TELEMETRY_KEYFRAME, keyframe.value)};
+                    }
+                }
+
+                //
+                // stream recorded telemetry since a time
+                //
+                ParseHistoryResult history = parseHistoryCommand(command, scan.index);
+                if(history.matched) {
+                    // Scan command close
+                    ScanResult scan = scanEndCommand(command, history.index, ')'); // skip whitespace
+                    if(scan.matched) {
+                        LOGFMT("command parsed: \"%s\"", cstr(command.substr(offset, scan.index - offset)));
+                        return {true, scan.index, id.value, RoverCommand(TELEMETRY_HISTORY, history.value)};
+                    }
+                }
+
                 //
                 // reset pose command - reset pose back to origin
                 //
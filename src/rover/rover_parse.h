@@ -36,6 +36,13 @@ typedef struct ParseStallResult {
     StallCommand value;   // if matched, the stall command, else {0,0}
 } ParseStallResult;
 
+typedef struct ParseSyncResult {
+    bool matched;       // true if fully matched, false if not
+    int index;          // if matched, index of first char after matched span,
+                        // otherwise index of start of scan
+    SyncCommand value;  // if matched, the sync command, else {0, 0}
+} ParseSyncResult;
+
 typedef struct ParseGotoResult {
     bool matched;       // true if fully matched, false if not
     int index;          // if matched, index of first char after matched span,
@@ -43,6 +50,55 @@ typedef struct ParseGotoResult {
     GotoCommand value;   // if matched, the stall command, else {0,0}
 } ParseGotoResult;
 
+typedef struct ParseWaypointResult {
+    bool matched;       // true if fully matched, false if not
+    int index;          // if matched, index of first char after matched span,
+                        // otherwise index of start of scan
+    WaypointCommand value;  // if matched, the waypoint command, else {0, 0, 0}
+} ParseWaypointResult;
+
+typedef struct ParsePathResult {
+    bool matched;       // true if fully matched, false if not
+    int index;          // if matched, index of first char after matched span,
+                        // otherwise index of start of scan
+    PathCommand value;  // if matched, the path command, else {0, 0}
+} ParsePathResult;
+
+typedef struct ParseRecordResult {
+    bool matched;       // true if fully matched, false if not
+    int index;          // if matched, index of first char after matched span,
+                        // otherwise index of start of scan
+    RecordCommand value;    // if matched, the record command, else {false}
+} ParseRecordResult;
+
+typedef struct ParseTwistResult {
+    bool matched;       // true if fully matched, false if not
+    int index;          // if matched, index of first char after matched span,
+                        // otherwise index of start of scan
+    TwistCommand value; // if matched, the twist command, else {0, 0}
+} ParseTwistResult;
+
+typedef struct ParseFormatResult {
+    bool matched;       // true if fully matched, false if not
+    int index;          // if matched, index of first char after matched span,
+                        // otherwise index of start of scan
+    FormatCommand value;    // if matched, the format command, else {false}
+} ParseFormatResult;
+
+typedef struct ParseTelemetryResult {
+    bool matched;       // true if fully matched, false if not
+    int index;          // if matched, index of first char after matched span,
+                        // otherwise index of start of scan
+    TelemetryCommand value; // if matched, the telemetry command, else {TELEMETRY_WHEEL, TELEMETRY_PERIOD_ALL}
+} ParseTelemetryResult;
+
+typedef struct ParseHistoryResult {
+    bool matched;       // true if fully matched, false if not
+    int index;          // if matched, index of first char after matched span,
+                        // otherwise index of start of scan
+    HistoryCommand value;   // if matched, the history command, else {TELEMETRY_WHEEL, 0}
+} ParseHistoryResult;
+
 typedef struct ParseCommandResult {
     bool matched;       // true if fully matched, false if not
     int index;          // if matched, index of first char after matched span,
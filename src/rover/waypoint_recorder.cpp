@@ -0,0 +1,438 @@
+#include "./waypoint_recorder.h"
+
+//
+// most distance between recorded waypoints, so
+// the delta between them fits in a WaypointDelta
+//
+const distance_type WAYPOINT_MAX_SPAN = (distance_type)(INT16_MAX - 1) / WaypointFixed::ONE;
+
+/**
+ * Distance from a point to a line segment
+ */
+static distance_type distanceToSegment(
+    const Point2D &point,   // IN : point to measure
+    const Point2D &start,   // IN : start of segment
+    const Point2D &end)     // IN : end of segment
+                            // RET: distance from point to nearest point on segment
+{
+    const distance_type sx = end.x - start.x;
+    const distance_type sy = end.y - start.y;
+    const distance_type px = point.x - start.x;
+    const distance_type py = point.y - start.y;
+    const distance_type length = HYPOT(sx, sy);
+    if(0 == length) {
+        return HYPOT(px, py);
+    }
+
+    // project onto the segment by it's direction rather than
+    // dividing by it's length squared, which overflows fixed point
+    const distance_type ux = sx / length;
+    const distance_type uy = sy / length;
+    const distance_type along = bound<distance_type>(px * ux + py * uy, 0, length);
+    return HYPOT(px - along * ux, py - along * uy);
+}
+
+/**
+ * Forget the path and start a new one
+ */
+PathSimplifier& PathSimplifier::reset()    // RET: this simplifier
+{
+    _count = 0;
+    _started = false;
+    return *this;
+}
+
+/**
+ * Add the next point on the path
+ */
+bool PathSimplifier::add(
+    const Point2D &point,       // IN : next point on the path
+    distance_type tolerance,    // IN : most a dropped point may be from the simplified path
+    distance_type maxSpan,      // IN : most distance between kept points
+    Point2D &kept)              // OUT: on true, the point to keep
+                                // RET: true if a point should be kept,
+                                //      false if not
+{
+    // the first point is always kept
+    if(!_started) {
+        _started = true;
+        _anchor = point;
+        _count = 0;
+        kept = point;
+        return true;
+    }
+
+    //
+    // open the window to the new point if every
+    // point in it is close to the line to the new point
+    //
+    const distance_type dx = point.x - _anchor.x;
+    const distance_type dy = point.y - _anchor.y;
+    bool fits = (HYPOT(dx, dy) <= maxSpan);
+    for(unsigned int i = 0; fits && (i < _count); i += 1) {
+        fits = distanceToSegment(_window[i], _anchor, point) <= tolerance;
+    }
+    if(fits) {
+        //
+        // when the window fills, drop every other point
+        // in it, so a long straight run stays one segment.
+        // dropped points lay between points that are still
+        // checked, so on a smooth path they stay close.
+        //
+        if(_count >= WAYPOINT_WINDOW_COUNT) {
+            for(unsigned int i = 1; i < _count; i += 2) {
+                _window[i / 2] = _window[i];
+            }
+            _count /= 2;
+        }
+        _window[_count] = point;
+        _count += 1;
+        return false;
+    }
+
+    //
+    // otherwise keep the point before the new one
+    // and start a new window from there.
+    //
+    kept = (_count > 0) ? _window[_count - 1] : point;
+    _anchor = kept;
+    _count = 0;
+    if((kept.x != point.x) || (kept.y != point.y)) {
+        _window[0] = point;
+        _count = 1;
+    }
+    return true;
+}
+
+/**
+ * Finish the path
+ */
+bool PathSimplifier::flush(Point2D &kept)  // OUT: on true, the last point on the path
+                                           // RET: true if there is a point to keep
+                                           //      false if not
+{
+    if(_count > 0) {
+        kept = _window[_count - 1];
+        _anchor = kept;
+        _count = 0;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Deteremine if dependencies are attached
+ */
+bool WaypointRecorder::attached() // RET: true if attached, false if not
+{
+    return (NULL != _rover) && (NULL != _messageBus);
+}
+
+/**
+ * Attach dependencies
+ */
+WaypointRecorder& WaypointRecorder::attach(
+    TwoWheelRover& rover,   // IN : rover whose path is recorded
+    MessageBus& messageBus) // IN : MessageBus to subscribe rover pose updates
+                            // RET: this recorder in attached state
+{
+    if(!attached()) {
+        _rover = &rover;
+        _messageBus = &messageBus;
+    }
+
+    return *this;
+}
+
+/**
+ * Detach dependencies
+ */
+WaypointRecorder& WaypointRecorder::detach() // RET: this recorder in detached state
+{
+    if(attached()) {
+        if(_recording) {
+            stopRecording();
+        }
+        _follower = nullptr;
+        _rover = nullptr;
+        _messageBus = nullptr;
+    }
+
+    return *this;
+}
+
+/**
+ * Forget the recorded path and start
+ * recording the rover's pose.
+ */
+WaypointRecorder& WaypointRecorder::startRecording() // RET: this recorder
+{
+    if(attached() && !_recording) {
+        _follower = nullptr;
+        _count = 0;
+        _tolerance = WAYPOINT_TOLERANCE;
+        _simplifier.reset();
+        _recording = true;
+
+        // start from where the rover is now
+        const Pose2D pose = _rover->pose();
+        record(pose.x, pose.y);
+
+        _messageBus->subscribe(*this, ROVER_POSE);
+    }
+    return *this;
+}
+
+/**
+ * Stop recording, keeping the
+ * last pose as the last waypoint.
+ */
+WaypointRecorder& WaypointRecorder::stopRecording()  // RET: this recorder
+{
+    if(_recording) {
+        if(attached()) {
+            _messageBus->unsubscribe(*this, ROVER_POSE);
+        }
+        Point2D kept;
+        if(_simplifier.flush(kept)) {
+            _store(kept);
+        }
+        _recording = false;
+    }
+    return *this;
+}
+
+/**
+ * Record a position on the path.
+ * This is called for each ROVER_POSE
+ * message while recording.
+ */
+WaypointRecorder& WaypointRecorder::record(
+    distance_type x,    // IN : horizontal position in world coordinates
+    distance_type y)    // IN : vertical position in world coordinates
+                        // RET: this recorder
+{
+    if(!_recording) {
+        return *this;
+    }
+
+    // ignore poses that have barely moved, like when stopped
+    const Point2D point = {x, y};
+    if(_simplifier.started()) {
+        const Point2D last = _simplifier.last();
+        if(pointInCircle<distance_type>(x, y, last.x, last.y, WAYPOINT_MIN_SPACING)) {
+            return *this;
+        }
+    }
+
+    Point2D kept;
+    if(_simplifier.add(point, _tolerance, WAYPOINT_MAX_SPAN, kept)) {
+        _store(kept);
+    }
+    return *this;
+}
+
+/**
+ * Handle a subscribed message from a publisher
+ */
+void WaypointRecorder::onMessage(
+    Publisher &publisher,       // IN : publisher of message
+    Message message,            // IN : message that was published
+    Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+    const char *)               // IN : message data as a c-cstring
+{
+    switch (message)
+    {
+        case ROVER_POSE: {
+            assert(&publisher == _rover);
+            assert(specifier == ROVER_SPEC);
+            const Pose2D pose = _rover->pose();
+            record(pose.x, pose.y);
+            break;
+        }
+        default: {
+            // NOOP
+            break;
+        }
+    }
+}
+
+/**
+ * Get the recorded waypoints.
+ * Waypoints are delta encoded, so they
+ * are decoded from the first up to count.
+ */
+unsigned int WaypointRecorder::waypoints(
+    Point2D *points,        // OUT: recorded waypoints
+    unsigned int count)     // IN : most waypoints to get
+                            // RET: number of waypoints in points
+{
+    WaypointFixed x = 0;
+    WaypointFixed y = 0;
+    unsigned int i = 0;
+    for(; (i < count) && (i < _count); i += 1) {
+        points[i] = _decode(i, x, y);
+    }
+    return i;
+}
+
+/**
+ * Follow the recorded path from the rover's current pose.
+ */
+WaypointRecorder& WaypointRecorder::play(
+    PathFollowBehavior &follower,   // IN : behavior in attached state
+    distance_type lookahead,        // IN : cm along the path ahead of the rover to steer toward
+    distance_type tolerance)        // IN : cm from last waypoint considered success
+                                    // RET: this recorder
+{
+    if(_recording) {
+        stopRecording();
+    }
+    _follower = nullptr;
+    if((0 == _count) || !follower.attached()) {
+        return *this;
+    }
+
+    //
+    // upload as much of the path as the follower
+    // holds, then stream the rest as it is driven.
+    //
+    for(_playIndex = 0; (_playIndex < _count) && (_playIndex < PATH_MAX_WAYPOINTS); _playIndex += 1) {
+        const Point2D point = _decode(_playIndex, _playX, _playY);
+        follower.addWaypoint(_playIndex, point.x, point.y);
+    }
+    follower.followPath(lookahead, tolerance);
+    _follower = &follower;
+    return _stream();
+}
+
+/**
+ * Poll from the control loop; while
+ * playing this streams waypoints to the
+ * follower as it makes room for them.
+ */
+WaypointRecorder& WaypointRecorder::poll(unsigned long)   // IN : current time in milliseconds
+                                                          // RET: this recorder
+{
+    return _stream();
+}
+
+/**
+ * Send waypoints to the follower while it has room
+ */
+WaypointRecorder& WaypointRecorder::_stream()    // RET: this recorder
+{
+    if(nullptr == _follower) {
+        return *this;
+    }
+
+    // stop playing if the follower finished or was cancelled
+    const GotoGoalState state = _follower->state();
+    if((STARTING != state) && (RUNNING != state)) {
+        _follower = nullptr;
+        return *this;
+    }
+
+    while(_playIndex < _count) {
+        WaypointFixed x = _playX;
+        WaypointFixed y = _playY;
+        const Point2D point = _decode(_playIndex, x, y);
+        if(SUCCESS != _follower->appendWaypoint(point.x, point.y)) {
+            break;  // full; try again when the rover has passed a waypoint
+        }
+        _playX = x;
+        _playY = y;
+        _playIndex += 1;
+    }
+    if(_playIndex >= _count) {
+        _follower = nullptr;    // the follower has the rest of the path
+    }
+    return *this;
+}
+
+/**
+ * Step from one recorded waypoint to the next
+ */
+Point2D WaypointRecorder::_decode(
+    unsigned int index, // IN : index of waypoint
+    WaypointFixed &x,   // IN : horizontal position of waypoint index - 1, unless index is 0
+                        // OUT: horizontal position of waypoint index
+    WaypointFixed &y)   // IN : vertical position of waypoint index - 1, unless index is 0
+                        // OUT: vertical position of waypoint index
+                        // RET: position of waypoint index
+{
+    if(0 == index) {
+        x = _firstX;
+        y = _firstY;
+    } else {
+        const WaypointDelta &delta = _deltas[index - 1];
+        x = WaypointFixed::fromRaw(x.raw() + delta.x);
+        y = WaypointFixed::fromRaw(y.raw() + delta.y);
+    }
+    return {(distance_type)x, (distance_type)y};
+}
+
+/**
+ * Store a waypoint, simplifying the ones
+ * already stored if storage is full.
+ */
+WaypointRecorder& WaypointRecorder::_store(const Point2D &point) // IN : waypoint to append
+                                                                 // RET: this recorder
+{
+    const WaypointFixed x(point.x);
+    const WaypointFixed y(point.y);
+    if(0 == _count) {
+        _firstX = _lastX = x;
+        _firstY = _lastY = y;
+        _count = 1;
+        return *this;
+    }
+
+    while(_count >= WAYPOINT_RECORDER_COUNT) {
+        _resimplify();
+    }
+
+    //
+    // the simplifier keeps waypoints within WAYPOINT_MAX_SPAN,
+    // so the delta fits; bound it anyway and step by what
+    // was stored, so decoding always agrees with _lastX, _lastY.
+    //
+    const int16_t dx = (int16_t)bound<int32_t>(x.raw() - _lastX.raw(), -INT16_MAX, INT16_MAX);
+    const int16_t dy = (int16_t)bound<int32_t>(y.raw() - _lastY.raw(), -INT16_MAX, INT16_MAX);
+    _deltas[_count - 1] = {dx, dy};
+    _lastX = WaypointFixed::fromRaw(_lastX.raw() + dx);
+    _lastY = WaypointFixed::fromRaw(_lastY.raw() + dy);
+    _count += 1;
+    return *this;
+}
+
+/**
+ * Double the tolerance and simplify the stored
+ * waypoints again, to make room for more.
+ */
+WaypointRecorder& WaypointRecorder::_resimplify()    // RET: this recorder
+{
+    _tolerance *= 2;
+
+    //
+    // rewrite the waypoints in place; a waypoint is only
+    // written after it's delta is read, because the write
+    // index never gets ahead of the read index.
+    //
+    const unsigned int count = _count;
+    WaypointFixed readX = 0;
+    WaypointFixed readY = 0;
+    _count = 0;
+    _resimplifier.reset();
+    Point2D kept;
+    for(unsigned int i = 0; i < count; i += 1) {
+        const Point2D point = _decode(i, readX, readY);
+        if(_resimplifier.add(point, _tolerance, WAYPOINT_MAX_SPAN, kept)) {
+            _store(kept);
+        }
+    }
+    if(_resimplifier.flush(kept)) {
+        _store(kept);
+    }
+    return *this;
+}
@@ -0,0 +1,264 @@
+#ifndef WAYPOINT_RECORDER_H
+#define WAYPOINT_RECORDER_H
+
+#include <stdint.h>
+
+#include "../config.h"
+#include "../rover/rover.h"
+#include "../rover/path_follow.h"
+#include "../message_bus/message_bus.h"
+#include "../rover/pose.h"
+#include "../util/fixed_point.h"
+
+//
+// waypoints are kept in 1/8 cm fixed point
+//
+typedef Fixed<3> WaypointFixed;
+
+//
+// change in position from the previous recorded waypoint,
+// as raw WaypointFixed values, so a waypoint takes 4 bytes
+// and one waypoint can be up to 40 meters from the last.
+//
+typedef struct WaypointDelta {
+    int16_t x;
+    int16_t y;
+} WaypointDelta;
+
+/**
+ * Online simplification of a path as it is sampled.
+ *
+ * This is the 'opening window' form of Douglas-Peucker;
+ * the line from the last kept point (the anchor) to the
+ * newest point is tested against every point sampled
+ * since the anchor.  While they are all within tolerance
+ * of it the window opens to the next point; when one
+ * is not, the point before the newest is kept and
+ * becomes the new anchor.  A point is also kept when
+ * the newest point is further from the anchor than maxSpan.
+ * The window is bounded; when it fills up every other point
+ * in it is dropped, so it covers the run since the anchor
+ * more sparsely.
+ */
+class PathSimplifier {
+    private:
+    Point2D _anchor = {0, 0};                   // last kept point
+    Point2D _window[WAYPOINT_WINDOW_COUNT];     // points sampled since the anchor
+    unsigned int _count = 0;                    // number of points in window
+    bool _started = false;                      // true once there is an anchor
+
+    public:
+
+    /**
+     * Forget the path and start a new one
+     */
+    PathSimplifier& reset();    // RET: this simplifier
+
+    /**
+     * Add the next point on the path
+     */
+    bool add(
+        const Point2D &point,       // IN : next point on the path
+        distance_type tolerance,    // IN : most a dropped point may be from the simplified path
+        distance_type maxSpan,      // IN : most distance between kept points
+        Point2D &kept);             // OUT: on true, the point to keep
+                                    // RET: true if a point should be kept,
+                                    //      false if not
+
+    /**
+     * Finish the path
+     */
+    bool flush(Point2D &kept);  // OUT: on true, the last point on the path
+                                // RET: true if there is a point to keep
+                                //      false if not
+
+    /**
+     * Get the last point added
+     */
+    Point2D last() {    // RET: most recent point
+        return (_count > 0) ? _window[_count - 1] : _anchor;
+    }
+
+    bool started() {    // RET: true if a point has been added since reset()
+        return _started;
+    }
+};
+
+/**
+ * Record the path the rover drives as a compact
+ * list of waypoints, and play it back.
+ *
+ * While recording, the pose from each ROVER_POSE
+ * message is simplified by a PathSimplifier, so only
+ * the waypoints needed to stay within tolerance of the
+ * driven path are kept; a straight run is one waypoint,
+ * a curve a few.  They are stored as the first waypoint
+ * followed by WaypointDeltas from each to the next.
+ * When the storage fills up the tolerance is doubled and
+ * the stored waypoints are simplified again, in place,
+ * so a drive of any length fits, more coarsely the
+ * longer it is.
+ *
+ * Playback follows the recorded path with a
+ * PathFollowBehavior, streaming it the recorded
+ * waypoints as it passes earlier ones, so the rover
+ * drives the whole path without stopping.
+ */
+class WaypointRecorder : public Subscriber {
+    private:
+    // attached dependencies
+    TwoWheelRover* _rover = nullptr;
+    MessageBus *_messageBus = nullptr;
+
+    bool _recording = false;
+    distance_type _tolerance = WAYPOINT_TOLERANCE;
+    PathSimplifier _simplifier;         // simplifies poses as they are recorded
+    PathSimplifier _resimplifier;       // simplifies stored waypoints when storage fills
+
+    WaypointFixed _firstX = 0;          // first waypoint
+    WaypointFixed _firstY = 0;
+    WaypointFixed _lastX = 0;           // last waypoint, where the next delta starts
+    WaypointFixed _lastY = 0;
+    WaypointDelta _deltas[WAYPOINT_RECORDER_COUNT - 1];   // change from each waypoint to the next
+    unsigned int _count = 0;            // number of waypoints recorded
+
+    // playback
+    PathFollowBehavior* _follower = nullptr;
+    unsigned int _playIndex = 0;        // next waypoint to send to follower
+    WaypointFixed _playX = 0;           // position of waypoint _playIndex - 1
+    WaypointFixed _playY = 0;
+
+    /**
+     * Step from one recorded waypoint to the next
+     */
+    Point2D _decode(
+        unsigned int index, // IN : index of waypoint
+        WaypointFixed &x,   // IN : horizontal position of waypoint index - 1, unless index is 0
+                            // OUT: horizontal position of waypoint index
+        WaypointFixed &y);  // IN : vertical position of waypoint index - 1, unless index is 0
+                            // OUT: vertical position of waypoint index
+                            // RET: position of waypoint index
+
+    /**
+     * Store a waypoint, simplifying the ones
+     * already stored if storage is full.
+     */
+    WaypointRecorder& _store(const Point2D &point); // IN : waypoint to append
+                                                    // RET: this recorder
+
+    /**
+     * Double the tolerance and simplify the stored
+     * waypoints again, to make room for more.
+     */
+    WaypointRecorder& _resimplify();    // RET: this recorder
+
+    /**
+     * Send waypoints to the follower while it has room
+     */
+    WaypointRecorder& _stream();    // RET: this recorder
+
+    public:
+
+    WaypointRecorder()
+        : Subscriber()
+    {
+    }
+
+    ~WaypointRecorder() {
+        detach();
+    }
+
+    /**
+     * Deteremine if dependencies are attached
+     */
+    bool attached(); // RET: true if attached, false if not
+
+    /**
+     * Attach dependencies
+     */
+    WaypointRecorder& attach(
+        TwoWheelRover& rover,   // IN : rover whose path is recorded
+        MessageBus& messageBus);// IN : MessageBus to subscribe rover pose updates
+                                // RET: this recorder in attached state
+
+    /**
+     * Detach dependencies
+     */
+    WaypointRecorder& detach(); // RET: this recorder in detached state
+
+    /**
+     * Forget the recorded path and start
+     * recording the rover's pose.
+     */
+    WaypointRecorder& startRecording(); // RET: this recorder
+
+    /**
+     * Stop recording, keeping the
+     * last pose as the last waypoint.
+     */
+    WaypointRecorder& stopRecording();  // RET: this recorder
+
+    bool recording() {  // RET: true if recording
+        return _recording;
+    }
+
+    /**
+     * Record a position on the path.
+     * This is called for each ROVER_POSE
+     * message while recording.
+     */
+    WaypointRecorder& record(
+        distance_type x,    // IN : horizontal position in world coordinates
+        distance_type y);   // IN : vertical position in world coordinates
+                            // RET: this recorder
+
+    /**
+     * Handle a subscribed message from a publisher
+     */
+    void onMessage(
+        Publisher &publisher,       // IN : publisher of message
+        Message message,            // IN : message that was published
+        Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+        const char *data);          // IN : message data as a c-cstring
+
+    unsigned int count() {  // RET: number of waypoints recorded
+        return _count;
+    }
+
+    distance_type tolerance() { // RET: cm the recorded path may stray from the driven path
+        return _tolerance;
+    }
+
+    /**
+     * Get the recorded waypoints.
+     * Waypoints are delta encoded, so they
+     * are decoded from the first up to count.
+     */
+    unsigned int waypoints(
+        Point2D *points,        // OUT: recorded waypoints
+        unsigned int count);    // IN : most waypoints to get
+                                // RET: number of waypoints in points
+
+    /**
+     * Follow the recorded path from the rover's current pose.
+     */
+    WaypointRecorder& play(
+        PathFollowBehavior &follower,   // IN : behavior in attached state
+        distance_type lookahead,        // IN : cm along the path ahead of the rover to steer toward
+        distance_type tolerance);       // IN : cm from last waypoint considered success
+                                        // RET: this recorder
+
+    bool playing() {    // RET: true if playing the recorded path
+        return nullptr != _follower;
+    }
+
+    /**
+     * Poll from the control loop; while
+     * playing this streams waypoints to the
+     * follower as it makes room for them.
+     */
+    WaypointRecorder& poll(unsigned long currentMillis);    // IN : current time in milliseconds
+                                                            // RET: this recorder
+};
+
+#endif // WAYPOINT_RECORDER_H
@@ -0,0 +1,79 @@
+#include "./wheel_sync.h"
+
+/**
+ * Set the controller gains; zero gains turn it off
+ */
+WheelSync& WheelSync::setGains(
+    float Kp,   // IN : cm/sec of trim per cm of error
+    float Ki)   // IN : cm/sec of trim per cm·sec of error
+                // RET: this WheelSync
+{
+    _Kp = Kp;
+    _Ki = Ki;
+    return reset();
+}
+
+/**
+ * Forget the error and trims, as when the wheels
+ * stop or leave speed control.
+ */
+WheelSync& WheelSync::reset()   // RET: this WheelSync
+{
+    _started = false;
+    _error = 0;
+    _integral = 0;
+    _leftTrim = 0;
+    _rightTrim = 0;
+    return *this;
+}
+
+/**
+ * Accumulate the error from the distance each wheel moved
+ * since the last step and calculate new trims.
+ */
+WheelSync& WheelSync::step(
+    distance_type leftSetpoint,     // IN : left speed control setpoint in cm/sec
+    distance_type rightSetpoint,    // IN : right speed control setpoint in cm/sec
+    distance_type leftDistance,     // IN : total left wheel distance in cm
+    distance_type rightDistance,    // IN : total right wheel distance in cm
+    float seconds)                  // IN : time since last step
+                                    // RET: this WheelSync
+{
+    const distance_type scale = (ABS(leftSetpoint) + ABS(rightSetpoint)) / 2;
+    if(!enabled() || (0 == scale)) {
+        // nothing to keep in sync
+        reset();
+    } else if(_started) {
+        //
+        // a distance that matches the ratio of the
+        // setpoints adds nothing to the error
+        //
+        const distance_type left = leftDistance - _leftDistance;
+        const distance_type right = rightDistance - _rightDistance;
+        _error += (left * rightSetpoint - right * leftSetpoint) / scale;
+
+        //
+        // the trims are the gradient that reduces the error,
+        // bounded so they never reverse a wheel.
+        //
+        const distance_type correction = _Kp * _error + _Ki * (_integral + _error * seconds);
+        const distance_type leftLimit = _maxTrim * ABS(leftSetpoint);
+        const distance_type rightLimit = _maxTrim * ABS(rightSetpoint);
+        const distance_type leftTrim = -correction * rightSetpoint / scale;
+        const distance_type rightTrim = correction * leftSetpoint / scale;
+        _leftTrim = bound<distance_type>(leftTrim, -leftLimit, leftLimit);
+        _rightTrim = bound<distance_type>(rightTrim, -rightLimit, rightLimit);
+
+        // do not wind up the integral while a trim is at it's limit
+        if((_leftTrim == leftTrim) && (_rightTrim == rightTrim)) {
+            _integral += _error * seconds;
+        }
+    }
+
+    if(enabled() && (0 != scale)) {
+        _started = true;
+    }
+    _leftDistance = leftDistance;
+    _rightDistance = rightDistance;
+    return *this;
+}
@@ -0,0 +1,83 @@
+#ifndef ROVER_WHEEL_SYNC_H
+#define ROVER_WHEEL_SYNC_H
+
+#include "./pose.h"
+
+/**
+ * Cross-coupled synchronization of two wheel speed controllers.
+ *
+ * Each DriveWheel controls it's own speed, so a mismatch
+ * between motors that is within each controller's tolerance
+ * still adds up to a heading error over a long run.
+ * This measures how far the wheels have drifted from the
+ * ratio of their setpoints, the synchronization error,
+ *
+ *   error += (Δleft · rightSetpoint - Δright · leftSetpoint) / mean(|setpoints|)
+ *
+ * which, driving straight, is how far the left wheel is
+ * ahead of the right; turning, it is zero while the
+ * rover follows the arc the setpoints ask for.
+ * A PI controller on that error trims both setpoints,
+ * slowing the wheel that is ahead and speeding up the
+ * one that is behind, each in proportion to the
+ * other's setpoint, so the error is driven back to zero.
+ *
+ * Distances are in cm and speeds in cm/sec.
+ */
+class WheelSync {
+    private:
+    float _Kp;                  // cm/sec of trim per cm of error
+    float _Ki;                  // cm/sec of trim per cm·sec of error
+    float _maxTrim;             // largest trim as a fraction of a wheel's setpoint
+
+    bool _started = false;      // true once distances have been sampled
+    distance_type _leftDistance = 0;    // distances at last step
+    distance_type _rightDistance = 0;
+    distance_type _error = 0;           // synchronization error in cm
+    distance_type _integral = 0;        // integral of error in cm·sec
+    distance_type _leftTrim = 0;        // cm/sec to add to left setpoint
+    distance_type _rightTrim = 0;       // cm/sec to add to right setpoint
+
+    public:
+
+    WheelSync(
+        float Kp,       // IN : cm/sec of trim per cm of error
+        float Ki,       // IN : cm/sec of trim per cm·sec of error
+        float maxTrim)  // IN : largest trim as a fraction of a wheel's setpoint
+        : _Kp(Kp), _Ki(Ki), _maxTrim(maxTrim)
+    {
+    }
+
+    /**
+     * Set the controller gains; zero gains turn it off
+     */
+    WheelSync& setGains(
+        float Kp,   // IN : cm/sec of trim per cm of error
+        float Ki);  // IN : cm/sec of trim per cm·sec of error
+                    // RET: this WheelSync
+
+    /**
+     * Forget the error and trims, as when the wheels
+     * stop or leave speed control.
+     */
+    WheelSync& reset();     // RET: this WheelSync
+
+    /**
+     * Accumulate the error from the distance each wheel moved
+     * since the last step and calculate new trims.
+     */
+    WheelSync& step(
+        distance_type leftSetpoint,     // IN : left speed control setpoint in cm/sec
+        distance_type rightSetpoint,    // IN : right speed control setpoint in cm/sec
+        distance_type leftDistance,     // IN : total left wheel distance in cm
+        distance_type rightDistance,    // IN : total right wheel distance in cm
+        float seconds);                 // IN : time since last step
+                                        // RET: this WheelSync
+
+    bool enabled() { return (0 != _Kp) || (0 != _Ki); }  // RET: true if trims are calculated
+    distance_type error() { return _error; }            // RET: synchronization error in cm
+    distance_type leftTrim() { return _leftTrim; }      // RET: cm/sec to add to left setpoint
+    distance_type rightTrim() { return _rightTrim; }    // RET: cm/sec to add to right setpoint
+};
+
+#endif // ROVER_WHEEL_SYNC_H
@@ -2,16 +2,20 @@
 #include "websockets/command_socket.h"
 #include "string/strcopy.h"
 #include "util/circular_buffer.h"
-#include "wheel/drive_wheel.h"
-#include "rover/rover.h"
-#include "rover/pose.h"
-#include "rover/goto_goal.h"
-
-// from main.cpp
-extern TwoWheelRover rover;
-extern DriveWheel leftWheel;
-extern DriveWheel rightWheel;
-extern GotoGoalBehavior gotoGoalBehavior;
+#include "telemetry_format.h"
+
+//
+// messages that are turned into telemetry
+//
+const Message TelemetryMessages[NUMBER_OF_TELEMETRY_MESSAGES] = {
+    LOG_CLIENT,
+    WHEEL_HALT,
+    WHEEL_POWER,
+    TARGET_SPEED,
+    SPEED_CONTROL,
+    ROVER_POSE,
+    GOTO_GOAL,
+};
 
 /**
  * Determine if listening for and sending telemetry
@@ -26,12 +30,9 @@ bool TelemetrySender::attached() {
 void TelemetrySender::attach(MessageBus *messageBus) // IN : message bus on which to listen
 {
     if(nullptr != (_messageBus = messageBus)) {
-        subscribe(*_messageBus, LOG_CLIENT);
-        subscribe(*_messageBus, WHEEL_POWER);
-        subscribe(*_messageBus, TARGET_SPEED);
-        subscribe(*_messageBus, SPEED_CONTROL);
-        subscribe(*_messageBus, ROVER_POSE);
-        subscribe(*_messageBus, GOTO_GOAL);
+        for(unsigned int i = 0; i < NUMBER_OF_TELEMETRY_MESSAGES; i += 1) {
+            subscribe(*_messageBus, TelemetryMessages[i]);
+        }
     }
 }
 
@@ -40,270 +41,141 @@ void TelemetrySender::attach(MessageBus *messageBus) // IN : message bus on whic
  */
 void TelemetrySender::detach() {
     if(attached()) {
-        unsubscribe(*_messageBus, LOG_CLIENT);
-        unsubscribe(*_messageBus, WHEEL_POWER);
-        unsubscribe(*_messageBus, TARGET_SPEED);
-        unsubscribe(*_messageBus, SPEED_CONTROL);
-        unsubscribe(*_messageBus, ROVER_POSE);
-        unsubscribe(*_messageBus, GOTO_GOAL);
+        for(unsigned int i = 0; i < NUMBER_OF_TELEMETRY_MESSAGES; i += 1) {
+            unsubscribe(*_messageBus, TelemetryMessages[i]);
+        }
 
         _messageBus = nullptr;
     }
 }
 
-int jsonNameAt(char *dest, int destSize, int destIndex, const char *name) {
-    int offset = strCopyAt(dest, destSize, destIndex, "\"");
-    offset = strCopyAt(dest, destSize, offset, name);
-    offset = strCopyAt(dest, destSize, offset, "\":");
-    return offset;
-}
-int jsonBoolAt(char *dest, int destSize, int destIndex, const char *name, bool value) {
-    int offset = jsonNameAt(dest, destSize, destIndex, name);
-    offset = strCopyBoolAt(dest, destSize, offset, value);
-    return offset;
-}
-
-int jsonIntAt(char *dest, int destSize, int destIndex, const char *name, int value) {
-    int offset = jsonNameAt(dest, destSize, destIndex, name);
-    offset = strCopyIntAt(dest, destSize, offset, value);
-    return offset;
-}
-
-int jsonULongAt(char *dest, int destSize, int destIndex, const char *name, unsigned long value) {
-    int offset = jsonNameAt(dest, destSize, destIndex, name);
-    offset = strCopyULongAt(dest, destSize, offset, value);
-    return offset;
-}
-
-int jsonFloatAt(char *dest, int destSize, int destIndex, const char *name, float value) {
-    int offset = jsonNameAt(dest, destSize, destIndex, name);
-    offset = strCopyFloatAt(dest, destSize, offset, value, 6);
-    return offset;
-}
-
-
-int strCopyQuotedAt(char *dest, int destSize, int destIndex, const char *quote, const char * value) {
-    int offset = strCopyAt(dest, destSize, destIndex, quote);
-    offset = strCopyAt(dest, destSize, offset, value);
-    offset = strCopyAt(dest, destSize, offset, quote);
-    return offset;
-}
-
-int jsonStringAt(char *dest, int destSize, int destIndex, const char *name, const char * value) {
-    int offset = jsonNameAt(dest, destSize, destIndex, name);
-    offset = strCopyQuotedAt(dest, destSize, offset, "\"", value);
-    return offset;
-}
-
-
-int jsonOpenObjectAt(char *dest, int destSize, int destIndex, const char *name) {
-    int offset = jsonNameAt(dest, destSize, destIndex, name);
-    offset = strCopyAt(dest, destSize, offset, "{");
-    return offset;
-}
-
-int jsonCloseObjectAt(char *dest, int destSize, int destIndex) {
-    return strCopyAt(dest, destSize, destIndex, "}");
-}
-
-int formatLog(char *buffer, int sizeOfBuffer, const char *src, const char *data) {
-    // pwm value was set: pwm value to client as wrapped json: like 'set({left:{forward:true,pwm:255}})'
-    int offset = strCopy(buffer, sizeOfBuffer, "log({");
-        offset = jsonStringAt(buffer, sizeOfBuffer, offset, "src", src);
-        offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-        offset = jsonStringAt(buffer, sizeOfBuffer, offset, "msg", data);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
-
-    return offset;
-}
-
-int formatHalt(char *buffer, int sizeOfBuffer, const char *src, const char *data) {
-    // pwm value was set: pwm value to client as wrapped json: like 'set({left:{forward:true,pwm:255}})'
-    int offset = strCopy(buffer, sizeOfBuffer, "halt({");
-        offset = jsonStringAt(buffer, sizeOfBuffer, offset, "src", src);
-        offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-        offset = jsonStringAt(buffer, sizeOfBuffer, offset, "msg", data);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
-
-    return offset;
-}
-
-int formatWheelPower(char *buffer, int sizeOfBuffer, DriveWheel &driveWheel) {
-    // pwm value was set: pwm value to client as wrapped json: like 'set({left:{forward:true,pwm:255}})'
-    int offset = strCopy(buffer, sizeOfBuffer, "set({");
-        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, (LEFT_WHEEL_SPEC == driveWheel.specifier()) ? "left" : "right");
-            offset = jsonBoolAt(buffer, sizeOfBuffer, offset, "forward", driveWheel.forward());
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-            offset = jsonIntAt(buffer, sizeOfBuffer, offset, "pwm", driveWheel.pwm());
-        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
-
-    return offset;
-}
-
-int formatTargetSpeed(char *buffer, int sizeOfBuffer, DriveWheel &driveWheel) {
-    // target speed was set: pwm value to client as wrapped json: like 'set({left:{target:12.3}})'
-    int offset = strCopy(buffer, sizeOfBuffer, "set({");
-        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, (LEFT_WHEEL_SPEC == driveWheel.specifier()) ? "left" : "right");
-            offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "target", driveWheel.useSpeedControl() ? driveWheel.targetSpeed() : 0);
-        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
-
-    return offset;
-}
-
-int formatSpeedControl(char *buffer, int sizeOfBuffer, DriveWheel &driveWheel) {
-    // speed control updated: send values to client: like 'tel({left: {forward: true, pwm: 255, target: 12.3, speed: 11.2, distance: 432.1, at:1234567890}})'
-    int offset = strCopy(buffer, sizeOfBuffer, "tel({");
-        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, (LEFT_WHEEL_SPEC == driveWheel.specifier()) ? "left" : "right");
-            // power
-            offset = jsonBoolAt(buffer, sizeOfBuffer, offset, "forward", driveWheel.forward());
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-            offset = jsonIntAt(buffer, sizeOfBuffer, offset, "pwm", driveWheel.pwm());
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-
-            // target speed
-            offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "target", driveWheel.useSpeedControl() ? driveWheel.targetSpeed() : 0);
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-
-            // measured speed, distance and time of measurement
-            offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "speed", driveWheel.speed());
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-            offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "distance", driveWheel.distance());
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-            offset = jsonULongAt(buffer, sizeOfBuffer, offset, "at", driveWheel.lastMs());
-
-        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
-
-    return offset;
-}
-
-/**
- * copy x, y, angle fields into json object
- */
-int jsonPose2DFieldsAt(char *buffer, const int sizeOfBuffer, int offset, const Pose2D& pose) {
-    // pose updated: send values to client: like 'tel({pose: {x: 10.1, y: 4.3, a: 0.53, at:1234567890}})'
-    offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "x", pose.x);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-    offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "y", pose.y);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-    offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "a", pose.angle);
-
-    return offset;
-}
-
-int formatRoverPose(char *buffer, int sizeOfBuffer, Pose2D& pose, unsigned int poseMs) {
-    // pose updated: send values to client: like 'tel({pose: {x: 10.1, y: 4.3, a: 0.53, at:1234567890}})'
-    int offset = strCopy(buffer, sizeOfBuffer, "pose({");
-        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, "pose");
-            offset = jsonPose2DFieldsAt(buffer, sizeOfBuffer, offset, pose);
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-            offset = jsonULongAt(buffer, sizeOfBuffer, offset, "at", poseMs);
-        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
-
-    return offset;
-}
-
-int formatGotoGoal(char *buffer, const int sizeOfBuffer, const Pose2D& pose, const GotoGoalState state, const unsigned int poseMs) {
-    // pose updated: send values to client: like 'tel({pose: {x: 10.1, y: 4.3, a: 0.53, at:1234567890}})'
-    int offset = strCopy(buffer, sizeOfBuffer, "goto({");
-        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, "goto");
-            offset = jsonPose2DFieldsAt(buffer, sizeOfBuffer, offset, pose);
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-            offset = jsonStringAt(buffer, sizeOfBuffer, offset, "state", GotoGoalStateStr[state]);
-            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
-            offset = jsonULongAt(buffer, sizeOfBuffer, offset, "at", poseMs);
-        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
-    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
-    return offset;
-}
-
 /**
- * Convert messages into telemetry strings
- * and write them into an output buffer
- * so they can be send using poll().
+ * Capture telemetry messages and format them.
+ * This is used when the sender listens on the
+ * same core that runs the rover; otherwise a
+ * TelemetryBridge captures the messages and
+ * hands them to send() on the network core.
  */
 void TelemetrySender::onMessage(
-    Publisher &publisher,       // IN : publisher of message
+    Publisher &,                // IN : publisher of message
     Message message,            // IN : message that was published
     Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
     const char *data)           // IN : message data as a c-cstring
-
 {
+    TelemetrySnapshot snapshot;
+    if(captureTelemetry(message, specifier, data, millis(), snapshot)) {
+        send(snapshot);
+    }
+}
 
+/**
+ * Convert captured telemetry into a record
+ * and write it into an output buffer
+ * so it can be sent using poll().
+ * Only the snapshot is read, so this is
+ * safe to call on any core.
+ */
+void TelemetrySender::send(const TelemetrySnapshot &snapshot) // IN : captured telemetry
+{
     //
     // 1. determine message 
     // 2. get an output buffer
-    // 3. format message into a string in the output buffer
+    // 3. format message into text or binary in the output buffer
     // The output buffer will be send during next poll()
     // 
+    const bool binary = (TELEMETRY_BINARY == _format);
+    const Message message = snapshot.message;
+    const Specifier specifier = snapshot.specifier;
+    const unsigned long now = snapshot.at;
     switch (message) {
         case LOG_CLIENT: {
-            char *buffer = _getBuffer();
+            if(!_isDue(TELEMETRY_LOG, message, specifier, now)) return;
+
+            char *buffer = _getBuffer(TELEMETRY_LOG);
             if(nullptr != buffer) {
-                formatLog(buffer, TELEMETRY_BUFFER_BYTES, (LEFT_WHEEL_SPEC == specifier) ? "left" : "right", data);
+                const char *src = (LEFT_WHEEL_SPEC == specifier) ? "left" : "right";
+                _setBufferLength(binary
+                    ? packLog((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, src, snapshot.data)
+                    : formatLog(buffer, TELEMETRY_BUFFER_BYTES, src, snapshot.data));
             }
             return;
         }
         case WHEEL_HALT: {
-            char *buffer = _getBuffer();
+            //
+            // a halt is never decimated, turned off or dropped;
+            // it replaces a queued periodic sample if it must.
+            //
+            char *buffer = (char *)_queue.reserve(TELEMETRY_LOG, TELEMETRY_NEVER_DROP, binary);
             if(nullptr != buffer) {
-                formatLog(buffer, TELEMETRY_BUFFER_BYTES, Specifiers[specifier], data ? data : "");
+                _setBufferLength(binary
+                    ? packLog((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, Specifiers[specifier], snapshot.data)
+                    : formatLog(buffer, TELEMETRY_BUFFER_BYTES, Specifiers[specifier], snapshot.data));
             }
             _sending = false;   // don't send telemetry when halted
             return;
         }
         case WHEEL_POWER: {
-            DriveWheel& driveWheel = (LEFT_WHEEL_SPEC == specifier) ? leftWheel : rightWheel;
-            
-            char *buffer = _getBuffer();
+            char *buffer = _isDue(TELEMETRY_SET, message, specifier, now) ? _getBuffer(TELEMETRY_SET) : nullptr;
             if(nullptr != buffer) {
-                formatWheelPower(buffer, TELEMETRY_BUFFER_BYTES, driveWheel);
+                _setBufferLength(binary
+                    ? packWheelPower((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, snapshot.wheel)
+                    : formatWheelPower(buffer, TELEMETRY_BUFFER_BYTES, snapshot.wheel));
             }
 
-            _sending = (driveWheel.pwm() > 0);  // don't send a bunch of zero positions
+            _sending = (snapshot.wheel.pwm > 0);  // don't send a bunch of zero positions
             return;
         }
         case TARGET_SPEED: {
+            if(!_isDue(TELEMETRY_SET, message, specifier, now)) return;
+
             // target speed was set: pwm value to client as wrapped json: like 'set({left:{target:12.3}})'
-            char *buffer = _getBuffer();
+            char *buffer = _getBuffer(TELEMETRY_SET);
             if(nullptr != buffer) {
-                DriveWheel& driveWheel = (LEFT_WHEEL_SPEC == specifier) ? leftWheel : rightWheel;
-                formatTargetSpeed(buffer, TELEMETRY_BUFFER_BYTES, driveWheel);
+                _setBufferLength(binary
+                    ? packTargetSpeed((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, snapshot.wheel)
+                    : formatTargetSpeed(buffer, TELEMETRY_BUFFER_BYTES, snapshot.wheel));
             }
             return;
         }
         case SPEED_CONTROL: {
             if(!_sending) return;
 
+            // every sample is recorded, even if it is not sent now
+            _history.append(historyOfWheel(snapshot.wheel));
+            if(!_isDue(TELEMETRY_WHEEL, message, specifier, now)) return;
+
             // speed control updated: send values to client: like 'tel({left: {forward: true, pwm: 255, target: 12.3, speed: 11.2, distance: 432.1, at:1234567890}})'
-            char *buffer = _getBuffer();
+            char *buffer = _getBuffer(TELEMETRY_WHEEL);
             if(nullptr != buffer) {
-                DriveWheel& driveWheel = (LEFT_WHEEL_SPEC == specifier) ? leftWheel : rightWheel;
-                formatSpeedControl(buffer, TELEMETRY_BUFFER_BYTES, driveWheel);
+                _setBufferLength(_formatWheel(buffer, snapshot.wheel, binary));
             }
             return;
         }
         case ROVER_POSE: {
             if(!_sending) return;
 
+            // every sample is recorded, even if it is not sent now
+            _history.append(historyOfPose(snapshot.pose));
+            if(!_isDue(TELEMETRY_POSE, message, specifier, now)) return;
+
             // pose updated: send values to client: like 'pose({pose: {x: 10.1, y: 4.3, a: 0.53, at:1234567890}})'
-            char *buffer = _getBuffer();
+            char *buffer = _getBuffer(TELEMETRY_POSE);
             if(nullptr != buffer) {
-                Pose2D pose = rover.pose();
-                formatRoverPose(buffer, TELEMETRY_BUFFER_BYTES, pose, rover.lastPoseMs());
+                _setBufferLength(binary
+                    ? packRoverPose((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, snapshot.pose)
+                    : formatRoverPose(buffer, TELEMETRY_BUFFER_BYTES, snapshot.pose));
             }
             return;
         }
         case GOTO_GOAL: {
+            if(!_isDue(TELEMETRY_GOTO, message, specifier, now)) return;
+
             // pose updated: send values to client: like 'goto({goto: {x: 10.1, y: 4.3, a: 0.53, state="STARTING", at:1234567890}})'
-            char *buffer = _getBuffer();
+            char *buffer = _getBuffer(TELEMETRY_GOTO);
             if(nullptr != buffer) {
-                const Pose2D goal = gotoGoalBehavior.goal();
-                const GotoGoalState state = gotoGoalBehavior.state();
-                formatGotoGoal(buffer, TELEMETRY_BUFFER_BYTES, goal, state, rover.lastPoseMs());
+                _setBufferLength(binary
+                    ? packGotoGoal((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, snapshot.go2)
+                    : formatGotoGoal(buffer, TELEMETRY_BUFFER_BYTES, snapshot.go2));
             }
             return;
         }
@@ -314,41 +186,401 @@ void TelemetrySender::onMessage(
 }
 
 /**
- * Get pointer to telemetry buffer
+ * Format wheel speed control telemetry.
+ * If delta encoding is on then only fields that
+ * changed since the last record for the wheel are sent,
+ * with a keyframe of all fields every TELEMETRY_KEYFRAME_INTERVAL
+ * records or when the client asks for one.
+ */
+int TelemetrySender::_formatWheel(
+    char *buffer,                   // OUT: receives formatted telemetry
+    const WheelTelemetry &wheel,    // IN : wheel values
+    bool binary)                    // IN : true for binary, false for text
+                                    // RET: length of telemetry or -1 on failure
+{
+    if(!_delta) {
+        return binary
+            ? packSpeedControl((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, wheel)
+            : formatSpeedControl(buffer, TELEMETRY_BUFFER_BYTES, wheel);
+    }
+
+    const int w = (LEFT_WHEEL_SPEC == wheel.wheel) ? 0 : 1;
+    const bool keyframe = _wheelKeyframe[w] || (_wheelSinceKeyframe[w] >= TELEMETRY_KEYFRAME_INTERVAL);
+    const uint8_t fields = keyframe
+        ? (WHEEL_ALL_FIELDS | WHEEL_KEYFRAME)
+        : wheelChangedFields(_lastWheel[w], wheel);
+
+    const int length = binary
+        ? packSpeedControlDelta((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, wheel, fields, _wheelSequence[w])
+        : formatSpeedControlDelta(buffer, TELEMETRY_BUFFER_BYTES, wheel, fields, _wheelSequence[w]);
+
+    //
+    // only advance the state if the record was formatted,
+    // so the next delta is relative to what the client has.
+    //
+    if(length > 0) {
+        _lastWheel[w] = wheel;
+        _wheelSequence[w] += 1;
+        _wheelSinceKeyframe[w] = keyframe ? 0 : _wheelSinceKeyframe[w] + 1;
+        _wheelKeyframe[w] = false;
+    }
+    return length;
+}
+
+/**
+ * Determine if a message should be formatted
+ * given the period of it's channel.
+ * This is checked before a buffer is taken,
+ * so decimated messages cost no formatting.
+ * Only periodic channels (wheel and pose) are
+ * decimated; they are resent within a period anyway.
+ * State change channels are only turned on or off, 
+ * since a suppressed change would leave the client 
+ * with a stale value until the next change.
  */
-char* TelemetrySender::_getBuffer() {
+bool TelemetrySender::_isDue(
+    TelemetryChannel channel,       // IN : channel that carries the message
+    Message message,                // IN : message to send
+    Specifier specifier,            // IN : specifier of message
+    unsigned long currentMillis)    // IN : milliseconds since startup
+                                    // RET: true if message should be sent
+{
+    const unsigned int periodMs = channelPeriod(channel);
+    if(TELEMETRY_PERIOD_OFF == periodMs) return false;
+    if(TELEMETRY_PERIOD_ALL == periodMs) return true;
+    if((TELEMETRY_WHEEL != channel) && (TELEMETRY_POSE != channel)) return true;
+
     //
-    // buffer is a circular queue of buffers
+    // each message/specifier pair is limited separately,
+    // so left and right wheels each get their own updates.
+    // a zero time means it has never been sent.
     //
-    if(_telemetryCount < TELEMETRY_BUFFER_COUNT) {
-        char *buffer = _telemetryBuffer[_telemetryWriteIndex];
-        _telemetryWriteIndex = (_telemetryWriteIndex + 1) % TELEMETRY_BUFFER_COUNT;
-        _telemetryCount += 1;
-        return buffer;
+    unsigned long &lastSentMs = _lastSentMs[message][specifier];
+    if((0 == lastSentMs) || (currentMillis - lastSentMs >= periodMs)) {
+        lastSentMs = currentMillis;
+        return true;
     }
+    return false;
+}
 
-    return nullptr;
+/**
+ * Turn a channel off, on, or limit it's rate
+ */
+void TelemetrySender::setChannelPeriod(
+    TelemetryChannel channel,   // IN : channel
+    unsigned int periodMs)      // IN : TELEMETRY_PERIOD_OFF (0) to turn off,
+                                //      TELEMETRY_PERIOD_ALL (1) to send all messages,
+                                //      otherwise minimum milliseconds between messages
+{
+    if(channel < NUMBER_OF_TELEMETRY_CHANNELS) {
+        _channelPeriodMs[channel] = periodMs;
+    }
 }
 
+/**
+ * Restore every channel to TELEMETRY_PERIOD_ALL
+ */
+void TelemetrySender::resetChannels() {
+    for(int channel = 0; channel < NUMBER_OF_TELEMETRY_CHANNELS; channel += 1) {
+        _channelPeriodMs[channel] = TELEMETRY_PERIOD_ALL;
+    }
+}
 
 /**
- * If there is telemetry buffered, then send it
+ * Get pointer to telemetry buffer.
+ * If the queue is full then the channel's
+ * drop policy decides what is lost; the
+ * oldest periodic sample is replaced, so
+ * state changes are never dropped behind them.
  */
-void TelemetrySender::poll() 
+char* TelemetrySender::_getBuffer(TelemetryChannel channel) // IN : channel of the record
+                                                            // RET: buffer of TELEMETRY_BUFFER_BYTES
+                                                            //      or nullptr if record was dropped
 {
-    // if there is telemetry queued, then send one
-    // of them during this polling session
-    if(_telemetryCount > 0) {
-        // get index of telemetry at start of queue
-        const int index = (_telemetryWriteIndex - _telemetryCount) % TELEMETRY_BUFFER_COUNT;
-
-        // if telemetry is not an empty string, then send it.
-        if(_telemetryBuffer[index][0]) {
-            wsSendCommandText(_telemetryBuffer[index], strlen(_telemetryBuffer[index]));
+    return (char *)_queue.reserve(channel, dropPolicy(channel), TELEMETRY_BINARY == _format);
+}
+
+/**
+ * Set the length of the buffer most recently
+ * returned by _getBuffer().  A length less than one
+ * (a formatting failure) leaves the buffer empty
+ * so it is skipped by poll().
+ */
+void TelemetrySender::_setBufferLength(int length) // IN : bytes written into buffer
+{
+    _queue.commit(length);
+}
+
+/**
+ * Stream recorded samples on a channel that
+ * are newer than the given time.  The backlog
+ * is sent in chunks by poll(), so a long
+ * backlog does not hold up live telemetry.
+ * Samples recorded after this call are not part of
+ * the backlog; the client gets those as live telemetry.
+ */
+void TelemetrySender::requestHistory(
+    TelemetryChannel channel,   // IN : TELEMETRY_WHEEL or TELEMETRY_POSE
+    unsigned long sinceMs)      // IN : send samples with at > sinceMs
+{
+    if((TELEMETRY_WHEEL != channel) && (TELEMETRY_POSE != channel)) return;
+
+    HistoryCursor &cursor = _historyCursor[channel];
+    cursor.next = _history.find(sinceMs);
+    cursor.end = _history.sequence();
+    cursor.active = true;
+}
+
+/**
+ * Send the next chunk of each requested backlog.
+ * History is always sent as binary;
+ * a chunk is a header followed by up to a frame's
+ * worth of samples from the requested channel.
+ * The last chunk is flagged, even if it is empty,
+ * so the client knows the backlog is complete.
+ */
+void TelemetrySender::_pollHistory() {
+    _pollHistory(TELEMETRY_WHEEL);
+    _pollHistory(TELEMETRY_POSE);
+}
+
+/**
+ * Send the next chunk of a channel's backlog
+ */
+void TelemetrySender::_pollHistory(TelemetryChannel channel)   // IN : TELEMETRY_WHEEL or TELEMETRY_POSE
+{
+    HistoryCursor &cursor = _historyCursor[channel];
+    if(!cursor.active) return;
+
+    // skip anything that was overwritten while we were streaming
+    if(cursor.next < _history.oldest()) {
+        cursor.next = _history.oldest();
+    }
+
+    const int maxRecords = (TELEMETRY_FRAME_BYTES - TELEMETRY_HISTORY_HEADER_BYTES) / TELEMETRY_HISTORY_RECORD_BYTES;
+    int offset = TELEMETRY_HISTORY_HEADER_BYTES;
+    int count = 0;
+    unsigned int scanned = 0;
+    HistoryRecord record;
+    while((cursor.next < cursor.end) && (count < maxRecords) && (scanned < TELEMETRY_HISTORY_SCAN)) {
+        if(_history.read(cursor.next, record) && (channel == record.channel)) {
+            offset += packHistoryRecord(_frame + offset, sizeof(_frame) - offset, record);
+            count += 1;
         }
+        cursor.next += 1;
+        scanned += 1;
+    }
+
+    const bool last = (cursor.next >= cursor.end);
+    if((count > 0) || last) {
+        packHistoryHeader(_frame, sizeof(_frame), channel, last ? TELEMETRY_HISTORY_LAST : 0, (uint8_t)count);
+        wsSendCommandBinary(_frame, offset);
+    }
+    cursor.active = !last;
+}
+
+/**
+ * Total records dropped on all channels
+ */
+unsigned long TelemetrySender::_totalLost() {
+    unsigned long total = 0;
+    for(int channel = 0; channel < NUMBER_OF_TELEMETRY_CHANNELS; channel += 1) {
+        total += _queue.lost((TelemetryChannel)channel);
+    }
+    return total;
+}
 
-        // remove it from the queue
-        _telemetryBuffer[index][0] = 0;
-        _telemetryCount -= 1;
+/**
+ * Move tokenized log records into the telemetry queue.
+ * This runs on the side that sends telemetry, so the
+ * cost of formatting a text log is paid here rather
+ * than where the message was logged.  Only free slots
+ * are used, so log records never push out other telemetry;
+ * they wait in the token log ring instead, and if that fills
+ * then a count of the dropped records is sent in their place.
+ */
+void TelemetrySender::_pollTokenLog(unsigned long currentMillis) // IN : milliseconds since startup
+{
+    const bool binary = (TELEMETRY_BINARY == _format);
+    const bool off = (TELEMETRY_PERIOD_OFF == _channelPeriodMs[TELEMETRY_LOG]);
+
+    for(unsigned int i = 0; (i < TOKEN_LOG_DRAIN) && (_queue.count() < _queue.capacity()); i += 1) {
+        TokenLogRecord record;
+        const unsigned int dropped = tokenLog.dropped();
+        if(dropped != _tokenLogDropped) {
+            record.at = currentMillis;
+            record.token = LOG_TOKEN_DROPPED;
+            record.level = WARN_LEVEL;
+            record.argc = 1;
+            record.args[0] = dropped - _tokenLogDropped;
+            _tokenLogDropped = dropped;
+        } else if(!tokenLog.pop(record)) {
+            return;
+        }
+        if(off) continue;   // log channel is turned off; discard
+
+        char *buffer = _getBuffer(TELEMETRY_LOG);
+        if(nullptr == buffer) return;
+        if(binary) {
+            _setBufferLength(packTokenLog((uint8_t *)buffer, TELEMETRY_BUFFER_BYTES, record));
+        } else {
+            // like 'log({"src":"INFO","msg":"wsCommandEvent.WStype_PONG, clientId: 0"})'
+            char msg[TELEMETRY_BUFFER_BYTES];
+            if(formatTokenLog(msg, sizeof(msg), record) < 0) {
+                strCopy(msg, sizeof(msg), tokenLogFormat(record.token));
+            }
+            _setBufferLength(formatLog(buffer, TELEMETRY_BUFFER_BYTES, tokenLogLevelName(record.level), msg));
+        }
     }
 }
+
+/**
+ * Format a loss report if records were dropped
+ * since the last report, at most once
+ * every TELEMETRY_LOSS_MS.  The report carries the
+ * per channel counts and how backed up sending
+ * has been since the last report.
+ */
+int TelemetrySender::_formatLoss(
+    uint8_t *buffer,                // OUT: receives formatted loss report
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    bool binary,                    // IN : true for binary, false for text
+    unsigned long currentMillis)    // IN : milliseconds since startup
+                                    // RET: length of report or zero if none is due
+{
+    const unsigned long totalLost = _totalLost();
+    if((totalLost == _reportedLost) || (currentMillis - _lastLossMs < TELEMETRY_LOSS_MS)) {
+        return 0;
+    }
+
+    LossTelemetry loss;
+    for(int channel = 0; channel < NUMBER_OF_TELEMETRY_CHANNELS; channel += 1) {
+        loss.lost[channel] = _queue.lost((TelemetryChannel)channel);
+    }
+    loss.depth = (uint8_t)_queue.count();
+    loss.highWater = (uint8_t)_queue.highWater();
+    loss.sendUs = _maxSendUs;
+    loss.at = currentMillis;
+
+    const int length = binary
+        ? packLoss(buffer, sizeOfBuffer, loss)
+        : formatLoss((char *)buffer, sizeOfBuffer, loss);
+    if(length <= 0) {
+        return 0;
+    }
+
+    _reportedLost = totalLost;
+    _lastLossMs = currentMillis;
+    _maxSendUs = 0;
+    _queue.resetHighWater();
+    return length;
+}
+
+
+/**
+ * Select text or binary telemetry.
+ * This applies to telemetry formatted after the call;
+ * telemetry that is already buffered is sent as it was formatted.
+ */
+void TelemetrySender::setFormat(TelemetryFormat format) // IN : TELEMETRY_TEXT or TELEMETRY_BINARY
+{
+    _format = format;
+    requestKeyframe(TELEMETRY_WHEEL);   // client's decoder starts over
+}
+
+/**
+ * Turn delta encoding of wheel telemetry on or off
+ */
+void TelemetrySender::setDelta(bool delta) // IN : true to send changed fields only
+{
+    _delta = delta;
+    requestKeyframe(TELEMETRY_WHEEL);
+}
+
+/**
+ * Send all fields in the next record on the channel.
+ * Only the wheel channel is delta encoded;
+ * other channels always send all fields.
+ */
+void TelemetrySender::requestKeyframe(TelemetryChannel channel) // IN : channel
+{
+    if(TELEMETRY_WHEEL == channel) {
+        _wheelKeyframe[0] = true;
+        _wheelKeyframe[1] = true;
+    }
+}
+
+/**
+ * If there is telemetry buffered, then 
+ * batch it into a frame and send it.
+ * A frame holds records of one format, so
+ * after a format change the remaining records
+ * go out in the next frame.
+ * If records were dropped then a loss report
+ * leads the frame.
+ * Then the next chunk of any requested history is sent.
+ */
+void TelemetrySender::poll(unsigned long currentMillis) // IN : milliseconds since startup
+{
+    _pollTokenLog(currentMillis);
+
+    const bool pending = (_queue.count() > 0) || (_totalLost() != _reportedLost);
+    if(pending && (currentMillis - _lastFrameMs >= TELEMETRY_FRAME_MS)) {
+        //
+        // a dropped wheel record leaves a gap in
+        // delta encoded telemetry, so start over.
+        //
+        const unsigned long wheelLost = _queue.lost(TELEMETRY_WHEEL);
+        if(wheelLost != _wheelLost) {
+            _wheelLost = wheelLost;
+            requestKeyframe(TELEMETRY_WHEEL);
+        }
+
+        bool binary = (TELEMETRY_BINARY == _format);
+        int frameLength = _formatLoss(_frame, TELEMETRY_BUFFER_BYTES, binary, currentMillis);
+
+        int length;
+        bool recordBinary;
+        const uint8_t *record;
+        while(nullptr != (record = _queue.front(length, recordBinary))) {
+            // if telemetry is not empty, then add it to the frame
+            if(length > 0) {
+                if(0 == frameLength) {
+                    binary = recordBinary;
+                } else if(binary != recordBinary) {
+                    break;  // different format goes in the next frame
+                }
+
+                const int newLength = appendToFrame(_frame, sizeof(_frame), frameLength, record, length, binary);
+                if(newLength < 0) {
+                    break;  // frame is full
+                }
+                frameLength = newLength;
+            }
+
+            // remove it from the queue
+            _queue.pop();
+        }
+
+        if(frameLength > 0) {
+            //
+            // the websocket send blocks while the tcp send
+            // buffer is full, so the time it takes is
+            // how backed up the connection is.
+            //
+            const unsigned long startUs = micros();
+            if(binary) {
+                wsSendCommandBinary(_frame, frameLength);
+            } else {
+                wsSendCommandText((const char *)_frame, frameLength);
+            }
+            const unsigned long sendUs = micros() - startUs;
+            if(sendUs > _maxSendUs) {
+                _maxSendUs = sendUs;
+            }
+        }
+        _lastFrameMs = currentMillis;
+    }
+
+    _pollHistory();
+}
@@ -2,7 +2,30 @@
 #define TELEMETRY_H
 
 #include "message_bus/message_bus.h"
+#include "telemetry_format.h"
+#include "telemetry_queue.h"
+#include "telemetry_history.h"
+#include "config.h"
 
+//
+// messages that are turned into telemetry
+//
+const unsigned int NUMBER_OF_TELEMETRY_MESSAGES = 7;
+extern const Message TelemetryMessages[NUMBER_OF_TELEMETRY_MESSAGES];
+
+/**
+ * Capture the values a telemetry message reports.
+ * This reads the rover, so call it on the core
+ * that runs the rover, when the message is published.
+ */
+bool captureTelemetry(
+    Message message,                // IN : message that was published
+    Specifier specifier,            // IN : specifier (like LEFT_WHEEL_SPEC)
+    const char *data,               // IN : message data as a c-cstring
+    unsigned long currentMillis,    // IN : milliseconds since startup
+    TelemetrySnapshot &snapshot);   // OUT: on true, the captured values
+                                    // RET: true if message is telemetry,
+                                    //      false if it is ignored
 
 /**
  * Class to listen for telemetry messages
@@ -12,23 +35,243 @@ class TelemetrySender : Subscriber {
     private:
 
     static const unsigned int TELEMETRY_BUFFER_COUNT = 8;
-    static const unsigned int TELEMETRY_BUFFER_BYTES = 128;
+    static const unsigned int TELEMETRY_BUFFER_BYTES = 192;
+    static_assert(TELEMETRY_BUFFER_BYTES <= TELEMETRY_FRAME_BYTES, "a telemetry buffer must fit in a frame");
+    static_assert(TELEMETRY_LOSS_BYTES <= TELEMETRY_BUFFER_BYTES, "a loss report must fit in a buffer");
+
+    // formatted records waiting to be sent
+    TelemetryQueue<TELEMETRY_BUFFER_COUNT, TELEMETRY_BUFFER_BYTES> _queue;
+
+    // what to drop when the queue is full; periodic samples are dropped, state changes are kept
+    TelemetryDropPolicy _dropPolicy[NUMBER_OF_TELEMETRY_CHANNELS] = {
+        TELEMETRY_DROP_OLDEST,  // TELEMETRY_WHEEL
+        TELEMETRY_DROP_OLDEST,  // TELEMETRY_POSE
+        TELEMETRY_NEVER_DROP,   // TELEMETRY_GOTO
+        TELEMETRY_NEVER_DROP,   // TELEMETRY_SET
+        TELEMETRY_NEVER_DROP,   // TELEMETRY_LOG
+    };
 
-    char _telemetryBuffer[TELEMETRY_BUFFER_COUNT][TELEMETRY_BUFFER_BYTES];
-    int _telemetryCount = 0;        // number of telemetry buffers to send
-    int _telemetryWriteIndex = 0;   // index of buffer to write to
+    //
+    // loss reporting
+    //
+    unsigned long _reportedLost = 0;    // total records lost as of last loss report
+    unsigned long _lastLossMs = 0;      // time of last loss report
+    unsigned long _maxSendUs = 0;       // longest websocket send since last loss report
+    unsigned long _wheelLost = 0;       // wheel records lost as of last keyframe request
+
+    //
+    // recorded wheel and pose samples and
+    // the backlogs being streamed to the client;
+    // each channel has it's own cursor so a
+    // request on one does not cancel the other.
+    //
+    typedef struct HistoryCursor {
+        bool active = false;        // true while streaming a backlog
+        unsigned long next = 0;     // sequence number of next record to examine
+        unsigned long end = 0;      // sequence number after last record to stream
+    } HistoryCursor;
+    TelemetryHistory _history;
+    HistoryCursor _historyCursor[NUMBER_OF_TELEMETRY_CHANNELS];  // only wheel and pose are used
+
+    unsigned int _tokenLogDropped = 0;  // token log records dropped as of last report
+
+    uint8_t _frame[TELEMETRY_FRAME_BYTES];  // buffered telemetry is batched into a frame
+    unsigned long _lastFrameMs = 0;         // time last frame was sent
 
     MessageBus *_messageBus = nullptr;
     bool _sending = false;
 
+    // per channel period; TELEMETRY_PERIOD_OFF, TELEMETRY_PERIOD_ALL or milliseconds between messages
+    unsigned int _channelPeriodMs[NUMBER_OF_TELEMETRY_CHANNELS] = {
+        TELEMETRY_PERIOD_ALL, TELEMETRY_PERIOD_ALL, TELEMETRY_PERIOD_ALL, TELEMETRY_PERIOD_ALL, TELEMETRY_PERIOD_ALL
+    };
+    unsigned long _lastSentMs[NUMBER_OF_MESSAGES][NUMBER_OF_SPECIFIERS] = {};   // time each message/specifier was last formatted; zero if never
+    TelemetryFormat _format = TELEMETRY_TEXT;
+    bool _delta = false;    // true to send changed wheel fields only
+
+    //
+    // delta encoding state for left [0] and right [1] wheels
+    //
+    WheelTelemetry _lastWheel[2];               // last wheel values sent
+    uint8_t _wheelSequence[2] = {0, 0};         // sequence number of next wheel record
+    uint8_t _wheelSinceKeyframe[2] = {0, 0};    // records sent since last keyframe
+    bool _wheelKeyframe[2] = {true, true};      // true to force a keyframe
+
     /**
      * Get pointer to telemetry buffer
      */
-    char *_getBuffer();
+    char *_getBuffer(TelemetryChannel channel); // IN : channel of the record
+                                                // RET: buffer of TELEMETRY_BUFFER_BYTES
+                                                //      or nullptr if record was dropped
+
+    /**
+     * Format wheel speed control telemetry,
+     * as a delta if delta encoding is on.
+     */
+    int _formatWheel(
+        char *buffer,                   // OUT: receives formatted telemetry
+        const WheelTelemetry &wheel,    // IN : wheel values
+        bool binary);                   // IN : true for binary, false for text
+                                        // RET: length of telemetry or -1 on failure
+
+    /**
+     * Set length of buffer last returned by _getBuffer()
+     */
+    void _setBufferLength(int length); // IN : bytes written into buffer
+
+    /**
+     * Send the next chunk of each requested backlog
+     */
+    void _pollHistory();
+
+    /**
+     * Send the next chunk of a channel's backlog
+     */
+    void _pollHistory(TelemetryChannel channel);    // IN : TELEMETRY_WHEEL or TELEMETRY_POSE
+
+    /**
+     * Move tokenized log records into the queue
+     */
+    void _pollTokenLog(unsigned long currentMillis);    // IN : milliseconds since startup
+
+    /**
+     * Total records dropped on all channels
+     */
+    unsigned long _totalLost();
+
+    /**
+     * Format a loss report if records were dropped
+     * since the last one and one is due
+     */
+    int _formatLoss(
+        uint8_t *buffer,                // OUT: receives formatted loss report
+        int sizeOfBuffer,               // IN : size of buffer in bytes
+        bool binary,                    // IN : true for binary, false for text
+        unsigned long currentMillis);   // IN : milliseconds since startup
+                                        // RET: length of report or zero if none is due
+
+    /**
+     * Determine if a message should be formatted
+     * given the period of it's channel
+     */
+    bool _isDue(
+        TelemetryChannel channel,       // IN : channel that carries the message
+        Message message,                // IN : message to send
+        Specifier specifier,            // IN : specifier of message
+        unsigned long currentMillis);   // IN : milliseconds since startup
+                                        // RET: true if message should be sent
 
     public:
 
+    /**
+     * Get the telemetry format
+     */
+    TelemetryFormat format() { return _format; }
 
+    /**
+     * Select text or binary telemetry
+     */
+    void setFormat(TelemetryFormat format); // IN : TELEMETRY_TEXT or TELEMETRY_BINARY
+
+    /**
+     * Determine if wheel telemetry is delta encoded
+     */
+    bool delta() { return _delta; }
+
+    /**
+     * Turn delta encoding of wheel telemetry on or off
+     */
+    void setDelta(bool delta); // IN : true to send changed fields only
+
+    /**
+     * Send all fields in the next record on the channel
+     */
+    void requestKeyframe(TelemetryChannel channel); // IN : channel
+
+    /**
+     * Get the period of a telemetry channel
+     */
+    unsigned int channelPeriod(TelemetryChannel channel) // IN : channel
+                                                          // RET: period in ms, TELEMETRY_PERIOD_OFF
+                                                          //      or TELEMETRY_PERIOD_ALL
+    {
+        return (channel < NUMBER_OF_TELEMETRY_CHANNELS) ? _channelPeriodMs[channel] : TELEMETRY_PERIOD_OFF;
+    }
+
+    /**
+     * Turn a channel off, on, or limit it's rate
+     */
+    void setChannelPeriod(
+        TelemetryChannel channel,   // IN : channel
+        unsigned int periodMs);     // IN : TELEMETRY_PERIOD_OFF (0) to turn off,
+                                    //      TELEMETRY_PERIOD_ALL (1) to send all messages,
+                                    //      otherwise minimum milliseconds between messages;
+                                    //      only wheel and pose are rate limited, other
+                                    //      channels send all messages unless they are off
+
+    /**
+     * Restore every channel to TELEMETRY_PERIOD_ALL
+     */
+    void resetChannels();
+
+    /**
+     * Get the drop policy of a telemetry channel
+     */
+    TelemetryDropPolicy dropPolicy(TelemetryChannel channel)   // IN : channel
+                                                                // RET: policy used when queue is full
+    {
+        return (channel < NUMBER_OF_TELEMETRY_CHANNELS) ? _dropPolicy[channel] : TELEMETRY_DROP_OLDEST;
+    }
+
+    /**
+     * Choose what happens to a channel's records
+     * when the telemetry queue is full
+     */
+    void setDropPolicy(
+        TelemetryChannel channel,       // IN : channel
+        TelemetryDropPolicy policy)     // IN : TELEMETRY_DROP_OLDEST or TELEMETRY_NEVER_DROP
+    {
+        if(channel < NUMBER_OF_TELEMETRY_CHANNELS) {
+            _dropPolicy[channel] = policy;
+        }
+    }
+
+    /**
+     * Get the number of records dropped on a channel
+     */
+    unsigned long lost(TelemetryChannel channel)    // IN : channel
+                                                    // RET: records dropped since startup
+    {
+        return _queue.lost(channel);
+    }
+
+    /**
+     * Start recording wheel and pose samples
+     */
+    int beginHistory(unsigned int capacity) // IN : number of samples to keep
+                                            // RET: SUCCESS or FAILURE if memory could not be allocated
+    {
+        return _history.begin(capacity);
+    }
+
+    /**
+     * Stream recorded samples on a channel that
+     * are newer than the given time; this replaces
+     * any backlog on that channel that is still
+     * being streamed.
+     */
+    void requestHistory(
+        TelemetryChannel channel,   // IN : TELEMETRY_WHEEL or TELEMETRY_POSE
+        unsigned long sinceMs);     // IN : send samples with at > sinceMs
+
+    /**
+     * Stop streaming all backlogs
+     */
+    void cancelHistory() {
+        for(int channel = 0; channel < NUMBER_OF_TELEMETRY_CHANNELS; channel += 1) {
+            _historyCursor[channel].active = false;
+        }
+    }
 
     /**
      * Determine if listening for and sending telemetry
@@ -46,8 +289,15 @@ class TelemetrySender : Subscriber {
     void detach();
 
     /**
-     * Convert messages into telemetry and
-     * send them to the client via the websocket.
+     * Format captured telemetry for sending
+     * to the client via the websocket.
+     */
+    void send(const TelemetrySnapshot &snapshot);   // IN : captured telemetry
+
+    /**
+     * Capture telemetry messages and format them.
+     * Only listen on the core that runs the rover;
+     * use a TelemetryBridge to send from another core.
      */
     virtual void onMessage(
         Publisher &publisher,       // IN : publisher of message
@@ -56,9 +306,10 @@ class TelemetrySender : Subscriber {
         const char *data);          // IN : message data as a c-cstring
 
     /**
-     * If there is telemetry buffered, then send it
+     * If there is telemetry buffered, then
+     * batch it into a frame and send it
      */
-    void poll();
+    void poll(unsigned long currentMillis); // IN : milliseconds since startup
 };
 
 #endif // TELEMETRY_H
\ No newline at end of file
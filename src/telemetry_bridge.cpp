@@ -0,0 +1,62 @@
+#include "telemetry_bridge.h"
+
+/**
+ * Start capturing telemetry messages
+ */
+TelemetryBridge& TelemetryBridge::attach(MessageBus &messageBus)   // IN : bus on which rover publishes (producer core)
+                                                                    // RET: this bridge in attached state
+{
+    if(!attached()) {
+        _messageBus = &messageBus;
+        for(unsigned int i = 0; i < NUMBER_OF_TELEMETRY_MESSAGES; i += 1) {
+            subscribe(*_messageBus, TelemetryMessages[i]);
+        }
+    }
+    return *this;
+}
+
+/**
+ * Stop capturing telemetry messages
+ */
+TelemetryBridge& TelemetryBridge::detach() // RET: this bridge in detached state
+{
+    if(attached()) {
+        for(unsigned int i = 0; i < NUMBER_OF_TELEMETRY_MESSAGES; i += 1) {
+            unsubscribe(*_messageBus, TelemetryMessages[i]);
+        }
+        _messageBus = nullptr;
+    }
+    return *this;
+}
+
+/**
+ * Capture a telemetry message into the ring.
+ * This is called on the producer core by the bus.
+ */
+void TelemetryBridge::onMessage(
+    Publisher &,                // IN : publisher of message
+    Message message,            // IN : message that was published
+    Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+    const char *data)           // IN : message data as a c-cstring
+{
+    TelemetrySnapshot snapshot;
+    if(captureTelemetry(message, specifier, data, millis(), snapshot)) {
+        _ring.push(snapshot);   // on overflow this is counted in dropped()
+    }
+}
+
+/**
+ * Hand all captured telemetry to the sender.
+ * Call this on the consumer core.
+ */
+int TelemetryBridge::poll(TelemetrySender &telemetry)  // IN : sender that formats the telemetry
+                                                        // RET: number of snapshots sent
+{
+    int count = 0;
+    TelemetrySnapshot snapshot;
+    while(_ring.pop(snapshot)) {
+        telemetry.send(snapshot);
+        count += 1;
+    }
+    return count;
+}
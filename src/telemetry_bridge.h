@@ -0,0 +1,82 @@
+#ifndef TELEMETRY_BRIDGE_H
+#define TELEMETRY_BRIDGE_H
+
+#include "message_bus/message_bus.h"
+#include "util/spsc_ring.h"
+#include "telemetry.h"
+#include "config.h"
+
+/**
+ * Carry telemetry from the core that runs the
+ * rover to the core that sends it to the client.
+ *
+ * The bridge listens for telemetry messages on the
+ * rover's bus and, on the publishing core, captures
+ * the values each message reports into a snapshot
+ * (see captureTelemetry()).  The snapshot is copied into a
+ * single-producer/single-consumer lock-free ring, so
+ * the other core never reads the wheels, the pose or
+ * the goto goal behavior while the rover is updating them.
+ * The other core calls poll(), which hands each snapshot
+ * to the TelemetrySender to be formatted and sent.
+ *
+ * - publish to the bus only from the producer core.
+ * - call poll() only from the consumer core.
+ * - if the ring is full the snapshot is dropped and counted.
+ */
+class TelemetryBridge : public Subscriber {
+    private:
+    MessageBus *_messageBus = nullptr;
+    SpscRing<TelemetrySnapshot, TELEMETRY_BRIDGE_COUNT> _ring;
+
+    public:
+
+    ~TelemetryBridge() {
+        detach();
+    }
+
+    /**
+     * Determine if bus is attached
+     */
+    bool attached() { return nullptr != _messageBus; }
+
+    /**
+     * Start capturing telemetry messages
+     */
+    TelemetryBridge& attach(MessageBus &messageBus);    // IN : bus on which rover publishes (producer core)
+                                                        // RET: this bridge in attached state
+
+    /**
+     * Stop capturing telemetry messages
+     */
+    TelemetryBridge& detach();  // RET: this bridge in detached state
+
+    /**
+     * Capture a telemetry message into the ring.
+     * This is called on the producer core by the bus.
+     */
+    void onMessage(
+        Publisher &publisher,       // IN : publisher of message
+        Message message,            // IN : message that was published
+        Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+        const char *data);          // IN : message data as a c-cstring
+
+    /**
+     * Hand all captured telemetry to the sender.
+     * Call this on the consumer core.
+     */
+    int poll(TelemetrySender &telemetry);   // IN : sender that formats the telemetry
+                                            // RET: number of snapshots sent
+
+    /**
+     * Number of snapshots waiting to be sent
+     */
+    unsigned int pending() { return _ring.count(); }
+
+    /**
+     * Number of snapshots dropped because the ring was full
+     */
+    unsigned int dropped() { return _ring.dropped(); }
+};
+
+#endif // TELEMETRY_BRIDGE_H
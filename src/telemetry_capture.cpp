@@ -0,0 +1,88 @@
+#include "telemetry.h"
+#include "string/strcopy.h"
+#include "wheel/drive_wheel.h"
+#include "rover/rover.h"
+#include "rover/pose.h"
+#include "rover/goto_goal.h"
+#include "rover/path_follow.h"
+
+//
+// Capturing telemetry reads the rover, so it is kept
+// apart from the TelemetrySender, which only formats
+// what was captured and can be built without the rover.
+//
+
+// from main.cpp
+extern TwoWheelRover rover;
+extern DriveWheel leftWheel;
+extern DriveWheel rightWheel;
+extern GotoGoalBehavior gotoGoalBehavior;
+extern PathFollowBehavior pathFollowBehavior;
+
+/**
+ * Capture wheel values for telemetry
+ */
+static WheelTelemetry wheelTelemetry(DriveWheel &driveWheel) // IN : wheel to capture
+                                                            // RET: snapshot of wheel values
+{
+    WheelTelemetry wheel;
+    wheel.wheel = driveWheel.specifier();
+    wheel.forward = driveWheel.forward();
+    wheel.pwm = (uint8_t)driveWheel.pwm();
+    wheel.target = driveWheel.useSpeedControl() ? (float)driveWheel.targetSpeed() : 0;
+    wheel.speed = (float)driveWheel.speed();
+    wheel.distance = (float)driveWheel.distance();
+    wheel.at = driveWheel.lastMs();
+    return wheel;
+}
+
+/**
+ * Capture the values a telemetry message reports.
+ * This reads the rover, so call it on the core
+ * that runs the rover, when the message is published.
+ */
+bool captureTelemetry(
+    Message message,                // IN : message that was published
+    Specifier specifier,            // IN : specifier (like LEFT_WHEEL_SPEC)
+    const char *data,               // IN : message data as a c-cstring
+    unsigned long currentMillis,    // IN : milliseconds since startup
+    TelemetrySnapshot &snapshot)    // OUT: on true, the captured values
+                                    // RET: true if message is telemetry,
+                                    //      false if it is ignored
+{
+    snapshot.message = message;
+    snapshot.specifier = specifier;
+    snapshot.at = currentMillis;
+    snapshot.data[0] = '\0';
+    switch (message) {
+        case LOG_CLIENT:
+        case WHEEL_HALT: {
+            strCopy(snapshot.data, sizeof(snapshot.data), (nullptr != data) ? data : "");
+            return true;
+        }
+        case WHEEL_POWER:
+        case TARGET_SPEED:
+        case SPEED_CONTROL: {
+            snapshot.wheel = wheelTelemetry((LEFT_WHEEL_SPEC == specifier) ? leftWheel : rightWheel);
+            return true;
+        }
+        case ROVER_POSE: {
+            snapshot.pose = {rover.pose(), rover.lastPoseMs(), rover.poseCovariance()};
+            return true;
+        }
+        case GOTO_GOAL: {
+            // a path reports the waypoint it is heading for as it's goal
+            if(PATH_SPEC == specifier) {
+                const GotoGoalState state = pathFollowBehavior.state();
+                snapshot.go2 = {pathFollowBehavior.goal(), (uint8_t)state, GotoGoalStateStr[state], rover.lastPoseMs()};
+            } else {
+                const GotoGoalState state = gotoGoalBehavior.state();
+                snapshot.go2 = {gotoGoalBehavior.goal(), (uint8_t)state, GotoGoalStateStr[state], rover.lastPoseMs()};
+            }
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
@@ -0,0 +1,606 @@
+#include <string.h>
+
+#include "telemetry_format.h"
+#include "string/strcopy.h"
+
+const char *TelemetryChannelNames[NUMBER_OF_TELEMETRY_CHANNELS] = {
+    "wheel",
+    "pose",
+    "goto",
+    "set",
+    "log",
+};
+
+/**
+ * Capture wheel values as a history sample
+ */
+HistoryRecord historyOfWheel(const WheelTelemetry &wheel) // IN : wheel values
+                                                          // RET: history sample
+{
+    HistoryRecord record;
+    record.at = (uint32_t)wheel.at;
+    record.channel = TELEMETRY_WHEEL;
+    record.wheel = (LEFT_WHEEL_SPEC == wheel.wheel) ? 0 : 1;
+    record.forward = wheel.forward ? 1 : 0;
+    record.pwm = wheel.pwm;
+    record.values[0] = wheel.target;
+    record.values[1] = wheel.speed;
+    record.values[2] = wheel.distance;
+    return record;
+}
+
+/**
+ * Capture a pose as a history sample
+ */
+HistoryRecord historyOfPose(const PoseTelemetry &pose) // IN : pose values
+                                                       // RET: history sample
+{
+    HistoryRecord record;
+    record.at = (uint32_t)pose.at;
+    record.channel = TELEMETRY_POSE;
+    record.wheel = 0;
+    record.forward = 0;
+    record.pwm = 0;
+    record.values[0] = (float)pose.pose.x;
+    record.values[1] = (float)pose.pose.y;
+    record.values[2] = (float)pose.pose.angle;
+    return record;
+}
+
+//
+// ---------------- text (wrapped json) format --------------------
+//
+
+int jsonNameAt(char *dest, int destSize, int destIndex, const char *name) {
+    int offset = strCopyAt(dest, destSize, destIndex, "\"");
+    offset = strCopyAt(dest, destSize, offset, name);
+    offset = strCopyAt(dest, destSize, offset, "\":");
+    return offset;
+}
+int jsonBoolAt(char *dest, int destSize, int destIndex, const char *name, bool value) {
+    int offset = jsonNameAt(dest, destSize, destIndex, name);
+    offset = strCopyBoolAt(dest, destSize, offset, value);
+    return offset;
+}
+
+int jsonIntAt(char *dest, int destSize, int destIndex, const char *name, int value) {
+    int offset = jsonNameAt(dest, destSize, destIndex, name);
+    offset = strCopyIntAt(dest, destSize, offset, value);
+    return offset;
+}
+
+int jsonULongAt(char *dest, int destSize, int destIndex, const char *name, unsigned long value) {
+    int offset = jsonNameAt(dest, destSize, destIndex, name);
+    offset = strCopyULongAt(dest, destSize, offset, value);
+    return offset;
+}
+
+int jsonFloatAt(char *dest, int destSize, int destIndex, const char *name, float value) {
+    int offset = jsonNameAt(dest, destSize, destIndex, name);
+    offset = strCopyFloatAt(dest, destSize, offset, value, 6);
+    return offset;
+}
+
+
+int strCopyQuotedAt(char *dest, int destSize, int destIndex, const char *quote, const char * value) {
+    int offset = strCopyAt(dest, destSize, destIndex, quote);
+    offset = strCopyAt(dest, destSize, offset, value);
+    offset = strCopyAt(dest, destSize, offset, quote);
+    return offset;
+}
+
+int jsonStringAt(char *dest, int destSize, int destIndex, const char *name, const char * value) {
+    int offset = jsonNameAt(dest, destSize, destIndex, name);
+    offset = strCopyQuotedAt(dest, destSize, offset, "\"", value);
+    return offset;
+}
+
+
+int jsonOpenObjectAt(char *dest, int destSize, int destIndex, const char *name) {
+    int offset = jsonNameAt(dest, destSize, destIndex, name);
+    offset = strCopyAt(dest, destSize, offset, "{");
+    return offset;
+}
+
+int jsonCloseObjectAt(char *dest, int destSize, int destIndex) {
+    return strCopyAt(dest, destSize, destIndex, "}");
+}
+
+int formatLog(char *buffer, int sizeOfBuffer, const char *src, const char *data) {
+    // log message: to client as wrapped json: like 'log({"src":"left","msg":"stalled"})'
+    int offset = strCopy(buffer, sizeOfBuffer, "log({");
+        offset = jsonStringAt(buffer, sizeOfBuffer, offset, "src", src);
+        offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+        offset = jsonStringAt(buffer, sizeOfBuffer, offset, "msg", data);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
+
+    return offset;
+}
+
+int formatWheelPower(char *buffer, int sizeOfBuffer, const WheelTelemetry &wheel) {
+    // pwm value was set: pwm value to client as wrapped json: like 'set({left:{forward:true,pwm:255}})'
+    int offset = strCopy(buffer, sizeOfBuffer, "set({");
+        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, (LEFT_WHEEL_SPEC == wheel.wheel) ? "left" : "right");
+            offset = jsonBoolAt(buffer, sizeOfBuffer, offset, "forward", wheel.forward);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            offset = jsonIntAt(buffer, sizeOfBuffer, offset, "pwm", wheel.pwm);
+        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
+
+    return offset;
+}
+
+int formatTargetSpeed(char *buffer, int sizeOfBuffer, const WheelTelemetry &wheel) {
+    // target speed was set: pwm value to client as wrapped json: like 'set({left:{target:12.3}})'
+    int offset = strCopy(buffer, sizeOfBuffer, "set({");
+        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, (LEFT_WHEEL_SPEC == wheel.wheel) ? "left" : "right");
+            offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "target", wheel.target);
+        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
+
+    return offset;
+}
+
+int formatSpeedControl(char *buffer, int sizeOfBuffer, const WheelTelemetry &wheel) {
+    // speed control updated: send values to client: like 'tel({left: {forward: true, pwm: 255, target: 12.3, speed: 11.2, distance: 432.1, at:1234567890}})'
+    int offset = strCopy(buffer, sizeOfBuffer, "tel({");
+        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, (LEFT_WHEEL_SPEC == wheel.wheel) ? "left" : "right");
+            // power
+            offset = jsonBoolAt(buffer, sizeOfBuffer, offset, "forward", wheel.forward);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            offset = jsonIntAt(buffer, sizeOfBuffer, offset, "pwm", wheel.pwm);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+
+            // target speed
+            offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "target", wheel.target);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+
+            // measured speed, distance and time of measurement
+            offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "speed", wheel.speed);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "distance", wheel.distance);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            offset = jsonULongAt(buffer, sizeOfBuffer, offset, "at", wheel.at);
+
+        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
+
+    return offset;
+}
+
+/**
+ * copy x, y, angle fields into json object
+ */
+int jsonPose2DFieldsAt(char *buffer, const int sizeOfBuffer, int offset, const Pose2D& pose) {
+    offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "x", (float)pose.x);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+    offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "y", (float)pose.y);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+    offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "a", (float)pose.angle);
+
+    return offset;
+}
+
+/**
+ * copy the upper triangle of a pose covariance
+ * into a json array as [xx, xy, xa, yy, ya, aa]
+ */
+int jsonPoseCovarianceAt(char *buffer, const int sizeOfBuffer, int offset, const char *name, const PoseCovariance& covariance) {
+    offset = jsonNameAt(buffer, sizeOfBuffer, offset, name);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "[");
+    for(int i = 0; i < 3; i += 1) {
+        for(int j = i; j < 3; j += 1) {
+            if((i > 0) || (j > 0)) {
+                offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            }
+            offset = strCopyFloatAt(buffer, sizeOfBuffer, offset, (float)covariance(i, j), 6);
+        }
+    }
+    return strCopyAt(buffer, sizeOfBuffer, offset, "]");
+}
+
+int formatRoverPose(char *buffer, int sizeOfBuffer, const PoseTelemetry &pose) {
+    // pose updated: send values to client: like 'pose({pose: {x: 10.1, y: 4.3, a: 0.53, cov: [0.1, 0, 0.01, 0.2, 0.02, 0.001], at:1234567890}})'
+    int offset = strCopy(buffer, sizeOfBuffer, "pose({");
+        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, "pose");
+            offset = jsonPose2DFieldsAt(buffer, sizeOfBuffer, offset, pose.pose);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            offset = jsonPoseCovarianceAt(buffer, sizeOfBuffer, offset, "cov", pose.covariance);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            offset = jsonULongAt(buffer, sizeOfBuffer, offset, "at", pose.at);
+        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
+
+    return offset;
+}
+
+int formatGotoGoal(char *buffer, const int sizeOfBuffer, const GotoTelemetry &go2) {
+    // goal updated: send values to client: like 'goto({goto: {x: 10.1, y: 4.3, a: 0.53, state: "RUNNING", at:1234567890}})'
+    int offset = strCopy(buffer, sizeOfBuffer, "goto({");
+        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, "goto");
+            offset = jsonPose2DFieldsAt(buffer, sizeOfBuffer, offset, go2.goal);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            offset = jsonStringAt(buffer, sizeOfBuffer, offset, "state", (nullptr != go2.stateName) ? go2.stateName : "");
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            offset = jsonULongAt(buffer, sizeOfBuffer, offset, "at", go2.at);
+        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
+    return offset;
+}
+
+/**
+ * Determine which wheel fields changed
+ */
+uint8_t wheelChangedFields(
+    const WheelTelemetry &last,     // IN : last values sent
+    const WheelTelemetry &next)     // IN : values to send
+                                    // RET: bit mask of WheelTelemetryField
+{
+    uint8_t fields = 0;
+    if(last.forward != next.forward) fields |= WHEEL_FORWARD_FIELD;
+    if(last.pwm != next.pwm) fields |= WHEEL_PWM_FIELD;
+    if(last.target != next.target) fields |= WHEEL_TARGET_FIELD;
+    if(last.speed != next.speed) fields |= WHEEL_SPEED_FIELD;
+    if(last.distance != next.distance) fields |= WHEEL_DISTANCE_FIELD;
+    return fields;
+}
+
+int formatSpeedControlDelta(
+    char *buffer,                   // OUT: receives the text
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const WheelTelemetry &wheel,    // IN : wheel values
+    uint8_t fields,                 // IN : WheelTelemetryField mask of fields to send
+    uint8_t sequence)               // IN : sequence number of this wheel's record
+                                    // RET: index of string terminator or -1 on overflow
+{
+    // changed fields only: like 'tel({"left":{"seq":12,"speed":11.2,"distance":432.1,"at":1234567890}})'
+    // keyframes add '"key":true' and all of the fields
+    int offset = strCopy(buffer, sizeOfBuffer, "tel({");
+        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, (LEFT_WHEEL_SPEC == wheel.wheel) ? "left" : "right");
+            offset = jsonIntAt(buffer, sizeOfBuffer, offset, "seq", sequence);
+            offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            if(fields & WHEEL_KEYFRAME) {
+                offset = jsonBoolAt(buffer, sizeOfBuffer, offset, "key", true);
+                offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            }
+            if(fields & WHEEL_FORWARD_FIELD) {
+                offset = jsonBoolAt(buffer, sizeOfBuffer, offset, "forward", wheel.forward);
+                offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            }
+            if(fields & WHEEL_PWM_FIELD) {
+                offset = jsonIntAt(buffer, sizeOfBuffer, offset, "pwm", wheel.pwm);
+                offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            }
+            if(fields & WHEEL_TARGET_FIELD) {
+                offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "target", wheel.target);
+                offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            }
+            if(fields & WHEEL_SPEED_FIELD) {
+                offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "speed", wheel.speed);
+                offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            }
+            if(fields & WHEEL_DISTANCE_FIELD) {
+                offset = jsonFloatAt(buffer, sizeOfBuffer, offset, "distance", wheel.distance);
+                offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+            }
+            offset = jsonULongAt(buffer, sizeOfBuffer, offset, "at", wheel.at);
+        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
+
+    return offset;
+}
+
+int formatLoss(
+    char *buffer,                   // OUT: receives the text
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const LossTelemetry &loss)      // IN : loss counters and queue depth
+                                    // RET: index of string terminator or -1 on overflow
+{
+    // like 'loss({"lost":{"wheel":3,"pose":1,"goto":0,"set":0,"log":0},"depth":2,"high":8,"sendUs":5230,"at":1234567890})'
+    int offset = strCopy(buffer, sizeOfBuffer, "loss({");
+        offset = jsonOpenObjectAt(buffer, sizeOfBuffer, offset, "lost");
+            for(int channel = 0; channel < NUMBER_OF_TELEMETRY_CHANNELS; channel += 1) {
+                if(channel > 0) {
+                    offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+                }
+                offset = jsonULongAt(buffer, sizeOfBuffer, offset, TelemetryChannelNames[channel], loss.lost[channel]);
+            }
+        offset = jsonCloseObjectAt(buffer, sizeOfBuffer, offset);
+        offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+        offset = jsonIntAt(buffer, sizeOfBuffer, offset, "depth", loss.depth);
+        offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+        offset = jsonIntAt(buffer, sizeOfBuffer, offset, "high", loss.highWater);
+        offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+        offset = jsonULongAt(buffer, sizeOfBuffer, offset, "sendUs", loss.sendUs);
+        offset = strCopyAt(buffer, sizeOfBuffer, offset, ",");
+        offset = jsonULongAt(buffer, sizeOfBuffer, offset, "at", loss.at);
+    offset = strCopyAt(buffer, sizeOfBuffer, offset, "})");
+
+    return offset;
+}
+
+//
+// ---------------- binary format --------------------
+//
+// Every record starts with a one byte TelemetryRecordType.
+// Multi-byte values are little-endian and are written
+// a byte at a time so the layout does not depend
+// on the host's byte order or struct packing.
+// Floats are IEEE-754 single precision.
+//
+
+static inline int packU8At(uint8_t *buffer, int offset, uint8_t value) {
+    buffer[offset] = value;
+    return offset + 1;
+}
+
+static inline int packU32At(uint8_t *buffer, int offset, uint32_t value) {
+    buffer[offset] = (uint8_t)(value);
+    buffer[offset + 1] = (uint8_t)(value >> 8);
+    buffer[offset + 2] = (uint8_t)(value >> 16);
+    buffer[offset + 3] = (uint8_t)(value >> 24);
+    return offset + 4;
+}
+
+static inline int packFloatAt(uint8_t *buffer, int offset, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return packU32At(buffer, offset, bits);
+}
+
+static inline int packPose2DAt(uint8_t *buffer, int offset, const Pose2D &pose) {
+    offset = packFloatAt(buffer, offset, (float)pose.x);
+    offset = packFloatAt(buffer, offset, (float)pose.y);
+    return packFloatAt(buffer, offset, (float)pose.angle);
+}
+
+/**
+ * wheel byte: 0 is left, 1 is right
+ */
+static inline uint8_t wheelByte(const WheelTelemetry &wheel) {
+    return (LEFT_WHEEL_SPEC == wheel.wheel) ? 0 : 1;
+}
+
+int packLog(
+    uint8_t *buffer,        // OUT: receives the record
+    int sizeOfBuffer,       // IN : size of buffer in bytes
+    const char *src,        // IN : source of log message as a c-string
+    const char *data)       // IN : log message as a c-string
+                            // RET: bytes written or -1 if buffer too small
+{
+    // [type][srcLength][msgLength][src bytes][msg bytes]; strings are not terminated
+    const int srcLength = (nullptr != src) ? (int)strlen(src) : 0;
+    const int msgLength = (nullptr != data) ? (int)strlen(data) : 0;
+    if((srcLength > 255) || (msgLength > 255)) return -1;
+    if(sizeOfBuffer < TELEMETRY_LOG_HEADER_BYTES + srcLength + msgLength) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_LOG);
+    offset = packU8At(buffer, offset, (uint8_t)srcLength);
+    offset = packU8At(buffer, offset, (uint8_t)msgLength);
+    memcpy(buffer + offset, src, srcLength);
+    offset += srcLength;
+    memcpy(buffer + offset, data, msgLength);
+    return offset + msgLength;
+}
+
+int packWheelPower(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const WheelTelemetry &wheel)    // IN : wheel values
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][wheel][flags][pwm]
+    if(sizeOfBuffer < TELEMETRY_WHEEL_POWER_BYTES) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_WHEEL_POWER);
+    offset = packU8At(buffer, offset, wheelByte(wheel));
+    offset = packU8At(buffer, offset, wheel.forward ? 1 : 0);
+    return packU8At(buffer, offset, wheel.pwm);
+}
+
+int packTargetSpeed(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const WheelTelemetry &wheel)    // IN : wheel values
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][wheel][pad][pad][target:f32]
+    if(sizeOfBuffer < TELEMETRY_TARGET_SPEED_BYTES) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_TARGET_SPEED);
+    offset = packU8At(buffer, offset, wheelByte(wheel));
+    offset = packU8At(buffer, offset, 0);
+    offset = packU8At(buffer, offset, 0);
+    return packFloatAt(buffer, offset, wheel.target);
+}
+
+int packSpeedControl(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const WheelTelemetry &wheel)    // IN : wheel values
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][wheel][flags][pwm][target:f32][speed:f32][distance:f32][at:u32]
+    if(sizeOfBuffer < TELEMETRY_WHEEL_BYTES) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_WHEEL);
+    offset = packU8At(buffer, offset, wheelByte(wheel));
+    offset = packU8At(buffer, offset, wheel.forward ? 1 : 0);
+    offset = packU8At(buffer, offset, wheel.pwm);
+    offset = packFloatAt(buffer, offset, wheel.target);
+    offset = packFloatAt(buffer, offset, wheel.speed);
+    offset = packFloatAt(buffer, offset, wheel.distance);
+    return packU32At(buffer, offset, (uint32_t)wheel.at);
+}
+
+int packRoverPose(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const PoseTelemetry &pose)      // IN : pose values
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][pad][pad][pad][x:f32][y:f32][angle:f32][at:u32][xx:f32][xy:f32][xa:f32][yy:f32][ya:f32][aa:f32]
+    if(sizeOfBuffer < TELEMETRY_POSE_BYTES) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_POSE);
+    offset = packU8At(buffer, offset, 0);
+    offset = packU8At(buffer, offset, 0);
+    offset = packU8At(buffer, offset, 0);
+    offset = packPose2DAt(buffer, offset, pose.pose);
+    offset = packU32At(buffer, offset, (uint32_t)pose.at);
+
+    // upper triangle of the symmetric covariance
+    for(int i = 0; i < 3; i += 1) {
+        for(int j = i; j < 3; j += 1) {
+            offset = packFloatAt(buffer, offset, (float)pose.covariance(i, j));
+        }
+    }
+    return offset;
+}
+
+int packGotoGoal(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const GotoTelemetry &go2)       // IN : goto goal values
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][state][pad][pad][x:f32][y:f32][angle:f32][at:u32]
+    if(sizeOfBuffer < TELEMETRY_GOTO_BYTES) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_GOTO);
+    offset = packU8At(buffer, offset, go2.state);
+    offset = packU8At(buffer, offset, 0);
+    offset = packU8At(buffer, offset, 0);
+    offset = packPose2DAt(buffer, offset, go2.goal);
+    return packU32At(buffer, offset, (uint32_t)go2.at);
+}
+
+int packSpeedControlDelta(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const WheelTelemetry &wheel,    // IN : wheel values
+    uint8_t fields,                 // IN : WheelTelemetryField mask of fields to send
+    uint8_t sequence)               // IN : sequence number of this wheel's record
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][wheel][fields][sequence][forward:u8]?[pwm:u8]?[target:f32]?[speed:f32]?[distance:f32]?[at:u32]
+    // where each optional field is present only if it's bit is set in fields
+    if(sizeOfBuffer < TELEMETRY_WHEEL_DELTA_MAX_BYTES) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_WHEEL_DELTA);
+    offset = packU8At(buffer, offset, wheelByte(wheel));
+    offset = packU8At(buffer, offset, fields);
+    offset = packU8At(buffer, offset, sequence);
+    if(fields & WHEEL_FORWARD_FIELD) offset = packU8At(buffer, offset, wheel.forward ? 1 : 0);
+    if(fields & WHEEL_PWM_FIELD) offset = packU8At(buffer, offset, wheel.pwm);
+    if(fields & WHEEL_TARGET_FIELD) offset = packFloatAt(buffer, offset, wheel.target);
+    if(fields & WHEEL_SPEED_FIELD) offset = packFloatAt(buffer, offset, wheel.speed);
+    if(fields & WHEEL_DISTANCE_FIELD) offset = packFloatAt(buffer, offset, wheel.distance);
+    return packU32At(buffer, offset, (uint32_t)wheel.at);
+}
+
+int packLoss(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const LossTelemetry &loss)      // IN : loss counters and queue depth
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][channels][depth][highWater][lost:u32 * channels][sendUs:u32][at:u32]
+    if(sizeOfBuffer < TELEMETRY_LOSS_BYTES) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_LOSS);
+    offset = packU8At(buffer, offset, NUMBER_OF_TELEMETRY_CHANNELS);
+    offset = packU8At(buffer, offset, loss.depth);
+    offset = packU8At(buffer, offset, loss.highWater);
+    for(int channel = 0; channel < NUMBER_OF_TELEMETRY_CHANNELS; channel += 1) {
+        offset = packU32At(buffer, offset, (uint32_t)loss.lost[channel]);
+    }
+    offset = packU32At(buffer, offset, (uint32_t)loss.sendUs);
+    return packU32At(buffer, offset, (uint32_t)loss.at);
+}
+
+int packHistoryHeader(
+    uint8_t *buffer,                // OUT: receives the header
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    TelemetryChannel channel,       // IN : channel of the records that follow
+    uint8_t flags,                  // IN : TELEMETRY_HISTORY_LAST if last chunk of backlog
+    uint8_t count)                  // IN : number of history records that follow
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][channel][flags][count]; count records follow
+    if(sizeOfBuffer < TELEMETRY_HISTORY_HEADER_BYTES) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_HISTORY);
+    offset = packU8At(buffer, offset, (uint8_t)channel);
+    offset = packU8At(buffer, offset, flags);
+    return packU8At(buffer, offset, count);
+}
+
+int packHistoryRecord(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const HistoryRecord &record)    // IN : history sample
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [at:u32][wheel][forward][pwm][pad][value:f32 * 3]
+    if(sizeOfBuffer < TELEMETRY_HISTORY_RECORD_BYTES) return -1;
+
+    int offset = packU32At(buffer, 0, record.at);
+    offset = packU8At(buffer, offset, record.wheel);
+    offset = packU8At(buffer, offset, record.forward);
+    offset = packU8At(buffer, offset, record.pwm);
+    offset = packU8At(buffer, offset, 0);
+    offset = packFloatAt(buffer, offset, record.values[0]);
+    offset = packFloatAt(buffer, offset, record.values[1]);
+    return packFloatAt(buffer, offset, record.values[2]);
+}
+
+int packTokenLog(
+    uint8_t *buffer,                // OUT: receives the record
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const TokenLogRecord &record)   // IN : tokenized log record
+                                    // RET: bytes written or -1 if buffer too small
+{
+    // [type][level][token:u16][at:u32][argc][arg:u32 * argc]
+    const int argc = (record.argc <= TOKEN_LOG_ARGS) ? record.argc : TOKEN_LOG_ARGS;
+    if(sizeOfBuffer < TELEMETRY_TOKEN_LOG_HEADER_BYTES + 4 * argc) return -1;
+
+    int offset = packU8At(buffer, 0, TELEMETRY_RECORD_TOKEN_LOG);
+    offset = packU8At(buffer, offset, record.level);
+    offset = packU8At(buffer, offset, (uint8_t)record.token);
+    offset = packU8At(buffer, offset, (uint8_t)(record.token >> 8));
+    offset = packU32At(buffer, offset, record.at);
+    offset = packU8At(buffer, offset, (uint8_t)argc);
+    for(int i = 0; i < argc; i += 1) {
+        offset = packU32At(buffer, offset, record.args[i]);
+    }
+    return offset;
+}
+
+//
+// ---------------- frames --------------------
+//
+
+/**
+ * Append a formatted record to a telemetry frame.
+ */
+int appendToFrame(
+    uint8_t *frame,             // IN : frame buffer
+                                // OUT: record appended if it fits
+    int sizeOfFrame,            // IN : size of frame buffer in bytes
+    int frameLength,            // IN : bytes already in frame
+    const uint8_t *record,      // IN : record to append
+    int recordLength,           // IN : bytes in record
+    bool binary)                // IN : true if record is binary, false if text
+                                // RET: new frame length or -1 if record does not fit
+{
+    const int separator = (!binary && (frameLength > 0)) ? 1 : 0;
+    if((frameLength < 0) || (recordLength < 0) || (frameLength + separator + recordLength > sizeOfFrame)) {
+        return -1;
+    }
+    if(separator) {
+        frame[frameLength++] = TELEMETRY_TEXT_SEPARATOR;
+    }
+    memcpy(frame + frameLength, record, recordLength);
+    return frameLength + recordLength;
+}
@@ -0,0 +1,230 @@
+#ifndef TELEMETRY_FORMAT_H
+#define TELEMETRY_FORMAT_H
+
+#include <stdint.h>
+
+#include "message_bus/messages.h"
+#include "rover/pose.h"
+#include "token_log.h"
+
+//
+// Telemetry is captured as a snapshot of the values
+// at the time of the message, then formatted
+// into either text or binary for sending to the client.
+//
+
+typedef enum TelemetryFormat {
+    TELEMETRY_TEXT = 0,     // json wrapped in a call, like 'tel({...})'
+    TELEMETRY_BINARY,       // fixed layout little-endian records
+} TelemetryFormat;
+
+//
+// telemetry channels; each can be turned off
+// or limited to a rate by the client.
+//
+typedef enum TelemetryChannel {
+    TELEMETRY_WHEEL = 0,    // 'tel'; SPEED_CONTROL
+    TELEMETRY_POSE,         // 'pose'; ROVER_POSE
+    TELEMETRY_GOTO,         // 'goto'; GOTO_GOAL
+    TELEMETRY_SET,          // 'set'; WHEEL_POWER and TARGET_SPEED
+    TELEMETRY_LOG,          // 'log'; LOG_CLIENT and WHEEL_HALT
+    NUMBER_OF_TELEMETRY_CHANNELS    // THIS SHOULD ALWAYS BE LAST
+} TelemetryChannel;
+
+//
+// array of strings that correspond to channel numbers
+//
+extern const char *TelemetryChannelNames[NUMBER_OF_TELEMETRY_CHANNELS];
+
+//
+// channel periods in milliseconds
+//
+const unsigned int TELEMETRY_PERIOD_OFF = 0;    // send nothing on the channel
+const unsigned int TELEMETRY_PERIOD_ALL = 1;    // send every message on the channel
+
+//
+// values for one wheel
+//
+typedef struct WheelTelemetry {
+    Specifier wheel;        // LEFT_WHEEL_SPEC or RIGHT_WHEEL_SPEC
+    bool forward;           // direction of motor
+    uint8_t pwm;            // motor pwm value
+    float target;           // target speed, or zero if not using speed control
+    float speed;            // measured speed
+    float distance;         // measured distance
+    unsigned long at;       // time of measurement in ms
+} WheelTelemetry;
+
+//
+// rover pose
+//
+typedef struct PoseTelemetry {
+    Pose2D pose;            // position and orientation
+    unsigned long at;       // time of pose in ms
+    PoseCovariance covariance;  // uncertainty of pose
+} PoseTelemetry;
+
+//
+// goto goal behavior state
+//
+typedef struct GotoTelemetry {
+    Pose2D goal;            // goal position
+    uint8_t state;          // GotoGoalState
+    const char *stateName;  // GotoGoalStateStr[state]
+    unsigned long at;       // time of last pose in ms
+} GotoTelemetry;
+
+//
+// values of a bus message captured for telemetry.
+// These are taken when the message is published,
+// on the core that published it, so telemetry
+// can be formatted later, or on another core,
+// without reading the rover while it is running.
+//
+const unsigned int TELEMETRY_SNAPSHOT_DATA_BYTES = 32;  // max bytes of log text, including terminator
+
+typedef struct TelemetrySnapshot {
+    Message message;        // message that was published
+    Specifier specifier;    // specifier of message
+    unsigned long at;       // time message was published in ms
+    union {
+        WheelTelemetry wheel;   // WHEEL_POWER, TARGET_SPEED, SPEED_CONTROL
+        PoseTelemetry pose;     // ROVER_POSE
+        GotoTelemetry go2;      // GOTO_GOAL
+    };
+    char data[TELEMETRY_SNAPSHOT_DATA_BYTES];   // LOG_CLIENT, WHEEL_HALT; message data
+} TelemetrySnapshot;
+
+//
+// telemetry queue health; records dropped on each
+// channel and how backed up sending has been.
+//
+typedef struct LossTelemetry {
+    unsigned long lost[NUMBER_OF_TELEMETRY_CHANNELS];   // records dropped per channel since startup
+    uint8_t depth;          // records waiting to be sent
+    uint8_t highWater;      // most records waiting since last report
+    unsigned long sendUs;   // longest websocket send since last report, in microseconds
+    unsigned long at;       // time of report in ms
+} LossTelemetry;
+
+//
+// compact fixed size sample kept in the telemetry history.
+//
+typedef struct HistoryRecord {
+    uint32_t at;            // time of sample in ms
+    uint8_t channel;        // TELEMETRY_WHEEL or TELEMETRY_POSE
+    uint8_t wheel;          // wheel: 0 is left, 1 is right; pose: 0
+    uint8_t forward;        // wheel: 1 if forward, 0 if reverse
+    uint8_t pwm;            // wheel: motor pwm value
+    float values[3];        // wheel: target, speed, distance; pose: x, y, angle
+} HistoryRecord;
+
+HistoryRecord historyOfWheel(const WheelTelemetry &wheel);
+HistoryRecord historyOfPose(const PoseTelemetry &pose);
+
+//
+// binary record types; first byte of every binary record.
+//
+typedef enum TelemetryRecordType {
+    TELEMETRY_RECORD_NONE = 0,
+    TELEMETRY_RECORD_WHEEL,         // 'tel'; wheel speed control update
+    TELEMETRY_RECORD_WHEEL_POWER,   // 'set'; wheel forward and pwm
+    TELEMETRY_RECORD_TARGET_SPEED,  // 'set'; wheel target speed
+    TELEMETRY_RECORD_POSE,          // 'pose'; rover pose
+    TELEMETRY_RECORD_GOTO,          // 'goto'; goto goal state
+    TELEMETRY_RECORD_LOG,           // 'log'; source and message strings
+    TELEMETRY_RECORD_WHEEL_DELTA,   // 'tel'; changed wheel fields only
+    TELEMETRY_RECORD_LOSS,          // 'loss'; dropped records and queue depth
+    TELEMETRY_RECORD_HISTORY,       // 'history'; a chunk of recorded wheel or pose samples
+    TELEMETRY_RECORD_TOKEN_LOG,     // 'log'; tokenized log record, formatted by the client
+} TelemetryRecordType;
+
+//
+// sizes of the fixed layout binary records in bytes
+//
+const int TELEMETRY_WHEEL_BYTES = 20;           // type, wheel, flags, pwm, target, speed, distance, at
+const int TELEMETRY_WHEEL_POWER_BYTES = 4;      // type, wheel, flags, pwm
+const int TELEMETRY_TARGET_SPEED_BYTES = 8;     // type, wheel, 2 pad, target
+const int TELEMETRY_POSE_BYTES = 44;            // type, 3 pad, x, y, angle, at, xx, xy, xa, yy, ya, aa
+const int TELEMETRY_GOTO_BYTES = 20;            // type, state, 2 pad, x, y, angle, at
+const int TELEMETRY_LOG_HEADER_BYTES = 3;       // type, source length, message length; strings follow
+const int TELEMETRY_WHEEL_DELTA_MAX_BYTES = 22; // type, wheel, fields, sequence, then changed fields and at
+const int TELEMETRY_LOSS_BYTES = 4 + 4 * NUMBER_OF_TELEMETRY_CHANNELS + 8;  // type, channels, depth, high water, lost per channel, sendUs, at
+const int TELEMETRY_HISTORY_HEADER_BYTES = 4;   // type, channel, flags, count; count history records follow
+const int TELEMETRY_HISTORY_RECORD_BYTES = 20;  // at, wheel, forward, pwm, pad, 3 values
+const uint8_t TELEMETRY_HISTORY_LAST = 0x01;    // history flag; last chunk of the backlog
+const int TELEMETRY_TOKEN_LOG_HEADER_BYTES = 9; // type, level, token, at, argc; argc 32 bit arguments follow
+
+//
+// Delta encoding of wheel telemetry.
+// A delta record carries only the fields that
+// changed since the last record sent for that wheel,
+// along with a sequence number and the time.
+// A keyframe carries all of the fields, so the
+// client can start from it or recover from a gap.
+//
+typedef enum WheelTelemetryField {
+    WHEEL_FORWARD_FIELD = 0x01,
+    WHEEL_PWM_FIELD = 0x02,
+    WHEEL_TARGET_FIELD = 0x04,
+    WHEEL_SPEED_FIELD = 0x08,
+    WHEEL_DISTANCE_FIELD = 0x10,
+    WHEEL_ALL_FIELDS = 0x1F,
+    WHEEL_KEYFRAME = 0x80,      // set if record is a keyframe
+} WheelTelemetryField;
+
+/**
+ * Determine which wheel fields changed
+ */
+uint8_t wheelChangedFields(
+    const WheelTelemetry &last,     // IN : last values sent
+    const WheelTelemetry &next);    // IN : values to send
+                                    // RET: bit mask of WheelTelemetryField
+
+//
+// text formats; each returns the index of the string terminator,
+// or -1 if the buffer was too small.
+//
+int formatLog(char *buffer, int sizeOfBuffer, const char *src, const char *data);
+int formatWheelPower(char *buffer, int sizeOfBuffer, const WheelTelemetry &wheel);
+int formatTargetSpeed(char *buffer, int sizeOfBuffer, const WheelTelemetry &wheel);
+int formatSpeedControl(char *buffer, int sizeOfBuffer, const WheelTelemetry &wheel);
+int formatRoverPose(char *buffer, int sizeOfBuffer, const PoseTelemetry &pose);
+int formatGotoGoal(char *buffer, int sizeOfBuffer, const GotoTelemetry &go2);
+int formatSpeedControlDelta(char *buffer, int sizeOfBuffer, const WheelTelemetry &wheel, uint8_t fields, uint8_t sequence);
+int formatLoss(char *buffer, int sizeOfBuffer, const LossTelemetry &loss);
+
+//
+// binary formats; each returns the number of bytes written,
+// or -1 if the buffer was too small.
+//
+int packLog(uint8_t *buffer, int sizeOfBuffer, const char *src, const char *data);
+int packWheelPower(uint8_t *buffer, int sizeOfBuffer, const WheelTelemetry &wheel);
+int packTargetSpeed(uint8_t *buffer, int sizeOfBuffer, const WheelTelemetry &wheel);
+int packSpeedControl(uint8_t *buffer, int sizeOfBuffer, const WheelTelemetry &wheel);
+int packRoverPose(uint8_t *buffer, int sizeOfBuffer, const PoseTelemetry &pose);
+int packGotoGoal(uint8_t *buffer, int sizeOfBuffer, const GotoTelemetry &go2);
+int packSpeedControlDelta(uint8_t *buffer, int sizeOfBuffer, const WheelTelemetry &wheel, uint8_t fields, uint8_t sequence);
+int packLoss(uint8_t *buffer, int sizeOfBuffer, const LossTelemetry &loss);
+int packHistoryHeader(uint8_t *buffer, int sizeOfBuffer, TelemetryChannel channel, uint8_t flags, uint8_t count);
+int packHistoryRecord(uint8_t *buffer, int sizeOfBuffer, const HistoryRecord &record);
+int packTokenLog(uint8_t *buffer, int sizeOfBuffer, const TokenLogRecord &record);
+
+//
+// Telemetry records are batched into frames;
+// binary records are simply concatenated,
+// text records are separated by a newline.
+//
+const char TELEMETRY_TEXT_SEPARATOR = '\n';
+
+int appendToFrame(
+    uint8_t *frame,             // IN : frame buffer
+                                // OUT: record appended if it fits
+    int sizeOfFrame,            // IN : size of frame buffer in bytes
+    int frameLength,            // IN : bytes already in frame
+    const uint8_t *record,      // IN : record to append
+    int recordLength,           // IN : bytes in record
+    bool binary);               // IN : true if record is binary, false if text
+                                // RET: new frame length or -1 if record does not fit
+
+#endif // TELEMETRY_FORMAT_H
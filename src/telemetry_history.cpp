@@ -0,0 +1,93 @@
+#include <stdlib.h>
+#include <assert.h>
+
+#include "telemetry_history.h"
+#include "error.h"
+
+TelemetryHistory::~TelemetryHistory() {
+    free(_records);
+}
+
+/**
+ * Allocate the ring; PSRAM is used if the board has it,
+ * otherwise internal RAM.
+ */
+int TelemetryHistory::begin(unsigned int capacity)  // IN : number of records to keep
+                                                    // RET: SUCCESS or FAILURE if memory could not be allocated
+{
+    free(_records);
+    _records = nullptr;
+    _capacity = 0;
+    _sequence = 0;
+
+    if(0 == capacity) {
+        return FAILURE;
+    }
+
+    #ifdef TESTING
+        _records = (HistoryRecord *)malloc(capacity * sizeof(HistoryRecord));
+    #else
+        _records = (HistoryRecord *)(psramFound()
+            ? ps_malloc(capacity * sizeof(HistoryRecord))
+            : malloc(capacity * sizeof(HistoryRecord)));
+    #endif
+    if(nullptr == _records) {
+        return FAILURE;
+    }
+
+    _capacity = capacity;
+    return SUCCESS;
+}
+
+/**
+ * Add a sample, overwriting the oldest if the ring is full.
+ * Samples must be appended in time order.
+ */
+void TelemetryHistory::append(const HistoryRecord &record) // IN : sample to keep
+{
+    if(ready()) {
+        // find() binary searches by time
+        assert((0 == count()) || (_records[(_sequence - 1) % _capacity].at <= record.at));
+
+        _records[_sequence % _capacity] = record;
+        _sequence += 1;
+    }
+}
+
+/**
+ * Find the first record after a time
+ * using a binary search of the kept records.
+ */
+unsigned long TelemetryHistory::find(unsigned long sinceMs) // IN : time in ms
+                                                            // RET: sequence number of the first
+                                                            //      record with at > sinceMs, or
+                                                            //      sequence() if there is none
+{
+    unsigned long low = oldest();
+    unsigned long high = _sequence;
+    while(low < high) {
+        const unsigned long middle = low + (high - low) / 2;
+        if(_records[middle % _capacity].at <= sinceMs) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+/**
+ * Read a record by sequence number
+ */
+bool TelemetryHistory::read(
+    unsigned long sequence,     // IN : sequence number of record
+    HistoryRecord &record)      // OUT: on true, the record
+                                // RET: true if read,
+                                //      false if overwritten or not yet written
+{
+    if((sequence < oldest()) || (sequence >= _sequence)) {
+        return false;
+    }
+    record = _records[sequence % _capacity];
+    return true;
+}
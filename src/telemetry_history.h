@@ -0,0 +1,94 @@
+#ifndef TELEMETRY_HISTORY_H
+#define TELEMETRY_HISTORY_H
+
+#include "telemetry_format.h"
+
+/**
+ * Time ordered ring of wheel and pose samples,
+ * kept in PSRAM when the board has it, so a client
+ * that reconnects, or whose tab was in the background,
+ * can backfill the gap in one transfer.
+ *
+ * Every appended record gets the next sequence number;
+ * the ring keeps the most recent capacity() records, so
+ * a sequence number refers to the same record until it
+ * is overwritten.  Readers hold sequence numbers rather
+ * than indices so they can detect that.
+ *
+ * Wheel and pose records are interleaved in the ring.
+ * Each is stamped with the time of the rover poll that
+ * published it, and they are appended in the order they
+ * are published (the bridge between cores keeps that
+ * order), so times never decrease from one record to the
+ * next, whatever the channel.  find() depends on that
+ * to binary search for a start time, and append()
+ * asserts it.
+ */
+class TelemetryHistory {
+    private:
+    HistoryRecord *_records = nullptr;  // ring of samples
+    unsigned int _capacity = 0;         // number of records in ring
+    unsigned long _sequence = 0;        // sequence number of next record to append
+
+    public:
+
+    ~TelemetryHistory();
+
+    /**
+     * Allocate the ring; PSRAM is used if the board has it.
+     */
+    int begin(unsigned int capacity);   // IN : number of records to keep
+                                        // RET: SUCCESS or FAILURE if memory could not be allocated
+
+    /**
+     * Determine if history is being kept
+     */
+    bool ready() { return nullptr != _records; }
+
+    /**
+     * Get the number of records the ring can keep
+     */
+    unsigned int capacity() { return _capacity; }
+
+    /**
+     * Get the number of records being kept
+     */
+    unsigned int count()    // RET: number of readable records
+    {
+        return (_sequence < _capacity) ? (unsigned int)_sequence : _capacity;
+    }
+
+    /**
+     * Get the sequence number the next record will get
+     */
+    unsigned long sequence() { return _sequence; }
+
+    /**
+     * Get the sequence number of the oldest record kept
+     */
+    unsigned long oldest() { return _sequence - count(); }
+
+    /**
+     * Add a sample, overwriting the oldest if the ring is full
+     */
+    void append(const HistoryRecord &record);   // IN : sample to keep
+
+    /**
+     * Find the first record after a time
+     */
+    unsigned long find(unsigned long sinceMs);  // IN : time in ms
+                                                // RET: sequence number of the first
+                                                //      record with at > sinceMs, or
+                                                //      sequence() if there is none
+
+    /**
+     * Read a record by sequence number
+     */
+    bool read(
+        unsigned long sequence,     // IN : sequence number of record
+        HistoryRecord &record);     // OUT: on true, the record
+                                    // RET: true if read,
+                                    //      false if overwritten or not yet written
+};
+
+#endif // TELEMETRY_HISTORY_H
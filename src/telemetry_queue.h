@@ -0,0 +1,235 @@
+#ifndef TELEMETRY_QUEUE_H
+#define TELEMETRY_QUEUE_H
+
+#include <stdint.h>
+
+#include "telemetry_format.h"
+
+//
+// What to do with a telemetry record when the queue is full.
+//
+typedef enum TelemetryDropPolicy {
+    TELEMETRY_DROP_OLDEST = 0,  // periodic samples; a newer sample replaces the oldest queued sample
+    TELEMETRY_NEVER_DROP,       // state changes; replaces a queued periodic sample rather than being dropped
+} TelemetryDropPolicy;
+
+/**
+ * Bounded queue of formatted telemetry records.
+ *
+ * Records are written in place into one of COUNT
+ * fixed size slots, then sent in the order they
+ * were queued.  When every slot is full a new record
+ * takes the slot of the oldest queued TELEMETRY_DROP_OLDEST
+ * record, preferring one on it's own channel, so
+ * periodic samples stay fresh and state changes,
+ * like a halt, are not lost behind them.
+ * If every queued record is TELEMETRY_NEVER_DROP then
+ * the new record is dropped.
+ *
+ * Every record that is dropped, whether evicted
+ * or turned away, is counted against it's channel.
+ *
+ * Slots never move; only the one byte slot indices
+ * are shifted when a record is evicted from the middle
+ * of the queue.
+ */
+template <unsigned int COUNT, unsigned int BYTES> class TelemetryQueue {
+    static_assert((COUNT > 0) && (COUNT <= 255), "COUNT must fit in a byte");
+
+    private:
+    uint8_t _buffer[COUNT][BYTES];
+    int _length[COUNT];                 // bytes in each slot; zero if empty
+    bool _binary[COUNT];                // true if slot holds a binary record
+    TelemetryChannel _channel[COUNT];   // channel of record in each slot
+    TelemetryDropPolicy _policy[COUNT]; // drop policy of record in each slot
+
+    uint8_t _order[COUNT];      // queued slots, oldest first
+    unsigned int _count = 0;    // number of queued slots
+    uint8_t _free[COUNT];       // slots that are not queued
+    unsigned int _freeCount = COUNT;
+    int _reserved = -1;         // slot last returned by reserve()
+
+    unsigned long _lost[NUMBER_OF_TELEMETRY_CHANNELS] = {};  // dropped records by channel
+    unsigned int _highWater = 0;    // most records queued since resetHighWater()
+
+    /**
+     * Find oldest queued record that may be dropped
+     */
+    int _findDroppable(TelemetryChannel channel)    // IN : channel to prefer
+                                                    // RET: position in queue or -1 if none
+    {
+        int any = -1;
+        for(unsigned int i = 0; i < _count; i += 1) {
+            const uint8_t slot = _order[i];
+            if(TELEMETRY_DROP_OLDEST == _policy[slot]) {
+                if(channel == _channel[slot]) {
+                    return i;
+                }
+                if(any < 0) {
+                    any = i;
+                }
+            }
+        }
+        return any;
+    }
+
+    public:
+
+    TelemetryQueue() {
+        for(unsigned int i = 0; i < COUNT; i += 1) {
+            _length[i] = 0;
+            _binary[i] = false;
+            _channel[i] = TELEMETRY_LOG;
+            _policy[i] = TELEMETRY_NEVER_DROP;
+            _free[i] = (uint8_t)(COUNT - 1 - i);
+        }
+    }
+
+    /**
+     * Get the total number of slots
+     */
+    unsigned int capacity() // RET: COUNT
+    {
+        return COUNT;
+    }
+
+    /**
+     * Get the size of a slot
+     */
+    unsigned int recordBytes()  // RET: BYTES
+    {
+        return BYTES;
+    }
+
+    /**
+     * Get the number of queued records
+     */
+    unsigned int count()    // RET: number of queued records
+    {
+        return _count;
+    }
+
+    /**
+     * Get the most records queued at once since the last
+     * call to resetHighWater()
+     */
+    unsigned int highWater()    // RET: queue depth high water mark
+    {
+        return _highWater;
+    }
+
+    /**
+     * Start measuring the high water mark from the current depth
+     */
+    void resetHighWater() {
+        _highWater = _count;
+    }
+
+    /**
+     * Get the number of records dropped on a channel
+     */
+    unsigned long lost(TelemetryChannel channel)    // IN : channel
+                                                    // RET: records dropped since construction
+    {
+        return (channel < NUMBER_OF_TELEMETRY_CHANNELS) ? _lost[channel] : 0;
+    }
+
+    /**
+     * Get a slot to format a record into.
+     * The record is queued with no content;
+     * call commit() once it is formatted.
+     */
+    uint8_t *reserve(
+        TelemetryChannel channel,       // IN : channel of the record
+        TelemetryDropPolicy policy,     // IN : what to do if the queue fills
+        bool binary)                    // IN : true if record will be binary
+                                        // RET: BYTES sized slot or
+                                        //      nullptr if the record was dropped
+    {
+        int slot;
+        if(_freeCount > 0) {
+            slot = _free[--_freeCount];
+        } else {
+            const int position = _findDroppable(channel);
+            if(position < 0) {
+                // everything queued must be kept, so drop this one
+                if(channel < NUMBER_OF_TELEMETRY_CHANNELS) {
+                    _lost[channel] += 1;
+                }
+                _reserved = -1;
+                return nullptr;
+            }
+
+            // evict the oldest periodic sample
+            slot = _order[position];
+            _lost[_channel[slot]] += 1;
+            for(unsigned int i = position + 1; i < _count; i += 1) {
+                _order[i - 1] = _order[i];
+            }
+            _count -= 1;
+        }
+
+        _length[slot] = 0;
+        _binary[slot] = binary;
+        _channel[slot] = channel;
+        _policy[slot] = policy;
+        _order[_count++] = (uint8_t)slot;
+        if(_count > _highWater) {
+            _highWater = _count;
+        }
+
+        _reserved = slot;
+        return _buffer[slot];
+    }
+
+    /**
+     * Set the length of the record formatted into
+     * the slot last returned by reserve().
+     * A length less than one (a formatting failure)
+     * leaves the slot empty so it is skipped when sent.
+     */
+    void commit(int length) // IN : bytes written into slot
+    {
+        if(_reserved >= 0) {
+            _length[_reserved] = (length > 0) ? length : 0;
+            _reserved = -1;
+        }
+    }
+
+    /**
+     * Get the oldest queued record
+     */
+    const uint8_t *front(
+        int &length,        // OUT: bytes in record; zero if record is empty
+        bool &binary)       // OUT: true if record is binary
+                            // RET: record or nullptr if queue is empty
+    {
+        if(0 == _count) {
+            return nullptr;
+        }
+        const uint8_t slot = _order[0];
+        length = _length[slot];
+        binary = _binary[slot];
+        return _buffer[slot];
+    }
+
+    /**
+     * Remove the oldest queued record
+     */
+    void pop() {
+        if(_count > 0) {
+            const uint8_t slot = _order[0];
+            if(slot == _reserved) {
+                _reserved = -1;
+            }
+            _length[slot] = 0;
+            for(unsigned int i = 1; i < _count; i += 1) {
+                _order[i - 1] = _order[i];
+            }
+            _count -= 1;
+            _free[_freeCount++] = slot;
+        }
+    }
+};
+
+#endif // TELEMETRY_QUEUE_H
@@ -0,0 +1,133 @@
+#include <stdio.h>
+
+#include "token_log.h"
+#include "log.h"
+
+TokenLog tokenLog;
+
+static const char *LogTokenFormats[NUMBER_OF_LOG_TOKENS] = {
+    #define LOG_TOKEN_FORMAT(_token_, _format_) _format_,
+    LOG_TOKEN_TABLE(LOG_TOKEN_FORMAT)
+    #undef LOG_TOKEN_FORMAT
+};
+
+static const char *LogLevelNames[] = {
+    "DEBUG",    // DEBUG_LEVEL
+    "INFO",     // INFO_LEVEL
+    "WARNING",  // WARN_LEVEL
+    "ERROR",    // ERROR_LEVEL
+};
+
+/**
+ * Get the format string of a token
+ */
+const char *tokenLogFormat(uint16_t token)  // IN : LogToken
+                                            // RET: format string or nullptr if unknown
+{
+    return (token < NUMBER_OF_LOG_TOKENS) ? LogTokenFormats[token] : nullptr;
+}
+
+/**
+ * Get the name of a log level
+ */
+const char *tokenLogLevelName(uint8_t level)    // IN : log level
+                                                // RET: "ERROR", "WARNING", "INFO" or "DEBUG"
+{
+    return (level <= ERROR_LEVEL) ? LogLevelNames[level] : LogLevelNames[ERROR_LEVEL];
+}
+
+/**
+ * Format a log record's message.
+ *
+ * Each conversion in the format string is copied,
+ * with it's flags, width and precision, and handed to
+ * snprintf() along with the next argument converted
+ * back to the type the conversion expects.
+ * Missing arguments format as zero and unsupported
+ * conversions are copied as is.
+ */
+int formatTokenLog(
+    char *buffer,                   // OUT: receives formatted message
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const TokenLogRecord &record)   // IN : record to format
+                                    // RET: index of the string terminator,
+                                    //      or -1 if the buffer was too small
+{
+    if((nullptr == buffer) || (sizeOfBuffer <= 0)) return -1;
+
+    const char *format = tokenLogFormat(record.token);
+    if(nullptr == format) {
+        const int length = snprintf(buffer, sizeOfBuffer, "unknown log token %u", (unsigned int)record.token);
+        return ((length >= 0) && (length < sizeOfBuffer)) ? length : -1;
+    }
+
+    int offset = 0;
+    unsigned int arg = 0;
+    const char *c = format;
+    while('\0' != *c) {
+        if('%' != *c) {
+            if(offset + 1 >= sizeOfBuffer) return -1;
+            buffer[offset++] = *c++;
+            continue;
+        }
+
+        //
+        // copy the conversion specification; '%', flags, width, precision, conversion
+        //
+        char spec[16];
+        int specLength = 0;
+        spec[specLength++] = *c++;
+        while(('\0' != *c) && (NULL != strchr("-+ #0123456789.", *c)) && (specLength < (int)sizeof(spec) - 2)) {
+            spec[specLength++] = *c++;
+        }
+        const char conversion = *c;
+        if('\0' == conversion) break;
+        spec[specLength++] = *c++;
+        spec[specLength] = '\0';
+
+        const uint32_t value = (arg < record.argc) ? record.args[arg] : 0;
+        const int remaining = sizeOfBuffer - offset;
+        int length;
+        switch(conversion) {
+            case 'd':
+            case 'i': {
+                length = snprintf(buffer + offset, remaining, spec, (int)(int32_t)value);
+                arg += 1;
+                break;
+            }
+            case 'u':
+            case 'x':
+            case 'X': {
+                length = snprintf(buffer + offset, remaining, spec, (unsigned int)value);
+                arg += 1;
+                break;
+            }
+            case 'c': {
+                length = snprintf(buffer + offset, remaining, spec, (int)(char)value);
+                arg += 1;
+                break;
+            }
+            case 'f':
+            case 'g': {
+                float f;
+                memcpy(&f, &value, sizeof(f));
+                length = snprintf(buffer + offset, remaining, spec, (double)f);
+                arg += 1;
+                break;
+            }
+            case '%': {
+                length = snprintf(buffer + offset, remaining, "%%");
+                break;
+            }
+            default: {
+                length = snprintf(buffer + offset, remaining, "%s", spec);
+                break;
+            }
+        }
+        if((length < 0) || (length >= remaining)) return -1;
+        offset += length;
+    }
+    buffer[offset] = '\0';
+
+    return offset;
+}
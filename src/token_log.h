@@ -0,0 +1,182 @@
+#ifndef TOKEN_LOG_H
+#define TOKEN_LOG_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+#include "log.h"
+#include "log_tokens.h"
+#include "util/mpsc_ring.h"
+#include "config.h"
+
+//
+// Tokenized logging.
+//
+// Rather than building a message string where it is
+// logged, a call copies a token that names the format
+// string (see log_tokens.h), the log level, a cached
+// timestamp and up to TOKEN_LOG_ARGS raw argument values
+// into a lock-free ring.  That is a few dozen instructions
+// and does not allocate, lock or touch the serial port,
+// so it is safe from either core and from the control loop,
+// and it works while the serial pins are used by the
+// wheel encoders.
+//
+// The ring is drained off the hot path by the telemetry
+// sender, which sends the record to the client as is,
+// or formats it if the client asked for text telemetry.
+//
+// Use the LOGT_ERROR/LOGT_WARNING/LOGT_INFO/LOGT_DEBUG macros
+// in log.h, which compile to nothing below the file's LOG_LEVEL.
+//
+
+typedef enum LogToken {
+    #define LOG_TOKEN_ENUM(_token_, _format_) _token_,
+    LOG_TOKEN_TABLE(LOG_TOKEN_ENUM)
+    #undef LOG_TOKEN_ENUM
+    NUMBER_OF_LOG_TOKENS
+} LogToken;
+
+const unsigned int TOKEN_LOG_ARGS = 4;  // most arguments in a log record
+
+typedef struct TokenLogRecord {
+    uint32_t at;        // milliseconds since startup as of last tick()
+    uint16_t token;     // LogToken of the format string
+    uint8_t level;      // one of ERROR_LEVEL, WARN_LEVEL, INFO_LEVEL, DEBUG_LEVEL
+    uint8_t argc;       // number of arguments used
+    uint32_t args[TOKEN_LOG_ARGS];  // raw argument values; floats as their bits
+} TokenLogRecord;
+
+//
+// Convert a log argument to it's raw 32 bit value.
+// Integers are truncated to 32 bits and floats are
+// passed as their bit pattern, so the format string
+// says how to read them back.  Strings can not be
+// logged because they may be gone by the time the
+// record is formatted.
+//
+inline uint32_t tokenLogArg(int value) { return (uint32_t)value; }
+inline uint32_t tokenLogArg(unsigned int value) { return (uint32_t)value; }
+inline uint32_t tokenLogArg(long value) { return (uint32_t)value; }
+inline uint32_t tokenLogArg(unsigned long value) { return (uint32_t)value; }
+inline uint32_t tokenLogArg(bool value) { return value ? 1 : 0; }
+inline uint32_t tokenLogArg(char value) { return (uint32_t)(unsigned char)value; }
+inline uint32_t tokenLogArg(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+inline uint32_t tokenLogArg(double value) { return tokenLogArg((float)value); }
+uint32_t tokenLogArg(const char *value) = delete;
+uint32_t tokenLogArg(char *value) = delete;
+
+
+class TokenLog {
+    private:
+
+    MpscRing<TokenLogRecord, TOKEN_LOG_RECORDS> _ring;
+    std::atomic<uint32_t> _nowMs;
+
+    static void _setArgs(uint32_t *) {
+        // no-op; all arguments are copied
+    }
+
+    template <typename FIRST, typename... REST>
+    static void _setArgs(uint32_t *args, FIRST first, REST... rest) {
+        *args = tokenLogArg(first);
+        _setArgs(args + 1, rest...);
+    }
+
+    public:
+
+    TokenLog()
+        : _nowMs(0)
+    {
+        // no-op
+    }
+
+    /**
+     * Set the time stamped on log records.
+     * Reading the clock on every log call costs
+     * more than the rest of the call, so the main
+     * loop sets it once per pass instead.
+     */
+    void tick(unsigned long currentMillis) // IN : milliseconds since startup
+    {
+        _nowMs.store((uint32_t)currentMillis, std::memory_order_relaxed);
+    }
+
+    /**
+     * Queue a log record.
+     *
+     * NOTE: safe to call from any task on either core,
+     *       but not from an interrupt handler.
+     */
+    template <typename... ARGS>
+    bool log(
+        uint8_t level,      // IN : one of ERROR_LEVEL, WARN_LEVEL, INFO_LEVEL, DEBUG_LEVEL
+        LogToken token,     // IN : format of the message
+        ARGS... args)       // IN : up to TOKEN_LOG_ARGS numeric arguments
+                            // RET: true if queued, false if the ring was full
+    {
+        static_assert(sizeof...(ARGS) <= TOKEN_LOG_ARGS, "too many log arguments");
+
+        TokenLogRecord record;
+        record.at = _nowMs.load(std::memory_order_relaxed);
+        record.token = (uint16_t)token;
+        record.level = level;
+        record.argc = (uint8_t)sizeof...(ARGS);
+        _setArgs(record.args, args...);
+        return _ring.push(record);
+    }
+
+    /**
+     * Remove the oldest log record.
+     *
+     * NOTE: only call from one task; the one that sends the log.
+     */
+    bool pop(TokenLogRecord &record)    // OUT: on true, the oldest record
+                                        // RET: true if a record was removed,
+                                        //      false if there are none
+    {
+        return _ring.pop(record);
+    }
+
+    /**
+     * Get the number of records waiting to be sent
+     */
+    unsigned int count() { return _ring.count(); }
+
+    /**
+     * Get the number of records dropped because the ring was full
+     */
+    unsigned int dropped() { return _ring.dropped(); }
+};
+
+extern TokenLog tokenLog;   // defined in token_log.cpp
+
+
+/**
+ * Get the format string of a token
+ */
+const char *tokenLogFormat(uint16_t token); // IN : LogToken
+                                            // RET: format string or nullptr if unknown
+
+/**
+ * Get the name of a log level
+ */
+const char *tokenLogLevelName(uint8_t level);   // IN : log level
+                                                // RET: "ERROR", "WARNING", "INFO" or "DEBUG"
+
+/**
+ * Format a log record's message
+ */
+int formatTokenLog(
+    char *buffer,                   // OUT: receives formatted message
+    int sizeOfBuffer,               // IN : size of buffer in bytes
+    const TokenLogRecord &record);  // IN : record to format
+                                    // RET: index of the string terminator,
+                                    //      or -1 if the buffer was too small
+
+#endif // TOKEN_LOG_H
@@ -0,0 +1,136 @@
+#ifndef UTIL_FAST_TRIG_H
+#define UTIL_FAST_TRIG_H
+
+#include <math.h>
+
+#include "./math.h"
+
+//
+// Single precision trig kernels for pose estimation
+// and behaviors, which call sin, cos and atan2 every
+// control tick.  Each reduces it's argument with
+// a couple of branches, then evaluates a minimax
+// polynomial, so there are no tables to keep in
+// RAM or flash and no calls into libm.
+//
+// Worst case absolute error, measured against
+// double precision libm by test/src/util/fast_trig.test.cpp:
+//
+//   fastWrapAngle  exact, other than float rounding of the 2π steps
+//   fastSin        2.5e-7 for |radians| <= π, 1e-6 for |radians| <= 4π
+//   fastCos        2.5e-7 for |radians| <= π, 1e-6 for |radians| <= 4π
+//   fastAtan2      2.5e-6 radians
+//
+// pose.h selects these or libm for the COS, SIN
+// and ATAN2 macros with USE_FAST_TRIG.
+//
+
+const float FAST_PI = (float)PI;
+const float FAST_HALF_PI = (float)(PI / 2);
+const float FAST_TWO_PI = (float)(2 * PI);
+
+/**
+ * Wrap an angle to -π to π radians.
+ * An angle that has just crossed ±π, the usual
+ * case when adding a turn to a heading, takes
+ * one comparison and one add; only angles
+ * more than a turn out of range need fmodf.
+ */
+inline float fastWrapAngle(float radians)   // IN : angle in radians
+                                            // RET: same direction in -π to π radians
+{
+    if(radians > FAST_PI) {
+        radians -= FAST_TWO_PI;
+        if(radians > FAST_PI) {
+            radians = fmodf(radians + FAST_PI, FAST_TWO_PI) - FAST_PI;
+        }
+    } else if(radians < -FAST_PI) {
+        radians += FAST_TWO_PI;
+        if(radians < -FAST_PI) {
+            radians = fmodf(radians - FAST_PI, FAST_TWO_PI) + FAST_PI;
+        }
+    }
+    return radians;
+}
+
+/**
+ * Sine of an angle in -π/2 to π/2 radians;
+ * odd degree 9 minimax polynomial,
+ * error 3.4e-9 before float rounding.
+ */
+inline float fastSinKernel(float x)     // IN : radians in -π/2 to π/2
+                                        // RET: sine of x
+{
+    const float x2 = x * x;
+    return x * (0.9999999766f + x2 * (-0.1666664764f + x2 * (0.008332899831f
+        + x2 * (-0.0001980089814f + x2 * 2.590489147e-06f))));
+}
+
+/**
+ * Sine of an angle
+ */
+inline float fastSin(float radians) // IN : angle in radians
+                                    // RET: sine of angle
+{
+    radians = fastWrapAngle(radians);
+
+    // reflect about ±π/2 into the kernel's range; sin(π - x) = sin(x)
+    if(radians > FAST_HALF_PI) {
+        radians = FAST_PI - radians;
+    } else if(radians < -FAST_HALF_PI) {
+        radians = -FAST_PI - radians;
+    }
+    return fastSinKernel(radians);
+}
+
+/**
+ * Cosine of an angle
+ */
+inline float fastCos(float radians) // IN : angle in radians
+                                    // RET: cosine of angle
+{
+    // cos(x) = sin(π/2 - |x|), which is in the kernel's range for |x| <= π
+    radians = fastWrapAngle(radians);
+    return fastSinKernel(FAST_HALF_PI - ((radians < 0) ? -radians : radians));
+}
+
+/**
+ * Arctangent of a ratio in 0 to 1;
+ * odd degree 11 minimax polynomial,
+ * error 1.7e-6 radians before float rounding.
+ */
+inline float fastAtanKernel(float t)    // IN : ratio in 0 to 1
+                                        // RET: arctangent of t in 0 to π/4 radians
+{
+    const float t2 = t * t;
+    return t * (0.9999772191f + t2 * (-0.332622828f + t2 * (0.1935403758f
+        + t2 * (-0.1164264802f + t2 * (0.05264734896f + t2 * -0.01171913462f)))));
+}
+
+/**
+ * Angle of the vector (x, y) from the positive x axis,
+ * like atan2f().  The smaller of |x| and |y| is divided
+ * by the larger so the kernel only sees 0 to 1, then
+ * the octant is restored.
+ */
+inline float fastAtan2(
+    float y,    // IN : vertical component
+    float x)    // IN : horizontal component
+                // RET: angle in -π to π radians; zero if both are zero
+{
+    const float ax = (x < 0) ? -x : x;
+    const float ay = (y < 0) ? -y : y;
+    if((0 == ax) && (0 == ay)) {
+        return 0;
+    }
+
+    float angle = (ay <= ax)
+        ? fastAtanKernel(ay / ax)
+        : FAST_HALF_PI - fastAtanKernel(ax / ay);
+    if(x < 0) {
+        angle = FAST_PI - angle;
+    }
+    return (y < 0) ? -angle : angle;
+}
+
+#endif // UTIL_FAST_TRIG_H
@@ -0,0 +1,386 @@
+#ifndef UTIL_FIXED_POINT_H
+#define UTIL_FIXED_POINT_H
+
+#include <stdint.h>
+
+#include "./math.h"
+
+//
+// Q-format fixed point numbers for control and pose math
+// on processors without a fast FPU, and in interrupt
+// handlers where the FPU may not be used.
+//
+// A Fixed<FRACTION_BITS> keeps it's value in a 32 bit
+// integer scaled by 2^FRACTION_BITS, so Fixed<16> (Q15.16)
+// holds ±32768 with a resolution of 1.5e-5, which is enough
+// for centimeters, cm/sec and radians.  Arithmetic never
+// wraps around; a result that does not fit saturates at
+// the largest or smallest value, so a runaway integral
+// term pins at a limit rather than changing sign.
+//
+// Operators accept floats and ints as well, which are
+// converted when the expression is evaluated; so constants
+// like POSE_ARC_MIN_ANGLE can be compared with a Fixed,
+// but that conversion uses the FPU, so values used in an
+// interrupt handler should be converted ahead of time.
+//
+// Fixed works with the templates in util/math.h, like
+// abs(), bound() and compareTo(), and fixedSin(), fixedCos(),
+// fixedAtan2() and fixedSqrt() use only integer math.
+//
+template <int FRACTION_BITS> class Fixed {
+    static_assert((FRACTION_BITS > 0) && (FRACTION_BITS <= 30), "FRACTION_BITS must be 1 to 30");
+
+    private:
+    int32_t _raw;   // value * 2^FRACTION_BITS
+
+    /**
+     * Clamp a 64 bit intermediate to the 32 bit range
+     */
+    static constexpr int32_t _saturate(int64_t value)   // IN : raw value that may be out of range
+                                                        // RET: raw value clamped to INT32_MIN to INT32_MAX
+    {
+        return (value > INT32_MAX) ? INT32_MAX : (value < INT32_MIN) ? INT32_MIN : (int32_t)value;
+    }
+
+    /**
+     * Round a scaled float or double to a raw value, saturating.
+     * The range is checked before the cast, because casting
+     * a value that is out of range is undefined.
+     */
+    template <typename T> static constexpr int32_t _round(T scaled) // IN : value * 2^FRACTION_BITS
+                                                                    // RET: nearest raw value
+    {
+        return (scaled >= (T)INT32_MAX) ? INT32_MAX
+            : (scaled <= (T)INT32_MIN) ? INT32_MIN
+            : (int32_t)((scaled >= 0) ? (scaled + (T)0.5) : (scaled - (T)0.5));
+    }
+
+    /**
+     * Construct from a raw value; tagged so it is
+     * not mistaken for the int constructor.
+     */
+    struct RawTag {};
+    constexpr Fixed(int32_t raw, RawTag) : _raw(raw) {}
+
+    public:
+    static const int32_t ONE = (int32_t)1 << FRACTION_BITS;     // raw value of 1.0
+
+    //
+    // like a float, a default constructed Fixed is not
+    // initialized, so Fixed can be used in unions and
+    // structs that are copied as bytes.  The constructors
+    // are constexpr so Fixed constants are initialized
+    // at compile time.
+    //
+    Fixed() = default;
+    constexpr Fixed(int value) : _raw(_saturate((int64_t)value * ONE)) {}
+    constexpr Fixed(long value) : _raw(_saturate((int64_t)value * ONE)) {}
+    constexpr Fixed(unsigned int value) : _raw(_saturate((int64_t)value * ONE)) {}
+    constexpr Fixed(unsigned long value) : _raw(_saturate((int64_t)(value > (unsigned long)INT32_MAX ? INT32_MAX : value) * ONE)) {}
+    constexpr Fixed(float value) : _raw(_round<float>(value * ONE)) {}
+    constexpr Fixed(double value) : _raw(_round<double>(value * ONE)) {}
+
+    /**
+     * Convert from another format, rounding
+     * if it has more fraction bits and
+     * saturating if it has fewer.
+     */
+    template <int OTHER_BITS> explicit Fixed(Fixed<OTHER_BITS> value)   // IN : value in another format
+    {
+        if(OTHER_BITS > FRACTION_BITS) {
+            const int shift = (OTHER_BITS > FRACTION_BITS) ? OTHER_BITS - FRACTION_BITS : 0;
+            _raw = (int32_t)(((int64_t)value.raw() + ((int64_t)1 << (shift - 1))) >> shift);
+        } else {
+            const int shift = (FRACTION_BITS > OTHER_BITS) ? FRACTION_BITS - OTHER_BITS : 0;
+            _raw = _saturate((int64_t)value.raw() * ((int64_t)1 << shift));
+        }
+    }
+
+    /**
+     * Construct from a raw scaled value
+     */
+    static constexpr Fixed fromRaw(int32_t raw) // IN : value * 2^FRACTION_BITS
+                                                // RET: fixed point value
+    {
+        return Fixed(raw, RawTag());
+    }
+
+    /**
+     * Largest and smallest values; results that
+     * do not fit saturate to these.
+     */
+    static constexpr Fixed maximum() { return fromRaw(INT32_MAX); }
+    static constexpr Fixed minimum() { return fromRaw(INT32_MIN); }
+
+    constexpr int32_t raw() const { return _raw; }  // RET: value * 2^FRACTION_BITS
+    constexpr float toFloat() const { return (float)_raw / ONE; }
+    constexpr double toDouble() const { return (double)_raw / ONE; }
+    explicit constexpr operator float() const { return toFloat(); }
+    explicit constexpr operator double() const { return toDouble(); }
+    int toInt() const { return (int)(_raw >> FRACTION_BITS); }  // RET: value rounded toward negative infinity
+
+    //
+    // like casting a float, casting to an integer truncates toward zero
+    //
+    explicit operator int() const { return (int)((_raw >= 0) ? (_raw >> FRACTION_BITS) : -((-(int64_t)_raw) >> FRACTION_BITS)); }
+    explicit operator long() const { return (long)(int)*this; }
+    explicit operator unsigned int() const { return (unsigned int)(int)*this; }
+    explicit operator unsigned long() const { return (unsigned long)(int)*this; }
+
+    //
+    // Saturating arithmetic.  These are friends defined in the
+    // class, so a float or int on either side is converted.
+    //
+    friend Fixed operator+(Fixed a, Fixed b) { return fromRaw(_saturate((int64_t)a._raw + b._raw)); }
+    friend Fixed operator-(Fixed a, Fixed b) { return fromRaw(_saturate((int64_t)a._raw - b._raw)); }
+    friend Fixed operator*(Fixed a, Fixed b) {
+        // round to nearest rather than toward negative infinity, so errors do not accumulate one way
+        const int64_t product = (int64_t)a._raw * b._raw;
+        return fromRaw(_saturate((product + ((int64_t)1 << (FRACTION_BITS - 1))) >> FRACTION_BITS));
+    }
+    friend Fixed operator/(Fixed a, Fixed b) {
+        if(0 == b._raw) {
+            // like float, the result of dividing by zero is as large as it can be
+            return (a._raw >= 0) ? maximum() : minimum();
+        }
+        // divide the magnitudes so rounding to nearest is the same on either side of zero
+        const int64_t dividend = abs<int64_t>(a._raw) * ONE;
+        const int64_t divisor = abs<int64_t>(b._raw);
+        const int64_t quotient = (dividend + divisor / 2) / divisor;
+        return fromRaw(_saturate(((a._raw < 0) != (b._raw < 0)) ? -quotient : quotient));
+    }
+    Fixed operator-() const { return fromRaw(_saturate(-(int64_t)_raw)); }
+
+    Fixed& operator+=(Fixed b) { return (*this = *this + b); }
+    Fixed& operator-=(Fixed b) { return (*this = *this - b); }
+    Fixed& operator*=(Fixed b) { return (*this = *this * b); }
+    Fixed& operator/=(Fixed b) { return (*this = *this / b); }
+
+    friend bool operator==(Fixed a, Fixed b) { return a._raw == b._raw; }
+    friend bool operator!=(Fixed a, Fixed b) { return a._raw != b._raw; }
+    friend bool operator<(Fixed a, Fixed b) { return a._raw < b._raw; }
+    friend bool operator<=(Fixed a, Fixed b) { return a._raw <= b._raw; }
+    friend bool operator>(Fixed a, Fixed b) { return a._raw > b._raw; }
+    friend bool operator>=(Fixed a, Fixed b) { return a._raw >= b._raw; }
+};
+
+//
+// The trig kernels work in Q30 with 64 bit products, whatever
+// the FRACTION_BITS of their argument, so their error is below
+// the resolution of the result.  Angles to ±π must fit, so
+// the trig functions need FRACTION_BITS of 29 or less.
+// Coefficients are the minimax polynomials of util/fast_trig.h.
+//
+const int FIXED_KERNEL_BITS = 30;
+const int64_t FIXED_KERNEL_ONE = (int64_t)1 << FIXED_KERNEL_BITS;
+const int64_t FIXED_KERNEL_PI = 3373259426LL;       // π * 2^30
+const int64_t FIXED_KERNEL_HALF_PI = 1686629713LL;  // π/2 * 2^30
+
+/**
+ * Product of two Q30 values, rounded
+ */
+inline int64_t fixedKernelMultiply(int64_t a, int64_t b)   // IN : Q30 values, |a|, |b| < 4
+                                                            // RET: Q30 product
+{
+    return (a * b + (FIXED_KERNEL_ONE >> 1)) >> FIXED_KERNEL_BITS;
+}
+
+/**
+ * Sine of a Q30 angle in -π/2 to π/2 radians
+ */
+inline int64_t fixedSinKernel(int64_t x)   // IN : Q30 radians in -π/2 to π/2
+                                            // RET: Q30 sine of x
+{
+    const int64_t x2 = fixedKernelMultiply(x, x);
+    int64_t sum = 2782LL;                                   // 2.590489147e-06
+    sum = fixedKernelMultiply(sum, x2) - 212611LL;          // 0.0001980089814
+    sum = fixedKernelMultiply(sum, x2) + 8947383LL;         // 0.008332899831
+    sum = fixedKernelMultiply(sum, x2) - 178956766LL;       // 0.1666664764
+    sum = fixedKernelMultiply(sum, x2) + 1073741799LL;      // 0.9999999766
+    return fixedKernelMultiply(sum, x);
+}
+
+/**
+ * Arctangent of a Q30 ratio in 0 to 1
+ */
+inline int64_t fixedAtanKernel(int64_t t)  // IN : Q30 ratio in 0 to 1
+                                            // RET: Q30 radians in 0 to π/4
+{
+    const int64_t t2 = fixedKernelMultiply(t, t);
+    int64_t sum = -12583325LL;                              // -0.01171913462
+    sum = fixedKernelMultiply(sum, t2) + 56529661LL;        // 0.05264734896
+    sum = fixedKernelMultiply(sum, t2) - 125011981LL;       // 0.1164264802
+    sum = fixedKernelMultiply(sum, t2) + 207812396LL;       // 0.1935403758
+    sum = fixedKernelMultiply(sum, t2) - 357151042LL;       // 0.332622828
+    sum = fixedKernelMultiply(sum, t2) + 1073717363LL;      // 0.9999772191
+    return fixedKernelMultiply(sum, t);
+}
+
+/**
+ * Convert a Fixed to Q30; the result does
+ * not fit in 32 bits, so it is kept in 64.
+ */
+template <int FRACTION_BITS> inline
+int64_t fixedToKernel(Fixed<FRACTION_BITS> value)   // IN : value
+                                                    // RET: Q30 value
+{
+    static_assert(FRACTION_BITS <= 29, "fixed point trig needs FRACTION_BITS of 29 or less");
+    return (int64_t)value.raw() * ((int64_t)1 << (FIXED_KERNEL_BITS - FRACTION_BITS));  // multiply; shifting a negative left is undefined
+}
+
+/**
+ * Convert a Q30 value to a Fixed, rounding
+ */
+template <int FRACTION_BITS> inline
+Fixed<FRACTION_BITS> fixedFromKernel(int64_t value) // IN : Q30 value within ±4
+                                                    // RET: rounded fixed point value
+{
+    static_assert(FRACTION_BITS <= 29, "fixed point trig needs FRACTION_BITS of 29 or less");
+    const int shift = FIXED_KERNEL_BITS - FRACTION_BITS;
+    return Fixed<FRACTION_BITS>::fromRaw((int32_t)((value + ((int64_t)1 << (shift - 1))) >> shift));
+}
+
+/**
+ * Wrap a Q30 angle to -π to π radians.
+ * This is done in Q30 rather than in the argument's
+ * format so that 2π is exact to 1e-9 radians, rather
+ * than to the argument's resolution for each turn.
+ */
+inline int64_t fixedKernelWrap(int64_t radians)    // IN : Q30 angle in radians
+                                                    // RET: Q30 angle in -π to π radians
+{
+    if((radians > FIXED_KERNEL_PI) || (radians < -FIXED_KERNEL_PI)) {
+        radians = (radians + FIXED_KERNEL_PI) % (2 * FIXED_KERNEL_PI);
+        radians = ((radians < 0) ? radians + 2 * FIXED_KERNEL_PI : radians) - FIXED_KERNEL_PI;
+    }
+    return radians;
+}
+
+/**
+ * Wrap an angle to -π to π radians
+ */
+template <int FRACTION_BITS> inline
+Fixed<FRACTION_BITS> fixedWrapAngle(Fixed<FRACTION_BITS> radians)   // IN : angle in radians
+                                                                    // RET: same direction in -π to π radians
+{
+    return fixedFromKernel<FRACTION_BITS>(fixedKernelWrap(fixedToKernel(radians)));
+}
+
+/**
+ * Sine of an angle
+ */
+template <int FRACTION_BITS> inline
+Fixed<FRACTION_BITS> fixedSin(Fixed<FRACTION_BITS> radians) // IN : angle in radians
+                                                            // RET: sine of angle
+{
+    int64_t x = fixedKernelWrap(fixedToKernel(radians));
+
+    // reflect about ±π/2 into the kernel's range; sin(π - x) = sin(x)
+    if(x > FIXED_KERNEL_HALF_PI) {
+        x = FIXED_KERNEL_PI - x;
+    } else if(x < -FIXED_KERNEL_HALF_PI) {
+        x = -FIXED_KERNEL_PI - x;
+    }
+    return fixedFromKernel<FRACTION_BITS>(fixedSinKernel(x));
+}
+
+/**
+ * Cosine of an angle
+ */
+template <int FRACTION_BITS> inline
+Fixed<FRACTION_BITS> fixedCos(Fixed<FRACTION_BITS> radians) // IN : angle in radians
+                                                            // RET: cosine of angle
+{
+    // cos(x) = sin(π/2 - |x|)
+    const int64_t x = fixedKernelWrap(fixedToKernel(radians));
+    return fixedFromKernel<FRACTION_BITS>(fixedSinKernel(FIXED_KERNEL_HALF_PI - ((x < 0) ? -x : x)));
+}
+
+/**
+ * Angle of the vector (x, y) from the positive x axis
+ */
+template <int FRACTION_BITS> inline
+Fixed<FRACTION_BITS> fixedAtan2(
+    Fixed<FRACTION_BITS> y, // IN : vertical component
+    Fixed<FRACTION_BITS> x) // IN : horizontal component
+                            // RET: angle in -π to π radians; zero if both are zero
+{
+    const int64_t ax = abs<int64_t>(x.raw());
+    const int64_t ay = abs<int64_t>(y.raw());
+    if((0 == ax) && (0 == ay)) {
+        return Fixed<FRACTION_BITS>::fromRaw(0);
+    }
+
+    // the smaller over the larger is a ratio in 0 to 1, which only depends on the raw values
+    int64_t angle = (ay <= ax)
+        ? fixedAtanKernel((ay << FIXED_KERNEL_BITS) / ax)
+        : FIXED_KERNEL_HALF_PI - fixedAtanKernel((ax << FIXED_KERNEL_BITS) / ay);
+    if(x.raw() < 0) {
+        angle = FIXED_KERNEL_PI - angle;
+    }
+    return fixedFromKernel<FRACTION_BITS>((y.raw() < 0) ? -angle : angle);
+}
+
+/**
+ * Integer square root, bit by bit, rounded to nearest
+ */
+inline uint64_t fixedIntegerSqrt(uint64_t remainder)   // IN : value
+                                                        // RET: nearest integer to square root of value
+{
+    uint64_t root = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while(bit > remainder) {
+        bit >>= 2;
+    }
+    while(0 != bit) {
+        if(remainder >= root + bit) {
+            remainder -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    // round to nearest
+    if(remainder > root) {
+        root += 1;
+    }
+    return root;
+}
+
+/**
+ * Square root, by integer bit by bit square root of the
+ * scaled value, so the result is exact to the last bit.
+ */
+template <int FRACTION_BITS> inline
+Fixed<FRACTION_BITS> fixedSqrt(Fixed<FRACTION_BITS> value)  // IN : value
+                                                            // RET: square root of value; zero if value is not positive
+{
+    if(value.raw() <= 0) {
+        return Fixed<FRACTION_BITS>::fromRaw(0);
+    }
+
+    // sqrt(raw * 2^F) is the raw square root
+    return Fixed<FRACTION_BITS>::fromRaw((int32_t)fixedIntegerSqrt((uint64_t)value.raw() << FRACTION_BITS));
+}
+
+/**
+ * Length of the vector (x, y).  The squares are summed
+ * in 64 bits, so unlike fixedSqrt(x * x + y * y) this
+ * does not saturate for lengths over sqrt(maximum()).
+ */
+template <int FRACTION_BITS> inline
+Fixed<FRACTION_BITS> fixedHypot(
+    Fixed<FRACTION_BITS> x, // IN : horizontal component
+    Fixed<FRACTION_BITS> y) // IN : vertical component
+                            // RET: length of vector, saturating
+{
+    // sqrt(rawX² + rawY²) is the raw length
+    const uint64_t ax = (uint64_t)abs<int64_t>(x.raw());
+    const uint64_t ay = (uint64_t)abs<int64_t>(y.raw());
+    const uint64_t root = fixedIntegerSqrt(ax * ax + ay * ay);
+    return Fixed<FRACTION_BITS>::fromRaw((root > INT32_MAX) ? INT32_MAX : (int32_t)root);
+}
+
+#endif // UTIL_FIXED_POINT_H
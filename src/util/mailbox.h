@@ -0,0 +1,86 @@
+#ifndef UTIL_MAILBOX_H
+#define UTIL_MAILBOX_H
+
+#include <atomic>
+
+/**
+ * Single-producer/single-consumer mailbox that
+ * hands the newest value from one thread (or core)
+ * to another, dropping values the consumer was
+ * too slow to take.
+ *
+ * Values are owned buffers passed by pointer, so
+ * nothing is copied; a value is in one of two
+ * slots, posted and waiting to be taken, or taken
+ * and held by the consumer until it is done with
+ * it, while the producer fills the next one.  The
+ * posted slot is swapped with a single atomic
+ * exchange, so neither side ever waits on the other.
+ *
+ * post() returns the value it replaced, which the
+ * consumer never saw, so the producer can recycle it.
+ */
+template <class T> class Mailbox {
+    private:
+    std::atomic<T *> _posted;           // newest value, not yet taken
+    std::atomic<unsigned int> _count;   // values posted
+    std::atomic<unsigned int> _dropped; // values replaced before they were taken
+
+    public:
+
+    Mailbox()
+        : _posted(nullptr), _count(0), _dropped(0)
+    {
+        // no-op
+    }
+
+    /**
+     * Get the number of values posted
+     */
+    unsigned int count()    // RET: number of values posted since construction
+    {
+        return _count.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Get the number of values that were replaced
+     * by a newer one before the consumer took them
+     */
+    unsigned int dropped()  // RET: number of dropped values since construction
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Post the newest value.
+     *
+     * NOTE: only call from the producer side.
+     */
+    T *post(T *theValue)    // IN : value to hand to the consumer
+                            // RET: the value it replaced, which the producer
+                            //      now owns again, or nullptr
+    {
+        T *replaced = _posted.exchange(theValue, std::memory_order_acq_rel);
+        _count.fetch_add(1, std::memory_order_relaxed);
+        if(nullptr != replaced) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+        return replaced;
+    }
+
+    /**
+     * Take the newest value, leaving the mailbox empty.
+     *
+     * NOTE: only call from the consumer side.
+     */
+    T *take()   // RET: the newest value, which the consumer now owns,
+                //      or nullptr if nothing was posted since the last take()
+    {
+        if(nullptr == _posted.load(std::memory_order_relaxed)) {
+            return nullptr; // skip the exchange when there is nothing to take
+        }
+        return _posted.exchange(nullptr, std::memory_order_acq_rel);
+    }
+};
+
+#endif // UTIL_MAILBOX_H
@@ -0,0 +1,128 @@
+#ifndef UTIL_MATRIX_H
+#define UTIL_MATRIX_H
+
+/**
+ * Fixed size matrix of ROWS x COLUMNS values.
+ *
+ * Dimensions are template parameters, so
+ * a mismatched product does not compile,
+ * and every matrix lives on the stack or
+ * in it's owner; nothing is allocated.
+ * This is meant for the small matrices
+ * of pose estimation, like a 3x3 covariance.
+ */
+template <typename T, int ROWS, int COLUMNS> struct Matrix {
+    T m[ROWS][COLUMNS];
+
+    T& operator()(int row, int column) { return m[row][column]; }
+    const T& operator()(int row, int column) const { return m[row][column]; }
+};
+
+/**
+ * Matrix of all zeros
+ */
+template <typename T, int ROWS, int COLUMNS> inline
+Matrix<T, ROWS, COLUMNS> zeroMatrix()   // RET: ROWS x COLUMNS zero matrix
+{
+    Matrix<T, ROWS, COLUMNS> result;
+    for(int i = 0; i < ROWS; i += 1) {
+        for(int j = 0; j < COLUMNS; j += 1) {
+            result.m[i][j] = 0;
+        }
+    }
+    return result;
+}
+
+/**
+ * Square identity matrix
+ */
+template <typename T, int N> inline
+Matrix<T, N, N> identityMatrix()    // RET: N x N identity matrix
+{
+    Matrix<T, N, N> result = zeroMatrix<T, N, N>();
+    for(int i = 0; i < N; i += 1) {
+        result.m[i][i] = 1;
+    }
+    return result;
+}
+
+/**
+ * Matrix product a * b
+ */
+template <typename T, int ROWS, int INNER, int COLUMNS> inline
+Matrix<T, ROWS, COLUMNS> multiply(
+    const Matrix<T, ROWS, INNER> &a,        // IN : left matrix
+    const Matrix<T, INNER, COLUMNS> &b)     // IN : right matrix
+                                            // RET: ROWS x COLUMNS product
+{
+    Matrix<T, ROWS, COLUMNS> result;
+    for(int i = 0; i < ROWS; i += 1) {
+        for(int j = 0; j < COLUMNS; j += 1) {
+            T sum = 0;
+            for(int k = 0; k < INNER; k += 1) {
+                sum += a.m[i][k] * b.m[k][j];
+            }
+            result.m[i][j] = sum;
+        }
+    }
+    return result;
+}
+
+/**
+ * Matrix product a * bᵀ, without forming the transpose
+ */
+template <typename T, int ROWS, int INNER, int COLUMNS> inline
+Matrix<T, ROWS, COLUMNS> multiplyTransposed(
+    const Matrix<T, ROWS, INNER> &a,        // IN : left matrix
+    const Matrix<T, COLUMNS, INNER> &b)     // IN : right matrix, transposed in product
+                                            // RET: ROWS x COLUMNS product
+{
+    Matrix<T, ROWS, COLUMNS> result;
+    for(int i = 0; i < ROWS; i += 1) {
+        for(int j = 0; j < COLUMNS; j += 1) {
+            T sum = 0;
+            for(int k = 0; k < INNER; k += 1) {
+                sum += a.m[i][k] * b.m[j][k];
+            }
+            result.m[i][j] = sum;
+        }
+    }
+    return result;
+}
+
+/**
+ * Matrix sum a + b
+ */
+template <typename T, int ROWS, int COLUMNS> inline
+Matrix<T, ROWS, COLUMNS> add(
+    const Matrix<T, ROWS, COLUMNS> &a,  // IN : left matrix
+    const Matrix<T, ROWS, COLUMNS> &b)  // IN : right matrix
+                                        // RET: ROWS x COLUMNS sum
+{
+    Matrix<T, ROWS, COLUMNS> result;
+    for(int i = 0; i < ROWS; i += 1) {
+        for(int j = 0; j < COLUMNS; j += 1) {
+            result.m[i][j] = a.m[i][j] + b.m[i][j];
+        }
+    }
+    return result;
+}
+
+/**
+ * Transpose of a matrix
+ */
+template <typename T, int ROWS, int COLUMNS> inline
+Matrix<T, COLUMNS, ROWS> transpose(
+    const Matrix<T, ROWS, COLUMNS> &a)  // IN : matrix
+                                        // RET: COLUMNS x ROWS transpose
+{
+    Matrix<T, COLUMNS, ROWS> result;
+    for(int i = 0; i < ROWS; i += 1) {
+        for(int j = 0; j < COLUMNS; j += 1) {
+            result.m[j][i] = a.m[i][j];
+        }
+    }
+    return result;
+}
+
+#endif // UTIL_MATRIX_H
@@ -0,0 +1,143 @@
+#ifndef UTIL_MPSC_RING_H
+#define UTIL_MPSC_RING_H
+
+#include <atomic>
+
+/**
+ * Multi-producer/single-consumer lock-free ring buffer.
+ *
+ * Any number of threads (or both cores) may call push()
+ * and exactly one thread may call pop().
+ *
+ * Each slot carries a sequence number that tells whose
+ * turn it is; a producer claims a slot by advancing the
+ * head with compare-exchange, fills it, then publishes it
+ * by storing the slot's sequence with release ordering.
+ * The consumer only reads a slot after it sees that
+ * sequence with acquire ordering, then hands the slot back
+ * to producers for the next lap of the ring.
+ *
+ * A full ring drops the new value rather than waiting,
+ * so push() never blocks and is safe to call from
+ * time critical code.
+ *
+ * Indices run freely and are reduced modulo CAPACITY
+ * when used, so CAPACITY must be a power of two.
+ */
+template <class T, unsigned int CAPACITY> class MpscRing {
+    static_assert((CAPACITY > 0) && (0 == (CAPACITY & (CAPACITY - 1))), "CAPACITY must be a power of two");
+
+    private:
+    typedef struct Slot {
+        std::atomic<unsigned int> sequence; // == index when free, == index + 1 when filled
+        T value;
+    } Slot;
+
+    Slot _slots[CAPACITY];
+    std::atomic<unsigned int> _head;    // next slot to claim; shared by producers
+    std::atomic<unsigned int> _tail;    // next slot to read; written only by consumer
+    std::atomic<unsigned int> _dropped; // pushes rejected because ring was full
+
+    public:
+
+    MpscRing()
+        : _head(0), _tail(0), _dropped(0)
+    {
+        for(unsigned int i = 0; i < CAPACITY; i += 1) {
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * Get the total number of slots in the ring
+     */
+    unsigned int capacity() // RET: CAPACITY
+    {
+        return CAPACITY;
+    }
+
+    /**
+     * Get the number of claimed slots.
+     *
+     * NOTE: this is a snapshot that may already be stale
+     *       and includes slots that producers are still filling.
+     */
+    unsigned int count()    // RET: number of values in the ring
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Determine if the ring has no values
+     */
+    bool empty()    // RET: true if no values to pop
+    {
+        return 0 == count();
+    }
+
+    /**
+     * Get the number of pushes that failed because the ring was full
+     */
+    unsigned int dropped()  // RET: number of dropped values since construction
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Copy a value into the ring.
+     *
+     * NOTE: safe to call from any number of producers.
+     */
+    bool push(const T &theValue)    // IN : value to copy into the ring
+                                    // RET: true if value was added,
+                                    //      false if ring was full and value was dropped
+    {
+        unsigned int head = _head.load(std::memory_order_relaxed);
+        for(;;) {
+            Slot &slot = _slots[head & (CAPACITY - 1)];
+            const int lap = (int)(slot.sequence.load(std::memory_order_acquire) - head);
+            if(0 == lap) {
+                // slot is free on this lap; try to claim it
+                if(_head.compare_exchange_weak(head, head + 1, std::memory_order_relaxed)) {
+                    slot.value = theValue;
+                    slot.sequence.store(head + 1, std::memory_order_release);   // publish slot to consumer
+                    return true;
+                }
+                // another producer claimed it; head now holds the new value
+            } else if(lap < 0) {
+                // slot still holds a value from the last lap; ring is full
+                _dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            } else {
+                // another producer got ahead of us
+                head = _head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * Copy the oldest value out of the ring.
+     *
+     * NOTE: only call from the consumer side.
+     *       A slot that is claimed but not yet filled
+     *       reads as empty until its producer finishes.
+     */
+    bool pop(T &theValue)   // OUT: on true, the oldest value in the ring
+                            //      otherwise unchanged.
+                            // RET: true if a value was removed,
+                            //      false if the ring was empty
+    {
+        const unsigned int tail = _tail.load(std::memory_order_relaxed);
+        Slot &slot = _slots[tail & (CAPACITY - 1)];
+        if(slot.sequence.load(std::memory_order_acquire) != tail + 1) {
+            return false;
+        }
+
+        theValue = slot.value;
+        slot.sequence.store(tail + CAPACITY, std::memory_order_release);    // release slot to producers
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif // UTIL_MPSC_RING_H
@@ -0,0 +1,119 @@
+#ifndef UTIL_SPSC_RING_H
+#define UTIL_SPSC_RING_H
+
+#include <atomic>
+
+/**
+ * Single-producer/single-consumer lock-free ring buffer.
+ *
+ * Exactly one thread (or core) may call push() and
+ * exactly one other thread (or core) may call pop().
+ * No locks are taken; the head index is only written
+ * by the producer and the tail index is only written
+ * by the consumer, and each is published to the other
+ * side with release/acquire ordering so the slot contents
+ * are visible before the index that exposes them.
+ *
+ * Indices run freely and are reduced modulo CAPACITY
+ * when used, so CAPACITY must be a power of two and
+ * all CAPACITY slots are usable.
+ *
+ * This only uses std::atomic<unsigned int>, which is
+ * lock-free on both the ESP32 (Xtensa) and the host,
+ * so the same code runs on the rover and in host tests.
+ */
+template <class T, unsigned int CAPACITY> class SpscRing {
+    static_assert((CAPACITY > 0) && (0 == (CAPACITY & (CAPACITY - 1))), "CAPACITY must be a power of two");
+
+    private:
+    T _buffer[CAPACITY];
+    std::atomic<unsigned int> _head;    // next slot to write; written only by producer
+    std::atomic<unsigned int> _tail;    // next slot to read; written only by consumer
+    std::atomic<unsigned int> _dropped; // pushes rejected because ring was full
+
+    public:
+
+    SpscRing()
+        : _head(0), _tail(0), _dropped(0)
+    {
+        // no-op
+    }
+
+    /**
+     * Get the total number of slots in the ring
+     */
+    unsigned int capacity() // RET: CAPACITY
+    {
+        return CAPACITY;
+    }
+
+    /**
+     * Get the number of filled slots.
+     *
+     * NOTE: when called from either side while the
+     *       other side is running this is a snapshot
+     *       that may already be stale.
+     */
+    unsigned int count()    // RET: number of values in the ring
+    {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Determine if the ring has no values
+     */
+    bool empty()    // RET: true if no values to pop
+    {
+        return 0 == count();
+    }
+
+    /**
+     * Get the number of pushes that failed because the ring was full
+     */
+    unsigned int dropped()  // RET: number of dropped values since construction
+    {
+        return _dropped.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Copy a value into the ring.
+     *
+     * NOTE: only call from the producer side.
+     */
+    bool push(const T &theValue)    // IN : value to copy into the ring
+                                    // RET: true if value was added,
+                                    //      false if ring was full and value was dropped
+    {
+        const unsigned int head = _head.load(std::memory_order_relaxed);
+        if((head - _tail.load(std::memory_order_acquire)) >= CAPACITY) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        _buffer[head & (CAPACITY - 1)] = theValue;
+        _head.store(head + 1, std::memory_order_release);   // publish slot to consumer
+        return true;
+    }
+
+    /**
+     * Copy the oldest value out of the ring.
+     *
+     * NOTE: only call from the consumer side.
+     */
+    bool pop(T &theValue)   // OUT: on true, the oldest value in the ring
+                            //      otherwise unchanged.
+                            // RET: true if a value was removed,
+                            //      false if the ring was empty
+    {
+        const unsigned int tail = _tail.load(std::memory_order_relaxed);
+        if(tail == _head.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        theValue = _buffer[tail & (CAPACITY - 1)];
+        _tail.store(tail + 1, std::memory_order_release);   // release slot to producer
+        return true;
+    }
+};
+
+#endif // UTIL_SPSC_RING_H
@@ -5,15 +5,28 @@
 #include "../string/strcopy.h"
 #include "../rover/rover.h"
 #include "../rover/rover_command.h"
+#include "../telemetry.h"
 
 #define LOG_LEVEL ERROR_LEVEL
 #include "../log.h"
 
 extern TwoWheelRover rover; // declared in main.cpp
 extern RoverCommandProcessor roverCommandProcessor; // declared in main.cpp
+extern TelemetrySender telemetry;   // declared in main.cpp
+#ifdef USE_CONTROL_TASK
+    #include "../util/spsc_ring.h"
+    extern SpscRing<QueuedCommand, COMMAND_RING_COUNT> commandRing;    // declared in main.cpp
+    extern SpscRing<CommandAck, COMMAND_RING_COUNT> ackRing;           // declared in main.cpp
+
+    //
+    // commands handed to the control core that have
+    // not been acked; kept to the size of the ack ring
+    // so the control core always has room for the ack.
+    //
+    static unsigned int commandsInFlight = 0;
+#endif
 
 void wsCommandEvent(unsigned char clientNum, WStype_t type, unsigned char * payload, unsigned int length);
-void logWsEvent(const char *event, const int id);
 
 int commandClientId = -1;       // websocket client id for rover commands
 bool isCommandSocketOn = false; // true if command socket is ready
@@ -24,7 +37,32 @@ void wsCommandInit() {
     wsCommand.onEvent(wsCommandEvent);
 }
 
+/**
+ * Ack a command by sending it back,
+ * or nack it with it's status
+ */
+static void wsCommandAck(
+    unsigned char clientNum,    // IN : client that sent the command
+    int status,                 // IN : SUCCESS or error from submitting the command
+    const char *text,           // IN : command text
+    unsigned int length)        // IN : bytes in text
+{
+    if(SUCCESS == status) {
+        wsCommand.sendTXT(clientNum, text, length);
+    } else {
+        wsCommand.sendTXT(clientNum, String("nack(") + String(status) + String(")"));
+    }
+}
+
 void wsCommandPoll() {
+    #ifdef USE_CONTROL_TASK
+        // ack or nack the commands the control core has executed
+        CommandAck ack;
+        while(ackRing.pop(ack)) {
+            commandsInFlight -= 1;
+            wsCommandAck(ack.clientNum, ack.status, ack.text, strlen(ack.text));
+        }
+    #endif
     wsCommand.loop();
 }
 
@@ -37,6 +75,15 @@ void wsSendCommandText(const char *msg, unsigned int length) {
     }
 }
 
+/**
+ * send a binary message to the command client
+ */
+void wsSendCommandBinary(const uint8_t *msg, unsigned int length) {
+    if(isCommandSocketOn && (commandClientId >= 0)) {
+        wsCommand.sendBIN(commandClientId, msg, length);
+    }
+}
+
 void wsCommandLogger(const char *msg, int value) {
     char buffer[128];
 
@@ -55,74 +102,72 @@ void wsCommandLogger(const char *msg, int value) {
 void wsCommandEvent(unsigned char clientNum, WStype_t type, unsigned char * payload, unsigned int length) {
     switch(type) {
         case WStype_CONNECTED: {
-            logWsEvent("wsCommandEvent.WS_EVT_CONNECT", clientNum);
+            LOGT_INFO(LOG_COMMAND_CONNECTED, (int)clientNum);
             wsCommand.sendPing(clientNum, (uint8_t *)"ping", sizeof("ping"));
             return;
         }
         case WStype_DISCONNECTED: {
-            logWsEvent("wsCommandEvent.WS_EVT_DISCONNECT", clientNum);
+            LOGT_INFO(LOG_COMMAND_DISCONNECTED, (int)clientNum);
             if (commandClientId == clientNum) {
                 commandClientId = -1;
                 isCommandSocketOn = false;
+                telemetry.setFormat(TELEMETRY_TEXT);  // next client must ask for binary
+                telemetry.setDelta(false);              // or delta encoding
+                telemetry.resetChannels();              // and for any channel rates
+                telemetry.cancelHistory();              // nobody is listening for the backlog
             }
             return;
         } 
         case WStype_PONG: {
-            logWsEvent("wsCommandEvent.WStype_PONG", clientNum);
+            LOGT_INFO(LOG_COMMAND_PONG, (int)clientNum);
             commandClientId = clientNum;
             isCommandSocketOn = true;
             return;
         }
         case WStype_BIN: {
-            logWsEvent("wsCommandEvent.WStype_BIN", clientNum);
+            LOGT_INFO(LOG_COMMAND_BINARY, (int)clientNum);
             return;
         }
         case WStype_TEXT: {
-            // log the command
-            char buffer[128];
-            #ifdef LOG_LEVEL
-                #if (LOG_LEVEL >= INFO_LEVEL)
-                    const int offset = strCopy(buffer, sizeof(buffer), "wsCommandEvent.WStype_TEXT: ");
-                    strCopySizeAt(buffer, sizeof(buffer), offset, (const char *)payload, length);
-                    logWsEvent(buffer, clientNum);
-                #endif
-            #endif
+            LOGT_INFO(LOG_COMMAND_TEXT, (int)clientNum, length);
 
-            // submit the command for execution
-            strCopySize(buffer, sizeof(buffer), (const char *)payload, (int)length);
-            const SubmitCommandResult result = roverCommandProcessor.submitCommand(buffer, 0);
-            if(SUCCESS == result.status) {
+            #ifdef USE_CONTROL_TASK
                 //
-                // ack the command by sending it back
+                // parse here so a bad command is nacked;
+                // telemetry commands are executed on this core,
+                // which sends telemetry, and the others are
+                // handed to the control core, which hands back
+                // their status to be acked in wsCommandPoll().
                 //
-                wsCommand.sendTXT(clientNum, (const char *)payload, length);
-            } else {
-                //
-                // nack the command with status
-                //
-                wsCommand.sendTXT(clientNum, String("nack(") + String(result.status) + String(")"));
-            }
+                QueuedCommand command;
+                strCopySize(command.text, sizeof(command.text), (const char *)payload, (int)length);
+                const SubmitCommandResult parsed = roverCommandProcessor.parseCommandText(command.text, 0);
+                int status = parsed.status;
+                if(SUCCESS == status) {
+                    command.command = parsed.command;
+                    command.clientNum = clientNum;
+                    if(isTelemetryCommand(command.command.type)) {
+                        status = roverCommandProcessor.executeCommand(command.command, command.text);
+                    } else if((commandsInFlight >= COMMAND_RING_COUNT) || !commandRing.push(command)) {
+                        status = COMMAND_ENQUEUE_FAILURE;
+                    } else {
+                        commandsInFlight += 1;
+                        return;
+                    }
+                }
+            #else
+                // submit the command for execution
+                char buffer[128];
+                strCopySize(buffer, sizeof(buffer), (const char *)payload, (int)length);
+                const int status = roverCommandProcessor.submitCommand(buffer, 0).status;
+            #endif
+            wsCommandAck(clientNum, status, (const char *)payload, length);
             return;
         }
         default: {
-            logWsEvent("wsCommandEvent.UNHANDLED EVENT: ", clientNum);
+            LOGT_INFO(LOG_COMMAND_UNHANDLED, (int)type, (int)clientNum);
             return;
         }
     }
 }
 
-
-void logWsEvent(
-    const char *event,  // IN : name of event as null terminated string
-    const int id)       // IN : client id to copy
-{
-    #ifdef LOG_LEVEL
-        #if (LOG_LEVEL >= INFO_LEVEL)
-            char msg[128];
-            int offset = strCopy(msg, sizeof(msg), event);
-            offset = strCopyAt(msg, sizeof(msg), offset, ", clientId: ");
-            strCopyIntAt(msg, sizeof(msg), offset, id);
-            LOG_INFO(msg);
-        #endif
-    #endif
-}
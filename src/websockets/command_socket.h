@@ -1,9 +1,12 @@
 #ifndef COMMAND_SOCKET_H
 #define COMMAND_SOCKET_H
 
+#include <stdint.h>
+
 extern void wsCommandInit();
 extern void wsCommandPoll();
 extern void wsSendCommandText(const char *msg, unsigned int length);
+extern void wsSendCommandBinary(const uint8_t *msg, unsigned int length);
 extern void wsCommandLogger(const char *msg, int value);
 
 #endif // COMMAND_SOCKET_H
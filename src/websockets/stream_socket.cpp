@@ -3,12 +3,14 @@
 #include "command_socket.h"
 
 #include "../string/strcopy.h"
-#include "../camera/camera_wrap.h"
+#include "../camera/camera_capture.h"
 #include "../error.h"
 
 #define LOG_LEVEL ERROR_LEVEL
 #include "../log.h"
 
+extern CameraCapture cameraCapture;    // declared in main.cpp
+
 void wsStreamEvent(unsigned char clientNum, WStype_t type, uint8_t * payload, size_t length);
 
 WebSocketsServer wsStream = WebSocketsServer(81);
@@ -37,45 +39,38 @@ int wsStreamSendImage(unsigned char *imageBuffer, unsigned int bufferSize) {
 }
 
 //
-// get a camera image and send it down websocket
+// send the newest camera image down websocket;
+// images are captured by the camera task,
+// so this never waits on the camera.
 //
 void wsStreamCameraImage() {
     if (isCameraStreamOn && (cameraClientId >= 0)) {
-        //
-        // grab and image and call sendImage on it
-        //
-        esp_err_t result = processImage(wsStreamSendImage);
-        if (SUCCESS != result) {
-            LOG_ERROR("Failure grabbing and sending image.");
+        if (!cameraCapture.capturing()) {
+            cameraCapture.start();
+        }
+        CameraFrame *frame = cameraCapture.take();
+        if (nullptr != frame) {
+            if (SUCCESS != wsStreamSendImage(frame->buf, frame->len)) {
+                LOGT_ERROR(LOG_STREAM_IMAGE_FAILED);
+            }
+            cameraCapture.release(frame);
         }
+    } else if (cameraCapture.capturing()) {
+        // no one is watching; give back any frame that was not sent
+        cameraCapture.stop();
     }
 }
 
-void logWsStreamEvent(
-    const char *event,  // IN : name of event as null terminated string
-    const int id)       // IN : client id to copy
-{
-    #ifdef LOG_LEVEL
-        #if (LOG_LEVEL >= INFO_LEVEL)
-            char msg[128];
-            int offset = strCopy(msg, sizeof(msg), event);
-            offset = strCopyAt(msg, sizeof(msg), offset, ", clientId: ");
-            strCopyIntAt(msg, sizeof(msg), offset, id);
-            LOG_INFO(msg);
-        #endif
-    #endif
-}
-
 void wsStreamEvent(unsigned char clientNum, WStype_t type, uint8_t * payload, size_t length) {
     switch(type) {
         case WStype_CONNECTED: {
-            logWsStreamEvent("wsStreamEvent.WS_EVT_CONNECT", clientNum);
+            LOGT_INFO(LOG_STREAM_CONNECTED, (int)clientNum);
             wsStream.sendPing(clientNum, (uint8_t *)"ping", sizeof("ping"));
             return;
         }
         case WStype_DISCONNECTED: {
             // os_printf("wsStream[%s][%u] disconnect: %u\n", server->url(), client->id());
-            logWsStreamEvent("wsStreamEvent.WS_EVT_DISCONNECT", clientNum);
+            LOGT_INFO(LOG_STREAM_DISCONNECTED, (int)clientNum);
             if (cameraClientId == clientNum) {
                 cameraClientId = -1;
                 isCameraStreamOn = false;
@@ -83,24 +78,21 @@ void wsStreamEvent(unsigned char clientNum, WStype_t type, uint8_t * payload, si
             return;
         } 
         case WStype_PONG: {
-            logWsStreamEvent("wsStreamEvent.WStype_PONG", clientNum);
+            LOGT_INFO(LOG_STREAM_PONG, (int)clientNum);
             cameraClientId = clientNum;
             isCameraStreamOn = true;
             return;
         }
         case WStype_BIN: {
-            logWsStreamEvent("wsStreamEvent.WStype_BIN", clientNum);
+            LOGT_INFO(LOG_STREAM_BINARY, (int)clientNum);
             return;
         }
         case WStype_TEXT: {
-            char buffer[128];
-            int offset = strCopy(buffer, sizeof(buffer), "wsStreamEvent.WStype_TEXT: ");
-            strCopySizeAt(buffer, sizeof(buffer), offset, (char *)payload, length);
-            logWsStreamEvent(buffer, clientNum);
+            LOGT_INFO(LOG_STREAM_TEXT, (int)clientNum, (unsigned int)length);
             return;
         }
         default: {
-            logWsStreamEvent("wsStreamEvent.UNHANDLED EVENT: ", clientNum);
+            LOGT_INFO(LOG_STREAM_UNHANDLED, (int)type, (int)clientNum);
             return;
         }
     }
@@ -126,6 +126,45 @@ DriveWheel& DriveWheel::setSpeedControl(
     return *this;
 }
 
+/**
+ * Set acceleration limits.
+ * Speeds passed to setSpeed() and power passed to
+ * setPower() are ramped toward at these limits,
+ * rather than sent to the wheel at once, so the
+ * wheel does not slip or draw a spike of current.
+ */
+DriveWheel& DriveWheel::setAccelerationLimits(
+    speed_type maxAcceleration, // IN : cm/sec² limit on change in speed; 0 for no limit
+    speed_type maxJerk,         // IN : cm/sec³ limit on change in acceleration; 0 for no limit
+    float maxPwmRate,           // IN : pwm/sec limit on change in power; 0 for no limit
+    float maxPwmJerk)           // IN : pwm/sec² limit on change in power rate; 0 for no limit
+                                // RET: this DriveWheel
+{
+    _maxAcceleration = maxAcceleration;
+    _maxJerk = maxJerk;
+    _maxPwmRate = maxPwmRate;
+    _maxPwmJerk = maxPwmJerk;
+    if(_useSpeedControl) {
+        _ramp.setLimits((float)_maxAcceleration, (float)_maxJerk);
+    } else {
+        _ramp.setLimits(_maxPwmRate, _maxPwmJerk);
+    }
+
+    return *this;
+}
+
+/**
+ * Scale this wheel's acceleration limits for the
+ * ramp in progress, so it finishes at the same time
+ * as the other wheel's ramp.
+ */
+DriveWheel& DriveWheel::setRampScale(float scale)   // IN : 0 to 1 multiplier of limits
+                                                    // RET: this DriveWheel
+{
+    _ramp.setScale(scale);
+    return *this;
+}
+
 /**
  * Read wheel encoder count.
  * This is a signed value that increases or descreased 
@@ -156,8 +195,13 @@ DriveWheel& DriveWheel::halt() // RET: this drive wheel
     // disengage speed control
     this->_history.truncateTo(0);
     this->_lastSpeed = 0;
+    this->_targetSpeed = 0;
+    this->_speedTrim = 0;
     this->_useSpeedControl = false;
 
+    // a halt is not ramped
+    this->_ramp.reset(0);
+
     // stop the wheel
     _setPwm(true, 0);
 
@@ -227,8 +271,21 @@ DriveWheel& DriveWheel::setPower(
                         // RET: this drive wheel
 {
     if(attached()) {
-        this->_useSpeedControl = false;
-        this->_setPwm(forward, pwm);
+        if(this->_useSpeedControl) {
+            // continue from the power speed control left the motor at
+            this->_useSpeedControl = false;
+            this->_ramp.reset(this->forward() ? (float)_motor->pwm() : -(float)_motor->pwm());
+        }
+        this->_ramp.setLimits(_maxPwmRate, _maxPwmJerk);
+
+        // below stall pwm the motor does not turn, so starting from a stop begin at stall
+        if((0 == _ramp.value()) && (pwm > _motor->stallPwm())) {
+            this->_ramp.reset(forward ? (float)_motor->stallPwm() : -(float)_motor->stallPwm());
+        }
+        this->_ramp.setTarget(forward ? (float)pwm : -(float)pwm);
+
+        const float power = _ramp.value();
+        this->_setPwm((power > 0) || ((0 == power) && forward), (pwm_type)(abs(power) + 0.5f));
     }
     return *this;
 }
@@ -239,12 +296,46 @@ DriveWheel& DriveWheel::setPower(
  * The first time this is called, it will enable the
  * speed controller, which will then start
  * maintaining the requested target speed.
+ * The setpoint ramps to the target speed at
+ * the acceleration limits.
  * Calling halt() or setPower() will disable the speed controller.
  * 
  * NOTE: your code should use either 
  *       setPower() or setSpeed() but not both.
  */
 DriveWheel& DriveWheel::setSpeed(speed_type speed)
+{
+    if(attached()) {
+        if(!_useSpeedControl) {
+            // ramp from the speed the wheel is going now; zero after a halt
+            this->_ramp.reset((float)_lastSpeed);
+        }
+        this->_ramp.setLimits((float)_maxAcceleration, (float)_maxJerk);
+
+        //
+        // if we are turning on speed control or
+        // if we are changing speed.
+        //
+        if((!_useSpeedControl) || (speed != _ramp.target())) {
+            this->_ramp.setTarget((float)speed);
+            this->_setSetpoint(_ramp.value());
+
+            // publish target speed change message
+            if(NULL != _messageBus) {
+                publish(*_messageBus, TARGET_SPEED, specifier());
+            }
+        }
+    }
+
+    return *this;
+}
+
+/**
+ * Set speed control's setpoint, estimating
+ * the pwm if speed control is just starting.
+ */
+DriveWheel& DriveWheel::_setSetpoint(speed_type speed)  // IN : setpoint speed
+                                                        // RET: this drive wheel
 {
     if(attached()) {
         //
@@ -258,11 +349,15 @@ DriveWheel& DriveWheel::setSpeed(speed_type speed)
             // or we are starting from a stop, 
             // or we are chaning direction, then
             // estimate initial pwm so speed control
-            // converges faster.
+            // converges faster.  While ramping, each
+            // step of the setpoint is too small to
+            // trigger that, so the pwm follows the
+            // feed forward of the ramp and speed
+            // control corrects it once the ramp is done.
             //
             const speed_type speedPerPwm = (_maxSpeed - _minSpeed) / (speed_type)(255 - _motor->stallPwm());
             const speed_type deltaPwm = (speed - _targetSpeed) / speedPerPwm;
-            if((!_useSpeedControl) || (0 == _targetSpeed) || (deltaPwm > 3)) {
+            if((!_useSpeedControl) || (0 == _targetSpeed) || (0 == _motor->pwm()) || (deltaPwm > 3) || !_ramp.done()) {
                 // use feed forward to estimate initial pwm
                 if(abs(speed) >= abs(this->_minSpeed)) {
                     // scale within drivable speeds
@@ -276,11 +371,6 @@ DriveWheel& DriveWheel::setSpeed(speed_type speed)
 
             this->_targetSpeed = speed;
             this->_useSpeedControl = true;
-
-            // publish target speed change message
-            if(NULL != _messageBus) {
-                publish(*_messageBus, TARGET_SPEED, specifier());
-            }
         }
     }
 
@@ -293,14 +383,38 @@ DriveWheel& DriveWheel::setSpeed(speed_type speed)
  * Poll drive wheel systems
  */
 DriveWheel& DriveWheel::poll(
-    unsigned long currentMillis)    // IN : current milliseconds from startup 
+    unsigned long)                  // IN : current milliseconds from startup 
                                     // RET: this drive wheel
 {
     _pollEncoder();
+    _pollRamp(millis());
     _pollSpeed(millis());
     return *this;
 }
 
+/**
+ * Poll the acceleration limited ramp and
+ * send it's setpoint to speed control or the motor
+ */
+DriveWheel& DriveWheel::_pollRamp(
+    unsigned long currentMillis)    // IN : current milliseconds from startup 
+                                    // RET: this drive wheel
+{
+    const float seconds = (0 == _rampMs) ? 0 : (currentMillis - _rampMs) / 1000.0f;
+    _rampMs = currentMillis;
+
+    if(attached() && !_ramp.done()) {
+        const float setpoint = _ramp.step(seconds);
+        if(_useSpeedControl) {
+            _setSetpoint(setpoint);
+        } else {
+            _setPwm(setpoint >= 0, (pwm_type)(abs(setpoint) + 0.5f));
+        }
+    }
+
+    return *this;
+}
+
 /**
  * Poll wheel encoders
  */
@@ -336,7 +450,7 @@ DriveWheel& DriveWheel::_pollSpeed(
             encoder_count_type encoderTicks = this->encoderTicks();
             if((encoderTicks - _lastEncoderTicks) >=  CONTROL_MIN_ENCODER_COUNT) {
                 encoder_count_type encoderCount = this->encoderCount();
-                const distance_type currentDistance = _circumference * (distance_type)encoderCount / _pulsesPerRevolution;
+                const distance_type currentDistance = _circumference * ((distance_type)encoderCount / _pulsesPerRevolution);
                 speed_type currentSpeed = 0; // assume coldstart (no prior reading/history)
 
                 if(_history.count() > 0) {
@@ -350,7 +464,8 @@ DriveWheel& DriveWheel::_pollSpeed(
                         pwm_type pwm = _motor->pwm();
 
                         // const speed_type error = _targetSpeed - currentSpeed;
-                        const int speedComparison = compareTo<speed_type>(abs(currentSpeed), abs(_targetSpeed), SPEED_TOLERANCE);
+                        // the trim is smaller than the setpoint, so it does not change direction
+                        const int speedComparison = compareTo<speed_type>(abs(currentSpeed), abs(_targetSpeed + _speedTrim), SPEED_TOLERANCE);
 
                         // just use a constant controller
                         if((0 != currentSpeed) && (sign(currentSpeed) != sign(_targetSpeed))) {
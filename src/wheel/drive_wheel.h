@@ -5,15 +5,14 @@
 #include "../encoder/encoder.h"
 #include "../message_bus/message_bus.h"
 #include "../util/circular_buffer.h"
+#include "./setpoint_ramp.h"
 #include "../rover/pose.h"
 
 #include "../config.h"
 
-typedef float speed_type;
-
 typedef struct history_type {
     unsigned long millis;
-    float distance;
+    distance_type distance;
 } history_type;
 
 extern history_type _historyDefault; // default value for empty history 
@@ -29,13 +28,23 @@ class DriveWheel : public Publisher {
     static const unsigned int _pollSpeedMillis = CONTROL_POLL_MS;  // how often to run closed loop speed control
     bool _useSpeedControl = false;
     encoder_count_type _lastEncoderTicks = 0;
-    speed_type _targetSpeed = 0;
+    speed_type _targetSpeed = 0;    // speed controller's setpoint, ramping toward _ramp.target()
     speed_type _lastSpeed = 0;
     speed_type _lastTotalError = 0;
     speed_type _minSpeed = 0;       // measured minimum speed below which motor stalls
     speed_type _maxSpeed = 0;       // measured maximum speed of motor
     float _Kp = 0, _Ki = 0, _Kd = 0;  // PID gains
 
+    // acceleration limits; the ramp is of speed with speed control, signed pwm without
+    SetpointRamp _ramp;
+    speed_type _maxAcceleration = WHEEL_MAX_ACCELERATION;
+    speed_type _maxJerk = WHEEL_MAX_JERK;
+    float _maxPwmRate = WHEEL_MAX_PWM_RATE;
+    float _maxPwmJerk = WHEEL_MAX_PWM_JERK;
+    unsigned long _rampMs = 0;      // time of last ramp step
+
+    speed_type _speedTrim = 0;      // added to the setpoint by the rover to keep the wheels in sync
+
     // motor state
     pwm_type _pwm = 0;
     pwm_type _forward = 1;
@@ -59,6 +68,21 @@ class DriveWheel : public Publisher {
      */
     DriveWheel& _pollEncoder();   // RET: this drive wheel
 
+    /**
+     * Poll the acceleration limited ramp and
+     * send it's setpoint to speed control or the motor
+     */
+    DriveWheel& _pollRamp(
+        unsigned long currentMillis);   // IN : current milliseconds from startup 
+                                        // RET: this drive wheel
+
+    /**
+     * Set speed control's setpoint, estimating
+     * the pwm if speed control is just starting.
+     */
+    DriveWheel& _setSetpoint(speed_type speed); // IN : setpoint speed
+                                                // RET: this drive wheel
+
     /**
      * Poll the closed loop (PID) speed control
      */
@@ -78,9 +102,9 @@ class DriveWheel : public Publisher {
     public:
 
     DriveWheel(
-        const Specifier specifier,  // IN : which wheel
-        float circumference)        // IN : circumference of wheel.
-                                    //      Note: use 1.0 to deal in pulsesPerRevolution of encoder
+        const Specifier specifier,      // IN : which wheel
+        distance_type circumference)    // IN : circumference of wheel.
+                                        //      Note: use 1.0 to deal in pulsesPerRevolution of encoder
         :   Publisher(specifier), 
             _circumference(circumference), 
             _history(_historyBuffer, sizeof(_historyBuffer) / sizeof(history_type), _historyDefault)
@@ -152,6 +176,47 @@ class DriveWheel : public Publisher {
         float Kd);              // IN : derivative gain
                                 // RET: this DriveWheel
 
+    /**
+     * Set acceleration limits.
+     * Speeds passed to setSpeed() and power passed to
+     * setPower() are ramped toward at these limits,
+     * rather than sent to the wheel at once, so the
+     * wheel does not slip or draw a spike of current.
+     */
+    DriveWheel& setAccelerationLimits(
+        speed_type maxAcceleration, // IN : cm/sec² limit on change in speed; 0 for no limit
+        speed_type maxJerk,         // IN : cm/sec³ limit on change in acceleration; 0 for no limit
+        float maxPwmRate,           // IN : pwm/sec limit on change in power; 0 for no limit
+        float maxPwmJerk);          // IN : pwm/sec² limit on change in power rate; 0 for no limit
+                                    // RET: this DriveWheel
+
+    /**
+     * Scale this wheel's acceleration limits for the
+     * ramp in progress, so it finishes at the same time
+     * as the other wheel's ramp.
+     */
+    DriveWheel& setRampScale(float scale);  // IN : 0 to 1 multiplier of limits
+                                            // RET: this DriveWheel
+
+    /**
+     * Get the change the ramp has left to make,
+     * in speed with speed control, otherwise in pwm.
+     */
+    float rampRemaining() { return _ramp.remaining(); }
+
+    /**
+     * Set a small speed added to the speed control
+     * setpoint, so the rover can keep this wheel in
+     * step with the other.  It must be smaller than
+     * the setpoint so it never reverses the wheel.
+     */
+    DriveWheel& setSpeedTrim(speed_type trim)   // IN : speed added to setpoint
+    {                                           // RET: this DriveWheel
+        _speedTrim = trim;
+        return *this;
+    }
+    speed_type speedTrim() { return _speedTrim; }   // RET: speed added to setpoint
+
     /**
      * Read wheel encoder count.
      * This is a signed value that increases or descreased 
@@ -196,10 +261,13 @@ class DriveWheel : public Publisher {
      */
     bool forward() { return (nullptr != _motor) ? _motor->forward() : true; }
 
-    speed_type useSpeedControl() { return _useSpeedControl; }
+    bool useSpeedControl() { return _useSpeedControl; }
 
     /**
      * Send speed and direction to left wheel.
+     * The pwm ramps to the new value at the pwm
+     * limits; starting from a stop, it starts
+     * at the motor's stall value.
      * 
      * NOTE: your code should use either 
      *       setPower() or setSpeed() but not both.
@@ -231,6 +299,15 @@ class DriveWheel : public Publisher {
      * Get the last set target speed
      */
     speed_type targetSpeed() // RET: last value passed to setSpeed()
+    { 
+        return _useSpeedControl ? _ramp.target() : 0; 
+    }
+
+    /**
+     * Get the speed control setpoint, which ramps
+     * toward the target speed at the acceleration limits
+     */
+    speed_type setpointSpeed() // RET: current speed control setpoint
     { 
         return this->_targetSpeed; 
     }
@@ -246,7 +323,7 @@ class DriveWheel : public Publisher {
     /**
      * Get the last measured total distance travelled
      */
-    float distance()    // RET: last measured total distance
+    distance_type distance()    // RET: last measured total distance
     {
         // entry at head of circular buffer is most recent
         return _history.head().distance;
@@ -267,6 +344,8 @@ class DriveWheel : public Publisher {
      * The first time this is called, it will enable the
      * speed controller, which will then start
      * maintaining the requested target speed.
+     * The setpoint ramps to the target speed at
+     * the acceleration limits.
      * Calling halt() will disable the speed controller.
      * 
      * NOTE: your code should use either 
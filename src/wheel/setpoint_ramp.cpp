@@ -0,0 +1,109 @@
+#include <math.h>
+
+#include "setpoint_ramp.h"
+#include "../util/math.h"
+
+/**
+ * Set the limits of the ramp
+ */
+SetpointRamp& SetpointRamp::setLimits(
+    float maxRate,  // IN : most change in setpoint per second; 0 for no limit
+    float maxJerk)  // IN : most change in rate per second; 0 for no limit
+                    // RET: this ramp
+{
+    _maxRate = (maxRate > 0) ? maxRate : 0;
+    _maxJerk = (maxJerk > 0) ? maxJerk : 0;
+    return *this;
+}
+
+/**
+ * Scale the limits, to slow this ramp so it
+ * finishes at the same time as another.
+ */
+SetpointRamp& SetpointRamp::setScale(float scale)   // IN : 0 to 1 multiplier of the limits
+                                                    // RET: this ramp
+{
+    _scale = bound<float>(scale, 0, 1);
+    return *this;
+}
+
+/**
+ * Set the value to ramp toward
+ */
+SetpointRamp& SetpointRamp::setTarget(float target) // IN : value to ramp toward
+                                                    // RET: this ramp
+{
+    _target = target;
+    if(0 == _maxRate) {
+        // no limit, so no ramp
+        _value = target;
+        _rate = 0;
+    }
+    return *this;
+}
+
+/**
+ * Jump to a value without ramping
+ * and stop any ramp in progress.
+ */
+SetpointRamp& SetpointRamp::reset(float value)  // IN : new setpoint and target
+                                                // RET: this ramp
+{
+    _value = value;
+    _target = value;
+    _rate = 0;
+    return *this;
+}
+
+/**
+ * Advance the setpoint along the ramp
+ */
+float SetpointRamp::step(float seconds) // IN : time since last step
+                                        // RET: new setpoint
+{
+    if(done() || (seconds <= 0)) {
+        return _value;
+    }
+    if(0 == _maxRate) {
+        return reset(_target)._value;
+    }
+
+    const float maxRate = _maxRate * _scale;
+    const float remaining = _target - _value;
+    const float direction = (0 != remaining) ? sign(remaining) : -sign(_rate);
+    float rate;
+    if(0 == _maxJerk) {
+        // trapezoid; full rate toward the target
+        rate = direction * maxRate;
+    } else {
+        //
+        // s-curve; use the fastest rate, within the jerk limit,
+        // from which the setpoint can still slow to a stop at the
+        // jerk limit exactly on the target.  From rate r at
+        // jerk j, stopping takes r²/2j, so the new rate n solves
+        // remaining = (rate + n)·seconds/2 + n²/2j.
+        //
+        const float maxJerk = _maxJerk * _scale;
+        const float change = maxJerk * seconds;
+        const float toward = remaining * direction;   // remaining and rate in the direction of the target
+        const float rateToward = _rate * direction;
+        if((rateToward <= change) && (toward <= change * seconds / 2)) {
+            // close enough to stop on the target this step
+            return reset(_target)._value;
+        }
+        const float discriminant = seconds * seconds / 4 + 2 * (toward - rateToward * seconds / 2) / maxJerk;
+        const float fit = (discriminant > 0) ? maxJerk * (sqrtf(discriminant) - seconds / 2) : (rateToward - change);
+        const float fastest = (rateToward + change < maxRate) ? (rateToward + change) : maxRate;
+        rate = direction * bound<float>(fit, rateToward - change, fastest);
+    }
+
+    // with a jerk limit the rate changes over the step, and the average of the old and new rate is exact
+    _value += ((0 == _maxJerk) ? rate : (_rate + rate) / 2) * seconds;
+    _rate = rate;
+
+    // stop on the target rather than overshoot it
+    if((_target - _value) * direction <= 0) {
+        reset(_target);
+    }
+    return _value;
+}
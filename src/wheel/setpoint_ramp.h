@@ -0,0 +1,78 @@
+#ifndef WHEEL_SETPOINT_RAMP_H
+#define WHEEL_SETPOINT_RAMP_H
+
+/**
+ * Jerk limited trapezoidal ramp of a setpoint toward a target.
+ *
+ * When the target changes, the setpoint does not jump to it;
+ * each step() moves it along a profile whose rate of change
+ * (acceleration, for a speed) is at most maxRate, and whose
+ * rate of change of rate (jerk) is at most maxJerk.  With
+ * both limits the profile is an s-curve; with no jerk limit
+ * it is a trapezoid; with no rate limit it jumps.
+ *
+ * Units are whatever the setpoint is in; a DriveWheel uses
+ * one for speed in cm/sec, with rate in cm/sec² and jerk
+ * in cm/sec³, and one for signed pwm.
+ *
+ * The scale multiplies both limits.  Two ramps that start
+ * together, with scales proportional to the change each must
+ * make, follow profiles of the same shape and finish together,
+ * so the ratio of their setpoints stays the same as they ramp.
+ * TwoWheelRover uses that to keep the curvature of the rover's
+ * path while both wheels ramp.
+ */
+class SetpointRamp {
+    private:
+    float _value = 0;       // current setpoint
+    float _target = 0;      // value the setpoint ramps toward
+    float _rate = 0;        // current rate of change of setpoint per second
+    float _maxRate = 0;     // limit on rate per second; 0 is no limit
+    float _maxJerk = 0;     // limit on change of rate per second; 0 is no limit
+    float _scale = 1;       // 0 to 1 multiplier of limits
+
+    public:
+
+    /**
+     * Set the limits of the ramp
+     */
+    SetpointRamp& setLimits(
+        float maxRate,  // IN : most change in setpoint per second; 0 for no limit
+        float maxJerk); // IN : most change in rate per second; 0 for no limit
+                        // RET: this ramp
+
+    /**
+     * Scale the limits, to slow this ramp so it
+     * finishes at the same time as another.
+     */
+    SetpointRamp& setScale(float scale);    // IN : 0 to 1 multiplier of the limits
+                                            // RET: this ramp
+
+    /**
+     * Set the value to ramp toward
+     */
+    SetpointRamp& setTarget(float target);  // IN : value to ramp toward
+                                            // RET: this ramp
+
+    /**
+     * Jump to a value without ramping
+     * and stop any ramp in progress.
+     */
+    SetpointRamp& reset(float value);   // IN : new setpoint and target
+                                        // RET: this ramp
+
+    /**
+     * Advance the setpoint along the ramp
+     */
+    float step(float seconds);  // IN : time since last step
+                                // RET: new setpoint
+
+    float value() { return _value; }        // RET: current setpoint
+    float target() { return _target; }      // RET: value being ramped toward
+    float rate() { return _rate; }          // RET: current rate of change per second
+    float remaining() { return _target - _value; }  // RET: change left to make
+    bool done() { return (_value == _target) && (0 == _rate); }  // RET: true if setpoint is at target
+    bool limited() { return _maxRate > 0; } // RET: true if the setpoint ramps rather than jumps
+};
+
+#endif // WHEEL_SETPOINT_RAMP_H
@@ -0,0 +1,54 @@
+#ifndef REPLAY_ARDUINO_H
+#define REPLAY_ARDUINO_H
+
+//
+// Just enough of the Arduino api to build the
+// rover's wheel and pose code on the host for replay.
+// Time comes from a virtual clock that the replay
+// advances, so replays are deterministic and
+// run as fast as the host can go.
+//
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <algorithm>
+
+using std::max;
+using std::min;
+
+typedef bool boolean;
+
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define LOW 0x0
+#define HIGH 0x1
+
+extern unsigned long replayMillis;  // virtual clock in ms since startup
+
+inline unsigned long millis() { return replayMillis; }
+inline unsigned long micros() { return replayMillis * 1000; }
+
+// gpio is not simulated; encoders are driven by calling Encoder::encode()
+inline void pinMode(uint8_t, uint8_t) {}
+inline int digitalRead(uint8_t) { return LOW; }
+inline void digitalWrite(uint8_t, uint8_t) {}
+inline void analogWrite(uint8_t, int) {}
+
+/**
+ * The little bit of Arduino's String the rover headers use
+ */
+class String : public std::string {
+    public:
+    String() {}
+    String(const char *value) : std::string(nullptr != value ? value : "") {}
+    String(const std::string &value) : std::string(value) {}
+    unsigned int length() const { return (unsigned int)size(); }
+    char charAt(unsigned int index) const { return (index < size()) ? (*this)[index] : 0; }
+    String substring(unsigned int from, unsigned int to) const { return String(std::string::substr(from, to - from)); }
+    String substring(unsigned int from) const { return String(std::string::substr(from)); }
+};
+
+#endif // REPLAY_ARDUINO_H
@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "file_frame_source.h"
+
+FileFrameSource::FileFrameSource(
+    const char **paths,         // IN : JPEG files to read
+    unsigned int pathCount)     // IN : number of files
+    :   _paths(paths),
+        _pathCount(pathCount)
+{
+    for(unsigned int i = 0; i < FRAME_COUNT; i += 1) {
+        _frames[i] = {nullptr, 0};
+        _capacity[i] = 0;
+        _sequence[i] = 0;
+        _held[i].store(false);
+    }
+}
+
+FileFrameSource::~FileFrameSource() {
+    for(unsigned int i = 0; i < FRAME_COUNT; i += 1) {
+        free(_frames[i].buf);
+    }
+}
+
+/**
+ * Read the next file into a free frame
+ */
+CameraFrame *FileFrameSource::grab()    // RET: frame owned by the caller or nullptr
+                                        //      if every frame is held or the file can not be read
+{
+    if(0 == _pathCount) {
+        return nullptr;
+    }
+
+    // find a frame that is not held
+    unsigned int i = 0;
+    for(; i < FRAME_COUNT; i += 1) {
+        if(!_held[i].load(std::memory_order_acquire)) {
+            break;
+        }
+    }
+    if(i >= FRAME_COUNT) {
+        return nullptr;
+    }
+
+    FILE *file = fopen(_paths[_nextPath], "rb");
+    _nextPath = (_nextPath + 1) % _pathCount;
+    if(nullptr == file) {
+        return nullptr;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    CameraFrame &frame = _frames[i];
+    if((size > 0) && ((size_t)size > _capacity[i])) {
+        free(frame.buf);
+        frame.buf = (uint8_t *)malloc(size);
+        _capacity[i] = (nullptr != frame.buf) ? size : 0;
+    }
+    frame.len = ((size > 0) && (nullptr != frame.buf)) ? fread(frame.buf, 1, size, file) : 0;
+    fclose(file);
+    if((0 == frame.len) || ((long)frame.len != size)) {
+        return nullptr;
+    }
+
+    _grabs += 1;
+    _sequence[i] = _grabs;
+    _held[i].store(true, std::memory_order_release);
+    return &frame;
+}
+
+/**
+ * Give a frame back to the source
+ */
+void FileFrameSource::release(CameraFrame *frame)  // IN : frame from grab()
+{
+    for(unsigned int i = 0; i < FRAME_COUNT; i += 1) {
+        if(&_frames[i] == frame) {
+            _held[i].store(false, std::memory_order_release);
+        }
+    }
+}
+
+/**
+ * Get the order in which a frame was grabbed
+ */
+unsigned int FileFrameSource::sequence(const CameraFrame *frame)    // IN : frame from grab()
+                                                                    // RET: 1 for the first grab, 2 for the next...
+{
+    for(unsigned int i = 0; i < FRAME_COUNT; i += 1) {
+        if(&_frames[i] == frame) {
+            return _sequence[i];
+        }
+    }
+    return 0;
+}
+
+/**
+ * Count the frames that have not been released
+ */
+unsigned int FileFrameSource::held()    // RET: frames grabbed and not released
+{
+    unsigned int count = 0;
+    for(unsigned int i = 0; i < FRAME_COUNT; i += 1) {
+        if(_held[i].load(std::memory_order_acquire)) {
+            count += 1;
+        }
+    }
+    return count;
+}
@@ -0,0 +1,64 @@
+#ifndef REPLAY_FILE_FRAME_SOURCE_H
+#define REPLAY_FILE_FRAME_SOURCE_H
+
+#include <atomic>
+
+#include "camera/camera_capture.h"
+
+/**
+ * A FrameSource that reads JPEG files in turn,
+ * over and over, so the capture pipeline runs
+ * on the host.
+ *
+ * Like the camera driver it has a few frame
+ * buffers; grab() fails when they are all held
+ * rather than blocking, and release() may be
+ * called from any thread.
+ */
+class FileFrameSource : public FrameSource {
+    public:
+    static const unsigned int FRAME_COUNT = 3;  // frames that can be held at once
+
+    private:
+    const char **_paths;
+    unsigned int _pathCount;
+    unsigned int _nextPath = 0;         // file read by next grab
+    unsigned int _grabs = 0;            // frames grabbed so far
+
+    CameraFrame _frames[FRAME_COUNT];
+    size_t _capacity[FRAME_COUNT];      // bytes allocated for each frame
+    unsigned int _sequence[FRAME_COUNT];// grab that filled each frame
+    std::atomic<bool> _held[FRAME_COUNT];
+
+    public:
+
+    FileFrameSource(
+        const char **paths,     // IN : JPEG files to read
+        unsigned int pathCount);// IN : number of files
+
+    ~FileFrameSource();
+
+    /**
+     * Read the next file into a free frame
+     */
+    CameraFrame *grab();    // RET: frame owned by the caller or nullptr
+                            //      if every frame is held or the file can not be read
+
+    /**
+     * Give a frame back to the source
+     */
+    void release(CameraFrame *frame);   // IN : frame from grab()
+
+    /**
+     * Get the order in which a frame was grabbed
+     */
+    unsigned int sequence(const CameraFrame *frame);    // IN : frame from grab()
+                                                        // RET: 1 for the first grab, 2 for the next...
+
+    /**
+     * Count the frames that have not been released
+     */
+    unsigned int held();    // RET: frames grabbed and not released
+};
+
+#endif // REPLAY_FILE_FRAME_SOURCE_H
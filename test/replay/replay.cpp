@@ -0,0 +1,165 @@
+//
+// Replay recorded wheel samples through the rover's
+// DriveWheel and TwoWheelRover code on a virtual clock
+// and print the resulting speed and pose traces as csv.
+//
+// build and run from the project root with tools/replay.sh
+//
+// usage: replay <trace> [--bench <repeat>]
+//
+//   <trace> is either a flight log downloaded from the rover's /flight
+//   endpoint or a csv of samples, one per line, with no header;
+//
+//       ms,leftCount,rightCount,pwm
+//       ms,leftCount,rightCount,leftPwm,rightPwm
+//
+//   where counts are signed encoder counts and pwm is negative in reverse.
+//   Lines starting with # are ignored.
+//
+//   --bench replays the trace <repeat> times without printing
+//   traces and reports the time per sample.
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+
+#include "rover_replay.h"
+#include "recorder/flight_log.h"
+
+using namespace std;
+
+/**
+ * Print traces as csv
+ */
+class CsvTraceListener : public ReplayTraceListener {
+    public:
+    void onSpeed(unsigned long ms, Specifier wheel, DriveWheel &driveWheel) {
+        printf("speed,%lu,%s,%f,%f,%d,%u\n", ms, Specifiers[wheel], 
+            driveWheel.speed(), driveWheel.distance(), driveWheel.forward() ? 1 : 0, driveWheel.pwm());
+    }
+
+    void onPose(unsigned long ms, TwoWheelRover &rover) {
+        const Pose2D pose = rover.pose();
+        const Pose2D velocity = rover.poseVelocity();
+        printf("pose,%lu,%f,%f,%f,%f,%f,%f\n", ms, 
+            pose.x, pose.y, pose.angle, velocity.x, velocity.y, velocity.angle);
+    }
+};
+
+/**
+ * Read samples from a flight log; each encoder sample
+ * becomes a replay sample with the wheel power in effect.
+ */
+static bool readFlightLog(const uint8_t *log, uint32_t size, vector<ReplaySample> &samples) {
+    FlightLogReader reader(log, size);
+    if(!reader.valid()) {
+        return false;
+    }
+
+    int pwm[2] = {0, 0};
+    FlightRecord record;
+    while(reader.next(record)) {
+        if(FLIGHT_RECORD_WHEEL_POWER == record.type) {
+            pwm[record.wheel ? 1 : 0] = record.forward ? (int)record.pwm : -(int)record.pwm;
+        } else if(FLIGHT_RECORD_ENCODERS == record.type) {
+            ReplaySample sample = {record.at, record.encoders.leftCount, record.encoders.rightCount, pwm[0], pwm[1]};
+            samples.push_back(sample);
+        }
+    }
+    return true;
+}
+
+/**
+ * Read samples from csv text
+ */
+static bool readCsv(const char *text, vector<ReplaySample> &samples) {
+    const char *line = text;
+    while((nullptr != line) && ('\0' != *line)) {
+        if(('#' != *line) && ('\n' != *line) && ('\r' != *line)) {
+            unsigned long ms;
+            long left, right;
+            int leftPwm, rightPwm;
+            const int fields = sscanf(line, "%lu,%ld,%ld,%d,%d", &ms, &left, &right, &leftPwm, &rightPwm);
+            if(fields < 4) {
+                return false;
+            }
+            if(4 == fields) {
+                rightPwm = leftPwm;
+            }
+            ReplaySample sample = {ms, left, right, leftPwm, rightPwm};
+            samples.push_back(sample);
+        }
+        line = strchr(line, '\n');
+        if(nullptr != line) line += 1;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: %s <trace> [--bench <repeat>]\n", argv[0]);
+        return 2;
+    }
+    const int repeat = ((argc > 3) && (0 == strcmp("--bench", argv[2]))) ? atoi(argv[3]) : 0;
+
+    FILE *file = fopen(argv[1], "rb");
+    if(nullptr == file) {
+        fprintf(stderr, "could not open %s\n", argv[1]);
+        return 1;
+    }
+    vector<char> bytes;
+    char buffer[4096];
+    size_t count;
+    while((count = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + count);
+    }
+    fclose(file);
+    bytes.push_back('\0');
+
+    //
+    // a flight log carries the rover geometry,
+    // a csv uses the compiled configuration
+    //
+    vector<ReplaySample> samples;
+    distance_type wheelBase = WHEELBASE;
+    distance_type leftCircumference = WHEEL_CIRCUMFERENCE;
+    distance_type rightCircumference = WHEEL_CIRCUMFERENCE;
+    int leftPulsesPerRevolution = PULSES_PER_REVOLUTION;
+    int rightPulsesPerRevolution = PULSES_PER_REVOLUTION;
+    FlightLogReader flightLog((const uint8_t *)bytes.data(), (uint32_t)(bytes.size() - 1));
+    if(flightLog.valid()) {
+        wheelBase = flightLog.header().wheelBase;
+        leftCircumference = flightLog.header().leftCircumference;
+        rightCircumference = flightLog.header().rightCircumference;
+        leftPulsesPerRevolution = flightLog.header().leftCountsPerRevolution;
+        rightPulsesPerRevolution = flightLog.header().rightCountsPerRevolution;
+        readFlightLog((const uint8_t *)bytes.data(), (uint32_t)(bytes.size() - 1), samples);
+    } else if(!readCsv(bytes.data(), samples)) {
+        fprintf(stderr, "%s is not a flight log or a csv of samples\n", argv[1]);
+        return 1;
+    }
+
+    if(repeat > 0) {
+        const auto start = chrono::steady_clock::now();
+        for(int i = 0; i < repeat; i += 1) {
+            RoverReplay replay(wheelBase, leftCircumference, leftPulsesPerRevolution, rightCircumference, rightPulsesPerRevolution);
+            for(const ReplaySample &sample : samples) {
+                replay.step(sample);
+            }
+        }
+        const double ns = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        const double steps = (double)samples.size() * repeat;
+        printf("replayed %.0f samples, %.1f ns per sample\n", steps, (steps > 0) ? ns / steps : 0);
+        return 0;
+    }
+
+    CsvTraceListener listener;
+    RoverReplay replay(wheelBase, leftCircumference, leftPulsesPerRevolution, rightCircumference, rightPulsesPerRevolution);
+    replay.setListener(&listener);
+    for(const ReplaySample &sample : samples) {
+        replay.step(sample);
+    }
+    return 0;
+}
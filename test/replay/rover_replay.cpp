@@ -0,0 +1,152 @@
+#include "rover_replay.h"
+
+unsigned long replayMillis = 0;     // virtual clock used by millis()
+
+//
+// encoders are driven by the replay, not by interrupts
+//
+bool encoderInterruptAttached(encoder_iss_type) { return false; }
+bool attachEncoderInterrupt(Encoder &, encoder_iss_type) { return false; }
+bool detachEncoderInterrupt(Encoder &, encoder_iss_type) { return false; }
+
+RoverReplay::RoverReplay(
+    distance_type wheelBase,            // IN : distance between drive wheels
+    distance_type leftCircumference,    // IN : left wheel circumference
+    int leftPulsesPerRevolution,        // IN : left encoder pulses in one wheel turn
+    distance_type rightCircumference,   // IN : right wheel circumference
+    int rightPulsesPerRevolution)       // IN : right encoder pulses in one wheel turn
+    :   _messageBus(),  // value initialized so subscriptions start empty
+        _leftForwardPwm(A1_A_PIN, LEFT_FORWARD_CHANNEL, MotorL9110s::pwmBits()),
+        _leftReversePwm(A1_B_PIN, LEFT_REVERSE_CHANNEL, MotorL9110s::pwmBits()),
+        _rightForwardPwm(B1_B_PIN, RIGHT_FORWARD_CHANNEL, MotorL9110s::pwmBits()),
+        _rightReversePwm(B1_A_PIN, RIGHT_REVERSE_CHANNEL, MotorL9110s::pwmBits()),
+        _leftEncoder(LEFT_ENCODER_PIN, -1),
+        _rightEncoder(RIGHT_ENCODER_PIN, -1),
+        _leftWheel(LEFT_WHEEL_SPEC, leftCircumference),
+        _rightWheel(RIGHT_WHEEL_SPEC, rightCircumference),
+        _rover(wheelBase)
+{
+    replayMillis = 0;
+    _rover.attach(
+        _leftWheel.attach(
+            _leftMotor.attach(_leftForwardPwm, _leftReversePwm),
+            &_leftEncoder,
+            leftPulsesPerRevolution,
+            &_messageBus),
+        _rightWheel.attach(
+            _rightMotor.attach(_rightForwardPwm, _rightReversePwm),
+            &_rightEncoder,
+            rightPulsesPerRevolution,
+            &_messageBus),
+        &_messageBus);
+
+    // recorded pwm was already ramped on the rover, so apply it as recorded
+    _rover.setAccelerationLimits(ALL_WHEELS, 0, 0, 0, 0);
+
+    subscribe(_messageBus, SPEED_CONTROL);
+    subscribe(_messageBus, ROVER_POSE);
+}
+
+RoverReplay::~RoverReplay() {
+    unsubscribe(_messageBus, SPEED_CONTROL);
+    unsubscribe(_messageBus, ROVER_POSE);
+}
+
+/**
+ * Set the listener that receives the traces
+ */
+RoverReplay& RoverReplay::setListener(ReplayTraceListener *listener)    // IN : listener or nullptr
+                                                                        // RET: this replay
+{
+    _listener = listener;
+    return *this;
+}
+
+/**
+ * Apply encoder counts to one wheel
+ */
+void RoverReplay::_encode(
+    Encoder &encoder,           // IN : encoder to drive
+    encoder_count_type delta)   // IN : signed change in count
+{
+    if(0 != delta) {
+        //
+        // stopping first clears any 'settling' direction
+        // so every count goes in the recorded direction
+        //
+        encoder.setDirection(encode_stopped);
+        encoder.setDirection((delta > 0) ? encode_forward : encode_reverse);
+        for(encoder_count_type i = (delta > 0) ? delta : -delta; i > 0; i -= 1) {
+            encoder.encode();
+        }
+    }
+}
+
+/**
+ * Advance the virtual clock to the sample's time,
+ * apply it's pwm and encoder counts and
+ * poll the rover.
+ */
+RoverReplay& RoverReplay::step(const ReplaySample &sample)  // IN : next recorded sample
+                                                            // RET: this replay
+{
+    replayMillis = sample.ms;
+
+    if(sample.leftPwm != _leftPwm) {
+        _leftWheel.setPower(sample.leftPwm >= 0, (pwm_type)abs(sample.leftPwm));
+        _leftPwm = sample.leftPwm;
+    }
+    if(sample.rightPwm != _rightPwm) {
+        _rightWheel.setPower(sample.rightPwm >= 0, (pwm_type)abs(sample.rightPwm));
+        _rightPwm = sample.rightPwm;
+    }
+
+    return drive(sample.ms, sample.leftCount, sample.rightCount);
+}
+
+/**
+ * Advance the virtual clock, apply encoder
+ * counts and poll the rover, leaving the
+ * motors to the rover's own control.
+ */
+RoverReplay& RoverReplay::drive(
+    unsigned long ms,               // IN : time in ms since startup
+    encoder_count_type leftCount,   // IN : signed left encoder count
+    encoder_count_type rightCount)  // IN : signed right encoder count
+                                    // RET: this replay
+{
+    replayMillis = ms;
+
+    if(!_started) {
+        // counts are relative to the first sample
+        _leftCount = leftCount;
+        _rightCount = rightCount;
+        _started = true;
+    }
+
+    _encode(_leftEncoder, leftCount - _leftCount);
+    _encode(_rightEncoder, rightCount - _rightCount);
+    _leftCount = leftCount;
+    _rightCount = rightCount;
+
+    _rover.poll(ms);
+    return *this;
+}
+
+/**
+ * Forward speed and pose messages to the listener
+ */
+void RoverReplay::onMessage(
+    Publisher &,            // IN : publisher of message
+    Message message,        // IN : message that was published
+    Specifier specifier,    // IN : specifier (like LEFT_WHEEL_SPEC)
+    const char *)           // IN : message data as a c-cstring
+{
+    if(nullptr != _listener) {
+        if(SPEED_CONTROL == message) {
+            _listener->onSpeed(replayMillis, specifier, (LEFT_WHEEL_SPEC == specifier) ? _leftWheel : _rightWheel);
+        } else if(ROVER_POSE == message) {
+            _listener->onPose(replayMillis, _rover);
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#ifndef REPLAY_ROVER_REPLAY_H
+#define REPLAY_ROVER_REPLAY_H
+
+#include "gpio/pwm.h"
+#include "motor/motor_l9110s.h"
+#include "encoder/encoder.h"
+#include "wheel/drive_wheel.h"
+#include "rover/rover.h"
+#include "message_bus/message_bus.h"
+
+//
+// one recorded sample of the wheels
+//
+typedef struct ReplaySample {
+    unsigned long ms;                   // time of sample in ms since startup
+    encoder_count_type leftCount;       // signed left encoder count
+    encoder_count_type rightCount;      // signed right encoder count
+    int leftPwm;                        // left motor pwm; negative is reverse
+    int rightPwm;                       // right motor pwm; negative is reverse
+} ReplaySample;
+
+/**
+ * Receives the speed and pose traces of a replay
+ */
+class ReplayTraceListener {
+    public:
+    virtual ~ReplayTraceListener() {}
+
+    /**
+     * A wheel's speed was measured by DriveWheel::_pollSpeed()
+     */
+    virtual void onSpeed(
+        unsigned long,          // IN : virtual time in ms since startup
+        Specifier,              // IN : LEFT_WHEEL_SPEC or RIGHT_WHEEL_SPEC
+        DriveWheel &)           // IN : the wheel; speed(), distance(), pwm()...
+    {
+    }
+
+    /**
+     * The pose was updated by TwoWheelRover::_pollPose()
+     */
+    virtual void onPose(
+        unsigned long,          // IN : virtual time in ms since startup
+        TwoWheelRover &)        // IN : the rover; pose(), poseVelocity()...
+    {
+    }
+};
+
+/**
+ * Replay recorded wheel samples through the rover's
+ * own DriveWheel and TwoWheelRover code on the host.
+ *
+ * Time is a virtual clock that is set from each sample,
+ * so a replay runs as fast as the host allows and
+ * produces the same traces every time.  Replaying the
+ * same samples with two versions of the estimators
+ * gives an A/B comparison on real data.
+ *
+ * Encoders are driven by calling Encoder::encode() once
+ * for each count between samples, in the direction of
+ * the recorded change, so the encoders reproduce the
+ * recorded counts exactly, including while the wheels
+ * coast.  The recorded pwm is applied with setPower(),
+ * so the speed controller is not engaged.
+ */
+class RoverReplay : Subscriber {
+    private:
+    MessageBus _messageBus;
+
+    PwmChannel _leftForwardPwm;
+    PwmChannel _leftReversePwm;
+    PwmChannel _rightForwardPwm;
+    PwmChannel _rightReversePwm;
+    MotorL9110s _leftMotor;
+    MotorL9110s _rightMotor;
+    Encoder _leftEncoder;
+    Encoder _rightEncoder;
+    DriveWheel _leftWheel;
+    DriveWheel _rightWheel;
+    TwoWheelRover _rover;
+
+    ReplayTraceListener *_listener = nullptr;
+    bool _started = false;
+    encoder_count_type _leftCount = 0;      // recorded counts already replayed
+    encoder_count_type _rightCount = 0;
+    int _leftPwm = 0;                       // recorded pwm already applied
+    int _rightPwm = 0;
+
+    /**
+     * Apply encoder counts to one wheel
+     */
+    void _encode(
+        Encoder &encoder,           // IN : encoder to drive
+        encoder_count_type delta);  // IN : signed change in count
+
+    public:
+
+    RoverReplay(
+        distance_type wheelBase,            // IN : distance between drive wheels
+        distance_type leftCircumference,    // IN : left wheel circumference
+        int leftPulsesPerRevolution,        // IN : left encoder pulses in one wheel turn
+        distance_type rightCircumference,   // IN : right wheel circumference
+        int rightPulsesPerRevolution);      // IN : right encoder pulses in one wheel turn
+
+    ~RoverReplay();
+
+    /**
+     * Set the listener that receives the traces
+     */
+    RoverReplay& setListener(ReplayTraceListener *listener);    // IN : listener or nullptr
+                                                                // RET: this replay
+
+    /**
+     * Advance the virtual clock to the sample's time,
+     * apply it's pwm and encoder counts and
+     * poll the rover.
+     * The first sample sets the starting counts.
+     */
+    RoverReplay& step(const ReplaySample &sample);  // IN : next recorded sample
+                                                    // RET: this replay
+
+    /**
+     * Advance the virtual clock, apply encoder
+     * counts and poll the rover, leaving the
+     * motors to the rover's own control.
+     * With a model that turns motor pwm into
+     * counts, this simulates closed loop control.
+     * The first call sets the starting counts.
+     */
+    RoverReplay& drive(
+        unsigned long ms,               // IN : time in ms since startup
+        encoder_count_type leftCount,   // IN : signed left encoder count
+        encoder_count_type rightCount); // IN : signed right encoder count
+                                        // RET: this replay
+
+    TwoWheelRover &rover() { return _rover; }
+    DriveWheel &leftWheel() { return _leftWheel; }
+    DriveWheel &rightWheel() { return _rightWheel; }
+    MessageBus &messageBus() { return _messageBus; }
+
+    /**
+     * Forward speed and pose messages to the listener
+     */
+    void onMessage(
+        Publisher &publisher,   // IN : publisher of message
+        Message message,        // IN : message that was published
+        Specifier specifier,    // IN : specifier (like LEFT_WHEEL_SPEC)
+        const char *data);      // IN : message data as a c-cstring
+};
+
+#endif // REPLAY_ROVER_REPLAY_H
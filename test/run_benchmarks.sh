@@ -0,0 +1,21 @@
+
+# benchmark cross-core lock-free ring throughput and latency
+gcc -O2 -DTESTING -std=c++11 -Wc++11-extensions -pthread -lstdc++ src/util/spsc_ring.bench.cpp; ./a.out; rm a.out
+
+# benchmark text versus binary telemetry size and formatting time
+gcc -O2 -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ src/telemetry_format.bench.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# benchmark time per speed and pose update over millions of replayed samples
+gcc -O2 -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h src/replay/rover_replay.bench.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# benchmark a tokenized log call versus building the message string
+gcc -O2 -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ src/token_log.bench.cpp ../src/token_log.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# benchmark time per pose update, exact arc versus midpoint odometry
+gcc -O2 -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ src/rover/odometry.bench.cpp ../src/rover/odometry.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+# benchmark time per call, fast trig kernels versus libm
+gcc -O2 -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ src/util/fast_trig.bench.cpp -lm; ./a.out; rm a.out
+
+# benchmark time per operation, q16 fixed point versus float
+gcc -O2 -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ src/util/fixed_point.bench.cpp -lm; ./a.out; rm a.out
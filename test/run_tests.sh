@@ -9,10 +9,112 @@ gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/parse/parse_hi
 gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/parse/parse_numbers.test.cpp ../src/parse/*.cpp; ./a.out; rm a.out
 
 # test rover command parsing functions
-gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/rover/rover_parse.test.cpp ../src/rover/rover_parse.cpp ../src/parse/*.cpp; ./a.out; rm a.out
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -include Arduino.h test.cpp src/rover/rover_parse.test.cpp ../src/rover/rover_parse.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp ../src/parse/*.cpp; ./a.out; rm a.out
 
 # test message bus
 gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/message_bus/message_bus.test.cpp ../src/message_bus/message_bus.cpp; ./a.out; rm a.out
 
 # test constant step speed controller
 gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/pid/step_control.test.cpp ../src/pid/step_control.cpp; ./a.out; rm a.out
+
+# test cross-core lock-free ring
+gcc -DTESTING -std=c++11 -Wc++11-extensions -pthread -lstdc++ test.cpp src/util/spsc_ring.test.cpp; ./a.out; rm a.out
+
+# test multi-producer lock-free ring
+gcc -DTESTING -std=c++11 -Wc++11-extensions -pthread -lstdc++ test.cpp src/util/mpsc_ring.test.cpp; ./a.out; rm a.out
+
+# test cross-core message bridge
+gcc -DTESTING -std=c++11 -Wc++11-extensions -pthread -lstdc++ test.cpp src/message_bus/message_bridge.test.cpp ../src/message_bus/message_bridge.cpp ../src/message_bus/message_bus.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# test text and binary telemetry formats
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/telemetry_format.test.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# test telemetry queue drop policies and loss report
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/telemetry_queue.test.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# test telemetry history ring
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/telemetry_history.test.cpp ../src/telemetry_history.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# test flight recorder and replay of recorded encoder samples
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/recorder/flight_recorder.test.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/rover/odometry.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+# test deterministic replay of wheel samples through the rover's wheel and pose code
+gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/replay/rover_replay.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test tokenized logging, it's formatting and binary record
+gcc -DTESTING -std=c++11 -Wc++11-extensions -pthread -lstdc++ test.cpp src/token_log.test.cpp ../src/token_log.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# test telemetry sender; a halt is never decimated or lost behind wheel samples
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -include Arduino.h test.cpp src/telemetry.test.cpp ../src/telemetry.cpp ../src/telemetry_format.cpp ../src/telemetry_history.cpp ../src/token_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# test exact-arc odometry against a midpoint estimate over simulated figure-eights
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/rover/odometry.test.cpp ../src/rover/odometry.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+# test pose history lookup by time, including while another thread appends
+gcc -DTESTING -std=c++11 -Wc++11-extensions -pthread -lstdc++ test.cpp src/rover/pose_history.test.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+# test fast sin, cos, atan2 and angle wrapping against libm
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/util/fast_trig.test.cpp -lm; ./a.out; rm a.out
+
+# test q16 fixed point arithmetic, saturation and trig, and pose math against float
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/util/fixed_point.test.cpp -lm; ./a.out; rm a.out
+
+# test jerk limited setpoint ramps, including two ramps keeping their ratio
+gcc -DTESTING -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/wheel/setpoint_ramp.test.cpp ../src/wheel/setpoint_ramp.cpp -lm; ./a.out; rm a.out
+
+# test cross-coupled wheel synchronization, and it's straight line drift with simulated mismatched motors
+gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/wheel_sync.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test goto goal time-to-goal, turn then drive vs blended, with simulated mismatched motors
+gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/goto_goal.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test pure pursuit path following against chained goto goals, with simulated mismatched motors
+gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/path_follow.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/path_follow.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test waypoint recorder simplification, bounded memory and playback, with simulated mismatched motors
+gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/waypoint_recorder.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/path_follow.cpp ../src/rover/waypoint_recorder.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test occupancy grid packing, transforms, line marking, blob and mapping from odometry
+gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/map/occupancy_grid.test.cpp replay/rover_replay.cpp ../src/map/occupancy_grid.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test path planner on mazes of several sizes, incremental search and driving around a wall
+gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/map/path_planner.test.cpp replay/rover_replay.cpp ../src/map/occupancy_grid.cpp ../src/map/path_planner.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test mailbox that hands the newest value between threads
+gcc -DTESTING -std=c++11 -Wc++11-extensions -pthread -lstdc++ test.cpp src/util/mailbox.test.cpp; ./a.out; rm a.out
+
+# test camera capture mailbox and file frame source, with a slow sender on another thread
+gcc -DTESTING -std=c++11 -Wc++11-extensions -pthread -lstdc++ -Ireplay -I../src test.cpp src/camera/camera_capture.test.cpp replay/file_frame_source.cpp ../src/camera/camera_capture.cpp; ./a.out; rm a.out
+
+# test flight recorder with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/recorder/flight_recorder.test.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/rover/odometry.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+# test rover replay with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/replay/rover_replay.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test telemetry sender with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -include Arduino.h test.cpp src/telemetry.test.cpp ../src/telemetry.cpp ../src/telemetry_format.cpp ../src/telemetry_history.cpp ../src/token_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+# test exact-arc odometry with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/rover/odometry.test.cpp ../src/rover/odometry.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+# test pose history with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -std=c++11 -Wc++11-extensions -pthread -lstdc++ test.cpp src/rover/pose_history.test.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+# test wheel synchronization with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/wheel_sync.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test goto goal with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/goto_goal.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test path following with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/path_follow.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/path_follow.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test waypoint recorder with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/waypoint_recorder.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/path_follow.cpp ../src/rover/waypoint_recorder.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test occupancy grid with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/map/occupancy_grid.test.cpp replay/rover_replay.cpp ../src/map/occupancy_grid.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+# test path planner with fixed point distances and speeds
+gcc -DTESTING -DUSE_FIXED_POINT -DUSE_ENCODER_INTERRUPTS -std=c++11 -Wc++11-extensions -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/map/path_planner.test.cpp replay/rover_replay.cpp ../src/map/occupancy_grid.cpp ../src/map/path_planner.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
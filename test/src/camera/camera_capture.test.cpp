@@ -0,0 +1,271 @@
+#include <stdio.h>
+#include <thread>
+
+#include "../../test.h"
+#include "../../replay/file_frame_source.h"
+#include "../../../src/camera/camera_capture.h"
+#include "../../../src/error.h"
+
+using namespace std;
+
+static const unsigned int FILE_COUNT = 5;
+static const char *paths[FILE_COUNT] = {
+    "camera_frame_0.jpg",
+    "camera_frame_1.jpg",
+    "camera_frame_2.jpg",
+    "camera_frame_3.jpg",
+    "camera_frame_4.jpg",
+};
+
+/**
+ * Size of a test JPEG
+ */
+static size_t frameSize(unsigned int index) // IN : file number
+                                            // RET: bytes in file
+{
+    return 4 + 1 + 1000 + 100 * index;
+}
+
+/**
+ * Write JPEG files of different sizes; each starts
+ * and ends with the JPEG markers and is filled with
+ * it's file number, so a torn frame is easy to spot.
+ */
+static void writeFrames() {
+    for(unsigned int i = 0; i < FILE_COUNT; i += 1) {
+        FILE *file = fopen(paths[i], "wb");
+        const size_t size = frameSize(i);
+        fputc(0xFF, file);
+        fputc(0xD8, file);  // start of image
+        for(size_t j = 2; j < size - 2; j += 1) {
+            fputc(i, file);
+        }
+        fputc(0xFF, file);
+        fputc(0xD9, file);  // end of image
+        fclose(file);
+    }
+}
+
+static void removeFrames() {
+    for(unsigned int i = 0; i < FILE_COUNT; i += 1) {
+        remove(paths[i]);
+    }
+}
+
+/**
+ * Determine if a frame is one of the files, whole
+ */
+static bool wholeFrame(const CameraFrame *frame) {
+    if((frame->len < 5) || (0xFF != frame->buf[0]) || (0xD8 != frame->buf[1])
+        || (0xFF != frame->buf[frame->len - 2]) || (0xD9 != frame->buf[frame->len - 1]))
+    {
+        return false;
+    }
+    const uint8_t index = frame->buf[2];
+    if((index >= FILE_COUNT) || (frameSize(index) != frame->len)) {
+        return false;
+    }
+    for(size_t i = 2; i < frame->len - 2; i += 1) {
+        if(index != frame->buf[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void TestCaptureWhileStreaming() {
+    FileFrameSource source(paths, FILE_COUNT);
+    CameraCapture capture;
+    capture.attach(source);
+    if(SUCCESS != capture.begin()) {
+        testError("CameraCapture: begin() failed%s", "");
+    }
+
+    // nothing is captured until streaming starts
+    if(capture.poll() || (0 != source.held())) {
+        testError("CameraCapture: captured %d frames before start()", capture.captured());
+    }
+
+    //
+    // with no one taking frames, only the newest is
+    // kept; the others are given back to the source
+    //
+    capture.start();
+    for(int i = 0; i < 5; i += 1) {
+        if(!capture.poll()) {
+            testError("CameraCapture: poll %d failed", i);
+        }
+    }
+    if((1 != source.held()) || (5 != capture.captured()) || (4 != capture.dropped())) {
+        testError("CameraCapture: expected 1 frame held and 4 dropped, got %d held", source.held());
+    }
+    CameraFrame *frame = capture.take();
+    if((nullptr == frame) || (5 != source.sequence(frame)) || !wholeFrame(frame)) {
+        testError("CameraCapture: expected newest frame, got frame %d", source.sequence(frame));
+    }
+    if(nullptr != capture.take()) {
+        testError("CameraCapture: took the same frame twice%s", "");
+    }
+    capture.release(frame);
+
+    // stopping gives back the frame that was not taken
+    capture.poll();
+    capture.stop();
+    if(capture.poll() || (0 != source.held())) {
+        testError("CameraCapture: %d frames held after stop()", source.held());
+    }
+}
+
+void TestSlowSender() {
+    //
+    // capture on one thread and send on another, with
+    // a sender that is slower than the camera; every
+    // frame sent is whole and newer than the last, and
+    // every frame grabbed is given back.
+    //
+    FileFrameSource source(paths, FILE_COUNT);
+    CameraCapture capture;
+    capture.attach(source).start();
+
+    atomic<bool> running(true);
+    thread producer([&]() {
+        while(running.load()) {
+            if(!capture.poll()) {
+                this_thread::yield();
+            }
+        }
+    });
+
+    const unsigned int SENDS = 200;
+    unsigned int sent = 0;
+    unsigned int lastSequence = 0;
+    unsigned int torn = 0;
+    while(sent < SENDS) {
+        CameraFrame *frame = capture.take();
+        if(nullptr == frame) {
+            this_thread::yield();
+            continue;
+        }
+        const unsigned int sequence = source.sequence(frame);
+        if(sequence <= lastSequence) {
+            testError("CameraCapture: sent frame %d after frame %d", sequence, lastSequence);
+        }
+        if(!wholeFrame(frame)) {
+            torn += 1;
+        }
+        lastSequence = sequence;
+        this_thread::sleep_for(chrono::microseconds(200));     // sending takes a while
+        capture.release(frame);
+        sent += 1;
+    }
+    running.store(false);
+    producer.join();
+    capture.stop();
+
+    printf("CameraCapture: sent %d frames while capturing %d; %d dropped for newer frames, %d grabs waited on a buffer\n",
+        sent, capture.captured(), capture.dropped(), capture.failures());
+    if(0 != torn) {
+        testError("CameraCapture: %d frames were torn", torn);
+    }
+    if(0 != source.held()) {
+        testError("CameraCapture: %d frames were never given back", source.held());
+    }
+    if((0 == capture.dropped()) || (capture.captured() < sent + capture.dropped()) || (capture.captured() > sent + capture.dropped() + 1)) {
+        testError("CameraCapture: %d captured is not %d sent plus dropped", capture.captured(), sent);
+    }
+}
+
+/**
+ * A source whose grab() stops streaming, as if
+ * the sender stopped while the camera was busy
+ */
+class StoppingFrameSource : public FrameSource {
+    public:
+    FileFrameSource &source;
+    CameraCapture *capture = nullptr;
+
+    StoppingFrameSource(FileFrameSource &fileSource) : source(fileSource) {}
+
+    CameraFrame *grab() {
+        capture->stop();
+        return source.grab();
+    }
+    void release(CameraFrame *frame) { source.release(frame); }
+};
+
+void TestStopWhileGrabbing() {
+    FileFrameSource files(paths, FILE_COUNT);
+    StoppingFrameSource source(files);
+    CameraCapture capture;
+    source.capture = &capture;
+    capture.attach(source).start();
+
+    // the frame is given back, not posted where no one will take it
+    if(capture.poll() || (0 != files.held()) || (0 != capture.captured())) {
+        testError("CameraCapture: %d frames held after stopping while grabbing", files.held());
+    }
+}
+
+void TestSnapshot() {
+    //
+    // a single image is captured by the producer,
+    // once, when no one is streaming
+    //
+    FileFrameSource source(paths, FILE_COUNT);
+    CameraCapture capture;
+    capture.attach(source);
+
+    atomic<bool> running(true);
+    thread producer([&]() {
+        while(running.load()) {
+            if(!capture.poll()) {
+                this_thread::yield();
+            }
+        }
+    });
+
+    for(int i = 0; i < 3; i += 1) {
+        CameraFrame *frame = capture.snapshot(1000);
+        if((nullptr == frame) || !wholeFrame(frame)) {
+            testError("CameraCapture: snapshot %d failed", i);
+        }
+        capture.release(frame);
+    }
+    this_thread::sleep_for(chrono::milliseconds(10));
+    running.store(false);
+    producer.join();
+
+    if((3 != capture.captured()) || (0 != source.held()) || capture.capturing()) {
+        testError("CameraCapture: expected 3 snapshots captured, got %d", capture.captured());
+    }
+
+    // with no producer, a snapshot times out
+    if(nullptr != capture.snapshot(5)) {
+        testError("CameraCapture: snapshot without a producer returned a frame%s", "");
+    }
+}
+
+void TestMissingFile() {
+    const char *missing[] = {"no_such_frame.jpg"};
+    FileFrameSource source(missing, 1);
+    CameraCapture capture;
+    capture.attach(source).start();
+    if(capture.poll() || (1 != capture.failures()) || (nullptr != capture.take())) {
+        testError("CameraCapture: expected 1 failure, got %d", capture.failures());
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -pthread -lstdc++ -Ireplay -I../src test.cpp src/camera/camera_capture.test.cpp replay/file_frame_source.cpp ../src/camera/camera_capture.cpp; ./a.out; rm a.out
+
+    writeFrames();
+    TestCaptureWhileStreaming();
+    TestSlowSender();
+    TestStopWhileGrabbing();
+    TestSnapshot();
+    TestMissingFile();
+    removeFrames();
+
+    return testResults("camera_capture");
+}
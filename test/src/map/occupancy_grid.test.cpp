@@ -0,0 +1,243 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "../../test.h"
+#include "../../replay/rover_replay.h"
+#include "../../../src/map/occupancy_grid.h"
+#include "../rover/simulated_wheel.h"
+
+void TestBegin() {
+    OccupancyGrid grid;
+    if(SUCCESS == grid.begin(100, 64, 5, 0, 0)) {
+        testError("OccupancyGrid: columns must be a multiple of 16, got %d", grid.columns());
+    }
+    if((SUCCESS != grid.begin(64, 32, 5, -160, -80)) || !grid.ready()) {
+        testError("OccupancyGrid: failed to allocate %d x %d", 64, 32);
+    }
+    if((64 * 32 != grid.count(CELL_UNKNOWN)) || (MAP_BLOB_HEADER_BYTES + 64 * 32 / 4 != grid.blobSize())) {
+        testError("OccupancyGrid: expected all cells unknown in a %d byte blob", MAP_BLOB_HEADER_BYTES + 64 * 32 / 4);
+    }
+}
+
+void TestTransforms() {
+    OccupancyGrid grid;
+    grid.begin(64, 32, 5, -160, -80);
+
+    // the world origin is in the middle of the grid
+    int column, row;
+    if(!grid.worldToCell(0, 0, column, row) || (32 != column) || (16 != row)) {
+        testError("OccupancyGrid: expected origin in cell 32, 16, got %d, %d", column, row);
+    }
+
+    // just below zero is the cell before, not the same cell
+    if(!grid.worldToCell(-0.1f, -4.9f, column, row) || (31 != column) || (15 != row)) {
+        testError("OccupancyGrid: expected cell 31, 15, got %d, %d", column, row);
+    }
+    if(grid.worldToCell(160, 0, column, row) || grid.worldToCell(0, -80.1f, column, row)) {
+        testError("OccupancyGrid: position outside grid reported in cell %d, %d", column, row);
+    }
+
+    // every cell's center is in that cell
+    for(int r = 0; r < 32; r += 1) {
+        for(int c = 0; c < 64; c += 1) {
+            const Point2D center = grid.cellToWorld(c, r);
+            if(!grid.worldToCell(center.x, center.y, column, row) || (c != column) || (r != row)) {
+                testError("OccupancyGrid: center of cell %d, %d is in another cell", c, r);
+            }
+        }
+    }
+}
+
+void TestCells() {
+    OccupancyGrid grid;
+    grid.begin(32, 4, 5, 0, 0);
+
+    // neighbors in the same word are left alone
+    grid.setCell(15, 1, CELL_OCCUPIED).setCell(16, 1, CELL_FREE).setCell(0, 2, CELL_OCCUPIED);
+    grid.setCell(14, 1, CELL_FREE).setCell(14, 1, CELL_UNKNOWN);
+    if((CELL_OCCUPIED != grid.cell(15, 1)) || (CELL_FREE != grid.cell(16, 1)) || (CELL_OCCUPIED != grid.cell(0, 2))
+        || (CELL_UNKNOWN != grid.cell(14, 1)) || (CELL_UNKNOWN != grid.cell(17, 1)) || (CELL_UNKNOWN != grid.cell(31, 1)))
+    {
+        testError("OccupancyGrid: cells are wrong after setting %d cells", 3);
+    }
+    if((2 != grid.count(CELL_OCCUPIED)) || (1 != grid.count(CELL_FREE))) {
+        testError("OccupancyGrid: expected 2 occupied cells, got %d", grid.count(CELL_OCCUPIED));
+    }
+
+    // outside the grid is unknown and can't be set
+    grid.setCell(-1, 0, CELL_OCCUPIED).setCell(0, 4, CELL_OCCUPIED);
+    if((CELL_UNKNOWN != grid.cell(-1, 0)) || (2 != grid.count(CELL_OCCUPIED))) {
+        testError("OccupancyGrid: cell outside grid was set, %d occupied", grid.count(CELL_OCCUPIED));
+    }
+
+    grid.fill(CELL_FREE);
+    if(32 * 4 != grid.count(CELL_FREE)) {
+        testError("OccupancyGrid: expected every cell free, got %d", grid.count(CELL_FREE));
+    }
+}
+
+void TestMarkLine() {
+    OccupancyGrid grid;
+    grid.begin(32, 32, 1, 0, 0);
+
+    // a line is one cell per step along it's longer axis, without gaps
+    grid.markLine(2.5f, 3.5f, 22.5f, 11.5f, CELL_FREE);
+    if((21 != grid.count(CELL_FREE)) || (CELL_FREE != grid.cell(2, 3)) || (CELL_FREE != grid.cell(22, 11))) {
+        testError("OccupancyGrid: expected 21 cells on line, got %d", grid.count(CELL_FREE));
+    }
+    int lastRow = 3;
+    for(int column = 2; column <= 22; column += 1) {
+        int rows = 0;
+        for(int row = 0; row < 32; row += 1) {
+            if(CELL_FREE == grid.cell(column, row)) {
+                rows += 1;
+                if((row != lastRow) && (row != lastRow + 1)) {
+                    testError("OccupancyGrid: line jumped from row %d to %d", lastRow, row);
+                }
+                lastRow = row;
+            }
+        }
+        if(1 != rows) {
+            testError("OccupancyGrid: expected 1 cell in column %d, got %d", column, rows);
+        }
+    }
+
+    // only the part in the grid is marked
+    grid.fill(CELL_UNKNOWN);
+    grid.markLine(-10.5f, 5.5f, 10.5f, 5.5f, CELL_OCCUPIED);
+    if(11 != grid.count(CELL_OCCUPIED)) {
+        testError("OccupancyGrid: expected 11 cells in grid, got %d", grid.count(CELL_OCCUPIED));
+    }
+}
+
+void TestBlob() {
+    OccupancyGrid grid;
+    grid.begin(48, 16, 2.5f, -60, -20);
+    for(int i = 0; i < 48; i += 1) {
+        grid.setCell(i, i % 16, (CellState)(1 + i % 2));
+    }
+
+    // download a chunk at a time
+    uint8_t blob[MAP_BLOB_HEADER_BYTES + 48 * 16 / 4];
+    unsigned int size = 0;
+    unsigned int chunk;
+    while(0 != (chunk = grid.download(blob + size, 7, size))) {
+        size += chunk;
+    }
+    if((sizeof(blob) != size) || ('O' != blob[0]) || ('G' != blob[1]) || (48 != blob[4]) || (16 != blob[6])) {
+        testError("OccupancyGrid: blob is %d bytes with a bad header", size);
+    }
+
+    // upload it to another grid of the same size
+    OccupancyGrid copy;
+    copy.begin(48, 16, 5, 0, 0);
+    for(unsigned int offset = 0; offset < size; offset += 11) {
+        if(SUCCESS != copy.upload(blob + offset, min<unsigned int>(11, size - offset), offset)) {
+            testError("OccupancyGrid: upload failed at offset %d", offset);
+        }
+    }
+    if((5 != copy.cellSize()) || (0 != copy.originX()) || (CELL_UNKNOWN != copy.cell(0, 0))) {
+        testError("OccupancyGrid: upload changed the grid before it was applied%s", "");
+    }
+    if(!copy.uploadPending() || !copy.applyUpload() || copy.uploadPending() || copy.applyUpload()) {
+        testError("OccupancyGrid: upload should be applied once%s", "");
+    }
+    if((2.5f != copy.cellSize()) || (-60 != copy.originX()) || (-20 != copy.originY())) {
+        testError("OccupancyGrid: uploaded cell size is %f", (float)copy.cellSize());
+    }
+    for(int row = 0; row < 16; row += 1) {
+        for(int column = 0; column < 48; column += 1) {
+            if(grid.cell(column, row) != copy.cell(column, row)) {
+                testError("OccupancyGrid: uploaded cell %d, %d is wrong", column, row);
+            }
+        }
+    }
+
+    // a short upload is never applied, and a new upload starts over
+    copy.fill(CELL_OCCUPIED);
+    if((SUCCESS != copy.upload(blob, size - 1, 0)) || copy.uploadPending() || copy.applyUpload()) {
+        testError("OccupancyGrid: short upload was applied%s", "");
+    }
+    if((SUCCESS == copy.upload(blob + size - 1, 1, size)) || copy.uploadPending()) {
+        testError("OccupancyGrid: out of order chunk was accepted%s", "");
+    }
+    if((CELL_OCCUPIED != copy.cell(0, 0)) || (SUCCESS != copy.upload(blob, size, 0)) || !copy.applyUpload() || (grid.cell(0, 0) != copy.cell(0, 0))) {
+        testError("OccupancyGrid: upload after a short upload failed%s", "");
+    }
+
+    // a blob for a different size grid is refused
+    OccupancyGrid other;
+    other.begin(32, 16, 5, 0, 0);
+    if(SUCCESS == other.upload(blob, size, 0)) {
+        testError("OccupancyGrid: uploaded %d byte blob to a different size grid", size);
+    }
+}
+
+void TestMapFromOdometry() {
+    const distance_type circumference = 20;
+    const int pulses = 40;
+    RoverReplay replay(13.5, circumference, pulses, circumference, pulses);
+    TwoWheelRover &rover = replay.rover();
+    rover.setAccelerationLimits(ALL_WHEELS, WHEEL_MAX_ACCELERATION, WHEEL_MAX_JERK, WHEEL_MAX_PWM_RATE, WHEEL_MAX_PWM_JERK);
+    rover.setMotorStall(SimulatedWheel::WHEEL_STALL_PWM / 255.0f, SimulatedWheel::WHEEL_STALL_PWM / 255.0f);
+    rover.setSpeedControl(ALL_WHEELS, 10, 50, 1, 0, 0);
+    SimulatedWheel left = {0.33f, 0, 0, 0, circumference / pulses};
+    SimulatedWheel right = {0.30f, 0, 0, 0, circumference / pulses};
+
+    OccupancyGrid grid;
+    grid.begin(MAP_HEAP_COLUMNS, MAP_HEAP_ROWS, MAP_CELL_SIZE, -(MAP_HEAP_COLUMNS * MAP_CELL_SIZE) / 2, -(MAP_HEAP_ROWS * MAP_CELL_SIZE) / 2);
+    grid.attach(rover, replay.messageBus()).startListening();
+
+    // drive a circle of radius 50 cm
+    const unsigned long stepMs = 5;
+    unsigned long ms = 1000;
+    replay.drive(ms, 0, 0);
+    rover.setVelocity(20, 0.4f);
+    for(; ms < 20000; ms += stepMs) {
+        left.step(replay.leftWheel(), ms, stepMs / 1000.0f);
+        right.step(replay.rightWheel(), ms, stepMs / 1000.0f);
+        replay.drive(ms + stepMs, left.count(), right.count());
+    }
+
+    //
+    // the path is marked without gaps, so every cell
+    // the rover passed through is free
+    //
+    const Pose2D pose = rover.pose();
+    int column, row;
+    grid.worldToCell(pose.x, pose.y, column, row);
+    const unsigned int free = grid.count(CELL_FREE);
+    printf("OccupancyGrid: %d x %d cells, %d bytes; circle of radius 50 cm marked %d cells free\n",
+        grid.columns(), grid.rows(), grid.blobSize(), free);
+    if(CELL_FREE != grid.cell(column, row)) {
+        testError("OccupancyGrid: rover's cell %d, %d is not free", column, row);
+    }
+    if((free < 40) || (free > 100)) {
+        testError("OccupancyGrid: expected a ring of cells around the circle, got %d", free);
+    }
+    if(CELL_UNKNOWN != grid.cell(MAP_HEAP_COLUMNS / 2, MAP_HEAP_ROWS / 2 + 10)) {
+        testError("OccupancyGrid: center of circle should be unknown, got %d", grid.cell(MAP_HEAP_COLUMNS / 2, MAP_HEAP_ROWS / 2 + 10));
+    }
+
+    // poses are ignored once it stops listening
+    grid.stopListening();
+    grid.fill(CELL_UNKNOWN);
+    replay.drive(ms + stepMs, left.count(), right.count());
+    if(0 != grid.count(CELL_FREE)) {
+        testError("OccupancyGrid: marked %d cells after it stopped listening", grid.count(CELL_FREE));
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/map/occupancy_grid.test.cpp replay/rover_replay.cpp ../src/map/occupancy_grid.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+    TestBegin();
+    TestTransforms();
+    TestCells();
+    TestMarkLine();
+    TestBlob();
+    TestMapFromOdometry();
+
+    return testResults("occupancy_grid");
+}
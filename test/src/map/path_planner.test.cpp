@@ -0,0 +1,319 @@
+#include <math.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../../test.h"
+#include "../../replay/rover_replay.h"
+#include "../../../src/map/occupancy_grid.h"
+#include "../../../src/map/path_planner.h"
+#include "../rover/simulated_wheel.h"
+
+static unsigned long seed = 1;
+
+/**
+ * Repeatable random numbers, so every run plans the same mazes
+ */
+static unsigned int randomInt(unsigned int limit)   // IN : limit
+                                                    // RET: random integer 0 to limit - 1
+{
+    seed = seed * 1103515245 + 12345;
+    return (unsigned int)((seed >> 16) & 0x7fff) % limit;
+}
+
+/**
+ * Carve a maze into a grid with 1 cm cells; passages are
+ * the odd cells, carved by a depth first search, then some
+ * walls are knocked out so there is more than one way through.
+ */
+static void carveMaze(OccupancyGrid &grid) // IN/OUT: grid to carve
+{
+    const int size = grid.columns();
+    const int cells = (size - 1) / 2;   // maze cells along each side
+    static int stack[128 * 128];
+    static bool visited[128 * 128];
+
+    grid.fill(CELL_OCCUPIED);
+    for(int i = 0; i < cells * cells; i += 1) {
+        visited[i] = false;
+    }
+    int top = 0;
+    stack[top++] = 0;
+    visited[0] = true;
+    grid.setCell(1, 1, CELL_FREE);
+    while(top > 0) {
+        const int current = stack[top - 1];
+        const int x = current % cells;
+        const int y = current / cells;
+        int options[4];
+        int count = 0;
+        if((x > 0) && !visited[current - 1]) options[count++] = current - 1;
+        if((x < cells - 1) && !visited[current + 1]) options[count++] = current + 1;
+        if((y > 0) && !visited[current - cells]) options[count++] = current - cells;
+        if((y < cells - 1) && !visited[current + cells]) options[count++] = current + cells;
+        if(0 == count) {
+            top -= 1;
+            continue;
+        }
+        const int next = options[randomInt(count)];
+        const int nx = next % cells;
+        const int ny = next / cells;
+        grid.setCell(2 * nx + 1, 2 * ny + 1, CELL_FREE).setCell(x + nx + 1, y + ny + 1, CELL_FREE);
+        visited[next] = true;
+        stack[top++] = next;
+    }
+
+    // knock out walls between passages
+    for(int i = 0; i < cells * cells / 8; i += 1) {
+        const int x = 1 + randomInt(size - 3);
+        const int y = 1 + randomInt(size - 3);
+        if((x + y) & 1) {
+            grid.setCell(x, y, CELL_FREE);
+        }
+    }
+}
+
+/**
+ * Determine if a straight line crosses no occupied cell,
+ * sampled every tenth of a cell
+ */
+static bool clearLine(OccupancyGrid &grid, const Point2D &from, const Point2D &to)
+{
+    const distance_type length = HYPOT(to.x - from.x, to.y - from.y);
+    const int samples = 1 + (int)(length * 10);
+    for(int i = 0; i <= samples; i += 1) {
+        const distance_type t = (distance_type)i / samples;
+        int column, row;
+        if(!grid.worldToCell(from.x + t * (to.x - from.x), from.y + t * (to.y - from.y), column, row)
+            || (CELL_OCCUPIED == grid.cell(column, row)))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Length of the planned path from a start
+ */
+static distance_type pathLength(PathPlanner &planner, Point2D start)
+{
+    distance_type length = 0;
+    for(unsigned int i = 0; i < planner.waypointCount(); i += 1) {
+        const Point2D point = planner.waypoint(i);
+        length += HYPOT(point.x - start.x, point.y - start.y);
+        start = point;
+    }
+    return length;
+}
+
+void TestMazes() {
+    const unsigned int sizes[] = {32, 64, 128, 256};
+    for(unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i += 1) {
+        const unsigned int size = sizes[i];
+        OccupancyGrid grid;
+        grid.begin(size, size, 1, 0, 0);
+        seed = size;
+        carveMaze(grid);
+
+        PathPlanner planner;
+        planner.begin(grid, size * size / 4);
+        planner.setClearance(0);
+
+        // corner to corner
+        const Point2D start = grid.cellToWorld(1, 1);
+        const Point2D goal = grid.cellToWorld(size - 3, size - 3);
+        const clock_t started = clock();
+        planner.plan(start.x, start.y, goal.x, goal.y);
+        while(PLANNER_SEARCHING == planner.step(PLANNER_BATCH)) {
+            // keep searching
+        }
+        const double ms = 1000.0 * (clock() - started) / CLOCKS_PER_SEC;
+        printf("PathPlanner: %3d x %-3d maze, %6d of %6d cells free; expanded %6d in %7.2f ms; %3d waypoints, %.0f cm\n",
+            size, size, grid.count(CELL_FREE), size * size, planner.expanded(), ms, planner.waypointCount(), (float)pathLength(planner, start));
+
+        if(PLANNER_PLANNED != planner.state()) {
+            testError("PathPlanner: no path through %d cell maze", size);
+            continue;
+        }
+
+        // every leg of the smoothed path is clear
+        Point2D from = start;
+        for(unsigned int w = 0; w < planner.waypointCount(); w += 1) {
+            const Point2D to = planner.waypoint(w);
+            if(!clearLine(grid, from, to)) {
+                testError("PathPlanner: leg %d crosses a wall", w);
+            }
+            from = to;
+        }
+        if((from.x != goal.x) || (from.y != goal.y)) {
+            testError("PathPlanner: path ends at %f, %f", (float)from.x, (float)from.y);
+        }
+    }
+}
+
+void TestOpenGround() {
+    // no obstacles, so the path is straight to the goal
+    OccupancyGrid grid;
+    grid.begin(64, 64, 5, -160, -160);
+    PathPlanner planner;
+    planner.begin(grid, 256);
+    planner.plan(-140, -100, 123, 77.5f);
+    while(PLANNER_SEARCHING == planner.step(PLANNER_BATCH)) {
+        // keep searching
+    }
+    if((PLANNER_PLANNED != planner.state()) || (1 != planner.waypointCount())
+        || (123 != planner.waypoint(0).x) || (77.5f != planner.waypoint(0).y))
+    {
+        testError("PathPlanner: expected 1 waypoint on open ground, got %d", planner.waypointCount());
+    }
+
+    // goals that are outside the grid or blocked fail right away
+    if(PLANNER_FAILED != planner.plan(0, 0, 200, 0)) {
+        testError("PathPlanner: planned to goal outside grid, state %d", planner.state());
+    }
+    grid.setCell(40, 32, CELL_OCCUPIED);
+    if(PLANNER_FAILED != planner.plan(0, 0, 42, 2)) {
+        testError("PathPlanner: planned to goal beside an obstacle, state %d", planner.state());
+    }
+
+    // a goal that is walled off fails after searching
+    grid.fill(CELL_UNKNOWN);
+    for(int i = 40; i < 60; i += 1) {
+        grid.setCell(i, 40, CELL_OCCUPIED).setCell(i, 59, CELL_OCCUPIED).setCell(40, i, CELL_OCCUPIED).setCell(59, i, CELL_OCCUPIED);
+    }
+    planner.plan(0, 0, 90, 90);
+    while(PLANNER_SEARCHING == planner.step(PLANNER_BATCH)) {
+        // keep searching
+    }
+    if((PLANNER_FAILED != planner.state()) || (0 != planner.waypointCount())) {
+        testError("PathPlanner: planned into a closed room, state %d", planner.state());
+    }
+}
+
+void TestIncremental() {
+    // searching a little at a time gives the same path
+    OccupancyGrid grid;
+    grid.begin(128, 128, 1, 0, 0);
+    seed = 7;
+    carveMaze(grid);
+    PathPlanner planner;
+    planner.begin(grid, 4096);
+    planner.setClearance(0);
+    planner.plan(1.5f, 1.5f, 125.5f, 1.5f);
+    unsigned int steps = 0;
+    while(PLANNER_SEARCHING == planner.step(10)) {
+        steps += 1;
+    }
+    const unsigned int count = planner.waypointCount();
+    Point2D path[128];
+    for(unsigned int i = 0; (i < count) && (i < 128); i += 1) {
+        path[i] = planner.waypoint(i);
+    }
+
+    planner.plan(1.5f, 1.5f, 125.5f, 1.5f);
+    planner.step(1000000);
+    if((PLANNER_PLANNED != planner.state()) || (count != planner.waypointCount()) || (steps < 100)) {
+        testError("PathPlanner: expected %d waypoints in one step", count);
+    }
+    for(unsigned int i = 0; (i < count) && (i < 128); i += 1) {
+        if((path[i].x != planner.waypoint(i).x) || (path[i].y != planner.waypoint(i).y)) {
+            testError("PathPlanner: waypoint %d differs when searched in one step", i);
+        }
+    }
+
+    //
+    // with a tiny heap the stale entries are squeezed
+    // out, but a maze needs more than 16 open cells
+    //
+    PathPlanner small;
+    small.begin(grid, 16);
+    small.setClearance(0);
+    small.plan(1.5f, 1.5f, 125.5f, 1.5f);
+    small.step(1000000);
+    if(PLANNER_FAILED != small.state()) {
+        testError("PathPlanner: expected to run out of open cells, state %d", small.state());
+    }
+}
+
+void TestDriveAroundWall() {
+    const distance_type circumference = 20;
+    const int pulses = 40;
+    RoverReplay replay(WHEELBASE, circumference, pulses, circumference, pulses);
+    TwoWheelRover &rover = replay.rover();
+    rover.setAccelerationLimits(ALL_WHEELS, WHEEL_MAX_ACCELERATION, WHEEL_MAX_JERK, WHEEL_MAX_PWM_RATE, WHEEL_MAX_PWM_JERK);
+    rover.setMotorStall(SimulatedWheel::WHEEL_STALL_PWM / 255.0f, SimulatedWheel::WHEEL_STALL_PWM / 255.0f);
+    rover.setSpeedControl(ALL_WHEELS, 10, 50, 1, 0, 0);
+    SimulatedWheel left = {0.33f, 0, 0, 0, circumference / pulses};
+    SimulatedWheel right = {0.30f, 3, 0, 0, circumference / pulses};
+
+    GotoGoalBehavior behavior;
+    behavior.attach(rover, replay.messageBus());
+    behavior.setTickPolicy(GOTO_TICK_FIXED_RATE, GOTO_TICK_MS).setSteerPolicy(GOTO_STEER_BLENDED, GOTO_SLOWDOWN_DISTANCE, GOTO_MAX_TURN_RATE);
+
+    // a wall across the way to the goal
+    OccupancyGrid grid;
+    grid.begin(MAP_HEAP_COLUMNS, MAP_HEAP_ROWS, MAP_CELL_SIZE, -(MAP_HEAP_COLUMNS * MAP_CELL_SIZE) / 2, -(MAP_HEAP_ROWS * MAP_CELL_SIZE) / 2);
+    grid.markLine(60, -60, 60, 40, CELL_OCCUPIED);
+    PathPlanner planner;
+    planner.begin(grid, PLANNER_HEAP_HEAP_COUNT);
+    planner.attach(rover, behavior);
+
+    const unsigned long stepMs = 5;
+    unsigned long ms = 1000;
+    replay.drive(ms, 0, 0);
+    planner.planAndDrive(120, 0, 0.75, 0.1);
+    distance_type closest = 1000;
+    for(; (ms < 121000) && planner.driving(); ms += stepMs) {
+        planner.poll(ms);
+        behavior.poll(ms);
+        left.step(replay.leftWheel(), ms, stepMs / 1000.0f);
+        right.step(replay.rightWheel(), ms, stepMs / 1000.0f);
+        replay.drive(ms + stepMs, left.count(), right.count());
+
+        // closest approach to the wall
+        const Pose2D pose = rover.pose();
+        const distance_type dx = pose.x - 60;
+        const distance_type dy = (pose.y > 40) ? pose.y - 40 : ((pose.y < -60) ? pose.y + 60 : 0);
+        closest = min<distance_type>(closest, HYPOT(dx, dy));
+    }
+    const Pose2D pose = rover.pose();
+    const distance_type miss = HYPOT(120 - pose.x, pose.y);
+    printf("PathPlanner: drove around a wall by %d waypoints in %.2f sec, closest %.1f cm to wall, miss %.1f cm\n",
+        planner.waypointCount(), (ms - 1000) / 1000.0f, (float)closest, (float)miss);
+
+    if(planner.driving() || (PLANNER_PLANNED != planner.state()) || (planner.waypointCount() < 2)) {
+        testError("PathPlanner: did not finish driving, %d waypoints", planner.waypointCount());
+    }
+    if(miss > 10) {
+        testError("PathPlanner: stopped %f cm from goal", (float)miss);
+    }
+    if(closest < 2) {
+        testError("PathPlanner: drove %f cm from the wall", (float)closest);
+    }
+
+    // cancelling stops the behavior it is driving
+    planner.planAndDrive(0, 0, 0.75, 0.1);
+    for(const unsigned long end = ms + 500; ms < end; ms += stepMs) {
+        planner.poll(ms);
+        behavior.poll(ms);
+        left.step(replay.leftWheel(), ms, stepMs / 1000.0f);
+        right.step(replay.rightWheel(), ms, stepMs / 1000.0f);
+        replay.drive(ms + stepMs, left.count(), right.count());
+    }
+    planner.cancel();
+    if(planner.driving() || (NOT_RUNNING != behavior.state())) {
+        testError("PathPlanner: still driving after cancel, behavior state %d", behavior.state());
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/map/path_planner.test.cpp replay/rover_replay.cpp ../src/map/occupancy_grid.cpp ../src/map/path_planner.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+    TestMazes();
+    TestOpenGround();
+    TestIncremental();
+    TestDriveAroundWall();
+
+    return testResults("path_planner");
+}
@@ -0,0 +1,134 @@
+#include <string.h>
+#include <thread>
+#include <atomic>
+#include <stdlib.h>
+
+#include "../../test.h"
+#include "../../../src/message_bus/message_bridge.h"
+
+using namespace std;
+
+//
+// buses are global so their subscription tables start zeroed
+//
+MessageBus controlBus;
+MessageBus networkBus;
+
+//
+// counts messages republished on the consumer bus
+//
+class CountingSubscriber : public Subscriber {
+    public:
+    int count = 0;
+    int lastSequence = 0;
+    int outOfOrder = 0;
+    Specifier lastSpecifier = NONE;
+
+    virtual void onMessage(
+        Publisher &publisher,       // IN : publisher of message
+        Message message,            // IN : message that was published
+        Specifier specifier,        // IN : specifier (like LEFT_WHEEL_SPEC)
+        const char *data)           // IN : message data as a c-cstring
+    {
+        const int sequence = atoi(data);
+        if(sequence != lastSequence + 1) {
+            outOfOrder += 1;
+        }
+        lastSequence = sequence;
+        lastSpecifier = specifier;
+        count += 1;
+    }
+};
+
+void TestBridgeSingleThread() {
+    MessageBridge bridge;
+    Publisher wheel(LEFT_WHEEL_SPEC);
+    CountingSubscriber subscriber;
+
+    bridge.attach(controlBus, networkBus).bridge(SPEED_CONTROL);
+    subscriber.subscribe(networkBus, SPEED_CONTROL);
+
+    wheel.publish(controlBus, SPEED_CONTROL, LEFT_WHEEL_SPEC, "1");
+    wheel.publish(controlBus, SPEED_CONTROL, LEFT_WHEEL_SPEC, "2");
+    wheel.publish(controlBus, WHEEL_POWER, LEFT_WHEEL_SPEC, "3");  // not bridged
+
+    //
+    // nothing is delivered until the consumer polls
+    //
+    if(0 != subscriber.count) {
+        testError("MessageBridge delivered before poll(): 0 != %d", subscriber.count);
+    }
+    if(2 != bridge.poll()) {
+        testError("MessageBridge.poll() republished wrong count%s", "");
+    }
+    if((2 != subscriber.count) || (LEFT_WHEEL_SPEC != subscriber.lastSpecifier) || (0 != subscriber.outOfOrder)) {
+        testError("MessageBridge republished wrong messages: count = %d, out of order = %d", subscriber.count, subscriber.outOfOrder);
+    }
+
+    //
+    // overflow is dropped and counted
+    //
+    for(unsigned int i = 0; i < MESSAGE_BRIDGE_CAPACITY + 3; i += 1) {
+        wheel.publish(controlBus, SPEED_CONTROL, LEFT_WHEEL_SPEC, "0");
+    }
+    if(3 != bridge.dropped()) {
+        testError("MessageBridge.dropped() is wrong: 3 != %d", bridge.dropped());
+    }
+    bridge.poll();
+
+    bridge.detach();
+    wheel.publish(controlBus, SPEED_CONTROL, LEFT_WHEEL_SPEC, "0");
+    if(0 != bridge.pending()) {
+        testError("MessageBridge queued a message after detach()%s", "");
+    }
+    subscriber.unsubscribe(networkBus, SPEED_CONTROL);
+}
+
+void TestBridgeAcrossThreads() {
+    //
+    // control thread publishes, network thread polls
+    //
+    const int COUNT = 20000;
+    MessageBridge bridge;
+    CountingSubscriber subscriber;
+
+    bridge.attach(controlBus, networkBus).bridge(ROVER_POSE);
+    subscriber.subscribe(networkBus, ROVER_POSE);
+
+    atomic<bool> done(false);
+    thread control([&]() {
+        Publisher rover(ROVER_SPEC);
+        char data[16];
+        for(int i = 1; i <= COUNT; i += 1) {
+            snprintf(data, sizeof(data), "%d", i);
+            while(bridge.pending() >= MESSAGE_BRIDGE_CAPACITY) {
+                this_thread::yield();   // don't overrun; we are testing ordering not drops
+            }
+            rover.publish(controlBus, ROVER_POSE, ROVER_SPEC, data);
+        }
+        done = true;
+    });
+
+    while(!done || (bridge.pending() > 0)) {
+        if(0 == bridge.poll()) {
+            this_thread::yield();
+        }
+    }
+    control.join();
+
+    if((COUNT != subscriber.count) || (0 != subscriber.outOfOrder) || (0 != bridge.dropped())) {
+        testError("MessageBridge across threads: count = %d, out of order = %d, dropped = %d",
+            subscriber.count, subscriber.outOfOrder, bridge.dropped());
+    }
+    subscriber.unsubscribe(networkBus, ROVER_POSE);
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -pthread -lstdc++ test.cpp src/message_bus/message_bridge.test.cpp ../src/message_bus/message_bridge.cpp ../src/message_bus/message_bus.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+    TestBridgeSingleThread();
+    TestBridgeAcrossThreads();
+
+    return testResults("message_bridge");
+}
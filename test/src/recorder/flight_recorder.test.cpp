@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../test.h"
+#include "../../../src/recorder/flight_recorder.h"
+#include "../../../src/rover/odometry.h"
+#include "../../../src/error.h"
+
+using namespace std;
+
+static const char *LOG_PATH = "/tmp/flight_recorder_test.log";
+
+static FlightLogHeader testHeader() {
+    FlightLogHeader header;
+    header.startMs = 1000;
+    header.wheelBase = 13.5f;
+    header.leftCircumference = 21.9f;
+    header.rightCircumference = 21.8f;
+    header.leftCountsPerRevolution = 40;
+    header.rightCountsPerRevolution = 40;
+    header.posePollMs = POSE_POLL_MS;
+    header.poseMinEncoderCount = POSE_MIN_ENCODER_COUNT;
+    return header;
+}
+
+//
+// read the whole log into memory; caller frees
+//
+static uint8_t *readLog(uint32_t &size) {
+    FILE *file = fopen(LOG_PATH, "rb");
+    if(nullptr == file) return nullptr;
+    fseek(file, 0, SEEK_END);
+    size = (uint32_t)ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *log = (uint8_t *)malloc(size);
+    if(1 != fread(log, size, 1, file)) {
+        free(log);
+        log = nullptr;
+    }
+    fclose(file);
+    return log;
+}
+
+//
+// drive a curve, estimating pose the way TwoWheelRover::_pollPose() does,
+// and recording the same samples and poses it would.
+//
+static unsigned long recordDrive(FlightRecorder &recorder, Pose2D poses[], unsigned long maxPoses) {
+    const FlightLogHeader header = testHeader();
+    Odometry odometry(header.wheelBase);
+    odometry.setWheels(header.leftCircumference, header.leftCountsPerRevolution, header.rightCircumference, header.rightCountsPerRevolution);
+
+    unsigned long poseCount = 0;
+    encoder_count_type lastLeftTicks = 0;
+    encoder_count_type lastRightTicks = 0;
+    recorder.recordCommand(1000, "cmd(1, twist(10, 0.5))");
+    for(unsigned long ms = 1000; ms < 6000; ms += 1) {
+        recorder.recordWheelPower(ms, ms & 1, true, (uint8_t)(ms / 32));
+        if(odometry.isDue(ms)) {
+            const bool starting = !odometry.started();
+            EncoderSample sample;
+            sample.ms = ms;
+            sample.leftTicks = (ms - 1000) / 7;     // left wheel is slower, so the rover turns
+            sample.rightTicks = (ms - 1000) / 5;
+            sample.leftCount = sample.leftTicks;
+            sample.rightCount = sample.rightTicks;
+            if(starting || (sample.leftTicks != lastLeftTicks) || (sample.rightTicks != lastRightTicks)) {
+                recorder.recordEncoders(ms, starting ? FLIGHT_ENCODERS_START : 0, sample);
+                lastLeftTicks = sample.leftTicks;
+                lastRightTicks = sample.rightTicks;
+            }
+            if(odometry.update(sample)) {
+                recorder.recordPose(ms, odometry.pose());
+                if(poseCount < maxPoses) {
+                    poses[poseCount] = odometry.pose();
+                }
+                poseCount += 1;
+            }
+        }
+        recorder.flush(ms);
+        recorder.poll();    // writer keeps up; it writes a chunk each loop
+    }
+    return poseCount;
+}
+
+void TestFlightReplay() {
+    FlightRecorder recorder;
+    if(SUCCESS != recorder.begin(LOG_PATH, testHeader())) {
+        testError("FlightRecorder.begin() failed%s", "");
+        return;
+    }
+    Pose2D poses[512];
+    const unsigned long poseCount = recordDrive(recorder, poses, 512);
+    recorder.end();
+    if(0 != recorder.dropped()) {
+        testError("FlightRecorder: dropped %u records while writer kept up", recorder.dropped());
+    }
+
+    uint32_t size;
+    uint8_t *log = readLog(size);
+    FlightLogReader reader(log, size);
+    if(!reader.valid() || !reader.indexed()) {
+        testError("FlightLogReader: log should be valid and indexed%s", "");
+        free(log);
+        return;
+    }
+    if((13.5f != reader.header().wheelBase) || (21.8f != reader.header().rightCircumference) || (40 != reader.header().leftCountsPerRevolution)) {
+        testError("FlightLogReader: header is wrong%s", "");
+    }
+
+    //
+    // replay encoder samples; every replayed pose must exactly match
+    //
+    const FlightLogHeader &header = reader.header();
+    Odometry odometry(header.wheelBase);
+    odometry.setWheels(header.leftCircumference, header.leftCountsPerRevolution, header.rightCircumference, header.rightCountsPerRevolution);
+
+    unsigned long replayed = 0;
+    unsigned long recorded = 0;
+    unsigned long commands = 0;
+    unsigned long wheelChanges = 0;
+    FlightRecord record;
+    while(reader.next(record)) {
+        if(FLIGHT_RECORD_COMMAND == record.type) {
+            if((0 != strncmp("cmd(1, twist(10, 0.5))", record.text, record.textLength)) || (1000 != record.at)) {
+                testError("FlightLogReader: command is wrong%s", "");
+            }
+            commands += 1;
+        } else if(FLIGHT_RECORD_WHEEL_POWER == record.type) {
+            wheelChanges += 1;
+        } else if(FLIGHT_RECORD_ENCODERS == record.type) {
+            if(0 != (record.flags & FLIGHT_ENCODERS_START)) {
+                odometry.reset();
+            }
+            if(odometry.update(record.encoders)) {
+                const Pose2D pose = odometry.pose();
+                if((replayed < 512) && ((pose.x != poses[replayed].x) || (pose.y != poses[replayed].y) || (pose.angle != poses[replayed].angle))) {
+                    testError("Flight replay: pose %lu does not match", replayed);
+                }
+                replayed += 1;
+            }
+        } else if(FLIGHT_RECORD_POSE == record.type) {
+            const Pose2D pose = odometry.pose();
+            if((pose.x != record.pose.x) || (pose.y != record.pose.y) || (pose.angle != record.pose.angle)) {
+                testError("Flight replay: recorded pose at %u does not match replay", record.at);
+            }
+            recorded += 1;
+        }
+    }
+    if((poseCount != replayed) || (poseCount != recorded) || (poseCount < 100)) {
+        testError("Flight replay: %lu poses, replayed %lu, recorded %lu", poseCount, replayed, recorded);
+    }
+    if((1 != commands) || (5000 != wheelChanges)) {
+        testError("Flight replay: %lu commands, %lu wheel power changes", commands, wheelChanges);
+    }
+
+    //
+    // seek using the index; no record before the seek time is skipped
+    //
+    reader.seek(4000);
+    if(!reader.next(record) || (record.at >= 4000) || (record.offset <= (uint32_t)FLIGHT_HEADER_BYTES)) {
+        testError("FlightLogReader.seek() should start before 4000, at %u", record.at);
+    }
+    reader.seek(0);
+    if(!reader.next(record) || (FLIGHT_RECORD_COMMAND != record.type)) {
+        testError("FlightLogReader.seek(0) should start at first record%s", "");
+    }
+
+    //
+    // a log cut off mid-record, like on power loss, is read up to the cut
+    //
+    FlightLogReader truncated(log, size / 2);
+    unsigned long count = 0;
+    while(truncated.next(record)) {
+        count += 1;
+    }
+    if(!truncated.valid() || truncated.indexed() || (0 == count) || (record.offset >= size / 2)) {
+        testError("FlightLogReader: truncated log read %lu records", count);
+    }
+
+    free(log);
+}
+
+void TestFlightDropped() {
+    FlightRecorder recorder;
+    recorder.begin(LOG_PATH, testHeader());
+
+    //
+    // writer never runs, so blocks run out
+    //
+    const Pose2D pose = {1, 2, 3};
+    const unsigned int perBlock = FLIGHT_BLOCK_BYTES / (FLIGHT_RECORD_HEADER_BYTES + 12);
+    const unsigned int total = (FLIGHT_BLOCK_COUNT + 1) * perBlock;
+    for(unsigned int i = 0; i < total; i += 1) {
+        recorder.recordPose(1000 + i, pose);
+    }
+    const uint32_t dropped = recorder.dropped();
+    if(dropped != (total - FLIGHT_BLOCK_COUNT * perBlock)) {
+        testError("FlightRecorder: expected %u dropped records", total - FLIGHT_BLOCK_COUNT * perBlock);
+    }
+
+    //
+    // once the writer catches up, the gap is noted in the log
+    //
+    while(recorder.writing()) {
+        recorder.poll();
+    }
+    recorder.recordPose(5000, pose);
+    recorder.end();
+
+    uint32_t size;
+    uint8_t *log = readLog(size);
+    FlightLogReader reader(log, size);
+    FlightRecord record;
+    unsigned long poses = 0;
+    uint32_t noted = 0;
+    while(reader.next(record)) {
+        if(FLIGHT_RECORD_POSE == record.type) poses += 1;
+        if(FLIGHT_RECORD_DROPPED == record.type) noted += record.dropped;
+    }
+    if((noted != dropped) || (poses != FLIGHT_BLOCK_COUNT * perBlock + 1)) {
+        testError("FlightRecorder: log notes %u dropped records", noted);
+    }
+    free(log);
+}
+
+void TestFlightChunkedWrite() {
+    FlightRecorder recorder;
+    recorder.begin(LOG_PATH, testHeader());
+
+    //
+    // a full block is written a chunk at a time,
+    // so no one poll blocks on the whole block
+    //
+    const Pose2D pose = {1, 2, 3};
+    const unsigned int perBlock = FLIGHT_BLOCK_BYTES / (FLIGHT_RECORD_HEADER_BYTES + 12);
+    for(unsigned int i = 0; i <= perBlock; i += 1) {
+        recorder.recordPose(1000 + i, pose);
+    }
+    int polls = 0;
+    uint32_t written = recorder.written();
+    while(recorder.writing()) {
+        recorder.poll();
+        if(recorder.written() != written) {
+            break;  // the block is indexed once it is completely written
+        }
+        polls += 1;
+    }
+    const int chunks = (FLIGHT_BLOCK_BYTES + FLIGHT_WRITE_BYTES - 1) / FLIGHT_WRITE_BYTES;
+    if(polls != (chunks - 1)) {
+        testError("FlightRecorder: block should take %d polls, took %d", chunks, polls + 1);
+    }
+    recorder.end();
+    if(0 != recorder.dropped()) {
+        testError("FlightRecorder: dropped %u records", recorder.dropped());
+    }
+}
+
+void TestPackFlightRecords() {
+    uint8_t buffer[64];
+    EncoderSample sample = {1234, -5, 6, 7, 8};
+    if(FLIGHT_RECORD_HEADER_BYTES + 17 != packFlightEncoders(buffer, sizeof(buffer), 1234, FLIGHT_ENCODERS_START, sample)) {
+        testError("packFlightEncoders: length is wrong%s", "");
+    }
+    if((FLIGHT_RECORD_ENCODERS != buffer[0]) || (17 != buffer[1]) || (FLIGHT_ENCODERS_START != buffer[6]) || (0xFB != buffer[7]) || (0xFF != buffer[10])) {
+        testError("packFlightEncoders: record is wrong%s", "");
+    }
+    if(-1 != packFlightPose(buffer, FLIGHT_RECORD_HEADER_BYTES + 11, 0, {0, 0, 0})) {
+        testError("packFlightPose: should fail on small buffer%s", "");
+    }
+    if(FLIGHT_HEADER_BYTES != packFlightHeader(buffer, sizeof(buffer), testHeader()) || (0 != memcmp("FREC", buffer, 4))) {
+        testError("packFlightHeader: header is wrong%s", "");
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ test.cpp src/recorder/flight_recorder.test.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/rover/odometry.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+    TestPackFlightRecords();
+    TestFlightReplay();
+    TestFlightDropped();
+    TestFlightChunkedWrite();
+
+    remove(LOG_PATH);
+    return testResults("flight_recorder");
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <vector>
+
+#include "../../replay/rover_replay.h"
+#include "../../../src/rover/odometry.h"
+
+using namespace std;
+
+//
+// Time per update of the rover's speed and pose
+// estimation over millions of replayed samples,
+// through the whole DriveWheel/TwoWheelRover path
+// and through Odometry alone.
+//
+
+static inline uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static volatile float sink = 0;   // keep the optimizer from removing the work
+
+/**
+ * Count the updates the rover publishes
+ */
+class CountTraces : public ReplayTraceListener {
+    public:
+    unsigned long speeds = 0;
+    unsigned long poses = 0;
+
+    void onSpeed(unsigned long, Specifier, DriveWheel &driveWheel) {
+        speeds += 1;
+        sink = driveWheel.speed();
+    }
+
+    void onPose(unsigned long, TwoWheelRover &rover) {
+        poses += 1;
+        sink = rover.pose().x;
+    }
+};
+
+int main() {
+    // from test folder run:
+    // gcc -O2 -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -lstdc++ -Ireplay -I../src -include Arduino.h src/replay/rover_replay.bench.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+    //
+    // a long wandering drive sampled every 5ms;
+    // wheel speeds vary slowly so the rover curves back and forth
+    //
+    const unsigned long COUNT = 4000000;
+    vector<ReplaySample> samples;
+    samples.reserve(COUNT);
+    double left = 0;
+    double right = 0;
+    for(unsigned long i = 0; i < COUNT; i += 1) {
+        const double phase = (double)(i % 20000) / 20000.0;
+        left += 0.20 + 0.05 * (phase < 0.5 ? phase : 1 - phase);
+        right += 0.20 + 0.05 * (phase < 0.5 ? 0.5 - phase : phase - 0.5);
+        samples.push_back({1000 + i * 5, (encoder_count_type)left, (encoder_count_type)right, 200, 200});
+    }
+
+    //
+    // whole path; encoders, DriveWheel::_pollSpeed, TwoWheelRover::_pollPose and the message bus
+    //
+    CountTraces traces;
+    RoverReplay replay(WHEELBASE, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION);
+    replay.setListener(&traces);
+    uint64_t startNs = nowNs();
+    for(const ReplaySample &sample : samples) {
+        replay.step(sample);
+    }
+    uint64_t elapsedNs = nowNs() - startNs;
+    printf("rover_replay: %lu samples, %.1f ns per sample, %lu speed updates, %lu pose updates, %.1f ns per update\n",
+        COUNT, (double)elapsedNs / COUNT, traces.speeds, traces.poses, (double)elapsedNs / (traces.speeds + traces.poses));
+
+    //
+    // pose estimation alone, with every sample due
+    //
+    Odometry odometry(WHEELBASE);
+    odometry.setWheels(WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION);
+    unsigned long updates = 0;
+    startNs = nowNs();
+    for(const ReplaySample &sample : samples) {
+        const EncoderSample encoders = {sample.ms, sample.leftCount, sample.rightCount, sample.leftCount, sample.rightCount};
+        if(odometry.update(encoders)) {
+            updates += 1;
+        }
+    }
+    elapsedNs = nowNs() - startNs;
+    sink = odometry.pose().x;
+    printf("rover_replay: odometry alone, %lu samples, %.1f ns per sample, %lu updates, %.1f ns per update\n",
+        COUNT, (double)elapsedNs / COUNT, updates, (double)elapsedNs / updates);
+
+    return 0;
+}
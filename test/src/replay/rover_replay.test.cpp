@@ -0,0 +1,139 @@
+#include <math.h>
+#include <vector>
+
+#include "../../test.h"
+#include "../../replay/rover_replay.h"
+
+using namespace std;
+
+/**
+ * Keep the traces of a replay
+ */
+class KeepTraces : public ReplayTraceListener {
+    public:
+    vector<Pose2D> poses;
+    vector<unsigned long> poseMs;
+    vector<speed_type> speeds[2];
+
+    void onSpeed(unsigned long, Specifier wheel, DriveWheel &driveWheel) {
+        speeds[(LEFT_WHEEL_SPEC == wheel) ? 0 : 1].push_back(driveWheel.speed());
+    }
+
+    void onPose(unsigned long ms, TwoWheelRover &rover) {
+        poses.push_back(rover.pose());
+        poseMs.push_back(ms);
+    }
+};
+
+static void replay(const vector<ReplaySample> &samples, KeepTraces &traces) {
+    RoverReplay rover(10, 20, 40, 20, 40);
+    rover.setListener(&traces);
+    for(const ReplaySample &sample : samples) {
+        rover.step(sample);
+    }
+}
+
+void TestReplayStraight() {
+    //
+    // both wheels at one revolution per second
+    //
+    vector<ReplaySample> samples;
+    for(unsigned long ms = 1000; ms <= 3000; ms += 5) {
+        const encoder_count_type count = (ms - 1000) * 40 / 1000;
+        samples.push_back({ms, count, count, 200, 200});
+    }
+
+    KeepTraces traces;
+    replay(samples, traces);
+
+    if(traces.poses.size() < 2) {
+        testError("RoverReplay: expected poses, got %d", (int)traces.poses.size());
+        return;
+    }
+    const Pose2D last = traces.poses.back();
+    if((fabsf((float)last.x - 40.0f) > 0.5f) || (0 != last.y) || (0 != last.angle)) {
+        testError("RoverReplay: straight line ended at (%f, %f)", (float)last.x, (float)last.y);
+    }
+
+    //
+    // once warmed up, measured speed is the recorded 20 units/sec
+    //
+    if(traces.speeds[0].empty() || (fabsf((float)traces.speeds[0].back() - 20.0f) > 0.5f)) {
+        testError("RoverReplay: left speed should be 20, got %f", traces.speeds[0].empty() ? 0 : (float)traces.speeds[0].back());
+    }
+}
+
+void TestReplayDeterministic() {
+    //
+    // turn in reverse, then coast
+    //
+    vector<ReplaySample> samples;
+    for(unsigned long ms = 0; ms <= 2000; ms += 7) {
+        const int pwm = (ms < 1500) ? -180 : 0;
+        samples.push_back({ms + 100, -(encoder_count_type)(ms / 31), -(encoder_count_type)(ms / 43), pwm, pwm});
+    }
+
+    KeepTraces first;
+    KeepTraces second;
+    replay(samples, first);
+    replay(samples, second);
+
+    if(first.poses.empty() || (first.poses.size() != second.poses.size())) {
+        testError("RoverReplay: replays produced %d and %d poses", (int)first.poses.size(), (int)second.poses.size());
+        return;
+    }
+    for(size_t i = 0; i < first.poses.size(); i += 1) {
+        if((first.poseMs[i] != second.poseMs[i]) || (first.poses[i].x != second.poses[i].x) || (first.poses[i].y != second.poses[i].y) || (first.poses[i].angle != second.poses[i].angle)) {
+            testError("RoverReplay: replays differ at pose %d", (int)i);
+            return;
+        }
+    }
+    if(first.poses.back().x >= 0) {
+        testError("RoverReplay: rover should have backed up, x is %f", (float)first.poses.back().x);
+    }
+}
+
+void TestSetVelocity() {
+    RoverReplay replay(10, 20, 40, 20, 40);
+    TwoWheelRover &rover = replay.rover();
+    rover.setSpeedControl(ALL_WHEELS, 5, 50, 1, 0, 0);
+
+    //
+    // within limits, wheels are half the wheel base
+    // times the turning rate either side of linear
+    //
+    rover.setVelocity(20, 1);
+    if((15 != replay.leftWheel().targetSpeed()) || (25 != replay.rightWheel().targetSpeed())) {
+        testError("setVelocity: expected 15, 25, got %f, %f", 
+            (float)replay.leftWheel().targetSpeed(), (float)replay.rightWheel().targetSpeed());
+    }
+
+    // spin in place clockwise
+    rover.setVelocity(0, -2);
+    if((10 != replay.leftWheel().targetSpeed()) || (-10 != replay.rightWheel().targetSpeed())) {
+        testError("setVelocity: expected 10, -10, got %f, %f", 
+            (float)replay.leftWheel().targetSpeed(), (float)replay.rightWheel().targetSpeed());
+    }
+
+    //
+    // past the limit the faster wheel saturates 
+    // and the curvature, right / left, is kept
+    //
+    rover.setVelocity(-60, 4);  // -80, -40
+    const speed_type left = replay.leftWheel().targetSpeed();
+    const speed_type right = replay.rightWheel().targetSpeed();
+    if((fabsf((float)left + 50) > 0.001f) || (fabsf((float)right + 25) > 0.001f)) {
+        testError("setVelocity: expected -50, -25 got %f, %f", (float)left, (float)right);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/replay/rover_replay.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+    TestReplayStraight();
+    TestReplayDeterministic();
+    TestSetVelocity();
+
+    return testResults("rover_replay");
+}
@@ -0,0 +1,135 @@
+#ifndef TEST_FIGURE_EIGHT_H
+#define TEST_FIGURE_EIGHT_H
+
+#include <math.h>
+
+#include "../../../src/config.h"
+#include "../../../src/rover/odometry.h"
+
+//
+// Host simulation of the rover driving figure-eights,
+// used to compare pose estimates against ground truth.
+//
+// The rover drives at a constant speed and turns one
+// full circle left, then one full circle right.  The
+// true pose is integrated every millisecond from the
+// continuous wheel distances; the encoders only see
+// whole ticks, as the LM393 encoders do, and are
+// sampled every POSE_POLL_MS like TwoWheelRover::_pollPose().
+//
+// The simulation is in float, whatever distance_type
+// is, so it drives the same in fixed point builds.
+//
+typedef struct TruePose {
+    float x;
+    float y;
+    float angle;
+} TruePose;
+
+typedef struct FigureEight {
+    float speed;            // cm/sec at the center of the rover
+    float radius;           // radius of each loop in cm
+    float wheelBase;        // distance between the wheels in cm
+    float distancePerTick;  // cm per encoder tick
+
+    // state
+    unsigned long ms;
+    float leftDistance;     // true distance travelled by each wheel
+    float rightDistance;
+    TruePose truth;         // true pose
+} FigureEight;
+
+inline FigureEight figureEight(float speed, float radius) {
+    FigureEight eight;
+    eight.speed = speed;
+    eight.radius = radius;
+    eight.wheelBase = (float)WHEELBASE;
+    eight.distancePerTick = (float)WHEEL_CIRCUMFERENCE / PULSES_PER_REVOLUTION;
+    eight.ms = 1000;
+    eight.leftDistance = 0;
+    eight.rightDistance = 0;
+    eight.truth = {0, 0, 0};
+    return eight;
+}
+
+/**
+ * Advance the simulation one millisecond
+ */
+inline void figureEightStep(FigureEight &eight) {
+    const double loopMs = 2000.0 * PI * eight.radius / eight.speed;
+    const double turn = (fmod((double)(eight.ms - 1000), 2 * loopMs) < loopMs) ? 1 : -1;
+    const double angularSpeed = turn * eight.speed / eight.radius;
+
+    const double dt = 0.001;
+    const double left = (eight.speed - angularSpeed * eight.wheelBase / 2) * dt;
+    const double right = (eight.speed + angularSpeed * eight.wheelBase / 2) * dt;
+    eight.leftDistance += left;
+    eight.rightDistance += right;
+
+    // exact for constant wheel speeds, and in double so truth has no float drift
+    const double deltaAngle = (right - left) / eight.wheelBase;
+    const double radius = ((right + left) / 2) / deltaAngle;
+    const double angle = eight.truth.angle;
+    eight.truth.x += radius * (sin(angle + deltaAngle) - sin(angle));
+    eight.truth.y -= radius * (cos(angle + deltaAngle) - cos(angle));
+    eight.truth.angle = atan2(sin(angle + deltaAngle), cos(angle + deltaAngle));
+    eight.ms += 1;
+}
+
+/**
+ * Read the encoders as whole ticks
+ */
+inline EncoderSample figureEightSample(const FigureEight &eight) {
+    EncoderSample sample;
+    sample.ms = eight.ms;
+    sample.leftCount = (encoder_count_type)floor(eight.leftDistance / eight.distancePerTick);
+    sample.rightCount = (encoder_count_type)floor(eight.rightDistance / eight.distancePerTick);
+    sample.leftTicks = sample.leftCount;     // always forward
+    sample.rightTicks = sample.rightCount;
+    return sample;
+}
+
+/**
+ * The pose estimate TwoWheelRover used before exact-arc
+ * odometry: the midpoint heading, updated only once a wheel
+ * moved POSE_MIN_ENCODER_COUNT ticks.  Kept to compare against.
+ */
+typedef struct MidpointOdometry {
+    bool started = false;
+    encoder_count_type leftTicks = 0;
+    encoder_count_type rightTicks = 0;
+    distance_type leftDistance = 0;
+    distance_type rightDistance = 0;
+    Pose2D pose = {0, 0, 0};
+
+    bool update(const EncoderSample &sample, distance_type distancePerTick, distance_type wheelBase) {
+        const distance_type left = distancePerTick * sample.leftCount;
+        const distance_type right = distancePerTick * sample.rightCount;
+        if(!started) {
+            started = true;
+            leftTicks = sample.leftTicks;
+            rightTicks = sample.rightTicks;
+            leftDistance = left;
+            rightDistance = right;
+            return true;
+        }
+        if(((sample.leftTicks - leftTicks) >= POSE_MIN_ENCODER_COUNT)
+            || ((sample.rightTicks - rightTicks) >= POSE_MIN_ENCODER_COUNT))
+        {
+            const distance_type deltaDistance = ((right - rightDistance) + (left - leftDistance)) / 2;
+            const distance_type deltaAngle = ((right - rightDistance) - (left - leftDistance)) / wheelBase;
+            const distance_type heading = limitAngle(pose.angle + deltaAngle / 2);
+            pose.x += deltaDistance * COS(heading);
+            pose.y += deltaDistance * SIN(heading);
+            pose.angle = limitAngle(pose.angle + deltaAngle);
+            leftTicks = sample.leftTicks;
+            rightTicks = sample.rightTicks;
+            leftDistance = left;
+            rightDistance = right;
+            return true;
+        }
+        return false;
+    }
+} MidpointOdometry;
+
+#endif // TEST_FIGURE_EIGHT_H
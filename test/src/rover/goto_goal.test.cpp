@@ -0,0 +1,103 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "../../test.h"
+#include "../../replay/rover_replay.h"
+#include "../../../src/rover/goto_goal.h"
+#include "simulated_wheel.h"
+
+/**
+ * Drive from the origin to a goal with mismatched motors
+ * and measure how long it takes and how far the rover drives.
+ */
+static bool gotoGoal(
+    GotoGoalSteer steer,        // IN : how the behavior steers
+    distance_type x,            // IN : goal position
+    distance_type y,
+    unsigned long &timeToGoalMs,// OUT: time to reach goal
+    distance_type &pathLength,  // OUT: distance driven
+    distance_type &miss)        // OUT: distance from goal when stopped
+                                // RET: true if goal achieved
+{
+    const distance_type circumference = 20;
+    const int pulses = 40;
+    RoverReplay replay(WHEELBASE, circumference, pulses, circumference, pulses);
+    TwoWheelRover &rover = replay.rover();
+    rover.setAccelerationLimits(ALL_WHEELS, WHEEL_MAX_ACCELERATION, WHEEL_MAX_JERK, WHEEL_MAX_PWM_RATE, WHEEL_MAX_PWM_JERK);
+    rover.setMotorStall(SimulatedWheel::WHEEL_STALL_PWM / 255.0f, SimulatedWheel::WHEEL_STALL_PWM / 255.0f);
+    rover.setSpeedControl(ALL_WHEELS, 10, 50, 1, 0, 0);
+
+    SimulatedWheel left = {0.33f, 0, 0, 0, circumference / pulses};
+    SimulatedWheel right = {0.30f, 3, 0, 0, circumference / pulses};
+
+    GotoGoalBehavior behavior;
+    behavior.attach(rover, replay.messageBus());
+    behavior.setTickPolicy(GOTO_TICK_FIXED_RATE, GOTO_TICK_MS).setSteerPolicy(steer, GOTO_SLOWDOWN_DISTANCE, GOTO_MAX_TURN_RATE);
+
+    const unsigned long stepMs = 5;
+    unsigned long ms = 1000;
+    replay.drive(ms, 0, 0);
+    behavior.gotoGoal(x, y, 0.75, 0.1);
+    for(; (ms < 61000) && (NOT_RUNNING != behavior.state()); ms += stepMs) {
+        behavior.poll(ms);
+        left.step(replay.leftWheel(), ms, stepMs / 1000.0f);
+        right.step(replay.rightWheel(), ms, stepMs / 1000.0f);
+        replay.drive(ms + stepMs, left.count(), right.count());
+    }
+    const bool achieved = (NOT_RUNNING == behavior.state());
+    timeToGoalMs = behavior.timeToGoalMs();
+    pathLength = behavior.pathLength();
+    behavior.cancel();
+
+    const Pose2D pose = rover.pose();
+    miss = HYPOT(x - pose.x, y - pose.y);
+    return achieved;
+}
+
+void TestBlendedIsFaster() {
+    const distance_type goals[][2] = {
+        {80, 0},    // straight ahead
+        {60, 60},   // ahead and left
+        {40, -60},  // ahead and right
+        {0, 50},    // to the left
+        {-60, 20},  // behind
+    };
+    const int count = sizeof(goals) / sizeof(goals[0]);
+
+    unsigned long totalTurnMs = 0;
+    unsigned long totalBlendMs = 0;
+    for(int i = 0; i < count; i += 1) {
+        unsigned long turnMs, blendMs;
+        distance_type turnPath, blendPath;
+        distance_type turnMiss, blendMiss;
+        const bool turnAchieved = gotoGoal(GOTO_STEER_TURN_THEN_DRIVE, goals[i][0], goals[i][1], turnMs, turnPath, turnMiss);
+        const bool blendAchieved = gotoGoal(GOTO_STEER_BLENDED, goals[i][0], goals[i][1], blendMs, blendPath, blendMiss);
+        printf("GotoGoal: goal (%.0f, %.0f) turn then drive %s %.2f sec, path %.1f cm, miss %.1f cm; blended %s %.2f sec, path %.1f cm, miss %.1f cm\n",
+            (float)goals[i][0], (float)goals[i][1],
+            turnAchieved ? "achieved in" : "gave up after", turnMs / 1000.0f, (float)turnPath, (float)turnMiss,
+            blendAchieved ? "achieved in" : "gave up after", blendMs / 1000.0f, (float)blendPath, (float)blendMiss);
+
+        if(!blendAchieved) {
+            testError("GotoGoal: blended controller did not reach (%f, %f)", (float)goals[i][0], (float)goals[i][1]);
+        }
+        if(blendMiss > 10) {
+            testError("GotoGoal: blended controller stopped %f cm from goal", (float)blendMiss);
+        }
+        totalTurnMs += turnMs;
+        totalBlendMs += blendMs;
+    }
+    printf("GotoGoal: total time to goal %.2f sec turn then drive, %.2f sec blended\n", totalTurnMs / 1000.0f, totalBlendMs / 1000.0f);
+
+    if(totalBlendMs * 2 > totalTurnMs) {
+        testError("GotoGoal: expected blended to take less than half the time, got %lu vs %lu ms", totalBlendMs, totalTurnMs);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/goto_goal.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+    TestBlendedIsFaster();
+
+    return testResults("goto_goal");
+}
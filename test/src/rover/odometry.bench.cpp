@@ -0,0 +1,67 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+
+#include "../../../src/rover/odometry.h"
+#include "figure_eight.h"
+
+using namespace std;
+
+//
+// Time per pose update for exact-arc odometry,
+// which integrates every encoder batch, and the
+// midpoint estimate it replaced, which waited
+// for POSE_MIN_ENCODER_COUNT ticks, over the
+// same figure-eight encoder samples.
+//
+
+static inline uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static volatile float sink = 0;   // keep the optimizer from removing the work
+
+int main() {
+    // from test folder run:
+    // gcc -O2 -DTESTING -std=c++11 -lstdc++ src/rover/odometry.bench.cpp ../src/rover/odometry.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+    //
+    // record the encoder samples first so
+    // only the pose updates are timed
+    //
+    const int COUNT = 200000;
+    static EncoderSample samples[COUNT];
+    FigureEight eight = figureEight(20, 30);
+    for(int i = 0; i < COUNT; i += 1) {
+        for(int j = 0; j < POSE_POLL_MS; j += 1) {
+            figureEightStep(eight);
+        }
+        samples[i] = figureEightSample(eight);
+    }
+
+    Odometry odometry(eight.wheelBase);
+    odometry.setWheels(WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION);
+    int arcUpdates = 0;
+    uint64_t startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        arcUpdates += odometry.update(samples[i]) ? 1 : 0;
+    }
+    const uint64_t arcNs = nowNs() - startNs;
+    sink += odometry.pose().x;
+
+    MidpointOdometry midpoint;
+    int midpointUpdates = 0;
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        midpointUpdates += midpoint.update(samples[i], eight.distancePerTick, eight.wheelBase) ? 1 : 0;
+    }
+    const uint64_t midpointNs = nowNs() - startNs;
+    sink += midpoint.pose.x;
+
+    printf("odometry: exact arc %.1f ns/sample, %d of %d samples updated the pose\n",
+        (double)arcNs / COUNT, arcUpdates, COUNT);
+    printf("odometry: midpoint  %.1f ns/sample, %d of %d samples updated the pose\n",
+        (double)midpointNs / COUNT, midpointUpdates, COUNT);
+
+    return 0;
+}
@@ -0,0 +1,298 @@
+#include <math.h>
+
+#include "../../test.h"
+#include "../../../src/rover/odometry.h"
+#include "figure_eight.h"
+
+using namespace std;
+
+static bool near(distance_type a, double b, double tolerance) {
+    return fabs((double)a - b) <= tolerance;
+}
+
+void TestIntegrateArcStraight() {
+    const Pose2D start = {1, 2, (distance_type)(PI / 2)};
+    const Pose2D pose = integrateArc(start, 10, 10, WHEELBASE);
+    if(!near(pose.x, 1, 0.0001) || !near(pose.y, 12, 0.0001) || !near(pose.angle, PI / 2, 0.0001)) {
+        testError("integrateArc: straight move ended at (%f, %f, %f)", (double)pose.x, (double)pose.y, (double)pose.angle);
+    }
+
+    // a tiny turn takes the straight line fallback and stays finite
+    const Pose2D nudged = integrateArc(start, 10, 10.0001, WHEELBASE);
+    if(!isfinite((double)nudged.x) || !near(nudged.y, 12, 0.001)) {
+        testError("integrateArc: nearly straight move ended at (%f, %f)", (double)nudged.x, (double)nudged.y);
+    }
+}
+
+void TestIntegrateArcQuarterCircle() {
+    //
+    // left wheel still, right wheel drives a quarter circle
+    // about the left wheel, in one update; the center
+    // moves along a quarter circle of radius wheelBase / 2.
+    //
+    const distance_type r = WHEELBASE / 2;
+    const Pose2D start = {0, 0, 0};
+    const Pose2D pose = integrateArc(start, 0, (distance_type)(PI / 2) * WHEELBASE, WHEELBASE);
+    if(!near(pose.x, (double)r, 0.001) || !near(pose.y, (double)r, 0.001) || !near(pose.angle, PI / 2, 0.0001)) {
+        testError("integrateArc: quarter circle ended at (%f, %f, %f), should be (%f, %f, %f)", (double)pose.x, (double)pose.y, (double)pose.angle, (double)r, (double)r, PI / 2);
+    }
+
+    // spinning in place turns without moving
+    const Pose2D spun = integrateArc(start, -5, 5, WHEELBASE);
+    if(!near(spun.x, 0, 0.0001) || !near(spun.y, 0, 0.0001) || !near(spun.angle, 10 / (double)WHEELBASE, 0.0001)) {
+        testError("integrateArc: spin moved to (%f, %f, %f)", (double)spun.x, (double)spun.y, (double)spun.angle);
+    }
+}
+
+void TestOdometryUpdatesEveryBatch() {
+    Odometry odometry(WHEELBASE);
+    odometry.setWheels(WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION);
+
+    EncoderSample sample = {1000, 0, 0, 0, 0};
+    odometry.update(sample);
+
+    // a single tick updates the pose; it is not held back for POSE_MIN_ENCODER_COUNT
+    sample = {1020, 1, 1, 1, 1};
+    if(!odometry.update(sample) || (odometry.pose().x <= 0)) {
+        testError("Odometry: one tick should update the pose%s", "");
+    }
+
+    // no ticks, no update
+    sample.ms = 1040;
+    if(odometry.update(sample)) {
+        testError("Odometry: should not update without ticks%s", "");
+    }
+}
+
+//
+// deterministic noise for monte carlo runs
+//
+static unsigned long noiseState = 12345;
+static double uniformNoise() {
+    noiseState = noiseState * 1103515245UL + 12345UL;
+    return ((noiseState >> 8) & 0xFFFF) / 65536.0 + 1.0 / 131072.0;
+}
+static double gaussianNoise() {
+    return sqrt(-2 * log(uniformNoise())) * cos(2 * PI * uniformNoise());
+}
+
+void TestCovarianceStartsAtZeroAndGrows() {
+    Odometry odometry(WHEELBASE);
+    odometry.setWheels(WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION);
+
+    EncoderSample sample = {1000, 0, 0, 0, 0};
+    odometry.update(sample);
+    PoseCovariance covariance = odometry.covariance();
+    for(int i = 0; i < 3; i += 1) {
+        for(int j = 0; j < 3; j += 1) {
+            if(0 != covariance(i, j)) {
+                testError("Odometry: covariance should start at zero, (%d, %d) is %f", i, j, (double)covariance(i, j));
+            }
+        }
+    }
+
+    //
+    // driving straight along x; uncertainty grows
+    // along the path, and across it as the
+    // uncertain heading swings the rover sideways.
+    //
+    distance_type lastXX = 0;
+    distance_type lastYY = 0;
+    for(int i = 1; i <= 20; i += 1) {
+        sample = {(unsigned long)(1000 + 20 * i), 2 * i, 2 * i, 2 * i, 2 * i};
+        odometry.update(sample);
+        covariance = odometry.covariance();
+        if((covariance(0, 0) <= lastXX) || (covariance(1, 1) <= lastYY)) {
+        testError("Odometry: covariance should grow while driving, xx %f, yy %f", (double)covariance(0, 0), (double)covariance(1, 1));
+            break;
+        }
+        lastXX = covariance(0, 0);
+        lastYY = covariance(1, 1);
+    }
+    for(int i = 0; i < 3; i += 1) {
+        for(int j = 0; j < i; j += 1) {
+            if(fabs((double)(covariance(i, j) - covariance(j, i))) > 1e-6) {
+                testError("Odometry: covariance should be symmetric, (%d, %d) is %f, (%d, %d) is %f", i, j, (double)covariance(i, j), j, i, (double)covariance(j, i));
+            }
+        }
+    }
+
+    // reset starts over with no uncertainty
+    odometry.reset();
+    odometry.update(sample);
+    if(0 != odometry.covariance()(0, 0)) {
+        testError("Odometry: reset should clear covariance%s", "");
+    }
+}
+
+/**
+ * Drive many noisy copies of an arc and compare their
+ * spread to the propagated covariance; the model should
+ * predict the spread of where the rover actually ends up.
+ */
+void TestCovarianceMatchesMonteCarlo() {
+    const distance_type slip = 0.02;
+    const distance_type stepLeft = 0.5;     // cm per step; a gentle left arc
+    const distance_type stepRight = 0.6;
+    const int STEPS = 200;
+    const int RUNS = 4000;
+
+    PoseCovariance covariance = zeroMatrix<distance_type, 3, 3>();
+    Pose2D pose = {0, 0, 0};
+    for(int step = 0; step < STEPS; step += 1) {
+        const Pose2D moved = integrateArc(pose, stepLeft, stepRight, WHEELBASE);
+        covariance = propagateCovariance(covariance, pose, moved, stepLeft, stepRight, WHEELBASE, slip, slip);
+        pose = moved;
+    }
+
+    double sumX = 0, sumY = 0, sumA = 0;
+    double sumXX = 0, sumXY = 0, sumYY = 0, sumAA = 0;
+    for(int run = 0; run < RUNS; run += 1) {
+        Pose2D noisy = {0, 0, 0};
+        double angle = 0;   // unwrapped
+        for(int step = 0; step < STEPS; step += 1) {
+            const distance_type left = stepLeft + (distance_type)(gaussianNoise() * sqrt((double)(slip * stepLeft)));
+            const distance_type right = stepRight + (distance_type)(gaussianNoise() * sqrt((double)(slip * stepRight)));
+            angle += (double)((right - left) / WHEELBASE);
+            noisy = integrateArc(noisy, left, right, WHEELBASE);
+        }
+        const double x = (double)noisy.x;
+        const double y = (double)noisy.y;
+        sumX += x;
+        sumY += y;
+        sumA += angle;
+        sumXX += x * x;
+        sumXY += x * y;
+        sumYY += y * y;
+        sumAA += angle * angle;
+    }
+    const double xx = sumXX / RUNS - (sumX / RUNS) * (sumX / RUNS);
+    const double xy = sumXY / RUNS - (sumX / RUNS) * (sumY / RUNS);
+    const double yy = sumYY / RUNS - (sumY / RUNS) * (sumY / RUNS);
+    const double aa = sumAA / RUNS - (sumA / RUNS) * (sumA / RUNS);
+
+    printf("Odometry: covariance xx %.3f, xy %.3f, yy %.3f, aa %.5f; monte carlo xx %.3f, xy %.3f, yy %.3f, aa %.5f\n",
+        (double)covariance(0, 0), (double)covariance(0, 1), (double)covariance(1, 1), (double)covariance(2, 2), xx, xy, yy, aa);
+    if((fabs((double)covariance(0, 0) - xx) > 0.15 * xx)
+        || (fabs((double)covariance(1, 1) - yy) > 0.15 * yy)
+        || (fabs((double)covariance(0, 1) - xy) > 0.15 * sqrt(xx * yy))
+        || (fabs((double)covariance(2, 2) - aa) > 0.15 * aa))
+    {
+        testError("Odometry: propagated covariance does not match monte carlo spread%s", "");
+    }
+}
+
+void TestPredictStopsWhenStale() {
+    Odometry odometry(WHEELBASE);
+    odometry.setWheels(WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION);
+
+    // drive straight ahead at a steady speed
+    EncoderSample sample = {1000, 0, 0, 0, 0};
+    odometry.update(sample);
+    for(int i = 1; i <= 10; i += 1) {
+        sample = {(unsigned long)(1000 + 100 * i), 2 * i, 2 * i, 2 * i, 2 * i};
+        odometry.update(sample);
+    }
+    const Pose2D pose = odometry.pose();
+    const distance_type speed = odometry.poseVelocity().x;
+
+    // half way to the next update it has moved half as far
+    const Pose2D predicted = odometry.predict(2050);
+    if(!near(predicted.x, (double)pose.x + (double)speed * 0.05, 0.001) || !near(predicted.y, (double)pose.y, 0.001)) {
+        testError("Odometry.predict() is (%f, %f), should be (%f, %f)", (double)predicted.x, (double)predicted.y, (double)pose.x + (double)speed * 0.05, (double)pose.y);
+    }
+
+    // without ticks for too long, the rover has stopped
+    const Pose2D stopped = odometry.predict(2000 + POSE_PREDICT_MAX_MS + 1);
+    if(!near(stopped.x, (double)pose.x, 0.0001)) {
+        testError("Odometry.predict() should hold the last pose once stale, got x = %f", (double)stopped.x);
+    }
+}
+
+/**
+ * At a low speed the pose only changes every few
+ * control ticks; steering by the predicted pose
+ * should lag the true pose less than steering by
+ * the last estimated pose.  This drives a gentle
+ * curve so the lag is not hidden by heading drift.
+ */
+void TestPredictReducesLag() {
+    FigureEight eight = figureEight(5, 1000);   // slow; a tick every ~100ms
+    Odometry odometry(eight.wheelBase);
+    odometry.setWheels(WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION);
+
+    double lastSquared = 0;
+    double predictedSquared = 0;
+    unsigned long ticks = 0;
+    const unsigned long endMs = eight.ms + 20000;
+    while(eight.ms < endMs) {
+        figureEightStep(eight);
+        if(odometry.isDue(eight.ms)) {
+            odometry.update(figureEightSample(eight));
+        }
+        if(0 == (eight.ms % GOTO_TICK_MS)) {
+            const Pose2D last = odometry.pose();
+            const Pose2D predicted = odometry.predict(eight.ms);
+            lastSquared += pow((double)last.x - eight.truth.x, 2) + pow((double)last.y - eight.truth.y, 2);
+            predictedSquared += pow((double)predicted.x - eight.truth.x, 2) + pow((double)predicted.y - eight.truth.y, 2);
+            ticks += 1;
+        }
+    }
+    const double lastRms = sqrt(lastSquared / ticks);
+    const double predictedRms = sqrt(predictedSquared / ticks);
+    printf("Odometry: at 5 cm/sec, rms position error %.2f cm predicted, %.2f cm last pose\n", predictedRms, lastRms);
+    if(predictedRms >= lastRms) {
+        testError("Odometry: predicted pose (%.2f cm) should lag less than last pose (%.2f cm)", predictedRms, lastRms);
+    }
+}
+
+/**
+ * Drive figure-eights and measure how far
+ * each estimate is from the true pose
+ */
+void TestFigureEightAccuracy() {
+    FigureEight eight = figureEight(20, 30);
+    Odometry odometry(eight.wheelBase);
+    odometry.setWheels(WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION, WHEEL_CIRCUMFERENCE, PULSES_PER_REVOLUTION);
+    MidpointOdometry midpoint;
+
+    double arcSquared = 0;
+    double midpointSquared = 0;
+    unsigned long samples = 0;
+    const unsigned long endMs = eight.ms + 10 * 2 * (unsigned long)(2000.0 * PI * eight.radius / eight.speed);
+    while(eight.ms < endMs) {
+        figureEightStep(eight);
+        if(odometry.isDue(eight.ms)) {
+            const EncoderSample sample = figureEightSample(eight);
+            odometry.update(sample);
+            midpoint.update(sample, eight.distancePerTick, eight.wheelBase);
+
+            const Pose2D arc = odometry.pose();
+            arcSquared += pow((double)arc.x - eight.truth.x, 2) + pow((double)arc.y - eight.truth.y, 2);
+            midpointSquared += pow((double)midpoint.pose.x - eight.truth.x, 2) + pow((double)midpoint.pose.y - eight.truth.y, 2);
+            samples += 1;
+        }
+    }
+    const double arcRms = sqrt(arcSquared / samples);
+    const double midpointRms = sqrt(midpointSquared / samples);
+    printf("Odometry: 10 figure-eights, rms position error %.2f cm exact arc, %.2f cm midpoint\n", arcRms, midpointRms);
+    if(arcRms >= midpointRms) {
+        testError("Odometry: exact arc (%.2f cm) should beat midpoint (%.2f cm)", arcRms, midpointRms);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ test.cpp src/rover/odometry.test.cpp ../src/rover/odometry.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+    TestIntegrateArcStraight();
+    TestIntegrateArcQuarterCircle();
+    TestOdometryUpdatesEveryBatch();
+    TestCovarianceStartsAtZeroAndGrows();
+    TestCovarianceMatchesMonteCarlo();
+    TestPredictStopsWhenStale();
+    TestPredictReducesLag();
+    TestFigureEightAccuracy();
+
+    return testResults("odometry");
+}
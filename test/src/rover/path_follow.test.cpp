@@ -0,0 +1,205 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "../../test.h"
+#include "../../replay/rover_replay.h"
+#include "../../../src/rover/goto_goal.h"
+#include "../../../src/rover/path_follow.h"
+#include "simulated_wheel.h"
+
+//
+// a lap of a block, with the corners cut, as
+// a path recorded while driving would be
+//
+static const distance_type waypoints[][2] = {
+    {40, 0},
+    {80, 0},
+    {100, 20},
+    {100, 50},
+    {100, 80},
+    {80, 100},
+    {50, 100},
+    {20, 100},
+    {0, 80},
+    {0, 40},
+    {0, 0},
+};
+static const unsigned int waypointCount = sizeof(waypoints) / sizeof(waypoints[0]);
+
+/**
+ * Closed loop simulation of a rover with mismatched motors
+ */
+typedef struct Simulation {
+    RoverReplay replay;
+    SimulatedWheel left;
+    SimulatedWheel right;
+    unsigned long ms;
+    distance_type worstOffPath;  // furthest the rover got from the waypoint segments
+
+    Simulation()
+        : replay(WHEELBASE, CIRCUMFERENCE, PULSES, CIRCUMFERENCE, PULSES),
+          left({0.33f, 0, 0, 0, CIRCUMFERENCE / PULSES}),
+          right({0.30f, 3, 0, 0, CIRCUMFERENCE / PULSES}),
+          ms(1000),
+          worstOffPath(0)
+    {
+        TwoWheelRover &rover = replay.rover();
+        rover.setAccelerationLimits(ALL_WHEELS, WHEEL_MAX_ACCELERATION, WHEEL_MAX_JERK, WHEEL_MAX_PWM_RATE, WHEEL_MAX_PWM_JERK);
+        rover.setMotorStall(SimulatedWheel::WHEEL_STALL_PWM / 255.0f, SimulatedWheel::WHEEL_STALL_PWM / 255.0f);
+        rover.setSpeedControl(ALL_WHEELS, 10, 50, 1, 0, 0);
+        replay.drive(ms, 0, 0);
+    }
+
+    void step() {
+        left.step(replay.leftWheel(), ms, STEP_MS / 1000.0f);
+        right.step(replay.rightWheel(), ms, STEP_MS / 1000.0f);
+        replay.drive(ms + STEP_MS, left.count(), right.count());
+        ms += STEP_MS;
+
+        // distance from the nearest segment of the path
+        const Pose2D pose = replay.rover().pose();
+        distance_type nearest = -1;
+        for(unsigned int i = 0; i < waypointCount; i += 1) {
+            const distance_type ax = (i > 0) ? waypoints[i - 1][0] : 0;
+            const distance_type ay = (i > 0) ? waypoints[i - 1][1] : 0;
+            const distance_type sx = waypoints[i][0] - ax;
+            const distance_type sy = waypoints[i][1] - ay;
+            const distance_type t = bound<distance_type>(((pose.x - ax) * sx + (pose.y - ay) * sy) / (sx * sx + sy * sy), 0, 1);
+            const distance_type d = HYPOT(ax + t * sx - pose.x, ay + t * sy - pose.y);
+            if((nearest < 0) || (d < nearest)) {
+                nearest = d;
+            }
+        }
+        if(nearest > worstOffPath) {
+            worstOffPath = nearest;
+        }
+    }
+
+    static constexpr distance_type CIRCUMFERENCE = 20;
+    static const int PULSES = 40;
+    static const unsigned long STEP_MS = 5;
+    static const unsigned long TIMEOUT_MS = 120000;
+} Simulation;
+constexpr distance_type Simulation::CIRCUMFERENCE;    // passed by reference, so needs a definition
+
+/**
+ * Drive the waypoints by chaining goto goal commands,
+ * each of which stops at it's goal.
+ */
+static bool chainGotoGoals(
+    unsigned long &timeMs,      // OUT: time to reach last waypoint
+    distance_type &offPath)     // OUT: furthest from the path
+                                // RET: true if all waypoints achieved
+{
+    Simulation sim;
+    GotoGoalBehavior behavior;
+    behavior.attach(sim.replay.rover(), sim.replay.messageBus());
+    behavior.setTickPolicy(GOTO_TICK_FIXED_RATE, GOTO_TICK_MS);
+
+    const unsigned long startMs = sim.ms;
+    for(unsigned int i = 0; i < waypointCount; i += 1) {
+        behavior.gotoGoal(waypoints[i][0], waypoints[i][1], 0.75, 0.1);
+        while((NOT_RUNNING != behavior.state()) && (sim.ms < startMs + Simulation::TIMEOUT_MS)) {
+            behavior.poll(sim.ms);
+            sim.step();
+        }
+    }
+    const bool achieved = (NOT_RUNNING == behavior.state());
+    behavior.cancel();
+
+    timeMs = sim.ms - startMs;
+    offPath = sim.worstOffPath;
+    return achieved;
+}
+
+/**
+ * Drive the waypoints as one path with pure pursuit
+ */
+static bool followPath(
+    unsigned long &timeMs,      // OUT: time to reach last waypoint
+    distance_type &pathLength,  // OUT: distance driven
+    distance_type &offPath,     // OUT: furthest from the path
+    distance_type &miss)        // OUT: distance from last waypoint when stopped
+                                // RET: true if path achieved
+{
+    Simulation sim;
+    PathFollowBehavior behavior;
+    behavior.attach(sim.replay.rover(), sim.replay.messageBus());
+    for(unsigned int i = 0; i < waypointCount; i += 1) {
+        if(SUCCESS != behavior.addWaypoint(i, waypoints[i][0], waypoints[i][1])) {
+            testError("PathFollow: failed to add waypoint %d", i);
+        }
+    }
+
+    behavior.followPath(PATH_LOOKAHEAD, 0);
+    const unsigned long startMs = sim.ms;
+    while((NOT_RUNNING != behavior.state()) && (sim.ms < startMs + Simulation::TIMEOUT_MS)) {
+        behavior.poll(sim.ms);
+        sim.step();
+    }
+    const bool achieved = (NOT_RUNNING == behavior.state());
+    timeMs = behavior.timeToGoalMs();
+    pathLength = behavior.pathLength();
+    behavior.cancel();
+
+    const Pose2D pose = sim.replay.rover().pose();
+    const distance_type *last = waypoints[waypointCount - 1];
+    offPath = sim.worstOffPath;
+    miss = HYPOT(last[0] - pose.x, last[1] - pose.y);
+    return achieved;
+}
+
+void TestWaypoints() {
+    PathFollowBehavior behavior;
+    if(SUCCESS == behavior.addWaypoint(1, 0, 0)) {
+        testError("PathFollow: waypoint %d added out of order", 1);
+    }
+    for(unsigned int i = 0; i < PATH_MAX_WAYPOINTS; i += 1) {
+        if(SUCCESS != behavior.addWaypoint(i, i, i)) {
+            testError("PathFollow: failed to add waypoint %d", i);
+        }
+    }
+    if(SUCCESS == behavior.addWaypoint(PATH_MAX_WAYPOINTS, 0, 0)) {
+        testError("PathFollow: added more than %d waypoints", PATH_MAX_WAYPOINTS);
+    }
+
+    // index zero starts over
+    if((SUCCESS != behavior.addWaypoint(0, 0, 0)) || (1 != behavior.pendingCount())) {
+        testError("PathFollow: expected 1 waypoint after restart, got %d", behavior.pendingCount());
+    }
+}
+
+void TestPathIsFasterThanChainedGoals() {
+    unsigned long chainMs, pathMs;
+    distance_type chainOffPath, pathOffPath;
+    distance_type pathLength, miss;
+    const bool chainAchieved = chainGotoGoals(chainMs, chainOffPath);
+    const bool pathAchieved = followPath(pathMs, pathLength, pathOffPath, miss);
+    printf("PathFollow: %d waypoints; chained goto goals %s %.2f sec, worst off path %.1f cm; pure pursuit %s %.2f sec, path %.1f cm, worst off path %.1f cm, miss %.1f cm\n",
+        waypointCount,
+        chainAchieved ? "achieved in" : "gave up after", chainMs / 1000.0f, (float)chainOffPath,
+        pathAchieved ? "achieved in" : "gave up after", pathMs / 1000.0f, (float)pathLength, (float)pathOffPath, (float)miss);
+
+    if(!pathAchieved) {
+        testError("PathFollow: did not reach last waypoint, stopped %f cm away", (float)miss);
+    }
+    if(miss > 10) {
+        testError("PathFollow: stopped %f cm from last waypoint", (float)miss);
+    }
+    if(pathOffPath > PATH_LOOKAHEAD) {
+        testError("PathFollow: strayed %f cm from the path", (float)pathOffPath);
+    }
+    if(pathMs * 3 > chainMs * 2) {
+        testError("PathFollow: expected at most 2/3 the time of chained goals, got %lu vs %lu ms", pathMs, chainMs);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/path_follow.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/path_follow.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+    TestWaypoints();
+    TestPathIsFasterThanChainedGoals();
+
+    return testResults("path_follow");
+}
@@ -0,0 +1,151 @@
+#include <math.h>
+#include <atomic>
+#include <thread>
+
+#include "../../test.h"
+#include "../../../src/rover/pose_history.h"
+
+using namespace std;
+
+static bool near(distance_type a, double b, double tolerance) {
+    return fabs((double)a - b) <= tolerance;
+}
+
+void TestPoseAtInterpolates() {
+    PoseHistory history;
+    Pose2D pose = {0, 0, 0};
+    if(history.poseAt(100, pose)) {
+        testError("PoseHistory.poseAt() found a pose in an empty history%s", "");
+    }
+
+    history.append(100, {0, 0, 0});
+    history.append(120, {10, 20, 1});
+
+    // exactly on a sample
+    if(!history.poseAt(100, pose) || !near(pose.x, 0, 0.0001)) {
+        testError("PoseHistory.poseAt(100) should be first sample, got x = %f", (double)pose.x);
+    }
+    if(!history.poseAt(120, pose) || !near(pose.x, 10, 0.0001)) {
+        testError("PoseHistory.poseAt(120) should be last sample, got x = %f", (double)pose.x);
+    }
+
+    // between samples
+    if(!history.poseAt(105, pose) || !near(pose.x, 2.5, 0.0001) || !near(pose.y, 5, 0.0001) || !near(pose.angle, 0.25, 0.0001)) {
+        testError("PoseHistory.poseAt(105) is (%f, %f, %f), should be (2.5, 5, 0.25)", (double)pose.x, (double)pose.y, (double)pose.angle);
+    }
+
+    // outside the history
+    if(history.poseAt(99, pose)) {
+        testError("PoseHistory.poseAt() should not find a time before the history%s", "");
+    }
+    if(history.poseAt(121, pose)) {
+        testError("PoseHistory.poseAt() should not find a time after the history%s", "");
+    }
+
+    // once encoders are read without moving, the newest pose holds
+    history.hold(160);
+    if(!history.poseAt(150, pose) || !near(pose.x, 10, 0.0001)) {
+        testError("PoseHistory.poseAt() should hold the newest pose, got x = %f", (double)pose.x);
+    }
+    if(history.poseAt(161, pose)) {
+        testError("PoseHistory.poseAt() should not find a time after the hold%s", "");
+    }
+
+    history.clear();
+    if(history.poseAt(110, pose) || (0 != history.count())) {
+        testError("PoseHistory.clear() should forget samples%s", "");
+    }
+}
+
+void TestPoseAtTurnsShortWay() {
+    //
+    // turning left from just under PI to
+    // just over -PI passes through PI, not zero
+    //
+    PoseHistory history;
+    history.append(0, {0, 0, (distance_type)(PI - 0.1)});
+    history.append(10, {0, 0, (distance_type)(-PI + 0.1)});
+    Pose2D pose;
+    if(!history.poseAt(5, pose) || !near(ABS(pose.angle), PI, 0.0001)) {
+        testError("PoseHistory.poseAt() should turn through PI, got %f", (double)pose.angle);
+    }
+}
+
+void TestPoseAtAfterWrap() {
+    PoseHistory history;
+    for(unsigned long i = 0; i < 3 * POSE_HISTORY_COUNT; i += 1) {
+        history.append(1000 + 20 * i, {(distance_type)i, 0, 0});
+    }
+    if(POSE_HISTORY_COUNT != history.count()) {
+        testError("PoseHistory.count() should be %d, got %d", POSE_HISTORY_COUNT, history.count());
+    }
+
+    // overwritten samples are gone, kept ones interpolate
+    const unsigned long oldest = 1000 + 20 * 2 * POSE_HISTORY_COUNT;
+    Pose2D pose;
+    if(history.poseAt(oldest - 10, pose)) {
+        testError("PoseHistory.poseAt() found an overwritten time%s", "");
+    }
+    if(!history.poseAt(oldest + 30, pose) || !near(pose.x, 2 * POSE_HISTORY_COUNT + 1.5, 0.0001)) {
+        testError("PoseHistory.poseAt() after wrap got x = %f", (double)pose.x);
+    }
+}
+
+/**
+ * Look up poses on one thread while another
+ * appends; every pose found must be consistent
+ * with the time it was asked for, so a sample
+ * torn by a concurrent append is never returned.
+ */
+void TestPoseAtWhileAppending() {
+    static PoseHistory history;
+    const unsigned long COUNT = 2000000;
+    atomic<unsigned long> newestMs(0);
+    atomic<bool> done(false);
+
+    history.append(0, {0, 0, 0});
+    thread writer([&]() {
+        for(unsigned long ms = 1; ms <= COUNT; ms += 1) {
+            // x and y both track time, so a torn pose is detectable;
+            // wrapped to stay within range of fixed point distances
+            history.append(ms, {(distance_type)(ms % 16384), -(distance_type)(ms % 16384), 0});
+            newestMs.store(ms, memory_order_release);
+        }
+        done.store(true, memory_order_release);
+    });
+
+    unsigned long found = 0;
+    unsigned long bad = 0;
+    while(!done.load(memory_order_acquire)) {
+        const unsigned long newest = newestMs.load(memory_order_acquire);
+        const unsigned long ms = (newest > POSE_HISTORY_COUNT / 2) ? newest - POSE_HISTORY_COUNT / 2 : 0;
+        Pose2D pose;
+        if(history.poseAt(ms, pose)) {
+            found += 1;
+            // floats hold integers exactly up to 2^24
+            if((pose.x != (distance_type)(ms % 16384)) || (pose.y != -(distance_type)(ms % 16384))) {
+                bad += 1;
+            }
+        }
+    }
+    writer.join();
+
+    if(0 != bad) {
+        testError("PoseHistory.poseAt() returned %lu torn poses", bad);
+    }
+    if(0 == found) {
+        testError("PoseHistory.poseAt() found nothing while appending%s", "");
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -pthread -lstdc++ test.cpp src/rover/pose_history.test.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp -lm; ./a.out; rm a.out
+
+    TestPoseAtInterpolates();
+    TestPoseAtTurnsShortWay();
+    TestPoseAtAfterWrap();
+    TestPoseAtWhileAppending();
+
+    return testResults("pose_history");
+}
@@ -70,10 +70,10 @@ void TestParseCommand() {
         testError("parseTankCommand: index is wrong after parsing: %d != %d", len(command), cmd.index);
     }
     if( (123 != cmd.id)
-        || (true != cmd.tank.left.forward) 
-        || (255 != cmd.tank.left.value)
-        || (false != cmd.tank.right.forward)
-        || (0 != cmd.tank.right.value)) 
+        || (true != cmd.command.tank.left.forward) 
+        || (255 != cmd.command.tank.left.value)
+        || (false != cmd.command.tank.right.forward)
+        || (0 != cmd.command.tank.right.value)) 
     {
         testError("parseTankCommand: value is wrong after parsing", "");
     }
@@ -87,22 +87,280 @@ void TestParseCommand() {
         testError("parseTankCommand: index is wrong after parsing: %d != %d", len(command), cmd.index);
     }
     if( (0 != cmd.id)
-        || (true != cmd.tank.left.forward) 
-        || (0 != cmd.tank.left.value)
-        || (true != cmd.tank.right.forward)
-        || (0 != cmd.tank.right.value)) 
+        || (true != cmd.command.tank.left.forward) 
+        || (0 != cmd.command.tank.left.value)
+        || (true != cmd.command.tank.right.forward)
+        || (0 != cmd.command.tank.right.value)) 
     {
         testError("parseTankCommand: value is wrong after parsing", "");
     }
 
 }
 
+void TestParseFormatCommand() {
+    String command = "cmd(7, format(binary, delta))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parseFormatCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((7 != cmd.id) || (TELEMETRY_FORMAT != cmd.command.type) 
+        || (true != cmd.command.format.binary) || (true != cmd.command.format.delta)) 
+    {
+        testError("parseFormatCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+
+    command = "cmd(8, format( text ))";
+    cmd = parseCommand(command, 0);
+    if(!cmd.matched || (TELEMETRY_FORMAT != cmd.command.type) 
+        || (false != cmd.command.format.binary) || (false != cmd.command.format.delta)) 
+    {
+        testError("parseFormatCommand: Failed to parse command: '%s'", cstr(command));
+    }
+
+    // unknown format is rejected
+    command = "cmd(9, format(json))";
+    cmd = parseCommand(command, 0);
+    if(cmd.matched) {
+        testError("parseFormatCommand: should not parse command: '%s'", cstr(command));
+    }
+}
+
+void TestParseTelemetryCommand() {
+    String command = "cmd(10, telemetry(pose, 100))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parseTelemetryCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((TELEMETRY_RATE != cmd.command.type) 
+        || (TELEMETRY_POSE != cmd.command.telemetry.channel) || (100 != cmd.command.telemetry.periodMs)) 
+    {
+        testError("parseTelemetryCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+
+    // zero turns a channel off
+    command = "cmd(11, telemetry( log , 0 ))";
+    cmd = parseCommand(command, 0);
+    if(!cmd.matched || (TELEMETRY_LOG != cmd.command.telemetry.channel) || (TELEMETRY_PERIOD_OFF != cmd.command.telemetry.periodMs)) {
+        testError("parseTelemetryCommand: Failed to parse command: '%s'", cstr(command));
+    }
+
+    // unknown channel or missing period is rejected
+    command = "cmd(12, telemetry(camera, 100))";
+    if(parseCommand(command, 0).matched) {
+        testError("parseTelemetryCommand: should not parse command: '%s'", cstr(command));
+    }
+    command = "cmd(13, telemetry(wheel))";
+    if(parseCommand(command, 0).matched) {
+        testError("parseTelemetryCommand: should not parse command: '%s'", cstr(command));
+    }
+}
+
+void TestParseKeyframeCommand() {
+    String command = "cmd(14, keyframe(wheel))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parseKeyframeCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((TELEMETRY_KEYFRAME != cmd.command.type) || (TELEMETRY_WHEEL != cmd.command.telemetry.channel)) {
+        testError("parseKeyframeCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+
+    command = "cmd(15, keyframe(speed))";
+    if(parseCommand(command, 0).matched) {
+        testError("parseKeyframeCommand: should not parse command: '%s'", cstr(command));
+    }
+}
+
+void TestParseHistoryCommand() {
+    String command = "cmd(16, history(123456, pose))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parseHistoryCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((TELEMETRY_HISTORY != cmd.command.type) 
+        || (TELEMETRY_POSE != cmd.command.history.channel) || (123456UL != cmd.command.history.sinceMs)) 
+    {
+        testError("parseHistoryCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+
+    // rover time after about 25 days does not fit in an int
+    command = "cmd(17, history(4000000000, wheel))";
+    cmd = parseCommand(command, 0);
+    if(!cmd.matched || (TELEMETRY_WHEEL != cmd.command.history.channel) || (4000000000UL != cmd.command.history.sinceMs)) {
+        testError("parseHistoryCommand: Failed to parse command: '%s', sinceMs %lu", cstr(command), cmd.command.history.sinceMs);
+    }
+
+    // only wheel and pose are recorded
+    const char *unrecorded[] = {"goto", "set", "log"};
+    for(const char *channel : unrecorded) {
+        command = String("cmd(18, history(0, ") + String(channel) + String("))");
+        if(parseCommand(command, 0).matched) {
+            testError("parseHistoryCommand: should not parse command: '%s'", cstr(command));
+        }
+    }
+}
+
+void TestParseTwistCommand() {
+    String command = "cmd(19, twist(20.5, -0.25))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parseTwistCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((TWIST != cmd.command.type) || (20.5f != cmd.command.twist.linear) || (-0.25f != cmd.command.twist.angular)) {
+        testError("parseTwistCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+
+    // reverse and spin in place
+    command = "cmd(20, twist(-10, 0))";
+    cmd = parseCommand(command, 0);
+    if(!cmd.matched || (-10.0f != cmd.command.twist.linear) || (0.0f != cmd.command.twist.angular)) {
+        testError("parseTwistCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    command = "cmd(21, twist(0, 1.5))";
+    cmd = parseCommand(command, 0);
+    if(!cmd.matched || (0.0f != cmd.command.twist.linear) || (1.5f != cmd.command.twist.angular)) {
+        testError("parseTwistCommand: Failed to parse command: '%s'", cstr(command));
+    }
+
+    // both velocities are required
+    const char *bad[] = {"cmd(22, twist(10))", "cmd(23, twist())", "cmd(24, twist(10, ))"};
+    for(const char *text : bad) {
+        command = String(text);
+        if(parseCommand(command, 0).matched) {
+            testError("parseTwistCommand: should not parse command: '%s'", cstr(command));
+        }
+    }
+}
+
+void TestParseSyncCommand() {
+    String command = "cmd(25, sync(0.5, 0.125))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parseSyncCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((SYNC != cmd.command.type) || (0.5f != cmd.command.sync.Kp) || (0.125f != cmd.command.sync.Ki)) {
+        testError("parseSyncCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+
+    // zero gains turn it off; negative gains are not allowed
+    command = "cmd(26, sync(0, 0))";
+    cmd = parseCommand(command, 0);
+    if(!cmd.matched || (0 != cmd.command.sync.Kp) || (0 != cmd.command.sync.Ki)) {
+        testError("parseSyncCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    command = "cmd(27, sync(-1, 0))";
+    if(parseCommand(command, 0).matched) {
+        testError("parseSyncCommand: should not parse command: '%s'", cstr(command));
+    }
+}
+
+void TestParseWaypointCommand() {
+    String command = "cmd(28, waypoint(3, 48.5, -104))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parseWaypointCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((WAYPOINT != cmd.command.type) || (3 != cmd.command.waypoint.index) 
+        || (48.5f != cmd.command.waypoint.x) || (-104.0f != cmd.command.waypoint.y)) 
+    {
+        testError("parseWaypointCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+
+    // index can't be negative and both coordinates are required
+    const char *bad[] = {"cmd(29, waypoint(-1, 0, 0))", "cmd(30, waypoint(0, 10))", "cmd(31, waypoint(10, 10))"};
+    for(const char *text : bad) {
+        command = String(text);
+        if(parseCommand(command, 0).matched) {
+            testError("parseWaypointCommand: should not parse command: '%s'", cstr(command));
+        }
+    }
+}
+
+void TestParsePathCommand() {
+    String command = "cmd(32, path(20, 2.5))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parsePathCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((PATH != cmd.command.type) || (20.0f != cmd.command.path.lookahead) || (2.5f != cmd.command.path.tolerance)) {
+        testError("parsePathCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+    command = "cmd(33, path(-20, 2.5))";
+    if(parseCommand(command, 0).matched) {
+        testError("parsePathCommand: should not parse command: '%s'", cstr(command));
+    }
+}
+
+void TestParseRecordCommand() {
+    String command = "cmd(34, record(true))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parseRecordCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((RECORD != cmd.command.type) || !cmd.command.record.on) {
+        testError("parseRecordCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+    command = "cmd(35, record(false))";
+    cmd = parseCommand(command, 0);
+    if(!cmd.matched || (RECORD != cmd.command.type) || cmd.command.record.on) {
+        testError("parseRecordCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+    command = "cmd(36, record())";
+    if(parseCommand(command, 0).matched) {
+        testError("parseRecordCommand: should not parse command: '%s'", cstr(command));
+    }
+}
+
+void TestParsePlayCommand() {
+    String command = "cmd(37, play(15, 2))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parsePlayCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((PLAY != cmd.command.type) || (15.0f != cmd.command.path.lookahead) || (2.0f != cmd.command.path.tolerance)) {
+        testError("parsePlayCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+    command = "cmd(38, play(15))";
+    if(parseCommand(command, 0).matched) {
+        testError("parsePlayCommand: should not parse command: '%s'", cstr(command));
+    }
+}
+
+void TestParsePlanCommand() {
+    String command = "cmd(39, plan(-120.5, 80, 0.1, 0.75))";
+    ParseCommandResult cmd = parseCommand(command, 0);
+    if(!cmd.matched || (len(command) != cmd.index)) {
+        testError("parsePlanCommand: Failed to parse command: '%s'", cstr(command));
+    }
+    if((PLAN != cmd.command.type) || (-120.5f != cmd.command.go2.x) || (80.0f != cmd.command.go2.y)
+        || (0.1f != cmd.command.go2.tolerance) || (0.75f != cmd.command.go2.pointForward))
+    {
+        testError("parsePlanCommand: value is wrong after parsing '%s'", cstr(command));
+    }
+    command = "cmd(40, plan(10, 20))";
+    if(parseCommand(command, 0).matched) {
+        testError("parsePlanCommand: should not parse command: '%s'", cstr(command));
+    }
+}
+
 int main() {
     // from test folder run: 
-    // gcc -std=c++11 -Wc++11-extensions -lstdc++ test.cpp src/rover/rover_parse.test.cpp ../src/parse/*.cpp; ./a.out; rm a.out
+    // gcc -DTESTING -std=c++11 -lstdc++ -Ireplay -include Arduino.h test.cpp src/rover/rover_parse.test.cpp ../src/rover/rover_parse.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp ../src/parse/*.cpp; ./a.out; rm a.out
 
     TestParseWheelCommand();
     TestParseTankCommand();
+    TestParseCommand();
+    TestParseFormatCommand();
+    TestParseTelemetryCommand();
+    TestParseKeyframeCommand();
+    TestParseHistoryCommand();
+    TestParseTwistCommand();
+    TestParseSyncCommand();
+    TestParseWaypointCommand();
+    TestParsePathCommand();
+    TestParseRecordCommand();
+    TestParsePlayCommand();
+    TestParsePlanCommand();
 
     return testResults("rover_parse");
 }
@@ -0,0 +1,35 @@
+#ifndef TEST_SIMULATED_WHEEL_H
+#define TEST_SIMULATED_WHEEL_H
+
+#include <math.h>
+
+#include "../../replay/rover_replay.h"
+
+/**
+ * First order model of a motor and wheel, with
+ * an encoder that counts distance travelled.
+ * Step it with the pwm the rover sends the wheel
+ * and feed it's count back to RoverReplay::drive()
+ * to simulate closed loop control.
+ */
+typedef struct SimulatedWheel {
+    float gain;         // cm/sec per pwm above stall
+    float drag;         // cm/sec lost to a load that comes and goes
+    float speed;        // cm/sec
+    float distance;     // cm
+    distance_type cmPerCount;
+
+    void step(DriveWheel &wheel, unsigned long ms, float seconds) {
+        const int pwm = (int)wheel.pwm() - (int)MOTOR_STALL_PWM;
+        const float load = drag * (1 + sinf(ms * 2 * (float)PI / 5000)) / 2;
+        const float steady = (pwm > 0) ? (gain * pwm - load) * (wheel.forward() ? 1 : -1) : 0;
+        speed += (steady - speed) * seconds / 0.1f;
+        distance += speed * seconds;
+    }
+    encoder_count_type count() { return (encoder_count_type)floorf(distance / (float)cmPerCount); }
+
+    static const pwm_type MOTOR_STALL_PWM = 60;    // pwm below which the motor stops
+    static const pwm_type WHEEL_STALL_PWM = 80;    // pwm the wheel is calibrated to start at
+} SimulatedWheel;
+
+#endif // TEST_SIMULATED_WHEEL_H
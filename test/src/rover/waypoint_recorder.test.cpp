@@ -0,0 +1,267 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "../../test.h"
+#include "../../replay/rover_replay.h"
+#include "../../../src/rover/path_follow.h"
+#include "../../../src/rover/waypoint_recorder.h"
+#include "simulated_wheel.h"
+
+static Point2D recorded[WAYPOINT_RECORDER_COUNT];
+
+/**
+ * Distance from a point to the recorded path,
+ * measured in double so it is exact in fixed point builds too
+ */
+static distance_type distanceToPath(
+    const Point2D &point,   // IN : point to measure
+    const Point2D *path,    // IN : waypoints
+    unsigned int count)     // IN : number of waypoints
+                            // RET: distance to nearest segment
+{
+    const double x = (double)point.x;
+    const double y = (double)point.y;
+    double nearest = hypot(x - (double)path[0].x, y - (double)path[0].y);
+    for(unsigned int i = 1; i < count; i += 1) {
+        const double ax = (double)path[i - 1].x;
+        const double ay = (double)path[i - 1].y;
+        const double sx = (double)path[i].x - ax;
+        const double sy = (double)path[i].y - ay;
+        const double lengthSquared = sx * sx + sy * sy;
+        const double t = (lengthSquared > 0)
+            ? bound<double>(((x - ax) * sx + (y - ay) * sy) / lengthSquared, 0, 1)
+            : 0;
+        const double d = hypot(ax + t * sx - x, ay + t * sy - y);
+        if(d < nearest) {
+            nearest = d;
+        }
+    }
+    return (distance_type)nearest;
+}
+
+/**
+ * A recorder that is recording, without a rover
+ */
+typedef struct Recording {
+    RoverReplay replay;
+    WaypointRecorder recorder;
+
+    Recording()
+        : replay(13.5, 20, 40, 20, 40)
+    {
+        recorder.attach(replay.rover(), replay.messageBus()).startRecording();
+    }
+} Recording;
+
+void TestStraightLine() {
+    Recording recording;
+    WaypointRecorder &recorder = recording.recorder;
+    for(int x = 1; x <= 300; x += 1) {
+        recorder.record(x, 0);
+    }
+    recorder.stopRecording();
+    const unsigned int count = recorder.waypoints(recorded, WAYPOINT_RECORDER_COUNT);
+    if((2 != count) || (0 != recorded[0].x) || (300 != recorded[1].x) || (0 != recorded[1].y)) {
+        testError("WaypointRecorder: expected straight line as 2 waypoints, got %d", count);
+    }
+
+    // poses that barely move are ignored, and recording stops
+    recorder.startRecording();
+    for(int i = 0; i < 100; i += 1) {
+        recorder.record(0.01f * i, 0);
+    }
+    recorder.stopRecording();
+    recorder.record(100, 100);
+    if(1 != recorder.count()) {
+        testError("WaypointRecorder: expected 1 waypoint when stopped, got %d", recorder.count());
+    }
+}
+
+void TestCurveStaysWithinTolerance() {
+    //
+    // a slalom, sampled every cm or so, like poses
+    // recorded at 20 cm/sec and 20 poses per second
+    //
+    Recording recording;
+    WaypointRecorder &recorder = recording.recorder;
+    unsigned int samples = 0;
+    for(distance_type x = 0.25f; x <= 500; x += 1.25f, samples += 1) {
+        recorder.record(x, 30 * SIN(x / 40));
+    }
+    recorder.stopRecording();
+    const unsigned int count = recorder.waypoints(recorded, WAYPOINT_RECORDER_COUNT);
+    distance_type worst = 0;
+    for(distance_type x = 0.25f; x <= 500; x += 1.25f) {
+        const Point2D sample = {x, 30 * SIN(x / 40)};
+        worst = max<distance_type>(worst, distanceToPath(sample, recorded, count));
+    }
+    printf("WaypointRecorder: slalom of %d poses kept as %d waypoints, %d bytes, worst error %.2f cm\n",
+        samples, count, (int)(count * sizeof(WaypointDelta)), (float)worst);
+
+    if(count * 10 > samples) {
+        testError("WaypointRecorder: expected less than a tenth of %d poses, got %d", samples, count);
+    }
+    if(worst > WAYPOINT_TOLERANCE + 0.125f) {
+        testError("WaypointRecorder: path strayed %f cm from the poses", (float)worst);
+    }
+    if((recorder.tolerance() != WAYPOINT_TOLERANCE) || (count > WAYPOINT_RECORDER_COUNT)) {
+        testError("WaypointRecorder: tolerance should not change for a short drive, got %f", (float)recorder.tolerance());
+    }
+}
+
+/**
+ * A long drive that weaves left and right
+ */
+static Point2D weave(unsigned int i) {   // IN : pose number, about 1 cm apart
+                                        // RET: position of pose
+    return {(distance_type)i, 50 * sinf(i / 80.0f)};
+}
+
+void TestLongDriveIsBounded() {
+    //
+    // a 300 meter drive would keep more waypoints
+    // than fit, so it is simplified more coarsely, but
+    // every pose stays within twice the final
+    // tolerance of the recorded path.  It is kept
+    // within the ±327 meters of fixed point distances.
+    //
+    Recording recording;
+    WaypointRecorder &recorder = recording.recorder;
+    const unsigned int samples = 30000;
+    for(unsigned int i = 1; i < samples; i += 1) {
+        const Point2D sample = weave(i);
+        recorder.record(sample.x, sample.y);
+    }
+    recorder.stopRecording();
+    const unsigned int count = recorder.waypoints(recorded, WAYPOINT_RECORDER_COUNT);
+    distance_type worst = 0;
+    for(unsigned int i = 0; i < samples; i += 1) {
+        worst = max<distance_type>(worst, distanceToPath(weave(i), recorded, count));
+    }
+    printf("WaypointRecorder: weave of %d poses kept as %d waypoints, tolerance %.0f cm, worst error %.2f cm\n",
+        samples, count, (float)recorder.tolerance(), (float)worst);
+
+    if((count > WAYPOINT_RECORDER_COUNT) || (count != recorder.count())) {
+        testError("WaypointRecorder: expected at most %d waypoints, got %d", WAYPOINT_RECORDER_COUNT, count);
+    }
+    if(recorder.tolerance() <= WAYPOINT_TOLERANCE) {
+        testError("WaypointRecorder: expected tolerance to grow, got %f", (float)recorder.tolerance());
+    }
+    if(worst > 2 * recorder.tolerance()) {
+        testError("WaypointRecorder: path strayed %f cm from the poses", (float)worst);
+    }
+
+    // the end of the drive is kept exactly, to 1/8 cm
+    const Point2D end = weave(samples - 1);
+    const Point2D &last = recorded[count - 1];
+    if(HYPOT(last.x - end.x, last.y - end.y) > 0.125f) {
+        testError("WaypointRecorder: last waypoint moved to %f, %f", (float)last.x, (float)last.y);
+    }
+}
+
+/**
+ * Closed loop simulation of a rover with mismatched motors
+ */
+typedef struct Simulation {
+    RoverReplay replay;
+    SimulatedWheel left;
+    SimulatedWheel right;
+    unsigned long ms;
+
+    Simulation()
+        : replay(13.5, CIRCUMFERENCE, PULSES, CIRCUMFERENCE, PULSES),
+          left({0.33f, 0, 0, 0, CIRCUMFERENCE / PULSES}),
+          right({0.30f, 3, 0, 0, CIRCUMFERENCE / PULSES}),
+          ms(1000)
+    {
+        TwoWheelRover &rover = replay.rover();
+        rover.setAccelerationLimits(ALL_WHEELS, WHEEL_MAX_ACCELERATION, WHEEL_MAX_JERK, WHEEL_MAX_PWM_RATE, WHEEL_MAX_PWM_JERK);
+        rover.setMotorStall(SimulatedWheel::WHEEL_STALL_PWM / 255.0f, SimulatedWheel::WHEEL_STALL_PWM / 255.0f);
+        rover.setSpeedControl(ALL_WHEELS, 10, 50, 1, 0, 0);
+        replay.drive(ms, 0, 0);
+    }
+
+    void step() {
+        left.step(replay.leftWheel(), ms, STEP_MS / 1000.0f);
+        right.step(replay.rightWheel(), ms, STEP_MS / 1000.0f);
+        replay.drive(ms + STEP_MS, left.count(), right.count());
+        ms += STEP_MS;
+    }
+
+    static constexpr distance_type CIRCUMFERENCE = 20;
+    static const int PULSES = 40;
+    static const unsigned long STEP_MS = 5;
+} Simulation;
+constexpr distance_type Simulation::CIRCUMFERENCE;    // passed by reference, so needs a definition
+
+void TestPlayback() {
+    //
+    // record a wandering drive, steered by hand
+    //
+    Simulation drive;
+    TwoWheelRover &driven = drive.replay.rover();
+    WaypointRecorder recorder;
+    recorder.attach(driven, drive.replay.messageBus()).startRecording();
+    const unsigned long startMs = drive.ms;
+    while(drive.ms < startMs + 40000) {
+        const float seconds = (drive.ms - startMs) / 1000.0f;
+        driven.setVelocity(20, 0.6f * sinf(seconds / 3));
+        drive.step();
+    }
+    driven.setVelocity(0, 0);
+    recorder.stopRecording();
+    const unsigned int count = recorder.waypoints(recorded, WAYPOINT_RECORDER_COUNT);
+    const Point2D end = recorded[count - 1];
+
+    //
+    // play it back on a fresh rover; the path is
+    // longer than the follower holds, so
+    // it is streamed as the rover drives.
+    //
+    Simulation play;
+    PathFollowBehavior follower;
+    follower.attach(play.replay.rover(), play.replay.messageBus());
+    recorder.detach().attach(play.replay.rover(), play.replay.messageBus());
+    recorder.play(follower, PATH_LOOKAHEAD, 0);
+    const unsigned long playMs = play.ms;
+    distance_type worst = 0;
+    while((NOT_RUNNING != follower.state()) && (play.ms < playMs + 120000)) {
+        recorder.poll(play.ms);
+        follower.poll(play.ms);
+        play.step();
+        const Pose2D pose = play.replay.rover().pose();
+        worst = max<distance_type>(worst, distanceToPath({pose.x, pose.y}, recorded, count));
+    }
+    const Pose2D pose = play.replay.rover().pose();
+    const distance_type miss = HYPOT(end.x - pose.x, end.y - pose.y);
+    printf("WaypointRecorder: 40 second drive recorded as %d waypoints; played back in %.2f sec, worst off path %.1f cm, miss %.1f cm\n",
+        count, follower.timeToGoalMs() / 1000.0f, (float)worst, (float)miss);
+
+    if(count <= PATH_MAX_WAYPOINTS) {
+        testError("WaypointRecorder: expected more than %d waypoints to stream, got %d", PATH_MAX_WAYPOINTS, count);
+    }
+    if((NOT_RUNNING != follower.state()) || recorder.playing()) {
+        testError("WaypointRecorder: playback did not finish, at waypoint %d", follower.waypointIndex());
+    }
+    if(follower.waypointIndex() + 1 != count) {
+        testError("WaypointRecorder: finished at waypoint %d of %d", follower.waypointIndex(), count);
+    }
+    if(miss > 10) {
+        testError("WaypointRecorder: stopped %f cm from the end of the path", (float)miss);
+    }
+    if(worst > PATH_LOOKAHEAD) {
+        testError("WaypointRecorder: strayed %f cm from the path", (float)worst);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/waypoint_recorder.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/goto_goal.cpp ../src/rover/path_follow.cpp ../src/rover/waypoint_recorder.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+    TestStraightLine();
+    TestCurveStaysWithinTolerance();
+    TestLongDriveIsBounded();
+    TestPlayback();
+
+    return testResults("waypoint_recorder");
+}
@@ -0,0 +1,136 @@
+#include <math.h>
+#include <stdio.h>
+
+#include "../../test.h"
+#include "../../replay/rover_replay.h"
+#include "simulated_wheel.h"
+
+static bool near(distance_type a, float b, float tolerance) {
+    return fabsf((float)a - b) <= tolerance;
+}
+
+void TestErrorDrivingStraight() {
+    WheelSync sync(1, 0, 0.25);
+    sync.step(20, 20, 0, 0, 0);
+
+    // left is 1 cm ahead, so slow it and speed up right
+    sync.step(20, 20, 11, 10, 0.5);
+    if(!near(sync.error(), 1, 0.0001f)) {
+        testError("WheelSync: expected error 1 cm, got %f", (float)sync.error());
+    }
+    if(!near(sync.leftTrim(), -1, 0.0001f) || !near(sync.rightTrim(), 1, 0.0001f)) {
+        testError("WheelSync: expected trims -1, 1, got %f, %f", (float)sync.leftTrim(), (float)sync.rightTrim());
+    }
+
+    // right catches up
+    sync.step(20, 20, 21, 21, 0.5);
+    if(!near(sync.error(), 0, 0.0001f) || (0 != sync.leftTrim()) || (0 != sync.rightTrim())) {
+        testError("WheelSync: expected no error, got %f", (float)sync.error());
+    }
+}
+
+void TestNoErrorOnArc() {
+    //
+    // wheels that move in the ratio of their
+    // setpoints, forward or spinning, are in sync
+    //
+    WheelSync sync(1, 1, 0.25);
+    sync.step(10, 20, 0, 0, 0);
+    sync.step(10, 20, 5, 10, 0.5);
+    if(!near(sync.error(), 0, 0.0001f)) {
+        testError("WheelSync: arc should have no error, got %f", (float)sync.error());
+    }
+    sync.reset();
+    sync.step(-15, 15, 5, 5, 0);
+    sync.step(-15, 15, 0, 10, 0.5);
+    if(!near(sync.error(), 0, 0.0001f)) {
+        testError("WheelSync: spin should have no error, got %f", (float)sync.error());
+    }
+
+    // a spin where both wheels went forward has drifted forward, so trim both backward
+    sync.step(-15, 15, 2, 12, 0.5);
+    if(sync.error() <= 0 || sync.leftTrim() >= 0 || sync.rightTrim() >= 0) {
+        testError("WheelSync: spin drifted forward, error %f, trims %f, %f", (float)sync.error(), (float)sync.leftTrim(), (float)sync.rightTrim());
+    }
+}
+
+void TestTrimIsBounded() {
+    WheelSync sync(10, 0, 0.25);
+    sync.step(20, 20, 0, 0, 0);
+    sync.step(20, 20, 10, 0, 0.5);
+    if(!near(sync.leftTrim(), -5, 0.0001f) || !near(sync.rightTrim(), 5, 0.0001f)) {
+        testError("WheelSync: expected trims bounded to -5, 5, got %f, %f", (float)sync.leftTrim(), (float)sync.rightTrim());
+    }
+
+    // stopping forgets the error
+    sync.step(0, 0, 10, 0, 0.5);
+    if((0 != sync.error()) || (0 != sync.leftTrim()) || (0 != sync.rightTrim())) {
+        testError("WheelSync: expected reset when stopped, got error %f", (float)sync.error());
+    }
+}
+
+/**
+ * Drive straight with mismatched motors
+ * and measure how far the heading drifts.
+ */
+static void driveStraight(
+    bool sync,              // IN : true to synchronize the wheels
+    float &drift,           // OUT: worst |left - right| distance, once started
+    float &heading)         // OUT: final heading
+{
+    const distance_type circumference = 20;
+    const int pulses = 40;
+    RoverReplay replay(13.5, circumference, pulses, circumference, pulses);
+    TwoWheelRover &rover = replay.rover();
+    rover.setAccelerationLimits(ALL_WHEELS, WHEEL_MAX_ACCELERATION, WHEEL_MAX_JERK, WHEEL_MAX_PWM_RATE, WHEEL_MAX_PWM_JERK);
+    rover.setMotorStall(SimulatedWheel::WHEEL_STALL_PWM / 255.0f, SimulatedWheel::WHEEL_STALL_PWM / 255.0f);
+    rover.setSpeedControl(ALL_WHEELS, 10, 50, 1, 0, 0);
+    rover.setWheelSync(sync ? WHEEL_SYNC_KP : 0, sync ? WHEEL_SYNC_KI : 0);
+
+    // left motor is 10% stronger than right, and right drags now and then
+    SimulatedWheel left = {0.33f, 0, 0, 0, circumference / pulses};
+    SimulatedWheel right = {0.30f, 3, 0, 0, circumference / pulses};
+
+    const unsigned long stepMs = 5;
+    unsigned long ms = 1000;
+    replay.drive(ms, 0, 0);
+    rover.setVelocity(20, 0);
+    drift = 0;
+    for(; ms < 31000; ms += stepMs) {
+        left.step(replay.leftWheel(), ms, stepMs / 1000.0f);
+        right.step(replay.rightWheel(), ms, stepMs / 1000.0f);
+        replay.drive(ms + stepMs, left.count(), right.count());
+        if((ms >= 16000) && (fabsf(left.distance - right.distance) > drift)) {
+            drift = fabsf(left.distance - right.distance);
+        }
+    }
+    heading = (float)rover.pose().angle;
+}
+
+void TestSyncReducesStraightDrift() {
+    float driftOff, headingOff;
+    float driftOn, headingOn;
+    driveStraight(false, driftOff, headingOff);
+    driveStraight(true, driftOn, headingOn);
+    printf("WheelSync: 30 seconds at 20 cm/sec, worst wheel drift in last 15 seconds %.2f cm (final heading %.3f) independent, %.2f cm (%.3f) synchronized\n",
+        driftOff, headingOff, driftOn, headingOn);
+
+    if(driftOn > 3) {
+        testError("WheelSync: synchronized wheels drifted %f cm", driftOn);
+    }
+    if(driftOn >= driftOff / 2) {
+        testError("WheelSync: expected less than half the drift, got %f vs %f cm", driftOn, driftOff);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -lstdc++ -Ireplay -I../src -include Arduino.h test.cpp src/rover/wheel_sync.test.cpp replay/rover_replay.cpp ../src/gpio/pwm.cpp ../src/motor/motor_l9110s.cpp ../src/encoder/encoder.cpp ../src/wheel/drive_wheel.cpp ../src/wheel/setpoint_ramp.cpp ../src/rover/rover.cpp ../src/rover/wheel_sync.cpp ../src/rover/odometry.cpp ../src/rover/pose_history.cpp ../src/rover/pose.cpp ../src/recorder/flight_recorder.cpp ../src/recorder/flight_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp -lm; ./a.out; rm a.out
+
+    TestErrorDrivingStraight();
+    TestNoErrorOnArc();
+    TestTrimIsBounded();
+    TestSyncReducesStraightDrift();
+
+    return testResults("wheel_sync");
+}
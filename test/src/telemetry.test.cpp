@@ -0,0 +1,228 @@
+#include <string.h>
+#include <string>
+
+#include "../test.h"
+#include "../../src/telemetry.h"
+#include "../../src/error.h"
+
+using namespace std;
+
+unsigned long replayMillis = 0;    // clock for Arduino.h
+
+//
+// frames sent by the telemetry sender
+//
+static string sentText;
+static int sentFrames = 0;
+static int historyRecords[NUMBER_OF_TELEMETRY_CHANNELS];    // history records sent per channel
+static int historyLast[NUMBER_OF_TELEMETRY_CHANNELS];       // last history chunks sent per channel
+void wsSendCommandText(const char *msg, unsigned int length) {
+    sentText.append(msg, length);
+    sentFrames += 1;
+}
+void wsSendCommandBinary(const uint8_t *msg, unsigned int length) {
+    if((length >= TELEMETRY_HISTORY_HEADER_BYTES) && (TELEMETRY_RECORD_HISTORY == msg[0])) {
+        historyRecords[msg[1]] += msg[3];
+        if(msg[2] & TELEMETRY_HISTORY_LAST) {
+            historyLast[msg[1]] += 1;
+        }
+    }
+    sentFrames += 1;
+}
+
+//
+// messages are not captured from a rover here;
+// the tests hand snapshots straight to send()
+//
+bool captureTelemetry(Message message, Specifier specifier, const char *data, unsigned long currentMillis, TelemetrySnapshot &snapshot) {
+    return false;
+}
+
+static TelemetrySnapshot wheelSnapshot(Message message, Specifier specifier, unsigned long at) {
+    TelemetrySnapshot snapshot;
+    snapshot.message = message;
+    snapshot.specifier = specifier;
+    snapshot.at = at;
+    snapshot.wheel = WheelTelemetry();
+    snapshot.wheel.wheel = specifier;
+    snapshot.wheel.forward = true;
+    snapshot.wheel.pwm = 200;
+    snapshot.wheel.speed = 12.5;
+    snapshot.wheel.at = at;
+    snapshot.data[0] = '\0';
+    return snapshot;
+}
+
+static TelemetrySnapshot haltSnapshot(Specifier specifier, unsigned long at) {
+    TelemetrySnapshot snapshot;
+    snapshot.message = WHEEL_HALT;
+    snapshot.specifier = specifier;
+    snapshot.at = at;
+    strcpy(snapshot.data, "halted");
+    return snapshot;
+}
+
+/**
+ * send every queued record
+ */
+static void drain(TelemetrySender &telemetry, unsigned long at) {
+    for(int i = 0; i < 8; i += 1) {
+        telemetry.poll(at);
+    }
+}
+
+/**
+ * count occurrences of pattern in text
+ */
+static int countOf(const string &text, const char *pattern) {
+    int count = 0;
+    for(size_t at = text.find(pattern); string::npos != at; at = text.find(pattern, at + 1)) {
+        count += 1;
+    }
+    return count;
+}
+
+void TestHaltSurvivesFlood() {
+    TelemetrySender telemetry;
+    sentText.clear();
+
+    // start sending wheel samples, then flood the queue with them
+    telemetry.send(wheelSnapshot(WHEEL_POWER, LEFT_WHEEL_SPEC, 1));
+    for(unsigned long i = 0; i < 50; i += 1) {
+        telemetry.send(wheelSnapshot(SPEED_CONTROL, LEFT_WHEEL_SPEC, 10 + i));
+    }
+    telemetry.send(haltSnapshot(LEFT_WHEEL_SPEC, 100));
+    for(unsigned long i = 0; i < 50; i += 1) {
+        telemetry.send(wheelSnapshot(SPEED_CONTROL, RIGHT_WHEEL_SPEC, 110 + i));
+    }
+    drain(telemetry, 200);
+
+    if(string::npos == sentText.find("\"msg\":\"halted\"")) {
+        testError("TelemetrySender: halt was lost behind wheel samples: %s", sentText.c_str());
+    }
+    if(0 == telemetry.lost(TELEMETRY_WHEEL)) {
+        testError("TelemetrySender: flood should have dropped wheel samples%s", "");
+    }
+    if(0 != telemetry.lost(TELEMETRY_LOG)) {
+        testError("TelemetrySender: log channel should not lose records%s", "");
+    }
+}
+
+void TestHaltIsNotDecimated() {
+    TelemetrySender telemetry;
+    sentText.clear();
+
+    //
+    // a halt is sent even if the log channel
+    // is rate limited or turned off
+    //
+    telemetry.setChannelPeriod(TELEMETRY_LOG, 1000);
+    telemetry.send(haltSnapshot(LEFT_WHEEL_SPEC, 10));
+    telemetry.send(haltSnapshot(RIGHT_WHEEL_SPEC, 20));
+    telemetry.send(haltSnapshot(LEFT_WHEEL_SPEC, 30));
+    drain(telemetry, 40);
+    const int count = countOf(sentText, "halted");
+    if(3 != count) {
+        testError("TelemetrySender: rate limit should not decimate halt, sent %d", count);
+    }
+
+    sentText.clear();
+    telemetry.setChannelPeriod(TELEMETRY_LOG, TELEMETRY_PERIOD_OFF);
+    telemetry.send(haltSnapshot(LEFT_WHEEL_SPEC, 50));
+    drain(telemetry, 60);
+    if(string::npos == sentText.find("halted")) {
+        testError("TelemetrySender: halt should be sent with log channel off%s", "");
+    }
+}
+
+void TestOnlyPeriodicChannelsAreDecimated() {
+    TelemetrySender telemetry;
+    sentText.clear();
+
+    //
+    // the first wheel sample is sent even if it
+    // comes before one period has passed since boot,
+    // then samples are limited to one per period.
+    //
+    telemetry.setChannelPeriod(TELEMETRY_WHEEL, 100);
+    telemetry.send(wheelSnapshot(WHEEL_POWER, LEFT_WHEEL_SPEC, 5));
+    telemetry.send(wheelSnapshot(SPEED_CONTROL, LEFT_WHEEL_SPEC, 10));
+    telemetry.send(wheelSnapshot(SPEED_CONTROL, LEFT_WHEEL_SPEC, 50));
+    telemetry.send(wheelSnapshot(SPEED_CONTROL, LEFT_WHEEL_SPEC, 110));
+    drain(telemetry, 120);
+    if(2 != countOf(sentText, "tel(")) {
+        testError("TelemetrySender: wheel should be decimated to 2 samples, sent %d", countOf(sentText, "tel("));
+    }
+
+    //
+    // state changes are never decimated,
+    // so the client always has the latest value
+    //
+    sentText.clear();
+    telemetry.setChannelPeriod(TELEMETRY_SET, 1000);
+    telemetry.send(wheelSnapshot(WHEEL_POWER, LEFT_WHEEL_SPEC, 200));
+    telemetry.send(wheelSnapshot(WHEEL_POWER, LEFT_WHEEL_SPEC, 210));
+    telemetry.send(wheelSnapshot(WHEEL_POWER, LEFT_WHEEL_SPEC, 220));
+    drain(telemetry, 230);
+    if(3 != countOf(sentText, "set(")) {
+        testError("TelemetrySender: set should not be decimated, sent %d", countOf(sentText, "set("));
+    }
+
+    sentText.clear();
+    telemetry.setChannelPeriod(TELEMETRY_SET, TELEMETRY_PERIOD_OFF);
+    telemetry.send(wheelSnapshot(WHEEL_POWER, LEFT_WHEEL_SPEC, 300));
+    drain(telemetry, 310);
+    if(0 != countOf(sentText, "set(")) {
+        testError("TelemetrySender: set channel is off, sent %d", countOf(sentText, "set("));
+    }
+}
+
+void TestHistoryCursorPerChannel() {
+    TelemetrySender telemetry;
+    if(SUCCESS != telemetry.beginHistory(64)) {
+        testError("TelemetrySender.beginHistory() failed%s", "");
+        return;
+    }
+    memset(historyRecords, 0, sizeof(historyRecords));
+    memset(historyLast, 0, sizeof(historyLast));
+
+    // record interleaved wheel and pose samples
+    telemetry.send(wheelSnapshot(WHEEL_POWER, LEFT_WHEEL_SPEC, 1));
+    for(unsigned long i = 0; i < 10; i += 1) {
+        telemetry.send(wheelSnapshot(SPEED_CONTROL, LEFT_WHEEL_SPEC, 10 + 10 * i));
+        TelemetrySnapshot pose;
+        pose.message = ROVER_POSE;
+        pose.specifier = ROVER_SPEC;
+        pose.at = 10 + 10 * i;
+        pose.pose = {{1, 2, 0.5}, pose.at};
+        telemetry.send(pose);
+    }
+    drain(telemetry, 200);
+
+    //
+    // asking for pose right after wheel,
+    // like a client backfilling after a reconnect,
+    // streams both backlogs
+    //
+    telemetry.requestHistory(TELEMETRY_WHEEL, 50);
+    telemetry.requestHistory(TELEMETRY_POSE, 0);
+    drain(telemetry, 210);
+    if((5 != historyRecords[TELEMETRY_WHEEL]) || (1 != historyLast[TELEMETRY_WHEEL])) {
+        testError("TelemetrySender: wheel backlog sent %d records", historyRecords[TELEMETRY_WHEEL]);
+    }
+    if((10 != historyRecords[TELEMETRY_POSE]) || (1 != historyLast[TELEMETRY_POSE])) {
+        testError("TelemetrySender: pose backlog sent %d records", historyRecords[TELEMETRY_POSE]);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ -Ireplay -include Arduino.h test.cpp src/telemetry.test.cpp ../src/telemetry.cpp ../src/telemetry_format.cpp ../src/telemetry_history.cpp ../src/token_log.cpp ../src/message_bus/message_bus.cpp ../src/message_bus/messages.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+    TestHaltSurvivesFlood();
+    TestHaltIsNotDecimated();
+    TestOnlyPeriodicChannelsAreDecimated();
+    TestHistoryCursorPerChannel();
+
+    return testResults("telemetry");
+}
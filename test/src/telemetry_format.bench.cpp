@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+
+#include "../../src/telemetry_format.h"
+
+using namespace std;
+
+//
+// Compare text and binary telemetry;
+// bytes per message, bytes per second at
+// the rover's nominal telemetry rates,
+// and time to format each message.
+//
+
+static inline uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static volatile int sink = 0;   // keep the optimizer from removing the work
+
+//
+// nominal rates while driving: both wheels and the pose
+// are published every control poll (20ms).
+//
+const int SPEED_CONTROL_PER_SEC = 2 * 50;
+const int ROVER_POSE_PER_SEC = 50;
+
+int main() {
+    // from test folder run:
+    // gcc -O2 -DTESTING -std=c++11 -lstdc++ src/telemetry_format.bench.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+    const int COUNT = 200000;
+    char text[128];
+    uint8_t binary[128];
+
+    WheelTelemetry wheel = {LEFT_WHEEL_SPEC, true, 237, 88.93f, 92.0f, 227.0f, 2140355};
+    PoseTelemetry pose = {{1234.5678f, -987.6543f, 1.570796f}, 2140355};
+
+    //
+    // text
+    //
+    int textWheelBytes = 0;
+    int textPoseBytes = 0;
+    uint64_t startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        wheel.distance += 0.5f;
+        wheel.at += 20;
+        textWheelBytes = formatSpeedControl(text, sizeof(text), wheel);
+        pose.pose.x += 0.25f;
+        pose.at += 20;
+        textPoseBytes = formatRoverPose(text, sizeof(text), pose);
+        sink += text[textPoseBytes - 1];
+    }
+    const uint64_t textNs = nowNs() - startNs;
+
+    //
+    // binary
+    //
+    int binaryWheelBytes = 0;
+    int binaryPoseBytes = 0;
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        wheel.distance += 0.5f;
+        wheel.at += 20;
+        binaryWheelBytes = packSpeedControl(binary, sizeof(binary), wheel);
+        pose.pose.x += 0.25f;
+        pose.at += 20;
+        binaryPoseBytes = packRoverPose(binary, sizeof(binary), pose);
+        sink += binary[binaryPoseBytes - 1];
+    }
+    const uint64_t binaryNs = nowNs() - startNs;
+
+    const int textPerSec = textWheelBytes * SPEED_CONTROL_PER_SEC + textPoseBytes * ROVER_POSE_PER_SEC;
+    const int binaryPerSec = binaryWheelBytes * SPEED_CONTROL_PER_SEC + binaryPoseBytes * ROVER_POSE_PER_SEC;
+
+    printf("telemetry_format: text   wheel = %d bytes, pose = %d bytes, %d bytes/sec, %.1f ns/msg\n",
+        textWheelBytes, textPoseBytes, textPerSec, (double)textNs / (2 * COUNT));
+    printf("telemetry_format: binary wheel = %d bytes, pose = %d bytes, %d bytes/sec, %.1f ns/msg\n",
+        binaryWheelBytes, binaryPoseBytes, binaryPerSec, (double)binaryNs / (2 * COUNT));
+    printf("telemetry_format: binary is %.1fx smaller and %.1fx faster to format\n",
+        (double)textPerSec / binaryPerSec, (double)textNs / binaryNs);
+
+    //
+    // delta encoded wheel telemetry while cruising;
+    // pwm and target hold steady, so only speed
+    // and distance change, with a periodic keyframe.
+    //
+    const int KEYFRAME_INTERVAL = 25;
+    int textDeltaBytes = 0;
+    int binaryDeltaBytes = 0;
+    WheelTelemetry last = wheel;
+    for(int i = 0; i < KEYFRAME_INTERVAL; i += 1) {
+        wheel.speed += (i & 1) ? 0.25f : -0.25f;
+        wheel.distance += 0.5f;
+        wheel.at += 20;
+        const uint8_t fields = (0 == i) ? (WHEEL_ALL_FIELDS | WHEEL_KEYFRAME) : wheelChangedFields(last, wheel);
+        textDeltaBytes += formatSpeedControlDelta(text, sizeof(text), wheel, fields, i);
+        binaryDeltaBytes += packSpeedControlDelta(binary, sizeof(binary), wheel, fields, i);
+        last = wheel;
+    }
+    printf("telemetry_format: delta  wheel = %.1f text bytes (%d full), %.1f binary bytes (%d full) averaged over a keyframe interval\n",
+        (double)textDeltaBytes / KEYFRAME_INTERVAL, textWheelBytes, (double)binaryDeltaBytes / KEYFRAME_INTERVAL, binaryWheelBytes);
+
+    return 0;
+}
@@ -0,0 +1,233 @@
+#include <string.h>
+
+#include "../test.h"
+#include "../../src/telemetry_format.h"
+
+//
+// read little-endian values back out of a binary record
+//
+static uint32_t u32At(const uint8_t *buffer, int offset) {
+    return (uint32_t)buffer[offset]
+        | ((uint32_t)buffer[offset + 1] << 8)
+        | ((uint32_t)buffer[offset + 2] << 16)
+        | ((uint32_t)buffer[offset + 3] << 24);
+}
+static float f32At(const uint8_t *buffer, int offset) {
+    const uint32_t bits = u32At(buffer, offset);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+const WheelTelemetry wheel = {RIGHT_WHEEL_SPEC, true, 237, 88.5f, 92.25f, 227.0f, 2140355};
+const PoseTelemetry pose = {{10.5f, -4.25f, 0.5f}, 707869, {{
+    {0.25f, 0.125f, 0.0625f},
+    {0.125f, 1.5f, -0.5f},
+    {0.0625f, -0.5f, 0.03125f}}}};
+const GotoTelemetry go2 = {{-300.0f, 0.0f, 3.0f}, 3, "ACHIEVED", 707870};
+
+void TestFormatText() {
+    char buffer[192];
+
+    int length = formatSpeedControl(buffer, sizeof(buffer), wheel);
+    const char *expected = "tel({\"right\":{\"forward\":true,\"pwm\":237,\"target\":88.500000,\"speed\":92.250000,\"distance\":227.000000,\"at\":2140355}})";
+    if((0 != strcmp(expected, buffer)) || ((int)strlen(expected) != length)) {
+        testError("formatSpeedControl: '%s' != '%s'", expected, buffer);
+    }
+
+    formatRoverPose(buffer, sizeof(buffer), pose);
+    expected = "pose({\"pose\":{\"x\":10.500000,\"y\":-4.250000,\"a\":0.500000,"
+        "\"cov\":[0.250000,0.125000,0.062500,1.500000,-0.500000,0.031250],\"at\":707869}})";
+    if(0 != strcmp(expected, buffer)) {
+        testError("formatRoverPose: '%s' != '%s'", expected, buffer);
+    }
+
+    // a pose far from the origin, after a long drive, still fits the sender's buffer
+    const PoseTelemetry far = {{-99999.5f, -99999.5f, -3.141592f}, 4294967295UL, {{
+        {99999.5f, -99999.5f, -999.5f},
+        {-99999.5f, 99999.5f, -999.5f},
+        {-999.5f, -999.5f, 999.5f}}}};
+    if(formatRoverPose(buffer, sizeof(buffer), far) < 0) {
+        testError("formatRoverPose: far pose does not fit in %d bytes", (int)sizeof(buffer));
+    }
+
+    formatGotoGoal(buffer, sizeof(buffer), go2);
+    expected = "goto({\"goto\":{\"x\":-300.000000,\"y\":0.000000,\"a\":3.000000,\"state\":\"ACHIEVED\",\"at\":707870}})";
+    if(0 != strcmp(expected, buffer)) {
+        testError("formatGotoGoal: '%s' != '%s'", expected, buffer);
+    }
+}
+
+void TestPackWheel() {
+    uint8_t buffer[64];
+
+    int length = packSpeedControl(buffer, sizeof(buffer), wheel);
+    if(TELEMETRY_WHEEL_BYTES != length) {
+        testError("packSpeedControl: length %d != %d", TELEMETRY_WHEEL_BYTES, length);
+    }
+    if((TELEMETRY_RECORD_WHEEL != buffer[0]) || (1 != buffer[1]) || (1 != buffer[2]) || (237 != buffer[3])) {
+        testError("packSpeedControl: header is wrong: %d, %d, %d, %d", buffer[0], buffer[1], buffer[2], buffer[3]);
+    }
+    if((88.5f != f32At(buffer, 4)) || (92.25f != f32At(buffer, 8)) || (227.0f != f32At(buffer, 12)) || (2140355 != u32At(buffer, 16))) {
+        testError("packSpeedControl: values are wrong%s", "");
+    }
+
+    //
+    // 2140355 == 0x0020A8C3; check byte order explicitly
+    //
+    if((0xC3 != buffer[16]) || (0xA8 != buffer[17]) || (0x20 != buffer[18]) || (0x00 != buffer[19])) {
+        testError("packSpeedControl: 'at' is not little-endian%s", "");
+    }
+
+    length = packWheelPower(buffer, sizeof(buffer), wheel);
+    if((TELEMETRY_WHEEL_POWER_BYTES != length) || (TELEMETRY_RECORD_WHEEL_POWER != buffer[0]) || (237 != buffer[3])) {
+        testError("packWheelPower: record is wrong, length %d", length);
+    }
+
+    length = packTargetSpeed(buffer, sizeof(buffer), wheel);
+    if((TELEMETRY_TARGET_SPEED_BYTES != length) || (TELEMETRY_RECORD_TARGET_SPEED != buffer[0]) || (88.5f != f32At(buffer, 4))) {
+        testError("packTargetSpeed: record is wrong, length %d", length);
+    }
+}
+
+void TestPackPoseAndGoto() {
+    uint8_t buffer[64];
+    const float covariance[6] = {0.25f, 0.125f, 0.0625f, 1.5f, -0.5f, 0.03125f};
+
+    int length = packRoverPose(buffer, sizeof(buffer), pose);
+    if((TELEMETRY_POSE_BYTES != length) || (TELEMETRY_RECORD_POSE != buffer[0])) {
+        testError("packRoverPose: record is wrong, length %d", length);
+    }
+    if((10.5f != f32At(buffer, 4)) || (-4.25f != f32At(buffer, 8)) || (0.5f != f32At(buffer, 12)) || (707869 != u32At(buffer, 16))) {
+        testError("packRoverPose: values are wrong%s", "");
+    }
+    for(int i = 0; i < 6; i += 1) {
+        if(covariance[i] != f32At(buffer, 20 + 4 * i)) {
+            testError("packRoverPose: covariance %d is wrong", i);
+        }
+    }
+
+    length = packGotoGoal(buffer, sizeof(buffer), go2);
+    if((TELEMETRY_GOTO_BYTES != length) || (TELEMETRY_RECORD_GOTO != buffer[0]) || (3 != buffer[1])) {
+        testError("packGotoGoal: record is wrong, length %d", length);
+    }
+    if((-300.0f != f32At(buffer, 4)) || (707870 != u32At(buffer, 16))) {
+        testError("packGotoGoal: values are wrong%s", "");
+    }
+}
+
+void TestPackLog() {
+    uint8_t buffer[64];
+
+    int length = packLog(buffer, sizeof(buffer), "left", "stalled");
+    if((TELEMETRY_LOG_HEADER_BYTES + 4 + 7 != length) || (TELEMETRY_RECORD_LOG != buffer[0]) || (4 != buffer[1]) || (7 != buffer[2])) {
+        testError("packLog: header is wrong, length %d", length);
+    }
+    if((0 != memcmp("left", buffer + 3, 4)) || (0 != memcmp("stalled", buffer + 7, 7))) {
+        testError("packLog: strings are wrong%s", "");
+    }
+}
+
+void TestPackTooSmall() {
+    uint8_t buffer[8];
+
+    if(-1 != packSpeedControl(buffer, sizeof(buffer), wheel)) {
+        testError("packSpeedControl: should fail on small buffer%s", "");
+    }
+    if(-1 != packRoverPose(buffer, sizeof(buffer), pose)) {
+        testError("packRoverPose: should fail on small buffer%s", "");
+    }
+    if(-1 != packLog(buffer, sizeof(buffer), "left", "stalled")) {
+        testError("packLog: should fail on small buffer%s", "");
+    }
+}
+
+void TestAppendToFrame() {
+    uint8_t frame[2 * TELEMETRY_POSE_BYTES + 8];
+    uint8_t record[TELEMETRY_POSE_BYTES];
+
+    //
+    // binary records are concatenated until the frame is full
+    //
+    packRoverPose(record, sizeof(record), pose);
+    int length = appendToFrame(frame, sizeof(frame), 0, record, TELEMETRY_POSE_BYTES, true);
+    length = appendToFrame(frame, sizeof(frame), length, record, TELEMETRY_POSE_BYTES, true);
+    if((2 * TELEMETRY_POSE_BYTES != length) || (TELEMETRY_RECORD_POSE != frame[TELEMETRY_POSE_BYTES])) {
+        testError("appendToFrame: binary frame is wrong, length %d", length);
+    }
+    if(-1 != appendToFrame(frame, sizeof(frame), length, record, TELEMETRY_POSE_BYTES, true)) {
+        testError("appendToFrame: should fail on a full frame%s", "");
+    }
+
+    //
+    // text records are separated by a newline
+    //
+    length = appendToFrame(frame, sizeof(frame), 0, (const uint8_t *)"log(1)", 6, false);
+    length = appendToFrame(frame, sizeof(frame), length, (const uint8_t *)"log(2)", 6, false);
+    if((13 != length) || (0 != memcmp("log(1)\nlog(2)", frame, length))) {
+        testError("appendToFrame: text frame is wrong, length %d", length);
+    }
+}
+
+void TestWheelDelta() {
+    //
+    // only changed fields are detected
+    //
+    WheelTelemetry next = wheel;
+    if(0 != wheelChangedFields(wheel, next)) {
+        testError("wheelChangedFields: should be no change%s", "");
+    }
+    next.speed += 1;
+    next.distance += 1;
+    next.at += 20;  // time is always sent, so it is not a field
+    if((WHEEL_SPEED_FIELD | WHEEL_DISTANCE_FIELD) != wheelChangedFields(wheel, next)) {
+        testError("wheelChangedFields: expected speed and distance, got 0x%x", wheelChangedFields(wheel, next));
+    }
+
+    //
+    // text delta has sequence and changed fields only
+    //
+    char text[128];
+    int length = formatSpeedControlDelta(text, sizeof(text), wheel, WHEEL_SPEED_FIELD, 12);
+    if((length < 0) || (0 != strncmp("tel({\"right\":{\"seq\":12,\"speed\":", text, 29)) || (nullptr != strstr(text, "distance"))) {
+        testError("formatSpeedControlDelta: got %s", text);
+    }
+    length = formatSpeedControlDelta(text, sizeof(text), wheel, WHEEL_ALL_FIELDS | WHEEL_KEYFRAME, 0);
+    if((length < 0) || (nullptr == strstr(text, "\"key\":true")) || (nullptr == strstr(text, "\"distance\":"))) {
+        testError("formatSpeedControlDelta: keyframe should have all fields, got %s", text);
+    }
+
+    //
+    // binary delta has header, changed fields, then time
+    //
+    uint8_t buffer[TELEMETRY_WHEEL_DELTA_MAX_BYTES];
+    length = packSpeedControlDelta(buffer, sizeof(buffer), wheel, WHEEL_SPEED_FIELD, 12);
+    if((12 != length) || (TELEMETRY_RECORD_WHEEL_DELTA != buffer[0]) || (WHEEL_SPEED_FIELD != buffer[2]) || (12 != buffer[3])) {
+        testError("packSpeedControlDelta: header is wrong, length %d", length);
+    }
+    float speed;
+    uint32_t at = buffer[8] | (buffer[9] << 8) | (buffer[10] << 16) | ((uint32_t)buffer[11] << 24);
+    memcpy(&speed, buffer + 4, sizeof(speed));  // host is little-endian
+    if((wheel.speed != speed) || (wheel.at != at)) {
+        testError("packSpeedControlDelta: values are wrong, speed %f", speed);
+    }
+    length = packSpeedControlDelta(buffer, sizeof(buffer), wheel, WHEEL_ALL_FIELDS | WHEEL_KEYFRAME, 0);
+    if(TELEMETRY_WHEEL_DELTA_MAX_BYTES != length) {
+        testError("packSpeedControlDelta: keyframe should be %d bytes", TELEMETRY_WHEEL_DELTA_MAX_BYTES);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ test.cpp src/telemetry_format.test.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+    TestFormatText();
+    TestPackWheel();
+    TestPackPoseAndGoto();
+    TestPackLog();
+    TestPackTooSmall();
+    TestAppendToFrame();
+    TestWheelDelta();
+
+    return testResults("telemetry_format");
+}
@@ -0,0 +1,102 @@
+#include <string.h>
+
+#include "../test.h"
+#include "../../src/telemetry_history.h"
+#include "../../src/error.h"
+
+using namespace std;
+
+static HistoryRecord poseAt(unsigned long at) {
+    const PoseTelemetry pose = {{(float)at, 0.0f, 0.0f}, at};
+    return historyOfPose(pose);
+}
+
+void TestHistoryAppendRead() {
+    TelemetryHistory history;
+    HistoryRecord record;
+
+    if(history.ready() || history.read(0, record)) {
+        testError("TelemetryHistory: should not be ready before begin()%s", "");
+    }
+    if((SUCCESS != history.begin(4)) || !history.ready() || (4 != history.capacity())) {
+        testError("TelemetryHistory.begin() failed%s", "");
+    }
+
+    for(unsigned long i = 0; i < 6; i += 1) {
+        history.append(poseAt(100 + 10 * i));
+    }
+
+    //
+    // ring keeps the 4 most recent records
+    //
+    if((4 != history.count()) || (6 != history.sequence()) || (2 != history.oldest())) {
+        testError("TelemetryHistory: count %u, oldest %lu", history.count(), history.oldest());
+    }
+    if(history.read(1, record)) {
+        testError("TelemetryHistory.read() should fail on overwritten record%s", "");
+    }
+    if(!history.read(2, record) || (120 != record.at) || (TELEMETRY_POSE != record.channel)) {
+        testError("TelemetryHistory.read() oldest record is wrong, at %u", record.at);
+    }
+    if(history.read(6, record)) {
+        testError("TelemetryHistory.read() should fail on unwritten record%s", "");
+    }
+}
+
+void TestHistoryFind() {
+    TelemetryHistory history;
+    history.begin(8);
+    for(unsigned long i = 0; i < 12; i += 1) {
+        history.append(poseAt(100 + 10 * i));   // kept: 140 .. 210
+    }
+
+    if(4 != history.find(0)) {
+        testError("TelemetryHistory.find() before oldest should be oldest, got %lu", history.find(0));
+    }
+    if(6 != history.find(155)) {
+        testError("TelemetryHistory.find(155) should be 6, got %lu", history.find(155));
+    }
+    if(7 != history.find(160)) {
+        testError("TelemetryHistory.find(160) should be 7, got %lu", history.find(160));
+    }
+    if(history.sequence() != history.find(210)) {
+        testError("TelemetryHistory.find() after newest should be sequence(), got %lu", history.find(210));
+    }
+}
+
+void TestPackHistory() {
+    const WheelTelemetry wheel = {RIGHT_WHEEL_SPEC, true, 237, 88.5f, 92.25f, 227.0f, 2140355};
+    const HistoryRecord record = historyOfWheel(wheel);
+
+    uint8_t buffer[TELEMETRY_HISTORY_HEADER_BYTES + TELEMETRY_HISTORY_RECORD_BYTES];
+    int length = packHistoryHeader(buffer, sizeof(buffer), TELEMETRY_WHEEL, TELEMETRY_HISTORY_LAST, 1);
+    length += packHistoryRecord(buffer + length, sizeof(buffer) - length, record);
+    if(TELEMETRY_HISTORY_HEADER_BYTES + TELEMETRY_HISTORY_RECORD_BYTES != length) {
+        testError("packHistory: length is wrong, %d", length);
+    }
+    if((TELEMETRY_RECORD_HISTORY != buffer[0]) || (TELEMETRY_WHEEL != buffer[1]) || (TELEMETRY_HISTORY_LAST != buffer[2]) || (1 != buffer[3])) {
+        testError("packHistoryHeader: header is wrong%s", "");
+    }
+
+    uint32_t at;
+    float speed;
+    memcpy(&at, buffer + 4, sizeof(at));        // host is little-endian
+    memcpy(&speed, buffer + 16, sizeof(speed));
+    if((2140355 != at) || (1 != buffer[8]) || (1 != buffer[9]) || (237 != buffer[10]) || (92.25f != speed)) {
+        testError("packHistoryRecord: record is wrong%s", "");
+    }
+    if(-1 != packHistoryRecord(buffer, TELEMETRY_HISTORY_RECORD_BYTES - 1, record)) {
+        testError("packHistoryRecord: should fail on small buffer%s", "");
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ test.cpp src/telemetry_history.test.cpp ../src/telemetry_history.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+    TestHistoryAppendRead();
+    TestHistoryFind();
+    TestPackHistory();
+
+    return testResults("telemetry_history");
+}
@@ -0,0 +1,158 @@
+#include <string.h>
+
+#include "../test.h"
+#include "../../src/telemetry_queue.h"
+
+using namespace std;
+
+/**
+ * queue a one byte record that identifies it
+ */
+template <unsigned int COUNT, unsigned int BYTES>
+static bool queueRecord(TelemetryQueue<COUNT, BYTES> &queue, TelemetryChannel channel, TelemetryDropPolicy policy, uint8_t id) {
+    uint8_t *buffer = queue.reserve(channel, policy, true);
+    if(nullptr == buffer) {
+        return false;
+    }
+    buffer[0] = id;
+    queue.commit(1);
+    return true;
+}
+
+/**
+ * pop all records, writing their ids into ids
+ */
+template <unsigned int COUNT, unsigned int BYTES>
+static int drain(TelemetryQueue<COUNT, BYTES> &queue, uint8_t *ids) {
+    int n = 0;
+    int length;
+    bool binary;
+    const uint8_t *record;
+    while(nullptr != (record = queue.front(length, binary))) {
+        if(length > 0) {
+            ids[n++] = record[0];
+        }
+        queue.pop();
+    }
+    return n;
+}
+
+void TestQueueOrder() {
+    TelemetryQueue<4, 8> queue;
+    uint8_t ids[4];
+
+    for(uint8_t i = 0; i < 4; i += 1) {
+        queueRecord(queue, TELEMETRY_WHEEL, TELEMETRY_DROP_OLDEST, i);
+    }
+    if((4 != queue.count()) || (4 != queue.highWater())) {
+        testError("TelemetryQueue: count is wrong: %d", queue.count());
+    }
+    const int n = drain(queue, ids);
+    if((4 != n) || (0 != ids[0]) || (3 != ids[3])) {
+        testError("TelemetryQueue: records out of order, %d records", n);
+    }
+    if((0 != queue.count()) || (0 != queue.lost(TELEMETRY_WHEEL))) {
+        testError("TelemetryQueue: should be empty with no loss%s", "");
+    }
+
+    //
+    // a record that fails to format is skipped
+    //
+    queue.reserve(TELEMETRY_POSE, TELEMETRY_DROP_OLDEST, true);
+    queue.commit(-1);
+    if(0 != drain(queue, ids)) {
+        testError("TelemetryQueue: empty record should be skipped%s", "");
+    }
+}
+
+void TestQueueDropOldest() {
+    TelemetryQueue<4, 8> queue;
+    uint8_t ids[4];
+
+    //
+    // periodic samples replace the oldest sample,
+    // preferring their own channel
+    //
+    queueRecord(queue, TELEMETRY_POSE, TELEMETRY_DROP_OLDEST, 1);
+    queueRecord(queue, TELEMETRY_WHEEL, TELEMETRY_DROP_OLDEST, 2);
+    queueRecord(queue, TELEMETRY_WHEEL, TELEMETRY_DROP_OLDEST, 3);
+    queueRecord(queue, TELEMETRY_POSE, TELEMETRY_DROP_OLDEST, 4);
+    queueRecord(queue, TELEMETRY_WHEEL, TELEMETRY_DROP_OLDEST, 5);
+
+    const int n = drain(queue, ids);
+    if((4 != n) || (1 != ids[0]) || (3 != ids[1]) || (4 != ids[2]) || (5 != ids[3])) {
+        testError("TelemetryQueue: oldest wheel sample should be dropped, %d records", n);
+    }
+    if((1 != queue.lost(TELEMETRY_WHEEL)) || (0 != queue.lost(TELEMETRY_POSE))) {
+        testError("TelemetryQueue: wheel loss should be 1, is %lu", queue.lost(TELEMETRY_WHEEL));
+    }
+}
+
+void TestQueueNeverDrop() {
+    TelemetryQueue<4, 8> queue;
+    uint8_t ids[4];
+
+    //
+    // a state change evicts a periodic sample
+    //
+    for(uint8_t i = 0; i < 4; i += 1) {
+        queueRecord(queue, TELEMETRY_WHEEL, TELEMETRY_DROP_OLDEST, i);
+    }
+    if(!queueRecord(queue, TELEMETRY_LOG, TELEMETRY_NEVER_DROP, 99)) {
+        testError("TelemetryQueue: halt should not be dropped%s", "");
+    }
+    int n = drain(queue, ids);
+    if((4 != n) || (1 != ids[0]) || (99 != ids[3])) {
+        testError("TelemetryQueue: halt should replace oldest sample, %d records", n);
+    }
+
+    //
+    // if everything must be kept, the new record is lost
+    //
+    for(uint8_t i = 0; i < 4; i += 1) {
+        queueRecord(queue, TELEMETRY_SET, TELEMETRY_NEVER_DROP, i);
+    }
+    if(queueRecord(queue, TELEMETRY_WHEEL, TELEMETRY_DROP_OLDEST, 50) || queueRecord(queue, TELEMETRY_LOG, TELEMETRY_NEVER_DROP, 51)) {
+        testError("TelemetryQueue: should drop when nothing can be evicted%s", "");
+    }
+    if((2 != queue.lost(TELEMETRY_WHEEL)) || (1 != queue.lost(TELEMETRY_LOG)) || (0 != queue.lost(TELEMETRY_SET))) {
+        testError("TelemetryQueue: loss counts are wrong, log %lu", queue.lost(TELEMETRY_LOG));
+    }
+    n = drain(queue, ids);
+    if((4 != n) || (0 != ids[0]) || (3 != ids[3])) {
+        testError("TelemetryQueue: kept records are wrong, %d records", n);
+    }
+}
+
+void TestLossFormat() {
+    LossTelemetry loss = {{3, 1, 0, 0, 2}, 2, 8, 5230, 1234567};
+
+    char text[160];
+    const int length = formatLoss(text, sizeof(text), loss);
+    if((length < 0) || (0 != strcmp("loss({\"lost\":{\"wheel\":3,\"pose\":1,\"goto\":0,\"set\":0,\"log\":2},\"depth\":2,\"high\":8,\"sendUs\":5230,\"at\":1234567})", text))) {
+        testError("formatLoss: got %s", text);
+    }
+
+    uint8_t buffer[TELEMETRY_LOSS_BYTES];
+    if(TELEMETRY_LOSS_BYTES != packLoss(buffer, sizeof(buffer), loss)) {
+        testError("packLoss: length should be %d", TELEMETRY_LOSS_BYTES);
+    }
+    if((TELEMETRY_RECORD_LOSS != buffer[0]) || (NUMBER_OF_TELEMETRY_CHANNELS != buffer[1]) || (2 != buffer[2]) || (8 != buffer[3]) || (3 != buffer[4]) || (2 != buffer[20])) {
+        testError("packLoss: record is wrong%s", "");
+    }
+    if(-1 != packLoss(buffer, sizeof(buffer) - 1, loss)) {
+        testError("packLoss: should fail on small buffer%s", "");
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ test.cpp src/telemetry_queue.test.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+    TestQueueOrder();
+    TestQueueDropOldest();
+    TestQueueNeverDrop();
+    TestLossFormat();
+
+    return testResults("telemetry_queue");
+}
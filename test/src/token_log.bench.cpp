@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+
+#include "../../src/token_log.h"
+#include "../../src/log.h"
+#include "../../src/string/strcopy.h"
+
+using namespace std;
+
+//
+// Cost of a tokenized log call compared to
+// building the same message as a string,
+// which is what the old LOG_ macros did.
+//
+
+static inline uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static TokenLog log;
+static volatile int sink;
+
+int main() {
+    // from test folder run:
+    // gcc -O2 -DTESTING -std=c++11 -lstdc++ src/token_log.bench.cpp ../src/token_log.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+    const unsigned int COUNT = 10000000;
+    TokenLogRecord record;
+
+    //
+    // log and drain in batches so the ring never fills;
+    // only the log calls are timed.
+    //
+    uint64_t logNs = 0;
+    for(unsigned int i = 0; i < COUNT; i += TOKEN_LOG_RECORDS) {
+        const uint64_t startNs = nowNs();
+        for(unsigned int j = 0; j < TOKEN_LOG_RECORDS; j += 1) {
+            log.log(INFO_LEVEL, LOG_COMMAND_TEXT, (int)j, i);
+        }
+        logNs += nowNs() - startNs;
+        while(log.pop(record)) {
+            sink = record.args[1];
+        }
+    }
+
+    //
+    // the string the old logWsEvent() built
+    //
+    char msg[128];
+    uint64_t startNs = nowNs();
+    for(unsigned int i = 0; i < COUNT; i += 1) {
+        int offset = strCopy(msg, sizeof(msg), "wsCommandEvent.WStype_TEXT");
+        offset = strCopyAt(msg, sizeof(msg), offset, ", clientId: ");
+        offset = strCopyIntAt(msg, sizeof(msg), offset, (int)(i & 7));
+        sink = offset;
+    }
+    const uint64_t stringNs = nowNs() - startNs;
+
+    //
+    // formatting the record where it is drained
+    //
+    startNs = nowNs();
+    for(unsigned int i = 0; i < COUNT; i += 1) {
+        record.args[1] = i;
+        sink = formatTokenLog(msg, sizeof(msg), record);
+    }
+    const uint64_t formatNs = nowNs() - startNs;
+
+    printf("token log call:     %6.1f ns\n", (double)logNs / COUNT);
+    printf("string message:     %6.1f ns\n", (double)stringNs / COUNT);
+    printf("format at drain:    %6.1f ns\n", (double)formatNs / COUNT);
+    printf("dropped: %u\n", log.dropped());
+
+    return 0;
+}
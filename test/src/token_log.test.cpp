@@ -0,0 +1,168 @@
+#include <string.h>
+#include <thread>
+
+#include "../test.h"
+#include "../../src/token_log.h"
+#include "../../src/log.h"
+#include "../../src/telemetry_format.h"
+
+using namespace std;
+
+void TestLogPop() {
+    TokenLog log;
+    TokenLogRecord record;
+
+    if(log.pop(record)) {
+        testError("TokenLog.pop() returned a record from an empty log%s", "");
+    }
+
+    log.tick(1234);
+    log.log(INFO_LEVEL, LOG_COMMAND_TEXT, 3, 17u);
+    if(!log.pop(record)) {
+        testError("TokenLog.pop() should return the logged record%s", "");
+    }
+    if((1234 != record.at) || (LOG_COMMAND_TEXT != record.token) || (INFO_LEVEL != record.level)
+        || (2 != record.argc) || (3 != record.args[0]) || (17 != record.args[1])) 
+    {
+        testError("TokenLog record is wrong, token %u, argc %u", record.token, record.argc);
+    }
+
+    //
+    // a full log drops and counts the new record
+    //
+    for(unsigned int i = 0; i < TOKEN_LOG_RECORDS; i += 1) {
+        log.log(ERROR_LEVEL, LOG_WIFI_FAILED);
+    }
+    if(log.log(ERROR_LEVEL, LOG_WIFI_FAILED) || (1 != log.dropped())) {
+        testError("TokenLog should drop when full, dropped %u", log.dropped());
+    }
+}
+
+void TestFormat() {
+    char buffer[128];
+    TokenLogRecord record = {0, LOG_COMMAND_UNHANDLED, INFO_LEVEL, 2, {(uint32_t)-1, 4}};
+
+    int length = formatTokenLog(buffer, sizeof(buffer), record);
+    if((length != (int)strlen(buffer)) || (0 != strcmp("wsCommandEvent.UNHANDLED EVENT -1, clientId: 4", buffer))) {
+        testError("formatTokenLog() signed format is wrong: %s", buffer);
+    }
+
+    record.token = LOG_CAMERA_INIT_FAILED;
+    record.argc = 1;
+    record.args[0] = 0x105;
+    formatTokenLog(buffer, sizeof(buffer), record);
+    if(0 != strcmp("Camera init failed with error 0x105", buffer)) {
+        testError("formatTokenLog() hex format is wrong: %s", buffer);
+    }
+
+    // missing arguments format as zero
+    record.argc = 0;
+    formatTokenLog(buffer, sizeof(buffer), record);
+    if(0 != strcmp("Camera init failed with error 0x0", buffer)) {
+        testError("formatTokenLog() missing argument is wrong: %s", buffer);
+    }
+
+    // floats are passed as their bits
+    if(tokenLogArg(1.5f) != 0x3FC00000) {
+        testError("tokenLogArg(float) should pass the bits, got %x", tokenLogArg(1.5f));
+    }
+
+    // too small a buffer fails rather than truncating
+    if(-1 != formatTokenLog(buffer, 10, record)) {
+        testError("formatTokenLog() should fail on small buffer%s", "");
+    }
+
+    record.token = NUMBER_OF_LOG_TOKENS;
+    formatTokenLog(buffer, sizeof(buffer), record);
+    if(nullptr == strstr(buffer, "unknown log token")) {
+        testError("formatTokenLog() should name an unknown token: %s", buffer);
+    }
+}
+
+void TestPack() {
+    uint8_t buffer[TELEMETRY_TOKEN_LOG_HEADER_BYTES + 4 * TOKEN_LOG_ARGS];
+    const TokenLogRecord record = {2140355, LOG_STREAM_TEXT, WARN_LEVEL, 2, {7, 300, 0, 0}};
+
+    const int length = packTokenLog(buffer, sizeof(buffer), record);
+    if(TELEMETRY_TOKEN_LOG_HEADER_BYTES + 8 != length) {
+        testError("packTokenLog: length is wrong, %d", length);
+    }
+
+    uint16_t token;
+    uint32_t at, arg;
+    memcpy(&token, buffer + 2, sizeof(token));     // host is little-endian
+    memcpy(&at, buffer + 4, sizeof(at));
+    memcpy(&arg, buffer + 13, sizeof(arg));
+    if((TELEMETRY_RECORD_TOKEN_LOG != buffer[0]) || (WARN_LEVEL != buffer[1]) || (LOG_STREAM_TEXT != token)
+        || (2140355 != at) || (2 != buffer[8]) || (300 != arg)) 
+    {
+        testError("packTokenLog: record is wrong%s", "");
+    }
+    if(-1 != packTokenLog(buffer, length - 1, record)) {
+        testError("packTokenLog: should fail on small buffer%s", "");
+    }
+}
+
+void TestConcurrentLog() {
+    //
+    // both cores log while the telemetry side drains;
+    // every record arrives whole, or is counted as dropped.
+    //
+    const unsigned int COUNT = 200000;
+    static TokenLog log;
+    static std::atomic<unsigned int> logged(0);
+    static std::atomic<bool> done(false);
+
+    auto producer = [COUNT](int id) {
+        for(unsigned int i = 0; i < COUNT; i += 1) {
+            if(log.log(DEBUG_LEVEL, LOG_COMMAND_TEXT, id, i)) {
+                logged.fetch_add(1);
+            }
+        }
+    };
+    thread a(producer, 1);
+    thread b(producer, 2);
+    thread waiter([&]() { a.join(); b.join(); done.store(true); });
+
+    unsigned int received = 0;
+    unsigned int torn = 0;
+    unsigned int last[3] = {0, 0, 0};
+    bool started[3] = {false, false, false};
+    TokenLogRecord record;
+    for(;;) {
+        if(log.pop(record)) {
+            const unsigned int id = record.args[0];
+            if((LOG_COMMAND_TEXT != record.token) || (2 != record.argc) || (id < 1) || (id > 2)
+                || (started[id] && (record.args[1] <= last[id]))) 
+            {
+                torn += 1;
+            } else {
+                started[id] = true;
+                last[id] = record.args[1];
+            }
+            received += 1;
+        } else if(done.load() && (0 == log.count())) {
+            break;
+        }
+    }
+    waiter.join();
+
+    if(0 != torn) {
+        testError("TokenLog saw %u torn or out of order records", torn);
+    }
+    if((received != logged.load()) || (received + log.dropped() != 2 * COUNT)) {
+        testError("TokenLog received %u of %u logged records", received, logged.load());
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -pthread -lstdc++ test.cpp src/token_log.test.cpp ../src/token_log.cpp ../src/telemetry_format.cpp ../src/string/strcopy.cpp; ./a.out; rm a.out
+
+    TestLogPop();
+    TestFormat();
+    TestPack();
+    TestConcurrentLog();
+
+    return testResults("token_log");
+}
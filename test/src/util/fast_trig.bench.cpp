@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <chrono>
+
+#include "../../../src/util/fast_trig.h"
+
+using namespace std;
+
+//
+// Time per call of the fast trig kernels versus libm
+// over the same angles, and of wrapping an angle with
+// fastWrapAngle() versus the atan2(sin, cos) that
+// limitAngle() used before.
+//
+
+static inline uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static volatile float sink = 0;   // keep the optimizer from removing the work
+
+const int COUNT = 1000000;
+static float angles[COUNT];     // headings a little past -π to π, like a heading plus a turn
+static float xs[COUNT];         // vectors in every octant
+static float ys[COUNT];
+
+static void report(const char *name, uint64_t fastNs, uint64_t libmNs) {
+    printf("fast_trig: %-6s fast %.1f ns/call, libm %.1f ns/call\n",
+        name, (double)fastNs / COUNT, (double)libmNs / COUNT);
+}
+
+int main() {
+    // from test folder run:
+    // gcc -O2 -DTESTING -std=c++11 -lstdc++ src/util/fast_trig.bench.cpp -lm; ./a.out; rm a.out
+
+    for(int i = 0; i < COUNT; i += 1) {
+        angles[i] = (float)(-1.25 * PI + 2.5 * PI * i / COUNT);
+        xs[i] = 100.0f * cosf(angles[i] * 7);
+        ys[i] = 100.0f * sinf(angles[i] * 7);
+    }
+
+    float sum = 0;
+    uint64_t startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        sum += fastSin(angles[i]);
+    }
+    const uint64_t fastSinNs = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        sum += sinf(angles[i]);
+    }
+    const uint64_t sinNs = nowNs() - startNs;
+
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        sum += fastCos(angles[i]);
+    }
+    const uint64_t fastCosNs = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        sum += cosf(angles[i]);
+    }
+    const uint64_t cosNs = nowNs() - startNs;
+
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        sum += fastAtan2(ys[i], xs[i]);
+    }
+    const uint64_t fastAtan2Ns = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        sum += atan2f(ys[i], xs[i]);
+    }
+    const uint64_t atan2Ns = nowNs() - startNs;
+
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        sum += fastWrapAngle(angles[i]);
+    }
+    const uint64_t fastWrapNs = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        sum += atan2f(sinf(angles[i]), cosf(angles[i]));
+    }
+    const uint64_t wrapNs = nowNs() - startNs;
+    sink += sum;
+
+    report("sin", fastSinNs, sinNs);
+    report("cos", fastCosNs, cosNs);
+    report("atan2", fastAtan2Ns, atan2Ns);
+    report("wrap", fastWrapNs, wrapNs);
+
+    return 0;
+}
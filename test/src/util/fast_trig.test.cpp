@@ -0,0 +1,131 @@
+#include <math.h>
+
+#include "../../test.h"
+#include "../../../src/util/fast_trig.h"
+
+using namespace std;
+
+//
+// error bounds documented in fast_trig.h
+//
+const double SIN_COS_BOUND = 2.5e-7;           // -π to π
+const double SIN_COS_WRAPPED_BOUND = 1e-6;      // -4π to 4π
+const double ATAN2_BOUND = 2.5e-6;
+
+/**
+ * difference between two angles, allowing for
+ * π and -π being the same direction
+ */
+static double angleError(double a, double b) {
+    double error = fabs(a - b);
+    return (error > PI) ? fabs(error - 2 * PI) : error;
+}
+
+void TestWrapAngle() {
+    double worst = 0;
+    for(int i = -400000; i <= 400000; i += 1) {
+        const float angle = i * 0.0001f;    // -40 to 40 radians
+        const float wrapped = fastWrapAngle(angle);
+        if((wrapped > (float)PI) || (wrapped < -(float)PI)) {
+            testError("fastWrapAngle(%f) = %f is out of range", angle, wrapped);
+            return;
+        }
+        const double error = angleError(wrapped, atan2(sin((double)angle), cos((double)angle)));
+        if(error > worst) {
+            worst = error;
+        }
+    }
+    printf("fastWrapAngle: worst error %.2e radians\n", worst);
+    if(worst > 1e-5) {  // float rounding of the angle itself at 40 radians
+        testError("fastWrapAngle: worst error %.2e", worst);
+    }
+
+    // in range is unchanged
+    if((1.0f != fastWrapAngle(1.0f)) || (-3.0f != fastWrapAngle(-3.0f)) || ((float)PI != fastWrapAngle((float)PI))) {
+        testError("fastWrapAngle: changed an angle already in range%s", "");
+    }
+}
+
+void TestSinCos() {
+    //
+    // outside of -π to π the error is mostly the float
+    // rounding of subtracting 2π, so it has a looser bound
+    //
+    double worstSin = 0;
+    double worstCos = 0;
+    double worstWrappedSin = 0;
+    double worstWrappedCos = 0;
+    for(int i = -1000000; i <= 1000000; i += 1) {
+        const float angle = (float)(4 * PI * i / 1000000.0);  // -4π to 4π
+        const double sinError = fabs(fastSin(angle) - sin((double)angle));
+        const double cosError = fabs(fastCos(angle) - cos((double)angle));
+        const bool inRange = (angle >= -(float)PI) && (angle <= (float)PI);
+        double &sinWorst = inRange ? worstSin : worstWrappedSin;
+        double &cosWorst = inRange ? worstCos : worstWrappedCos;
+        if(sinError > sinWorst) {
+            sinWorst = sinError;
+        }
+        if(cosError > cosWorst) {
+            cosWorst = cosError;
+        }
+    }
+    printf("fastSin: worst error %.2e, %.2e wrapped; fastCos: worst error %.2e, %.2e wrapped\n", 
+        worstSin, worstWrappedSin, worstCos, worstWrappedCos);
+    if((worstSin > SIN_COS_BOUND) || (worstWrappedSin > SIN_COS_WRAPPED_BOUND)) {
+        testError("fastSin: worst error %.2e, %.2e wrapped, is over bound", worstSin, worstWrappedSin);
+    }
+    if((worstCos > SIN_COS_BOUND) || (worstWrappedCos > SIN_COS_WRAPPED_BOUND)) {
+        testError("fastCos: worst error %.2e, %.2e wrapped, is over bound", worstCos, worstWrappedCos);
+    }
+
+    // small angles keep their relative accuracy, which the odometry chord relies on
+    for(float angle = 1e-6f; angle < 1e-2f; angle *= 1.5f) {
+        const double relative = fabs(fastSin(angle) / angle - sin((double)angle) / angle);
+        if(relative > 1e-6) {
+            testError("fastSin(%e) relative error %.2e", angle, relative);
+            break;
+        }
+    }
+}
+
+void TestAtan2() {
+    double worst = 0;
+    const int STEPS = 2000;
+    for(int i = -STEPS; i <= STEPS; i += 1) {
+        for(int j = -STEPS; j <= STEPS; j += 1) {
+            const float y = i * 0.37f;
+            const float x = j * 0.53f;
+            if((0 == x) && (0 == y)) {
+                continue;
+            }
+            const double error = angleError(fastAtan2(y, x), atan2((double)y, (double)x));
+            if(error > worst) {
+                worst = error;
+            }
+        }
+    }
+    printf("fastAtan2: worst error %.2e radians\n", worst);
+    if(worst > ATAN2_BOUND) {
+        testError("fastAtan2: worst error %.2e is over bound %.2e", worst, ATAN2_BOUND);
+    }
+
+    // axes and origin
+    if((0 != fastAtan2(0, 0)) || (0 != fastAtan2(0, 1))
+        || (fabs(fastAtan2(1, 0) - PI / 2) > ATAN2_BOUND)
+        || (fabs(fastAtan2(-1, 0) + PI / 2) > ATAN2_BOUND)
+        || (fabs(fastAtan2(0, -1) - PI) > ATAN2_BOUND))
+    {
+        testError("fastAtan2: wrong on an axis%s", "");
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ test.cpp src/util/fast_trig.test.cpp -lm; ./a.out; rm a.out
+
+    TestWrapAngle();
+    TestSinCos();
+    TestAtan2();
+
+    return testResults("fast_trig");
+}
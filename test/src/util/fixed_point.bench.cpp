@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#include <chrono>
+
+#include "../../../src/util/fixed_point.h"
+#include "../../../src/util/fast_trig.h"
+
+using namespace std;
+
+//
+// Time per operation of Q16 fixed point versus float,
+// with the util/fast_trig.h kernels for float trig,
+// over the same values.  The host has a fast FPU, so
+// this shows the relative cost of the integer code;
+// on a processor without an FPU float is emulated
+// and the comparison goes the other way.
+//
+
+typedef Fixed<16> q16;
+
+static inline uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static volatile float sink = 0;   // keep the optimizer from removing the work
+
+const int COUNT = 1000000;
+static float floats[COUNT];
+static q16 fixeds[COUNT];
+
+static void report(const char *name, uint64_t fixedNs, uint64_t floatNs) {
+    printf("fixed_point: %-6s q16 %.1f ns/op, float %.1f ns/op\n",
+        name, (double)fixedNs / COUNT, (double)floatNs / COUNT);
+}
+
+int main() {
+    // from test folder run:
+    // gcc -O2 -DTESTING -std=c++11 -lstdc++ src/util/fixed_point.bench.cpp -lm; ./a.out; rm a.out
+
+    for(int i = 0; i < COUNT; i += 1) {
+        floats[i] = (float)(-1.25 * PI + 2.5 * PI * i / COUNT);    // angles, or cm, a little past ±π
+        fixeds[i] = q16(floats[i]);
+    }
+
+    float floatSum = 0;
+    q16 fixedSum = 0;
+    uint64_t startNs = nowNs();
+    for(int i = 1; i < COUNT; i += 1) {
+        fixedSum += fixeds[i] * fixeds[i - 1];
+    }
+    const uint64_t fixedMultiplyNs = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 1; i < COUNT; i += 1) {
+        floatSum += floats[i] * floats[i - 1];
+    }
+    const uint64_t floatMultiplyNs = nowNs() - startNs;
+
+    startNs = nowNs();
+    for(int i = 1; i < COUNT; i += 1) {
+        fixedSum += fixeds[i] / fixeds[i - 1];
+    }
+    const uint64_t fixedDivideNs = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 1; i < COUNT; i += 1) {
+        floatSum += floats[i] / floats[i - 1];
+    }
+    const uint64_t floatDivideNs = nowNs() - startNs;
+
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        fixedSum += fixedSin(fixeds[i]);
+    }
+    const uint64_t fixedSinNs = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        floatSum += fastSin(floats[i]);
+    }
+    const uint64_t floatSinNs = nowNs() - startNs;
+
+    startNs = nowNs();
+    for(int i = 1; i < COUNT; i += 1) {
+        fixedSum += fixedAtan2(fixeds[i], fixeds[i - 1]);
+    }
+    const uint64_t fixedAtan2Ns = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 1; i < COUNT; i += 1) {
+        floatSum += fastAtan2(floats[i], floats[i - 1]);
+    }
+    const uint64_t floatAtan2Ns = nowNs() - startNs;
+
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        fixedSum += fixedSqrt(fixeds[i]);
+    }
+    const uint64_t fixedSqrtNs = nowNs() - startNs;
+    startNs = nowNs();
+    for(int i = 0; i < COUNT; i += 1) {
+        floatSum += sqrtf(fabsf(floats[i]));
+    }
+    const uint64_t floatSqrtNs = nowNs() - startNs;
+    sink += floatSum + fixedSum.toFloat();
+
+    report("mul", fixedMultiplyNs, floatMultiplyNs);
+    report("div", fixedDivideNs, floatDivideNs);
+    report("sin", fixedSinNs, floatSinNs);
+    report("atan2", fixedAtan2Ns, floatAtan2Ns);
+    report("sqrt", fixedSqrtNs, floatSqrtNs);
+
+    return 0;
+}
@@ -0,0 +1,176 @@
+#include <math.h>
+
+#include "../../test.h"
+#include "../../../src/util/fixed_point.h"
+#include "../rover/figure_eight.h"
+
+using namespace std;
+
+typedef Fixed<16> q16;
+
+//
+// Q16 resolution is 2^-16, about 1.5e-5; the integer
+// trig kernels should be within a couple of steps of it.
+//
+const double Q16_STEP = 1.0 / 65536;
+const double TRIG_BOUND = 2 * Q16_STEP;
+
+void TestArithmetic() {
+    const q16 a(3.25f);
+    const q16 b(-1.5f);
+    if((a + b) != q16(1.75f)) testError("q16: 3.25 + -1.5 = %f", (a + b).toFloat());
+    if((a - b) != q16(4.75f)) testError("q16: 3.25 - -1.5 = %f", (a - b).toFloat());
+    if((a * b) != q16(-4.875f)) testError("q16: 3.25 * -1.5 = %f", (a * b).toFloat());
+    if(fabs((a / b).toDouble() - (3.25 / -1.5)) > Q16_STEP / 2) testError("q16: 3.25 / -1.5 = %f", (a / b).toFloat());
+    if((a * 2) != q16(6.5f)) testError("q16: 3.25 * 2 = %f", (a * 2).toFloat());
+    if(-b != q16(1.5f)) testError("q16: -(-1.5) = %f", (-b).toFloat());
+    if(q16(-2.5f).toInt() != -3) testError("q16: toInt(-2.5) = %d", q16(-2.5f).toInt());
+
+    // works with the math.h templates
+    if(abs(b) != q16(1.5f)) testError("q16: abs(-1.5) = %f", abs(b).toFloat());
+    if(bound<q16>(a, 0, 1) != q16(1)) testError("q16: bound(3.25, 0, 1) = %f", bound<q16>(a, 0, 1).toFloat());
+    if(0 != compareTo<q16>(a, 3.3f, 0.1f)) testError("q16: compareTo(3.25, 3.3, 0.1) is not zero%s", "");
+
+    // products and quotients round to nearest over a range of values
+    double worst = 0;
+    for(int i = -200; i <= 200; i += 1) {
+        for(int j = -200; j <= 200; j += 1) {
+            const double x = i * 0.37;
+            const double y = j * 0.11 + 0.005;
+            const double productError = fabs((q16(x) * q16(y)).toDouble() - q16(x).toDouble() * q16(y).toDouble());
+            const double quotientError = fabs((q16(x) / q16(y)).toDouble() - q16(x).toDouble() / q16(y).toDouble());
+            worst = fmax(worst, fmax(productError, quotientError));
+        }
+    }
+    if(worst > Q16_STEP / 2) {
+        testError("q16: product or quotient is %.2e from exact, more than half a step", worst);
+    }
+}
+
+void TestSaturation() {
+    const q16 big(30000);
+    if((big + big) != q16::maximum()) testError("q16: 30000 + 30000 did not saturate; %f", (big + big).toFloat());
+    if((-big - big) != q16::minimum()) testError("q16: -30000 - 30000 did not saturate; %f", (-big - big).toFloat());
+    if((big * -big) != q16::minimum()) testError("q16: 30000 * -30000 did not saturate; %f", (big * -big).toFloat());
+    if((big / q16(0.001f)) != q16::maximum()) testError("q16: 30000 / 0.001 did not saturate; %f", (big / q16(0.001f)).toFloat());
+    if((q16(1) / q16(0)) != q16::maximum()) testError("q16: 1 / 0 is not maximum%s", "");
+    if((q16(-1) / q16(0)) != q16::minimum()) testError("q16: -1 / 0 is not minimum%s", "");
+    if(q16(1.0e9f) != q16::maximum()) testError("q16: 1e9 did not saturate%s", "");
+    if(q16(-1.0e9) != q16::minimum()) testError("q16: -1e9 did not saturate%s", "");
+    if(-q16::minimum() != q16::maximum()) testError("q16: -minimum is not maximum%s", "");
+
+    // an integral term that runs away pins at the limit rather than wrapping negative
+    q16 integral = 0;
+    for(int i = 0; i < 100000; i += 1) {
+        integral += q16(1000);
+    }
+    if(integral != q16::maximum()) testError("q16: runaway integral is %f, not maximum", integral.toFloat());
+}
+
+void TestTrig() {
+    double worstSin = 0;
+    double worstCos = 0;
+    for(int i = -100000; i <= 100000; i += 1) {
+        const double angle = 4 * PI * i / 100000.0;  // -4π to 4π
+        const q16 fixedAngle(angle);
+        worstSin = fmax(worstSin, fabs(fixedSin(fixedAngle).toDouble() - sin(fixedAngle.toDouble())));
+        worstCos = fmax(worstCos, fabs(fixedCos(fixedAngle).toDouble() - cos(fixedAngle.toDouble())));
+    }
+    printf("q16: fixedSin worst error %.2e, fixedCos worst error %.2e\n", worstSin, worstCos);
+    if(worstSin > TRIG_BOUND) testError("q16: fixedSin worst error %.2e is over bound %.2e", worstSin, TRIG_BOUND);
+    if(worstCos > TRIG_BOUND) testError("q16: fixedCos worst error %.2e is over bound %.2e", worstCos, TRIG_BOUND);
+
+    double worstAtan2 = 0;
+    for(int i = -300; i <= 300; i += 1) {
+        for(int j = -300; j <= 300; j += 1) {
+            if((0 == i) && (0 == j)) continue;
+            const q16 y(i * 0.73);
+            const q16 x(j * 0.41);
+            double error = fabs(fixedAtan2(y, x).toDouble() - atan2(y.toDouble(), x.toDouble()));
+            error = (error > PI) ? fabs(error - 2 * PI) : error;
+            worstAtan2 = fmax(worstAtan2, error);
+        }
+    }
+    printf("q16: fixedAtan2 worst error %.2e radians\n", worstAtan2);
+    if(worstAtan2 > TRIG_BOUND) testError("q16: fixedAtan2 worst error %.2e is over bound %.2e", worstAtan2, TRIG_BOUND);
+    if(fixedAtan2(q16(0), q16(0)) != q16(0)) testError("q16: fixedAtan2(0, 0) is not zero%s", "");
+
+    double worstSqrt = 0;
+    for(int i = 1; i < 100000; i += 1) {
+        const q16 value(i * 0.3);
+        worstSqrt = fmax(worstSqrt, fabs(fixedSqrt(value).toDouble() - sqrt(value.toDouble())));
+    }
+    if(worstSqrt > Q16_STEP / 2) testError("q16: fixedSqrt worst error %.2e is more than half a step", worstSqrt);
+    if(fixedSqrt(q16(-4)) != q16(0)) testError("q16: fixedSqrt(-4) is not zero%s", "");
+}
+
+/**
+ * Integrate wheel distances to a pose with
+ * the midpoint heading, in either number type.
+ */
+template <typename T, typename SIN, typename COS> static void integrate(
+    T &x, T &y, T &angle, T left, T right, T wheelBase, SIN sine, COS cosine)
+{
+    const T distance = (left + right) / 2;
+    const T deltaAngle = (right - left) / wheelBase;
+    const T heading = angle + deltaAngle / 2;
+    x += distance * cosine(heading);
+    y += distance * sine(heading);
+    angle = angle + deltaAngle;
+}
+
+void TestPoseAgainstFloat() {
+    //
+    // drive the same figure-eights through float and Q16
+    // pose math.  Both drift from the true pose, mostly
+    // because the encoders only count whole ticks; Q16's
+    // rounding should add little to that.
+    //
+    FigureEight eight = figureEight(20, 30);
+    float fx = 0, fy = 0, fangle = 0;
+    q16 qx = 0, qy = 0, qangle = 0;
+    const q16 qWheelBase(eight.wheelBase);
+    EncoderSample last = figureEightSample(eight);
+    double floatError = 0;
+    double fixedError = 0;
+    const int COUNT = (int)(10 * 2 * (2000 * PI * eight.radius / eight.speed) / POSE_POLL_MS);  // 10 figure-eights
+    for(int i = 0; i < COUNT; i += 1) {
+        for(unsigned int j = 0; j < POSE_POLL_MS; j += 1) {
+            figureEightStep(eight);
+        }
+        const EncoderSample sample = figureEightSample(eight);
+        const float left = (sample.leftCount - last.leftCount) * eight.distancePerTick;
+        const float right = (sample.rightCount - last.rightCount) * eight.distancePerTick;
+        last = sample;
+
+        integrate<float>(fx, fy, fangle, left, right, eight.wheelBase,
+            [](float a) { return sinf(a); }, [](float a) { return cosf(a); });
+        integrate<q16>(qx, qy, qangle, q16(left), q16(right), qWheelBase,
+            [](q16 a) { return fixedSin(a); }, [](q16 a) { return fixedCos(a); });
+        fangle = atan2f(sinf(fangle), cosf(fangle));
+        qangle = fixedWrapAngle(qangle);
+
+        const double floatDistance = hypot(fx - eight.truth.x, fy - eight.truth.y);
+        const double fixedDistance = hypot(qx.toDouble() - eight.truth.x, qy.toDouble() - eight.truth.y);
+        floatError += floatDistance * floatDistance;
+        fixedError += fixedDistance * fixedDistance;
+    }
+    floatError = sqrt(floatError / COUNT);
+    fixedError = sqrt(fixedError / COUNT);
+    printf("q16: 10 figure-eights, rms position error %.2f cm float, %.2f cm q16\n", floatError, fixedError);
+    if(fixedError > floatError * 1.1) {
+        testError("q16: rms position error %.2f cm is more than 10%% over float's %.2f cm", fixedError, floatError);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ test.cpp src/util/fixed_point.test.cpp -lm; ./a.out; rm a.out
+
+    TestArithmetic();
+    TestSaturation();
+    TestTrig();
+    TestPoseAgainstFloat();
+
+    return testResults("fixed_point");
+}
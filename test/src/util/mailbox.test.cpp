@@ -0,0 +1,103 @@
+#include <string.h>
+#include <thread>
+
+#include "../../test.h"
+#include "../../../src/util/mailbox.h"
+
+using namespace std;
+
+void TestPostTake() {
+    Mailbox<int> mailbox;
+    int values[3] = {0, 1, 2};
+
+    if(nullptr != mailbox.take()) {
+        testError("Mailbox.take() returned a value from an empty mailbox%s", "");
+    }
+
+    // the newest value replaces the one that was not taken
+    if(nullptr != mailbox.post(&values[0])) {
+        testError("Mailbox.post() replaced a value in an empty mailbox%s", "");
+    }
+    if(&values[0] != mailbox.post(&values[1])) {
+        testError("Mailbox.post() should return the value it replaced%s", "");
+    }
+    if(&values[1] != mailbox.take()) {
+        testError("Mailbox.take() should return the newest value%s", "");
+    }
+    if(nullptr != mailbox.take()) {
+        testError("Mailbox.take() returned the same value twice%s", "");
+    }
+    mailbox.post(&values[2]);
+    if((3 != mailbox.count()) || (1 != mailbox.dropped())) {
+        testError("Mailbox counts are wrong: %d posted, %d dropped", mailbox.count(), mailbox.dropped());
+    }
+}
+
+void TestConcurrentStress() {
+    //
+    // one producer thread and one consumer thread;
+    // every value is either taken or handed back
+    // to the producer exactly once, and values are
+    // taken in the order they were posted.
+    //
+    const unsigned int COUNT = 1000000;
+    static unsigned int values[COUNT];
+    static Mailbox<unsigned int> mailbox;
+    static unsigned char seen[COUNT];
+    memset(seen, 0, sizeof(seen));
+
+    atomic<bool> done(false);
+    thread producer([&]() {
+        for(unsigned int i = 0; i < COUNT; i += 1) {
+            values[i] = i;
+            unsigned int *replaced = mailbox.post(&values[i]);
+            if(nullptr != replaced) {
+                seen[*replaced] += 1;
+            }
+        }
+        done.store(true);
+    });
+
+    unsigned int taken = 0;
+    unsigned int last = 0;
+    bool first = true;
+    for(;;) {
+        const bool finished = done.load();
+        unsigned int *value = mailbox.take();
+        if(nullptr != value) {
+            if(!first && (*value <= last)) {
+                testError("Mailbox: took %u after %u", *value, last);
+            }
+            first = false;
+            last = *value;
+            seen[*value] += 1;
+            taken += 1;
+        } else if(finished) {
+            break;
+        }
+    }
+    producer.join();
+
+    unsigned int wrong = 0;
+    for(unsigned int i = 0; i < COUNT; i += 1) {
+        if(1 != seen[i]) {
+            wrong += 1;
+        }
+    }
+    if(0 != wrong) {
+        testError("Mailbox: %u values were lost or seen twice", wrong);
+    }
+    if((COUNT != mailbox.count()) || (COUNT != taken + mailbox.dropped())) {
+        testError("Mailbox: %u taken plus %u dropped is not %u", taken, mailbox.dropped(), COUNT);
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -pthread -lstdc++ test.cpp src/util/mailbox.test.cpp; ./a.out; rm a.out
+
+    TestPostTake();
+    TestConcurrentStress();
+
+    return testResults("mailbox");
+}
@@ -0,0 +1,191 @@
+#include <string.h>
+#include <thread>
+
+#include "../../test.h"
+#include "../../../src/util/mpsc_ring.h"
+
+using namespace std;
+
+void TestPushPop() {
+    MpscRing<int, 4> ring;
+    int value = -1;
+
+    if(ring.pop(value)) {
+        testError("MpscRing.pop() returned a value from an empty ring: %d", value);
+    }
+
+    for(int i = 0; i < 4; i += 1) {
+        if(!ring.push(i)) {
+            testError("MpscRing.push() failed before ring was full at %d", i);
+        }
+    }
+    if(4 != ring.count()) {
+        testError("MpscRing.count() is wrong: 4 != %d", ring.count());
+    }
+
+    //
+    // full ring should reject and count the drop
+    //
+    if(ring.push(99)) {
+        testError("MpscRing.push() succeeded on a full ring%s", "");
+    }
+    if(1 != ring.dropped()) {
+        testError("MpscRing.dropped() is wrong: 1 != %d", ring.dropped());
+    }
+
+    //
+    // values come out in order they went in
+    //
+    for(int i = 0; i < 4; i += 1) {
+        if(!ring.pop(value) || (i != value)) {
+            testError("MpscRing.pop() returned wrong value: %d != %d", i, value);
+        }
+    }
+    if(!ring.empty()) {
+        testError("MpscRing should be empty, but count is %d", ring.count());
+    }
+}
+
+void TestWrapAround() {
+    //
+    // indices run freely; make sure many laps stay in order
+    //
+    MpscRing<unsigned int, 8> ring;
+    unsigned int expected = 0;
+    unsigned int value = 0;
+    for(unsigned int i = 0; i < 1000; i += 1) {
+        ring.push(i);
+        if(0 == (i % 3)) {
+            while(ring.pop(value)) {
+                if(value != expected) {
+                    testError("MpscRing wrap-around out of order: %u != %u", expected, value);
+                }
+                expected += 1;
+            }
+        }
+    }
+}
+
+void TestConcurrentProducers() {
+    //
+    // several producer threads and one consumer thread;
+    // every value must arrive exactly once, and the
+    // values of each producer must arrive in the
+    // order that producer pushed them.
+    //
+    const unsigned int PRODUCERS = 4;
+    const unsigned int COUNT = 500000;  // values per producer
+    static MpscRing<unsigned int, 64> ring;
+
+    thread *producers[PRODUCERS];
+    for(unsigned int p = 0; p < PRODUCERS; p += 1) {
+        producers[p] = new thread([p, COUNT]() {
+            for(unsigned int i = 1; i <= COUNT; ) {
+                if(ring.push((p << 24) | i)) {
+                    i += 1;
+                } else {
+                    this_thread::yield();
+                }
+            }
+        });
+    }
+
+    unsigned int next[PRODUCERS] = {1, 1, 1, 1};
+    unsigned int received = 0;
+    unsigned int errors = 0;
+    unsigned int value = 0;
+    while(received < PRODUCERS * COUNT) {
+        if(ring.pop(value)) {
+            const unsigned int p = value >> 24;
+            const unsigned int i = value & 0xFFFFFF;
+            if((p >= PRODUCERS) || (i != next[p])) {
+                errors += 1;
+            }
+            if(p < PRODUCERS) {
+                next[p] = i + 1;    // resync so we report each gap once
+            }
+            received += 1;
+        } else {
+            this_thread::yield();
+        }
+    }
+    for(unsigned int p = 0; p < PRODUCERS; p += 1) {
+        producers[p]->join();
+        delete producers[p];
+    }
+
+    if(0 != errors) {
+        testError("MpscRing concurrent producers saw %u out of order or corrupt values", errors);
+    }
+    for(unsigned int p = 0; p < PRODUCERS; p += 1) {
+        if(COUNT + 1 != next[p]) {
+            testError("MpscRing producer %u values were lost", p);
+        }
+    }
+    if(!ring.empty()) {
+        testError("MpscRing should be empty after stress, but count is %d", ring.count());
+    }
+}
+
+void TestConcurrentDrops() {
+    //
+    // producers that never retry; every push either
+    // arrives or is counted as dropped.
+    //
+    const unsigned int PRODUCERS = 2;
+    const unsigned int COUNT = 200000;
+    static MpscRing<unsigned int, 16> ring;
+    static std::atomic<unsigned int> pushed(0);
+    static std::atomic<bool> done(false);
+
+    thread *producers[PRODUCERS];
+    for(unsigned int p = 0; p < PRODUCERS; p += 1) {
+        producers[p] = new thread([COUNT]() {
+            for(unsigned int i = 0; i < COUNT; i += 1) {
+                if(ring.push(i)) {
+                    pushed.fetch_add(1);
+                }
+            }
+        });
+    }
+    thread waiter([&]() {
+        for(unsigned int p = 0; p < PRODUCERS; p += 1) {
+            producers[p]->join();
+            delete producers[p];
+        }
+        done.store(true);
+    });
+
+    unsigned int received = 0;
+    unsigned int value = 0;
+    for(;;) {
+        if(ring.pop(value)) {
+            received += 1;
+        } else if(done.load()) {
+            while(ring.pop(value)) {
+                received += 1;
+            }
+            break;
+        }
+    }
+    waiter.join();
+
+    if(received != pushed.load()) {
+        testError("MpscRing received %u values but %u were pushed", received, pushed.load());
+    }
+    if(received + ring.dropped() != PRODUCERS * COUNT) {
+        testError("MpscRing received + dropped should be %u, got %u", PRODUCERS * COUNT, received + ring.dropped());
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -pthread -lstdc++ test.cpp src/util/mpsc_ring.test.cpp; ./a.out; rm a.out
+
+    TestPushPop();
+    TestWrapAround();
+    TestConcurrentProducers();
+    TestConcurrentDrops();
+
+    return testResults("mpsc_ring");
+}
@@ -0,0 +1,78 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <vector>
+
+#include "../../../src/util/spsc_ring.h"
+
+using namespace std;
+
+//
+// Throughput and latency of the cross-core message ring
+// using one producer thread and one consumer thread.
+//
+
+typedef struct Stamped {
+    uint64_t sequence;
+    uint64_t sentNs;
+    char payload[32];   // roughly the size of a bridged message
+} Stamped;
+
+static inline uint64_t nowNs() {
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static SpscRing<Stamped, 64> ring;
+
+int main() {
+    // from test folder run:
+    // gcc -O2 -DTESTING -std=c++11 -pthread -lstdc++ src/util/spsc_ring.bench.cpp; ./a.out; rm a.out
+
+    const uint64_t COUNT = 1000000;
+    const uint64_t SAMPLE_EVERY = 64;
+    vector<uint64_t> latencies;
+    latencies.reserve(COUNT / SAMPLE_EVERY + 1);
+
+    const uint64_t startNs = nowNs();
+    thread producer([&]() {
+        Stamped value;
+        for(uint64_t i = 0; i < COUNT; ) {
+            value.sequence = i;
+            value.sentNs = nowNs();
+            if(ring.push(value)) {
+                i += 1;
+            } else {
+                this_thread::yield();
+            }
+        }
+    });
+
+    Stamped value;
+    for(uint64_t received = 0; received < COUNT; ) {
+        if(ring.pop(value)) {
+            if(0 == (value.sequence % SAMPLE_EVERY)) {
+                latencies.push_back(nowNs() - value.sentNs);
+            }
+            received += 1;
+        } else {
+            this_thread::yield();
+        }
+    }
+    const uint64_t elapsedNs = nowNs() - startNs;
+    producer.join();
+
+    sort(latencies.begin(), latencies.end());
+    printf("spsc_ring: %llu messages in %.1f ms, %.2f M msg/sec, %.1f ns/msg\n",
+        (unsigned long long)COUNT,
+        elapsedNs / 1e6,
+        COUNT * 1000.0 / elapsedNs,
+        (double)elapsedNs / COUNT);
+    printf("spsc_ring: latency p50 = %llu ns, p99 = %llu ns, max = %llu ns\n",
+        (unsigned long long)latencies[latencies.size() / 2],
+        (unsigned long long)latencies[latencies.size() * 99 / 100],
+        (unsigned long long)latencies.back());
+
+    return 0;
+}
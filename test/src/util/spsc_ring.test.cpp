@@ -0,0 +1,120 @@
+#include <string.h>
+#include <thread>
+
+#include "../../test.h"
+#include "../../../src/util/spsc_ring.h"
+
+using namespace std;
+
+void TestPushPop() {
+    SpscRing<int, 4> ring;
+    int value = -1;
+
+    if(ring.pop(value)) {
+        testError("SpscRing.pop() returned a value from an empty ring: %d", value);
+    }
+
+    for(int i = 0; i < 4; i += 1) {
+        if(!ring.push(i)) {
+            testError("SpscRing.push() failed before ring was full at %d", i);
+        }
+    }
+    if(4 != ring.count()) {
+        testError("SpscRing.count() is wrong: 4 != %d", ring.count());
+    }
+
+    //
+    // full ring should reject and count the drop
+    //
+    if(ring.push(99)) {
+        testError("SpscRing.push() succeeded on a full ring%s", "");
+    }
+    if(1 != ring.dropped()) {
+        testError("SpscRing.dropped() is wrong: 1 != %d", ring.dropped());
+    }
+
+    //
+    // values come out in order they went in
+    //
+    for(int i = 0; i < 4; i += 1) {
+        if(!ring.pop(value) || (i != value)) {
+            testError("SpscRing.pop() returned wrong value: %d != %d", i, value);
+        }
+    }
+    if(!ring.empty()) {
+        testError("SpscRing should be empty, but count is %d", ring.count());
+    }
+}
+
+void TestWrapAround() {
+    //
+    // indices run freely; make sure many laps stay in order
+    //
+    SpscRing<unsigned int, 8> ring;
+    unsigned int expected = 0;
+    unsigned int value = 0;
+    for(unsigned int i = 0; i < 1000; i += 1) {
+        ring.push(i);
+        if(0 == (i % 3)) {
+            while(ring.pop(value)) {
+                if(value != expected) {
+                    testError("SpscRing wrap-around out of order: %u != %u", expected, value);
+                }
+                expected += 1;
+            }
+        }
+    }
+}
+
+void TestConcurrentStress() {
+    //
+    // one producer thread and one consumer thread;
+    // every value must arrive exactly once and in order.
+    //
+    const unsigned int COUNT = 2000000;
+    static SpscRing<unsigned int, 64> ring;
+
+    thread producer([&]() {
+        for(unsigned int i = 1; i <= COUNT; ) {
+            if(ring.push(i)) {
+                i += 1;
+            } else {
+                this_thread::yield();
+            }
+        }
+    });
+
+    unsigned int expected = 1;
+    unsigned int errors = 0;
+    unsigned int value = 0;
+    while(expected <= COUNT) {
+        if(ring.pop(value)) {
+            if(value != expected) {
+                errors += 1;
+                expected = value;   // resync so we report each gap once
+            }
+            expected += 1;
+        } else {
+            this_thread::yield();
+        }
+    }
+    producer.join();
+
+    if(0 != errors) {
+        testError("SpscRing concurrent stress saw %u out of order values", errors);
+    }
+    if(!ring.empty()) {
+        testError("SpscRing should be empty after stress, but count is %d", ring.count());
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -pthread -lstdc++ test.cpp src/util/spsc_ring.test.cpp; ./a.out; rm a.out
+
+    TestPushPop();
+    TestWrapAround();
+    TestConcurrentStress();
+
+    return testResults("spsc_ring");
+}
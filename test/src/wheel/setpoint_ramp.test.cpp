@@ -0,0 +1,128 @@
+#include <math.h>
+
+#include "../../test.h"
+#include "../../../src/wheel/setpoint_ramp.h"
+
+using namespace std;
+
+const float STEP_SECONDS = 0.02;    // CONTROL_POLL_MS
+
+/**
+ * Ramp to the target, checking the limits on every step
+ */
+static int runRamp(SetpointRamp &ramp, float maxRate, float maxJerk, const char *name) {
+    int steps = 0;
+    float lastValue = ramp.value();
+    float lastRate = 0;
+    while(!ramp.done() && (steps < 10000)) {
+        const float value = ramp.step(STEP_SECONDS);
+        const float rate = (value - lastValue) / STEP_SECONDS;
+        if(fabs(rate) > maxRate * 1.001) {
+            testError("%s: rate %f is over limit %f at step %d", name, rate, maxRate, steps);
+        }
+        // the last step lands on the target, so it may change rate more sharply
+        if((maxJerk > 0) && !ramp.done() && (steps > 0) && (fabs(rate - lastRate) / STEP_SECONDS > maxJerk * 1.001)) {
+            testError("%s: jerk %f is over limit %f at step %d", name, (rate - lastRate) / STEP_SECONDS, maxJerk, steps);
+        }
+        lastValue = value;
+        lastRate = rate;
+        steps += 1;
+    }
+    return steps;
+}
+
+void TestUnlimited() {
+    SetpointRamp ramp;
+    ramp.setTarget(30);
+    if((30 != ramp.value()) || !ramp.done()) {
+        testError("unlimited ramp: setpoint is %f, not 30", ramp.value());
+    }
+}
+
+void TestTrapezoid() {
+    SetpointRamp ramp;
+    ramp.setLimits(100, 0).setTarget(30);
+    const int steps = runRamp(ramp, 100, 0, "trapezoid");
+
+    // 30 at 100 per second is 0.3 seconds
+    if((ramp.value() != 30) || (steps != 15)) {
+        testError("trapezoid: ended at %f after %d steps, not 30 after 15", ramp.value(), steps);
+    }
+}
+
+void TestSCurve() {
+    SetpointRamp ramp;
+    ramp.setLimits(100, 1000).setTarget(30);
+    float last = ramp.value();
+    int steps = 0;
+    while(!ramp.done() && (steps < 10000)) {
+        const float value = ramp.step(STEP_SECONDS);
+        if(value < last) {
+            testError("s-curve: setpoint went backward from %f to %f", last, value);
+        }
+        last = value;
+        steps += 1;
+    }
+
+    // 0.1 seconds to reach full rate, 0.2 seconds at it, 0.1 seconds to stop; about 20 steps
+    if((ramp.value() != 30) || (steps < 19) || (steps > 22)) {
+        testError("s-curve: ended at %f after %d steps, not 30 after about 20", ramp.value(), steps);
+    }
+
+    ramp.reset(0).setTarget(30);
+    runRamp(ramp, 100, 1000, "s-curve");
+}
+
+void TestReverse() {
+    //
+    // change the target to the other direction part way;
+    // the setpoint slows, turns around, and gets there
+    //
+    SetpointRamp ramp;
+    ramp.setLimits(100, 1000).setTarget(30);
+    for(int i = 0; i < 8; i += 1) {
+        ramp.step(STEP_SECONDS);
+    }
+    ramp.setTarget(-20);
+    runRamp(ramp, 100, 1000, "reverse");
+    if(-20 != ramp.value()) {
+        testError("reverse: ended at %f, not -20", ramp.value());
+    }
+}
+
+void TestScaledRampsKeepRatio() {
+    //
+    // two ramps scaled in proportion to their change
+    // keep the same ratio and finish together, like two
+    // wheels keeping the rover's curvature
+    //
+    SetpointRamp left;
+    SetpointRamp right;
+    left.setLimits(100, 1000).setScale(0.5).setTarget(15);
+    right.setLimits(100, 1000).setScale(1.0).setTarget(30);
+    int steps = 0;
+    while(!(left.done() && right.done()) && (steps < 10000)) {
+        const float l = left.step(STEP_SECONDS);
+        const float r = right.step(STEP_SECONDS);
+        if((0 != r) && (fabs(l / r - 0.5) > 1e-4)) {
+            testError("scaled: ratio %f at step %d, not 0.5", l / r, steps);
+        }
+        if(left.done() != right.done()) {
+            testError("scaled: ramps did not finish together at step %d", steps);
+        }
+        steps += 1;
+    }
+}
+
+int main() {
+    // from test folder run:
+    // gcc -DTESTING -std=c++11 -lstdc++ test.cpp src/wheel/setpoint_ramp.test.cpp ../src/wheel/setpoint_ramp.cpp -lm; ./a.out; rm a.out
+
+    TestUnlimited();
+    TestTrapezoid();
+    TestSCurve();
+    TestReverse();
+    TestScaledRampsKeepRatio();
+
+    return testResults("setpoint_ramp");
+}
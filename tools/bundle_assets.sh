@@ -40,6 +40,7 @@ cat client/js/command/rover_command.js >> client/bundle.js
 
 cat client/js/telemetry/pose/pose_canvas_painter.js >> client/bundle.js
 cat client/js/telemetry/motor/telemetry_canvas_painter.js >> client/bundle.js
+cat client/js/telemetry/log_tokens.js >> client/bundle.js
 cat client/js/telemetry/telemetry_listener.js >> client/bundle.js
 cat client/js/telemetry/telemetry_model_listener.js >> client/bundle.js
 cat client/js/telemetry/reset_telemetry_view_controller.js >> client/bundle.js
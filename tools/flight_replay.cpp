@@ -0,0 +1,136 @@
+//
+// Replay a flight log recorded on the rover
+// through the rover's pose estimation and
+// compare the replayed poses to the recorded poses.
+//
+// build and run with tools/flight_replay.sh
+//
+// usage: flight_replay <flight.log> [--poses]
+//        --poses prints each replayed pose as csv
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "recorder/flight_log.h"
+#include "rover/odometry.h"
+
+int main(int argc, char **argv) {
+    if(argc < 2) {
+        fprintf(stderr, "usage: %s <flight.log> [--poses]\n", argv[0]);
+        return 2;
+    }
+    const bool printPoses = (argc > 2) && (0 == strcmp("--poses", argv[2]));
+
+    //
+    // read whole log into memory
+    //
+    FILE *file = fopen(argv[1], "rb");
+    if(nullptr == file) {
+        fprintf(stderr, "could not open %s\n", argv[1]);
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    uint8_t *log = (uint8_t *)malloc(size > 0 ? size : 1);
+    if((nullptr == log) || ((size > 0) && (1 != fread(log, size, 1, file)))) {
+        fprintf(stderr, "could not read %s\n", argv[1]);
+        fclose(file);
+        return 1;
+    }
+    fclose(file);
+
+    FlightLogReader reader(log, (uint32_t)size);
+    if(!reader.valid()) {
+        fprintf(stderr, "%s is not a flight log\n", argv[1]);
+        free(log);
+        return 1;
+    }
+
+    const FlightLogHeader &header = reader.header();
+    printf("wheelbase %g, circumference %g/%g, counts per revolution %u/%u, %s\n",
+        header.wheelBase, header.leftCircumference, header.rightCircumference,
+        header.leftCountsPerRevolution, header.rightCountsPerRevolution,
+        reader.indexed() ? "indexed" : "not indexed; log was not ended cleanly");
+    if((POSE_POLL_MS != header.posePollMs) || (POSE_MIN_ENCODER_COUNT != header.poseMinEncoderCount)) {
+        printf("warning: log was recorded with pose poll %ums and minimum count %u, replaying with %ums and %ld\n",
+            header.posePollMs, header.poseMinEncoderCount, POSE_POLL_MS, (long)POSE_MIN_ENCODER_COUNT);
+    }
+
+    Odometry odometry(header.wheelBase);
+    odometry.setWheels(
+        header.leftCircumference, header.leftCountsPerRevolution,
+        header.rightCircumference, header.rightCountsPerRevolution);
+
+    unsigned long commands = 0;
+    unsigned long wheelChanges = 0;
+    unsigned long samples = 0;
+    unsigned long poses = 0;
+    unsigned long replayed = 0;
+    unsigned long mismatches = 0;
+    unsigned long dropped = 0;
+    float maxError = 0;
+    bool expectPose = false;    // true if last sample updated the replayed pose
+
+    FlightRecord record;
+    while(reader.next(record)) {
+        switch(record.type) {
+            case FLIGHT_RECORD_COMMAND: {
+                commands += 1;
+                printf("%10lu command %.*s\n", (unsigned long)record.at, record.textLength, record.text);
+                break;
+            }
+            case FLIGHT_RECORD_WHEEL_POWER: {
+                wheelChanges += 1;
+                break;
+            }
+            case FLIGHT_RECORD_ENCODERS: {
+                samples += 1;
+                if(0 != (record.flags & FLIGHT_ENCODERS_START)) {
+                    odometry.reset();
+                }
+                expectPose = odometry.update(record.encoders);
+                if(expectPose) {
+                    replayed += 1;
+                    if(printPoses) {
+                        const Pose2D pose = odometry.pose();
+                        printf("%lu,%f,%f,%f\n", (unsigned long)record.at, pose.x, pose.y, pose.angle);
+                    }
+                }
+                break;
+            }
+            case FLIGHT_RECORD_POSE: {
+                poses += 1;
+                const Pose2D pose = odometry.pose();
+                const float error = fmaxf(fmaxf(fabsf(pose.x - record.pose.x), fabsf(pose.y - record.pose.y)), fabsf(pose.angle - record.pose.angle));
+                if(error > maxError) {
+                    maxError = error;
+                }
+                if(!expectPose || (odometry.lastPoseMs() != record.at) || (error > 0.001f)) {
+                    mismatches += 1;
+                    printf("%10lu recorded pose (%f, %f, %f) replayed (%f, %f, %f)\n", (unsigned long)record.at,
+                        record.pose.x, record.pose.y, record.pose.angle, pose.x, pose.y, pose.angle);
+                }
+                expectPose = false;
+                break;
+            }
+            case FLIGHT_RECORD_DROPPED: {
+                dropped += record.dropped;
+                printf("%10lu %lu records were dropped; replay may diverge\n", (unsigned long)record.at, (unsigned long)record.dropped);
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+
+    printf("%lu commands, %lu wheel power changes, %lu encoder samples, %lu recorded poses, %lu replayed poses, %lu dropped\n",
+        commands, wheelChanges, samples, poses, replayed, dropped);
+    printf("%lu mismatched poses, largest difference %g\n", mismatches, maxError);
+
+    free(log);
+    return (0 == mismatches) ? 0 : 1;
+}
@@ -0,0 +1,8 @@
+#!/bin/bash
+
+# this should be run from the root of the project folder
+#
+# replay a flight log downloaded from the rover's /flight endpoint;
+#   tools/flight_replay.sh flight.log [--poses]
+
+g++ -std=c++11 -Isrc tools/flight_replay.cpp src/recorder/flight_log.cpp src/rover/odometry.cpp src/rover/pose.cpp -o /tmp/flight_replay && /tmp/flight_replay "$@"
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# this should be run from the root of the project folder
+#
+# generate the client's table of tokenized log formats
+# from src/log_tokens.h; run this after editing that table
+# so the client formats log records the same way the rover does.
+
+OUT=client/js/telemetry/log_tokens.js
+
+echo "/**" > $OUT
+echo " * Format strings of tokenized log records, indexed by token." >> $OUT
+echo " * GENERATED from src/log_tokens.h by tools/log_tokens_js.sh; do not edit." >> $OUT
+echo " */" >> $OUT
+echo "const LOG_TOKEN_FORMATS = [" >> $OUT
+sed -n 's/^ *LOG_TOKEN( *\([A-Z0-9_]*\), *\(".*"\)) *\\\{0,1\} *$/    \2,     \/\/ \1/p' src/log_tokens.h >> $OUT
+echo "];" >> $OUT
@@ -0,0 +1,16 @@
+#!/bin/bash
+
+# this should be run from the root of the project folder
+#
+# replay a flight log or csv of wheel samples through the rover's
+# wheel speed and pose code and print the speed and pose traces;
+#   tools/replay.sh flight.log > traces.csv
+#   tools/replay.sh samples.csv --bench 100
+
+g++ -O2 -DTESTING -DUSE_ENCODER_INTERRUPTS -std=c++11 -Itest/replay -Isrc -include Arduino.h \
+    test/replay/replay.cpp test/replay/rover_replay.cpp \
+    src/gpio/pwm.cpp src/motor/motor_l9110s.cpp src/encoder/encoder.cpp src/wheel/drive_wheel.cpp \
+    src/rover/rover.cpp src/rover/odometry.cpp src/rover/pose.cpp \
+    src/recorder/flight_recorder.cpp src/recorder/flight_log.cpp \
+    src/message_bus/message_bus.cpp src/message_bus/messages.cpp \
+    -o /tmp/rover_replay && /tmp/rover_replay "$@"